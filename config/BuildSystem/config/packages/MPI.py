@@ -501,8 +501,11 @@ class Configure(config.package.Package):
     if self.libraries.check(self.dlib, "MPI_Win_create"):
       self.addDefine('HAVE_MPI_WIN_CREATE',1)
       self.addDefine('HAVE_MPI_REPLACE',1) # MPI_REPLACE is strictly for use with the one-sided function MPI_Accumulate
+    if self.libraries.check(self.dlib, "MPI_Dist_graph_create_adjacent") and self.libraries.check(self.dlib, "MPI_Neighbor_alltoallv"):
+      self.addDefine('HAVE_MPI_NEIGHBORHOOD_COLLECTIVES',1)
     funcs = '''MPI_Comm_spawn MPI_Type_get_envelope MPI_Type_get_extent MPI_Type_dup MPI_Init_thread
-      MPI_Iallreduce MPI_Ibarrier MPI_Finalized MPI_Exscan MPI_Reduce_scatter MPI_Reduce_scatter_block'''.split()
+      MPI_Iallreduce MPI_Ibarrier MPI_Finalized MPI_Exscan MPI_Reduce_scatter MPI_Reduce_scatter_block
+      MPI_Ineighbor_alltoallv MPI_Neighbor_alltoallv_init'''.split()
     found, missing = self.libraries.checkClassify(self.dlib, funcs)
     for f in found:
       self.addDefine('HAVE_' + f.upper(),1)
@@ -49,6 +49,8 @@ regressionParameters = {'src/dm/impls/patch/examples/tests/ex1': [{'numProcs': 1
                                                                  {'num' : 'gmsh_3', 'numProcs': 3, 'args': '-filename %(meshes)s/square.msh -interpolate 1 -dm_view'},
                                                                  {'num' : 'gmsh_4', 'numProcs': 3, 'args': '-filename %(meshes)s/square_bin.msh -interpolate 1 -dm_view'},
                                                                  {'num' : 'gmsh_5', 'numProcs': 1, 'args': '-filename %(meshes)s/square_quad.msh -interpolate 1 -dm_view'},
+                                                                 {'num' : 'gmsh_6', 'numProcs': 3, 'args': '-filename %(meshes)s/square.msh -interpolate 1 -dm_plex_load_parallel -petscpartitioner_type simple -dm_view'},
+                                                                 {'num' : 'gmsh_7', 'numProcs': 3, 'args': '-filename %(meshes)s/square_bin.msh -interpolate 1 -dm_plex_load_parallel -petscpartitioner_type simple -dm_view'},
                                                                  # Fluent mesh reader tests
                                                                  {'num' : 'fluent_0', 'numProcs': 1, 'args': '-filename %(meshes)s/square.cas -interpolate 1 -dm_view'},
                                                                  {'num' : 'fluent_1', 'numProcs': 3, 'args': '-filename %(meshes)s/square.cas -interpolate 1 -dm_view'},
@@ -455,6 +457,10 @@ regressionParameters = {'src/dm/impls/patch/examples/tests/ex1': [{'numProcs': 1
                                                                {'num': 'tensor_p4est_2d', 'numProcs': 1, 'args': '-run_type test -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -petscspace_order 1 -petscspace_poly_tensor -dm_forest_initial_refinement 2 -dm_forest_minimum_refinement 0 -dm_plex_convert_type p4est', 'requires' : ['p4est']},
                                                                {'num': 'tensor_plex_3d', 'numProcs': 1, 'args': '-run_type test -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -petscspace_order 1 -petscspace_poly_tensor -dm_refine_hierarchy 1 -dim 3'},
                                                                {'num': 'tensor_p4est_3d', 'numProcs': 1, 'args': '-run_type test -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -petscspace_order 1 -petscspace_poly_tensor -dm_forest_initial_refinement 1 -dm_forest_minimum_refinement 0 -dim 3 -dm_plex_convert_type p8est', 'requires' : ['p4est']},
+                                                               # Matrix-free operator
+                                                               {'num': 'mffe_mg', 'numProcs': 1, 'args': '-run_type full -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -interpolate 1 -petscspace_order 2 -petscspace_poly_tensor -dm_refine_hierarchy 2 -dm_mat_type mffe -ksp_type cg -ksp_rtol 1.0e-12 -pc_type mg -pc_mg_levels 3 -mg_levels_ksp_type chebyshev -mg_levels_ksp_chebyshev_esteig 0,0.1,0,1.1 -mg_levels_pc_type jacobi -mg_coarse_ksp_type cg -mg_coarse_ksp_rtol 1.0e-12 -mg_coarse_pc_type jacobi -ksp_monitor_short -ksp_converged_reason -snes_monitor_short -snes_converged_reason'},
+                                                               #   Matrix-free action through element matrices, over more cells than one chunk holds, checked through Au + F(0)
+                                                               {'num': 'mffe_chunks', 'numProcs': 1, 'args': '-run_type test -quiet -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -interpolate 1 -petscspace_order 2 -petscspace_poly_tensor -dm_refine 5 -dm_mat_type mffe'},
                                                                # AMR
                                                                {'num': 'amr_0', 'numProcs': 5, 'args': '-run_type test -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -petscspace_order 1 -petscspace_poly_tensor -dm_refine 1'},
                                                                {'num': 'amr_1', 'numProcs': 1, 'args': '-run_type test -refinement_limit 0.0 -simplex 0 -bc_type dirichlet -petscspace_order 1 -petscspace_poly_tensor -dm_plex_convert_type p4est -dm_p4est_refine_pattern center -dm_forest_maximum_refinement 5 -dm_view vtk:amr.vtu:vtk_vtu -vec_view vtk:amr.vtu:vtk_vtu:append', 'requires' : ['p4est']},
@@ -553,6 +559,14 @@ regressionParameters = {'src/dm/impls/patch/examples/tests/ex1': [{'numProcs': 1
                                                                #   FULL Schur with LU/Jacobi
                                                                {'num': 'quad_q2q1_full', 'numProcs': 1, 'args': '-run_type full -simplex 0 -refinement_limit 0.00625 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -ksp_type fgmres -ksp_gmres_restart 10 -ksp_rtol 1.0e-9 -pc_type fieldsplit -pc_fieldsplit_type schur -pc_fieldsplit_schur_factorization_type full -fieldsplit_pressure_ksp_rtol 1e-10 -fieldsplit_velocity_ksp_type gmres -fieldsplit_velocity_pc_type lu -fieldsplit_pressure_pc_type jacobi -snes_monitor_short -ksp_monitor_short -snes_converged_reason -ksp_converged_reason -snes_view -show_solution 0', 'parser': 'Solver'},
                                                                {'num': 'quad_q2p1_full', 'numProcs': 1, 'args': '-run_type full -simplex 0 -refinement_limit 0.00625 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscdualspace_lagrange_continuity 0 -ksp_type fgmres -ksp_gmres_restart 10 -ksp_rtol 1.0e-9 -pc_type fieldsplit -pc_fieldsplit_type schur -pc_fieldsplit_schur_factorization_type full -fieldsplit_pressure_ksp_rtol 1e-10 -fieldsplit_velocity_ksp_type gmres -fieldsplit_velocity_pc_type lu -fieldsplit_pressure_pc_type jacobi -snes_monitor_short -ksp_monitor_short -snes_converged_reason -ksp_converged_reason -snes_view -show_solution 0', 'parser': 'Solver'},
+                                                               #   Threaded cell-colored assembly
+                                                               {'num': 'quad_q2q1_threads', 'numProcs': 1, 'args': '-run_type full -simplex 0 -dm_refine 3 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -ksp_type fgmres -ksp_gmres_restart 10 -ksp_rtol 1.0e-9 -pc_type fieldsplit -pc_fieldsplit_type schur -pc_fieldsplit_schur_factorization_type full -fieldsplit_pressure_ksp_rtol 1e-10 -fieldsplit_velocity_ksp_type gmres -fieldsplit_velocity_pc_type lu -fieldsplit_pressure_pc_type jacobi -snes_monitor_short -ksp_converged_reason -snes_converged_reason -show_solution 0 -malloc_debug -malloc_test -dm_plex_assembly_threads 8', 'parser': 'Solver'},
+                                                               #   Sum-factorized tensor product kernels
+                                                               {'num': 'quad_q2q1_tensor', 'numProcs': 1, 'args': '-run_type test -simplex 0 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -vel_petscfe_type tensor -pres_petscfe_type tensor'},
+                                                               #   Matrix-free Jacobian action, checked against the assembled Jacobian through Au + F(0)
+                                                               {'num': 'quad_q2q1_mffe', 'numProcs': 1, 'args': '-run_type test -simplex 0 -dm_refine 1 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -dm_mat_type mffe'},
+                                                               {'num': 'quad_q2q1_mffe_tensor', 'numProcs': 1, 'args': '-run_type test -simplex 0 -dm_refine 1 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -vel_petscfe_type tensor -pres_petscfe_type tensor -dm_mat_type mffe'},
+                                                               {'num': 'hex_q1q1_mffe_tensor', 'numProcs': 1, 'args': '-run_type test -dim 3 -simplex 0 -dm_refine 1 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 1 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -vel_petscfe_type tensor -pres_petscfe_type tensor -dm_mat_type mffe'},
                                                                ],
                         'src/snes/examples/tutorials/ex63':   [# 2D serial P1 full runs
                                                                {'num': 'quad_q2q1_full', 'numProcs': 1, 'args': '-run_type full -simplex 0 -dm_refine 2 -bc_type dirichlet -interpolate 1 -vel_petscspace_order 2 -vel_petscspace_poly_tensor -pres_petscspace_order 1 -pres_petscspace_poly_tensor -ksp_type fgmres -ksp_gmres_restart 10 -ksp_rtol 1.0e-9 -pc_type fieldsplit -pc_fieldsplit_type schur -pc_fieldsplit_schur_factorization_type full -fieldsplit_pressure_ksp_rtol 1e-10 -fieldsplit_velocity_ksp_type gmres -fieldsplit_velocity_pc_type lu -fieldsplit_pressure_pc_type jacobi -snes_monitor_short -ksp_monitor_short -snes_converged_reason -ksp_converged_reason -snes_view -show_solution 0', 'parser': 'Solver'},
@@ -34,6 +34,7 @@
 #define KSPFGMRES 'fgmres'
 #define KSPLGMRES 'lgmres'
 #define KSPDGMRES 'dgmres'
+#define KSPGCRODR 'gcrodr'
 #define KSPPGMRES 'pgmres'
 #define KSPTCQMR 'tcqmr'
 #define KSPBCGS 'bcgs'
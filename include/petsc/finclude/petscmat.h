@@ -217,6 +217,7 @@
       PetscEnum SOR_EISENSTAT
       PetscEnum SOR_APPLY_UPPER
       PetscEnum SOR_APPLY_LOWER
+      PetscEnum SOR_MULTICOLOR
 
       parameter (SOR_FORWARD_SWEEP=1,SOR_BACKWARD_SWEEP=2)
       parameter (SOR_SYMMETRIC_SWEEP=3,SOR_LOCAL_FORWARD_SWEEP=4)
@@ -224,6 +225,7 @@
       parameter (SOR_LOCAL_SYMMETRIC_SWEEP=12)
       parameter (SOR_ZERO_INITIAL_GUESS=16,SOR_EISENSTAT=32)
       parameter (SOR_APPLY_UPPER=64,SOR_APPLY_LOWER=128)
+      parameter (SOR_MULTICOLOR=256)
 !
 !  MatOperation
 !
@@ -50,6 +50,7 @@
 #define PCNN 'nn'
 #define PCCHOLESKY 'cholesky'
 #define PCPBJACOBI 'pbjacobi'
+#define PCVPBJACOBI 'vpbjacobi'
 #define PCMAT 'mat'
 #define PCHYPRE 'hypre'
 #define PCPARMS 'parms'
@@ -95,6 +95,47 @@ struct _PetscGridHash {
   DMLabel      cellsSparse; /* Sparse storage for cell map */
 };
 
+/* Info about the coloring of the cells used by the threaded FEM assembly, see DMPlexSetAssemblyThreads() */
+typedef struct {
+  PetscSection section;            /* the local section of lidx */
+  PetscSection globalSection;      /* the global section of gidx, or NULL until the first Jacobian */
+  PetscInt     cStart, cEnd;       /* the cells that are colored */
+  PetscInt     totDim;             /* the number of unknowns in the closure of each cell */
+  PetscInt    *lidx;               /* the local vector offsets of the closure of each cell */
+  PetscInt    *gidx;               /* the global rows of the closure of each cell, negative for constrained unknowns */
+  PetscInt     ncolors;
+  PetscInt    *color;              /* cells[color[c]:color[c+1]] are the cells of color c */
+  PetscInt    *cells;
+  PetscInt     nthreads;           /* number of threads that integrate and add each color */
+  PetscInt     ndsthreads;         /* number of per thread copies in ds and dsAux */
+  PetscDS      prob, probAux;      /* the problems copied to ds and dsAux */
+  PetscDS     *ds, *dsAux;         /* per thread copies, for the work arrays used by the integration */
+} DMPlex_AssemblyColoring;
+
+/* Flattened closure dofs of the cells for one section, see DMPlexSetUseClosureCache() */
+typedef struct _n_DMPlex_ClosureCache *DMPlex_ClosureCache;
+struct _n_DMPlex_ClosureCache {
+  PetscObjectId       id;            /* the section of idx */
+  PetscObjectState    state;         /* the state of the section when idx was computed */
+  PetscObjectId       gid;           /* the global section of gidx, or 0 if gidx has not been computed */
+  PetscObjectState    gstate;
+  PetscInt            cStart, cEnd;  /* the cells whose closures are cached */
+  PetscInt           *off;           /* the closure of cell c is stored in [off[c-cStart], off[c-cStart+1]) */
+  PetscInt           *idx;           /* the local vector offsets of the closure, in the order of DMPlexVecGetClosure() */
+  PetscBT             bc;            /* marks the constrained dofs in idx, or NULL if there are none */
+  PetscInt           *gidx;          /* the global rows of the closure, in the order of DMPlexMatSetClosure() */
+  PetscLogDouble      mem;           /* the bytes held by this cache */
+  DMPlex_ClosureCache next;
+};
+
+/* The state at which a MATMFFE matrix from DMCreateMatrix() applies the Jacobian, recorded by DMPlexComputeJacobian_Internal() */
+typedef struct {
+  Vec       X, X_t; /* the local solution and its time derivative, or NULL */
+  PetscReal t;      /* the time */
+  PetscReal shift;  /* the multiplier of the dF/du_t term */
+  void     *user;   /* the user context of the pointwise functions */
+} DMPlex_MFFE;
+
 typedef struct {
   PetscInt             refct;
 
@@ -156,6 +197,11 @@ typedef struct {
   /* Projection */
   PetscInt             maxProjectionHeight; /* maximum height of cells used in DMPlexProject functions */
 
+  /* FEM assembly */
+  PetscInt             assemblyThreads;   /* Number of threads of the colored cell loop, 0 for the serial loop */
+  PetscBool            useClosureCache;   /* Cache the closure dofs of the cells for each section */
+  DMPlex_ClosureCache  closureCache;      /* The most recently used caches, one per section */
+
   /* Output */
   PetscInt             vtkCellHeight;            /* The height of cells for output, default is 0 */
   PetscReal            scale[NUM_PETSC_UNITS];   /* The scale for each SI unit */
@@ -200,6 +246,9 @@ PETSC_INTERN PetscErrorCode CellRefinerGetAffineTransforms_Internal(CellRefiner,
 PETSC_INTERN PetscErrorCode CellRefinerRestoreAffineTransforms_Internal(CellRefiner, PetscInt *, PetscReal *[], PetscReal *[], PetscReal *[]);
 PETSC_INTERN PetscErrorCode CellRefinerInCellTest_Internal(CellRefiner, const PetscReal[], PetscBool *);
 PETSC_EXTERN PetscErrorCode DMPlexCreateGmsh_ReadElement(PetscViewer, PetscInt, PetscBool, PetscBool, GmshElement **);
+PETSC_INTERN PetscErrorCode DMPlexCreateFromCellListParallel_Internal(MPI_Comm, PetscInt, PetscInt, PetscInt, PetscInt, PetscBool, const int[], PetscInt, const double[], PetscSF *, DM *);
+PETSC_INTERN PetscErrorCode DMPlexSetLabelFromVertexSets_Internal(DM, PetscSF, const char[], PetscInt, const PetscInt[]);
+PETSC_INTERN PetscErrorCode DMPlexReplace_Internal(DM, DM);
 PETSC_INTERN PetscErrorCode DMPlexInvertCell_Internal(PetscInt, PetscInt, PetscInt[]);
 PETSC_INTERN PetscErrorCode DMPlexVecSetFieldClosure_Internal(DM, PetscSection, Vec, PetscBool[], PetscInt, const PetscScalar[], InsertMode);
 PETSC_INTERN PetscErrorCode DMPlexProjectConstraints_Internal(DM, Vec, Vec);
@@ -252,7 +301,16 @@ PETSC_STATIC_INLINE PetscInt DihedralSwap(PetscInt N, PetscInt a, PetscInt b)
 
 PETSC_EXTERN PetscErrorCode DMPlexComputeResidual_Internal(DM, PetscInt, PetscInt, PetscReal, Vec, Vec, PetscReal, Vec, void *);
 PETSC_EXTERN PetscErrorCode DMPlexComputeJacobian_Internal(DM, PetscInt, PetscInt, PetscReal, PetscReal, Vec, Vec, Mat, Mat, void *);
+PETSC_EXTERN PetscErrorCode DMPlexComputeJacobianAction_Internal(DM, PetscInt, PetscInt, PetscReal, PetscReal, Vec, Vec, Vec, Vec, void *);
 PETSC_EXTERN PetscErrorCode DMPlexReconstructGradients_Internal(DM, PetscFV, PetscInt, PetscInt, Vec, Vec, Vec, Vec);
+PETSC_INTERN PetscErrorCode DMPlexGetAssemblyColoring_Internal(DM, PetscInt, PetscInt, DMPlex_AssemblyColoring **);
+PETSC_INTERN PetscErrorCode DMPlexIntegrateResidualThreaded_Internal(DMPlex_AssemblyColoring *, PetscFE, PetscDS, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscScalar[]);
+PETSC_INTERN PetscErrorCode DMPlexIntegrateJacobianThreaded_Internal(DMPlex_AssemblyColoring *, PetscFE, PetscDS, PetscFEJacobianType, PetscInt, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscReal, PetscScalar[]);
+PETSC_INTERN PetscErrorCode DMPlexVecSetClosureColored_Internal(DMPlex_AssemblyColoring *, Vec, const PetscScalar[]);
+PETSC_INTERN PetscErrorCode DMPlexMatSetClosureColored_Internal(DM, DMPlex_AssemblyColoring *, PetscSection, Mat, const PetscScalar[]);
+PETSC_INTERN PetscErrorCode DMPlexGetClosureCache_Internal(DM, PetscSection, PetscSection, DMPlex_ClosureCache *);
+PETSC_INTERN PetscErrorCode DMPlexDestroyClosureCache_Internal(DM);
+PETSC_EXTERN PetscErrorCode DMPlexGetMFFE_Internal(Mat, DMPlex_MFFE **);
 
 #undef __FUNCT__
 #define __FUNCT__ "DMPlex_Invert2D_Internal"
@@ -117,6 +117,11 @@ PETSC_EXTERN PetscErrorCode PetscKernel_A_gets_inverse_A_15(MatScalar*,PetscInt*
 */
 #define PetscKernel_A_gets_inverse_A(bs,A,pivots,W,allowzeropivot,zeropivotdetected) (PetscLINPACKgefa((A),(bs),(pivots),(allowzeropivot),(zeropivotdetected)) || PetscLINPACKgedi((A),(bs),(pivots),(W)))
 
+/*
+    A[i] = inv(A[i]) for the n blocks of size bs stored one after the other in A, several at a time with vector instructions
+*/
+PETSC_EXTERN PetscErrorCode PetscKernel_A_gets_inverse_A_batch(PetscInt,PetscInt,MatScalar*,PetscReal,PetscBool,PetscBool*);
+
 /* -----------------------------------------------------------------------*/
 
 #if !defined(PETSC_USE_REAL_MAT_SINGLE)
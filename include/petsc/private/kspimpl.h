@@ -19,6 +19,7 @@ struct _KSPOps {
                                                           calculates the residual in a
                                                           user-provided area.  */
   PetscErrorCode (*solve)(KSP);                        /* actual solver */
+  PetscErrorCode (*matsolve)(KSP,Mat,Mat);             /* block solver for several right hand sides, see KSPMatSolve() */
   PetscErrorCode (*setup)(KSP);
   PetscErrorCode (*setfromoptions)(PetscOptionItems*,KSP);
   PetscErrorCode (*publishoptions)(KSP);
@@ -295,9 +296,16 @@ PETSC_STATIC_INLINE PetscErrorCode KSP_PCApplyBAorABTranspose(KSP ksp,Vec x,Vec
   PetscFunctionReturn(0);
 }
 
-PETSC_EXTERN PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve;
+PETSC_EXTERN PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve, KSP_MatSolve;
 PETSC_EXTERN PetscLogEvent KSP_Solve_FS_0,KSP_Solve_FS_1,KSP_Solve_FS_2,KSP_Solve_FS_3,KSP_Solve_FS_4,KSP_Solve_FS_S,KSP_Solve_FS_L,KSP_Solve_FS_U;
 
+/* building blocks of the block Krylov methods used by KSPMatSolve(), see itblock.c */
+PETSC_INTERN PetscErrorCode KSPMatSolveColumns(KSP,Mat,Mat);
+PETSC_INTERN PetscErrorCode KSPBlockMatMult(KSP,Mat,Mat*);
+PETSC_INTERN PetscErrorCode KSPBlockPCApply(KSP,Mat,Mat);
+PETSC_INTERN PetscErrorCode KSPBlockOrthogonalize(Mat,PetscInt,const PetscReal*,PetscReal,PetscInt*,PetscScalar*,PetscInt);
+PETSC_INTERN PetscErrorCode KSPBlockConverged(KSP,PetscInt,const PetscReal*,const PetscReal*);
+
 PETSC_INTERN PetscErrorCode MatGetSchurComplement_Basic(Mat,IS,IS,IS,IS,MatReuse,Mat*,MatSchurComplementAinvType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode PCPreSolveChangeRHS(PC,PetscBool*);
 
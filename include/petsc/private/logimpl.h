@@ -83,6 +83,7 @@ PETSC_EXTERN PetscErrorCode PetscLogEventBeginComplete(PetscLogEvent, int, Petsc
 PETSC_EXTERN PetscErrorCode PetscLogEventEndComplete(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
 PETSC_EXTERN PetscErrorCode PetscLogEventBeginTrace(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
 PETSC_EXTERN PetscErrorCode PetscLogEventEndTrace(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
+PETSC_INTERN PetscErrorCode PetscLogChromeEnd(void);
 
 /* Creation and destruction functions */
 PETSC_EXTERN PetscErrorCode PetscClassRegLogCreate(PetscClassRegLog *);
@@ -326,12 +326,32 @@ struct _MatStash {
   MPI_Datatype   blocktype;
   size_t         blocktype_size;
   InsertMode     *insertmode;   /* Pointer to check mat->insertmode and set upon message arrival in case no local values have been set. */
+
+  /* The following variables are used for streaming communication, which sends the stash while values are being set */
+  PetscInt       streamsize;      /* number of stashed values after which they are sent */
+  const PetscInt *owners;         /* ownership ranges, set with MatStashSetOwners_Private() */
+  PetscMPIInt    *streamcounts;   /* number of messages sent to each rank since the last assembly */
+  PetscInt       nstreamsends,maxstreamsends;
+  MPI_Request    *streamreqs;     /* sends that are in flight */
+  char           **streambufs;    /* and their buffers */
+  PetscInt       *streamlens;     /* and their number of blocks */
+  PetscInt       streaminflight;  /* number of blocks in all the sends in flight */
+  PetscMPIInt    nstreamrecvs;    /* number of messages received since the last assembly */
+  PetscInt       streamcalls;     /* number of insertions since the incoming messages were last received */
+  PetscMPIInt    streamtag;       /* tag1 and tag2 alternate between assemblies */
+  PetscErrorCode (*streaminsert)(Mat,PetscInt,PetscInt,const PetscScalar[]); /* adds a received block with ADD_VALUES */
+  PetscBool      streampoll;      /* messages are to be received by the next MatSetValues() */
+  PetscMPIInt    nstreamframes;   /* number of received messages kept for the assembly */
+  char           *streamrecvbuf;  /* receive buffer of the messages that are added on arrival */
+  PetscMPIInt    streamrecvmax;   /* and its size in blocks */
 };
 
 PETSC_INTERN PetscErrorCode MatStashCreate_Private(MPI_Comm,PetscInt,MatStash*);
 PETSC_INTERN PetscErrorCode MatStashDestroy_Private(MatStash*);
 PETSC_INTERN PetscErrorCode MatStashScatterEnd_Private(MatStash*);
 PETSC_INTERN PetscErrorCode MatStashSetInitialSize_Private(MatStash*,PetscInt);
+PETSC_INTERN PetscErrorCode MatStashSetOwners_Private(MatStash*,const PetscInt[],PetscErrorCode (*)(Mat,PetscInt,PetscInt,const PetscScalar[]));
+PETSC_INTERN PetscErrorCode MatStashStreamPoll_Private(Mat);
 PETSC_INTERN PetscErrorCode MatStashGetInfo_Private(MatStash*,PetscInt*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatStashValuesRow_Private(MatStash*,PetscInt,PetscInt,const PetscInt[],const PetscScalar[],PetscBool );
 PETSC_INTERN PetscErrorCode MatStashValuesCol_Private(MatStash*,PetscInt,PetscInt,const PetscInt[],const PetscScalar[],PetscInt,PetscBool );
@@ -357,6 +377,33 @@ typedef struct {
 } Mat_CompressedRow;
 PETSC_EXTERN PetscErrorCode MatCheckCompressedRow(Mat,PetscInt,Mat_CompressedRow*,PetscInt*,PetscInt,PetscReal);
 
+/* Info about the level sets of a sparse triangular factor, used by the level-scheduled threaded MatSolve() */
+typedef struct {
+  PetscBool        use;                     /* use the level-scheduled MatSolve() */
+  PetscBool        checked;                 /* the options have been processed */
+  PetscInt         nthreads;                /* number of threads that process each level */
+  PetscInt         nlevels[2];              /* number of levels of the forward [0] and backward [1] substitution */
+  PetscInt         *level[2];               /* rows[t][level[t][l]:level[t][l+1]] are the rows of level l */
+  PetscInt         *rows[2];
+  PetscInt         *ti,*tj,*tk;             /* column oriented copy of the forward factor when it is stored by columns: the
+                                               entries of column i are in rows tj[ti[i]:ti[i+1]] at locations tk[] of a[] */
+  PetscObjectState nonzerostate;            /* non-zero state of the factor when the levels were computed */
+} Mat_SolveLevels;
+PETSC_INTERN PetscErrorCode MatSolveLevelsSetFromOptions(Mat,Mat_SolveLevels*);
+PETSC_INTERN PetscErrorCode MatSolveLevelsSetUp(Mat,Mat_SolveLevels*,PetscInt,PetscInt,const PetscInt[]);
+PETSC_INTERN PetscErrorCode MatSolveLevelsReset(Mat_SolveLevels*);
+
+/* Info about the coloring of the (block) rows used by the multicolor MatSOR() */
+typedef struct {
+  PetscInt         nthreads;                /* number of threads that sweep each color */
+  PetscInt         ncolors;
+  PetscInt         *color;                  /* rows[color[c]:color[c+1]] are the rows of color c */
+  PetscInt         *rows;
+  PetscObjectState nonzerostate;            /* non-zero state of the matrix when the coloring was computed */
+} Mat_SORColoring;
+PETSC_INTERN PetscErrorCode MatSORColoringSetUp(Mat,Mat_SORColoring*,PetscInt,const PetscInt[],const PetscInt[]);
+PETSC_INTERN PetscErrorCode MatSORColoringReset(Mat_SORColoring*);
+
 typedef struct { /* used by MatCreateRedundantMatrix() for reusing matredundant */
   PetscInt     nzlocal,nsends,nrecvs;
   PetscMPIInt  *send_rank,*recv_rank;
@@ -404,6 +451,7 @@ struct _p_Mat {
   Mat_Redundant          *redundant;        /* used by MatCreateRedundantMatrix() */
   PetscBool              erroriffailure;    /* Generate an error if detected (for example a zero pivot) instead of returning */
   MatFactorError         errortype;         /* type of error */
+  PetscInt               nblocks,*bsizes;   /* local sizes of the diagonal blocks set with MatSetVariableBlockSizes() */
 };
 
 PETSC_INTERN PetscErrorCode MatAXPY_Basic(Mat,PetscScalar,Mat,MatStructure);
@@ -1603,6 +1651,7 @@ PETSC_EXTERN PetscLogEvent MAT_GetMultiProcBlock;
 PETSC_EXTERN PetscLogEvent MAT_CUSPCopyToGPU, MAT_CUSPARSECopyToGPU, MAT_SetValuesBatch, MAT_SetValuesBatchI, MAT_SetValuesBatchII, MAT_SetValuesBatchIII, MAT_SetValuesBatchIV;
 PETSC_EXTERN PetscLogEvent MAT_ViennaCLCopyToGPU;
 PETSC_EXTERN PetscLogEvent MAT_Merge,MAT_Residual,MAT_SetRandom;
+PETSC_EXTERN PetscLogEvent MAT_MultOMPImbalance;
 PETSC_EXTERN PetscLogEvent MATCOLORING_Apply,MATCOLORING_Comm,MATCOLORING_Local,MATCOLORING_ISCreate,MATCOLORING_SetUp,MATCOLORING_Weights;
 
 #endif
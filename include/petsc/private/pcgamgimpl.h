@@ -4,11 +4,14 @@
 #include <petsc/private/pcmgimpl.h>                    /*I "petscksp.h" I*/
 #include <petscmatcoarsen.h>                           /*I "petscmatcoarsen.h" I*/
 
+#define GAMG_MAXLEVELS 30
+
 struct _PCGAMGOps {
   PetscErrorCode (*graph)(PC, Mat, Mat*);
   PetscErrorCode (*coarsen)(PC, Mat*, PetscCoarsenData**);
   PetscErrorCode (*prolongator)(PC, Mat, Mat, PetscCoarsenData*, Mat*);
   PetscErrorCode (*optprolongator)(PC, Mat, Mat*);
+  PetscErrorCode (*optprolongatornumeric)(PC, Mat, Mat); /* recompute the values of a prolongator from optprolongator() for new values of the matrix */
   PetscErrorCode (*createlevel)(PC, Mat, PetscInt, Mat *, Mat *, PetscMPIInt *, IS *);
   PetscErrorCode (*createdefaultdata)(PC, Mat); /* for data methods that have a default (SA) */
   PetscErrorCode (*setfromoptions)(PetscOptionItems*,PC);
@@ -23,6 +26,7 @@ typedef struct gamg_TAG {
   PetscInt  setup_count;
   PetscBool repart;
   PetscBool reuse_prol;
+  PetscBool reuse_coarsening;
   PetscBool use_aggs_in_gasm;
   PetscInt  min_eq_proc;
   PetscInt  coarse_eq_limit;
@@ -42,6 +46,13 @@ typedef struct gamg_TAG {
   char *gamg_type_name;
 
   PetscRandom  random;   /* used to generate any random numbers needed by GAMG */
+
+  /* hierarchy kept with reuse_coarsening, for rebuilds with new values of the same nonzero pattern; indexed by the fine level */
+  PetscInt      cached_nlevels;                /* 0 if nothing is cached */
+  PetscObjectId cached_pmat_id;
+  Mat           cached_P[GAMG_MAXLEVELS];      /* prolongators before the coarse equations are moved by repartitioning */
+  Mat           cached_PtAP[GAMG_MAXLEVELS];   /* Galerkin products before the coarse equations are moved */
+  IS            cached_perm[GAMG_MAXLEVELS];   /* the coarse equations kept by this process after repartitioning, or NULL */
   void *subctx;
 } PC_GAMG;
 
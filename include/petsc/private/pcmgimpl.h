@@ -41,6 +41,7 @@ typedef struct {
   PetscInt  maxlevels;                        /* total number of levels allocated */
   PetscInt  galerkin;                         /* use Galerkin process to compute coarser matrices, 0=no, 1=yes, 2=yes but computed externally */
   PetscBool usedmfornumberoflevels;           /* sets the number of levels by getting this information out of the DM */
+  PetscBool usesingle;                        /* the operators of the coarser levels use single precision values */
 
   PetscInt     nlevels;
   PC_MG_Levels **levels;
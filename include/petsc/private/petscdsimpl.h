@@ -65,6 +65,8 @@ struct _p_PetscDS {
   PetscReal   *x;                      /* Workspace for computing real coordinates */
   PetscScalar *f0, *f1;                /* Point evaluations of weak form residual integrands */
   PetscScalar *g0, *g1, *g2, *g3;      /* Point evaluations of weak form Jacobian integrands */
+  PetscScalar *work;                   /* Workspace of the element integration kernels, grown on demand */
+  PetscInt     Nwork;                  /* The size of work */
   DSBoundary   boundary;               /* Linked list of boundary conditions */
 };
 
@@ -12,6 +12,7 @@ PETSC_EXTERN PetscBool PetscFERegisterAllCalled;
 PETSC_EXTERN PetscErrorCode PetscSpaceRegisterAll(void);
 PETSC_EXTERN PetscErrorCode PetscDualSpaceRegisterAll(void);
 PETSC_EXTERN PetscErrorCode PetscFERegisterAll(void);
+PETSC_EXTERN PetscErrorCode PetscFESetUpIntegration_Internal(PetscFE, PetscDS, PetscDS);
 
 typedef struct _PetscSpaceOps *PetscSpaceOps;
 struct _PetscSpaceOps {
@@ -63,6 +64,7 @@ struct _p_PetscDualSpace {
   PetscInt         order;      /* The approximation order of the space */
   PetscQuadrature *functional; /* The basis of functionals for this space */
   PetscBool        setupcalled;
+  PetscInt         spdim;      /* The dimension of the space, computed on demand, or -1 */
 };
 
 typedef struct {
@@ -90,7 +92,7 @@ struct _PetscFEOps {
   PetscErrorCode (*integrate)(PetscFE, PetscDS, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], PetscDS, const PetscScalar[], PetscReal[]);
   PetscErrorCode (*integrateresidual)(PetscFE, PetscDS, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscScalar[]);
   PetscErrorCode (*integratebdresidual)(PetscFE, PetscDS, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscScalar[]);
-  PetscErrorCode (*integratejacobianaction)(PetscFE, PetscDS, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscReal, PetscScalar[]);
+  PetscErrorCode (*integratejacobianaction)(PetscFE, PetscDS, PetscFEJacobianType, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscReal, PetscScalar[]);
   PetscErrorCode (*integratejacobian)(PetscFE, PetscDS, PetscFEJacobianType, PetscInt, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscReal, PetscScalar[]);
   PetscErrorCode (*integratebdjacobian)(PetscFE, PetscDS, PetscInt, PetscInt, PetscInt, PetscFECellGeom *, const PetscScalar[], const PetscScalar[], PetscDS, const PetscScalar[], PetscReal, PetscReal, PetscScalar[]);
 };
@@ -145,6 +147,16 @@ typedef struct {
   PetscInt     *embedding;      /* Map from subelements dofs to element dofs */
 } PetscFE_Composite;
 
+typedef struct {
+  PetscQuadrature quad;     /* The quadrature for which the 1D factors were computed */
+  PetscBool       isTensor; /* The basis and quadrature factor into identical 1D pieces */
+  PetscInt        n;        /* The number of 1D nodes */
+  PetscInt        nq;       /* The number of 1D quadrature points */
+  PetscReal      *B, *D;    /* The 1D basis and its derivative at the 1D quadrature points, nq x n */
+  PetscInt       *bidx;     /* The lexicographic tensor index of each basis function */
+  PetscInt       *qidx;     /* The lexicographic tensor index of each quadrature point */
+} PetscFE_Tensor;
+
 /* Utility functions */
 #undef __FUNCT__
 #define __FUNCT__ "CoordinatesRefToReal"
@@ -0,0 +1,39 @@
+/*
+   This private file should not be included in users' code.
+   Pack/unpack plans shared by PetscSF and VecScatter.
+*/
+#if !defined(_PETSCSFPACKIMPL_H)
+#define _PETSCSFPACKIMPL_H
+
+#include <petscsys.h>
+
+/*
+   A plan for moving the entries of an index list to and from a contiguous buffer.
+
+   The index list is the concatenation of nmsg messages; it is cut into segments that do not cross
+   messages. A regular segment is an arithmetic progression start, start+stride, ... of indices and
+   is done with memcpy() when its blocks are adjacent in memory, otherwise with a strided loop.
+   An irregular segment indexes through the list. Segments are short enough that they can be
+   distributed among threads.
+*/
+typedef struct _n_PetscSFPackOpt *PetscSFPackOpt;
+struct _n_PetscSFPackOpt {
+  PetscInt       nmsg;
+  PetscInt       *msgseg;   /* segments of message m are msgseg[m] <= s < msgseg[m+1] */
+  PetscInt       nseg;
+  PetscInt       *offset;   /* segment s covers entries offset[s] <= j < offset[s+1] of the list and the buffer */
+  PetscInt       *start;    /* first index of a regular segment */
+  PetscInt       *stride;   /* index stride of a regular segment, 0 for an irregular segment */
+  const PetscInt *idx;      /* the index list, owned by the caller, which must keep it while the plan exists */
+  PetscInt       n;         /* length of the index list */
+  PetscInt       nregular;  /* number of entries in regular segments */
+  PetscBool      unique;    /* no index appears twice, so unpacking may also be split among threads */
+  PetscInt       nthreads;
+};
+
+PETSC_INTERN PetscErrorCode PetscSFPackOptCreate(PetscInt,const PetscInt[],const PetscInt[],PetscInt,PetscSFPackOpt*);
+PETSC_INTERN PetscErrorCode PetscSFPackOptDestroy(PetscSFPackOpt*);
+PETSC_INTERN PetscErrorCode PetscSFPackOptPack(PetscSFPackOpt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscScalar*,PetscScalar*);
+PETSC_INTERN PetscErrorCode PetscSFPackOptUnpack(PetscSFPackOpt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscScalar*,PetscScalar*,InsertMode);
+
+#endif
@@ -10,6 +10,7 @@
 
 #include <petscvec.h>
 #include <petsc/private/petscimpl.h>
+#include <petsc/private/sfpackimpl.h>
 #include <petscviewer.h>
 
 PETSC_EXTERN PetscBool VecRegisterAllCalled;
@@ -93,6 +94,7 @@ struct _VecOps {
   PetscErrorCode (*restorelocalvector)(Vec,Vec);
   PetscErrorCode (*getlocalvectorread)(Vec,Vec);
   PetscErrorCode (*restorelocalvectorread)(Vec,Vec);
+  PetscErrorCode (*mdotnorm)(Vec,PetscInt,const Vec[],PetscScalar*,PetscReal*);
 };
 
 /*
@@ -150,7 +152,7 @@ struct _p_Vec {
 };
 
 PETSC_EXTERN PetscLogEvent VEC_SetRandom;
-PETSC_EXTERN PetscLogEvent VEC_View, VEC_Max, VEC_Min, VEC_DotBarrier, VEC_Dot, VEC_MDotBarrier, VEC_MDot, VEC_TDot, VEC_MTDot;
+PETSC_EXTERN PetscLogEvent VEC_View, VEC_Max, VEC_Min, VEC_DotBarrier, VEC_Dot, VEC_MDotBarrier, VEC_MDot, VEC_MDotNorm, VEC_TDot, VEC_MTDot;
 PETSC_EXTERN PetscLogEvent VEC_Norm, VEC_Normalize, VEC_Scale, VEC_Copy, VEC_Set, VEC_AXPY, VEC_AYPX, VEC_WAXPY, VEC_MAXPY;
 PETSC_EXTERN PetscLogEvent VEC_AssemblyEnd, VEC_PointwiseMult, VEC_SetValues, VEC_Load, VEC_ScatterBarrier, VEC_ScatterBegin, VEC_ScatterEnd;
 PETSC_EXTERN PetscLogEvent VEC_ReduceArithmetic, VEC_ReduceBarrier, VEC_ReduceCommunication;
@@ -188,6 +190,7 @@ PETSC_EXTERN PetscErrorCode VecCUDACopyFromGPU(Vec v);
 PETSC_EXTERN PetscErrorCode VecDuplicateVecs_Default(Vec,PetscInt,Vec *[]);
 PETSC_EXTERN PetscErrorCode VecDestroyVecs_Default(PetscInt,Vec []);
 PETSC_INTERN PetscErrorCode VecLoad_Binary(Vec, PetscViewer);
+PETSC_INTERN PetscErrorCode VecView_Binary_Mmap(Vec,PetscViewer);
 PETSC_EXTERN PetscErrorCode VecLoad_Default(Vec, PetscViewer);
 
 PETSC_EXTERN PetscInt  NormIds[7];  /* map from NormType to IDs used to cache/retreive values of norms */
@@ -276,6 +279,14 @@ typedef struct {
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
   MPI_Win                window;
   PetscInt               *winstarts;    /* displacements in the processes I am putting to */
+#endif
+  PetscSFPackOpt         packopt;       /* plan for packing (the to side) or unpacking (the from side) values, may be NULL */
+  /* for MPI_Neighbor_alltoallv() approach */
+  PetscBool              use_neighbor;
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  MPI_Comm               neighborcomm;  /* graph communicator whose destinations are procs, used when this side sends */
+  PetscMPIInt            *ncounts,*ndispls; /* message lengths and offsets in values for each process in procs */
+  MPI_Request            nrequest;      /* nonblocking or persistent neighborhood exchange started when this side sends */
 #endif
 } VecScatter_MPI_General;
 
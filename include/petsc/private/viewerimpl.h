@@ -31,6 +31,16 @@ struct _p_PetscViewer {
   PetscBool         setupcalled;
 };
 
+/*
+   The objects written with PetscViewerBinarySetUseMmap() start with a header of 16 PetscInt64: this magic number,
+   the version, the classid, sizeof(PetscInt), sizeof(PetscScalar), then numbers that depend on the object.
+   Their arrays start on boundaries of PETSC_VIEWER_BINARY_MMAP_ALIGN bytes.
+*/
+#define PETSC_VIEWER_BINARY_MMAP_MAGIC   0x50414d4d53544550LL  /* "PETSMMAP" on little-endian machines */
+#define PETSC_VIEWER_BINARY_MMAP_VERSION 1
+#define PETSC_VIEWER_BINARY_MMAP_ALIGN   64
+#define PetscViewerBinaryMmapAlign(off)  ((((off)+PETSC_VIEWER_BINARY_MMAP_ALIGN-1)/PETSC_VIEWER_BINARY_MMAP_ALIGN)*PETSC_VIEWER_BINARY_MMAP_ALIGN)
+
 
 
 #endif
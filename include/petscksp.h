@@ -47,6 +47,7 @@ typedef const char* KSPType;
 #define   KSPFGMRES     "fgmres"
 #define   KSPLGMRES     "lgmres"
 #define   KSPDGMRES     "dgmres"
+#define   KSPGCRODR     "gcrodr"
 #define   KSPPGMRES     "pgmres"
 #define KSPTCQMR      "tcqmr"
 #define KSPBCGS       "bcgs"
@@ -71,6 +72,8 @@ typedef const char* KSPType;
 #define KSPTSIRM      "tsirm"
 #define KSPCGLS       "cgls"
 #define KSPFETIDP     "fetidp"
+#define KSPSGMRES     "sgmres"
+#define KSPSCG        "scg"
 
 /* Logging support */
 PETSC_EXTERN PetscClassId KSP_CLASSID;
@@ -83,6 +86,7 @@ PETSC_EXTERN PetscErrorCode KSPSetUp(KSP);
 PETSC_EXTERN PetscErrorCode KSPSetUpOnBlocks(KSP);
 PETSC_EXTERN PetscErrorCode KSPSolve(KSP,Vec,Vec);
 PETSC_EXTERN PetscErrorCode KSPSolveTranspose(KSP,Vec,Vec);
+PETSC_EXTERN PetscErrorCode KSPMatSolve(KSP,Mat,Mat);
 PETSC_EXTERN PetscErrorCode KSPReset(KSP);
 PETSC_EXTERN PetscErrorCode KSPDestroy(KSP*);
 PETSC_EXTERN PetscErrorCode KSPSetReusePreconditioner(KSP,PetscBool);
@@ -207,6 +211,9 @@ PETSC_EXTERN PetscErrorCode KSPGMRESClassicalGramSchmidtOrthogonalization(KSP,Pe
 PETSC_EXTERN PetscErrorCode KSPLGMRESSetAugDim(KSP,PetscInt);
 PETSC_EXTERN PetscErrorCode KSPLGMRESSetConstant(KSP);
 
+PETSC_EXTERN PetscErrorCode KSPGCRODRSetRecycle(KSP,PetscInt);
+PETSC_EXTERN PetscErrorCode KSPGCRODRGetRecycle(KSP,PetscInt*);
+
 PETSC_EXTERN PetscErrorCode KSPPIPEFGMRESSetShift(KSP,PetscScalar);
 
 PETSC_EXTERN PetscErrorCode KSPGCRSetRestart(KSP,PetscInt);
@@ -610,6 +617,20 @@ PETSC_EXTERN const char *const KSPCGTypes[];
 PETSC_EXTERN PetscErrorCode KSPCGSetType(KSP,KSPCGType);
 PETSC_EXTERN PetscErrorCode KSPCGUseSingleReduction(KSP,PetscBool );
 
+/*E
+    KSPSStepBasisType - The polynomial basis used by the s-step methods KSPSGMRES and KSPSCG
+
+   Level: advanced
+
+.seealso: KSPSStepSetBasis(), KSPSGMRES, KSPSCG
+E*/
+typedef enum {KSP_SSTEP_BASIS_MONOMIAL,KSP_SSTEP_BASIS_NEWTON,KSP_SSTEP_BASIS_CHEBYSHEV} KSPSStepBasisType;
+PETSC_EXTERN const char *const KSPSStepBasisTypes[];
+
+PETSC_EXTERN PetscErrorCode KSPSStepSetBasis(KSP,PetscInt,KSPSStepBasisType);
+PETSC_EXTERN PetscErrorCode KSPSStepGetBasis(KSP,PetscInt*,KSPSStepBasisType*);
+PETSC_EXTERN PetscErrorCode KSPSStepSetUseMatrixPowers(KSP,PetscBool);
+
 PETSC_EXTERN PetscErrorCode KSPNASHSetRadius(KSP,PetscReal);
 PETSC_EXTERN PetscErrorCode KSPNASHGetNormD(KSP,PetscReal *);
 PETSC_EXTERN PetscErrorCode KSPNASHGetObjFcn(KSP,PetscReal *);
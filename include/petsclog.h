@@ -228,6 +228,7 @@ PETSC_EXTERN PetscErrorCode PetscLogDefaultBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogAllBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogNestedBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogTraceBegin(FILE *);
+PETSC_EXTERN PetscErrorCode PetscLogChromeBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogActions(PetscBool);
 PETSC_EXTERN PetscErrorCode PetscLogObjects(PetscBool);
 /* General functions */
@@ -239,6 +240,7 @@ PETSC_EXTERN PetscErrorCode PetscLogObjectState(PetscObject, const char[], ...);
 PETSC_EXTERN PetscErrorCode PetscLogView(PetscViewer);
 PETSC_EXTERN PetscErrorCode PetscLogViewFromOptions(void);
 PETSC_EXTERN PetscErrorCode PetscLogDump(const char[]);
+PETSC_EXTERN PetscErrorCode PetscLogChromeDump(const char[]);
 
 PETSC_EXTERN PetscErrorCode PetscGetFlops(PetscLogDouble *);
 
@@ -294,6 +296,7 @@ PETSC_EXTERN PetscLogDouble petsc_sum_of_waits_ct;
 
 PETSC_EXTERN PetscErrorCode PetscLogEventGetFlops(PetscLogEvent, PetscLogDouble*);
 PETSC_EXTERN PetscErrorCode PetscLogEventZeroFlops(PetscLogEvent);
+PETSC_EXTERN PetscErrorCode PetscLogEventAddTime(PetscLogEvent,PetscLogDouble);
 
 /*
      These are used internally in the PETSc routines to keep a count of MPI messages and
@@ -434,6 +437,7 @@ PETSC_STATIC_INLINE int PetscMPIParallelComm(MPI_Comm comm)
 #define PetscLogEventEnd(e,o1,o2,o3,o4)     0
 #define PetscLogEventBarrierBegin(e,o1,o2,o3,o4,cm) 0
 #define PetscLogEventBarrierEnd(e,o1,o2,o3,o4,cm)   0
+#define PetscLogEventAddTime(e,t)           0
 #define PetscLogObjectParents(p,n,c)        0
 #define PetscLogObjectCreate(h)             0
 #define PetscLogObjectDestroy(h)            0
@@ -446,10 +450,12 @@ PETSC_STATIC_INLINE int PetscMPIParallelComm(MPI_Comm comm)
 #define PetscLogViewFromOptions()           0
 #define PetscLogDefaultBegin()                     0
 #define PetscLogTraceBegin(file)            0
+#define PetscLogChromeBegin()               0
 #define PetscLogSet(lb,le)                  0
 #define PetscLogAllBegin()                  0
 #define PetscLogNestedBegin()               0
 #define PetscLogDump(c)                     0
+#define PetscLogChromeDump(c)               0
 #define PetscLogEventRegister(a,b,c)        0
 #define PetscLogObjects(a)                  0
 #define PetscLogActions(a)                  0
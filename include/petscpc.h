@@ -87,6 +87,7 @@ PETSC_EXTERN PetscErrorCode PCSORSetOmega(PC,PetscReal);
 PETSC_EXTERN PetscErrorCode PCSORGetOmega(PC,PetscReal*);
 PETSC_EXTERN PetscErrorCode PCSORSetIterations(PC,PetscInt,PetscInt);
 PETSC_EXTERN PetscErrorCode PCSORGetIterations(PC,PetscInt*,PetscInt*);
+PETSC_EXTERN PetscErrorCode PCSORSetMulticolor(PC,PetscBool);
 
 PETSC_EXTERN PetscErrorCode PCEisenstatSetOmega(PC,PetscReal);
 PETSC_EXTERN PetscErrorCode PCEisenstatGetOmega(PC,PetscReal*);
@@ -133,6 +134,7 @@ PETSC_EXTERN PetscErrorCode PCFactorGetUseInPlace(PC,PetscBool*);
 PETSC_EXTERN PetscErrorCode PCFactorSetAllowDiagonalFill(PC,PetscBool);
 PETSC_EXTERN PetscErrorCode PCFactorGetAllowDiagonalFill(PC,PetscBool*);
 PETSC_EXTERN PetscErrorCode PCFactorSetPivotInBlocks(PC,PetscBool);
+PETSC_EXTERN PetscErrorCode PCFactorSetUseSinglePrecision(PC,PetscBool);
 
 PETSC_EXTERN PetscErrorCode PCFactorSetLevels(PC,PetscInt);
 PETSC_EXTERN PetscErrorCode PCFactorGetLevels(PC,PetscInt*);
@@ -263,6 +265,7 @@ PETSC_EXTERN PetscErrorCode PCGAMGSetNSmooths(PC,PetscInt);
 PETSC_EXTERN PetscErrorCode PCGAMGSetSymGraph(PC,PetscBool);
 PETSC_EXTERN PetscErrorCode PCGAMGSetSquareGraph(PC,PetscInt);
 PETSC_EXTERN PetscErrorCode PCGAMGSetReuseInterpolation(PC,PetscBool);
+PETSC_EXTERN PetscErrorCode PCGAMGSetReuseCoarsening(PC,PetscBool);
 PETSC_EXTERN PetscErrorCode PCGAMGFinalizePackage(void);
 PETSC_EXTERN PetscErrorCode PCGAMGInitializePackage(void);
 PETSC_EXTERN PetscErrorCode PCGAMGRegister(PCGAMGType,PetscErrorCode (*)(PC));
@@ -307,6 +310,7 @@ PETSC_EXTERN PetscErrorCode PCMGSetCyclesOnLevel(PC,PetscInt,PetscInt);
 PETSC_EXTERN PetscErrorCode PCMGMultiplicativeSetCycles(PC,PetscInt);
 PETSC_EXTERN PetscErrorCode PCMGSetGalerkin(PC,PetscBool);
 PETSC_EXTERN PetscErrorCode PCMGGetGalerkin(PC,PetscBool*);
+PETSC_EXTERN PetscErrorCode PCMGSetUseSinglePrecision(PC,PetscBool);
 
 PETSC_EXTERN PetscErrorCode PCMGSetRhs(PC,PetscInt,Vec);
 PETSC_EXTERN PetscErrorCode PCMGSetX(PC,PetscInt,Vec);
@@ -1438,6 +1438,12 @@ PETSC_EXTERN PetscErrorCode PetscMallocSetDumpLog(void);
 PETSC_EXTERN PetscErrorCode PetscMallocSetDumpLogThreshold(PetscLogDouble);
 PETSC_EXTERN PetscErrorCode PetscMallocGetDumpLog(PetscBool*);
 
+/*
+   Pooled memory allocation, see PetscMallocUsePool()
+*/
+PETSC_EXTERN PetscErrorCode PetscMallocUsePool(void);
+PETSC_EXTERN PetscErrorCode PetscMallocPoolGetUsage(PetscLogDouble*,PetscLogDouble*,PetscLogDouble*);
+
 /*E
     PetscDataType - Used for handling different basic data types.
 
@@ -2721,6 +2727,9 @@ E*/
 typedef enum {PETSC_BINARY_SEEK_SET = 0,PETSC_BINARY_SEEK_CUR = 1,PETSC_BINARY_SEEK_END = 2} PetscBinarySeekType;
 PETSC_EXTERN PetscErrorCode PetscBinarySeek(int,off_t,PetscBinarySeekType,off_t*);
 PETSC_EXTERN PetscErrorCode PetscBinarySynchronizedSeek(MPI_Comm,int,off_t,PetscBinarySeekType,off_t*);
+PETSC_EXTERN PetscErrorCode PetscBinaryWriteAt(int,const void*,size_t,off_t);
+PETSC_EXTERN PetscErrorCode PetscBinaryMap(int,off_t,size_t,void**);
+PETSC_EXTERN PetscErrorCode PetscBinaryUnmap(void*,size_t);
 PETSC_EXTERN PetscErrorCode PetscByteSwap(void *,PetscDataType,PetscInt);
 
 PETSC_EXTERN PetscErrorCode PetscSetDebugTerminal(const char[]);
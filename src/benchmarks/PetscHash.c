@@ -0,0 +1,82 @@
+
+static char help[] = "Compares PetscTable with PetscHMapI for the pattern of MatSetUpMultiply_MPIAIJ():\n\
+the off-process column indices are added once each, then looked up many times.\n\
+  -n <n> : number of distinct keys\n\
+  -m <m> : number of lookups\n\
+  -N <N> : keys are taken from [0,N)\n\n";
+
+#include <petscsys.h>
+#include <petscctable.h>
+#include <petsctime.h>
+#include <../src/sys/utils/hash.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscInt           n = 100000,m = 2000000,N = 100000000,i,key,val,sum1 = 0,sum2 = 0,*keys,*lookup;
+  PetscLogDouble     t0,t1,t2,t3,t4,t5,t6,t7;
+  PetscTable         table;
+  PetscTablePosition pos;
+  PetscHMapI         map;
+  PetscHashIter      it;
+  PetscBool          missing;
+  PetscErrorCode     ierr;
+
+  ierr = PetscInitialize(&argc,&argv,0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-N",&N,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc2(n,&keys,m,&lookup);CHKERRQ(ierr);
+  /* keys spread over [0,N) with a regular stride and some scatter, as the ghost columns of a mesh */
+  for (i=0; i<n; i++) keys[i] = (PetscInt)(((unsigned long long)i*(N/n) + ((unsigned long long)i*2654435761ULL)%(N/n ? N/n : 1))%N);
+  for (i=0; i<m; i++) lookup[i] = keys[(PetscInt)(((unsigned long long)i*40503ULL)%n)];
+
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  ierr = PetscTableCreate(n,N+1,&table);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    ierr = PetscTableFind(table,keys[i]+1,&val);CHKERRQ(ierr);
+    if (!val) {ierr = PetscTableAdd(table,keys[i]+1,i+1,INSERT_VALUES);CHKERRQ(ierr);}
+  }
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    ierr  = PetscTableFind(table,lookup[i]+1,&val);CHKERRQ(ierr);
+    sum1 += val-1;
+  }
+  ierr = PetscTime(&t2);CHKERRQ(ierr);
+  ierr = PetscTableGetHeadPosition(table,&pos);CHKERRQ(ierr);
+  while (pos) {
+    ierr  = PetscTableGetNext(table,&pos,&key,&val);CHKERRQ(ierr);
+    sum1 += key;
+  }
+  ierr = PetscTime(&t3);CHKERRQ(ierr);
+  ierr = PetscTableDestroy(&table);CHKERRQ(ierr);
+
+  ierr = PetscTime(&t4);CHKERRQ(ierr);
+  ierr = PetscHMapICreate(&map);CHKERRQ(ierr);
+  ierr = PetscHMapIResize(map,n);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    ierr = PetscHMapIQuerySet(map,keys[i],i,&missing);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t5);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    ierr  = PetscHMapIGet(map,lookup[i],&val);CHKERRQ(ierr);
+    sum2 += val;
+  }
+  ierr = PetscTime(&t6);CHKERRQ(ierr);
+  PetscHashIterBegin(map,it);
+  while (!PetscHashIterAtEnd(map,it)) {
+    PetscHashIterGetKey(map,it,key);
+    sum2 += key+1;
+    PetscHashIterNext(map,it);
+  }
+  ierr = PetscTime(&t7);CHKERRQ(ierr);
+  ierr = PetscHMapIDestroy(&map);CHKERRQ(ierr);
+  if (sum1 != sum2) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"PetscTable and PetscHMapI disagree: %D %D",sum1,sum2);
+
+  fprintf(stdout,"%-15s : insert %e lookup %e iterate %e sec per entry\n","PetscTable",(t1-t0)/n,(t2-t1)/m,(t3-t2)/n);
+  fprintf(stdout,"%-15s : insert %e lookup %e iterate %e sec per entry\n","PetscHMapI",(t5-t4)/n,(t6-t5)/m,(t7-t6)/n);
+  ierr = PetscFree2(keys,lookup);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
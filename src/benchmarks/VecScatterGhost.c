@@ -0,0 +1,65 @@
+
+static char help[] = "Times a ghost point exchange done with VecScatter.\n\
+Each process needs -nghost entries from each of its -nneighbors neighbors on either side.\n\
+Compare the default with -vecscatter_alltoall, -vecscatter_window and -vecscatter_neighbor.\n\n";
+
+#include <petscvec.h>
+#include <petsctime.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  Vec            x,y;
+  IS             ix;
+  VecScatter     ctx;
+  PetscLogDouble t1 = 0.0,t2 = 0.0;
+  PetscMPIInt    rank,size;
+  PetscInt       n = 10000,nghost = 100,nneighbors = 2,its = 1000,i,j,k,cnt = 0,*idx;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nghost",&nghost,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nneighbors",&nneighbors,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-its",&its,NULL);CHKERRQ(ierr);
+  nneighbors = PetscMin(nneighbors,(size-1)/2);
+  nghost     = PetscMin(nghost,n);
+
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,n,PETSC_DETERMINE,&x);CHKERRQ(ierr);
+  ierr = VecSet(x,1.0);CHKERRQ(ierr);
+
+  /* the first nghost entries of the nneighbors processes on either side, periodically */
+  ierr = PetscMalloc1(2*nneighbors*nghost,&idx);CHKERRQ(ierr);
+  for (k=-nneighbors; k<=nneighbors; k++) {
+    if (!k) continue;
+    j = (rank+k+size)%size;
+    for (i=0; i<nghost; i++) idx[cnt++] = j*n+i;
+  }
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,cnt,idx,PETSC_OWN_POINTER,&ix);CHKERRQ(ierr);
+  ierr = VecCreateSeq(PETSC_COMM_SELF,cnt,&y);CHKERRQ(ierr);
+  ierr = VecScatterCreate(x,ix,y,NULL,&ctx);CHKERRQ(ierr);
+
+  PetscPreLoadBegin(PETSC_TRUE,"VecScatter");
+  ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  for (i=0; i<its; i++) {
+    ierr = VecScatterBegin(ctx,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(ctx,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterBegin(ctx,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+    ierr = VecScatterEnd(ctx,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t2);CHKERRQ(ierr);
+  PetscPreLoadEnd();
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"VecScatter ghost exchange, %D neighbors with %D entries each:\n",2*nneighbors,nghost);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD," Time per forward and reverse scatter %g\n",(t2-t1)/its);CHKERRQ(ierr);
+
+  ierr = VecScatterDestroy(&ctx);CHKERRQ(ierr);
+  ierr = ISDestroy(&ix);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
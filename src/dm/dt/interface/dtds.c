@@ -363,6 +363,8 @@ static PetscErrorCode PetscDSDestroyStructs_Static(PetscDS prob)
   ierr = PetscFree4(prob->basis,prob->basisDer,prob->basisBd,prob->basisDerBd);CHKERRQ(ierr);
   ierr = PetscFree5(prob->u,prob->u_t,prob->u_x,prob->x,prob->refSpaceDer);CHKERRQ(ierr);
   ierr = PetscFree6(prob->f0,prob->f1,prob->g0,prob->g1,prob->g2,prob->g3);CHKERRQ(ierr);
+  ierr = PetscFree(prob->work);CHKERRQ(ierr);
+  prob->Nwork = 0;
   PetscFunctionReturn(0);
 }
 
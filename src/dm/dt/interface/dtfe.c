@@ -35,6 +35,7 @@ We will have three objects:
  - FEM: This keeps {P, P', Q}
 */
 #include <petsc/private/petscfeimpl.h> /*I "petscfe.h" I*/
+#include <petsc/private/petscdsimpl.h>
 #include <petsc/private/dtimpl.h>
 #include <petsc/private/dmpleximpl.h> /* For CellRefiner */
 #include <petscdmshell.h>
@@ -1135,6 +1136,7 @@ PetscErrorCode PetscDualSpaceSetType(PetscDualSpace sp, PetscDualSpaceType name)
   }
   ierr = (*r)(sp);CHKERRQ(ierr);
   ierr = PetscObjectChangeTypeName((PetscObject) sp, name);CHKERRQ(ierr);
+  sp->spdim = -1;
   PetscFunctionReturn(0);
 }
 
@@ -1274,6 +1276,7 @@ PetscErrorCode PetscDualSpaceSetUp(PetscDualSpace sp)
   if (sp->setupcalled) PetscFunctionReturn(0);
   sp->setupcalled = PETSC_TRUE;
   if (sp->ops->setup) {ierr = (*sp->ops->setup)(sp);CHKERRQ(ierr);}
+  sp->spdim = -1;
   PetscFunctionReturn(0);
 }
 
@@ -1347,6 +1350,7 @@ PetscErrorCode PetscDualSpaceCreate(MPI_Comm comm, PetscDualSpace *sp)
 
   s->order = 0;
   s->setupcalled = PETSC_FALSE;
+  s->spdim = -1;
 
   *sp = s;
   PetscFunctionReturn(0);
@@ -1430,7 +1434,8 @@ PetscErrorCode PetscDualSpaceSetDM(PetscDualSpace sp, DM dm)
   PetscValidHeaderSpecific(dm, DM_CLASSID, 2);
   ierr = DMDestroy(&sp->dm);CHKERRQ(ierr);
   ierr = PetscObjectReference((PetscObject) dm);CHKERRQ(ierr);
-  sp->dm = dm;
+  sp->dm    = dm;
+  sp->spdim = -1;
   PetscFunctionReturn(0);
 }
 
@@ -1480,6 +1485,7 @@ PetscErrorCode PetscDualSpaceSetOrder(PetscDualSpace sp, PetscInt order)
   PetscFunctionBegin;
   PetscValidHeaderSpecific(sp, PETSCDUALSPACE_CLASSID, 1);
   sp->order = order;
+  sp->spdim = -1;
   PetscFunctionReturn(0);
 }
 
@@ -1539,8 +1545,12 @@ PetscErrorCode PetscDualSpaceGetDimension(PetscDualSpace sp, PetscInt *dim)
   PetscFunctionBegin;
   PetscValidHeaderSpecific(sp, PETSCDUALSPACE_CLASSID, 1);
   PetscValidPointer(dim, 2);
-  *dim = 0;
-  if (sp->ops->getdimension) {ierr = (*sp->ops->getdimension)(sp, dim);CHKERRQ(ierr);}
+  /* The dimension is kept, since computing it may query the reference cell, which allocates */
+  if (sp->spdim < 0) {
+    sp->spdim = 0;
+    if (sp->ops->getdimension) {ierr = (*sp->ops->getdimension)(sp, &sp->spdim);CHKERRQ(ierr);}
+  }
+  *dim = sp->spdim;
   PetscFunctionReturn(0);
 }
 
@@ -2399,6 +2409,7 @@ PetscErrorCode PetscDualSpaceSimpleSetDimension(PetscDualSpace sp, PetscInt dim)
   PetscValidHeaderSpecific(sp, PETSCDUALSPACE_CLASSID, 1);
   PetscValidLogicalCollectiveInt(sp, dim, 2);
   ierr = PetscTryMethod(sp, "PetscDualSpaceSimpleSetDimension_C", (PetscDualSpace,PetscInt),(sp,dim));CHKERRQ(ierr);
+  sp->spdim = -1;
   PetscFunctionReturn(0);
 }
 
@@ -5561,6 +5572,795 @@ PetscErrorCode PetscFECompositeGetMapping(PetscFE fem, PetscInt *numSubelements,
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorReset_Private"
+static PetscErrorCode PetscFETensorReset_Private(PetscFE_Tensor *t)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscQuadratureDestroy(&t->quad);CHKERRQ(ierr);
+  ierr = PetscFree4(t->B, t->D, t->bidx, t->qidx);CHKERRQ(ierr);
+  t->isTensor = PETSC_FALSE;
+  t->n        = 0;
+  t->nq       = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEDestroy_Tensor"
+PetscErrorCode PetscFEDestroy_Tensor(PetscFE fem)
+{
+  PetscFE_Tensor *t = (PetscFE_Tensor *) fem->data;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFETensorReset_Private(t);CHKERRQ(ierr);
+  ierr = PetscFree(t);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEView_Tensor"
+PetscErrorCode PetscFEView_Tensor(PetscFE fem, PetscViewer viewer)
+{
+  PetscFE_Tensor *t = (PetscFE_Tensor *) fem->data;
+  PetscBool       iascii;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(fem, PETSCFE_CLASSID, 1);
+  PetscValidHeaderSpecific(viewer, PETSC_VIEWER_CLASSID, 2);
+  ierr = PetscObjectTypeCompare((PetscObject) viewer, PETSCVIEWERASCII, &iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer, "Tensor Product Finite Element:\n");CHKERRQ(ierr);
+    if (t->isTensor) {ierr = PetscViewerASCIIPrintf(viewer, "  1D nodes: %D 1D quad points: %D cells per block: %D\n", t->n, t->nq, PetscMax(fem->numBlocks, 1));CHKERRQ(ierr);}
+    ierr = PetscFEView_Basic_Ascii(fem, viewer);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorUnique_Private"
+/* Sorts the values and removes duplicates up to roundoff */
+static PetscErrorCode PetscFETensorUnique_Private(PetscInt *n, PetscReal x[])
+{
+  PetscInt       i, m = 0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSortReal(*n, x);CHKERRQ(ierr);
+  for (i = 0; i < *n; ++i) if (!m || x[i] - x[m-1] > PETSC_SQRT_MACHINE_EPSILON) x[m++] = x[i];
+  *n = m;
+  PetscFunctionReturn(0);
+}
+
+/* Returns the lexicographic index of the point on the tensor grid of the 1D points x1[], with the first direction fastest, or -1 if it is not on the grid */
+PETSC_STATIC_INLINE PetscInt PetscFETensorIndex_Private(PetscInt dim, PetscInt n, const PetscReal x1[], const PetscReal pt[])
+{
+  PetscInt d, i, idx = 0, stride = 1;
+
+  for (d = 0; d < dim; ++d, stride *= n) {
+    for (i = 0; i < n; ++i) if (PetscAbsReal(pt[d] - x1[i]) < PETSC_SQRT_MACHINE_EPSILON) break;
+    if (i == n) return -1;
+    idx += i*stride;
+  }
+  return idx;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorSetUpData_Private"
+/*
+  Factors the nodal basis and the quadrature into 1D pieces. The nodes of the dual space and the quadrature points must lie on
+  tensor grids, and the product of the 1D Lagrange polynomials must reproduce the full tabulation, otherwise the basic kernels are used.
+*/
+static PetscErrorCode PetscFETensorSetUpData_Private(PetscFE fem)
+{
+  PetscFE_Tensor  *t = (PetscFE_Tensor *) fem->data;
+  const PetscReal *qpoints;
+  PetscReal       *x1 = NULL, *xq = NULL, *Bf, *Df;
+  PetscBT          seen;
+  PetscInt         dim, qdim, Nb, Nc, Nq, n, nq, j, q, d, e, i, a, k, m;
+  PetscBool        isTensor = PETSC_TRUE;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFETensorReset_Private(t);CHKERRQ(ierr);
+  if (!fem->quadrature) PetscFunctionReturn(0);
+  ierr = PetscObjectReference((PetscObject) fem->quadrature);CHKERRQ(ierr);
+  t->quad = fem->quadrature;
+  ierr = PetscFEGetSpatialDimension(fem, &dim);CHKERRQ(ierr);
+  ierr = PetscFEGetDimension(fem, &Nb);CHKERRQ(ierr);
+  ierr = PetscFEGetNumComponents(fem, &Nc);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(fem->quadrature, &qdim, &Nq, &qpoints, NULL);CHKERRQ(ierr);
+  if (dim < 1 || qdim != dim) isTensor = PETSC_FALSE;
+  /* The 1D nodes and quadrature points are the distinct values of the first coordinate */
+  ierr = PetscMalloc2(Nb, &x1, Nq, &xq);CHKERRQ(ierr);
+  for (j = 0; isTensor && j < Nb; ++j) {
+    PetscQuadrature  f;
+    const PetscReal *points;
+    PetscInt         np;
+
+    ierr = PetscDualSpaceGetFunctional(fem->dualSpace, j, &f);CHKERRQ(ierr);
+    ierr = PetscQuadratureGetData(f, NULL, &np, &points, NULL);CHKERRQ(ierr);
+    if (np != 1) isTensor = PETSC_FALSE;
+    else x1[j] = points[0];
+  }
+  for (q = 0; isTensor && q < Nq; ++q) xq[q] = qpoints[q*dim];
+  n  = Nb;
+  nq = Nq;
+  if (isTensor) {
+    ierr = PetscFETensorUnique_Private(&n, x1);CHKERRQ(ierr);
+    ierr = PetscFETensorUnique_Private(&nq, xq);CHKERRQ(ierr);
+    if (PetscPowInt(n, dim) != Nb || PetscPowInt(nq, dim) != Nq) isTensor = PETSC_FALSE;
+  }
+  if (isTensor) {
+    ierr = PetscMalloc4(nq*n, &t->B, nq*n, &t->D, Nb, &t->bidx, Nq, &t->qidx);CHKERRQ(ierr);
+    t->n  = n;
+    t->nq = nq;
+    ierr = PetscBTCreate(PetscMax(Nb, Nq), &seen);CHKERRQ(ierr);
+    for (j = 0; isTensor && j < Nb; ++j) {
+      PetscQuadrature  f;
+      const PetscReal *points;
+
+      ierr = PetscDualSpaceGetFunctional(fem->dualSpace, j, &f);CHKERRQ(ierr);
+      ierr = PetscQuadratureGetData(f, NULL, NULL, &points, NULL);CHKERRQ(ierr);
+      t->bidx[j] = PetscFETensorIndex_Private(dim, n, x1, points);
+      if (t->bidx[j] < 0 || PetscBTLookupSet(seen, t->bidx[j])) isTensor = PETSC_FALSE;
+    }
+    ierr = PetscBTMemzero(PetscMax(Nb, Nq), seen);CHKERRQ(ierr);
+    for (q = 0; isTensor && q < Nq; ++q) {
+      t->qidx[q] = PetscFETensorIndex_Private(dim, nq, xq, &qpoints[q*dim]);
+      if (t->qidx[q] < 0 || PetscBTLookupSet(seen, t->qidx[q])) isTensor = PETSC_FALSE;
+    }
+    ierr = PetscBTDestroy(&seen);CHKERRQ(ierr);
+  }
+  if (isTensor) {
+    /* Tabulate the 1D Lagrange polynomials and their derivatives */
+    for (a = 0; a < nq; ++a) {
+      for (i = 0; i < n; ++i) {
+        PetscReal b = 1.0, der = 0.0;
+
+        for (m = 0; m < n; ++m) if (m != i) b *= (xq[a] - x1[m])/(x1[i] - x1[m]);
+        for (k = 0; k < n; ++k) {
+          PetscReal p;
+
+          if (k == i) continue;
+          p = 1.0/(x1[i] - x1[k]);
+          for (m = 0; m < n; ++m) if (m != i && m != k) p *= (xq[a] - x1[m])/(x1[i] - x1[m]);
+          der += p;
+        }
+        t->B[a*n+i] = b;
+        t->D[a*n+i] = der;
+      }
+    }
+    /* Check the factorization against the full tabulation */
+    ierr = PetscFEGetDefaultTabulation(fem, &Bf, &Df, NULL);CHKERRQ(ierr);
+    for (q = 0; isTensor && q < Nq; ++q) {
+      for (j = 0; isTensor && j < Nb; ++j) {
+        PetscReal val = 1.0, tol = PETSC_SQRT_MACHINE_EPSILON;
+
+        for (d = 0, i = t->bidx[j], a = t->qidx[q]; d < dim; ++d, i /= n, a /= nq) val *= t->B[(a%nq)*n + i%n];
+        if (PetscAbsReal(val - Bf[(q*Nb+j)*Nc]) > tol*PetscMax(1.0, PetscAbsReal(Bf[(q*Nb+j)*Nc]))) isTensor = PETSC_FALSE;
+        for (e = 0; isTensor && e < dim; ++e) {
+          const PetscReal der = Df[((q*Nb+j)*Nc)*dim+e];
+
+          val = 1.0;
+          for (d = 0, i = t->bidx[j], a = t->qidx[q]; d < dim; ++d, i /= n, a /= nq) val *= d == e ? t->D[(a%nq)*n + i%n] : t->B[(a%nq)*n + i%n];
+          if (PetscAbsReal(val - der) > tol*PetscMax(1.0, PetscAbsReal(der))) isTensor = PETSC_FALSE;
+        }
+      }
+    }
+  }
+  ierr = PetscFree2(x1, xq);CHKERRQ(ierr);
+  t->isTensor = isTensor;
+  if (isTensor) {ierr = PetscInfo3(fem, "Sum factorization with %D 1D nodes and %D 1D quadrature points in dimension %D\n", n, nq, dim);CHKERRQ(ierr);}
+  else          {ierr = PetscInfo(fem, "The space is not a tensor product, using the basic kernels\n");CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorGetData_Private"
+/* Returns the 1D factors if fem is a tensor element whose space factors, otherwise NULL */
+static PetscErrorCode PetscFETensorGetData_Private(PetscFE fem, PetscFE_Tensor **t)
+{
+  PetscBool      isTensor;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *t   = NULL;
+  ierr = PetscObjectTypeCompare((PetscObject) fem, PETSCFETENSOR, &isTensor);CHKERRQ(ierr);
+  if (!isTensor) PetscFunctionReturn(0);
+  if (((PetscFE_Tensor *) fem->data)->quad != fem->quadrature) {ierr = PetscFETensorSetUpData_Private(fem);CHKERRQ(ierr);}
+  if (((PetscFE_Tensor *) fem->data)->isTensor) *t = (PetscFE_Tensor *) fem->data;
+  PetscFunctionReturn(0);
+}
+
+/*
+  Applies the 1D operator A (nout x nin), or A^T stored as nin x nout, along one direction of a tensor stored as [npost][nin][npre],
+  where npre includes the cells of the block, which are stored innermost so that the inner loop runs across cells
+*/
+PETSC_STATIC_INLINE void PetscFETensorContract_Private(PetscInt nin, PetscInt nout, PetscInt npre, PetscInt npost, const PetscReal A[], PetscBool trans, const PetscScalar in[], PetscScalar out[])
+{
+  PetscInt k, a, i, l;
+
+  for (k = 0; k < npost; ++k) {
+    for (a = 0; a < nout; ++a) {
+      PetscScalar *o = &out[(k*nout + a)*npre];
+
+      for (l = 0; l < npre; ++l) o[l] = 0.0;
+      for (i = 0; i < nin; ++i) {
+        const PetscReal    c = trans ? A[i*nout+a] : A[a*nin+i];
+        const PetscScalar *x = &in[(k*nin + i)*npre];
+
+        for (l = 0; l < npre; ++l) o[l] += c*x[l];
+      }
+    }
+  }
+}
+
+/*
+  Maps a block of Nw cells between the nodal values, n^dim per cell, and the quadrature point values, nq^dim per cell, in O(n^{dim+1})
+  operations per cell. The 1D basis is used in every direction except g, which uses its derivative (g < 0 interpolates values). The
+  transpose maps quadrature values back to the test functions. The work arrays w0 and w1 must hold Nw*max(n,nq)^dim values.
+*/
+static void PetscFETensorApply_Private(PetscInt dim, PetscFE_Tensor *t, PetscInt g, PetscBool trans, PetscInt Nw, const PetscScalar in[], PetscScalar out[], PetscScalar w0[], PetscScalar w1[])
+{
+  const PetscInt     nin  = trans ? t->nq : t->n;
+  const PetscInt     nout = trans ? t->n  : t->nq;
+  const PetscScalar *src  = in;
+  PetscInt           npre = Nw, npost = PetscPowInt(nin, dim-1), d;
+
+  for (d = 0; d < dim; ++d) {
+    PetscScalar *dst = d == dim-1 ? out : (d%2 ? w1 : w0);
+
+    PetscFETensorContract_Private(nin, nout, npre, npost, d == g ? t->D : t->B, trans, src, dst);
+    src    = dst;
+    npre  *= nout;
+    npost /= nin;
+  }
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorGetWorkSize_Private"
+/* The largest number of values per cell in a tensor buffer, which is the larger of the quadrature size and any field dimension */
+static PetscErrorCode PetscFETensorGetWorkSize_Private(PetscDS prob, PetscInt Nq, PetscInt *S)
+{
+  PetscInt       Nf, f;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *S   = Nq;
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  for (f = 0; f < Nf; ++f) {
+    PetscObject  obj;
+    PetscClassId id;
+    PetscInt     Nb;
+
+    ierr = PetscDSGetDiscretization(prob, f, &obj);CHKERRQ(ierr);
+    ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+    if (id != PETSCFE_CLASSID) continue;
+    ierr = PetscFEGetDimension((PetscFE) obj, &Nb);CHKERRQ(ierr);
+    *S   = PetscMax(*S, Nb);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorEvaluateBlock_Private"
+/*
+  Evaluates all fields of prob at the Nq quadrature points of a block of Nw cells, giving uq[(w*Nq+q)*Nc+c] and, if uxq is given,
+  the reference gradients uxq[((w*Nq+q)*Nc+c)*dim+d]. Tensor fields use sum factorization, other fields the full tabulation.
+  The work array must hold (4+dim)*Nw*S values, with S from PetscFETensorGetWorkSize_Private().
+*/
+static PetscErrorCode PetscFETensorEvaluateBlock_Private(PetscDS prob, PetscInt Nq, PetscInt Nw, PetscInt S, const PetscScalar coefficients[], PetscScalar uq[], PetscScalar uxq[], PetscScalar work[])
+{
+  PetscScalar   *U = work, *V = &work[Nw*S], *w0 = &work[2*Nw*S], *w1 = &work[3*Nw*S], *G = &work[4*Nw*S];
+  PetscReal    **basisField, **basisFieldDer;
+  PetscInt       dim, Nf, Nc, totDim, fOffset = 0, dOffset = 0, f;
+  PetscErrorCode ierr;
+
+  PetscFunctionBeginHot;
+  ierr = PetscDSGetSpatialDimension(prob, &dim);CHKERRQ(ierr);
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(prob, &Nc);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSGetTabulation(prob, &basisField, &basisFieldDer);CHKERRQ(ierr);
+  for (f = 0; f < Nf; ++f) {
+    PetscFE_Tensor *t = NULL;
+    PetscObject     obj;
+    PetscClassId    id;
+    PetscInt        Nb, Ncf, w, q, b, c, d;
+
+    ierr = PetscDSGetDiscretization(prob, f, &obj);CHKERRQ(ierr);
+    ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+    if (id == PETSCFE_CLASSID) {
+      ierr = PetscFEGetDimension((PetscFE) obj, &Nb);CHKERRQ(ierr);
+      ierr = PetscFEGetNumComponents((PetscFE) obj, &Ncf);CHKERRQ(ierr);
+      ierr = PetscFETensorGetData_Private((PetscFE) obj, &t);CHKERRQ(ierr);
+      if (t && PetscPowInt(t->nq, dim) != Nq) t = NULL;
+    } else if (id == PETSCFV_CLASSID) {
+      Nb   = 1;
+      ierr = PetscFVGetNumComponents((PetscFV) obj, &Ncf);CHKERRQ(ierr);
+    } else SETERRQ1(PetscObjectComm((PetscObject) prob), PETSC_ERR_ARG_WRONG, "Unknown discretization type for field %d", f);
+    if (t) {
+      for (c = 0; c < Ncf; ++c) {
+        for (w = 0; w < Nw; ++w) for (b = 0; b < Nb; ++b) U[t->bidx[b]*Nw+w] = coefficients[w*totDim+dOffset+b*Ncf+c];
+        PetscFETensorApply_Private(dim, t, -1, PETSC_FALSE, Nw, U, V, w0, w1);
+        for (w = 0; w < Nw; ++w) for (q = 0; q < Nq; ++q) uq[(w*Nq+q)*Nc+fOffset+c] = V[t->qidx[q]*Nw+w];
+        if (!uxq) continue;
+        for (d = 0; d < dim; ++d) PetscFETensorApply_Private(dim, t, d, PETSC_FALSE, Nw, U, &G[d*Nq*Nw], w0, w1);
+        for (w = 0; w < Nw; ++w) for (q = 0; q < Nq; ++q) for (d = 0; d < dim; ++d) uxq[((w*Nq+q)*Nc+fOffset+c)*dim+d] = G[(d*Nq+t->qidx[q])*Nw+w];
+      }
+    } else {
+      const PetscReal *basis    = basisField[f];
+      const PetscReal *basisDer = basisFieldDer[f];
+
+      for (w = 0; w < Nw; ++w) {
+        for (q = 0; q < Nq; ++q) {
+          PetscScalar *u  = &uq[(w*Nq+q)*Nc+fOffset];
+          PetscScalar *ux = uxq ? &uxq[((w*Nq+q)*Nc+fOffset)*dim] : NULL;
+
+          for (c = 0; c < Ncf; ++c) u[c] = 0.0;
+          if (ux) for (d = 0; d < Ncf*dim; ++d) ux[d] = 0.0;
+          for (b = 0; b < Nb; ++b) {
+            for (c = 0; c < Ncf; ++c) {
+              const PetscInt    cidx = b*Ncf+c;
+              const PetscScalar coef = coefficients[w*totDim+dOffset+cidx];
+
+              u[c] += coef*basis[q*Nb*Ncf+cidx];
+              if (ux) for (d = 0; d < dim; ++d) ux[c*dim+d] += coef*basisDer[(q*Nb*Ncf+cidx)*dim+d];
+            }
+          }
+        }
+      }
+    }
+    fOffset += Ncf;
+    dOffset += Nb*Ncf;
+  }
+  PetscFunctionReturn(0);
+}
+
+/* Gives the field values and the real gradients at a point from its values and reference gradients */
+PETSC_STATIC_INLINE void PetscFETensorGetJet_Private(PetscInt dim, PetscInt Nc, const PetscReal invJ[], const PetscScalar uq[], const PetscScalar uxq[], PetscScalar u[], PetscScalar u_x[])
+{
+  PetscInt c, d, e;
+
+  for (c = 0; c < Nc; ++c) {
+    u[c] = uq[c];
+    for (d = 0; d < dim; ++d) {
+      u_x[c*dim+d] = 0.0;
+      for (e = 0; e < dim; ++e) u_x[c*dim+d] += invJ[e*dim+d]*uxq[c*dim+e];
+    }
+  }
+}
+
+/*
+  Integrates the weighted quadrature values F0[(c*Nq+q)*Nw+w] and reference fluxes F1[((c*dim+d)*Nq+q)*Nw+w], in lexicographic
+  quadrature order, against the test functions of a block of Nw cells, overwriting elemVec[w*totDim+b*Nc+c]
+*/
+static void PetscFETensorUpdateElementVec_Private(PetscFE_Tensor *t, PetscInt dim, PetscInt Nb, PetscInt Nc, PetscInt Nq, PetscInt Nw, PetscInt S, PetscBool hasF0, PetscBool hasF1,
+                                                  const PetscScalar F0[], const PetscScalar F1[], PetscScalar work[], PetscInt totDim, PetscScalar elemVec[])
+{
+  PetscScalar *R = work, *T = &work[Nw*S], *w0 = &work[2*Nw*S], *w1 = &work[3*Nw*S];
+  PetscInt     w, b, c, d, i;
+
+  for (c = 0; c < Nc; ++c) {
+    for (i = 0; i < Nb*Nw; ++i) R[i] = 0.0;
+    if (hasF0) {
+      PetscFETensorApply_Private(dim, t, -1, PETSC_TRUE, Nw, &F0[c*Nq*Nw], T, w0, w1);
+      for (i = 0; i < Nb*Nw; ++i) R[i] += T[i];
+    }
+    for (d = 0; hasF1 && d < dim; ++d) {
+      PetscFETensorApply_Private(dim, t, d, PETSC_TRUE, Nw, &F1[(c*dim+d)*Nq*Nw], T, w0, w1);
+      for (i = 0; i < Nb*Nw; ++i) R[i] += T[i];
+    }
+    for (w = 0; w < Nw; ++w) for (b = 0; b < Nb; ++b) elemVec[w*totDim+b*Nc+c] = R[t->bidx[b]*Nw+w];
+  }
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEIntegrate_Tensor"
+PetscErrorCode PetscFEIntegrate_Tensor(PetscFE fem, PetscDS prob, PetscInt field, PetscInt Ne, PetscFECellGeom *geom,
+                                       const PetscScalar coefficients[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal integral[])
+{
+  PetscFE_Tensor  *tf;
+  PetscPointFunc   obj_func;
+  PetscQuadrature  quad;
+  const PetscReal *quadPoints, *quadWeights;
+  PetscScalar     *u, *u_x, *a, *a_x, *uq, *uxq, *work;
+  PetscReal       *x;
+  PetscInt        *uOff, *uOff_x, *aOff = NULL, *aOff_x = NULL;
+  PetscInt         dim, Nf, NfAux = 0, NcTot, Nq, Nw, S, totDim, totDimAux = 0, e, w, q;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscDSGetObjective(prob, field, &obj_func);CHKERRQ(ierr);
+  if (!obj_func) PetscFunctionReturn(0);
+  ierr = PetscFETensorGetData_Private(fem, &tf);CHKERRQ(ierr);
+  if (!tf) {
+    ierr = PetscFEIntegrate_Basic(fem, prob, field, Ne, geom, coefficients, probAux, coefficientsAux, integral);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscFEGetSpatialDimension(fem, &dim);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fem, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, &Nq, &quadPoints, &quadWeights);CHKERRQ(ierr);
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(prob, &NcTot);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentOffsets(prob, &uOff);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentDerivativeOffsets(prob, &uOff_x);CHKERRQ(ierr);
+  ierr = PetscDSGetEvaluationArrays(prob, &u, NULL, &u_x);CHKERRQ(ierr);
+  ierr = PetscDSGetRefCoordArrays(prob, &x, NULL);CHKERRQ(ierr);
+  if (probAux) {
+    ierr = PetscDSGetNumFields(probAux, &NfAux);CHKERRQ(ierr);
+    ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentOffsets(probAux, &aOff);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentDerivativeOffsets(probAux, &aOff_x);CHKERRQ(ierr);
+    ierr = PetscDSGetEvaluationArrays(probAux, &a, NULL, &a_x);CHKERRQ(ierr);
+  }
+  Nw   = PetscMax(fem->numBlocks, 1);
+  ierr = PetscFETensorGetWorkSize_Private(prob, Nq, &S);CHKERRQ(ierr);
+  ierr = PetscMalloc3(Nw*Nq*NcTot, &uq, Nw*Nq*NcTot*dim, &uxq, (4+dim)*Nw*S, &work);CHKERRQ(ierr);
+  for (e = 0; e < Ne; e += Nw) {
+    const PetscInt Nc = PetscMin(Nw, Ne-e);
+
+    ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Nc, S, &coefficients[e*totDim], uq, uxq, work);CHKERRQ(ierr);
+    for (w = 0; w < Nc; ++w) {
+      const PetscFECellGeom *cg = &geom[e+w];
+
+      for (q = 0; q < Nq; ++q) {
+        PetscScalar integrand;
+
+        CoordinatesRefToReal(dim, dim, cg->v0, cg->J, &quadPoints[q*dim], x);
+        PetscFETensorGetJet_Private(dim, NcTot, cg->invJ, &uq[(w*Nq+q)*NcTot], &uxq[(w*Nq+q)*NcTot*dim], u, u_x);
+        ierr = EvaluateFieldJets(probAux, PETSC_FALSE, q, cg->invJ, &coefficientsAux[(e+w)*totDimAux], NULL, a, a_x, NULL);CHKERRQ(ierr);
+        obj_func(dim, Nf, NfAux, uOff, uOff_x, u, NULL, u_x, aOff, aOff_x, a, NULL, a_x, 0.0, x, &integrand);
+        integral[field] += PetscRealPart(integrand*cg->detJ*quadWeights[q]);
+      }
+    }
+  }
+  ierr = PetscFree3(uq, uxq, work);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorGetResidualWorkSize_Private"
+/* The number of values of the work array of PetscFEIntegrateResidual_Tensor() */
+static PetscErrorCode PetscFETensorGetResidualWorkSize_Private(PetscFE fem, PetscDS prob, PetscInt *n)
+{
+  PetscQuadrature quad;
+  PetscInt        dim, Nc, NcTot, Nq, Nw, S;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFEGetSpatialDimension(fem, &dim);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fem, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, &Nq, NULL, NULL);CHKERRQ(ierr);
+  ierr = PetscFEGetNumComponents(fem, &Nc);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(prob, &NcTot);CHKERRQ(ierr);
+  ierr = PetscFETensorGetWorkSize_Private(prob, Nq, &S);CHKERRQ(ierr);
+  Nw   = PetscMax(fem->numBlocks, 1);
+  *n   = Nw*Nq*NcTot*(2+dim) + Nw*Nq*Nc*(1+dim) + (4+dim)*Nw*S;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorGetWork_Private"
+/* Returns a work array of n values kept in prob, which is only reallocated when it is too small */
+static PetscErrorCode PetscFETensorGetWork_Private(PetscDS prob, PetscInt n, PetscScalar **work)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (n > prob->Nwork) {
+    ierr        = PetscFree(prob->work);CHKERRQ(ierr);
+    ierr        = PetscMalloc1(n, &prob->work);CHKERRQ(ierr);
+    prob->Nwork = n;
+  }
+  *work = prob->work;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEIntegrateResidual_Tensor"
+PetscErrorCode PetscFEIntegrateResidual_Tensor(PetscFE fem, PetscDS prob, PetscInt field, PetscInt Ne, PetscFECellGeom *geom,
+                                               const PetscScalar coefficients[], const PetscScalar coefficients_t[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscScalar elemVec[])
+{
+  PetscFE_Tensor  *tf;
+  PetscPointFunc   f0_func;
+  PetscPointFunc   f1_func;
+  PetscQuadrature  quad;
+  const PetscReal *quadPoints, *quadWeights;
+  PetscScalar     *f0, *f1, *u, *u_t = NULL, *u_x, *a, *a_x, *refSpaceDer;
+  PetscScalar     *uq, *uxq, *utq, *F, *work;
+  PetscReal       *x;
+  PetscInt        *uOff, *uOff_x, *aOff = NULL, *aOff_x = NULL;
+  PetscInt         dim, Nf, NfAux = 0, Nb, Nc, NcTot, Nq, Nw, S, Nwork, totDim, totDimAux = 0, fOffset, e, w, q, c, d;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFETensorGetData_Private(fem, &tf);CHKERRQ(ierr);
+  if (!tf) {
+    ierr = PetscFEIntegrateResidual_Basic(fem, prob, field, Ne, geom, coefficients, coefficients_t, probAux, coefficientsAux, t, elemVec);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscFEGetSpatialDimension(fem, &dim);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fem, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, &Nq, &quadPoints, &quadWeights);CHKERRQ(ierr);
+  ierr = PetscFEGetDimension(fem, &Nb);CHKERRQ(ierr);
+  ierr = PetscFEGetNumComponents(fem, &Nc);CHKERRQ(ierr);
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(prob, &NcTot);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentOffsets(prob, &uOff);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentDerivativeOffsets(prob, &uOff_x);CHKERRQ(ierr);
+  ierr = PetscDSGetFieldOffset(prob, field, &fOffset);CHKERRQ(ierr);
+  ierr = PetscDSGetResidual(prob, field, &f0_func, &f1_func);CHKERRQ(ierr);
+  ierr = PetscDSGetEvaluationArrays(prob, &u, coefficients_t ? &u_t : NULL, &u_x);CHKERRQ(ierr);
+  ierr = PetscDSGetRefCoordArrays(prob, &x, &refSpaceDer);CHKERRQ(ierr);
+  ierr = PetscDSGetWeakFormArrays(prob, &f0, &f1, NULL, NULL, NULL, NULL);CHKERRQ(ierr);
+  if (probAux) {
+    ierr = PetscDSGetNumFields(probAux, &NfAux);CHKERRQ(ierr);
+    ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentOffsets(probAux, &aOff);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentDerivativeOffsets(probAux, &aOff_x);CHKERRQ(ierr);
+    ierr = PetscDSGetEvaluationArrays(probAux, &a, NULL, &a_x);CHKERRQ(ierr);
+  }
+  Nw   = PetscMax(fem->numBlocks, 1);
+  ierr = PetscFETensorGetWorkSize_Private(prob, Nq, &S);CHKERRQ(ierr);
+  /* The buffers are kept in prob, so that the kernel does not allocate once PetscFESetUpIntegration_Internal() has sized them */
+  ierr = PetscFETensorGetResidualWorkSize_Private(fem, prob, &Nwork);CHKERRQ(ierr);
+  ierr = PetscFETensorGetWork_Private(prob, Nwork, &uq);CHKERRQ(ierr);
+  uxq  = &uq[Nw*Nq*NcTot];
+  utq  = &uxq[Nw*Nq*NcTot*dim];
+  F    = &utq[Nw*Nq*NcTot];
+  work = &F[Nw*Nq*Nc*(1+dim)];
+  for (e = 0; e < Ne; e += Nw) {
+    const PetscInt Ncell = PetscMin(Nw, Ne-e);
+    PetscScalar   *F0    = F, *F1 = &F[Nc*Nq*Ncell];
+
+    ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Ncell, S, &coefficients[e*totDim], uq, uxq, work);CHKERRQ(ierr);
+    if (u_t) {ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Ncell, S, &coefficients_t[e*totDim], utq, NULL, work);CHKERRQ(ierr);}
+    for (w = 0; w < Ncell; ++w) {
+      const PetscFECellGeom *cg = &geom[e+w];
+
+      for (q = 0; q < Nq; ++q) {
+        const PetscInt ql = tf->qidx[q];
+
+        CoordinatesRefToReal(dim, dim, cg->v0, cg->J, &quadPoints[q*dim], x);
+        PetscFETensorGetJet_Private(dim, NcTot, cg->invJ, &uq[(w*Nq+q)*NcTot], &uxq[(w*Nq+q)*NcTot*dim], u, u_x);
+        if (u_t) for (c = 0; c < NcTot; ++c) u_t[c] = utq[(w*Nq+q)*NcTot+c];
+        ierr = EvaluateFieldJets(probAux, PETSC_FALSE, q, cg->invJ, &coefficientsAux[(e+w)*totDimAux], NULL, a, a_x, NULL);CHKERRQ(ierr);
+        ierr = PetscMemzero(&f0[q*Nc], Nc * sizeof(PetscScalar));CHKERRQ(ierr);
+        ierr = PetscMemzero(refSpaceDer, Nc*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+        if (f0_func) f0_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, x, &f0[q*Nc]);
+        if (f1_func) f1_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, x, refSpaceDer);
+        TransformF(dim, dim, Nc, q, cg->invJ, cg->detJ, quadWeights, refSpaceDer, f0, f1);
+        for (c = 0; c < Nc; ++c) {
+          F0[(c*Nq+ql)*Ncell+w] = f0[q*Nc+c];
+          for (d = 0; d < dim; ++d) F1[((c*dim+d)*Nq+ql)*Ncell+w] = f1[(q*Nc+c)*dim+d];
+        }
+      }
+    }
+    PetscFETensorUpdateElementVec_Private(tf, dim, Nb, Nc, Nq, Ncell, S, f0_func ? PETSC_TRUE : PETSC_FALSE, f1_func ? PETSC_TRUE : PETSC_FALSE, F0, F1, work, totDim, &elemVec[e*totDim+fOffset]);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFETensorIntegrateJacobianActionDense_Private"
+/* Forms the element matrices with the basic kernel and applies them, for spaces which do not factor */
+static PetscErrorCode PetscFETensorIntegrateJacobianActionDense_Private(PetscFE fem, PetscDS prob, PetscFEJacobianType jtype, PetscInt fieldI, PetscInt Ne, PetscFECellGeom *geom,
+                                                                      const PetscScalar coefficients[], const PetscScalar coefficients_t[], const PetscScalar coefficientsY[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscReal u_tshift, PetscScalar elemVec[])
+{
+  PetscScalar   *elemMat;
+  PetscInt       Nf, NbI, NcI, totDim, offsetI, fieldJ, e, i, j;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSGetFieldOffset(prob, fieldI, &offsetI);CHKERRQ(ierr);
+  ierr = PetscFEGetDimension(fem, &NbI);CHKERRQ(ierr);
+  ierr = PetscFEGetNumComponents(fem, &NcI);CHKERRQ(ierr);
+  ierr = PetscCalloc1(Ne*totDim*totDim, &elemMat);CHKERRQ(ierr);
+  for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
+    ierr = PetscFEIntegrateJacobian_Basic(fem, prob, jtype, fieldI, fieldJ, Ne, geom, coefficients, coefficients_t, probAux, coefficientsAux, t, u_tshift, elemMat);CHKERRQ(ierr);
+  }
+  for (e = 0; e < Ne; ++e) {
+    for (i = offsetI; i < offsetI+NbI*NcI; ++i) {
+      elemVec[e*totDim+i] = 0.0;
+      for (j = 0; j < totDim; ++j) elemVec[e*totDim+i] += elemMat[(e*totDim+i)*totDim+j]*coefficientsY[e*totDim+j];
+    }
+  }
+  ierr = PetscFree(elemMat);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEIntegrateJacobianAction_Tensor"
+/*
+  The pointwise Jacobian is applied to the direction at each quadrature point, so that the action costs the same as a residual evaluation:
+    f0_{fc} = g0_{fc,gc} y^{gc} + g1_{fc,gc,dg} \nabla y^{gc}_{dg}
+    f1_{fc,df} = g2_{fc,gc,df} y^{gc} + g3_{fc,gc,df,dg} \nabla y^{gc}_{dg}
+*/
+PetscErrorCode PetscFEIntegrateJacobianAction_Tensor(PetscFE fem, PetscDS prob, PetscFEJacobianType jtype, PetscInt fieldI, PetscInt Ne, PetscFECellGeom *geom,
+                                                     const PetscScalar coefficients[], const PetscScalar coefficients_t[], const PetscScalar coefficientsY[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscReal u_tshift, PetscScalar elemVec[])
+{
+  PetscFE_Tensor  *tf;
+  PetscQuadrature  quad;
+  const PetscReal *quadPoints, *quadWeights;
+  PetscScalar     *f0, *f1, *g0, *g1, *g2, *g3, *u, *u_t = NULL, *u_x, *a, *a_x, *refSpaceDer;
+  PetscScalar     *uq, *uxq, *utq, *yq, *yxq, *y, *y_x, *F, *work;
+  PetscReal       *x;
+  PetscInt        *uOff, *uOff_x, *aOff = NULL, *aOff_x = NULL;
+  PetscInt         dim, Nf, NfAux = 0, NbI, NcI, NcTot, Nq, Nw, S, totDim, totDimAux = 0, offsetI, fieldJ, e, w, q, fc, gc, d, d2;
+  PetscBool        hasF0 = PETSC_FALSE, hasF1 = PETSC_FALSE;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFETensorGetData_Private(fem, &tf);CHKERRQ(ierr);
+  if (!tf) {
+    ierr = PetscFETensorIntegrateJacobianActionDense_Private(fem, prob, jtype, fieldI, Ne, geom, coefficients, coefficients_t, coefficientsY, probAux, coefficientsAux, t, u_tshift, elemVec);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
+    PetscPointJac g0_func, g1_func, g2_func, g3_func;
+
+    switch(jtype) {
+    case PETSCFE_JACOBIAN_DYN: ierr = PetscDSGetDynamicJacobian(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+    case PETSCFE_JACOBIAN_PRE: ierr = PetscDSGetJacobianPreconditioner(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+    case PETSCFE_JACOBIAN:     ierr = PetscDSGetJacobian(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+    }
+    if (g0_func || g1_func) hasF0 = PETSC_TRUE;
+    if (g2_func || g3_func) hasF1 = PETSC_TRUE;
+  }
+  if (!hasF0 && !hasF1) PetscFunctionReturn(0);
+  ierr = PetscFEGetSpatialDimension(fem, &dim);CHKERRQ(ierr);
+  ierr = PetscFEGetQuadrature(fem, &quad);CHKERRQ(ierr);
+  ierr = PetscQuadratureGetData(quad, NULL, &Nq, &quadPoints, &quadWeights);CHKERRQ(ierr);
+  ierr = PetscFEGetDimension(fem, &NbI);CHKERRQ(ierr);
+  ierr = PetscFEGetNumComponents(fem, &NcI);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalComponents(prob, &NcTot);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentOffsets(prob, &uOff);CHKERRQ(ierr);
+  ierr = PetscDSGetComponentDerivativeOffsets(prob, &uOff_x);CHKERRQ(ierr);
+  ierr = PetscDSGetFieldOffset(prob, fieldI, &offsetI);CHKERRQ(ierr);
+  ierr = PetscDSGetEvaluationArrays(prob, &u, coefficients_t ? &u_t : NULL, &u_x);CHKERRQ(ierr);
+  ierr = PetscDSGetRefCoordArrays(prob, &x, &refSpaceDer);CHKERRQ(ierr);
+  ierr = PetscDSGetWeakFormArrays(prob, &f0, &f1, &g0, &g1, &g2, &g3);CHKERRQ(ierr);
+  if (probAux) {
+    ierr = PetscDSGetNumFields(probAux, &NfAux);CHKERRQ(ierr);
+    ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentOffsets(probAux, &aOff);CHKERRQ(ierr);
+    ierr = PetscDSGetComponentDerivativeOffsets(probAux, &aOff_x);CHKERRQ(ierr);
+    ierr = PetscDSGetEvaluationArrays(probAux, &a, NULL, &a_x);CHKERRQ(ierr);
+  }
+  Nw   = PetscMax(fem->numBlocks, 1);
+  ierr = PetscFETensorGetWorkSize_Private(prob, Nq, &S);CHKERRQ(ierr);
+  ierr = PetscMalloc7(Nw*Nq*NcTot, &uq, Nw*Nq*NcTot*dim, &uxq, u_t ? Nw*Nq*NcTot : 0, &utq, Nw*Nq*NcTot, &yq, Nw*Nq*NcTot*dim, &yxq, Nw*Nq*NcI*(1+dim), &F, (4+dim)*Nw*S + NcTot*(1+dim), &work);CHKERRQ(ierr);
+  /* The jet of the direction at a point follows the block work space */
+  y    = &work[(4+dim)*Nw*S];
+  y_x  = &y[NcTot];
+  for (e = 0; e < Ne; e += Nw) {
+    const PetscInt Ncell = PetscMin(Nw, Ne-e);
+    PetscScalar   *F0    = F, *F1 = &F[NcI*Nq*Ncell];
+
+    ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Ncell, S, &coefficients[e*totDim], uq, uxq, work);CHKERRQ(ierr);
+    ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Ncell, S, &coefficientsY[e*totDim], yq, yxq, work);CHKERRQ(ierr);
+    if (u_t) {ierr = PetscFETensorEvaluateBlock_Private(prob, Nq, Ncell, S, &coefficients_t[e*totDim], utq, NULL, work);CHKERRQ(ierr);}
+    for (w = 0; w < Ncell; ++w) {
+      const PetscFECellGeom *cg = &geom[e+w];
+
+      for (q = 0; q < Nq; ++q) {
+        const PetscInt ql = tf->qidx[q];
+
+        CoordinatesRefToReal(dim, dim, cg->v0, cg->J, &quadPoints[q*dim], x);
+        PetscFETensorGetJet_Private(dim, NcTot, cg->invJ, &uq[(w*Nq+q)*NcTot], &uxq[(w*Nq+q)*NcTot*dim], u, u_x);
+        PetscFETensorGetJet_Private(dim, NcTot, cg->invJ, &yq[(w*Nq+q)*NcTot], &yxq[(w*Nq+q)*NcTot*dim], y, y_x);
+        if (u_t) for (gc = 0; gc < NcTot; ++gc) u_t[gc] = utq[(w*Nq+q)*NcTot+gc];
+        ierr = EvaluateFieldJets(probAux, PETSC_FALSE, q, cg->invJ, &coefficientsAux[(e+w)*totDimAux], NULL, a, a_x, NULL);CHKERRQ(ierr);
+        ierr = PetscMemzero(&f0[q*NcI], NcI * sizeof(PetscScalar));CHKERRQ(ierr);
+        ierr = PetscMemzero(refSpaceDer, NcI*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+        for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
+          PetscPointJac  g0_func, g1_func, g2_func, g3_func;
+          const PetscInt offJ = uOff[fieldJ], NcJ = uOff[fieldJ+1] - uOff[fieldJ];
+
+          switch(jtype) {
+          case PETSCFE_JACOBIAN_DYN: ierr = PetscDSGetDynamicJacobian(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+          case PETSCFE_JACOBIAN_PRE: ierr = PetscDSGetJacobianPreconditioner(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+          case PETSCFE_JACOBIAN:     ierr = PetscDSGetJacobian(prob, fieldI, fieldJ, &g0_func, &g1_func, &g2_func, &g3_func);CHKERRQ(ierr);break;
+          }
+          if (g0_func) {
+            ierr = PetscMemzero(g0, NcI*NcJ * sizeof(PetscScalar));CHKERRQ(ierr);
+            g0_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, u_tshift, x, g0);
+            for (fc = 0; fc < NcI; ++fc) for (gc = 0; gc < NcJ; ++gc) f0[q*NcI+fc] += g0[fc*NcJ+gc]*y[offJ+gc];
+          }
+          if (g1_func) {
+            ierr = PetscMemzero(g1, NcI*NcJ*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+            g1_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, u_tshift, x, g1);
+            for (fc = 0; fc < NcI; ++fc) for (gc = 0; gc < NcJ; ++gc) for (d = 0; d < dim; ++d) f0[q*NcI+fc] += g1[(fc*NcJ+gc)*dim+d]*y_x[(offJ+gc)*dim+d];
+          }
+          if (g2_func) {
+            ierr = PetscMemzero(g2, NcI*NcJ*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+            g2_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, u_tshift, x, g2);
+            for (fc = 0; fc < NcI; ++fc) for (gc = 0; gc < NcJ; ++gc) for (d = 0; d < dim; ++d) refSpaceDer[fc*dim+d] += g2[(fc*NcJ+gc)*dim+d]*y[offJ+gc];
+          }
+          if (g3_func) {
+            ierr = PetscMemzero(g3, NcI*NcJ*dim*dim * sizeof(PetscScalar));CHKERRQ(ierr);
+            g3_func(dim, Nf, NfAux, uOff, uOff_x, u, u_t, u_x, aOff, aOff_x, a, NULL, a_x, t, u_tshift, x, g3);
+            for (fc = 0; fc < NcI; ++fc) for (gc = 0; gc < NcJ; ++gc) for (d = 0; d < dim; ++d) for (d2 = 0; d2 < dim; ++d2) refSpaceDer[fc*dim+d] += g3[((fc*NcJ+gc)*dim+d)*dim+d2]*y_x[(offJ+gc)*dim+d2];
+          }
+        }
+        TransformF(dim, dim, NcI, q, cg->invJ, cg->detJ, quadWeights, refSpaceDer, f0, f1);
+        for (fc = 0; fc < NcI; ++fc) {
+          F0[(fc*Nq+ql)*Ncell+w] = f0[q*NcI+fc];
+          for (d = 0; d < dim; ++d) F1[((fc*dim+d)*Nq+ql)*Ncell+w] = f1[(q*NcI+fc)*dim+d];
+        }
+      }
+    }
+    PetscFETensorUpdateElementVec_Private(tf, dim, NbI, NcI, Nq, Ncell, S, hasF0, hasF1, F0, F1, work, totDim, &elemVec[e*totDim+offsetI]);
+  }
+  ierr = PetscFree7(uq, uxq, utq, yq, yxq, F, work);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEInitialize_Tensor"
+PetscErrorCode PetscFEInitialize_Tensor(PetscFE fem)
+{
+  PetscFunctionBegin;
+  fem->ops->setfromoptions          = NULL;
+  fem->ops->setup                   = PetscFESetUp_Basic;
+  fem->ops->view                    = PetscFEView_Tensor;
+  fem->ops->destroy                 = PetscFEDestroy_Tensor;
+  fem->ops->getdimension            = PetscFEGetDimension_Basic;
+  fem->ops->gettabulation           = PetscFEGetTabulation_Basic;
+  fem->ops->integrate               = PetscFEIntegrate_Tensor;
+  fem->ops->integrateresidual       = PetscFEIntegrateResidual_Tensor;
+  fem->ops->integratebdresidual     = PetscFEIntegrateBdResidual_Basic;
+  fem->ops->integratejacobianaction = PetscFEIntegrateJacobianAction_Tensor;
+  fem->ops->integratejacobian       = PetscFEIntegrateJacobian_Basic;
+  fem->ops->integratebdjacobian     = PetscFEIntegrateBdJacobian_Basic;
+  PetscFunctionReturn(0);
+}
+
+/*MC
+  PETSCFETENSOR = "tensor" - A PetscFE object that integrates with sum factorization on tensor product cells
+
+  Notes:
+  For tensor product spaces, such as Q_k Lagrange elements on quadrilaterals and hexahedra with a tensor quadrature, the basis
+  functions are products of 1D polynomials. Interpolation to the quadrature points and integration against the test functions
+  are then done one direction at a time, which costs O(k^{d+1}) per cell rather than O(k^{2d}) for the full tabulation. The cells
+  of each block, whose size is the number of blocks given to PetscFESetTileSizes() or -petscfe_num_blocks, are processed together
+  with the cell index innermost, so that the 1D contractions vectorize across cells. The element also supports the matrix-free
+  Jacobian action used by DMPlexSNESComputeJacobianActionFEM(). Spaces that do not factor use the PETSCFEBASIC kernels.
+
+  Level: intermediate
+
+.seealso: PetscFEType, PetscFECreate(), PetscFESetType(), PetscFESetTileSizes(), PetscFEIntegrateJacobianAction()
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFECreate_Tensor"
+PETSC_EXTERN PetscErrorCode PetscFECreate_Tensor(PetscFE fem)
+{
+  PetscFE_Tensor *t;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(fem, PETSCFE_CLASSID, 1);
+  ierr      = PetscNewLog(fem, &t);CHKERRQ(ierr);
+  fem->data = t;
+  /* Vectorize across a few cells unless the blocking was set */
+  if (fem->numBlocks == 1) fem->numBlocks = 4;
+
+  ierr = PetscFEInitialize_Tensor(fem);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscFEGetDimension"
 /*@
@@ -5759,6 +6559,32 @@ PetscErrorCode PetscFEIntegrateResidual(PetscFE fem, PetscDS prob, PetscInt fiel
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscFESetUpIntegration_Internal"
+/*
+  PetscFESetUpIntegration_Internal - Computes everything that PetscFEIntegrateResidual() and PetscFEIntegrateJacobian() for the
+  field of fem would otherwise compute on first use: the tabulations and the dual space dimensions through PetscDSSetUp(), the
+  1D factors of a PETSCFETENSOR element, and the work array that the tensor kernel keeps in prob. These kernels then do not
+  allocate, so that they may be called concurrently by threads which each have their own prob and probAux.
+*/
+PetscErrorCode PetscFESetUpIntegration_Internal(PetscFE fem, PetscDS prob, PetscDS probAux)
+{
+  PetscFE_Tensor *tf;
+  PetscScalar    *work;
+  PetscInt        Nwork;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscDSSetUp(prob);CHKERRQ(ierr);
+  if (probAux) {ierr = PetscDSSetUp(probAux);CHKERRQ(ierr);}
+  ierr = PetscFETensorGetData_Private(fem, &tf);CHKERRQ(ierr);
+  if (tf) {
+    ierr = PetscFETensorGetResidualWorkSize_Private(fem, prob, &Nwork);CHKERRQ(ierr);
+    ierr = PetscFETensorGetWork_Private(prob, Nwork, &work);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscFEIntegrateBdResidual"
 /*@C
@@ -5842,6 +6668,53 @@ PetscErrorCode PetscFEIntegrateJacobian(PetscFE fem, PetscDS prob, PetscFEJacobi
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscFEIntegrateJacobianAction"
+/*@C
+  PetscFEIntegrateJacobianAction - Produce the action of the element Jacobian on a direction for a chunk of elements, without forming the element matrices
+
+  Not collective
+
+  Input Parameters:
++ fem          - The PetscFE object for the field being integrated
+. prob         - The PetscDS specifying the discretizations and continuum functions
+. jtype        - The type of matrix pointwise functions that should be used
+. fieldI       - The test field being integrated
+. Ne           - The number of elements in the chunk
+. geom         - The cell geometry for each cell in the chunk
+. coefficients - The array of FEM basis coefficients for the elements for the Jacobian evaluation point
+. coefficients_t - The array of FEM basis time derivative coefficients for the elements
+. coefficientsY - The array of FEM basis coefficients for the elements of the direction
+. probAux      - The PetscDS specifying the auxiliary discretizations
+. coefficientsAux - The array of FEM auxiliary basis coefficients for the elements
+. t            - The time
+- u_tShift     - A multiplier for the dF/du_t term (as opposed to the dF/du term)
+
+  Output Parameter
+. elemVec      - the element vectors J y for fieldI from each element, summed over the basis fields
+
+  Note:
+  The pointwise Jacobian functions are contracted with the direction at each quadrature point,
+$         f0_{fc} = g0_{fc,gc} y^{gc} + g1_{fc,gc,dg} \nabla y^{gc}_{dg}
+$         f1_{fc,df} = g2_{fc,gc,df} y^{gc} + g3_{fc,gc,df,dg} \nabla y^{gc}_{dg}
+  which are then integrated like a residual. Only some implementations, such as PETSCFETENSOR, provide this operation,
+  and elemVec is left untouched by the others.
+
+  Level: developer
+
+.seealso: PetscFEIntegrateJacobian(), PetscFEIntegrateResidual()
+@*/
+PetscErrorCode PetscFEIntegrateJacobianAction(PetscFE fem, PetscDS prob, PetscFEJacobianType jtype, PetscInt fieldI, PetscInt Ne, PetscFECellGeom *geom, const PetscScalar coefficients[], const PetscScalar coefficients_t[],
+                                              const PetscScalar coefficientsY[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscReal u_tshift, PetscScalar elemVec[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(fem, PETSCFE_CLASSID, 1);
+  if (fem->ops->integratejacobianaction) {ierr = (*fem->ops->integratejacobianaction)(fem, prob, jtype, fieldI, Ne, geom, coefficients, coefficients_t, coefficientsY, probAux, coefficientsAux, t, u_tshift, elemVec);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscFEIntegrateBdJacobian"
 /*C
@@ -1,11 +1,14 @@
 static char help[] = "Load and save the mesh and fields to HDF5 and ExodusII\n\n";
 
 #include <petscdmplex.h>
+#include <petscsf.h>
 #include <petscviewerhdf5.h>
 
 typedef struct {
   PetscBool interpolate;                  /* Generate intermediate mesh elements */
   char      filename[PETSC_MAX_PATH_LEN]; /* Mesh filename */
+  PetscBool write;                        /* Write the distributed mesh to dmdist.h5 */
+  PetscBool read;                         /* Read the mesh back from dmdist.h5 */
 } AppCtx;
 
 #undef __FUNCT__
@@ -17,14 +20,70 @@ static PetscErrorCode ProcessOptions(MPI_Comm comm, AppCtx *options)
   PetscFunctionBeginUser;
   options->interpolate = PETSC_FALSE;
   options->filename[0] = '\0';
+  options->write       = PETSC_TRUE;
+  options->read        = PETSC_TRUE;
 
   ierr = PetscOptionsBegin(comm, "", "Meshing Problem Options", "DMPLEX");CHKERRQ(ierr);
   ierr = PetscOptionsBool("-interpolate", "Generate intermediate mesh elements", "ex5.c", options->interpolate, &options->interpolate, NULL);CHKERRQ(ierr);
   ierr = PetscOptionsString("-filename", "The mesh file", "ex5.c", options->filename, options->filename, PETSC_MAX_PATH_LEN, NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-write", "Write the distributed mesh to dmdist.h5", "ex5.c", options->write, &options->write, NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-read", "Read the mesh back from dmdist.h5", "ex5.c", options->read, &options->read, NULL);CHKERRQ(ierr);
   ierr = PetscOptionsEnd();
   PetscFunctionReturn(0);
 };
 
+#undef __FUNCT__
+#define __FUNCT__ "ViewGlobalSizes"
+/* Prints the number of points of each dimension and in each label of ref, counting shared points once, so that the
+   result does not depend on the partition */
+static PetscErrorCode ViewGlobalSizes(DM dm, DM ref, const char name[])
+{
+  MPI_Comm        comm;
+  PetscSF         sf;
+  DMLabel         depthLabel, label;
+  const PetscInt *leaves;
+  PetscBool      *owned;
+  PetscInt        dim, pStart, pEnd, p, nleaves, numLabels, l, d, val, lsize, gsize;
+  const char     *lname;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBeginUser;
+  ierr = PetscObjectGetComm((PetscObject) dm, &comm);CHKERRQ(ierr);
+  ierr = DMGetDimension(dm, &dim);CHKERRQ(ierr);
+  ierr = DMPlexGetChart(dm, &pStart, &pEnd);CHKERRQ(ierr);
+  ierr = PetscMalloc1(pEnd-pStart, &owned);CHKERRQ(ierr);
+  for (p = pStart; p < pEnd; ++p) owned[p-pStart] = PETSC_TRUE;
+  ierr = DMGetPointSF(dm, &sf);CHKERRQ(ierr);
+  ierr = PetscSFGetGraph(sf, NULL, &nleaves, &leaves, NULL);CHKERRQ(ierr);
+  for (l = 0; l < nleaves; ++l) owned[(leaves ? leaves[l] : l)-pStart] = PETSC_FALSE;
+  ierr = PetscPrintf(comm, "%s:", name);CHKERRQ(ierr);
+  ierr = DMPlexGetDepthLabel(dm, &depthLabel);CHKERRQ(ierr);
+  for (d = dim; d >= 0; --d) {
+    for (p = pStart, lsize = 0; p < pEnd; ++p) {
+      ierr = DMLabelGetValue(depthLabel, p, &val);CHKERRQ(ierr);
+      if (owned[p-pStart] && val == d) ++lsize;
+    }
+    ierr = MPIU_Allreduce(&lsize, &gsize, 1, MPIU_INT, MPI_SUM, comm);CHKERRQ(ierr);
+    ierr = PetscPrintf(comm, "%s %D-cells %D", d == dim ? "" : ",", d, gsize);CHKERRQ(ierr);
+  }
+  ierr = DMGetNumLabels(ref, &numLabels);CHKERRQ(ierr);
+  for (l = 0; l < numLabels; ++l) {
+    ierr = DMGetLabelName(ref, l, &lname);CHKERRQ(ierr);
+    ierr = DMGetLabel(dm, lname, &label);CHKERRQ(ierr);
+    if (label == depthLabel) continue;
+    for (p = pStart, lsize = 0; p < pEnd; ++p) {
+      val = -1;
+      if (label) {ierr = DMLabelGetValue(label, p, &val);CHKERRQ(ierr);}
+      if (owned[p-pStart] && val != -1) ++lsize;
+    }
+    ierr = MPIU_Allreduce(&lsize, &gsize, 1, MPIU_INT, MPI_SUM, comm);CHKERRQ(ierr);
+    ierr = PetscPrintf(comm, ", %s %D", lname, gsize);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(comm, "\n");CHKERRQ(ierr);
+  ierr = PetscFree(owned);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "main"
 int main(int argc, char **argv)
@@ -32,8 +91,8 @@ int main(int argc, char **argv)
   DM             dm, dmdist, dmnew;
   AppCtx         user;
   PetscViewer    v;
-  PetscSF        pointSF;
-  PetscBool      flg;
+  PetscSF        pointSF = NULL;
+  PetscBool      flg, parallel;
   PetscErrorCode ierr;
 
   ierr = PetscInitialize(&argc, &argv, NULL,help);if (ierr) return ierr;
@@ -49,21 +108,36 @@ int main(int argc, char **argv)
   ierr = DMSetFromOptions(dm);CHKERRQ(ierr);
   ierr = DMViewFromOptions(dm, NULL, "-dm_view");CHKERRQ(ierr);
 
-  ierr = PetscViewerHDF5Open(PetscObjectComm((PetscObject) dm), "dmdist.h5", FILE_MODE_WRITE, &v); CHKERRQ(ierr);
-  ierr = DMView(dm, v);CHKERRQ(ierr);
-  ierr = PetscViewerDestroy(&v);CHKERRQ(ierr);
+  if (user.write) {
+    ierr = PetscViewerHDF5Open(PetscObjectComm((PetscObject) dm), "dmdist.h5", FILE_MODE_WRITE, &v); CHKERRQ(ierr);
+    ierr = DMView(dm, v);CHKERRQ(ierr);
+    ierr = PetscViewerDestroy(&v);CHKERRQ(ierr);
+  }
+  if (!user.read) {
+    ierr = DMDestroy(&dm);CHKERRQ(ierr);
+    ierr = PetscFinalize();
+    return ierr;
+  }
 
   ierr = DMCreate(PetscObjectComm((PetscObject) dm), &dmnew);CHKERRQ(ierr);
   ierr = DMSetType(dmnew, DMPLEX);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) dmnew, "Loaded Mesh");CHKERRQ(ierr);
   ierr = PetscViewerHDF5Open(PETSC_COMM_WORLD, "dmdist.h5", FILE_MODE_READ, &v);CHKERRQ(ierr);
   ierr = DMLoad(dmnew, v);CHKERRQ(ierr);
   ierr = PetscViewerDestroy(&v);CHKERRQ(ierr);
   ierr = DMViewFromOptions(dmnew, NULL, "-new_dm_view");CHKERRQ(ierr);
 
-  /* The NATIVE format for coordiante viewing is killing parallel output, since we have a local vector. Map it to global, and it will work. */
-  ierr = DMPlexEqual(dmnew, dm, &flg);CHKERRQ(ierr);
-  if (flg) {ierr = PetscPrintf(PETSC_COMM_WORLD,"DMs equal\n");CHKERRQ(ierr);}
-  else     {ierr = PetscPrintf(PETSC_COMM_WORLD,"DMs are not equal\n");CHKERRQ(ierr);}
+  ierr = PetscOptionsHasName(NULL, NULL, "-dm_plex_load_parallel", &parallel);CHKERRQ(ierr);
+  if (parallel || !user.write) {
+    /* The loaded mesh has its own partition, so compare only the global sizes */
+    ierr = ViewGlobalSizes(dm, dm, "Original mesh");CHKERRQ(ierr);
+    ierr = ViewGlobalSizes(dmnew, dm, "Loaded mesh");CHKERRQ(ierr);
+  } else {
+    /* The NATIVE format for coordiante viewing is killing parallel output, since we have a local vector. Map it to global, and it will work. */
+    ierr = DMPlexEqual(dmnew, dm, &flg);CHKERRQ(ierr);
+    if (flg) {ierr = PetscPrintf(PETSC_COMM_WORLD,"DMs equal\n");CHKERRQ(ierr);}
+    else     {ierr = PetscPrintf(PETSC_COMM_WORLD,"DMs are not equal\n");CHKERRQ(ierr);}
+  }
 
   ierr = DMDestroy(&dm);CHKERRQ(ierr);
   ierr = DMDestroy(&dmnew);CHKERRQ(ierr);
@@ -895,12 +895,90 @@ PetscErrorCode DMDestroy_Plex(DM dm)
   ierr = PetscFree(mesh->children);CHKERRQ(ierr);
   ierr = DMDestroy(&mesh->referenceTree);CHKERRQ(ierr);
   ierr = PetscGridHashDestroy(&mesh->lbox);CHKERRQ(ierr);
+  ierr = DMPlexDestroyClosureCache_Internal(dm);CHKERRQ(ierr);
   /* This was originally freed in DMDestroy(), but that prevents reference counting of backend objects */
   ierr = PetscFree(mesh);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)dm,"DMAdaptLabel_C",NULL);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexMFFEDestroy_Private"
+static PetscErrorCode DMPlexMFFEDestroy_Private(void *ctx)
+{
+  DMPlex_MFFE   *mf = (DMPlex_MFFE *) ctx;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDestroy(&mf->X);CHKERRQ(ierr);
+  ierr = VecDestroy(&mf->X_t);CHKERRQ(ierr);
+  ierr = PetscFree(mf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetMFFE_Internal"
+/* Returns the state of a MATMFFE matrix created by DMCreateMatrix(), or NULL for any other matrix */
+PetscErrorCode DMPlexGetMFFE_Internal(Mat A, DMPlex_MFFE **mf)
+{
+  PetscContainer container;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *mf  = NULL;
+  if (!A) PetscFunctionReturn(0);
+  ierr = PetscObjectQuery((PetscObject) A, "DMPlex_MFFE", (PetscObject *) &container);CHKERRQ(ierr);
+  if (container) {ierr = PetscContainerGetPointer(container, (void **) mf);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATMFFE = "mffe" - A matrix-free Jacobian for a DMPlex with a PetscDS, obtained from DMCreateMatrix() after DMSetMatType() or -dm_mat_type mffe
+
+   Notes:
+   The matrix is a MATSHELL that holds no values. When the Jacobian is computed, for example by DMPlexSNESComputeJacobianFEM(),
+   it only records the local solution, the time and the shift. MatMult() then applies the element Jacobians, through
+   PetscFEIntegrateJacobianAction() when every field has an element type that provides it, such as PETSCFETENSOR, and
+   otherwise by forming the element matrices of a bounded number of cells at a time (about 2^18 values) and multiplying
+   them. MatGetDiagonal() forms the blocks of the element matrices that couple each field to itself, also a bounded
+   number of cells at a time, and keeps their diagonals, so that PCJACOBI and Chebyshev smoothers can be used. It has
+   no sum-factorized version: even for PETSCFETENSOR it costs as much as integrating those blocks of the Jacobian,
+   so it should be computed once per Jacobian, as PCJACOBI does.
+
+   Since PCMG rediscretizes the coarser levels with DMCreateMatrix() on the coarsened DMs, -dm_mat_type mffe -pc_type mg
+   gives geometric multigrid without assembling any level. The coarse level is also matrix-free, so it needs an iterative
+   solver such as -mg_coarse_ksp_type cg -mg_coarse_pc_type jacobi.
+
+   Boundary integrals of the Jacobian are not applied, so computing the Jacobian into this matrix raises PETSC_ERR_SUP when
+   the PetscDS has a boundary Jacobian or a finite volume field.
+
+   Level: intermediate
+
+.seealso: DMCreateMatrix(), DMSetMatType(), DMPlexSNESComputeJacobianFEM(), DMPlexSNESComputeJacobianActionFEM(), MATSHELL, PETSCFETENSOR
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "DMCreateMatrix_Plex_MFFE"
+static PetscErrorCode DMCreateMatrix_Plex_MFFE(DM dm, Mat J)
+{
+  DMPlex_MFFE   *mf;
+  PetscContainer container;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNew(&mf);CHKERRQ(ierr);
+  ierr = MatSetType(J, MATSHELL);CHKERRQ(ierr);
+  ierr = MatSetUp(J);CHKERRQ(ierr);
+  ierr = MatShellSetContext(J, mf);CHKERRQ(ierr);
+  ierr = PetscContainerCreate(PetscObjectComm((PetscObject) J), &container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container, mf);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container, DMPlexMFFEDestroy_Private);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject) J, "DMPlex_MFFE", (PetscObject) container);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+  ierr = MatSetDM(J, dm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMCreateMatrix_Plex"
 PetscErrorCode DMCreateMatrix_Plex(DM dm, Mat *J)
@@ -908,7 +986,7 @@ PetscErrorCode DMCreateMatrix_Plex(DM dm, Mat *J)
   PetscSection           sectionGlobal;
   PetscInt               bs = -1, mbs;
   PetscInt               localSize;
-  PetscBool              isShell, isBlock, isSeqBlock, isMPIBlock, isSymBlock, isSymSeqBlock, isSymMPIBlock, isMatIS;
+  PetscBool              isShell, isBlock, isSeqBlock, isMPIBlock, isSymBlock, isSymSeqBlock, isSymMPIBlock, isMatIS, isMFFE;
   PetscErrorCode         ierr;
   MatType                mtype;
   ISLocalToGlobalMapping ltog;
@@ -921,6 +999,11 @@ PetscErrorCode DMCreateMatrix_Plex(DM dm, Mat *J)
   ierr = PetscSectionGetConstrainedStorageSize(sectionGlobal, &localSize);CHKERRQ(ierr);
   ierr = MatCreate(PetscObjectComm((PetscObject)dm), J);CHKERRQ(ierr);
   ierr = MatSetSizes(*J, localSize, localSize, PETSC_DETERMINE, PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = PetscStrcmp(mtype, MATMFFE, &isMFFE);CHKERRQ(ierr);
+  if (isMFFE) {
+    ierr = DMCreateMatrix_Plex_MFFE(dm, *J);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = MatSetType(*J, mtype);CHKERRQ(ierr);
   ierr = MatSetFromOptions(*J);CHKERRQ(ierr);
   ierr = MatGetBlockSize(*J, &mbs);CHKERRQ(ierr);
@@ -2909,7 +2992,7 @@ PetscErrorCode DMPlexGetHeightStratum(DM dm, PetscInt stratumValue, PetscInt *st
     PetscFunctionReturn(0);
   }
   ierr = DMPlexGetDepthLabel(dm, &label);CHKERRQ(ierr);
-  if (!label) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_ARG_WRONG, "No label named depth was found");CHKERRQ(ierr);
+  if (!label) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_ARG_WRONG, "No label named depth was found");
   ierr = DMLabelGetNumValues(label, &depth);CHKERRQ(ierr);
   ierr = DMLabelGetStratumBounds(label, depth-1-stratumValue, start, end);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -3565,6 +3648,41 @@ PETSC_STATIC_INLINE PetscErrorCode DMPlexVecGetClosure_Depth1_Static(DM dm, Pets
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexVecGetClosure_Cache_Static"
+PETSC_STATIC_INLINE PetscErrorCode DMPlexVecGetClosure_Cache_Static(DM dm, DMPlex_ClosureCache cache, Vec v, PetscInt point, PetscInt *csize, PetscScalar *values[])
+{
+  const PetscInt     off  = cache->off[point-cache->cStart];
+  const PetscInt     size = cache->off[point-cache->cStart+1] - off;
+  const PetscInt    *idx  = &cache->idx[off];
+  const PetscScalar *vArray;
+  PetscScalar       *array;
+  PetscInt           i;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBeginHot;
+  if (!values) {
+    if (csize) *csize = size;
+    PetscFunctionReturn(0);
+  }
+  if (!*values) {
+    ierr = DMGetWorkArray(dm, size, PETSC_SCALAR, &array);CHKERRQ(ierr);
+  } else {
+    if (size > *csize) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Size of input array %D < actual size %D", *csize, size);
+    array = *values;
+  }
+  ierr = VecGetArrayRead(v, &vArray);CHKERRQ(ierr);
+  for (i = 0; i < size; ++i) array[i] = vArray[idx[i]];
+  ierr = VecRestoreArrayRead(v, &vArray);CHKERRQ(ierr);
+  if (!*values) {
+    if (csize) *csize = size;
+    *values = array;
+  } else {
+    *csize = size;
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexVecGetClosure_Static"
 PETSC_STATIC_INLINE PetscErrorCode DMPlexVecGetClosure_Static(PetscSection section, PetscInt numPoints, const PetscInt points[], const PetscInt perm[], const PetscScalar vArray[], PetscInt *size, PetscScalar array[])
@@ -3659,6 +3777,7 @@ PETSC_STATIC_INLINE PetscErrorCode DMPlexVecGetClosure_Fields_Static(PetscSectio
 @*/
 PetscErrorCode DMPlexVecGetClosure(DM dm, PetscSection section, Vec v, PetscInt point, PetscInt *csize, PetscScalar *values[])
 {
+  DMPlex_ClosureCache cache;
   PetscSection    clSection;
   IS              clPoints;
   PetscScalar    *array, *vArray;
@@ -3672,6 +3791,11 @@ PetscErrorCode DMPlexVecGetClosure(DM dm, PetscSection section, Vec v, PetscInt
   if (!section) {ierr = DMGetDefaultSection(dm, &section);CHKERRQ(ierr);}
   PetscValidHeaderSpecific(section, PETSC_SECTION_CLASSID, 2);
   PetscValidHeaderSpecific(v, VEC_CLASSID, 3);
+  ierr = DMPlexGetClosureCache_Internal(dm, section, NULL, &cache);CHKERRQ(ierr);
+  if (cache && (point >= cache->cStart) && (point < cache->cEnd)) {
+    ierr = DMPlexVecGetClosure_Cache_Static(dm, cache, v, point, csize, values);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = DMPlexGetDepth(dm, &depth);CHKERRQ(ierr);
   ierr = PetscSectionGetNumFields(section, &numFields);CHKERRQ(ierr);
   if (depth == 1 && numFields < 2) {
@@ -3889,10 +4013,11 @@ PETSC_STATIC_INLINE PetscErrorCode updatePointFields_private(PetscSection sectio
         fuse(&a[k], values[perm ? perm[foffset+k] : foffset+k]);
       }
     } else {
-      for (k = fdof/fcomp-1; k >= 0; --k) {
+      /* Walk the dofs of the point in order so that cind follows the sorted constraint indices */
+      for (k = 0; k < fdof/fcomp; ++k) {
         for (c = 0; c < fcomp; ++c) {
           if ((cind < fcdof) && (k*fcomp+c == fcdofs[cind])) {++cind; continue;}
-          fuse(&a[(fdof/fcomp-1-k)*fcomp+c], values[perm ? perm[foffset+k*fcomp+c] : foffset+k*fcomp+c]);
+          fuse(&a[k*fcomp+c], values[perm ? perm[foffset+(fdof/fcomp-1-k)*fcomp+c] : foffset+(fdof/fcomp-1-k)*fcomp+c]);
         }
       }
     }
@@ -3926,10 +4051,10 @@ PETSC_STATIC_INLINE PetscErrorCode updatePointFieldsBC_private(PetscSection sect
         }
       }
     } else {
-      for (k = fdof/fcomp-1; k >= 0; --k) {
+      for (k = 0; k < fdof/fcomp; ++k) {
         for (c = 0; c < fcomp; ++c) {
           if ((cind < fcdof) && (k*fcomp+c == fcdofs[cind])) {
-            fuse(&a[(fdof/fcomp-1-k)*fcomp+c], values[perm ? perm[foffset+k*fcomp+c] : foffset+k*fcomp+c]);
+            fuse(&a[k*fcomp+c], values[perm ? perm[foffset+(fdof/fcomp-1-k)*fcomp+c] : foffset+(fdof/fcomp-1-k)*fcomp+c]);
             ++cind;
           }
         }
@@ -3940,6 +4065,48 @@ PETSC_STATIC_INLINE PetscErrorCode updatePointFieldsBC_private(PetscSection sect
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexVecSetClosure_Cache_Static"
+PETSC_STATIC_INLINE PetscErrorCode DMPlexVecSetClosure_Cache_Static(DM dm, DMPlex_ClosureCache cache, Vec v, PetscInt point, const PetscScalar values[], InsertMode mode)
+{
+  const PetscInt  off  = cache->off[point-cache->cStart];
+  const PetscInt  size = cache->off[point-cache->cStart+1] - off;
+  const PetscInt *idx  = &cache->idx[off];
+  PetscBT         bc   = cache->bc;
+  PetscScalar    *array;
+  PetscInt        i;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBeginHot;
+  ierr = VecGetArray(v, &array);CHKERRQ(ierr);
+  switch (mode) {
+  case INSERT_VALUES:
+    if (bc) {for (i = 0; i < size; ++i) if (!PetscBTLookup(bc, off+i)) array[idx[i]] = values[i];}
+    else    {for (i = 0; i < size; ++i) array[idx[i]] = values[i];}
+    break;
+  case INSERT_ALL_VALUES:
+    for (i = 0; i < size; ++i) array[idx[i]] = values[i];
+    break;
+  case INSERT_BC_VALUES:
+    if (bc) {for (i = 0; i < size; ++i) if (PetscBTLookup(bc, off+i)) array[idx[i]] = values[i];}
+    break;
+  case ADD_VALUES:
+    if (bc) {for (i = 0; i < size; ++i) if (!PetscBTLookup(bc, off+i)) array[idx[i]] += values[i];}
+    else    {for (i = 0; i < size; ++i) array[idx[i]] += values[i];}
+    break;
+  case ADD_ALL_VALUES:
+    for (i = 0; i < size; ++i) array[idx[i]] += values[i];
+    break;
+  case ADD_BC_VALUES:
+    if (bc) {for (i = 0; i < size; ++i) if (PetscBTLookup(bc, off+i)) array[idx[i]] += values[i];}
+    break;
+  default:
+    SETERRQ1(PetscObjectComm((PetscObject)dm), PETSC_ERR_ARG_OUTOFRANGE, "Invalid insert mode %d", mode);
+  }
+  ierr = VecRestoreArray(v, &array);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexVecSetClosure_Depth1_Static"
 PETSC_STATIC_INLINE PetscErrorCode DMPlexVecSetClosure_Depth1_Static(DM dm, PetscSection section, Vec v, PetscInt point, const PetscScalar values[], InsertMode mode)
@@ -4024,6 +4191,7 @@ PETSC_STATIC_INLINE PetscErrorCode DMPlexVecSetClosure_Depth1_Static(DM dm, Pets
 @*/
 PetscErrorCode DMPlexVecSetClosure(DM dm, PetscSection section, Vec v, PetscInt point, const PetscScalar values[], InsertMode mode)
 {
+  DMPlex_ClosureCache cache;
   PetscSection    clSection;
   IS              clPoints;
   PetscScalar    *array;
@@ -4037,6 +4205,11 @@ PetscErrorCode DMPlexVecSetClosure(DM dm, PetscSection section, Vec v, PetscInt
   if (!section) {ierr = DMGetDefaultSection(dm, &section);CHKERRQ(ierr);}
   PetscValidHeaderSpecific(section, PETSC_SECTION_CLASSID, 2);
   PetscValidHeaderSpecific(v, VEC_CLASSID, 3);
+  ierr = DMPlexGetClosureCache_Internal(dm, section, NULL, &cache);CHKERRQ(ierr);
+  if (cache && (point >= cache->cStart) && (point < cache->cEnd)) {
+    ierr = DMPlexVecSetClosure_Cache_Static(dm, cache, v, point, values, mode);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = DMPlexGetDepth(dm, &depth);CHKERRQ(ierr);
   ierr = PetscSectionGetNumFields(section, &numFields);CHKERRQ(ierr);
   if (depth == 1 && numFields < 2 && mode == ADD_VALUES) {
@@ -5073,6 +5246,7 @@ PetscErrorCode DMPlexRestoreClosureIndices(DM dm, PetscSection section, PetscSec
 PetscErrorCode DMPlexMatSetClosure(DM dm, PetscSection section, PetscSection globalSection, Mat A, PetscInt point, const PetscScalar values[], InsertMode mode)
 {
   DM_Plex        *mesh   = (DM_Plex*) dm->data;
+  DMPlex_ClosureCache cache;
   PetscSection    clSection;
   IS              clPoints;
   PetscInt       *points = NULL, *newPoints;
@@ -5090,6 +5264,30 @@ PetscErrorCode DMPlexMatSetClosure(DM dm, PetscSection section, PetscSection glo
   if (!globalSection) {ierr = DMGetDefaultGlobalSection(dm, &globalSection);CHKERRQ(ierr);}
   PetscValidHeaderSpecific(globalSection, PETSC_SECTION_CLASSID, 3);
   PetscValidHeaderSpecific(A, MAT_CLASSID, 4);
+  ierr = DMPlexGetClosureCache_Internal(dm, section, globalSection, &cache);CHKERRQ(ierr);
+  if (cache && cache->gidx && (point >= cache->cStart) && (point < cache->cEnd)) {
+    const PetscInt *cindices = &cache->gidx[cache->off[point-cache->cStart]];
+
+    numIndices = cache->off[point-cache->cStart+1] - cache->off[point-cache->cStart];
+    if (mesh->printSetValues) {ierr = DMPlexPrintMatSetValues(PETSC_VIEWER_STDOUT_SELF, A, point, numIndices, cindices, 0, NULL, values);CHKERRQ(ierr);}
+    ierr = MatSetValues(A, numIndices, cindices, numIndices, cindices, values, mode);
+    if (ierr) {
+      PetscMPIInt    rank;
+      PetscErrorCode ierr2;
+
+      ierr2 = MPI_Comm_rank(PetscObjectComm((PetscObject)A), &rank);CHKERRQ(ierr2);
+      ierr2 = (*PetscErrorPrintf)("[%d]ERROR in DMPlexMatSetClosure\n", rank);CHKERRQ(ierr2);
+      ierr2 = DMPlexPrintMatSetValues(PETSC_VIEWER_STDERR_SELF, A, point, numIndices, cindices, 0, NULL, values);CHKERRQ(ierr2);
+      CHKERRQ(ierr);
+    }
+    if (mesh->printFEM > 1) {
+      PetscInt i;
+      ierr = PetscPrintf(PETSC_COMM_SELF, "  Indices:");CHKERRQ(ierr);
+      for (i = 0; i < numIndices; ++i) {ierr = PetscPrintf(PETSC_COMM_SELF, " %d", cindices[i]);CHKERRQ(ierr);}
+      ierr = PetscPrintf(PETSC_COMM_SELF, "\n");CHKERRQ(ierr);
+    }
+    PetscFunctionReturn(0);
+  }
   ierr = PetscSectionGetNumFields(section, &numFields);CHKERRQ(ierr);
   if (numFields > 31) SETERRQ1(PetscObjectComm((PetscObject)dm), PETSC_ERR_ARG_OUTOFRANGE, "Number of fields %D limited to 31", numFields);
   ierr = PetscMemzero(offsets, 32 * sizeof(PetscInt));CHKERRQ(ierr);
@@ -5884,7 +6082,7 @@ PetscErrorCode DMCreateInterpolation_Plex(DM dmCoarse, DM dmFine, Mat *interpola
   PetscInt       m, n;
   void          *ctx;
   DM             cdm;
-  PetscBool      regular;
+  PetscBool      regular, isMFFE;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -5895,7 +6093,9 @@ PetscErrorCode DMCreateInterpolation_Plex(DM dmCoarse, DM dmFine, Mat *interpola
 
   ierr = MatCreate(PetscObjectComm((PetscObject) dmCoarse), interpolation);CHKERRQ(ierr);
   ierr = MatSetSizes(*interpolation, m, n, PETSC_DETERMINE, PETSC_DETERMINE);CHKERRQ(ierr);
-  ierr = MatSetType(*interpolation, dmCoarse->mattype);CHKERRQ(ierr);
+  /* A matrix-free operator still uses an assembled interpolator */
+  ierr = PetscStrcmp(dmCoarse->mattype, MATMFFE, &isMFFE);CHKERRQ(ierr);
+  ierr = MatSetType(*interpolation, isMFFE ? MATAIJ : dmCoarse->mattype);CHKERRQ(ierr);
   ierr = DMGetApplicationContext(dmFine, &ctx);CHKERRQ(ierr);
 
   ierr = DMGetCoarseDM(dmFine, &cdm);CHKERRQ(ierr);
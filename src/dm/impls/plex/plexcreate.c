@@ -324,7 +324,7 @@ PetscErrorCode DMPlexCreateCubeBoundary(DM dm, const PetscReal lower[], const Pe
   PetscScalar    *coords;
   PetscInt       coordSize;
   PetscMPIInt    rank;
-  PetscInt       v, vx, vy, vz;
+  PetscInt       v, vx = 0, vy = 0, vz = 0;
   PetscInt       voffset, iface=0, cone[4];
   PetscErrorCode ierr;
 
@@ -1019,13 +1019,13 @@ extern PetscErrorCode DMComputeL2GradientDiff_Plex(DM,PetscReal,PetscErrorCode(*
 extern PetscErrorCode DMComputeL2FieldDiff_Plex(DM,PetscReal,PetscErrorCode(**)(PetscInt,PetscReal,const PetscReal[],PetscInt,PetscScalar *,void *),void **,Vec,PetscReal *);
 
 #undef __FUNCT__
-#define __FUNCT__ "DMPlexReplace_Static"
+#define __FUNCT__ "DMPlexReplace_Internal"
 /* Replace dm with the contents of dmNew
    - Share the DM_Plex structure
    - Share the coordinates
    - Share the SF
 */
-static PetscErrorCode DMPlexReplace_Static(DM dm, DM dmNew)
+PetscErrorCode DMPlexReplace_Internal(DM dm, DM dmNew)
 {
   PetscSF          sf;
   DM               coordDM, coarseDM;
@@ -1123,6 +1123,7 @@ static PetscErrorCode DMPlexSwap_Static(DM dmA, DM dmB)
 PetscErrorCode  DMSetFromOptions_NonRefinement_Plex(PetscOptionItems *PetscOptionsObject,DM dm)
 {
   DM_Plex       *mesh = (DM_Plex*) dm->data;
+  PetscBool      useClosureCache, flg;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -1137,6 +1138,11 @@ PetscErrorCode  DMSetFromOptions_NonRefinement_Plex(PetscOptionItems *PetscOptio
   /* Projection behavior */
   ierr = PetscOptionsInt("-dm_plex_max_projection_height", "Maxmimum mesh point height used to project locally", "DMPlexSetMaxProjectionHeight", 0, &mesh->maxProjectionHeight, NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-dm_plex_regular_refinement", "Use special nested projection algorithm for regular refinement", "DMPlexSetRegularRefinement", mesh->regularRefinement, &mesh->regularRefinement, NULL);CHKERRQ(ierr);
+  /* FEM assembly */
+  ierr = PetscOptionsInt("-dm_plex_assembly_threads", "Number of threads of the colored FEM residual and Jacobian assembly, 0 for the serial loop", "DMPlexSetAssemblyThreads", mesh->assemblyThreads, &mesh->assemblyThreads, NULL);CHKERRQ(ierr);
+  /* Closure operations */
+  ierr = PetscOptionsBool("-dm_plex_closure_cache", "Cache the closure dofs of the cells for each section", "DMPlexSetUseClosureCache", mesh->useClosureCache, &useClosureCache, &flg);CHKERRQ(ierr);
+  if (flg) {ierr = DMPlexSetUseClosureCache(dm, useClosureCache);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
 
@@ -1188,7 +1194,7 @@ PetscErrorCode  DMSetFromOptions_Plex(PetscOptionItems *PetscOptionsObject,DM dm
       ierr = DMSetFromOptions_NonRefinement_Plex(PetscOptionsObject, dm);CHKERRQ(ierr);
       ierr = DMRefine(dm, PetscObjectComm((PetscObject) dm), &refinedMesh);CHKERRQ(ierr);
       /* Total hack since we do not pass in a pointer */
-      ierr = DMPlexReplace_Static(dm, refinedMesh);CHKERRQ(ierr);
+      ierr = DMPlexReplace_Internal(dm, refinedMesh);CHKERRQ(ierr);
       ierr = DMSetFromOptions_NonRefinement_Plex(PetscOptionsObject, dm);CHKERRQ(ierr);
       ierr = DMDestroy(&refinedMesh);CHKERRQ(ierr);
     }
@@ -1214,7 +1220,7 @@ PetscErrorCode  DMSetFromOptions_Plex(PetscOptionItems *PetscOptionsObject,DM dm
       ierr = DMSetFromOptions_NonRefinement_Plex(PetscOptionsObject, dm);CHKERRQ(ierr);
       ierr = DMCoarsen(dm, PetscObjectComm((PetscObject) dm), &coarseMesh);CHKERRQ(ierr);
       /* Total hack since we do not pass in a pointer */
-      ierr = DMPlexReplace_Static(dm, coarseMesh);CHKERRQ(ierr);
+      ierr = DMPlexReplace_Internal(dm, coarseMesh);CHKERRQ(ierr);
       ierr = DMSetFromOptions_NonRefinement_Plex(PetscOptionsObject, dm);CHKERRQ(ierr);
       ierr = DMDestroy(&coarseMesh);CHKERRQ(ierr);
     }
@@ -1419,6 +1425,9 @@ PETSC_EXTERN PetscErrorCode DMCreate_Plex(DM dm)
   mesh->useAnchors          = PETSC_FALSE;
 
   mesh->maxProjectionHeight = 0;
+  mesh->assemblyThreads     = 0;
+  mesh->useClosureCache     = PETSC_FALSE;
+  mesh->closureCache        = NULL;
 
   mesh->printSetValues = PETSC_FALSE;
   mesh->printFEM       = 0;
@@ -1493,6 +1502,8 @@ static PetscErrorCode DMPlexBuildFromCellList_Parallel_Private(DM dm, PetscInt n
   ierr = PetscMalloc1(numVerticesAdj, &verticesAdj);CHKERRQ(ierr);
   off = 0; ierr = PetscHashIGetKeys(vhash, &off, verticesAdj);CHKERRQ(ierr);
   if (off != numVerticesAdj) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Invalid number of local vertices %D should be %D", off, numVerticesAdj);
+  /* The hash does not order its keys, and they are searched below */
+  ierr = PetscSortInt(numVerticesAdj, verticesAdj);CHKERRQ(ierr);
   ierr = PetscMalloc1(numVerticesAdj, &remoteVerticesAdj);CHKERRQ(ierr);
   for (v = 0; v < numVerticesAdj; ++v) {
     const PetscInt gv = verticesAdj[v];
@@ -1606,6 +1617,175 @@ static PetscErrorCode DMPlexBuildCoordinates_Parallel_Private(DM dm, PetscInt sp
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexBuildPointSF_Parallel_Private"
+/*
+  This builds the pointSF of an interpolated mesh from the global vertex numbers given by sfVert. A point is identified by
+  the sorted global numbers of its vertices, and the copies of each point whose vertices are all shared are matched by
+  the process owning its smallest vertex, which makes the copy on the highest rank the root.
+*/
+static PetscErrorCode DMPlexBuildPointSF_Parallel_Private(DM dm, PetscInt numCells, PetscSF sfVert)
+{
+  MPI_Comm           comm;
+  MPI_Datatype       keyType;
+  PetscSF            sfProcess, sfPoint;
+  PetscSFNode       *remoteProc, *owners, *recvOwners, *remotePoints;
+  PetscSection       sendSection, recvSection, ownerSection;
+  PetscLayout        vLayout;
+  const PetscSFNode *iremote;
+  const PetscInt    *vrange, *degree;
+  PetscInt          *rootShared, *shared, *gvert, *keys, *recvKeys, *points, *dest, *count, *perm, *localPoints;
+  PetscInt           numVertices, numVerticesAdj, numKeys = 0, numRecv, numLeaves = 0, pStart, pEnd, vStart, vEnd, p, k, v, off;
+  PetscMPIInt        rank, numProcs, r;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject) dm, &comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = DMPlexGetChart(dm, &pStart, &pEnd);CHKERRQ(ierr);
+  ierr = DMPlexGetDepthStratum(dm, 0, &vStart, &vEnd);CHKERRQ(ierr);
+  ierr = PetscSFGetGraph(sfVert, &numVertices, &numVerticesAdj, NULL, &iremote);CHKERRQ(ierr);
+  if (vEnd-vStart != numVerticesAdj) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_PLIB, "Number of vertices %D should be %D", vEnd-vStart, numVerticesAdj);
+  ierr = PetscLayoutCreate(comm, &vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetLocalSize(vLayout, numVertices);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(vLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(vLayout, &vrange);CHKERRQ(ierr);
+  /* Mark the vertices having copies on other processes */
+  ierr = PetscMalloc3(numVertices, &rootShared, numVerticesAdj, &shared, numVerticesAdj, &gvert);CHKERRQ(ierr);
+  ierr = PetscSFComputeDegreeBegin(sfVert, &degree);CHKERRQ(ierr);
+  ierr = PetscSFComputeDegreeEnd(sfVert, &degree);CHKERRQ(ierr);
+  for (v = 0; v < numVertices; ++v) rootShared[v] = degree[v] > 1 ? 1 : 0;
+  ierr = PetscSFBcastBegin(sfVert, MPIU_INT, rootShared, shared);CHKERRQ(ierr);
+  ierr = PetscSFBcastEnd(sfVert, MPIU_INT, rootShared, shared);CHKERRQ(ierr);
+  for (v = 0; v < numVerticesAdj; ++v) gvert[v] = vrange[iremote[v].rank] + iremote[v].index;
+  /* A key holds the sorted global vertex numbers of a point, padded with -1, and the point itself */
+  ierr = PetscMalloc2((pEnd-pStart)*6, &keys, pEnd-pStart, &dest);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(sendSection, 0, numProcs);CHKERRQ(ierr);
+  for (p = numCells; p < pEnd; ++p) {
+    PetscInt *key = &keys[numKeys*6], *closure = NULL, closureSize, cl, nv = 0;
+
+    ierr = DMPlexGetTransitiveClosure(dm, p, PETSC_TRUE, &closureSize, &closure);CHKERRQ(ierr);
+    for (cl = 0; cl < closureSize*2; cl += 2) {
+      const PetscInt q = closure[cl];
+
+      if ((q < vStart) || (q >= vEnd)) continue;
+      if (!shared[q-vStart] || nv >= 4) {nv = -1; break;}
+      key[nv++] = gvert[q-vStart];
+    }
+    ierr = DMPlexRestoreTransitiveClosure(dm, p, PETSC_TRUE, &closureSize, &closure);CHKERRQ(ierr);
+    if (nv <= 0) continue;
+    ierr = PetscSortInt(nv, key);CHKERRQ(ierr);
+    for (v = nv; v < 4; ++v) key[v] = -1;
+    key[4] = rank;
+    key[5] = p;
+    ierr = PetscLayoutFindOwner(vLayout, key[0], &dest[numKeys]);CHKERRQ(ierr);
+    ierr = PetscSectionAddDof(sendSection, dest[numKeys], 1);CHKERRQ(ierr);
+    ++numKeys;
+  }
+  ierr = PetscSectionSetUp(sendSection);CHKERRQ(ierr);
+  ierr = PetscMalloc2(numKeys*6, &recvKeys, numProcs, &count);CHKERRQ(ierr);
+  ierr = PetscMalloc1(numKeys, &points);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numProcs * sizeof(PetscInt));CHKERRQ(ierr);
+  for (k = 0; k < numKeys; ++k) {
+    ierr = PetscSectionGetOffset(sendSection, dest[k], &off);CHKERRQ(ierr);
+    ierr = PetscMemcpy(&recvKeys[(off+count[dest[k]])*6], &keys[k*6], 6 * sizeof(PetscInt));CHKERRQ(ierr);
+    points[off+count[dest[k]]++] = keys[k*6+5];
+  }
+  ierr = PetscFree2(keys, dest);CHKERRQ(ierr);
+  keys = recvKeys;
+  /* Send each key to the owner of its smallest vertex; as in DMPlexDistribute(), sfProcess connects every pair of
+     processes, so the counts are exchanged all-to-all while only the nonzero ones carry data */
+  ierr = PetscMalloc1(numProcs, &remoteProc);CHKERRQ(ierr);
+  for (r = 0; r < numProcs; ++r) {
+    remoteProc[r].rank  = r;
+    remoteProc[r].index = rank;
+  }
+  ierr = PetscSFCreate(comm, &sfProcess);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(sfProcess, numProcs, numProcs, NULL, PETSC_OWN_POINTER, remoteProc, PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = MPI_Type_contiguous(6, MPIU_INT, &keyType);CHKERRQ(ierr);
+  ierr = MPI_Type_commit(&keyType);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &recvSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(dm, sfProcess, sendSection, keyType, keys, recvSection, (void **) &recvKeys);CHKERRQ(ierr);
+  ierr = MPI_Type_free(&keyType);CHKERRQ(ierr);
+  ierr = PetscFree2(keys, count);CHKERRQ(ierr);
+  /* Match the copies of each point, which all have the same smallest vertex */
+  ierr = PetscSectionGetStorageSize(recvSection, &numRecv);CHKERRQ(ierr);
+  ierr = PetscMalloc3(numRecv, &owners, numRecv, &dest, numRecv, &perm);CHKERRQ(ierr);
+  for (k = 0; k < numRecv; ++k) {dest[k] = recvKeys[k*6]; perm[k] = k;}
+  ierr = PetscSortIntWithArray(numRecv, dest, perm);CHKERRQ(ierr);
+  for (k = 0; k < numRecv; ++k) owners[k].rank = -1;
+  for (k = 0; k < numRecv;) {
+    PetscInt kEnd, i, j;
+
+    for (kEnd = k+1; kEnd < numRecv && dest[kEnd] == dest[k]; ++kEnd);
+    for (i = k; i < kEnd; ++i) {
+      const PetscInt *key = &recvKeys[perm[i]*6];
+      PetscSFNode     root;
+
+      if (owners[perm[i]].rank >= 0) continue;
+      root.rank = key[4]; root.index = key[5];
+      for (j = i+1; j < kEnd; ++j) {
+        const PetscInt *okey = &recvKeys[perm[j]*6];
+
+        if ((okey[1] != key[1]) || (okey[2] != key[2]) || (okey[3] != key[3])) continue;
+        if (okey[4] > root.rank) {root.rank = okey[4]; root.index = okey[5];}
+      }
+      for (j = i; j < kEnd; ++j) {
+        const PetscInt *okey = &recvKeys[perm[j]*6];
+
+        if ((okey[1] != key[1]) || (okey[2] != key[2]) || (okey[3] != key[3])) continue;
+        owners[perm[j]] = root;
+      }
+    }
+    k = kEnd;
+  }
+  ierr = PetscFree(recvKeys);CHKERRQ(ierr);
+  /* Return the owner of each point to the processes which sent it */
+  ierr = PetscSectionCreate(comm, &ownerSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(dm, sfProcess, recvSection, MPIU_2INT, owners, ownerSection, (void **) &recvOwners);CHKERRQ(ierr);
+  ierr = PetscFree3(owners, dest, perm);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sfProcess);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&recvSection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&ownerSection);CHKERRQ(ierr);
+  /* The section offsets of sent and returned keys agree, so we recover the points in the order they were sent */
+  ierr = PetscMalloc1(pEnd-pStart, &remotePoints);CHKERRQ(ierr);
+  for (p = pStart; p < pEnd; ++p) remotePoints[p-pStart].rank = -1;
+  for (r = 0; r < numProcs; ++r) {
+    PetscInt dof, d;
+
+    ierr = PetscSectionGetDof(sendSection, r, &dof);CHKERRQ(ierr);
+    ierr = PetscSectionGetOffset(sendSection, r, &off);CHKERRQ(ierr);
+    for (d = off; d < off+dof; ++d) {
+      if (recvOwners[d].rank != rank) {remotePoints[points[d]-pStart] = recvOwners[d]; ++numLeaves;}
+    }
+  }
+  ierr = PetscFree(recvOwners);CHKERRQ(ierr);
+  ierr = PetscFree(points);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&sendSection);CHKERRQ(ierr);
+  ierr = PetscFree3(rootShared, shared, gvert);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&vLayout);CHKERRQ(ierr);
+  {
+    PetscSFNode *remote;
+    PetscInt     l = 0;
+
+    ierr = PetscMalloc1(numLeaves, &localPoints);CHKERRQ(ierr);
+    ierr = PetscMalloc1(numLeaves, &remote);CHKERRQ(ierr);
+    for (p = pStart; p < pEnd; ++p) {
+      if (remotePoints[p-pStart].rank < 0) continue;
+      localPoints[l] = p;
+      remote[l++]    = remotePoints[p-pStart];
+    }
+    ierr = PetscFree(remotePoints);CHKERRQ(ierr);
+    ierr = DMGetPointSF(dm, &sfPoint);CHKERRQ(ierr);
+    ierr = PetscObjectSetName((PetscObject) sfPoint, "point SF");CHKERRQ(ierr);
+    ierr = PetscSFSetGraph(sfPoint, pEnd-pStart, numLeaves, localPoints, PETSC_OWN_POINTER, remote, PETSC_OWN_POINTER);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexCreateFromCellListParallel"
 /*@C
@@ -1657,6 +1837,22 @@ $        3
 .seealso: DMPlexCreateFromCellList(), DMPlexCreateFromDAG(), DMPlexCreate()
 @*/
 PetscErrorCode DMPlexCreateFromCellListParallel(MPI_Comm comm, PetscInt dim, PetscInt numCells, PetscInt numVertices, PetscInt numCorners, PetscBool interpolate, const int cells[], PetscInt spaceDim, const double vertexCoords[], DM *dm)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = DMPlexCreateFromCellListParallel_Internal(comm, dim, numCells, numVertices, numCorners, interpolate, cells, spaceDim, vertexCoords, NULL, dm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexCreateFromCellListParallel_Internal"
+/*
+  This is DMPlexCreateFromCellListParallel() which can also return the vertex SF. Its roots are the vertices owned by this
+  process in the global vertex numbering, and its leaf v is the vertex vStart+v of the new mesh, so that readers can
+  attach data given in the global vertex numbering, such as labels.
+*/
+PetscErrorCode DMPlexCreateFromCellListParallel_Internal(MPI_Comm comm, PetscInt dim, PetscInt numCells, PetscInt numVertices, PetscInt numCorners, PetscBool interpolate, const int cells[], PetscInt spaceDim, const double vertexCoords[], PetscSF *vertexSF, DM *dm)
 {
   PetscSF        sfVert;
   PetscErrorCode ierr;
@@ -1669,14 +1865,150 @@ PetscErrorCode DMPlexCreateFromCellListParallel(MPI_Comm comm, PetscInt dim, Pet
   ierr = DMSetDimension(*dm, dim);CHKERRQ(ierr);
   ierr = DMPlexBuildFromCellList_Parallel_Private(*dm, numCells, numVertices, numCorners, cells, &sfVert);CHKERRQ(ierr);
   if (interpolate) {
-    DM idm = NULL;
+    DM      idm = NULL;
+    PetscSF sfPoint;
 
+    /* The pointSF is rebuilt from the global vertex numbers, which also matches faces and edges whose vertices are owned elsewhere */
+    ierr = PetscSFCreate(comm, &sfPoint);CHKERRQ(ierr);
+    ierr = DMSetPointSF(*dm, sfPoint);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&sfPoint);CHKERRQ(ierr);
     ierr = DMPlexInterpolate(*dm, &idm);CHKERRQ(ierr);
     ierr = DMDestroy(dm);CHKERRQ(ierr);
     *dm  = idm;
+    ierr = DMPlexBuildPointSF_Parallel_Private(*dm, numCells, sfVert);CHKERRQ(ierr);
   }
   ierr = DMPlexBuildCoordinates_Parallel_Private(*dm, spaceDim, numCells, sfVert, vertexCoords);CHKERRQ(ierr);
-  ierr = PetscSFDestroy(&sfVert);CHKERRQ(ierr);
+  if (vertexSF) *vertexSF = sfVert;
+  else {ierr = PetscSFDestroy(&sfVert);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexSetLabelFromVertexSets_Internal"
+/*
+  This labels the points of a mesh made by DMPlexCreateFromCellListParallel_Internal() which are given by their vertices
+  in the global vertex numbering. Each set holds the label value, the number of vertices, and up to 4 vertices, and may
+  be given on any process. It goes to the owner of its smallest vertex, which passes it on through sfVert to every
+  process having that vertex, and these label the point joining all its vertices, if they have it.
+*/
+PetscErrorCode DMPlexSetLabelFromVertexSets_Internal(DM dm, PetscSF sfVert, const char name[], PetscInt numSets, const PetscInt sets[])
+{
+  MPI_Comm           comm;
+  MPI_Datatype       setType;
+  PetscSF            sfProcess;
+  PetscSFNode       *remoteProc;
+  PetscSection       procSection, recvSection, vertSection, leafSection;
+  PetscLayout        vLayout;
+  const PetscSFNode *iremote;
+  const PetscInt    *vrange;
+  PetscInt          *sendSets, *recvSets, *vertSets, *leafSets, *dest, *count, *gvert, *perm;
+  PetscInt           numVertices, numRecv, nleaves, vStart, s, l, n, off;
+  PetscMPIInt        rank, numProcs, p;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject) dm, &comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = PetscSFGetGraph(sfVert, &numVertices, &nleaves, NULL, &iremote);CHKERRQ(ierr);
+  ierr = PetscLayoutCreate(comm, &vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetLocalSize(vLayout, numVertices);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(vLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(vLayout, &vrange);CHKERRQ(ierr);
+  ierr = DMCreateLabel(dm, name);CHKERRQ(ierr);
+  ierr = MPI_Type_contiguous(6, MPIU_INT, &setType);CHKERRQ(ierr);
+  ierr = MPI_Type_commit(&setType);CHKERRQ(ierr);
+  /* Put the smallest vertex first, and send each set to its owner */
+  ierr = PetscMalloc3(numSets*6, &sendSets, numSets, &dest, numProcs, &count);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &procSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(procSection, 0, numProcs);CHKERRQ(ierr);
+  for (s = 0; s < numSets; ++s) {
+    const PetscInt *set  = &sets[s*6];
+    PetscInt        vmin = 0;
+
+    if ((set[1] < 1) || (set[1] > 4)) SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Invalid number of vertices %D in a point, should be in [1, 4]", set[1]);
+    for (n = 1; n < set[1]; ++n) if (set[2+n] < set[2+vmin]) vmin = n;
+    ierr = PetscLayoutFindOwner(vLayout, set[2+vmin], &dest[s]);CHKERRQ(ierr);
+    ierr = PetscSectionAddDof(procSection, dest[s], 1);CHKERRQ(ierr);
+  }
+  ierr = PetscSectionSetUp(procSection);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numProcs * sizeof(PetscInt));CHKERRQ(ierr);
+  for (s = 0; s < numSets; ++s) {
+    PetscInt *set, vmin = 0;
+
+    ierr = PetscSectionGetOffset(procSection, dest[s], &off);CHKERRQ(ierr);
+    set  = &sendSets[(off+count[dest[s]]++)*6];
+    ierr = PetscMemcpy(set, &sets[s*6], 6 * sizeof(PetscInt));CHKERRQ(ierr);
+    for (n = set[1]; n < 4; ++n) set[2+n] = -1;
+    for (n = 1; n < set[1]; ++n) if (set[2+n] < set[2+vmin]) vmin = n;
+    if (vmin) {const PetscInt tmp = set[2]; set[2] = set[2+vmin]; set[2+vmin] = tmp;}
+  }
+  ierr = PetscMalloc1(numProcs, &remoteProc);CHKERRQ(ierr);
+  for (p = 0; p < numProcs; ++p) {
+    remoteProc[p].rank  = p;
+    remoteProc[p].index = rank;
+  }
+  ierr = PetscSFCreate(comm, &sfProcess);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(sfProcess, numProcs, numProcs, NULL, PETSC_OWN_POINTER, remoteProc, PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &recvSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(dm, sfProcess, procSection, setType, sendSets, recvSection, (void **) &recvSets);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sfProcess);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&procSection);CHKERRQ(ierr);
+  ierr = PetscFree3(sendSets, dest, count);CHKERRQ(ierr);
+  /* Sort the sets received by their smallest vertex, and pass them to each process having that vertex */
+  ierr = PetscSectionGetStorageSize(recvSection, &numRecv);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&recvSection);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(PETSC_COMM_SELF, &vertSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(vertSection, 0, numVertices);CHKERRQ(ierr);
+  for (s = 0; s < numRecv; ++s) {ierr = PetscSectionAddDof(vertSection, recvSets[s*6+2] - vrange[rank], 1);CHKERRQ(ierr);}
+  ierr = PetscSectionSetUp(vertSection);CHKERRQ(ierr);
+  ierr = PetscMalloc2(numRecv*6, &vertSets, numVertices, &count);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numVertices * sizeof(PetscInt));CHKERRQ(ierr);
+  for (s = 0; s < numRecv; ++s) {
+    const PetscInt v = recvSets[s*6+2] - vrange[rank];
+
+    ierr = PetscSectionGetOffset(vertSection, v, &off);CHKERRQ(ierr);
+    ierr = PetscMemcpy(&vertSets[(off+count[v]++)*6], &recvSets[s*6], 6 * sizeof(PetscInt));CHKERRQ(ierr);
+  }
+  ierr = PetscFree(recvSets);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(PETSC_COMM_SELF, &leafSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(dm, sfVert, vertSection, setType, vertSets, leafSection, (void **) &leafSets);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&vertSection);CHKERRQ(ierr);
+  ierr = PetscFree2(vertSets, count);CHKERRQ(ierr);
+  ierr = MPI_Type_free(&setType);CHKERRQ(ierr);
+  /* Find the points among the local vertices */
+  ierr = PetscMalloc2(nleaves, &gvert, nleaves, &perm);CHKERRQ(ierr);
+  for (l = 0; l < nleaves; ++l) {gvert[l] = vrange[iremote[l].rank] + iremote[l].index; perm[l] = l;}
+  ierr = PetscSortIntWithArray(nleaves, gvert, perm);CHKERRQ(ierr);
+  ierr = DMPlexGetDepthStratum(dm, 0, &vStart, NULL);CHKERRQ(ierr);
+  for (l = 0; l < nleaves; ++l) {
+    PetscInt dof;
+
+    ierr = PetscSectionGetDof(leafSection, l, &dof);CHKERRQ(ierr);
+    ierr = PetscSectionGetOffset(leafSection, l, &off);CHKERRQ(ierr);
+    for (s = off; s < off+dof; ++s) {
+      const PetscInt *set = &leafSets[s*6];
+      const PetscInt *join;
+      PetscInt        points[4], joinSize, lv;
+
+      for (n = 0; n < set[1]; ++n) {
+        ierr = PetscFindInt(set[2+n], nleaves, gvert, &lv);CHKERRQ(ierr);
+        if (lv < 0) break;
+        points[n] = vStart + perm[lv];
+      }
+      /* This process does not have all the vertices, so it does not have the point */
+      if (n < set[1]) continue;
+      if (set[1] == 1) {ierr = DMSetLabelValue(dm, name, points[0], set[0]);CHKERRQ(ierr); continue;}
+      ierr = DMPlexGetFullJoin(dm, set[1], points, &joinSize, &join);CHKERRQ(ierr);
+      if (joinSize == 1) {ierr = DMSetLabelValue(dm, name, join[0], set[0]);CHKERRQ(ierr);}
+      ierr = DMPlexRestoreJoin(dm, set[1], points, &joinSize, &join);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscFree2(gvert, perm);CHKERRQ(ierr);
+  ierr = PetscFree(leafSets);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&leafSection);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&vLayout);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1932,9 +2264,15 @@ PetscErrorCode DMPlexCreateFromDAG(DM dm, PetscInt depth, const PetscInt numPoin
   Output Parameter:
 . dm - The DM
 
+  Options Database:
+. -dm_plex_load_parallel - Read Gmsh and HDF5 files in chunks on all processes, rather than on process 0
+
+  Note: A parallel load gives a naive partition of the cells, which should be rebalanced with DMPlexDistribute(). An
+  interpolated HDF5 mesh is read from the cell vertices that DMView() stores with it.
+
   Level: beginner
 
-.seealso: DMPlexCreateFromDAG(), DMPlexCreateFromCellList(), DMPlexCreate()
+.seealso: DMPlexCreateFromDAG(), DMPlexCreateFromCellList(), DMPlexCreate(), DMPlexDistribute()
 @*/
 PetscErrorCode DMPlexCreateFromFile(MPI_Comm comm, const char filename[], PetscBool interpolate, DM *dm)
 {
@@ -230,6 +230,72 @@ PetscErrorCode DMPlexGetMaxProjectionHeight(DM dm, PetscInt *height)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexSetAssemblyThreads"
+/*@
+  DMPlexSetAssemblyThreads - Set the number of threads of the colored cell loop in the FEM residual and Jacobian assembly
+
+  Logically collective on DM
+
+  Input Parameters:
++ dm       - the DMPlex object
+- nthreads - the number of threads, 0 for the serial cell loop, or PETSC_DECIDE for the maximum number of OpenMP threads
+
+  Options Database Key:
+. -dm_plex_assembly_threads <nthreads> - the number of threads
+
+  Notes: The cells are colored so that no two cells of one color share a mesh point with unknowns. The element integrals
+  are computed by the threads at once, and the element vectors and matrices of one color are added by all threads at once.
+  The pointwise functions of the PetscDS are therefore called concurrently and must not write to shared data.
+
+  The element matrices are added directly into the nonzeros of an assembled MATSEQAIJ matrix, such as the one from
+  DMCreateMatrix(); other matrix types, finite volume fields, ghost cells, hanging node constraints and closure
+  permutations use the serial cell loop. Without OpenMP the colored loop runs on one thread.
+
+  Level: advanced
+
+.seealso: DMPlexGetAssemblyThreads(), DMPlexSNESComputeResidualFEM(), DMPlexSNESComputeJacobianFEM()
+@*/
+PetscErrorCode DMPlexSetAssemblyThreads(DM dm, PetscInt nthreads)
+{
+  DM_Plex *plex = (DM_Plex *) dm->data;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidLogicalCollectiveInt(dm, nthreads, 2);
+  if (nthreads < 0 && nthreads != PETSC_DECIDE) SETERRQ1(PetscObjectComm((PetscObject) dm), PETSC_ERR_ARG_OUTOFRANGE, "Number of threads %D must be non-negative or PETSC_DECIDE", nthreads);
+  plex->assemblyThreads = nthreads;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetAssemblyThreads"
+/*@
+  DMPlexGetAssemblyThreads - Get the number of threads of the colored cell loop in the FEM residual and Jacobian assembly
+
+  Not collective
+
+  Input Parameter:
+. dm - the DMPlex object
+
+  Output Parameter:
+. nthreads - the number of threads, 0 for the serial cell loop, or PETSC_DECIDE for the maximum number of OpenMP threads
+
+  Level: advanced
+
+.seealso: DMPlexSetAssemblyThreads()
+@*/
+PetscErrorCode DMPlexGetAssemblyThreads(DM dm, PetscInt *nthreads)
+{
+  DM_Plex *plex = (DM_Plex *) dm->data;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidIntPointer(nthreads, 2);
+  *nthreads = plex->assemblyThreads;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMProjectFunctionLabelLocal_Plex"
 PetscErrorCode DMProjectFunctionLabelLocal_Plex(DM dm, PetscReal time, DMLabel label, PetscInt numIds, const PetscInt ids[], PetscErrorCode (**funcs)(PetscInt, PetscReal, const PetscReal [], PetscInt, PetscScalar *, void *), void **ctxs, InsertMode mode, Vec localX)
@@ -1,6 +1,8 @@
 #define PETSCDM_DLL
 #include <petsc/private/dmpleximpl.h>    /*I   "petscdmplex.h"   I*/
 
+static PetscErrorCode DMPlexCreateGmsh_Parallel_Private(MPI_Comm, PetscViewer, PetscBool, PetscBool, PetscInt, PetscBool, DM *);
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexCreateGmshFromFile"
 /*@C
@@ -78,13 +80,20 @@ PetscErrorCode DMPlexCreateGmshFromFile(MPI_Comm comm, const char filename[], Pe
   Output Parameter:
 . dm  - The DM object representing the mesh
 
-  Note: http://www.geuz.org/gmsh/doc/texinfo/#MSH-ASCII-file-format
+  Options Database:
+. -dm_plex_load_parallel - Each process reads a contiguous chunk of the cells and vertices, rather than process 0 reading the whole mesh
+
+  Notes: http://www.geuz.org/gmsh/doc/texinfo/#MSH-ASCII-file-format
   and http://www.geuz.org/gmsh/doc/texinfo/#MSH-binary-file-format
 
+  With -dm_plex_load_parallel, process 0 streams an ASCII file to the other processes chunk by chunk, and every process
+  reads its own chunk of a binary file. The resulting partition is naive, and DMPlexDistribute() should be used to
+  rebalance it. Every cell must have the same number of vertices.
+
   Level: beginner
 
 .keywords: mesh,Gmsh
-.seealso: DMPLEX, DMCreate()
+.seealso: DMPLEX, DMCreate(), DMPlexDistribute()
 @*/
 PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool interpolate, DM *dm)
 {
@@ -97,7 +106,7 @@ PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool int
   int            i, numVertices = 0, numCells = 0, trueNumCells = 0, numRegions = 0, snum;
   PetscMPIInt    num_proc, rank;
   char           line[PETSC_MAX_PATH_LEN];
-  PetscBool      match, binary, bswap = PETSC_FALSE;
+  PetscBool      match, binary, bswap = PETSC_FALSE, parallel = PETSC_FALSE;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -108,6 +117,8 @@ PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool int
   ierr = PetscLogEventBegin(DMPLEX_CreateGmsh,*dm,0,0,0);CHKERRQ(ierr);
   ierr = PetscViewerGetType(viewer, &vtype);CHKERRQ(ierr);
   ierr = PetscStrcmp(vtype, PETSCVIEWERBINARY, &binary);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(((PetscObject) *dm)->options, ((PetscObject) *dm)->prefix, "-dm_plex_load_parallel", &parallel, NULL);CHKERRQ(ierr);
+  if (num_proc == 1) parallel = PETSC_FALSE;
   if (!rank || binary) {
     PetscBool match;
     int       fileType, dataSize;
@@ -160,6 +171,14 @@ PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool int
     ierr = PetscViewerRead(viewer, line, 1, NULL, PETSC_STRING);CHKERRQ(ierr);
     snum = sscanf(line, "%d", &numVertices);
     if (snum != 1) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "File is not a valid Gmsh file");
+  }
+  if (parallel) {
+    if (!binary) {ierr = MPI_Bcast(&numVertices, 1, MPI_INT, 0, comm);CHKERRQ(ierr);}
+    ierr = DMPlexCreateGmsh_Parallel_Private(comm, viewer, binary, bswap, numVertices, interpolate, dm);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(DMPLEX_CreateGmsh,*dm,0,0,0);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (!rank || binary) {
     ierr = PetscMalloc1(numVertices*3, &coordsIn);CHKERRQ(ierr);
     if (binary) {
       size_t doubleSize, intSize;
@@ -171,7 +190,7 @@ PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool int
       elementSize = (intSize + 3*doubleSize);
       ierr = PetscMalloc1(elementSize*numVertices, &buffer);CHKERRQ(ierr);
       ierr = PetscViewerRead(viewer, buffer, elementSize*numVertices, NULL, PETSC_CHAR);CHKERRQ(ierr);
-      if (bswap) ierr = PetscByteSwap(buffer, PETSC_CHAR, elementSize*numVertices);CHKERRQ(ierr);
+      if (bswap) {ierr = PetscByteSwap(buffer, PETSC_CHAR, elementSize*numVertices);CHKERRQ(ierr);}
       for (v = 0; v < numVertices; ++v) {
         baseptr = ((PetscScalar*)(buffer+v*elementSize+intSize));
         coordsIn[v*3+0] = baseptr[0];
@@ -323,74 +342,92 @@ PetscErrorCode DMPlexCreateGmsh(MPI_Comm comm, PetscViewer viewer, PetscBool int
   ierr = DMSetCoordinatesLocal(*dm, coordinates);CHKERRQ(ierr);
   ierr = VecDestroy(&coordinates);CHKERRQ(ierr);
   /* Clean up intermediate storage */
-  if (!rank || binary) ierr = PetscFree(gmsh_elem);CHKERRQ(ierr);
+  if (!rank || binary) {ierr = PetscFree(gmsh_elem);CHKERRQ(ierr);}
   ierr = PetscLogEventEnd(DMPLEX_CreateGmsh,*dm,0,0,0);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
 #undef __FUNCT__
-#define __FUNCT__ "DMPlexCreateGmsh_ReadElement"
-PetscErrorCode DMPlexCreateGmsh_ReadElement(PetscViewer viewer, PetscInt numCells, PetscBool binary, PetscBool byteSwap, GmshElement **gmsh_elems)
+#define __FUNCT__ "DMPlexCreateGmsh_ElementType_Private"
+static PetscErrorCode DMPlexCreateGmsh_ElementType_Private(int cellType, int *dim, int *numNodes)
+{
+  PetscFunctionBegin;
+  switch (cellType) {
+  case 1: /* 2-node line */
+    *dim = 1;
+    *numNodes = 2;
+    break;
+  case 2: /* 3-node triangle */
+    *dim = 2;
+    *numNodes = 3;
+    break;
+  case 3: /* 4-node quadrangle */
+    *dim = 2;
+    *numNodes = 4;
+    break;
+  case 4: /* 4-node tetrahedron */
+    *dim  = 3;
+    *numNodes = 4;
+    break;
+  case 5: /* 8-node hexahedron */
+    *dim = 3;
+    *numNodes = 8;
+    break;
+  case 15: /* 1-node vertex */
+    *dim = 0;
+    *numNodes = 1;
+    break;
+  default:
+    SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Unsupported Gmsh element type %d", cellType);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexCreateGmsh_ReadElementChunk_Private"
+/*
+  Reads the next numCells elements. Binary files store the elements in blocks of one type, so block[] carries the type,
+  the number of elements left and the number of tags of the current block from one call to the next. If fd is not -1,
+  this process reads the binary file from its own descriptor fd instead of through the viewer.
+*/
+static PetscErrorCode DMPlexCreateGmsh_ReadElementChunk_Private(PetscViewer viewer, int fd, PetscInt numCells, PetscBool binary, PetscBool byteSwap, int block[], GmshElement elements[])
 {
   PetscInt       c, p;
-  GmshElement   *elements;
-  int            i, cellType, dim, numNodes, numElem, numTags;
+  int            i, cellType, dim, numNodes, numTags;
   int            ibuf[16];
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
-  ierr = PetscMalloc1(numCells, &elements);CHKERRQ(ierr);
   for (c = 0; c < numCells;) {
-    ierr = PetscViewerRead(viewer, &ibuf, 3, NULL, PETSC_ENUM);CHKERRQ(ierr);
-    if (byteSwap) ierr = PetscByteSwap(&ibuf, PETSC_ENUM, 3);CHKERRQ(ierr);
-    if (binary) {
-      cellType = ibuf[0];
-      numElem = ibuf[1];
-      numTags = ibuf[2];
-    } else {
-      elements[c].id = ibuf[0];
-      cellType = ibuf[1];
-      numTags = ibuf[2];
-      numElem = 1;
-    }
-    switch (cellType) {
-    case 1: /* 2-node line */
-      dim = 1;
-      numNodes = 2;
-      break;
-    case 2: /* 3-node triangle */
-      dim = 2;
-      numNodes = 3;
-      break;
-    case 3: /* 4-node quadrangle */
-      dim = 2;
-      numNodes = 4;
-      break;
-    case 4: /* 4-node tetrahedron */
-      dim  = 3;
-      numNodes = 4;
-      break;
-    case 5: /* 8-node hexahedron */
-      dim = 3;
-      numNodes = 8;
-      break;
-    case 15: /* 1-node vertex */
-      dim = 0;
-      numNodes = 1;
-      break;
-    default:
-      SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Unsupported Gmsh element type %d", cellType);
+    if (!binary || !block[1]) {
+      if (fd != -1) {ierr = PetscBinaryRead(fd, &ibuf, 3, PETSC_ENUM);CHKERRQ(ierr);}
+      else          {ierr = PetscViewerRead(viewer, &ibuf, 3, NULL, PETSC_ENUM);CHKERRQ(ierr);}
+      if (byteSwap) {ierr = PetscByteSwap(&ibuf, PETSC_ENUM, 3);CHKERRQ(ierr);}
+      if (binary) {
+        block[0] = ibuf[0];
+        block[1] = ibuf[1];
+        block[2] = ibuf[2];
+      } else {
+        elements[c].id = ibuf[0];
+        block[0] = ibuf[1];
+        block[1] = 1;
+        block[2] = ibuf[2];
+      }
     }
+    cellType = block[0];
+    numTags  = block[2];
+    ierr = DMPlexCreateGmsh_ElementType_Private(cellType, &dim, &numNodes);CHKERRQ(ierr);
     if (binary) {
       const PetscInt nint = numNodes + numTags + 1;
-      for (i = 0; i < numElem; ++i, ++c) {
+      for (i = 0; block[1] && c < numCells; ++i, ++c, --block[1]) {
         /* Loop over inner binary element block */
         elements[c].dim = dim;
         elements[c].numNodes = numNodes;
         elements[c].numTags = numTags;
 
-        ierr = PetscViewerRead(viewer, &ibuf, nint, NULL, PETSC_ENUM);CHKERRQ(ierr);
-        if (byteSwap) ierr = PetscByteSwap( &ibuf, PETSC_ENUM, nint);CHKERRQ(ierr);
+        if (fd != -1) {ierr = PetscBinaryRead(fd, &ibuf, nint, PETSC_ENUM);CHKERRQ(ierr);}
+        else          {ierr = PetscViewerRead(viewer, &ibuf, nint, NULL, PETSC_ENUM);CHKERRQ(ierr);}
+        if (byteSwap) {ierr = PetscByteSwap(&ibuf, PETSC_ENUM, nint);CHKERRQ(ierr);}
         elements[c].id = ibuf[0];
         for (p = 0; p < numTags; p++) elements[c].tags[p] = ibuf[1 + p];
         for (p = 0; p < numNodes; p++) elements[c].nodes[p] = ibuf[1 + numTags + p];
@@ -402,8 +439,278 @@ PetscErrorCode DMPlexCreateGmsh_ReadElement(PetscViewer viewer, PetscInt numCell
       ierr = PetscViewerRead(viewer, elements[c].tags, elements[c].numTags, NULL, PETSC_ENUM);CHKERRQ(ierr);
       ierr = PetscViewerRead(viewer, elements[c].nodes, elements[c].numNodes, NULL, PETSC_ENUM);CHKERRQ(ierr);
       c++;
+      block[1] = 0;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexCreateGmsh_ReadElement"
+PetscErrorCode DMPlexCreateGmsh_ReadElement(PetscViewer viewer, PetscInt numCells, PetscBool binary, PetscBool byteSwap, GmshElement **gmsh_elems)
+{
+  int            block[3] = {0, 0, 0};
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(numCells, gmsh_elems);CHKERRQ(ierr);
+  ierr = DMPlexCreateGmsh_ReadElementChunk_Private(viewer, -1, numCells, binary, byteSwap, block, *gmsh_elems);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexCreateGmsh_Parallel_Private"
+/*
+  Reads the nodes and elements in contiguous chunks, one for each process, and builds the distributed mesh from them with
+  DMPlexCreateFromCellListParallel(). The first process reads an ASCII file in sequence and sends each chunk to its
+  owner. In a binary file each process seeks to its own chunk: the nodes have a fixed size, and the first process scans
+  the headers of the element blocks to find where each chunk of elements starts.
+*/
+static PetscErrorCode DMPlexCreateGmsh_Parallel_Private(MPI_Comm comm, PetscViewer viewer, PetscBool binary, PetscBool bswap, PetscInt numVertices, PetscBool interpolate, DM *dm)
+{
+  PetscLayout     vLayout, eLayout;
+  PetscSF         sfVert;
+  const PetscInt *vrange, *erange;
+  GmshElement    *elements, *ebuf = NULL;
+  double         *coordsIn, *vertexCoords;
+  int            *cells, block[3] = {0, 0, 0}, i, snum, numElem = 0;
+  char            line[PETSC_MAX_PATH_LEN];
+  PetscInt        numElements, numLocalVertices, numLocalElements, numCells = 0, numCorners, maxChunk = 0, lcorners[2], corners[2], dim = 0, ldim = 0, c, e, v, d, k;
+  PetscBool       match, hasFacets = PETSC_FALSE, hasTags = PETSC_FALSE, flags[2];
+  PetscMPIInt     rank, numProcs, tag, count;
+  PetscInt64      start = 0;
+  off_t           off;
+  size_t          intSize;
+  int             fd = -1;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = PetscObjectGetNewTag((PetscObject) viewer, &tag);CHKERRQ(ierr);
+  ierr = PetscDataTypeGetSize(PETSC_ENUM, &intSize);CHKERRQ(ierr);
+  if (binary) {
+    PetscBool mpiio;
+
+    ierr = PetscViewerBinaryGetUseMPIIO(viewer, &mpiio);CHKERRQ(ierr);
+    if (mpiio) SETERRQ(comm, PETSC_ERR_SUP, "Parallel Gmsh loading cannot use a binary viewer with MPI-IO");
+    ierr = PetscViewerBinaryGetDescriptor(viewer, &fd);CHKERRQ(ierr);
+  }
+  /* Read vertices */
+  ierr = PetscLayoutCreate(comm, &vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(vLayout, numVertices);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(vLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(vLayout, &vrange);CHKERRQ(ierr);
+  for (k = 0; k < numProcs; ++k) maxChunk = PetscMax(maxChunk, vrange[k+1]-vrange[k]);
+  numLocalVertices = vrange[rank+1] - vrange[rank];
+  ierr = PetscMalloc1(numLocalVertices*3, &coordsIn);CHKERRQ(ierr);
+  if (binary) {
+    size_t doubleSize;
+    PetscInt elementSize;
+    char *buffer;
+
+    ierr = PetscDataTypeGetSize(PETSC_DOUBLE, &doubleSize);CHKERRQ(ierr);
+    elementSize = (intSize + 3*doubleSize);
+    /* The nodes have a fixed size, so each process seeks to its chunk from where the first process is in the file */
+    if (!rank) {ierr = PetscBinarySeek(fd, 0, PETSC_BINARY_SEEK_CUR, &off);CHKERRQ(ierr); start = (PetscInt64) off;}
+    ierr = MPI_Bcast(&start, 1, MPIU_INT64, 0, comm);CHKERRQ(ierr);
+    ierr = PetscMalloc1(elementSize*numLocalVertices, &buffer);CHKERRQ(ierr);
+    ierr = PetscBinarySeek(fd, (off_t) (start + vrange[rank]*elementSize), PETSC_BINARY_SEEK_SET, &off);CHKERRQ(ierr);
+    ierr = PetscBinaryRead(fd, buffer, elementSize*numLocalVertices, PETSC_CHAR);CHKERRQ(ierr);
+    for (v = 0; v < numLocalVertices; ++v) {ierr = PetscMemcpy(&coordsIn[v*3], buffer+v*elementSize+intSize, 3*doubleSize);CHKERRQ(ierr);}
+    if (bswap) {ierr = PetscByteSwap(coordsIn, PETSC_DOUBLE, numLocalVertices*3);CHKERRQ(ierr);}
+    ierr = PetscFree(buffer);CHKERRQ(ierr);
+    /* The first process goes on with the rest of the file */
+    if (!rank) {ierr = PetscBinarySeek(fd, (off_t) (start + numVertices*elementSize), PETSC_BINARY_SEEK_SET, &off);CHKERRQ(ierr);}
+  } else if (!rank) {
+    double *buffer;
+
+    ierr = PetscMalloc1(maxChunk*3, &buffer);CHKERRQ(ierr);
+    for (k = 0; k < numProcs; ++k) {
+      const PetscInt n = vrange[k+1] - vrange[k];
+      double        *chunk = k ? buffer : coordsIn;
+
+      for (v = 0; v < n; ++v) {
+        ierr = PetscViewerRead(viewer, &i, 1, NULL, PETSC_ENUM);CHKERRQ(ierr);
+        ierr = PetscViewerRead(viewer, &chunk[v*3], 3, NULL, PETSC_DOUBLE);CHKERRQ(ierr);
+        if (i != (int)(vrange[k]+v)+1) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Invalid node number %d should be %d", i, vrange[k]+v+1);
+      }
+      if (k) {
+        ierr = PetscMPIIntCast(n*3, &count);CHKERRQ(ierr);
+        ierr = MPI_Send(buffer, count, MPI_DOUBLE, k, tag, comm);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscFree(buffer);CHKERRQ(ierr);
+  } else {
+    ierr = PetscMPIIntCast(numLocalVertices*3, &count);CHKERRQ(ierr);
+    ierr = MPI_Recv(coordsIn, count, MPI_DOUBLE, 0, tag, comm, MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  }
+  if (!rank || binary) {
+    ierr = PetscViewerRead(viewer, line, 1, NULL, PETSC_STRING);CHKERRQ(ierr);
+    ierr = PetscStrncmp(line, "$EndNodes", PETSC_MAX_PATH_LEN, &match);CHKERRQ(ierr);
+    if (!match) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "File is not a valid Gmsh file");
+    ierr = PetscViewerRead(viewer, line, 1, NULL, PETSC_STRING);CHKERRQ(ierr);
+    ierr = PetscStrncmp(line, "$Elements", PETSC_MAX_PATH_LEN, &match);CHKERRQ(ierr);
+    if (!match) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "File is not a valid Gmsh file");
+    ierr = PetscViewerRead(viewer, line, 1, NULL, PETSC_STRING);CHKERRQ(ierr);
+    snum = sscanf(line, "%d", &numElem);
+    if (snum != 1) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "File is not a valid Gmsh file");
+  }
+  ierr = MPI_Bcast(&numElem, 1, MPI_INT, 0, comm);CHKERRQ(ierr);
+  numElements = numElem;
+  /* Read elements, of all dimensions */
+  ierr = PetscLayoutCreate(comm, &eLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(eLayout, numElements);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(eLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(eLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(eLayout, &erange);CHKERRQ(ierr);
+  numLocalElements = erange[rank+1] - erange[rank];
+  ierr = PetscMalloc1(numLocalElements, &elements);CHKERRQ(ierr);
+  if (binary) {
+    PetscInt64 *offsets = NULL, local[4], end = 0;
+
+    /* The first process scans the block headers once, and sends each process the location of its first element with
+       the type, the number of elements left and the number of tags of the block it is in */
+    if (!rank) {
+      PetscInt64 pos, first = 0;
+      int        hdr[3], edim, numNodes;
+
+      ierr = PetscMalloc1(numProcs*4, &offsets);CHKERRQ(ierr);
+      ierr = PetscBinarySeek(fd, 0, PETSC_BINARY_SEEK_CUR, &off);CHKERRQ(ierr);
+      pos  = (PetscInt64) off;
+      for (k = 0; first < numElements;) {
+        PetscInt64 nint;
+
+        ierr = PetscBinaryRead(fd, hdr, 3, PETSC_ENUM);CHKERRQ(ierr);
+        if (bswap) {ierr = PetscByteSwap(hdr, PETSC_ENUM, 3);CHKERRQ(ierr);}
+        if (hdr[1] <= 0) SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Invalid number of elements %d in a Gmsh element block", hdr[1]);
+        ierr = DMPlexCreateGmsh_ElementType_Private(hdr[0], &edim, &numNodes);CHKERRQ(ierr);
+        nint = 1 + hdr[2] + numNodes;
+        for (; k < numProcs && erange[k] < first + hdr[1]; ++k) {
+          if (erange[k] == first) {
+            offsets[k*4+0] = pos;
+            offsets[k*4+1] = offsets[k*4+2] = offsets[k*4+3] = 0;
+          } else {
+            offsets[k*4+0] = pos + (3 + (erange[k] - first)*nint)*intSize;
+            offsets[k*4+1] = hdr[0];
+            offsets[k*4+2] = first + hdr[1] - erange[k];
+            offsets[k*4+3] = hdr[2];
+          }
+        }
+        first += hdr[1];
+        pos   += (3 + hdr[1]*nint)*intSize;
+        ierr = PetscBinarySeek(fd, (off_t) pos, PETSC_BINARY_SEEK_SET, &off);CHKERRQ(ierr);
+      }
+      /* Processes without elements */
+      for (; k < numProcs; ++k) {
+        offsets[k*4+0] = pos;
+        offsets[k*4+1] = offsets[k*4+2] = offsets[k*4+3] = 0;
+      }
+      end = pos;
+    }
+    ierr = MPI_Scatter(offsets, 4, MPIU_INT64, local, 4, MPIU_INT64, 0, comm);CHKERRQ(ierr);
+    ierr = PetscFree(offsets);CHKERRQ(ierr);
+    ierr = PetscBinarySeek(fd, (off_t) local[0], PETSC_BINARY_SEEK_SET, &off);CHKERRQ(ierr);
+    block[0] = (int) local[1]; block[1] = (int) local[2]; block[2] = (int) local[3];
+    ierr = DMPlexCreateGmsh_ReadElementChunk_Private(viewer, fd, numLocalElements, binary, bswap, block, elements);CHKERRQ(ierr);
+    if (!rank) {ierr = PetscBinarySeek(fd, (off_t) end, PETSC_BINARY_SEEK_SET, &off);CHKERRQ(ierr);}
+  } else if (!rank) {
+    for (k = 0, maxChunk = 0; k < numProcs; ++k) maxChunk = PetscMax(maxChunk, erange[k+1]-erange[k]);
+    ierr = PetscMalloc1(maxChunk, &ebuf);CHKERRQ(ierr);
+    for (k = 0; k < numProcs; ++k) {
+      const PetscInt n = erange[k+1] - erange[k];
+
+      ierr = DMPlexCreateGmsh_ReadElementChunk_Private(viewer, -1, n, binary, bswap, block, k ? ebuf : elements);CHKERRQ(ierr);
+      if (k) {
+        ierr = PetscMPIIntCast(n*sizeof(GmshElement), &count);CHKERRQ(ierr);
+        ierr = MPI_Send(ebuf, count, MPI_BYTE, k, tag, comm);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscFree(ebuf);CHKERRQ(ierr);
+  } else {
+    ierr = PetscMPIIntCast(numLocalElements*sizeof(GmshElement), &count);CHKERRQ(ierr);
+    ierr = MPI_Recv(elements, count, MPI_BYTE, 0, tag, comm, MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  }
+  if (!rank || binary) {
+    ierr = PetscViewerRead(viewer, line, 1, NULL, PETSC_STRING);CHKERRQ(ierr);
+    ierr = PetscStrncmp(line, "$EndElements", PETSC_MAX_PATH_LEN, &match);CHKERRQ(ierr);
+    if (!match) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "File is not a valid Gmsh file");
+  }
+  /* The cells are the elements of highest dimension, which must all have the same number of vertices */
+  for (e = 0; e < numLocalElements; ++e) ldim = PetscMax(ldim, elements[e].dim);
+  ierr = MPIU_Allreduce(&ldim, &dim, 1, MPIU_INT, MPI_MAX, comm);CHKERRQ(ierr);
+  lcorners[0] = 0; lcorners[1] = -PETSC_MAX_INT;
+  for (e = 0; e < numLocalElements; ++e) {
+    if (elements[e].dim == dim) {
+      lcorners[0] = PetscMax(lcorners[0], elements[e].numNodes);
+      lcorners[1] = PetscMax(lcorners[1], -elements[e].numNodes);
+      if (elements[e].numTags > 0) hasTags = PETSC_TRUE;
+      ++numCells;
+    } else if (elements[e].dim == dim-1) hasFacets = PETSC_TRUE;
+  }
+  ierr = MPIU_Allreduce(lcorners, corners, 2, MPIU_INT, MPI_MAX, comm);CHKERRQ(ierr);
+  numCorners = corners[0];
+  if (corners[0] != -corners[1]) SETERRQ2(comm, PETSC_ERR_SUP, "Parallel Gmsh loading needs cells with the same number of vertices, not %D and %D", -corners[1], corners[0]);
+  ierr = PetscMalloc1(numCells*numCorners, &cells);CHKERRQ(ierr);
+  for (e = 0, c = 0; e < numLocalElements; ++e) {
+    int *cone = &cells[c*numCorners];
+
+    if (elements[e].dim != dim) continue;
+    for (v = 0; v < numCorners; ++v) cone[v] = elements[e].nodes[v] - 1;
+    if (dim == 3) {
+      /* Tetrahedra are inverted */
+      if (numCorners == 4) {
+        int tmp = cone[0];
+        cone[0] = cone[1];
+        cone[1] = tmp;
+      }
+      /* Hexahedra are inverted */
+      if (numCorners == 8) {
+        int tmp = cone[1];
+        cone[1] = cone[3];
+        cone[3] = tmp;
+      }
+    }
+    ++c;
+  }
+  ierr = PetscMalloc1(numLocalVertices*dim, &vertexCoords);CHKERRQ(ierr);
+  for (v = 0; v < numLocalVertices; ++v) for (d = 0; d < dim; ++d) vertexCoords[v*dim+d] = coordsIn[v*3+d];
+  ierr = PetscFree(coordsIn);CHKERRQ(ierr);
+  ierr = DMDestroy(dm);CHKERRQ(ierr);
+  ierr = DMPlexCreateFromCellListParallel_Internal(comm, dim, numCells, numLocalVertices, numCorners, interpolate, cells, dim, vertexCoords, &sfVert, dm);CHKERRQ(ierr);
+  ierr = PetscFree(cells);CHKERRQ(ierr);
+  ierr = PetscFree(vertexCoords);CHKERRQ(ierr);
+  /* Every process must create the same labels, in the same order */
+  flags[0] = hasFacets; flags[1] = hasTags;
+  ierr = MPIU_Allreduce(MPI_IN_PLACE, flags, 2, MPIU_BOOL, MPI_LOR, comm);CHKERRQ(ierr);
+  if (flags[0]) {
+    PetscInt *sets, numSets = 0, n;
+
+    for (e = 0; e < numLocalElements; ++e) if (elements[e].dim == dim-1) ++numSets;
+    ierr = PetscMalloc1(numSets*6, &sets);CHKERRQ(ierr);
+    for (e = 0, k = 0; e < numLocalElements; ++e) {
+      if (elements[e].dim != dim-1) continue;
+      if (elements[e].numNodes > 4) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Gmsh facet element %d has %d nodes, more than 4", elements[e].id, elements[e].numNodes);
+      sets[k*6+0] = elements[e].numTags > 0 ? elements[e].tags[0] : 0;
+      sets[k*6+1] = elements[e].numNodes;
+      for (n = 0; n < elements[e].numNodes; ++n) sets[k*6+2+n] = elements[e].nodes[n] - 1;
+      ++k;
+    }
+    ierr = DMPlexSetLabelFromVertexSets_Internal(*dm, sfVert, "Face Sets", numSets, sets);CHKERRQ(ierr);
+    ierr = PetscFree(sets);CHKERRQ(ierr);
+  }
+  if (flags[1]) {
+    ierr = DMCreateLabel(*dm, "Cell Sets");CHKERRQ(ierr);
+    for (e = 0, c = 0; e < numLocalElements; ++e) {
+      if (elements[e].dim != dim) continue;
+      if (elements[e].numTags > 0) {ierr = DMSetLabelValue(*dm, "Cell Sets", c, elements[e].tags[0]);CHKERRQ(ierr);}
+      ++c;
     }
   }
-  *gmsh_elems = elements;
+  ierr = PetscSFDestroy(&sfVert);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&vLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&eLayout);CHKERRQ(ierr);
+  ierr = PetscFree(elements);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
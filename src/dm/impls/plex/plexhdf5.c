@@ -596,6 +596,15 @@ typedef struct {
   DM          dm;
   PetscViewer viewer;
   DMLabel     label;
+  /* Parallel load: strata are read in chunks, and their points are sent where they live */
+  PetscBool    parallel;
+  PetscInt     numPairs, maxPairs, *pairs; /* (point, value) pairs read for the current label */
+  PetscSF      sfProcess;                  /* Connects each process to every other one */
+  PetscSF      sfVert;                     /* Vertex SF from DMPlexCreateFromCellListParallel_Internal() */
+  PetscLayout  cLayout, oLayout;           /* Layouts of the cells and of the remaining points in the file numbering */
+  PetscInt     Nc, Nv;                     /* Numbers of cells and vertices in the file */
+  PetscSection dirSection;                 /* Cones of the points in oLayout owned by this process */
+  PetscInt    *dirCones;
 } LabelCtx;
 
 static herr_t ReadLabelStratumHDF5_Static(hid_t g_id, const char *name, const H5L_info_t *info, void *op_data)
@@ -616,21 +625,221 @@ static herr_t ReadLabelStratumHDF5_Static(hid_t g_id, const char *name, const H5
   ierr = PetscSNPrintf(group, PETSC_MAX_PATH_LEN, "/labels/%s/%s", lname, name);CHKERRQ(ierr);
   ierr = PetscViewerHDF5PushGroup(viewer, group);CHKERRQ(ierr);
   {
-    /* Force serial load */
+    /* Force serial load, unless each process reads a chunk */
     ierr = PetscViewerHDF5ReadSizes(viewer, "indices", NULL, &N);CHKERRQ(ierr);
-    ierr = PetscLayoutSetLocalSize(stratumIS->map, !((LabelCtx *) op_data)->rank ? N : 0);CHKERRQ(ierr);
+    if (!((LabelCtx *) op_data)->parallel) {ierr = PetscLayoutSetLocalSize(stratumIS->map, !((LabelCtx *) op_data)->rank ? N : 0);CHKERRQ(ierr);}
     ierr = PetscLayoutSetSize(stratumIS->map, N);CHKERRQ(ierr);
   }
   ierr = ISLoad(stratumIS, viewer);
   ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
   ierr = ISGetLocalSize(stratumIS, &N);
   ierr = ISGetIndices(stratumIS, &ind);
-  for (i = 0; i < N; ++i) {ierr = DMLabelSetValue(label, ind[i], value);}
+  if (((LabelCtx *) op_data)->parallel) {
+    LabelCtx *ctx = (LabelCtx *) op_data;
+
+    if (ctx->numPairs + N > ctx->maxPairs) {
+      PetscInt *pairs;
+
+      ctx->maxPairs = PetscMax(2*ctx->maxPairs, ctx->numPairs + N);
+      ierr = PetscMalloc1(ctx->maxPairs*2, &pairs);CHKERRQ(ierr);
+      ierr = PetscMemcpy(pairs, ctx->pairs, ctx->numPairs*2 * sizeof(PetscInt));CHKERRQ(ierr);
+      ierr = PetscFree(ctx->pairs);CHKERRQ(ierr);
+      ctx->pairs = pairs;
+    }
+    for (i = 0; i < N; ++i, ++ctx->numPairs) {ctx->pairs[ctx->numPairs*2+0] = ind[i]; ctx->pairs[ctx->numPairs*2+1] = value;}
+  } else {
+    for (i = 0; i < N; ++i) {ierr = DMLabelSetValue(label, ind[i], value);}
+  }
   ierr = ISRestoreIndices(stratumIS, &ind);
   ierr = ISDestroy(&stratumIS);
   return 0;
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetConesParallel_HDF5_Static"
+/* Gets the cones of points in oLayout from the processes owning them. The cones come back in the order of the points. */
+static PetscErrorCode DMPlexGetConesParallel_HDF5_Static(LabelCtx *ctx, PetscInt numPoints, const PetscInt points[], PetscInt **cones)
+{
+  MPI_Comm        comm;
+  PetscSection    sendSection, recvSection, replySection, coneSection;
+  const PetscInt *orange;
+  PetscInt       *dest, *count, *sendPoints, *recvPoints, *reply, *perm, *coneStream;
+  PetscInt        numRecv, replySize, streamSize, n, r, off, dof, d;
+  PetscMPIInt     rank, numProcs, p;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject) ctx->dm, &comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(ctx->oLayout, &orange);CHKERRQ(ierr);
+  ierr = PetscMalloc4(numPoints, &dest, numProcs, &count, numPoints, &sendPoints, numPoints, &perm);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(sendSection, 0, numProcs);CHKERRQ(ierr);
+  for (n = 0; n < numPoints; ++n) {
+    ierr = PetscLayoutFindOwner(ctx->oLayout, points[n] - ctx->Nc, &dest[n]);CHKERRQ(ierr);
+    ierr = PetscSectionAddDof(sendSection, dest[n], 1);CHKERRQ(ierr);
+  }
+  ierr = PetscSectionSetUp(sendSection);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numProcs * sizeof(PetscInt));CHKERRQ(ierr);
+  for (n = 0; n < numPoints; ++n) {
+    ierr = PetscSectionGetOffset(sendSection, dest[n], &off);CHKERRQ(ierr);
+    sendPoints[off+count[dest[n]]] = points[n];
+    perm[off+count[dest[n]]++]     = n;
+  }
+  ierr = PetscSectionCreate(comm, &recvSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(ctx->dm, ctx->sfProcess, sendSection, MPIU_INT, sendPoints, recvSection, (void **) &recvPoints);CHKERRQ(ierr);
+  /* Reply with the cone size and cone of each point asked for */
+  ierr = PetscSectionGetStorageSize(recvSection, &numRecv);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &replySection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(replySection, 0, numProcs);CHKERRQ(ierr);
+  for (p = 0; p < numProcs; ++p) {
+    ierr = PetscSectionGetDof(recvSection, p, &dof);CHKERRQ(ierr);
+    ierr = PetscSectionGetOffset(recvSection, p, &off);CHKERRQ(ierr);
+    for (d = off; d < off+dof; ++d) {
+      PetscInt coneSize;
+
+      ierr = PetscSectionGetDof(ctx->dirSection, recvPoints[d] - ctx->Nc - orange[rank], &coneSize);CHKERRQ(ierr);
+      ierr = PetscSectionAddDof(replySection, p, 1+coneSize);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscSectionSetUp(replySection);CHKERRQ(ierr);
+  ierr = PetscSectionGetStorageSize(replySection, &replySize);CHKERRQ(ierr);
+  ierr = PetscMalloc1(replySize, &reply);CHKERRQ(ierr);
+  for (d = 0, r = 0; d < numRecv; ++d) {
+    PetscInt coneSize, coneOff;
+
+    ierr = PetscSectionGetDof(ctx->dirSection, recvPoints[d] - ctx->Nc - orange[rank], &coneSize);CHKERRQ(ierr);
+    ierr = PetscSectionGetOffset(ctx->dirSection, recvPoints[d] - ctx->Nc - orange[rank], &coneOff);CHKERRQ(ierr);
+    reply[r++] = coneSize;
+    for (n = 0; n < coneSize; ++n) reply[r++] = ctx->dirCones[coneOff+n];
+  }
+  ierr = PetscFree(recvPoints);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &coneSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(ctx->dm, ctx->sfProcess, replySection, MPIU_INT, reply, coneSection, (void **) &coneStream);CHKERRQ(ierr);
+  ierr = PetscFree(reply);CHKERRQ(ierr);
+  /* The replies come in the order the points were sent, which we undo */
+  ierr = PetscSectionGetStorageSize(coneSection, &streamSize);CHKERRQ(ierr);
+  ierr = PetscMalloc1(streamSize, cones);CHKERRQ(ierr);
+  {
+    PetscInt *start, c;
+
+    ierr = PetscMalloc1(numPoints+1, &start);CHKERRQ(ierr);
+    for (n = 0, r = 0; n < numPoints; ++n) {start[perm[n]] = coneStream[r]+1; r += coneStream[r]+1;}
+    for (n = 0, off = 0; n < numPoints; ++n) {const PetscInt sz = start[n]; start[n] = off; off += sz;}
+    for (n = 0, r = 0; n < numPoints; ++n) {
+      const PetscInt sz = coneStream[r]+1;
+
+      for (c = 0; c < sz; ++c) (*cones)[start[perm[n]]+c] = coneStream[r+c];
+      r += sz;
+    }
+    ierr = PetscFree(start);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(coneStream);CHKERRQ(ierr);
+  ierr = PetscFree4(dest, count, sendPoints, perm);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&recvSection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&replySection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&coneSection);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexSetLabelParallel_HDF5_Static"
+/*
+  Sets the label values read in chunks for a mesh loaded in parallel. Cells are labeled by the process holding them, and
+  other points are found from their vertices, which we get by descending the DAG stored in the file.
+*/
+static PetscErrorCode DMPlexSetLabelParallel_HDF5_Static(LabelCtx *ctx, const char name[])
+{
+  MPI_Comm        comm;
+  PetscSection    sendSection, recvSection;
+  const PetscInt *crange;
+  PetscInt       *dest, *count, *sendPairs, *recvPairs, *sets, *pending, *pendingSet;
+  PetscInt        numCellPairs = 0, numSets = 0, numPending = 0, numRecv, n, off, c;
+  PetscMPIInt     rank, numProcs;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject) ctx->dm, &comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(ctx->cLayout, &crange);CHKERRQ(ierr);
+  for (n = 0; n < ctx->numPairs; ++n) if (ctx->pairs[n*2] < ctx->Nc) ++numCellPairs;
+  /* Send cell values to the process holding the cell */
+  ierr = PetscMalloc4(numCellPairs, &dest, numProcs, &count, numCellPairs*2, &sendPairs, (ctx->numPairs-numCellPairs)*6, &sets);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(sendSection, 0, numProcs);CHKERRQ(ierr);
+  for (n = 0, c = 0; n < ctx->numPairs; ++n) {
+    if (ctx->pairs[n*2] >= ctx->Nc) continue;
+    ierr = PetscLayoutFindOwner(ctx->cLayout, ctx->pairs[n*2], &dest[c]);CHKERRQ(ierr);
+    ierr = PetscSectionAddDof(sendSection, dest[c++], 1);CHKERRQ(ierr);
+  }
+  ierr = PetscSectionSetUp(sendSection);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numProcs * sizeof(PetscInt));CHKERRQ(ierr);
+  for (n = 0, c = 0; n < ctx->numPairs; ++n) {
+    if (ctx->pairs[n*2] >= ctx->Nc) continue;
+    ierr = PetscSectionGetOffset(sendSection, dest[c], &off);CHKERRQ(ierr);
+    ierr = PetscMemcpy(&sendPairs[(off+count[dest[c]]++)*2], &ctx->pairs[n*2], 2 * sizeof(PetscInt));CHKERRQ(ierr);
+    ++c;
+  }
+  ierr = PetscSectionCreate(comm, &recvSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(ctx->dm, ctx->sfProcess, sendSection, MPIU_2INT, sendPairs, recvSection, (void **) &recvPairs);CHKERRQ(ierr);
+  ierr = PetscSectionGetStorageSize(recvSection, &numRecv);CHKERRQ(ierr);
+  for (n = 0; n < numRecv; ++n) {ierr = DMLabelSetValue(ctx->label, recvPairs[n*2] - crange[rank], recvPairs[n*2+1]);CHKERRQ(ierr);}
+  ierr = PetscFree(recvPairs);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&recvSection);CHKERRQ(ierr);
+  /* Collect the vertices of the other points, one level of the DAG at a time */
+  ierr = PetscMalloc2(ctx->numPairs-numCellPairs, &pending, ctx->numPairs-numCellPairs, &pendingSet);CHKERRQ(ierr);
+  for (n = 0; n < ctx->numPairs; ++n) {
+    const PetscInt q = ctx->pairs[n*2];
+
+    if (q < ctx->Nc) continue;
+    sets[numSets*6+0] = ctx->pairs[n*2+1];
+    sets[numSets*6+1] = 0;
+    pending[numPending]      = q;
+    pendingSet[numPending++] = numSets++;
+  }
+  while (1) {
+    PetscInt *cones, *newPending, *newPendingSet, numNewPending = 0, maxNewPending = 0, globalPending, r;
+
+    for (n = 0, r = 0; n < numPending; ++n) {
+      /* Vertices have no cone, so they need no request */
+      if (pending[n] < ctx->Nc+ctx->Nv) {
+        PetscInt *set = &sets[pendingSet[n]*6], v;
+
+        for (v = 0; v < set[1]; ++v) if (set[2+v] == pending[n]-ctx->Nc) break;
+        if (v < set[1]) continue;
+        if (set[1] >= 4) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_SUP, "Parallel loading only supports labels on points with at most 4 vertices");
+        set[2+set[1]++] = pending[n]-ctx->Nc;
+      } else {
+        pending[r]      = pending[n];
+        pendingSet[r++] = pendingSet[n];
+      }
+    }
+    numPending = r;
+    ierr = MPIU_Allreduce(&numPending, &globalPending, 1, MPIU_INT, MPI_SUM, comm);CHKERRQ(ierr);
+    if (!globalPending) break;
+    ierr = DMPlexGetConesParallel_HDF5_Static(ctx, numPending, pending, &cones);CHKERRQ(ierr);
+    for (n = 0, r = 0; n < numPending; ++n) {maxNewPending += cones[r]; r += cones[r]+1;}
+    ierr = PetscMalloc2(maxNewPending, &newPending, maxNewPending, &newPendingSet);CHKERRQ(ierr);
+    for (n = 0, r = 0; n < numPending; ++n) {
+      for (c = 1; c <= cones[r]; ++c) {newPending[numNewPending] = cones[r+c]; newPendingSet[numNewPending++] = pendingSet[n];}
+      r += cones[r]+1;
+    }
+    ierr = PetscFree(cones);CHKERRQ(ierr);
+    ierr = PetscFree2(pending, pendingSet);CHKERRQ(ierr);
+    pending    = newPending;
+    pendingSet = newPendingSet;
+    numPending = numNewPending;
+  }
+  ierr = PetscFree2(pending, pendingSet);CHKERRQ(ierr);
+  ierr = DMPlexSetLabelFromVertexSets_Internal(ctx->dm, ctx->sfVert, name, numSets, sets);CHKERRQ(ierr);
+  ierr = PetscFree4(dest, count, sendPairs, sets);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 static herr_t ReadLabelHDF5_Static(hid_t g_id, const char *name, const H5L_info_t *info, void *op_data)
 {
   DM             dm  = ((LabelCtx *) op_data)->dm;
@@ -640,14 +849,243 @@ static herr_t ReadLabelHDF5_Static(hid_t g_id, const char *name, const H5L_info_
 
   ierr = DMCreateLabel(dm, name); if (ierr) return (herr_t) ierr;
   ierr = DMGetLabel(dm, name, &((LabelCtx *) op_data)->label); if (ierr) return (herr_t) ierr;
+  ((LabelCtx *) op_data)->numPairs = 0;
   PetscStackCall("H5Literate_by_name",err = H5Literate_by_name(g_id, name, H5_INDEX_NAME, H5_ITER_NATIVE, &idx, ReadLabelStratumHDF5_Static, op_data, 0));
+  if (!err && ((LabelCtx *) op_data)->parallel) {ierr = DMPlexSetLabelParallel_HDF5_Static((LabelCtx *) op_data, name); if (ierr) return (herr_t) ierr;}
   return err;
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexLoadParallel_HDF5_Static"
+/*
+  Each process reads a contiguous chunk of the cells and of the vertices, and the mesh is built with
+  DMPlexCreateFromCellListParallel(). The cell vertices come from the cones of an uninterpolated mesh, and otherwise
+  from the visualization topology. The file numbers the cells first and then the vertices, in the order of the
+  coordinates. The DAG is also spread over the processes so that labels on other points can be found from their vertices.
+*/
+static PetscErrorCode DMPlexLoadParallel_HDF5_Static(DM dm, PetscViewer viewer)
+{
+  MPI_Comm        comm;
+  LabelCtx        ctx;
+  DM              pdm;
+  IS              orderIS, conesIS, cellsIS;
+  Vec             coordinates;
+  PetscSection    sendSection, recvSection;
+  PetscSFNode    *remoteProc;
+  const PetscInt *order, *cones, *cellCones, *crange, *orange;
+  PetscScalar    *coords;
+  PetscReal       lengthScale;
+  double         *vertexCoords;
+  int            *cells;
+  PetscInt       *dest, *count, *sendCones, *recvCones, *cellVertices = NULL;
+  PetscInt        dim, spatialDim, numPoints, N, Nl, numLocalCells, numLocalVertices, numCorners = 0, lcorners[2], corners[2], localNc = PETSC_MAX_INT, sendSize = 0, recvSize, p, q, c, r, off;
+  PetscBool       uninterpolated, hasViz;
+  hid_t           fileId, groupId;
+  hsize_t         idx = 0;
+  PetscMPIInt     rank, numProcs, k;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject) dm, &comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm, &numProcs);CHKERRQ(ierr);
+  ierr = PetscMemzero(&ctx, sizeof(LabelCtx));CHKERRQ(ierr);
+  ierr = DMGetDimension(dm, &dim);CHKERRQ(ierr);
+  /* Read a chunk of the DAG */
+  ierr = PetscViewerHDF5PushGroup(viewer, "/topology");CHKERRQ(ierr);
+  ierr = ISCreate(comm, &orderIS);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) orderIS, "order");CHKERRQ(ierr);
+  ierr = ISCreate(comm, &conesIS);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) conesIS, "cones");CHKERRQ(ierr);
+  ierr = ISCreate(comm, &cellsIS);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) cellsIS, "cells");CHKERRQ(ierr);
+  ierr = PetscViewerHDF5ReadSizes(viewer, "order", NULL, &numPoints);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(orderIS->map, numPoints);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(conesIS->map, numPoints);CHKERRQ(ierr);
+  ierr = ISLoad(orderIS, viewer);CHKERRQ(ierr);
+  ierr = ISLoad(conesIS, viewer);CHKERRQ(ierr);
+  ierr = ISGetLocalSize(orderIS, &Nl);CHKERRQ(ierr);
+  ierr = ISGetIndices(orderIS, &order);CHKERRQ(ierr);
+  ierr = ISGetIndices(conesIS, &cones);CHKERRQ(ierr);
+  for (p = 0, N = 0; p < Nl; ++p) N += cones[p];
+  ierr = PetscLayoutSetLocalSize(cellsIS->map, N);CHKERRQ(ierr);
+  ierr = ISLoad(cellsIS, viewer);CHKERRQ(ierr);
+  ierr = ISGetIndices(cellsIS, &cellCones);CHKERRQ(ierr);
+  ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
+  /* The vertices are the points without a cone, and are numbered right after the cells */
+  for (p = 0; p < Nl; ++p) if (!cones[p]) localNc = PetscMin(localNc, order[p]);
+  ierr = MPIU_Allreduce(&localNc, &ctx.Nc, 1, MPIU_INT, MPI_MIN, comm);CHKERRQ(ierr);
+  ierr = PetscViewerHDF5PushGroup(viewer, "/geometry");CHKERRQ(ierr);
+  ierr = PetscViewerHDF5ReadSizes(viewer, "vertices", &spatialDim, &N);CHKERRQ(ierr);
+  ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
+  ctx.Nv         = N/spatialDim;
+  uninterpolated = ctx.Nc + ctx.Nv == numPoints ? PETSC_TRUE : PETSC_FALSE;
+  ierr = PetscLayoutCreate(comm, &ctx.cLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(ctx.cLayout, ctx.Nc);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(ctx.cLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(ctx.cLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(ctx.cLayout, &crange);CHKERRQ(ierr);
+  ierr = PetscLayoutCreate(comm, &ctx.oLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(ctx.oLayout, numPoints - ctx.Nc);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(ctx.oLayout, 1);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(ctx.oLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(ctx.oLayout, &orange);CHKERRQ(ierr);
+  numLocalCells = crange[rank+1] - crange[rank];
+  /* Send the cones we read to the processes owning the points, the cells in cLayout and the others in oLayout.
+     As in DMPlexDistribute(), sfProcess connects every pair of processes, so it has numProcs^2 edges in total and
+     DMPlexDistributeData() exchanges one count per pair, like MPI_Alltoall(). Only the nonzero counts carry data, and
+     the same SF is reused for every label stratum. */
+  ierr = PetscMalloc1(numProcs, &remoteProc);CHKERRQ(ierr);
+  for (k = 0; k < numProcs; ++k) {
+    remoteProc[k].rank  = k;
+    remoteProc[k].index = rank;
+  }
+  ierr = PetscSFCreate(comm, &ctx.sfProcess);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(ctx.sfProcess, numProcs, numProcs, NULL, PETSC_OWN_POINTER, remoteProc, PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscMalloc2(Nl, &dest, numProcs, &count);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(sendSection, 0, numProcs);CHKERRQ(ierr);
+  for (p = 0; p < Nl; ++p) {
+    dest[p] = -1;
+    if (order[p] < ctx.Nc) {
+      if (!uninterpolated) continue;
+      ierr = PetscLayoutFindOwner(ctx.cLayout, order[p], &dest[p]);CHKERRQ(ierr);
+    } else if (cones[p]) {
+      ierr = PetscLayoutFindOwner(ctx.oLayout, order[p] - ctx.Nc, &dest[p]);CHKERRQ(ierr);
+    } else continue;
+    ierr = PetscSectionAddDof(sendSection, dest[p], 2+cones[p]);CHKERRQ(ierr);
+  }
+  ierr = PetscSectionSetUp(sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionGetStorageSize(sendSection, &sendSize);CHKERRQ(ierr);
+  ierr = PetscMalloc1(sendSize, &sendCones);CHKERRQ(ierr);
+  ierr = PetscMemzero(count, numProcs * sizeof(PetscInt));CHKERRQ(ierr);
+  for (p = 0, q = 0; p < Nl; q += cones[p], ++p) {
+    if (dest[p] < 0) continue;
+    ierr = PetscSectionGetOffset(sendSection, dest[p], &off);CHKERRQ(ierr);
+    off += count[dest[p]];
+    sendCones[off++] = order[p];
+    sendCones[off++] = cones[p];
+    for (c = 0; c < cones[p]; ++c) sendCones[off++] = cellCones[q+c];
+    count[dest[p]] += 2+cones[p];
+  }
+  ierr = ISRestoreIndices(orderIS, &order);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(conesIS, &cones);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(cellsIS, &cellCones);CHKERRQ(ierr);
+  ierr = ISDestroy(&orderIS);CHKERRQ(ierr);
+  ierr = ISDestroy(&conesIS);CHKERRQ(ierr);
+  ierr = ISDestroy(&cellsIS);CHKERRQ(ierr);
+  ierr = PetscSectionCreate(comm, &recvSection);CHKERRQ(ierr);
+  ierr = DMPlexDistributeData(dm, ctx.sfProcess, sendSection, MPIU_INT, sendCones, recvSection, (void **) &recvCones);CHKERRQ(ierr);
+  ierr = PetscSectionGetStorageSize(recvSection, &recvSize);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&sendSection);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&recvSection);CHKERRQ(ierr);
+  ierr = PetscFree2(dest, count);CHKERRQ(ierr);
+  ierr = PetscFree(sendCones);CHKERRQ(ierr);
+  /* Store the cones received, the cells in cell order and the others in a section */
+  ierr = PetscSectionCreate(PETSC_COMM_SELF, &ctx.dirSection);CHKERRQ(ierr);
+  ierr = PetscSectionSetChart(ctx.dirSection, 0, orange[rank+1] - orange[rank]);CHKERRQ(ierr);
+  lcorners[0] = 0; lcorners[1] = -PETSC_MAX_INT;
+  for (r = 0; r < recvSize; r += 2+recvCones[r+1]) {
+    if (recvCones[r] < ctx.Nc) {
+      lcorners[0] = PetscMax(lcorners[0],  recvCones[r+1]);
+      lcorners[1] = PetscMax(lcorners[1], -recvCones[r+1]);
+    } else {
+      ierr = PetscSectionSetDof(ctx.dirSection, recvCones[r] - ctx.Nc - orange[rank], recvCones[r+1]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscSectionSetUp(ctx.dirSection);CHKERRQ(ierr);
+  ierr = PetscSectionGetStorageSize(ctx.dirSection, &N);CHKERRQ(ierr);
+  ierr = PetscMalloc1(N, &ctx.dirCones);CHKERRQ(ierr);
+  if (uninterpolated) {
+    ierr = MPIU_Allreduce(lcorners, corners, 2, MPIU_INT, MPI_MAX, comm);CHKERRQ(ierr);
+    numCorners = corners[0];
+    if (corners[0] != -corners[1]) SETERRQ2(comm, PETSC_ERR_SUP, "Parallel loading needs cells with the same number of vertices, not %D and %D", -corners[1], corners[0]);
+    ierr = PetscMalloc1(numLocalCells*numCorners, &cellVertices);CHKERRQ(ierr);
+  }
+  for (r = 0; r < recvSize; r += 2+recvCones[r+1]) {
+    if (recvCones[r] < ctx.Nc) {
+      /* The cone of a cell in an uninterpolated mesh holds its vertices */
+      for (c = 0; c < numCorners; ++c) cellVertices[(recvCones[r]-crange[rank])*numCorners+c] = recvCones[r+2+c] - ctx.Nc;
+    } else {
+      ierr = PetscSectionGetOffset(ctx.dirSection, recvCones[r] - ctx.Nc - orange[rank], &off);CHKERRQ(ierr);
+      for (c = 0; c < recvCones[r+1]; ++c) ctx.dirCones[off+c] = recvCones[r+2+c];
+    }
+  }
+  ierr = PetscFree(recvCones);CHKERRQ(ierr);
+  if (!uninterpolated) {
+    const PetscInt *vizCells;
+
+    ierr = PetscViewerHDF5HasAttribute(viewer, "/viz/topology/cells", "cell_corners", &hasViz);CHKERRQ(ierr);
+    if (!hasViz) SETERRQ(comm, PETSC_ERR_SUP, "Parallel loading of an interpolated mesh needs the cell vertices in /viz/topology/cells, as written by DMView()");
+    ierr = PetscViewerHDF5ReadAttribute(viewer, "/viz/topology/cells", "cell_corners", PETSC_INT, (void *) &numCorners);CHKERRQ(ierr);
+    ierr = PetscViewerHDF5PushGroup(viewer, "/viz/topology");CHKERRQ(ierr);
+    ierr = PetscViewerHDF5ReadSizes(viewer, "cells", NULL, &N);CHKERRQ(ierr);
+    if (N != ctx.Nc*numCorners) SETERRQ2(comm, PETSC_ERR_SUP, "Parallel loading needs a visualization topology holding every cell, %D entries should be %D", N, ctx.Nc*numCorners);
+    ierr = ISCreate(comm, &cellsIS);CHKERRQ(ierr);
+    ierr = PetscObjectSetName((PetscObject) cellsIS, "cells");CHKERRQ(ierr);
+    ierr = PetscLayoutSetLocalSize(cellsIS->map, numLocalCells*numCorners);CHKERRQ(ierr);
+    ierr = PetscLayoutSetSize(cellsIS->map, N);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(cellsIS->map, numCorners);CHKERRQ(ierr);
+    ierr = ISLoad(cellsIS, viewer);CHKERRQ(ierr);
+    ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
+    ierr = PetscMalloc1(numLocalCells*numCorners, &cellVertices);CHKERRQ(ierr);
+    ierr = ISGetIndices(cellsIS, &vizCells);CHKERRQ(ierr);
+    ierr = PetscMemcpy(cellVertices, vizCells, numLocalCells*numCorners * sizeof(PetscInt));CHKERRQ(ierr);
+    ierr = ISRestoreIndices(cellsIS, &vizCells);CHKERRQ(ierr);
+    ierr = ISDestroy(&cellsIS);CHKERRQ(ierr);
+    /* The visualization topology inverts cells, which we undo */
+    for (c = 0; c < numLocalCells; ++c) {ierr = DMPlexInvertCell_Internal(dim, numCorners, &cellVertices[c*numCorners]);CHKERRQ(ierr);}
+  }
+  ierr = PetscMalloc1(numLocalCells*numCorners, &cells);CHKERRQ(ierr);
+  for (c = 0; c < numLocalCells*numCorners; ++c) cells[c] = (int) cellVertices[c];
+  ierr = PetscFree(cellVertices);CHKERRQ(ierr);
+  /* Read a chunk of the vertices */
+  ierr = PetscViewerHDF5PushGroup(viewer, "/geometry");CHKERRQ(ierr);
+  ierr = VecCreate(comm, &coordinates);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) coordinates, "vertices");CHKERRQ(ierr);
+  ierr = VecSetBlockSize(coordinates, spatialDim);CHKERRQ(ierr);
+  ierr = VecSetSizes(coordinates, PETSC_DECIDE, ctx.Nv*spatialDim);CHKERRQ(ierr);
+  ierr = VecLoad(coordinates, viewer);CHKERRQ(ierr);
+  ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
+  ierr = DMPlexGetScale(dm, PETSC_UNIT_LENGTH, &lengthScale);CHKERRQ(ierr);
+  ierr = VecScale(coordinates, 1.0/lengthScale);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(coordinates, &numLocalVertices);CHKERRQ(ierr);
+  numLocalVertices /= spatialDim;
+  ierr = PetscMalloc1(numLocalVertices*spatialDim, &vertexCoords);CHKERRQ(ierr);
+  ierr = VecGetArray(coordinates, &coords);CHKERRQ(ierr);
+  for (c = 0; c < numLocalVertices*spatialDim; ++c) vertexCoords[c] = PetscRealPart(coords[c]);
+  ierr = VecRestoreArray(coordinates, &coords);CHKERRQ(ierr);
+  ierr = VecDestroy(&coordinates);CHKERRQ(ierr);
+  /* Create Plex */
+  ierr = DMPlexCreateFromCellListParallel_Internal(comm, dim, numLocalCells, numLocalVertices, numCorners, uninterpolated ? PETSC_FALSE : PETSC_TRUE, cells, spatialDim, vertexCoords, &ctx.sfVert, &pdm);CHKERRQ(ierr);
+  ierr = PetscFree(cells);CHKERRQ(ierr);
+  ierr = PetscFree(vertexCoords);CHKERRQ(ierr);
+  ierr = DMPlexReplace_Internal(dm, pdm);CHKERRQ(ierr);
+  ierr = DMDestroy(&pdm);CHKERRQ(ierr);
+  /* Read Labels*/
+  ctx.rank     = rank;
+  ctx.dm       = dm;
+  ctx.viewer   = viewer;
+  ctx.parallel = PETSC_TRUE;
+  ierr = PetscViewerHDF5PushGroup(viewer, "/labels");CHKERRQ(ierr);
+  ierr = PetscViewerHDF5OpenGroup(viewer, &fileId, &groupId);CHKERRQ(ierr);
+  PetscStackCallHDF5(H5Literate,(groupId, H5_INDEX_NAME, H5_ITER_NATIVE, &idx, ReadLabelHDF5_Static, &ctx));
+  PetscStackCallHDF5(H5Gclose,(groupId));
+  ierr = PetscViewerHDF5PopGroup(viewer);CHKERRQ(ierr);
+  ierr = PetscFree(ctx.pairs);CHKERRQ(ierr);
+  ierr = PetscFree(ctx.dirCones);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&ctx.dirSection);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&ctx.cLayout);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&ctx.oLayout);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&ctx.sfProcess);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&ctx.sfVert);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexLoad_HDF5"
-/* The first version will read everything onto proc 0, letting the user distribute
-   The next will create a naive partition, and then rebalance after reading
+/* By default this reads everything onto proc 0, letting the user distribute. With -dm_plex_load_parallel each process
+   reads a chunk, making a naive partition which the user can rebalance with DMPlexDistribute()
 */
 PetscErrorCode DMPlexLoad_HDF5(DM dm, PetscViewer viewer)
 {
@@ -661,14 +1099,21 @@ PetscErrorCode DMPlexLoad_HDF5(DM dm, PetscViewer viewer)
   PetscInt        dim, spatialDim, N, numVertices, vStart, vEnd, v, pEnd, p, q, maxConeSize = 0, c;
   hid_t           fileId, groupId;
   hsize_t         idx = 0;
-  PetscMPIInt     rank;
+  PetscBool       parallel = PETSC_FALSE;
+  PetscMPIInt     rank, numProcs;
   PetscErrorCode  ierr;
 
   PetscFunctionBegin;
   ierr = MPI_Comm_rank(PetscObjectComm((PetscObject) dm), &rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject) dm), &numProcs);CHKERRQ(ierr);
   /* Read toplogy */
   ierr = PetscViewerHDF5ReadAttribute(viewer, "/topology/cells", "cell_dim", PETSC_INT, (void *) &dim);CHKERRQ(ierr);
   ierr = DMSetDimension(dm, dim);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(((PetscObject) dm)->options, ((PetscObject) dm)->prefix, "-dm_plex_load_parallel", &parallel, NULL);CHKERRQ(ierr);
+  if (parallel && numProcs > 1) {
+    ierr = DMPlexLoadParallel_HDF5_Static(dm, viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = PetscViewerHDF5PushGroup(viewer, "/topology");CHKERRQ(ierr);
 
   ierr = ISCreate(PetscObjectComm((PetscObject) dm), &orderIS);CHKERRQ(ierr);
@@ -760,6 +1205,7 @@ PetscErrorCode DMPlexLoad_HDF5(DM dm, PetscViewer viewer)
   ierr = DMSetCoordinates(dm, coordinates);CHKERRQ(ierr);
   ierr = VecDestroy(&coordinates);CHKERRQ(ierr);
   /* Read Labels*/
+  ierr = PetscMemzero(&ctx, sizeof(LabelCtx));CHKERRQ(ierr);
   ctx.rank   = rank;
   ctx.dm     = dm;
   ctx.viewer = viewer;
@@ -73,3 +73,383 @@ PetscErrorCode DMPlexCreateClosureIndex(DM dm, PetscSection section)
   ierr = PetscSectionSetClosureIndex(section, (PetscObject) dm, closureSection, closureIS);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexSetUseClosureCache"
+/*@
+  DMPlexSetUseClosureCache - Cache the dofs in the closure of each cell, so that DMPlexVecGetClosure(), DMPlexVecSetClosure() and DMPlexMatSetClosure() on cells are indexed loads and stores
+
+  Logically collective on DM
+
+  Input Parameters:
++ dm  - The DM
+- use - PETSC_TRUE to cache the closures
+
+  Options Database Key:
+. -dm_plex_closure_cache - Use the cache
+
+  Notes:
+  The cache is built on the first closure operation with a section, and holds the local offsets of the closure dofs of every cell with
+  the orientations and the closure permutation already applied, and the global indices used by DMPlexMatSetClosure(). It is kept for
+  the few most recently used sections and is rebuilt when the state of the section changes, for instance in PetscSectionSetUp(). The
+  global indices are not cached for a DM with anchors. DMPlexGetClosureCacheMemory() gives the memory used.
+
+  Level: intermediate
+
+.seealso: DMPlexGetUseClosureCache(), DMPlexGetClosureCacheMemory(), DMPlexCreateClosureIndex(), DMPlexVecGetClosure()
+@*/
+PetscErrorCode DMPlexSetUseClosureCache(DM dm, PetscBool use)
+{
+  DM_Plex       *mesh = (DM_Plex *) dm->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidLogicalCollectiveBool(dm, use, 2);
+  mesh->useClosureCache = use;
+  if (!use) {ierr = DMPlexDestroyClosureCache_Internal(dm);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetUseClosureCache"
+/*@
+  DMPlexGetUseClosureCache - Check whether the dofs in the closure of each cell are cached
+
+  Not collective
+
+  Input Parameter:
+. dm  - The DM
+
+  Output Parameter:
+. use - PETSC_TRUE if the closures are cached
+
+  Level: intermediate
+
+.seealso: DMPlexSetUseClosureCache(), DMPlexGetClosureCacheMemory()
+@*/
+PetscErrorCode DMPlexGetUseClosureCache(DM dm, PetscBool *use)
+{
+  DM_Plex *mesh = (DM_Plex *) dm->data;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidIntPointer(use, 2);
+  *use = mesh->useClosureCache;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetClosureCacheMemory"
+/*@
+  DMPlexGetClosureCacheMemory - Get the memory used by the closure caches of the DM
+
+  Not collective
+
+  Input Parameter:
+. dm  - The DM
+
+  Output Parameter:
+. mem - The number of bytes held by the caches on this process
+
+  Level: intermediate
+
+.seealso: DMPlexSetUseClosureCache()
+@*/
+PetscErrorCode DMPlexGetClosureCacheMemory(DM dm, PetscLogDouble *mem)
+{
+  DM_Plex            *mesh = (DM_Plex *) dm->data;
+  DMPlex_ClosureCache cache;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm, DM_CLASSID, 1);
+  PetscValidPointer(mem, 2);
+  *mem = 0.0;
+  for (cache = mesh->closureCache; cache; cache = cache->next) *mem += cache->mem;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexClosureCacheDestroy_Private"
+static PetscErrorCode DMPlexClosureCacheDestroy_Private(DMPlex_ClosureCache *cache)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!*cache) PetscFunctionReturn(0);
+  ierr = PetscFree((*cache)->off);CHKERRQ(ierr);
+  ierr = PetscFree((*cache)->idx);CHKERRQ(ierr);
+  ierr = PetscBTDestroy(&(*cache)->bc);CHKERRQ(ierr);
+  ierr = PetscFree((*cache)->gidx);CHKERRQ(ierr);
+  ierr = PetscFree(*cache);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexDestroyClosureCache_Internal"
+PetscErrorCode DMPlexDestroyClosureCache_Internal(DM dm)
+{
+  DM_Plex            *mesh = (DM_Plex *) dm->data;
+  DMPlex_ClosureCache cache, next;
+  PetscErrorCode      ierr;
+
+  PetscFunctionBegin;
+  for (cache = mesh->closureCache; cache; cache = next) {
+    next = cache->next;
+    ierr = DMPlexClosureCacheDestroy_Private(&cache);CHKERRQ(ierr);
+  }
+  mesh->closureCache = NULL;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexClosureCacheGetPoints_Private"
+/* The points in the closure of cell c which are in the chart of the section, as used by DMPlexVecGetClosure() */
+static PetscErrorCode DMPlexClosureCacheGetPoints_Private(DM dm, PetscSection section, PetscInt c, PetscInt *numPoints, const PetscInt **points)
+{
+  PetscSection    clSection;
+  IS              clPoints;
+  const PetscInt *clp;
+  PetscInt       *pts = NULL;
+  PetscInt        pStart, pEnd, p, q;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSectionGetClosureIndex(section, (PetscObject) dm, &clSection, &clPoints);CHKERRQ(ierr);
+  if (clPoints) {
+    PetscInt dof, off;
+
+    ierr = PetscSectionGetDof(clSection, c, &dof);CHKERRQ(ierr);
+    ierr = PetscSectionGetOffset(clSection, c, &off);CHKERRQ(ierr);
+    /* The indices stay valid while the section holds the index */
+    ierr = ISGetIndices(clPoints, &clp);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(clPoints, &clp);CHKERRQ(ierr);
+    *numPoints = dof/2;
+    *points    = &clp[off];
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscSectionGetChart(section, &pStart, &pEnd);CHKERRQ(ierr);
+  ierr = DMPlexGetTransitiveClosure(dm, c, PETSC_TRUE, numPoints, &pts);CHKERRQ(ierr);
+  for (p = 0, q = 0; p < *numPoints*2; p += 2) {
+    if ((pts[p] >= pStart) && (pts[p] < pEnd)) {
+      pts[q*2]   = pts[p];
+      pts[q*2+1] = pts[p+1];
+      ++q;
+    }
+  }
+  *numPoints = q;
+  *points    = pts;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexClosureCacheRestorePoints_Private"
+static PetscErrorCode DMPlexClosureCacheRestorePoints_Private(DM dm, PetscSection section, PetscInt c, PetscInt *numPoints, const PetscInt **points)
+{
+  PetscSection   clSection;
+  IS             clPoints;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSectionGetClosureIndex(section, (PetscObject) dm, &clSection, &clPoints);CHKERRQ(ierr);
+  if (!clPoints) {ierr = DMPlexRestoreTransitiveClosure(dm, c, PETSC_TRUE, numPoints, (PetscInt **) points);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexClosureCacheSetUp_Private"
+/* Computes off[], idx[] and bc[] with the layout of DMPlexVecGetClosure(): field by field, reversed for negative orientations, and permuted by the closure permutation */
+static PetscErrorCode DMPlexClosureCacheSetUp_Private(DM dm, PetscSection section, DMPlex_ClosureCache cache)
+{
+  const PetscInt *perm;
+  PetscInt        numFields, numPoints, cStart = cache->cStart, cEnd = cache->cEnd, c, p, f, n;
+  PetscBool       hasBC = PETSC_FALSE;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(cache->off);CHKERRQ(ierr);
+  ierr = PetscFree(cache->idx);CHKERRQ(ierr);
+  ierr = PetscBTDestroy(&cache->bc);CHKERRQ(ierr);
+  ierr = PetscFree(cache->gidx);CHKERRQ(ierr);
+  cache->gid = 0;
+  ierr = PetscSectionGetNumFields(section, &numFields);CHKERRQ(ierr);
+  ierr = PetscSectionGetClosureInversePermutation_Internal(section, (PetscObject) dm, NULL, &perm);CHKERRQ(ierr);
+  /* Sizes */
+  ierr = PetscMalloc1(cEnd-cStart+1, &cache->off);CHKERRQ(ierr);
+  cache->off[0] = 0;
+  for (c = cStart; c < cEnd; ++c) {
+    const PetscInt *pts;
+    PetscInt        size = 0, dof, cdof;
+
+    ierr = DMPlexClosureCacheGetPoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+    for (p = 0; p < numPoints*2; p += 2) {
+      ierr = PetscSectionGetDof(section, pts[p], &dof);CHKERRQ(ierr);
+      ierr = PetscSectionGetConstraintDof(section, pts[p], &cdof);CHKERRQ(ierr);
+      size += dof;
+      if (cdof) hasBC = PETSC_TRUE;
+    }
+    ierr = DMPlexClosureCacheRestorePoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+    if (perm && size != section->clSize) SETERRQ3(PETSC_COMM_SELF, PETSC_ERR_SUP, "Closure size %D of cell %D differs from the closure permutation size %D", size, c, section->clSize);
+    cache->off[c-cStart+1] = cache->off[c-cStart] + size;
+  }
+  n    = cache->off[cEnd-cStart];
+  ierr = PetscMalloc1(n, &cache->idx);CHKERRQ(ierr);
+  if (hasBC) {ierr = PetscBTCreate(n, &cache->bc);CHKERRQ(ierr);}
+  /* Offsets */
+  for (c = cStart; c < cEnd; ++c) {
+    const PetscInt *pts;
+    PetscInt       *idx   = &cache->idx[cache->off[c-cStart]];
+    const PetscInt  cbase = cache->off[c-cStart];
+    PetscInt        q = 0;
+
+    ierr = DMPlexClosureCacheGetPoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+    for (f = 0; f < PetscMax(1, numFields); ++f) {
+      PetscSection    s = numFields ? section->field[f] : section;
+      PetscInt        fcomp = 1;
+
+      if (numFields) {ierr = PetscSectionGetFieldComponents(section, f, &fcomp);CHKERRQ(ierr);}
+      for (p = 0; p < numPoints*2; p += 2) {
+        const PetscInt  o = pts[p+1];
+        const PetscInt *cdofs;
+        PetscInt        dof, off, cdof, k, d;
+
+        ierr = PetscSectionGetDof(s, pts[p], &dof);CHKERRQ(ierr);
+        ierr = PetscSectionGetOffset(s, pts[p], &off);CHKERRQ(ierr);
+        ierr = PetscSectionGetConstraintDof(s, pts[p], &cdof);CHKERRQ(ierr);
+        if (cdof) {ierr = PetscSectionGetConstraintIndices(s, pts[p], &cdofs);CHKERRQ(ierr);}
+        for (k = 0; k < dof; ++k, ++q) {
+          /* The dof of the point at position q of the closure */
+          const PetscInt v   = o >= 0 ? k : (numFields ? (dof/fcomp-1-k/fcomp)*fcomp + k%fcomp : dof-1-k);
+          const PetscInt pos = perm ? perm[q] : q;
+
+          idx[pos] = off+v;
+          for (d = 0; d < cdof; ++d) if (cdofs[d] == v) {ierr = PetscBTSet(cache->bc, cbase+pos);CHKERRQ(ierr);}
+        }
+      }
+    }
+    ierr = DMPlexClosureCacheRestorePoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+  }
+  cache->mem = (cEnd-cStart+1+n)*sizeof(PetscInt) + (hasBC ? PetscBTLength(n) : 0);
+  ierr = PetscLogObjectMemory((PetscObject) dm, cache->mem);CHKERRQ(ierr);
+  ierr = PetscInfo3(dm, "Cached the closures of %D cells with %D dofs, %g bytes\n", cEnd-cStart, n, cache->mem);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexClosureCacheSetUpGlobal_Private"
+/* Computes gidx[] with the layout of DMPlexMatSetClosure(), which does not apply the closure permutation */
+static PetscErrorCode DMPlexClosureCacheSetUpGlobal_Private(DM dm, PetscSection section, PetscSection globalSection, DMPlex_ClosureCache cache)
+{
+  PetscInt       numFields, numPoints, cStart = cache->cStart, cEnd = cache->cEnd, c, p, f, n;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSectionGetNumFields(section, &numFields);CHKERRQ(ierr);
+  if (numFields > 31) SETERRQ1(PetscObjectComm((PetscObject) dm), PETSC_ERR_ARG_OUTOFRANGE, "Number of fields %D limited to 31", numFields);
+  if (!cache->gidx) {
+    n    = cache->off[cEnd-cStart];
+    ierr = PetscMalloc1(n, &cache->gidx);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject) dm, n*sizeof(PetscInt));CHKERRQ(ierr);
+    cache->mem += n*sizeof(PetscInt);
+  }
+  for (c = cStart; c < cEnd; ++c) {
+    const PetscInt *pts;
+    PetscInt       *gidx = &cache->gidx[cache->off[c-cStart]];
+    PetscInt        offsets[32], globalOff, off = 0;
+
+    ierr = DMPlexClosureCacheGetPoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+    ierr = PetscMemzero(offsets, 32 * sizeof(PetscInt));CHKERRQ(ierr);
+    for (p = 0; p < numPoints*2; p += 2) {
+      PetscInt fdof;
+
+      for (f = 0; f < numFields; ++f) {
+        ierr          = PetscSectionGetFieldDof(section, pts[p], f, &fdof);CHKERRQ(ierr);
+        offsets[f+1] += fdof;
+      }
+    }
+    for (f = 1; f < numFields; ++f) offsets[f+1] += offsets[f];
+    for (p = 0; p < numPoints*2; p += 2) {
+      ierr = PetscSectionGetOffset(globalSection, pts[p], &globalOff);CHKERRQ(ierr);
+      if (numFields) {ierr = DMPlexGetIndicesPointFields_Internal(section, pts[p], globalOff < 0 ? -(globalOff+1) : globalOff, offsets, PETSC_FALSE, pts[p+1], gidx);CHKERRQ(ierr);}
+      else           {ierr = DMPlexGetIndicesPoint_Internal(section, pts[p], globalOff < 0 ? -(globalOff+1) : globalOff, &off, PETSC_FALSE, pts[p+1], gidx);CHKERRQ(ierr);}
+    }
+    ierr = DMPlexClosureCacheRestorePoints_Private(dm, section, c, &numPoints, &pts);CHKERRQ(ierr);
+  }
+  cache->gid    = ((PetscObject) globalSection)->id;
+  cache->gstate = ((PetscObject) globalSection)->state;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetClosureCache_Internal"
+/*
+  DMPlexGetClosureCache_Internal - Get the closure cache for the section, building or updating it if necessary
+
+  Input Parameters:
++ dm            - The DM
+. section       - The local section
+- globalSection - The global section if gidx is needed, or NULL
+
+  Output Parameter:
+. cache - The cache, or NULL if the closures are not cached. If globalSection is given but the global indices cannot be cached, gidx is NULL.
+
+  Note: The most recently used cache is moved to the head of the list, and at most 4 sections are cached.
+*/
+PetscErrorCode DMPlexGetClosureCache_Internal(DM dm, PetscSection section, PetscSection globalSection, DMPlex_ClosureCache *cache)
+{
+  DM_Plex            *mesh = (DM_Plex *) dm->data;
+  DMPlex_ClosureCache c, prev = NULL;
+  const PetscInt      maxCaches = 4;
+  PetscInt            n = 0;
+  PetscErrorCode      ierr;
+
+  PetscFunctionBegin;
+  *cache = NULL;
+  if (!mesh->useClosureCache) PetscFunctionReturn(0);
+  for (c = mesh->closureCache; c; prev = c, c = c->next, ++n) if (c->id == ((PetscObject) section)->id) break;
+  if (!c) {
+    PetscInt cStart, cEnd;
+
+    /* Drop the least recently used cache */
+    if (n >= maxCaches) {
+      for (c = mesh->closureCache, prev = NULL; c->next; prev = c, c = c->next);
+      prev->next = NULL;
+      ierr = DMPlexClosureCacheDestroy_Private(&c);CHKERRQ(ierr);
+    }
+    ierr = DMPlexGetHeightStratum(dm, 0, &cStart, &cEnd);CHKERRQ(ierr);
+    ierr = PetscNew(&c);CHKERRQ(ierr);
+    c->id     = ((PetscObject) section)->id;
+    c->state  = ((PetscObject) section)->state;
+    c->cStart = cStart;
+    c->cEnd   = cEnd;
+    c->next   = mesh->closureCache;
+    mesh->closureCache = c;
+    ierr = DMPlexClosureCacheSetUp_Private(dm, section, c);CHKERRQ(ierr);
+  } else {
+    if (prev) {
+      prev->next = c->next;
+      c->next    = mesh->closureCache;
+      mesh->closureCache = c;
+    }
+    if (c->state != ((PetscObject) section)->state) {
+      c->state = ((PetscObject) section)->state;
+      ierr = DMPlexClosureCacheSetUp_Private(dm, section, c);CHKERRQ(ierr);
+    }
+  }
+  if (globalSection && (c->gid != ((PetscObject) globalSection)->id || c->gstate != ((PetscObject) globalSection)->state)) {
+    PetscSection anchorSection;
+
+    ierr = DMPlexGetAnchors(dm, &anchorSection, NULL);CHKERRQ(ierr);
+    if (anchorSection) {
+      /* DMPlexMatSetClosure() replaces the constrained points by their anchors */
+      if (c->gidx) c->mem -= c->off[c->cEnd-c->cStart]*sizeof(PetscInt);
+      ierr      = PetscFree(c->gidx);CHKERRQ(ierr);
+      c->gid    = ((PetscObject) globalSection)->id;
+      c->gstate = ((PetscObject) globalSection)->state;
+    } else {
+      ierr = DMPlexClosureCacheSetUpGlobal_Private(dm, section, globalSection, c);CHKERRQ(ierr);
+    }
+  }
+  *cache = c;
+  PetscFunctionReturn(0);
+}
@@ -51,8 +51,8 @@ const char ParMetisPartitionerCitation[] = "@article{KarypisKumar98,\n"
 @*/
 PetscErrorCode DMPlexCreatePartitionerGraph(DM dm, PetscInt height, PetscInt *numVertices, PetscInt **offsets, PetscInt **adjacency, IS *globalNumbering)
 {
-  PetscInt       p, pStart, pEnd, a, adjSize, idx, size, nroots;
-  PetscInt      *adj = NULL, *vOffsets = NULL, *graph = NULL;
+  PetscInt       p, pStart, pEnd, a, adjSize, idx, size, nroots, depth, dim;
+  PetscInt      *adj = NULL, *vOffsets = NULL, *graph = NULL, *localCells = NULL, *remoteCells = NULL;
   IS             cellNumbering;
   const PetscInt *cellNum;
   PetscBool      useCone, useClosure;
@@ -82,6 +82,28 @@ PetscErrorCode DMPlexCreatePartitionerGraph(DM dm, PetscInt height, PetscInt *nu
     *globalNumbering = cellNumbering;
   }
   ierr = ISGetIndices(cellNumbering, &cellNum);CHKERRQ(ierr);
+  /* Without overlap, the neighbor across a face on the process boundary is only known to the other process, so we
+     exchange the global number of the cell adjacent to each such face over the point SF */
+  ierr = DMPlexGetDepth(dm, &depth);CHKERRQ(ierr);
+  ierr = DMGetDimension(dm, &dim);CHKERRQ(ierr);
+  if (nroots > 0 && depth == dim) {
+    PetscInt fStart, fEnd, f, supportSize;
+    const PetscInt *support;
+
+    ierr = DMPlexGetHeightStratum(dm, height+1, &fStart, &fEnd);CHKERRQ(ierr);
+    ierr = PetscMalloc2(nroots, &localCells, nroots, &remoteCells);CHKERRQ(ierr);
+    for (f = 0; f < nroots; ++f) localCells[f] = remoteCells[f] = -1;
+    for (f = fStart; f < fEnd; ++f) {
+      ierr = DMPlexGetSupportSize(dm, f, &supportSize);CHKERRQ(ierr);
+      if (supportSize != 1) continue;
+      ierr = DMPlexGetSupport(dm, f, &support);CHKERRQ(ierr);
+      if (support[0] >= pStart && support[0] < pEnd && cellNum[support[0]] >= 0) localCells[f] = cellNum[support[0]];
+    }
+    ierr = PetscSFReduceBegin(sfPoint, MPIU_INT, localCells, remoteCells, MPI_MAX);CHKERRQ(ierr);
+    ierr = PetscSFReduceEnd(sfPoint, MPIU_INT, localCells, remoteCells, MPI_MAX);CHKERRQ(ierr);
+    ierr = PetscSFBcastBegin(sfPoint, MPIU_INT, localCells, remoteCells);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sfPoint, MPIU_INT, localCells, remoteCells);CHKERRQ(ierr);
+  }
   for (*numVertices = 0, p = pStart; p < pEnd; p++) {
     /* Skip non-owned cells in parallel (ParMetis expects no overlap) */
     if (nroots > 0) {if (cellNum[p] < 0) continue;}
@@ -96,6 +118,24 @@ PetscErrorCode DMPlexCreatePartitionerGraph(DM dm, PetscInt height, PetscInt *nu
         *pBuf = point;
       }
     }
+    if (localCells) {
+      const PetscInt *cone;
+      PetscInt        coneSize, c;
+
+      ierr = DMPlexGetConeSize(dm, p, &coneSize);CHKERRQ(ierr);
+      ierr = DMPlexGetCone(dm, p, &cone);CHKERRQ(ierr);
+      for (c = 0; c < coneSize; ++c) {
+        const PetscInt f = cone[c];
+
+        if (localCells[f] >= 0 && remoteCells[f] >= 0 && remoteCells[f] != localCells[f]) {
+          PetscInt *PETSC_RESTRICT pBuf;
+          ierr = PetscSectionAddDof(section, p, 1);CHKERRQ(ierr);
+          ierr = PetscSegBufferGetInts(adjBuffer, 1, &pBuf);CHKERRQ(ierr);
+          /* Already global, so it is encoded as negative to pass through the local to global map below */
+          *pBuf = -(remoteCells[f]+1);
+        }
+      }
+    }
     (*numVertices)++;
   }
   ierr = DMPlexSetAdjacencyUseCone(dm, useCone);CHKERRQ(ierr);
@@ -123,6 +163,7 @@ PetscErrorCode DMPlexCreatePartitionerGraph(DM dm, PetscInt height, PetscInt *nu
     for (n=0; n<size; n++) {if (cells_arr[n] < 0) cells_arr[n] = -(cells_arr[n]+1);}
     ierr = ISLocalToGlobalMappingRestoreIndices(ltogCells, (const PetscInt**)&cells_arr);CHKERRQ(ierr);
     ierr = ISLocalToGlobalMappingApplyBlock(ltogCells, vOffsets[*numVertices], graph, graph);CHKERRQ(ierr);
+    if (localCells) {for (n = 0; n < vOffsets[*numVertices]; ++n) if (graph[n] < 0) graph[n] = -(graph[n]+1);}
     ierr = ISLocalToGlobalMappingDestroy(&ltogCells);CHKERRQ(ierr);
     ierr = ISDestroy(&cellNumbering);CHKERRQ(ierr);
   }
@@ -131,6 +172,7 @@ PetscErrorCode DMPlexCreatePartitionerGraph(DM dm, PetscInt height, PetscInt *nu
   ierr = PetscSegBufferDestroy(&adjBuffer);CHKERRQ(ierr);
   ierr = PetscSectionDestroy(&section);CHKERRQ(ierr);
   ierr = PetscFree(adj);CHKERRQ(ierr);
+  ierr = PetscFree2(localCells, remoteCells);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
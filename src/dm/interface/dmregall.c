@@ -170,6 +170,7 @@ PetscErrorCode PetscDualSpaceRegisterAll()
 PETSC_EXTERN PetscErrorCode PetscFECreate_Basic(PetscFE);
 PETSC_EXTERN PetscErrorCode PetscFECreate_Nonaffine(PetscFE);
 PETSC_EXTERN PetscErrorCode PetscFECreate_Composite(PetscFE);
+PETSC_EXTERN PetscErrorCode PetscFECreate_Tensor(PetscFE);
 #ifdef PETSC_HAVE_OPENCL
 PETSC_EXTERN PetscErrorCode PetscFECreate_OpenCL(PetscFE);
 #endif
@@ -200,6 +201,7 @@ PetscErrorCode PetscFERegisterAll()
   ierr = PetscFERegister(PETSCFEBASIC,     PetscFECreate_Basic);CHKERRQ(ierr);
   ierr = PetscFERegister(PETSCFENONAFFINE, PetscFECreate_Nonaffine);CHKERRQ(ierr);
   ierr = PetscFERegister(PETSCFECOMPOSITE, PetscFECreate_Composite);CHKERRQ(ierr);
+  ierr = PetscFERegister(PETSCFETENSOR,    PetscFECreate_Tensor);CHKERRQ(ierr);
 #ifdef PETSC_HAVE_OPENCL
   ierr = PetscFERegister(PETSCFEOPENCL, PetscFECreate_OpenCL);CHKERRQ(ierr);
 #endif
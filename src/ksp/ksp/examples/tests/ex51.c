@@ -0,0 +1,104 @@
+
+static char help[] = "Tests KSPMatSolve() against one KSPSolve() per right hand side.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -nrhs <nrhs>      : number of right hand sides\n\
+  -beta <beta>      : convection coefficient, makes the operator nonsymmetric\n\
+  -dependent        : make the last right hand side a multiple of the first\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,U,B,X;
+  Vec            b,x;
+  KSP            ksp;
+  PetscReal      beta = 0.0,err,errmax = 0.0;
+  PetscInt       i,j,Ii,J,Istart,Iend,m = 8,n = 7,nrhs = 4,its,itsmax = 0;
+  PetscScalar    v,*u;
+  PetscBool      dependent = PETSC_FALSE;
+  KSPConvergedReason reason;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nrhs",&nrhs,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetReal(NULL,NULL,"-beta",&beta,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-dependent",&dependent,NULL);CHKERRQ(ierr);
+
+  /* five point Laplacian, with a first order upwind convection term in x when beta is nonzero */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,5,NULL);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    v = -1.0; i = Ii/n; j = Ii - i*n;
+    if (i>0)   {J = Ii - n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {
+      J = Ii - 1; v = -1.0 - beta;
+      ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+    v = 4.0 + beta; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* exact solutions U and right hand sides B = A U */
+  ierr = MatCreateDense(PETSC_COMM_WORLD,Iend-Istart,PETSC_DECIDE,m*n,nrhs,NULL,&U);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(U,&u);CHKERRQ(ierr);
+  for (j=0; j<nrhs; j++) {
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      u[Ii-Istart+j*(Iend-Istart)] = (dependent && j == nrhs-1) ? 2.0*u[Ii-Istart] : PetscSinReal((PetscReal)(Ii+1)*(j+1)/(m*n));
+    }
+  }
+  ierr = MatDenseRestoreArray(U,&u);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(U,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(U,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatMatMult(A,U,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&B);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&X);CHKERRQ(ierr);
+
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-7,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+
+  /* all the right hand sides at once */
+  ierr = KSPMatSolve(ksp,B,X);CHKERRQ(ierr);
+  ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+  ierr = KSPGetConvergedReason(ksp,&reason);CHKERRQ(ierr);
+  ierr = MatAXPY(X,-1.0,U,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatNorm(X,NORM_1,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"KSPMatSolve: %s after %D iterations, error %s\n",KSPConvergedReasons[reason],its,err < 1.e-4 ? "below 1.e-4" : "too large");CHKERRQ(ierr);
+
+  /* one right hand side at a time */
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  for (j=0; j<nrhs; j++) {
+    ierr = MatGetColumnVector(B,b,j);CHKERRQ(ierr);
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+    itsmax = PetscMax(itsmax,its);
+    ierr = MatGetColumnVector(U,b,j);CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,b);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_1,&err);CHKERRQ(ierr);
+    errmax = PetscMax(errmax,err);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"KSPSolve: at most %D iterations per right hand side, error %s\n",itsmax,errmax < 1.e-4 ? "below 1.e-4" : "too large");CHKERRQ(ierr);
+
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&U);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&X);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
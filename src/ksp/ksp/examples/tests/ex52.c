@@ -0,0 +1,89 @@
+static char help[] = "Tests the multicolor SOR (-pc_sor_multicolor) against the SOR in the natural ordering.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -bs <bs>          : number of coupled unknowns per mesh point\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,b,u;
+  KSP            ksp;
+  PC             pc;
+  PetscReal      err;
+  PetscInt       i,j,k,l,Ii,J,Istart,Iend,m = 10,n = 9,bs = 1,its;
+  PetscScalar    *v,one = 1.0;
+  PetscBool      multicolor;
+  KSPConvergedReason reason;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-bs",&bs,NULL);CHKERRQ(ierr);
+
+  /* five point Laplacian for each of the bs unknowns of a mesh point, coupled to each other at the mesh point */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,bs*m*n,bs*m*n);CHKERRQ(ierr);
+  ierr = MatSetBlockSize(A,bs);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5*bs,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5*bs,NULL,2*bs,NULL);CHKERRQ(ierr);
+  ierr = MatSeqBAIJSetPreallocation(A,bs,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIBAIJSetPreallocation(A,bs,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc1(bs*bs,&v);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart/bs; Ii<Iend/bs; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    for (k=0; k<bs*bs; k++) v[k] = 0.0;
+    for (k=0; k<bs; k++) v[k*bs+k] = -1.0;
+    if (i>0)   {J = Ii - n; ierr = MatSetValuesBlocked(A,1,&Ii,1,&J,v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; ierr = MatSetValuesBlocked(A,1,&Ii,1,&J,v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; ierr = MatSetValuesBlocked(A,1,&Ii,1,&J,v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; ierr = MatSetValuesBlocked(A,1,&Ii,1,&J,v,INSERT_VALUES);CHKERRQ(ierr);}
+    for (k=0; k<bs; k++) {
+      for (l=0; l<bs; l++) v[k*bs+l] = (k == l) ? 5.0 + 0.1*k : -0.2/(1.0 + PetscAbsInt(k-l));
+    }
+    ierr = MatSetValuesBlocked(A,1,&Ii,1,&Ii,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(v);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(A,&u,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&x);CHKERRQ(ierr);
+  ierr = VecSet(u,one);CHKERRQ(ierr);
+  ierr = MatMult(A,u,b);CHKERRQ(ierr);
+
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPSetType(ksp,KSPCG);CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCSOR);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-8,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+
+  /* the natural ordering, then the colors; a second multicolor solve reuses the coloring */
+  for (k=0; k<3; k++) {
+    multicolor = (PetscBool)(k > 0);
+    ierr = PCSORSetMulticolor(pc,multicolor);CHKERRQ(ierr);
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+    ierr = KSPGetConvergedReason(ksp,&reason);CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s SOR: %s after %D iterations, error %s\n",multicolor ? "Multicolor" : "Natural ordering",KSPConvergedReasons[reason],its,err < 1.e-6 ? "below 1.e-6" : "too large");CHKERRQ(ierr);
+  }
+
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
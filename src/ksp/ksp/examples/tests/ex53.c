@@ -0,0 +1,93 @@
+static char help[] = "Tests the single precision values of AIJ matrices and their factors (-pc_factor_single_precision, -pc_mg_single_precision).\n\
+The product with the single precision values is compared with the double precision one, then the Laplacian is solved\n\
+with CG and the preconditioner given in the options.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,b,u;
+  KSP            ksp;
+  PetscReal      err,nrm,nrmu;
+  PetscInt       i,j,Ii,J,Istart,Iend,m = 20,n = 18,its;
+  PetscScalar    v,d;
+  PetscRandom    rand;
+  KSPConvergedReason reason;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  /* five point Laplacian with a variable coefficient, so the values are not exact in single precision, plus a multiple of the identity */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    d = 1.0/3.0;
+    if (i>0)   {J = Ii - n; v = -1.0/(1.0 + 0.05*(2*i-1)); d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; v = -1.0/(1.0 + 0.05*(2*i+1)); d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -1.0/(1.0 + 0.1*i);        d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; v = -1.0/(1.0 + 0.1*i);        d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    ierr = MatSetValues(A,1,&Ii,1,&Ii,&d,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(A,&u,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&x);CHKERRQ(ierr);
+
+  /* the product with the single precision values differs from the double precision one by the rounding of the values */
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(u,rand);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = MatMult(A,u,b);CHKERRQ(ierr);
+  ierr = MatAIJSetSinglePrecision(A,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,u,b,x);CHKERRQ(ierr);
+  ierr = VecScale(x,0.5);CHKERRQ(ierr);
+  ierr = MatMult(A,u,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,b);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(b,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Single precision MatMult(): relative difference %s\n",err > 0.0 && err < 1.e-6*nrm ? "below 1.e-6" : "wrong");CHKERRQ(ierr);
+  ierr = MatAIJSetSinglePrecision(A,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatMult(A,u,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,b);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Double precision MatMult(): difference %s\n",err == 0.0 ? "zero" : "nonzero");CHKERRQ(ierr);
+
+  /* the outer Krylov method stays in double precision, so the solution is as accurate as without the single precision values */
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+  ierr = MatMult(A,u,b);CHKERRQ(ierr);
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPSetType(ksp,KSPCG);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-10,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+  ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+  ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+  ierr = KSPGetConvergedReason(ksp,&reason);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&nrmu);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s after %D iterations, error %s\n",KSPConvergedReasons[reason],its,err < 1.e-8*nrmu ? "below 1.e-8" : "too large");CHKERRQ(ierr);
+
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,106 @@
+static char help[] = "Tests the recycle space of KSPGCRODR on a sequence of linear systems with slowly changing operators.\n\
+The convection-diffusion operator on an m by n grid is solved for a sequence of convection strengths, with the\n\
+same KSP and KSPSetOperators() before each solve; the iterations are compared with those of GMRES with the same restart.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -nsolve <nsolve>  : number of linear systems\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/*
+   five point Laplacian plus an upwinded convection term of strength c, stored in the same matrix for each c
+*/
+static PetscErrorCode FillMatrix(Mat A,PetscInt m,PetscInt n,PetscReal c)
+{
+  PetscInt       i,j,Ii,J,Istart,Iend;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    if (i>0)   {J = Ii - n; v = -1.0 - c;     ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; v = -1.0;         ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -1.0 - 0.5*c; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; v = -1.0;         ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    v = 4.0 + 1.5*c; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,b,u;
+  KSP            ksp[2];
+  PetscReal      err,nrmu;
+  PetscInt       m = 24,n = 20,nsolve = 5,s,l,its[2],total[2] = {0,0};
+  KSPConvergedReason reason;
+  PetscBool      ok = PETSC_TRUE;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nsolve",&nsolve,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&u,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&x);CHKERRQ(ierr);
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+
+  /* the same restart for both, so GCRODR takes restart - k Arnoldi steps per cycle */
+  for (l=0; l<2; l++) {
+    ierr = KSPCreate(PETSC_COMM_WORLD,&ksp[l]);CHKERRQ(ierr);
+    ierr = KSPSetType(ksp[l],l ? KSPGCRODR : KSPGMRES);CHKERRQ(ierr);
+    ierr = KSPGMRESSetRestart(ksp[l],20);CHKERRQ(ierr);
+    ierr = KSPSetTolerances(ksp[l],1.e-8,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+    if (l) {ierr = KSPSetOptionsPrefix(ksp[l],"r_");CHKERRQ(ierr);}
+    ierr = KSPSetFromOptions(ksp[l]);CHKERRQ(ierr);
+  }
+
+  for (s=0; s<nsolve; s++) {
+    /* new values in the same matrix, the recycle space is kept and its image is recomputed */
+    ierr = FillMatrix(A,m,n,0.4 + 0.02*s);CHKERRQ(ierr);
+    ierr = MatMult(A,u,b);CHKERRQ(ierr);
+    for (l=0; l<2; l++) {
+      ierr = KSPSetOperators(ksp[l],A,A);CHKERRQ(ierr);
+      ierr = KSPSolve(ksp[l],b,x);CHKERRQ(ierr);
+      ierr = KSPGetIterationNumber(ksp[l],&its[l]);CHKERRQ(ierr);
+      ierr = KSPGetConvergedReason(ksp[l],&reason);CHKERRQ(ierr);
+      ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+      ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+      ierr = VecNorm(u,NORM_INFINITY,&nrmu);CHKERRQ(ierr);
+      if (reason < 0 || err > 1.e-5*nrmu) {
+        ierr = PetscPrintf(PETSC_COMM_WORLD,"Solve %D with %s: %s, error %g\n",s,l ? "GCRODR" : "GMRES",KSPConvergedReasons[reason],(double)err);CHKERRQ(ierr);
+        ok = PETSC_FALSE;
+      }
+      total[l] += its[l];
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Solve %D: GCRODR %s GMRES\n",s,its[1] < its[0] ? "needs fewer iterations than" : (its[1] == its[0] ? "needs as many iterations as" : "needs more iterations than"));CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Solutions %s\n",ok ? "accurate" : "wrong");CHKERRQ(ierr);
+  ierr = PetscInfo2(NULL,"Total iterations GMRES %D GCRODR %D\n",total[0],total[1]);CHKERRQ(ierr);
+
+  for (l=0; l<2; l++) {
+    ierr = KSPDestroy(&ksp[l]);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
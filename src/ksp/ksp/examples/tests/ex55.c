@@ -0,0 +1,132 @@
+static char help[] = "Tests the numeric rebuild of GAMG with PCGAMGSetReuseCoarsening() (-pc_gamg_reuse_coarsening).\n\
+A sequence of diffusion problems whose coefficient changes, with the same nonzero pattern, is solved with the same KSP;\n\
+after each solve the Galerkin operators of the hierarchy are compared with P^T A P for the current matrix.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -nsolve <nsolve>  : number of linear systems\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/*
+   five point stencil of -div(k grad u) with k = 1 + s x y, the coefficient of the step s changes the values only
+*/
+static PetscErrorCode FillMatrix(Mat A,PetscInt m,PetscInt n,PetscInt s)
+{
+  PetscInt       i,j,Ii,J,Istart,Iend;
+  PetscScalar    v,d;
+  PetscReal      k,x,y;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    x = (i+0.5)/m; y = (j+0.5)/n;
+    k = 1.0 + 4.0*s*x*y;
+    d = 0.0;
+    if (i>0)   {J = Ii - n; v = -k; d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; v = -k; d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -k; d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; v = -k; d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (!i || i == m-1) d += k;
+    ierr = MatSetValues(A,1,&Ii,1,&Ii,&d,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckGalerkin"
+/*
+   largest relative difference between the operator of a coarse level and P^T A P of the next finer level
+*/
+static PetscErrorCode CheckGalerkin(PC pc,PetscInt *nlevels,PetscReal *err)
+{
+  PetscInt       l;
+  KSP            smoother;
+  Mat            Af,Ac,P,C;
+  PetscReal      nrm,diff;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *err = 0.0;
+  ierr = PCMGGetLevels(pc,nlevels);CHKERRQ(ierr);
+  for (l=*nlevels-1; l>0; l--) {
+    ierr = PCMGGetSmoother(pc,l,&smoother);CHKERRQ(ierr);
+    ierr = KSPGetOperators(smoother,NULL,&Af);CHKERRQ(ierr);
+    ierr = PCMGGetSmoother(pc,l-1,&smoother);CHKERRQ(ierr);
+    ierr = KSPGetOperators(smoother,NULL,&Ac);CHKERRQ(ierr);
+    ierr = PCMGGetInterpolation(pc,l,&P);CHKERRQ(ierr);
+    ierr = MatPtAP(Af,P,MAT_INITIAL_MATRIX,2.0,&C);CHKERRQ(ierr);
+    ierr = MatAXPY(C,-1.0,Ac,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatNorm(C,NORM_FROBENIUS,&diff);CHKERRQ(ierr);
+    ierr = MatNorm(Ac,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+    *err = PetscMax(*err,diff/nrm);
+    ierr = MatDestroy(&C);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,b,u;
+  KSP            ksp;
+  PC             pc;
+  PetscReal      err,nrmu;
+  PetscInt       m = 40,n = 36,nsolve = 3,s,its,nlevels;
+  KSPConvergedReason reason;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nsolve",&nsolve,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&u,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&x);CHKERRQ(ierr);
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetType(ksp,KSPCG);CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCGAMG);CHKERRQ(ierr);
+  ierr = PCGAMGSetReuseCoarsening(pc,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-10,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+
+  for (s=0; s<nsolve; s++) {
+    /* new values in the same matrix and nonzero pattern */
+    ierr = FillMatrix(A,m,n,s);CHKERRQ(ierr);
+    ierr = MatMult(A,u,b);CHKERRQ(ierr);
+    ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+    ierr = KSPGetConvergedReason(ksp,&reason);CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+    ierr = VecNorm(u,NORM_INFINITY,&nrmu);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Solve %D: %s after %D iterations, error %s\n",s,KSPConvergedReasons[reason],its,err < 1.e-6*nrmu ? "below 1.e-6" : "too large");CHKERRQ(ierr);
+    ierr = CheckGalerkin(pc,&nlevels,&err);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"  %D levels, Galerkin operators %s\n",nlevels,err < 1.e-12 ? "match P^T A P" : "differ from P^T A P");CHKERRQ(ierr);
+  }
+
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
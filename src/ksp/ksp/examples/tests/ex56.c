@@ -0,0 +1,151 @@
+static char help[] = "Tests the inversion of the diagonal blocks of PCVPBJACOBI and PCPBJACOBI.\n\
+The matrix has random diagonal blocks whose first diagonal entry is zero, so the inversion pivots, of the sizes 5, 1\n\
+and 3 in runs of nrun blocks (PCVPBJACOBI with MatSetVariableBlockSizes()), or all of size bs, and a coupling\n\
+between neighbouring rows of different blocks. The preconditioner built from the block diagonal must invert it.\n\
+Input parameters include:\n\
+  -nb <nb>     : number of blocks on each process\n\
+  -nrun <nrun> : number of consecutive blocks of the same size\n\
+  -bs <bs>     : the same block size for all blocks\n\n";
+
+#include <petscksp.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/*
+   the diagonal blocks, and with couple the coupling between the last row of a block and the first row of the next
+*/
+static PetscErrorCode FillMatrix(Mat A,PetscInt nb,const PetscInt *bsizes,PetscBool couple)
+{
+  PetscInt       b,i,j,r,c,rstart,N;
+  PetscScalar    v;
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(A,&N,NULL);CHKERRQ(ierr);
+  for (b=0,r=rstart; b<nb; r+=bsizes[b],b++) {
+    for (i=0; i<bsizes[b]; i++) {
+      for (j=0; j<bsizes[b]; j++) {
+        ierr = PetscRandomGetValue(rand,&v);CHKERRQ(ierr);
+        if (i == j) v = (i || bsizes[b] == 1) ? v + bsizes[b] : 0.0;
+        ierr = MatSetValue(A,r+i,r+j,v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+    if (couple) {
+      c = r+bsizes[b];
+      if (c < N) {
+        ierr = MatSetValue(A,c-1,c,-0.1,INSERT_VALUES);CHKERRQ(ierr);
+        ierr = MatSetValue(A,c,c-1,-0.1,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CreateMatrix"
+static PetscErrorCode CreateMatrix(PetscInt nb,PetscInt *bsizes,PetscInt bs,PetscBool couple,Mat *A)
+{
+  PetscInt       b,n = 0,bsmax = 1;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (b=0; b<nb; b++) {
+    n    += bsizes[b];
+    bsmax = PetscMax(bsmax,bsizes[b]);
+  }
+  ierr = MatCreate(PETSC_COMM_WORLD,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,n,n,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  if (bs) {ierr = MatSetBlockSize(*A,bs);CHKERRQ(ierr);}
+  ierr = MatSetFromOptions(*A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*A,bsmax+2,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,bsmax+2,NULL,2,NULL);CHKERRQ(ierr);
+  if (bs) {
+    ierr = MatSeqBAIJSetPreallocation(*A,bs,3,NULL);CHKERRQ(ierr);
+    ierr = MatMPIBAIJSetPreallocation(*A,bs,3,NULL,2,NULL);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetVariableBlockSizes(*A,nb,bsizes);CHKERRQ(ierr);
+  }
+  ierr = FillMatrix(*A,nb,bsizes,couple);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            D,A;
+  Vec            x,b,u;
+  KSP            ksp;
+  PC             pc;
+  PetscReal      err,nrmu;
+  PetscInt       nb = 45,nrun = 9,bs = 0,i,*bsizes;
+  const PetscInt sizes[3] = {5,1,3};
+  PetscBool      flg;
+  KSPConvergedReason reason;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nb",&nb,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nrun",&nrun,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-bs",&bs,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc1(nb,&bsizes);CHKERRQ(ierr);
+  for (i=0; i<nb; i++) bsizes[i] = bs ? bs : sizes[(i/nrun)%3];
+
+  /* the preconditioner of the block diagonal is its inverse */
+  ierr = CreateMatrix(nb,bsizes,bs,PETSC_FALSE,&D);CHKERRQ(ierr);
+  ierr = MatCreateVecs(D,&u,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&x);CHKERRQ(ierr);
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+  ierr = MatMult(D,u,b);CHKERRQ(ierr);
+  ierr = PCCreate(PETSC_COMM_WORLD,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCVPBJACOBI);CHKERRQ(ierr);
+  ierr = PCSetOperators(pc,D,D);CHKERRQ(ierr);
+  ierr = PCSetFromOptions(pc);CHKERRQ(ierr);
+  ierr = PCSetUp(pc);CHKERRQ(ierr);
+  ierr = PCApply(pc,b,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"PCApply() of the block diagonal: error %s\n",err < 1.e-10 ? "below 1.e-10" : "too large");CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)pc,PCVPBJACOBI,&flg);CHKERRQ(ierr);
+  if (flg) {
+    ierr = MatMultTranspose(D,u,b);CHKERRQ(ierr);
+    ierr = PCApplyTranspose(pc,b,x);CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"PCApplyTranspose() of the block diagonal: error %s\n",err < 1.e-10 ? "below 1.e-10" : "too large");CHKERRQ(ierr);
+  }
+  ierr = PCDestroy(&pc);CHKERRQ(ierr);
+
+  /* the preconditioner of the coupled matrix */
+  ierr = CreateMatrix(nb,bsizes,bs,PETSC_TRUE,&A);CHKERRQ(ierr);
+  ierr = MatMult(A,u,b);CHKERRQ(ierr);
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCVPBJACOBI);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-10,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+  ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+  ierr = KSPGetConvergedReason(ksp,&reason);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&nrmu);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"KSPSolve(): %s, error %s\n",KSPConvergedReasons[reason],err < 1.e-6*nrmu ? "below 1.e-6" : "too large");CHKERRQ(ierr);
+
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&D);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFree(bsizes);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
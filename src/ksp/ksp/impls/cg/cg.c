@@ -583,6 +583,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_CG(KSP ksp)
   */
   ksp->ops->setup          = KSPSetUp_CG;
   ksp->ops->solve          = KSPSolve_CG;
+  ksp->ops->matsolve       = KSPMatSolve_CG;
   ksp->ops->destroy        = KSPDestroy_CG;
   ksp->ops->view           = KSPView_CG;
   ksp->ops->setfromoptions = KSPSetFromOptions_CG;
@@ -0,0 +1,187 @@
+
+/*
+    Block conjugate gradient method for several right hand sides, used by KSPMatSolve() with KSPCG.
+
+    The block of search directions P is kept orthonormal and is rebuilt at each iteration from the preconditioned
+  residuals with a rank revealing orthogonalization, so that directions that become linearly dependent, for
+  example when some of the right hand sides have converged, are dropped rather than causing a breakdown of the
+  small systems solved at each iteration.
+
+    Reference: H. Ji and Y. Li, A breakdown-free block conjugate gradient method, BIT Numerical Mathematics 57, 2017.
+*/
+#include <../src/ksp/ksp/impls/cg/cgimpl.h>       /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockCGNorms"
+/*
+   Norms of the columns of the residual, as selected by the norm type, and C = Q^H Z computed in the same reduction
+*/
+static PetscErrorCode KSPBlockCGNorms(KSP ksp,PetscInt k,PetscInt rk,Mat Q,Mat R,Mat Z,PetscScalar *lbuf,PetscScalar *C,PetscReal *nrm)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *q,*r,*z,*s,one = 1.0,zero = 0.0;
+  PetscInt       n,i,j;
+  PetscBLASInt   bn,bk,brk,bld;
+
+  PetscFunctionBegin;
+  ierr = MatGetLocalSize(R,&n,NULL);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(R,&r);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(Z,&z);CHKERRQ(ierr);
+  if (rk) {
+    ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(rk,&brk);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(PetscMax(n,1),&bld);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(Q,&q);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&brk,&bk,&bn,&one,q,&bld,z,&bld,&zero,lbuf,&brk));
+    ierr = MatDenseRestoreArray(Q,&q);CHKERRQ(ierr);
+  }
+  s = lbuf + rk*k;
+  for (j=0; j<k; j++) {
+    s[j] = 0.0;
+    switch (ksp->normtype) {
+    case KSP_NORM_PRECONDITIONED:
+      for (i=0; i<n; i++) s[j] += PetscConj(z[i+j*n])*z[i+j*n];
+      break;
+    case KSP_NORM_UNPRECONDITIONED:
+      for (i=0; i<n; i++) s[j] += PetscConj(r[i+j*n])*r[i+j*n];
+      break;
+    case KSP_NORM_NATURAL:
+      for (i=0; i<n; i++) s[j] += PetscConj(r[i+j*n])*z[i+j*n];
+      break;
+    default:
+      break;
+    }
+  }
+  ierr = MatDenseRestoreArray(Z,&z);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+  ierr = MPIU_Allreduce(lbuf,C,rk*k+k,MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)ksp));CHKERRQ(ierr);
+  for (j=0; j<k; j++) nrm[j] = PetscSqrtReal(PetscAbsScalar(C[rk*k+j]));
+  ierr = PetscLogFlops(2.0*n*(rk+1)*k);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatSolve_CG"
+PetscErrorCode KSPMatSolve_CG(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode ierr;
+  Mat            R,Z,P,W,T,Q = NULL;
+  PetscScalar    *lbuf,*gbuf,*D,*C,*p,*q,*r,*w,*x,one = 1.0,mone = -1.0,zero = 0.0;
+  PetscReal      *ref,*nrm,*scl;
+  PetscInt       n,k,rk,j;
+  PetscBLASInt   bn,bk,brk,bld,info;
+#if defined(PETSC_USE_COMPLEX)
+  KSP_CG         *cg = (KSP_CG*)ksp->data;
+
+  PetscFunctionBegin;
+  if (cg->type != KSP_CG_HERMITIAN) {
+    ierr = KSPMatSolveColumns(ksp,B,X);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#else
+  PetscFunctionBegin;
+#endif
+  ierr = MatGetLocalSize(B,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,NULL,&k);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(n,1),&bld);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_COPY_VALUES,&R);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&Z);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&P);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&W);CHKERRQ(ierr);
+  ierr = PetscMalloc4(2*k*k+k,&lbuf,2*k*k+k,&gbuf,k*k,&D,k*k,&C);CHKERRQ(ierr);
+  ierr = PetscMalloc3(k,&ref,k,&nrm,k,&scl);CHKERRQ(ierr);
+
+  /* R = B - A X */
+  if (ksp->guess_zero) {
+    ierr = MatZeroEntries(X);CHKERRQ(ierr);
+  } else {
+    ierr = KSPBlockMatMult(ksp,X,&Q);CHKERRQ(ierr);
+    ierr = MatAXPY(R,-1.0,Q,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  }
+  ierr = KSPBlockPCApply(ksp,R,Z);CHKERRQ(ierr);
+  ierr = KSPBlockCGNorms(ksp,k,0,NULL,R,Z,lbuf,gbuf,ref);CHKERRQ(ierr);
+  ierr = KSPBlockConverged(ksp,k,ref,ref);CHKERRQ(ierr);
+  if (ksp->reason) goto finished;
+
+  /* columns are weighted by their initial residual when deciding which search directions are dependent */
+  for (j=0; j<k; j++) scl[j] = ref[j] > 0.0 ? 1.0/ref[j] : 1.0;
+  ierr = MatCopy(Z,P,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = KSPBlockOrthogonalize(P,k,scl,0.0,&rk,NULL,0);CHKERRQ(ierr);
+  if (!rk) {
+    ksp->reason = KSP_DIVERGED_BREAKDOWN;
+    goto finished;
+  }
+
+  while (1) {
+    ierr = KSPBlockMatMult(ksp,P,&Q);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(rk,&brk);CHKERRQ(ierr);
+
+    /* Delta = P^H A P and Gamma = P^H R in one reduction */
+    ierr = MatDenseGetArray(P,&p);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(Q,&q);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(R,&r);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&brk,&brk,&bn,&one,p,&bld,q,&bld,&zero,lbuf,&brk));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&brk,&bk,&bn,&one,p,&bld,r,&bld,&zero,lbuf+rk*rk,&brk));
+    ierr = MPIU_Allreduce(lbuf,gbuf,rk*(rk+k),MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)ksp));CHKERRQ(ierr);
+    ierr = PetscMemcpy(D,gbuf,rk*rk*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr = PetscMemcpy(C,gbuf+rk*rk,rk*k*sizeof(PetscScalar));CHKERRQ(ierr);
+    PetscStackCallBLAS("LAPACKpotrf",LAPACKpotrf_("U",&brk,D,&brk,&info));
+    if (info) {
+      ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+      ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+      ierr = MatDenseRestoreArray(Q,&q);CHKERRQ(ierr);
+      ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+      ierr = PetscInfo1(ksp,"Block of search directions is not positive definite, pivot %d\n",(int)info);CHKERRQ(ierr);
+      ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+      break;
+    }
+    /* alpha = Delta^{-1} Gamma, X = X + P alpha, R = R - A P alpha */
+    PetscStackCallBLAS("LAPACKpotrs",LAPACKpotrs_("U",&brk,&bk,D,&brk,C,&brk,&info));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bn,&bk,&brk,&one,p,&bld,C,&brk,&one,x,&bld));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bn,&bk,&brk,&mone,q,&bld,C,&brk,&one,r,&bld));
+    ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(Q,&q);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+    ierr = PetscLogFlops(2.0*n*rk*(rk+3*k));CHKERRQ(ierr);
+
+    ierr = KSPBlockPCApply(ksp,R,Z);CHKERRQ(ierr);
+    ksp->its++;
+    ierr = KSPBlockCGNorms(ksp,k,rk,Q,R,Z,lbuf,gbuf,nrm);CHKERRQ(ierr);
+    ierr = KSPBlockConverged(ksp,k,nrm,ref);CHKERRQ(ierr);
+    if (ksp->reason) break;
+
+    /* beta = -Delta^{-1} (A P)^H Z makes Z + P beta conjugate to P; its orthonormalized columns are the new directions */
+    for (j=0; j<rk*k; j++) C[j] = -gbuf[j];
+    PetscStackCallBLAS("LAPACKpotrs",LAPACKpotrs_("U",&brk,&bk,D,&brk,C,&brk,&info));
+    ierr = MatCopy(Z,W,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(P,&p);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(W,&w);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bn,&bk,&brk,&one,p,&bld,C,&brk,&one,w,&bld));
+    ierr = MatDenseRestoreArray(W,&w);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+    ierr = PetscLogFlops(2.0*n*rk*k);CHKERRQ(ierr);
+    ierr = KSPBlockOrthogonalize(W,k,scl,0.0,&rk,NULL,0);CHKERRQ(ierr);
+    T = P; P = W; W = T;
+    if (!rk) {
+      ierr = PetscInfo(ksp,"All search directions are dependent\n");CHKERRQ(ierr);
+      ksp->reason = KSP_DIVERGED_BREAKDOWN;
+      break;
+    }
+  }
+
+finished:
+  ierr = PetscFree4(lbuf,gbuf,D,C);CHKERRQ(ierr);
+  ierr = PetscFree3(ref,nrm,scl);CHKERRQ(ierr);
+  ierr = MatDestroy(&Q);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = MatDestroy(&Z);CHKERRQ(ierr);
+  ierr = MatDestroy(&P);CHKERRQ(ierr);
+  ierr = MatDestroy(&W);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
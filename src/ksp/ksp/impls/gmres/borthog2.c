@@ -8,6 +8,20 @@
 */
 #include <../src/ksp/ksp/impls/gmres/gmresimpl.h>
 
+/*
+   After vnew <- vnew - V h with orthonormal V, ||vnew||^2 = ||v||^2 - ||h||^2. The difference is only
+   an estimate of the norm; it is used when requested with -ksp_gmres_cgs_norm_estimate and when it has
+   not lost too many digits to cancellation, otherwise the solvers compute the norm with VecNorm().
+*/
+#define KSPGMRES_CGS_NORM_CANCEL 1.e-2
+
+PETSC_STATIC_INLINE void KSPGMRESCGSNormEstimate_Private(KSP_GMRES *gmres,PetscReal vnrm,PetscReal hnrm2)
+{
+  PetscReal wnrm2 = vnrm*vnrm - hnrm2;
+
+  gmres->orthognorm = (gmres->cgsnorm && wnrm2 > KSPGMRES_CGS_NORM_CANCEL*vnrm*vnrm) ? PetscSqrtReal(wnrm2) : -1.0;
+}
+
 /*@C
      KSPGMRESClassicalGramSchmidtOrthogonalization -  This is the basic orthogonalization routine
                 using classical Gram-Schmidt with possible iterative refinement to improve the stability
@@ -25,6 +39,12 @@
 
     Notes: Use KSPGMRESSetCGSRefinementType() to determine if iterative refinement is to be used
 
+    With -ksp_gmres_cgs_norm_estimate the norm of the vector is computed together with the inner products by
+    VecMDotAndNorm(), and the norm of the new direction is estimated as sqrt(||v||^2 - ||h||^2). GMRES, FGMRES and
+    LGMRES then use this estimate instead of computing the norm, so they need a single reduction per iteration
+    unless refinement is done. The estimate differs from the computed norm in the last digits, so the residual
+    history changes slightly.
+
    Level: intermediate
 
 .seelaso:  KSPGMRESSetOrthogonalization(), KSPGMRESClassicalGramSchmidtOrthogonalization(), KSPGMRESSetCGSRefinementType(),
@@ -39,7 +59,7 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
   PetscErrorCode ierr;
   PetscInt       j;
   PetscScalar    *hh,*hes,*lhh;
-  PetscReal      hnrm, wnrm;
+  PetscReal      hnrm, wnrm, vnrm = 0.0;
   PetscBool      refine = (PetscBool)(gmres->cgstype == KSP_GMRES_CGS_REFINE_ALWAYS);
 
   PetscFunctionBegin;
@@ -61,9 +81,13 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
 
   /*
      This is really a matrix-vector product, with the matrix stored
-     as pointer to rows
+     as pointer to rows; the norm of vnew comes with it in the same reduction if requested
   */
-  ierr = VecMDot(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh);CHKERRQ(ierr); /* <v,vnew> */
+  if (gmres->cgsnorm) {
+    ierr = VecMDotAndNorm(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh,&vnrm);CHKERRQ(ierr); /* <v,vnew> */
+  } else {
+    ierr = VecMDot(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh);CHKERRQ(ierr); /* <v,vnew> */
+  }
   for (j=0; j<=it; j++) {
     KSPCheckDot(ksp,lhh[j]);
     lhh[j] = -lhh[j];
@@ -75,21 +99,24 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
   */
   ierr = VecMAXPY(VEC_VV(it+1),it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
   /* note lhh[j] is -<v,vnew> , hence the subtraction */
+  hnrm = 0.0;
   for (j=0; j<=it; j++) {
     hh[j]  -= lhh[j];     /* hh += <v,vnew> */
     hes[j] -= lhh[j];     /* hes += <v,vnew> */
+    hnrm   += PetscRealPart(lhh[j] * PetscConj(lhh[j]));
   }
+  KSPGMRESCGSNormEstimate_Private(gmres,vnrm,hnrm);
 
   /*
    *  the second step classical Gram-Schmidt is only necessary
    *  when a simple test criteria is not passed
    */
   if (gmres->cgstype == KSP_GMRES_CGS_REFINE_IFNEEDED) {
-    hnrm = 0.0;
-    for (j=0; j<=it; j++) hnrm +=  PetscRealPart(lhh[j] * PetscConj(lhh[j]));
-
     hnrm = PetscSqrtReal(hnrm);
-    ierr = VecNorm(VEC_VV(it+1),NORM_2, &wnrm);CHKERRQ(ierr);
+    if (gmres->orthognorm >= 0.0) wnrm = gmres->orthognorm;
+    else {
+      ierr = VecNorm(VEC_VV(it+1),NORM_2, &wnrm);CHKERRQ(ierr);
+    }
     if (wnrm < hnrm) {
       refine = PETSC_TRUE;
       ierr   = PetscInfo2(ksp,"Performing iterative refinement wnorm %g hnorm %g\n",(double)wnrm,(double)hnrm);CHKERRQ(ierr);
@@ -97,14 +124,21 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
   }
 
   if (refine) {
-    ierr = VecMDot(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh);CHKERRQ(ierr); /* <v,vnew> */
+    if (gmres->cgsnorm) {
+      ierr = VecMDotAndNorm(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh,&vnrm);CHKERRQ(ierr); /* <v,vnew> */
+    } else {
+      ierr = VecMDot(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh);CHKERRQ(ierr); /* <v,vnew> */
+    }
     for (j=0; j<=it; j++) lhh[j] = -lhh[j];
     ierr = VecMAXPY(VEC_VV(it+1),it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
     /* note lhh[j] is -<v,vnew> , hence the subtraction */
+    hnrm = 0.0;
     for (j=0; j<=it; j++) {
       hh[j]  -= lhh[j];     /* hh += <v,vnew> */
       hes[j] -= lhh[j];     /* hes += <v,vnew> */
+      hnrm   += PetscRealPart(lhh[j] * PetscConj(lhh[j]));
     }
+    KSPGMRESCGSNormEstimate_Private(gmres,vnrm,hnrm);
   }
   ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -116,4 +150,3 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
 
 
 
-
@@ -0,0 +1,893 @@
+
+/*
+    This file implements GCRODR, GMRES with deflated restarting and recycling of the deflation space
+    from one linear solve to the next.
+    Reference:  M. Parks, E. de Sturler, G. Mackey, D. Johnson and S. Maiti, 2006.
+
+    The recycle space U is kept with C = Op U, where Op = B^{-1}A with left and AB^{-1} with right
+    preconditioning, and C has orthonormal columns. Each cycle removes the part of the residual in the
+    range of C and runs Arnoldi with the projected operator (I - C C^H) Op; the new direction is
+    orthogonalized against C and the Krylov vectors together, with a single VecMDot(), so the coupling
+    B = C^H Op V comes with the Hessenberg matrix. Since C^H r = 0 the least squares problem is that
+    of GMRES, and the correction is V y + U (C^H r_0 - B y).
+
+    At the end of each cycle the recycle space is replaced by the harmonic Ritz vectors of Op in the
+    space spanned by U and the Krylov vectors that belong to the harmonic Ritz values of smallest
+    magnitude. Between solves the recycle space is kept; when the operators have changed C is
+    recomputed from U, so in a sequence of solves with slowly changing matrices the slow modes
+    deflated in one solve are deflated from the start of the next.
+*/
+
+#include <../src/ksp/ksp/impls/gmres/gcrodr/gcrodrimpl.h>       /*I  "petscksp.h"  I*/
+#include <petsc/private/vecimpl.h>
+
+#define GCRODR_DELTA_DIRECTIONS 10
+#define GCRODR_DEFAULT_MAXK     30
+#define GCRODR_DEFAULT_RECYCLE  10
+/* the norm of a vector after the removal of orthonormal directions is computed from the inner products when this keeps enough digits */
+#define GCRODR_NORM_CANCEL      1.e-2
+
+static PetscErrorCode KSPGCRODRUpdateHessenberg(KSP,PetscInt,PetscBool,PetscReal*);
+static PetscErrorCode KSPGCRODRBuildSoln(PetscScalar*,Vec,Vec,KSP,PetscInt);
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_GCRODR"
+PetscErrorCode KSPSetUp_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscInt       max_k   = gcrodr->max_k,k_max = gcrodr->k_max;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k_max >= max_k) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Dimension of the recycle space %D must be less than the restart %D",k_max,max_k);
+  ierr = KSPSetUp_GMRES(ksp);CHKERRQ(ierr);
+
+  /* the inner products are taken with C as well as with the Krylov vectors */
+  ierr = PetscMalloc1(k_max+max_k+2,&gcrodr->orthogwork);CHKERRQ(ierr);
+  ierr = PetscMalloc5(k_max+max_k+1,&gcrodr->ortho,k_max+max_k,&gcrodr->yhat,k_max*max_k,&gcrodr->bk,k_max,&gcrodr->alpha,k_max,&gcrodr->ucoef);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,(k_max+max_k+2 + k_max*max_k + 2*k_max)*sizeof(PetscScalar) + (2*k_max+2*max_k+1)*sizeof(Vec));CHKERRQ(ierr);
+  if (k_max) {
+    ierr = KSPCreateVecs(ksp,k_max,&gcrodr->U,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,k_max,gcrodr->U);CHKERRQ(ierr);
+    ierr = KSPCreateVecs(ksp,k_max,&gcrodr->C,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,k_max,gcrodr->C);CHKERRQ(ierr);
+    ierr = KSPCreateVecs(ksp,k_max,&gcrodr->Unew,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,k_max,gcrodr->Unew);CHKERRQ(ierr);
+    ierr = KSPCreateVecs(ksp,k_max,&gcrodr->Cnew,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,k_max,gcrodr->Cnew);CHKERRQ(ierr);
+  }
+
+  /* the eigenvalue problem for the harmonic Ritz vectors has at most max_k unknowns, k from U and the rest from the Krylov vectors */
+  gcrodr->lwork = 8*max_k + 16 + 2*k_max*max_k;
+  ierr = PetscMalloc7((max_k+1)*max_k,&gcrodr->G,(max_k+1)*max_k,&gcrodr->WY,max_k*max_k,&gcrodr->GG,max_k*max_k,&gcrodr->GW,max_k*max_k,&gcrodr->Q,max_k*max_k,&gcrodr->Z,(max_k+1)*k_max,&gcrodr->GP);CHKERRQ(ierr);
+  ierr = PetscMalloc7(gcrodr->lwork,&gcrodr->work,max_k,&gcrodr->wr,max_k,&gcrodr->wi,max_k,&gcrodr->beta,max_k,&gcrodr->modul,max_k,&gcrodr->perm,max_k,&gcrodr->select);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,(2*(max_k+1)*max_k + 4*max_k*max_k + (max_k+1)*k_max + gcrodr->lwork)*sizeof(PetscScalar) + 4*max_k*sizeof(PetscReal) + max_k*(sizeof(PetscInt)+sizeof(PetscBLASInt)));CHKERRQ(ierr);
+  gcrodr->k = 0;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Orthonormalizes the columns of C with classical Gram-Schmidt done twice and applies the same transformations to U,
+   so that C = Op U still holds. Directions that are numerically in the span of the previous ones are dropped; on
+   output k is the number of directions kept.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODROrthonormalize"
+static PetscErrorCode KSPGCRODROrthonormalize(KSP ksp,PetscInt *k,Vec *U,Vec *C)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscScalar    *h      = gcrodr->orthogwork;
+  PetscReal      nrm0,nrm;
+  PetscInt       i,j,l,n = 0;
+  Vec            t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (j=0; j<*k; j++) {
+    if (n != j) {
+      t = U[n]; U[n] = U[j]; U[j] = t;
+      t = C[n]; C[n] = C[j]; C[j] = t;
+    }
+    if (n) {
+      for (l=0; l<2; l++) {
+        if (!l) {
+          ierr = VecMDotAndNorm(C[n],n,C,h,&nrm0);CHKERRQ(ierr);
+        } else {
+          ierr = VecMDot(C[n],n,C,h);CHKERRQ(ierr);
+        }
+        for (i=0; i<n; i++) h[i] = -h[i];
+        ierr = VecMAXPY(C[n],n,h,C);CHKERRQ(ierr);
+        ierr = VecMAXPY(U[n],n,h,U);CHKERRQ(ierr);
+      }
+    } else {
+      ierr = VecNorm(C[n],NORM_2,&nrm0);CHKERRQ(ierr);
+    }
+    ierr = VecNorm(C[n],NORM_2,&nrm);CHKERRQ(ierr);
+    if (nrm <= 1.e-10*nrm0 || nrm == 0.0) {
+      ierr = PetscInfo2(ksp,"Dropping direction %D of the recycle space, it is in the span of the previous %D\n",j,n);CHKERRQ(ierr);
+      continue;
+    }
+    ierr = VecScale(C[n],1.0/nrm);CHKERRQ(ierr);
+    ierr = VecScale(U[n],1.0/nrm);CHKERRQ(ierr);
+    n++;
+  }
+  *k = n;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Recomputes C = Op U if the operators have changed since C was computed, for example after KSPSetOperators()
+   with new matrices or new values in the same matrices. The recycle space U itself is kept.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRCheckOperators"
+static PetscErrorCode KSPGCRODRCheckOperators(KSP ksp)
+{
+  KSP_GCRODR       *gcrodr = (KSP_GCRODR*)ksp->data;
+  Mat              Amat,Pmat;
+  PetscObjectId    Aid,Pid;
+  PetscObjectState Astate,Pstate;
+  PetscInt         j;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = PetscObjectGetId((PetscObject)Amat,&Aid);CHKERRQ(ierr);
+  ierr = PetscObjectGetId((PetscObject)Pmat,&Pid);CHKERRQ(ierr);
+  ierr = PetscObjectStateGet((PetscObject)Amat,&Astate);CHKERRQ(ierr);
+  ierr = PetscObjectStateGet((PetscObject)Pmat,&Pstate);CHKERRQ(ierr);
+  if (gcrodr->k && (Aid != gcrodr->Aid || Pid != gcrodr->Pid || Astate != gcrodr->Astate || Pstate != gcrodr->Pstate)) {
+    for (j=0; j<gcrodr->k; j++) {
+      ierr = KSP_PCApplyBAorAB(ksp,gcrodr->U[j],gcrodr->C[j],VEC_TEMP_MATOP);CHKERRQ(ierr);
+    }
+    ierr = KSPGCRODROrthonormalize(ksp,&gcrodr->k,gcrodr->U,gcrodr->C);CHKERRQ(ierr);
+    ierr = PetscInfo1(ksp,"Recomputed the recycle space of dimension %D for the new operators\n",gcrodr->k);CHKERRQ(ierr);
+    gcrodr->ncompute++;
+  }
+  gcrodr->Aid    = Aid;
+  gcrodr->Pid    = Pid;
+  gcrodr->Astate = Astate;
+  gcrodr->Pstate = Pstate;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Orthogonalizes the new direction VEC_VV(it+1) against C and the Krylov vectors with classical Gram-Schmidt, all
+   inner products and the norm of the new direction in one reduction; the inner products with C go into BK(:,it).
+   The refinement follows KSPGMRESClassicalGramSchmidtOrthogonalization().
+*/
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODROrthogonalize"
+static PetscErrorCode KSPGCRODROrthogonalize(KSP ksp,PetscInt it)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscInt       j,k = gcrodr->k,n = gcrodr->k + it + 1;
+  PetscScalar    *hh,*hes,*lhh = gcrodr->orthogwork;
+  PetscReal      hnrm,wnrm,vnrm;
+  PetscBool      refine = (PetscBool)(gcrodr->cgstype == KSP_GMRES_CGS_REFINE_ALWAYS),known;
+  Vec            *ortho = gcrodr->ortho;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscLogEventBegin(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+  ortho[k+it] = VEC_VV(it);
+  hh  = HH(0,it);
+  hes = HES(0,it);
+  for (j=0; j<=it; j++) {
+    hh[j]  = 0.0;
+    hes[j] = 0.0;
+  }
+  for (j=0; j<k; j++) *BK(j,it) = 0.0;
+
+  ierr = VecMDotAndNorm(VEC_VV(it+1),n,ortho,lhh,&vnrm);CHKERRQ(ierr);
+  for (j=0; j<n; j++) {
+    KSPCheckDot(ksp,lhh[j]);
+    lhh[j] = -lhh[j];
+  }
+  ierr = VecMAXPY(VEC_VV(it+1),n,lhh,ortho);CHKERRQ(ierr);
+  hnrm = 0.0;
+  for (j=0; j<n; j++) hnrm += PetscRealPart(lhh[j] * PetscConj(lhh[j]));
+  for (j=0; j<k; j++) *BK(j,it) -= lhh[j];
+  for (j=0; j<=it; j++) {
+    hh[j]  -= lhh[k+j];
+    hes[j] -= lhh[k+j];
+  }
+  wnrm  = vnrm*vnrm - hnrm;
+  known = (PetscBool)(wnrm > GCRODR_NORM_CANCEL*vnrm*vnrm);
+  wnrm  = known ? PetscSqrtReal(wnrm) : 0.0;
+
+  if (gcrodr->cgstype == KSP_GMRES_CGS_REFINE_IFNEEDED) {
+    hnrm = PetscSqrtReal(hnrm);
+    if (!known) {
+      ierr = VecNorm(VEC_VV(it+1),NORM_2,&wnrm);CHKERRQ(ierr);
+    }
+    if (wnrm < hnrm) {
+      refine = PETSC_TRUE;
+      ierr   = PetscInfo2(ksp,"Performing iterative refinement wnorm %g hnorm %g\n",(double)wnrm,(double)hnrm);CHKERRQ(ierr);
+    }
+  }
+
+  if (refine) {
+    ierr = VecMDotAndNorm(VEC_VV(it+1),n,ortho,lhh,&vnrm);CHKERRQ(ierr);
+    for (j=0; j<n; j++) lhh[j] = -lhh[j];
+    ierr = VecMAXPY(VEC_VV(it+1),n,lhh,ortho);CHKERRQ(ierr);
+    hnrm = 0.0;
+    for (j=0; j<n; j++) hnrm += PetscRealPart(lhh[j] * PetscConj(lhh[j]));
+    for (j=0; j<k; j++) *BK(j,it) -= lhh[j];
+    for (j=0; j<=it; j++) {
+      hh[j]  -= lhh[k+j];
+      hes[j] -= lhh[k+j];
+    }
+    wnrm  = vnrm*vnrm - hnrm;
+    known = (PetscBool)(wnrm > GCRODR_NORM_CANCEL*vnrm*vnrm);
+    wnrm  = known ? PetscSqrtReal(wnrm) : 0.0;
+  }
+
+  if (known) {
+    ierr = PetscObjectComposedDataSetReal((PetscObject)VEC_VV(it+1),NormIds[NORM_2],wnrm);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Replaces the recycle space with the harmonic Ritz vectors of the last cycle, which had p Arnoldi steps.
+
+   With Yhat = [U V_p] and W = [C V_{p+1}], Op Yhat = W G with G = [I B; 0 Hbar]. The harmonic Ritz vectors are
+   Yhat z for the generalized eigenvalue problem G^H G z = theta G^H W^H Yhat z; the Schur vectors of the k_max
+   eigenvalues of smallest magnitude give the new U = Yhat P, with C = W G P orthonormalized.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRUpdateRecycleSpace"
+static PetscErrorCode KSPGCRODRUpdateRecycleSpace(KSP ksp,PetscInt p)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscInt       i,j,k = gcrodr->k,N = gcrodr->k + p,kk = 0,pair;
+  PetscScalar    *G = gcrodr->G,*WY = gcrodr->WY,*Z = gcrodr->Z,*GP = gcrodr->GP,one = 1.0,zero = 0.0;
+  PetscReal      *wr = gcrodr->wr,*wi = gcrodr->wi,*beta = gcrodr->beta,*modul = gcrodr->modul;
+  PetscInt       *perm = gcrodr->perm;
+  PetscBLASInt   *select = gcrodr->select,bN,bN1,bkk,m,info,sdim,ijob = 0,wantq = 0,wantz = 1,liwork = 1,iwork;
+  Vec            *ortho = gcrodr->ortho,*yhat = gcrodr->yhat,*t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscBLASIntCast(N,&bN);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(N+1,&bN1);CHKERRQ(ierr);
+
+  /* G = [I B; 0 Hbar], of size N+1 by N */
+  ierr = PetscMemzero(G,(N+1)*N*sizeof(PetscScalar));CHKERRQ(ierr);
+  for (j=0; j<k; j++) G[j+j*(N+1)] = 1.0;
+  for (j=0; j<p; j++) {
+    for (i=0; i<k; i++)    G[i+(k+j)*(N+1)]   = *BK(i,j);
+    for (i=0; i<=j+1; i++) G[k+i+(k+j)*(N+1)] = *HES(i,j);
+  }
+
+  /* W^H Yhat = [C^H U 0; V_{p+1}^H U I] */
+  for (j=0; j<=p; j++) ortho[k+j] = VEC_VV(j);
+  ierr = PetscMemzero(WY,(N+1)*N*sizeof(PetscScalar));CHKERRQ(ierr);
+  for (j=0; j<k; j++) {
+    ierr = VecMDot(gcrodr->U[j],N+1,ortho,WY+j*(N+1));CHKERRQ(ierr);
+  }
+  for (j=0; j<p; j++) WY[k+j+(k+j)*(N+1)] = 1.0;
+
+  PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bN,&bN,&bN1,&one,G,&bN1,G,&bN1,&zero,gcrodr->GG,&bN));
+  PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bN,&bN,&bN1,&one,G,&bN1,WY,&bN1,&zero,gcrodr->GW,&bN));
+
+#if defined(PETSC_MISSING_LAPACK_GGES)
+  SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"GGES - Lapack routine is unavailable.");
+#elif defined(PETSC_MISSING_LAPACK_TGSEN)
+  SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"TGSEN - Lapack routine is unavailable.");
+#else
+  PetscStackCallBLAS("LAPACKgges",LAPACKgges_("N","V","N",NULL,&bN,gcrodr->GG,&bN,gcrodr->GW,&bN,&sdim,wr,wi,beta,gcrodr->Q,&bN,Z,&bN,gcrodr->work,&gcrodr->lwork,NULL,&info));
+  if (info) {
+    ierr = PetscInfo1(ksp,"Error in LAPACK routine XGGES %d, keeping the previous recycle space\n",(int)info);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  /* select the eigenvalues of smallest magnitude, complex conjugate pairs together */
+  for (i=0; i<N; i++) {
+    modul[i]  = beta[i] != 0.0 ? PetscSqrtReal(wr[i]*wr[i] + wi[i]*wi[i])/PetscAbsReal(beta[i]) : PETSC_MAX_REAL;
+    perm[i]   = i;
+    select[i] = 0;
+  }
+  ierr = PetscSortRealWithPermutation(N,modul,perm);CHKERRQ(ierr);
+  for (j=0; j<N; j++) {
+    i = perm[j];
+    if (select[i]) continue;
+    if (wi[i] != 0.0) {
+      if (kk + 2 > gcrodr->k_max) break;
+      pair         = wi[i] > 0.0 ? i+1 : i-1;
+      select[i]    = 1;
+      select[pair] = 1;
+      kk          += 2;
+    } else {
+      if (kk + 1 > gcrodr->k_max) break;
+      select[i] = 1;
+      kk++;
+    }
+  }
+  if (!kk) PetscFunctionReturn(0);
+  PetscStackCallBLAS("LAPACKtgsen",LAPACKtgsen_(&ijob,&wantq,&wantz,select,&bN,gcrodr->GG,&bN,gcrodr->GW,&bN,wr,wi,beta,gcrodr->Q,&bN,Z,&bN,&m,NULL,NULL,NULL,gcrodr->work,&gcrodr->lwork,&iwork,&liwork,&info));
+  if (info) {
+    ierr = PetscInfo1(ksp,"Error in LAPACK routine XTGSEN %d, keeping the previous recycle space\n",(int)info);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  kk = m;
+#endif
+
+  /* the first kk columns P of Z span the selected harmonic Ritz vectors; U = Yhat P and C = W G P */
+  ierr = PetscBLASIntCast(kk,&bkk);CHKERRQ(ierr);
+  PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bN1,&bkk,&bN,&one,G,&bN1,Z,&bN,&zero,GP,&bN1));
+  for (j=0; j<k; j++) yhat[j]   = gcrodr->U[j];
+  for (j=0; j<p; j++) yhat[k+j] = VEC_VV(j);
+  for (j=0; j<kk; j++) {
+    ierr = VecSet(gcrodr->Unew[j],0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(gcrodr->Unew[j],N,Z+j*N,yhat);CHKERRQ(ierr);
+    ierr = VecSet(gcrodr->Cnew[j],0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(gcrodr->Cnew[j],N+1,GP+j*(N+1),ortho);CHKERRQ(ierr);
+  }
+  ierr = KSPGCRODROrthonormalize(ksp,&kk,gcrodr->Unew,gcrodr->Cnew);CHKERRQ(ierr);
+
+  t = gcrodr->U; gcrodr->U = gcrodr->Unew; gcrodr->Unew = t;
+  t = gcrodr->C; gcrodr->C = gcrodr->Cnew; gcrodr->Cnew = t;
+  gcrodr->k = kk;
+  PetscFunctionReturn(0);
+}
+
+/*
+    Runs one cycle of GCRODR. On entry VEC_VV(0) holds the initial residual; the part in the range of C is
+    removed here and restored in the solution by KSPGCRODRBuildSoln().
+*/
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRCycle"
+static PetscErrorCode KSPGCRODRCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)(ksp->data);
+  PetscReal      res_norm,res,hapbnd,tt,rnrm,anrm;
+  PetscErrorCode ierr;
+  PetscInt       it = 0,j,k = gcrodr->k,max_k = gcrodr->max_k - gcrodr->k;
+  PetscBool      hapend = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  if (itcount) *itcount = 0;
+  gcrodr->it = -1;
+  if (k) {
+    ierr = VecMDotAndNorm(VEC_VV(0),k,gcrodr->C,gcrodr->alpha,&rnrm);CHKERRQ(ierr);
+    anrm = 0.0;
+    for (j=0; j<k; j++) {
+      anrm            += PetscRealPart(gcrodr->alpha[j] * PetscConj(gcrodr->alpha[j]));
+      gcrodr->alpha[j] = -gcrodr->alpha[j];
+    }
+    ierr = VecMAXPY(VEC_VV(0),k,gcrodr->alpha,gcrodr->C);CHKERRQ(ierr);
+    for (j=0; j<k; j++) gcrodr->alpha[j] = -gcrodr->alpha[j];
+    tt = rnrm*rnrm - anrm;
+    if (tt > GCRODR_NORM_CANCEL*rnrm*rnrm) {
+      ierr = PetscObjectComposedDataSetReal((PetscObject)VEC_VV(0),NormIds[NORM_2],PetscSqrtReal(tt));CHKERRQ(ierr);
+    }
+    for (j=0; j<k; j++) gcrodr->ortho[j] = gcrodr->C[j];
+  }
+  ierr    = VecNormalize(VEC_VV(0),&res_norm);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,res_norm);
+  res     = res_norm;
+  *GRS(0) = res_norm;
+
+  /* check for the convergence */
+  ierr       = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = res;
+  ierr       = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    ierr        = KSPGCRODRBuildSoln(GRS(0),ksp->vec_sol,ksp->vec_sol,ksp,-1);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+  while (!ksp->reason && it < max_k && ksp->its < ksp->max_it) {
+    if (it) {
+      ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+    }
+    gcrodr->it = (it - 1);
+    if (gcrodr->vv_allocated <= it + VEC_OFFSET + 1) {
+      ierr = KSPGMRESGetNewVectors(ksp,it+1);CHKERRQ(ierr);
+    }
+    ierr = KSP_PCApplyBAorAB(ksp,VEC_VV(it),VEC_VV(1+it),VEC_TEMP_MATOP);CHKERRQ(ierr);
+
+    /* update hessenberg matrix and do Gram-Schmidt against C and the Krylov vectors */
+    ierr = KSPGCRODROrthogonalize(ksp,it);CHKERRQ(ierr);
+    if (ksp->reason) break;
+
+    ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    *HH(it+1,it)  = tt;
+    *HES(it+1,it) = tt;
+
+    /* check for the happy breakdown */
+    hapbnd = PetscAbsScalar(tt / *GRS(it));
+    if (hapbnd > gcrodr->haptol) hapbnd = gcrodr->haptol;
+    if (tt < hapbnd) {
+      ierr   = PetscInfo2(ksp,"Detected happy breakdown, current hapbnd = %14.12e tt = %14.12e\n",(double)hapbnd,(double)tt);CHKERRQ(ierr);
+      hapend = PETSC_TRUE;
+    }
+    ierr = KSPGCRODRUpdateHessenberg(ksp,it,hapend,&res);CHKERRQ(ierr);
+
+    it++;
+    gcrodr->it = (it-1);
+    ksp->its++;
+    ksp->rnorm = res;
+    if (ksp->reason) break;
+
+    ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+    if (hapend) {
+      if (!ksp->reason) {
+        if (ksp->errorifnotconverged) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"You reached the happy break down, but convergence was not indicated. Residual norm = %g",(double)res);
+        else {
+          ksp->reason = KSP_DIVERGED_BREAKDOWN;
+          break;
+        }
+      }
+    }
+  }
+
+  /* Monitor if we know that we will not return for a restart */
+  if (it && (ksp->reason || ksp->its >= ksp->max_it)) {
+    ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+    ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  }
+  if (itcount) *itcount = it;
+
+  ierr = KSPGCRODRBuildSoln(GRS(0),ksp->vec_sol,ksp->vec_sol,ksp,it-1);CHKERRQ(ierr);
+  if (gcrodr->k_max && it && ksp->reason >= 0) {
+    ierr = KSPGCRODRUpdateRecycleSpace(ksp,it);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSolve_GCRODR"
+PetscErrorCode KSPSolve_GCRODR(KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscInt       its,itcount;
+  KSP_GCRODR     *gcrodr    = (KSP_GCRODR*)ksp->data;
+  PetscBool      guess_zero = ksp->guess_zero;
+
+  PetscFunctionBegin;
+  if (ksp->calc_sings && !gcrodr->Rsvd) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ORDER,"Must call KSPSetComputeSingularValues() before KSPSetUp() is called");
+
+  ierr     = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr     = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+  ierr = KSPGCRODRCheckOperators(ksp);CHKERRQ(ierr);
+  itcount     = 0;
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    ierr     = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    ierr     = KSPGCRODRCycle(&its,ksp);CHKERRQ(ierr);
+    itcount += its;
+    if (itcount >= ksp->max_it) {
+      if (!ksp->reason) ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    ksp->guess_zero = PETSC_FALSE; /* every future call to KSPInitialResidual() will have nonzero guess */
+  }
+  ksp->guess_zero = guess_zero; /* restore if user provided nonzero initial guess */
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_GCRODR"
+PetscErrorCode KSPReset_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDestroyVecs(gcrodr->k_max,&gcrodr->U);CHKERRQ(ierr);
+  ierr = VecDestroyVecs(gcrodr->k_max,&gcrodr->C);CHKERRQ(ierr);
+  ierr = VecDestroyVecs(gcrodr->k_max,&gcrodr->Unew);CHKERRQ(ierr);
+  ierr = VecDestroyVecs(gcrodr->k_max,&gcrodr->Cnew);CHKERRQ(ierr);
+  ierr = PetscFree5(gcrodr->ortho,gcrodr->yhat,gcrodr->bk,gcrodr->alpha,gcrodr->ucoef);CHKERRQ(ierr);
+  ierr = PetscFree7(gcrodr->G,gcrodr->WY,gcrodr->GG,gcrodr->GW,gcrodr->Q,gcrodr->Z,gcrodr->GP);CHKERRQ(ierr);
+  ierr = PetscFree7(gcrodr->work,gcrodr->wr,gcrodr->wi,gcrodr->beta,gcrodr->modul,gcrodr->perm,gcrodr->select);CHKERRQ(ierr);
+  gcrodr->k = 0;
+  ierr = KSPReset_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_GCRODR"
+PetscErrorCode KSPDestroy_GCRODR(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+  ierr = PetscFree(ksp->data);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetRestart_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetRestart_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetHapTol_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetCGSRefinementType_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetCGSRefinementType_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRecycle_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRGetRecycle_C",NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPGCRODRBuildSoln - create the solution from the starting vector and the current iterates,
+    the correction is V nrs + U (alpha - B nrs). As KSPGMRESBuildSoln(), but it < 0 still adds U alpha.
+ */
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRBuildSoln"
+static PetscErrorCode KSPGCRODRBuildSoln(PetscScalar *nrs,Vec vs,Vec vdest,KSP ksp,PetscInt it)
+{
+  PetscScalar    tt;
+  PetscErrorCode ierr;
+  PetscInt       ii,k,j;
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)(ksp->data);
+
+  PetscFunctionBegin;
+  if (it < 0 && !gcrodr->k) {
+    ierr = VecCopy(vs,vdest);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (it >= 0) {
+    if (*HH(it,it) != 0.0) {
+      nrs[it] = *GRS(it) / *HH(it,it);
+    } else {
+      ksp->reason = KSP_DIVERGED_BREAKDOWN;
+
+      ierr = PetscInfo2(ksp,"Likely your matrix or preconditioner is singular. HH(it,it) is identically zero; it = %D GRS(it) = %g\n",it,(double)PetscAbsScalar(*GRS(it)));CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+    for (ii=1; ii<=it; ii++) {
+      k  = it - ii;
+      tt = *GRS(k);
+      for (j=k+1; j<=it; j++) tt = tt - *HH(k,j) * nrs[j];
+      if (*HH(k,k) == 0.0) {
+        ksp->reason = KSP_DIVERGED_BREAKDOWN;
+
+        ierr = PetscInfo1(ksp,"Likely your matrix or preconditioner is singular. HH(k,k) is identically zero; k = %D\n",k);CHKERRQ(ierr);
+        PetscFunctionReturn(0);
+      }
+      nrs[k] = tt / *HH(k,k);
+    }
+  }
+
+  /* Accumulate the correction to the solution of the preconditioned problem in TEMP */
+  ierr = VecSet(VEC_TEMP,0.0);CHKERRQ(ierr);
+  if (it >= 0) {
+    ierr = VecMAXPY(VEC_TEMP,it+1,nrs,&VEC_VV(0));CHKERRQ(ierr);
+  }
+  if (gcrodr->k) {
+    for (k=0; k<gcrodr->k; k++) {
+      gcrodr->ucoef[k] = gcrodr->alpha[k];
+      for (j=0; j<=it; j++) gcrodr->ucoef[k] -= *BK(k,j) * nrs[j];
+    }
+    ierr = VecMAXPY(VEC_TEMP,gcrodr->k,gcrodr->ucoef,gcrodr->U);CHKERRQ(ierr);
+  }
+
+  ierr = KSPUnwindPreconditioner(ksp,VEC_TEMP,VEC_TEMP_MATOP);CHKERRQ(ierr);
+  /* add solution to previous solution */
+  if (vdest != vs) {
+    ierr = VecCopy(vs,vdest);CHKERRQ(ierr);
+  }
+  ierr = VecAXPY(vdest,1.0,VEC_TEMP);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Do the scalar work for the orthogonalization.  Return new residual norm.
+ */
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRUpdateHessenberg"
+static PetscErrorCode KSPGCRODRUpdateHessenberg(KSP ksp,PetscInt it,PetscBool hapend,PetscReal *res)
+{
+  PetscScalar *hh,*cc,*ss,tt;
+  PetscInt    j;
+  KSP_GCRODR  *gcrodr = (KSP_GCRODR*)(ksp->data);
+
+  PetscFunctionBegin;
+  hh = HH(0,it);
+  cc = CC(0);
+  ss = SS(0);
+
+  /* Apply all the previously computed plane rotations to the new column
+     of the Hessenberg matrix */
+  for (j=1; j<=it; j++) {
+    tt  = *hh;
+    *hh = PetscConj(*cc) * tt + *ss * *(hh+1);
+    hh++;
+    *hh = *cc++ * *hh - (*ss++ * tt);
+  }
+
+  /*
+    compute the new plane rotation, and apply it to:
+     1) the right-hand-side of the Hessenberg system
+     2) the new column of the Hessenberg matrix
+    thus obtaining the updated value of the residual
+  */
+  if (!hapend) {
+    tt = PetscSqrtScalar(PetscConj(*hh) * *hh + PetscConj(*(hh+1)) * *(hh+1));
+    if (tt == 0.0) {
+      ksp->reason = KSP_DIVERGED_NULL;
+      PetscFunctionReturn(0);
+    }
+    *cc        = *hh / tt;
+    *ss        = *(hh+1) / tt;
+    *GRS(it+1) = -(*ss * *GRS(it));
+    *GRS(it)   = PetscConj(*cc) * *GRS(it);
+    *hh        = PetscConj(*cc) * *hh + *ss * *(hh+1);
+    *res       = PetscAbsScalar(*GRS(it+1));
+  } else {
+    /* happy breakdown: HH(it+1, it) = 0, the residual is zero */
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBuildSolution_GCRODR"
+PetscErrorCode KSPBuildSolution_GCRODR(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!gcrodr->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&gcrodr->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)gcrodr->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = gcrodr->sol_temp;
+  }
+  if (!gcrodr->nrs) {
+    /* allocate the work area */
+    ierr = PetscMalloc1(gcrodr->max_k,&gcrodr->nrs);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,gcrodr->max_k*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  ierr = KSPGCRODRBuildSoln(gcrodr->nrs,ksp->vec_sol,ptr,ksp,gcrodr->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_GCRODR"
+PetscErrorCode KSPView_GCRODR(KSP ksp,PetscViewer viewer)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = KSPView_GMRES(ksp,viewer);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  GCRODR: recycle space dimension=%D, current dimension=%D\n",gcrodr->k_max,gcrodr->k);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  GCRODR: recycle space recomputed for new operators %D times\n",gcrodr->ncompute);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetFromOptions_GCRODR"
+PetscErrorCode KSPSetFromOptions_GCRODR(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscInt       k;
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscBool      flg;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_GMRES(PetscOptionsObject,ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP GCRODR Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_gcrodr_recycle","Dimension of the recycle space kept between cycles and solves","KSPGCRODRSetRecycle",gcrodr->k_max,&k,&flg);CHKERRQ(ierr);
+  if (flg) { ierr = KSPGCRODRSetRecycle(ksp,k);CHKERRQ(ierr); }
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPGMRESSetRestart_GCRODR"
+static PetscErrorCode KSPGMRESSetRestart_GCRODR(KSP ksp,PetscInt max_k)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (max_k < 1) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Restart must be positive");
+  if (!ksp->setupstage) {
+    gcrodr->max_k = max_k;
+  } else if (gcrodr->max_k != max_k) {
+    /* free the data structures, then create them again */
+    ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+    gcrodr->max_k   = max_k;
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRSetRecycle_GCRODR"
+static PetscErrorCode KSPGCRODRSetRecycle_GCRODR(KSP ksp,PetscInt k_max)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k_max < 0) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Dimension of the recycle space must be nonnegative");
+  if (!ksp->setupstage) {
+    gcrodr->k_max = k_max;
+  } else if (gcrodr->k_max != k_max) {
+    /* the recycle space is discarded */
+    ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+    gcrodr->k_max   = k_max;
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRGetRecycle_GCRODR"
+static PetscErrorCode KSPGCRODRGetRecycle_GCRODR(KSP ksp,PetscInt *k_max)
+{
+  PetscFunctionBegin;
+  *k_max = ((KSP_GCRODR*)ksp->data)->k_max;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRSetRecycle"
+/*@
+   KSPGCRODRSetRecycle - Sets the dimension of the recycle space of GCRODR, the harmonic Ritz vectors that are
+   deflated in each cycle and kept for the next solve.
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  k - the dimension of the recycle space, less than the restart
+
+   Options Database:
+.  -ksp_gcrodr_recycle <k>
+
+   Notes: Each cycle takes restart - k Arnoldi steps. Changing k after the KSP is set up discards the recycle space.
+   Use 0 to get (restarted) GMRES.
+
+   Level: intermediate
+
+.keywords: KSP, GCRODR, recycling, deflation
+
+.seealso: KSPGCRODR, KSPGCRODRGetRecycle(), KSPGMRESSetRestart()
+@*/
+PetscErrorCode KSPGCRODRSetRecycle(KSP ksp,PetscInt k)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,k,2);
+  ierr = PetscTryMethod(ksp,"KSPGCRODRSetRecycle_C",(KSP,PetscInt),(ksp,k));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPGCRODRGetRecycle"
+/*@
+   KSPGCRODRGetRecycle - Gets the dimension of the recycle space of GCRODR.
+
+   Not Collective
+
+   Input Parameter:
+.  ksp - the Krylov space context
+
+   Output Parameter:
+.  k - the dimension of the recycle space
+
+   Level: intermediate
+
+.keywords: KSP, GCRODR, recycling, deflation
+
+.seealso: KSPGCRODR, KSPGCRODRSetRecycle()
+@*/
+PetscErrorCode KSPGCRODRGetRecycle(KSP ksp,PetscInt *k)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidIntPointer(k,2);
+  ierr = PetscUseMethod(ksp,"KSPGCRODRGetRecycle_C",(KSP,PetscInt*),(ksp,k));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPGCRODR - GMRES with deflated restarting and recycling of the deflation space between linear solves.
+
+   Options Database Keys:
++   -ksp_gmres_restart <restart> - the size of the approximation space, Krylov directions plus recycle space
+.   -ksp_gmres_haptol <tol> - sets the tolerance for "happy ending" (exact convergence)
+.   -ksp_gmres_preallocate - preallocate all the Krylov search directions initially (otherwise groups of
+                             vectors are allocated as needed)
+.   -ksp_gmres_cgs_refinement_type <never,ifneeded,always> - determine if iterative refinement is used to increase the
+                                   stability of the classical Gram-Schmidt orthogonalization
+-   -ksp_gcrodr_recycle <k> - dimension of the recycle space (default 10)
+
+   Notes: Each cycle projects the residual out of the range of the recycle space and runs restart - k Arnoldi
+   steps with the projected operator; the new direction is orthogonalized against the recycle space and the
+   Krylov vectors with one block inner product (classical Gram-Schmidt). At the end of the cycle the recycle
+   space is replaced by the k harmonic Ritz vectors of smallest magnitude from the recycle space and the Krylov
+   space.
+
+   The recycle space is kept between calls to KSPSolve(), also after KSPSetOperators() with new matrices of the
+   same size: its image under the new operator is then recomputed, k applications of the operator and the
+   preconditioner, so sequences of linear systems whose matrices change slowly, such as in implicit time
+   stepping, start with the slow modes of the previous systems deflated. KSPReset() discards it.
+
+   Supports left and right preconditioning, but not symmetric. Not available for complex numbers.
+
+   References:
+.   1. - M. Parks, E. de Sturler, G. Mackey, D. Johnson and S. Maiti, Recycling Krylov subspaces for sequences
+    of linear systems, SIAM Journal on Scientific Computing, 28 (2006).
+
+   Level: intermediate
+
+   Developer Notes: This object is subclassed off of KSPGMRES
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPLGMRES, KSPDGMRES,
+           KSPGCRODRSetRecycle(), KSPGCRODRGetRecycle(), KSPGMRESSetRestart(), KSPGMRESSetCGSRefinementType()
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_GCRODR"
+PETSC_EXTERN PetscErrorCode KSPCreate_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr      = PetscNewLog(ksp,&gcrodr);CHKERRQ(ierr);
+  ksp->data = (void*)gcrodr;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,2);CHKERRQ(ierr);
+
+  ksp->ops->buildsolution                = KSPBuildSolution_GCRODR;
+  ksp->ops->setup                        = KSPSetUp_GCRODR;
+  ksp->ops->solve                        = KSPSolve_GCRODR;
+  ksp->ops->reset                        = KSPReset_GCRODR;
+  ksp->ops->destroy                      = KSPDestroy_GCRODR;
+  ksp->ops->view                         = KSPView_GCRODR;
+  ksp->ops->setfromoptions               = KSPSetFromOptions_GCRODR;
+  ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_GMRES;
+  ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_GMRES;
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",KSPGMRESSetPreAllocateVectors_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetRestart_C",KSPGMRESSetRestart_GCRODR);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetRestart_C",KSPGMRESGetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetHapTol_C",KSPGMRESSetHapTol_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetCGSRefinementType_C",KSPGMRESSetCGSRefinementType_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetCGSRefinementType_C",KSPGMRESGetCGSRefinementType_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRecycle_C",KSPGCRODRSetRecycle_GCRODR);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRGetRecycle_C",KSPGCRODRGetRecycle_GCRODR);CHKERRQ(ierr);
+
+  gcrodr->haptol         = 1.0e-30;
+  gcrodr->q_preallocate  = 0;
+  gcrodr->delta_allocate = GCRODR_DELTA_DIRECTIONS;
+  gcrodr->orthog         = KSPGMRESClassicalGramSchmidtOrthogonalization;
+  gcrodr->nrs            = 0;
+  gcrodr->sol_temp       = 0;
+  gcrodr->max_k          = GCRODR_DEFAULT_MAXK;
+  gcrodr->Rsvd           = 0;
+  gcrodr->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
+  gcrodr->orthogwork     = 0;
+  gcrodr->k_max          = GCRODR_DEFAULT_RECYCLE;
+  PetscFunctionReturn(0);
+}
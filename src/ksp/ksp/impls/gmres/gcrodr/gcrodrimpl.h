@@ -0,0 +1,51 @@
+/*
+   Private data structure used by the GCRODR method.
+*/
+
+#if !defined(__GCRODR)
+#define __GCRODR
+
+#define KSPGMRES_NO_MACROS
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>
+#include <petscblaslapack.h>
+
+typedef struct {
+  KSPGMRESHEADER
+
+  /* the recycle space, kept from solve to solve */
+  PetscInt         k_max;      /* maximum dimension of the recycle space */
+  PetscInt         k;          /* current dimension of the recycle space */
+  Vec              *U;         /* basis of the recycle space */
+  Vec              *C;         /* C = Op U with orthonormal columns, Op = B^{-1}A (left) or AB^{-1} (right preconditioning) */
+  Vec              *Unew,*Cnew; /* the next recycle space, built from the harmonic Ritz vectors of the last cycle */
+  PetscObjectId    Aid,Pid;    /* the operators C was computed with */
+  PetscObjectState Astate,Pstate;
+  PetscInt         ncompute;   /* number of times C was recomputed for new operators */
+
+  Vec              *ortho;     /* C followed by the Krylov vectors, so the new direction is orthogonalized against both with one VecMDot() */
+  Vec              *yhat;      /* U followed by the Krylov vectors */
+  PetscScalar      *bk;        /* C^H Op V, the coupling of the Krylov vectors to C */
+  PetscScalar      *alpha;     /* C^H r, the part of the initial residual of the cycle in the range of C */
+  PetscScalar      *ucoef;     /* coefficients of U in the correction of the cycle */
+
+  /* work space for the generalized eigenvalue problem of the harmonic Ritz vectors */
+  PetscScalar      *G,*WY,*GG,*GW,*Q,*Z,*GP,*work;
+  PetscReal        *wr,*wi,*beta,*modul;
+  PetscInt         *perm;
+  PetscBLASInt     *select,lwork;
+} KSP_GCRODR;
+
+#define HH(a,b)  (gcrodr->hh_origin + (b)*(gcrodr->max_k+2)+(a))
+#define HES(a,b) (gcrodr->hes_origin + (b)*(gcrodr->max_k+1)+(a))
+#define CC(a)    (gcrodr->cc_origin + (a))
+#define SS(a)    (gcrodr->ss_origin + (a))
+#define GRS(a)   (gcrodr->rs_origin + (a))
+#define BK(a,b)  (gcrodr->bk + (b)*gcrodr->k_max+(a))
+
+/* vector names */
+#define VEC_OFFSET     2
+#define VEC_TEMP       gcrodr->vecs[0]
+#define VEC_TEMP_MATOP gcrodr->vecs[1]
+#define VEC_VV(i)      gcrodr->vecs[VEC_OFFSET+i]
+
+#endif
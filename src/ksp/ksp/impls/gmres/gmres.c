@@ -156,11 +156,17 @@ PetscErrorCode KSPGMRESCycle(PetscInt *itcount,KSP ksp)
     ierr = KSP_PCApplyBAorAB(ksp,VEC_VV(it),VEC_VV(1+it),VEC_TEMP_MATOP);CHKERRQ(ierr);
 
     /* update hessenberg matrix and do Gram-Schmidt */
+    gmres->orthognorm = -1.0;
     ierr = (*gmres->orthog)(ksp,it);CHKERRQ(ierr);
     if (ksp->reason) break;
 
     /* vv(i+1) . vv(i+1) */
-    ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    if (gmres->orthognorm >= 0.0) {
+      tt   = gmres->orthognorm;
+      ierr = VecScale(VEC_VV(it+1),1.0/tt);CHKERRQ(ierr);
+    } else {
+      ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    }
 
     /* save the magnitude */
     *HH(it+1,it)  = tt;
@@ -608,6 +614,8 @@ PetscErrorCode KSPSetFromOptions_GMRES(PetscOptionItems *PetscOptionsObject,KSP
   if (flg) {ierr = KSPGMRESSetOrthogonalization(ksp,KSPGMRESModifiedGramSchmidtOrthogonalization);CHKERRQ(ierr);}
   ierr = PetscOptionsEnum("-ksp_gmres_cgs_refinement_type","Type of iterative refinement for classical (unmodified) Gram-Schmidt","KSPGMRESSetCGSRefinementType",
                           KSPGMRESCGSRefinementTypes,(PetscEnum)gmres->cgstype,(PetscEnum*)&gmres->cgstype,&flg);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-ksp_gmres_cgs_norm_estimate","Estimate the norm of the new direction from the classical Gram-Schmidt inner products","KSPGMRESClassicalGramSchmidtOrthogonalization",
+                          gmres->cgsnorm,&gmres->cgsnorm,NULL);CHKERRQ(ierr);
   flg  = PETSC_FALSE;
   ierr = PetscOptionsBool("-ksp_gmres_krylov_monitor","Plot the Krylov directions","KSPMonitorSet",flg,&flg,NULL);CHKERRQ(ierr);
   if (flg) {
@@ -896,6 +904,8 @@ PetscErrorCode  KSPGMRESSetHapTol(KSP ksp,PetscReal tol)
 .   -ksp_gmres_modifiedgramschmidt - use modified Gram-Schmidt in the orthogonalization (more stable, but slower)
 .   -ksp_gmres_cgs_refinement_type <never,ifneeded,always> - determine if iterative refinement is used to increase the
                                    stability of the classical Gram-Schmidt  orthogonalization.
+.   -ksp_gmres_cgs_norm_estimate - estimate the norm of the new direction from the classical Gram-Schmidt inner products
+                                   saving one reduction per iteration, see KSPGMRESClassicalGramSchmidtOrthogonalization()
 -   -ksp_gmres_krylov_monitor - plot the Krylov space generated
 
    Level: beginner
@@ -931,6 +941,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_GMRES(KSP ksp)
   ksp->ops->buildsolution                = KSPBuildSolution_GMRES;
   ksp->ops->setup                        = KSPSetUp_GMRES;
   ksp->ops->solve                        = KSPSolve_GMRES;
+  ksp->ops->matsolve                     = KSPMatSolve_GMRES;
   ksp->ops->reset                        = KSPReset_GMRES;
   ksp->ops->destroy                      = KSPDestroy_GMRES;
   ksp->ops->view                         = KSPView_GMRES;
@@ -0,0 +1,270 @@
+
+/*
+    Block GMRES for several right hand sides, used by KSPMatSolve() with KSPGMRES.
+
+    Each cycle builds a block Krylov basis V_0, V_1, ... from the block of residuals with block classical Gram-Schmidt
+  (twice) and Cholesky QR; all the right hand sides share the basis and the minimal residual problem of each is
+  solved with the same block Hessenberg matrix, reduced to triangular form with Givens rotations as it is built.
+  Columns of the initial residual block that are numerically dependent are dropped when the cycle starts, and a
+  cycle ends early when a new block of the basis loses rank.
+
+    Reference: Y. Saad, Iterative Methods for Sparse Linear Systems, second edition, section 6.12.
+*/
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>       /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockGMRESNorms"
+/*
+   2-norms of the columns of R
+*/
+static PetscErrorCode KSPBlockGMRESNorms(Mat R,PetscScalar *lbuf,PetscScalar *gbuf,PetscReal *nrm)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *r;
+  PetscInt       n,k,i,j;
+
+  PetscFunctionBegin;
+  ierr = MatGetLocalSize(R,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(R,NULL,&k);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(R,&r);CHKERRQ(ierr);
+  for (j=0; j<k; j++) {
+    lbuf[j] = 0.0;
+    for (i=0; i<n; i++) lbuf[j] += PetscConj(r[i+j*n])*r[i+j*n];
+  }
+  ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+  ierr = MPIU_Allreduce(lbuf,gbuf,k,MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)R));CHKERRQ(ierr);
+  for (j=0; j<k; j++) nrm[j] = PetscSqrtReal(PetscAbsScalar(gbuf[j]));
+  ierr = PetscLogFlops(2.0*n*k);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatSolve_GMRES"
+PetscErrorCode KSPMatSolve_GMRES(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode ierr;
+  KSP_GMRES      *gmres = (KSP_GMRES*)ksp->data;
+  MPI_Comm       comm;
+  Mat            R,S,AX = NULL,AV = NULL,T = NULL,*V;
+  PetscScalar    *H,*G,*Y,*cs,*sn,*lbuf,*gbuf,*Rb,*v,*w,*x,*hc,a,b,tt,one = 1.0,mone = -1.0,zero = 0.0;
+  PetscReal      *ref,*nrm,*scl,t,wnrm;
+  PetscInt       m = gmres->max_k,n,N,k,p,pv = 0,i,j,l,q,c,it,nc,nb,bottom,rr,nrot,*rrow,ldh,pass;
+  PetscBool      first = PETSC_TRUE,left = (PetscBool)(ksp->pc_side == PC_LEFT);
+  PetscBLASInt   bn,bk,bp,bnb,bnc,bldh,bld;
+
+  PetscFunctionBegin;
+  if (ksp->pc_side == PC_SYMMETRIC) {
+    ierr = KSPMatSolveColumns(ksp,B,X);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscObjectGetComm((PetscObject)ksp,&comm);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(B,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,&N,&k);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(n,1),&bld);CHKERRQ(ierr);
+  ldh  = (m+1)*k;
+  ierr = PetscBLASIntCast(ldh,&bldh);CHKERRQ(ierr);
+  ierr = PetscMalloc5(ldh*m*k,&H,ldh*k,&G,m*k*k,&Y,2*m*k*k,&cs,2*m*k*k,&sn);CHKERRQ(ierr);
+  ierr = PetscMalloc4(ldh*k+k,&lbuf,ldh*k+k,&gbuf,k*k,&Rb,2*m*k*k,&rrow);CHKERRQ(ierr);
+  ierr = PetscMalloc3(k,&ref,k,&nrm,k,&scl);CHKERRQ(ierr);
+  ierr = PetscCalloc1(m+1,&V);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&R);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&S);CHKERRQ(ierr);
+  if (ksp->guess_zero) {ierr = MatZeroEntries(X);CHKERRQ(ierr);}
+
+  while (1) {
+    /* residual of the current iterate, preconditioned from the left */
+    ierr = MatCopy(B,S,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    if (!first || !ksp->guess_zero) {
+      ierr = KSPBlockMatMult(ksp,X,&AX);CHKERRQ(ierr);
+      ierr = MatAXPY(S,-1.0,AX,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    }
+    if (left) {
+      ierr = KSPBlockPCApply(ksp,S,R);CHKERRQ(ierr);
+    } else {
+      ierr = MatCopy(S,R,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    }
+    ierr = KSPBlockGMRESNorms(R,lbuf,gbuf,nrm);CHKERRQ(ierr);
+    if (first) {
+      ierr = PetscMemcpy(ref,nrm,k*sizeof(PetscReal));CHKERRQ(ierr);
+      for (j=0; j<k; j++) scl[j] = ref[j] > 0.0 ? 1.0/ref[j] : 1.0;
+      first = PETSC_FALSE;
+    }
+    ierr = KSPBlockConverged(ksp,k,nrm,ref);CHKERRQ(ierr);
+    if (ksp->reason) break;
+
+    /* first block of the basis, R = V_0 Rb, without the columns that are dependent */
+    ierr = KSPBlockOrthogonalize(R,k,scl,0.0,&p,Rb,k);CHKERRQ(ierr);
+    if (!p) {
+      ksp->reason = KSP_DIVERGED_BREAKDOWN;
+      break;
+    }
+    if (p != pv) {
+      for (i=0; i<=m; i++) {
+        ierr = MatDestroy(&V[i]);CHKERRQ(ierr);
+        ierr = MatCreateDense(comm,n,PETSC_DECIDE,N,p,NULL,&V[i]);CHKERRQ(ierr);
+        ierr = MatAssemblyBegin(V[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+        ierr = MatAssemblyEnd(V[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+      }
+      ierr = MatDestroy(&AV);CHKERRQ(ierr);
+      ierr = MatDestroy(&T);CHKERRQ(ierr);
+      pv   = p;
+    }
+    ierr = PetscBLASIntCast(p,&bp);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(R,&w);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(V[0],&v);CHKERRQ(ierr);
+    ierr = PetscMemcpy(v,w,n*p*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(V[0],&v);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(R,&w);CHKERRQ(ierr);
+    ierr = PetscMemzero(H,ldh*m*k*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr = PetscMemzero(G,ldh*k*sizeof(PetscScalar));CHKERRQ(ierr);
+    for (q=0; q<k; q++) {
+      for (i=0; i<p; i++) G[i+q*ldh] = Rb[i+q*k];
+    }
+    nrot = 0;
+
+    for (it=0; it<m; it++) {
+      /* V_{it+1} = Op V_it, with one sparse matrix - dense matrix product */
+      if (left) {
+        ierr = KSPBlockMatMult(ksp,V[it],&AV);CHKERRQ(ierr);
+        ierr = KSPBlockPCApply(ksp,AV,V[it+1]);CHKERRQ(ierr);
+      } else {
+        if (!T) {ierr = MatDuplicate(V[0],MAT_DO_NOT_COPY_VALUES,&T);CHKERRQ(ierr);}
+        ierr = KSPBlockPCApply(ksp,V[it],T);CHKERRQ(ierr);
+        ierr = KSPBlockMatMult(ksp,T,&AV);CHKERRQ(ierr);
+        ierr = MatCopy(AV,V[it+1],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      }
+
+      /* block classical Gram-Schmidt with one reorthogonalization; each pass is one reduction */
+      ierr = PetscLogEventBegin(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+      wnrm = 0.0;
+      for (pass=0; pass<2; pass++) {
+        nb   = (it+1)*p*p;
+        ierr = MatDenseGetArray(V[it+1],&w);CHKERRQ(ierr);
+        for (i=0; i<=it; i++) {
+          ierr = MatDenseGetArray(V[i],&v);CHKERRQ(ierr);
+          PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bp,&bp,&bn,&one,v,&bld,w,&bld,&zero,lbuf+i*p*p,&bp));
+          ierr = MatDenseRestoreArray(V[i],&v);CHKERRQ(ierr);
+        }
+        if (!pass) {
+          for (j=0; j<p; j++) {
+            lbuf[nb+j] = 0.0;
+            for (l=0; l<n; l++) lbuf[nb+j] += PetscConj(w[l+j*n])*w[l+j*n];
+          }
+          nb += p;
+        }
+        ierr = MPIU_Allreduce(lbuf,gbuf,nb,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+        if (!pass) {
+          for (j=0; j<p; j++) wnrm = PetscMax(wnrm,PetscAbsScalar(gbuf[(it+1)*p*p+j]));
+          wnrm = PetscSqrtReal(wnrm);
+        }
+        for (i=0; i<=it; i++) {
+          ierr = MatDenseGetArray(V[i],&v);CHKERRQ(ierr);
+          PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bn,&bp,&bp,&mone,v,&bld,gbuf+i*p*p,&bp,&one,w,&bld));
+          ierr = MatDenseRestoreArray(V[i],&v);CHKERRQ(ierr);
+          for (j=0; j<p; j++) {
+            for (l=0; l<p; l++) H[i*p+l+(it*p+j)*ldh] += gbuf[i*p*p+l+j*p];
+          }
+        }
+        ierr = MatDenseRestoreArray(V[it+1],&w);CHKERRQ(ierr);
+        ierr = PetscLogFlops(4.0*n*p*p*(it+1));CHKERRQ(ierr);
+      }
+      ierr = KSPBlockOrthogonalize(V[it+1],p,NULL,wnrm,&rr,Rb,p);CHKERRQ(ierr);
+      ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+      for (j=0; j<p; j++) {
+        for (l=0; l<p; l++) H[(it+1)*p+l+(it*p+j)*ldh] = Rb[l+j*p];
+      }
+
+      /* reduce the new block column to triangular form, applying the rotations to the right hand sides as well */
+      bottom = (it+2)*p-1;
+      for (j=0; j<p; j++) {
+        c  = it*p+j;
+        hc = H + c*ldh;
+        for (l=0; l<nrot; l++) {
+          i       = rrow[l];
+          tt      = hc[i-1];
+          hc[i-1] = PetscConj(cs[l])*tt + PetscConj(sn[l])*hc[i];
+          hc[i]   = cs[l]*hc[i] - sn[l]*tt;
+        }
+        for (i=bottom; i>c; i--) {
+          a = hc[i-1]; b = hc[i];
+          if (b == 0.0) continue;
+          t        = PetscSqrtReal(PetscRealPart(PetscConj(a)*a + PetscConj(b)*b));
+          cs[nrot] = a/t;
+          sn[nrot] = b/t;
+          hc[i-1]  = t;
+          hc[i]    = 0.0;
+          for (q=0; q<k; q++) {
+            tt             = G[i-1+q*ldh];
+            G[i-1+q*ldh]   = PetscConj(cs[nrot])*tt + PetscConj(sn[nrot])*G[i+q*ldh];
+            G[i+q*ldh]     = cs[nrot]*G[i+q*ldh] - sn[nrot]*tt;
+          }
+          rrow[nrot++] = i;
+        }
+      }
+
+      /* the residual norm of each right hand side is the norm of its part of G below the triangular block */
+      for (q=0; q<k; q++) {
+        t = 0.0;
+        for (i=(it+1)*p; i<=bottom; i++) t += PetscRealPart(PetscConj(G[i+q*ldh])*G[i+q*ldh]);
+        nrm[q] = PetscSqrtReal(t);
+      }
+      ksp->its++;
+      ierr = KSPBlockConverged(ksp,k,nrm,ref);CHKERRQ(ierr);
+      if (ksp->reason) {it++; break;}
+      if (rr < p) {
+        ierr = PetscInfo2(ksp,"Block %D of the basis has rank %D, restarting\n",it+1,rr);CHKERRQ(ierr);
+        it++;
+        break;
+      }
+    }
+
+    /* solve the triangular least squares problems and update the solutions */
+    nc = it*p;
+    for (c=0; c<nc; c++) {
+      if (H[c+c*ldh] == 0.0) {nc = c; break;}
+    }
+    if (nc) {
+      ierr = PetscBLASIntCast(nc,&bnc);CHKERRQ(ierr);
+      for (q=0; q<k; q++) {
+        for (i=0; i<nc; i++) Y[i+q*nc] = G[i+q*ldh];
+      }
+      PetscStackCallBLAS("BLAStrsm",BLAStrsm_("L","U","N","N",&bnc,&bk,&one,H,&bldh,Y,&bnc));
+      if (left) {
+        ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+      } else {
+        ierr = MatZeroEntries(S);CHKERRQ(ierr);
+        ierr = MatDenseGetArray(S,&x);CHKERRQ(ierr);
+      }
+      for (i=0; i*p<nc; i++) {
+        ierr = PetscBLASIntCast(PetscMin(p,nc-i*p),&bnb);CHKERRQ(ierr);
+        ierr = MatDenseGetArray(V[i],&v);CHKERRQ(ierr);
+        PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bn,&bk,&bnb,&one,v,&bld,Y+i*p,&bnc,&one,x,&bld));
+        ierr = MatDenseRestoreArray(V[i],&v);CHKERRQ(ierr);
+      }
+      ierr = PetscLogFlops(2.0*n*nc*k+1.0*nc*nc*k);CHKERRQ(ierr);
+      if (left) {
+        ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+      } else {
+        ierr = MatDenseRestoreArray(S,&x);CHKERRQ(ierr);
+        ierr = KSPBlockPCApply(ksp,S,R);CHKERRQ(ierr);
+        ierr = MatAXPY(X,1.0,R,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      }
+    }
+    if (ksp->reason) break;
+  }
+
+  for (i=0; i<=m; i++) {ierr = MatDestroy(&V[i]);CHKERRQ(ierr);}
+  ierr = PetscFree(V);CHKERRQ(ierr);
+  ierr = MatDestroy(&AX);CHKERRQ(ierr);
+  ierr = MatDestroy(&AV);CHKERRQ(ierr);
+  ierr = MatDestroy(&T);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = PetscFree5(H,G,Y,cs,sn);CHKERRQ(ierr);
+  ierr = PetscFree4(lbuf,gbuf,Rb,rrow);CHKERRQ(ierr);
+  ierr = PetscFree3(ref,nrm,scl);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
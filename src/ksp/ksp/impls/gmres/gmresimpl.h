@@ -30,6 +30,8 @@
                                                                         \
   PetscErrorCode (*orthog)(KSP,PetscInt);                    \
   KSPGMRESCGSRefinementType cgstype;                                    \
+  PetscBool cgsnorm;         /* classical Gram-Schmidt estimates the norm of the new direction */ \
+  PetscReal orthognorm;      /* that estimate, negative if the solver must compute the norm */ \
                                                                         \
   Vec      *vecs;                                        /* the work vectors */ \
   Vec      *vecb;                                        /* holds the last full basis vectors of the Krylov subspace to compute (harmonic) Ritz pairs */ \
@@ -61,6 +63,7 @@ PETSC_INTERN PetscErrorCode KSPComputeRitz_GMRES(KSP,PetscBool,PetscBool,PetscIn
 PETSC_INTERN PetscErrorCode KSPReset_GMRES(KSP);
 PETSC_INTERN PetscErrorCode KSPDestroy_GMRES(KSP);
 PETSC_INTERN PetscErrorCode KSPGMRESGetNewVectors(KSP,PetscInt);
+PETSC_INTERN PetscErrorCode KSPMatSolve_GMRES(KSP,Mat,Mat);
 
 typedef PetscErrorCode (*FCN)(KSP,PetscInt); /* force argument to next function to not be extern C*/
 
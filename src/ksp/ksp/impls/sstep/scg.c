@@ -0,0 +1,384 @@
+
+/*
+    This file implements s-step (communication avoiding) conjugate gradients: each outer step builds s+1 basis
+  vectors from the search direction and s from the residual, computes their Gram matrix in a single reduction and
+  then performs s iterations of preconditioned CG on the coordinates in this basis.
+*/
+#include <../src/ksp/ksp/impls/sstep/sstepimpl.h>       /*I  "petscksp.h"  I*/
+
+typedef struct {
+  KSPSSTEPHEADER
+  PetscBool   nopc;         /* without preconditioner the r-space and z-space vectors are the same */
+  Vec         *Y;           /* 2s+1 basis vectors in z-space, s+1 from the search direction then s from the residual,
+                               followed by the search direction and the preconditioned residual between outer steps */
+  Vec         *Yt;          /* the same in r-space, M Y; equal to Y without preconditioner */
+  PetscScalar *G;           /* Gram matrix Yt^H Y, (2s+1) x (2s+1) */
+  PetscScalar *Gn;          /* Gram matrix Y^H Y or Yt^H Yt for the residual norm */
+  PetscScalar *xc,*rc,*pc,*bp,*tc; /* coordinates */
+  PetscReal   *alpha,*beta; /* coefficients of the first iterations, for the Ritz values */
+  PetscInt    nlanczos;
+} KSP_SCG;
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_SCG"
+static PetscErrorCode KSPSetUp_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscInt       n = 2*scg->s+1;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!scg->Y) {
+    ierr = PetscObjectTypeCompare((PetscObject)ksp->pc,PCNONE,&scg->nopc);CHKERRQ(ierr);
+    ierr = KSPCreateVecs(ksp,n+2,&scg->Y,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,n+2,scg->Y);CHKERRQ(ierr);
+    if (scg->nopc) scg->Yt = scg->Y;
+    else {
+      ierr = KSPCreateVecs(ksp,n+2,&scg->Yt,0,NULL);CHKERRQ(ierr);
+      ierr = PetscLogObjectParents(ksp,n+2,scg->Yt);CHKERRQ(ierr);
+    }
+    ierr = PetscMalloc7(n*n,&scg->G,n*n,&scg->Gn,n,&scg->xc,n,&scg->rc,n,&scg->pc,n,&scg->bp,n*n,&scg->tc);CHKERRQ(ierr);
+    ierr = PetscMalloc2(scg->s,&scg->alpha,scg->s,&scg->beta);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,(3*n*n+4*n)*sizeof(PetscScalar)+2*scg->s*sizeof(PetscReal));CHKERRQ(ierr);
+  }
+  ierr = KSPSetUp_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* u^H G v for the Gram matrices of size n */
+PETSC_STATIC_INLINE PetscScalar KSPSCGQuad(PetscInt n,const PetscScalar *G,const PetscScalar *u,const PetscScalar *v)
+{
+  PetscInt    i,l;
+  PetscScalar sum = 0.0,t;
+
+  for (i=0; i<n; i++) {
+    t = 0.0;
+    for (l=0; l<n; l++) t += G[i+l*n]*v[l];
+    sum += PetscConj(u[i])*t;
+  }
+  return sum;
+}
+
+/*
+   KSPSCGApplyB - The coordinates of A Y c in the basis Yt, for coordinates c that vanish on the last vector of each chain
+*/
+static void KSPSCGApplyB(KSP_SCG *scg,PetscInt sb,const PetscScalar *c,PetscScalar *bc)
+{
+  PetscInt i,off,len,n = 2*sb+1;
+
+  for (i=0; i<n; i++) bc[i] = 0.0;
+  for (off=0,len=sb; off<n; off+=len+1,len--) {
+    for (i=0; i<len; i++) {
+      bc[off+i]   += scg->theta[i]*c[off+i];
+      bc[off+i+1] += scg->sigma[i]*c[off+i];
+      if (i) bc[off+i-1] += scg->gamma[i]*c[off+i];
+    }
+  }
+}
+
+#define KSPSCGSwap(a,b) do {Vec _t = (a); (a) = (b); (b) = _t;} while (0)
+
+/* the state between outer steps */
+#define VEC_P  scg->Y[2*scg->s+1]
+#define VEC_Z  scg->Y[2*scg->s+2]
+#define VEC_PT scg->Yt[2*scg->s+1]
+#define VEC_R  scg->Yt[2*scg->s+2]
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSCGSwapState"
+/*
+   KSPSCGSwapState - Exchanges the state vectors with the first vectors of the two chains of the basis, so that the
+   state is moved into the basis at the start of an outer step and the vectors it leaves are used for the new state
+*/
+static PetscErrorCode KSPSCGSwapState(KSP_SCG *scg,PetscInt sb)
+{
+  PetscFunctionBegin;
+  KSPSCGSwap(scg->Y[0],VEC_P);
+  KSPSCGSwap(scg->Y[sb+1],VEC_Z);
+  if (!scg->nopc) {
+    KSPSCGSwap(scg->Yt[0],VEC_PT);
+    KSPSCGSwap(scg->Yt[sb+1],VEC_R);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSolve_SCG"
+static PetscErrorCode KSPSolve_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscInt       i,j,l,sb,n;
+  PetscScalar    *G = scg->G,*Gn,*xc = scg->xc,*rc = scg->rc,*pc = scg->pc,*bp = scg->bp,*tc = scg->tc;
+  PetscScalar    a,b,rho,rhonew,pAp,dot;
+  PetscReal      dp = 0.0,cond;
+  Vec            X,B,*Y,*Yt;
+  Mat            Amat;
+  MPI_Comm       comm;
+  PetscBool      diagonalscale,reduce;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (diagonalscale) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Krylov method %s does not support diagonal scaling",((PetscObject)ksp)->type_name);
+  ierr = PetscObjectGetComm((PetscObject)ksp,&comm);CHKERRQ(ierr);
+  ierr = PCGetOperators(ksp->pc,&Amat,NULL);CHKERRQ(ierr);
+  X    = ksp->vec_sol;
+  B    = ksp->vec_rhs;
+  scg->sact     = scg->s;
+  scg->nlanczos = 0;
+
+  ksp->its = 0;
+  if (!ksp->guess_zero) {
+    ierr = KSP_MatMult(ksp,Amat,X,VEC_R);CHKERRQ(ierr);       /*   r <- b - Ax   */
+    ierr = VecAYPX(VEC_R,-1.0,B);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(B,VEC_R);CHKERRQ(ierr);
+  }
+  if (!scg->nopc) {ierr = KSP_PCApply(ksp,VEC_R,VEC_Z);CHKERRQ(ierr);}
+  ierr = VecDotBegin(VEC_R,VEC_Z,&rho);CHKERRQ(ierr);
+  if (ksp->normtype == KSP_NORM_PRECONDITIONED)   {ierr = VecNormBegin(VEC_Z,NORM_2,&dp);CHKERRQ(ierr);}
+  if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {ierr = VecNormBegin(VEC_R,NORM_2,&dp);CHKERRQ(ierr);}
+  ierr = PetscCommSplitReductionBegin(comm);CHKERRQ(ierr);
+  ierr = VecDotEnd(VEC_R,VEC_Z,&rho);CHKERRQ(ierr);
+  if (ksp->normtype == KSP_NORM_PRECONDITIONED)   {ierr = VecNormEnd(VEC_Z,NORM_2,&dp);CHKERRQ(ierr);}
+  if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {ierr = VecNormEnd(VEC_R,NORM_2,&dp);CHKERRQ(ierr);}
+  if (ksp->normtype == KSP_NORM_NATURAL) dp = PetscSqrtReal(PetscAbsScalar(rho));
+  KSPCheckNorm(ksp,dp);
+  ksp->rnorm = dp;
+  ierr = KSPLogResidualHistory(ksp,dp);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,0,dp);CHKERRQ(ierr);
+  ierr = (*ksp->converged)(ksp,0,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+  if (ksp->reason) PetscFunctionReturn(0);
+  ierr = VecCopy(VEC_Z,VEC_P);CHKERRQ(ierr);                  /*   p <- z, M p <- r   */
+  if (!scg->nopc) {ierr = VecCopy(VEC_R,VEC_PT);CHKERRQ(ierr);}
+
+  while (!ksp->reason && ksp->its < ksp->max_it) {
+    if (rho == 0.0) {
+      ksp->reason = KSP_CONVERGED_ATOL;
+      ierr        = PetscInfo(ksp,"converged due to rho = 0\n");CHKERRQ(ierr);
+      break;
+    } else if (PetscRealPart(rho) < 0.0) {
+      ksp->reason = KSP_DIVERGED_INDEFINITE_PC;
+      ierr        = PetscInfo(ksp,"diverging due to indefinite preconditioner\n");CHKERRQ(ierr);
+      break;
+    }
+    /* build the basis and its Gram matrices, with fewer vectors if it is too ill conditioned */
+    for (;;) {
+      sb   = PetscMin(KSPSStepBlockSize((KSP_SStep*)scg),ksp->max_it-ksp->its);
+      n    = 2*sb+1;
+      ierr = KSPSCGSwapState(scg,sb);CHKERRQ(ierr);
+      Y    = scg->Y;
+      Yt   = scg->Yt;
+      ierr = KSPSStepBuildBasis(ksp,sb,Y,Yt,NULL);CHKERRQ(ierr);
+      ierr = KSPSStepBuildBasis(ksp,sb-1,Y+sb+1,Yt+sb+1,NULL);CHKERRQ(ierr);
+      Gn   = G;
+      for (j=0; j<n; j++) {
+        ierr = VecMDotBegin(Y[j],n,Yt,G+j*n);CHKERRQ(ierr);
+      }
+      if (!scg->nopc && ksp->normtype == KSP_NORM_PRECONDITIONED) {
+        Gn = scg->Gn;
+        for (j=0; j<n; j++) {ierr = VecMDotBegin(Y[j],n,Y,Gn+j*n);CHKERRQ(ierr);}
+      } else if (!scg->nopc && ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+        Gn = scg->Gn;
+        for (j=0; j<n; j++) {ierr = VecMDotBegin(Yt[j],n,Yt,Gn+j*n);CHKERRQ(ierr);}
+      }
+      ierr = PetscCommSplitReductionBegin(comm);CHKERRQ(ierr);
+      for (j=0; j<n; j++) {
+        ierr = VecMDotEnd(Y[j],n,Yt,G+j*n);CHKERRQ(ierr);
+      }
+      if (Gn != G && ksp->normtype == KSP_NORM_PRECONDITIONED) {
+        for (j=0; j<n; j++) {ierr = VecMDotEnd(Y[j],n,Y,Gn+j*n);CHKERRQ(ierr);}
+      } else if (Gn != G) {
+        for (j=0; j<n; j++) {ierr = VecMDotEnd(Yt[j],n,Yt,Gn+j*n);CHKERRQ(ierr);}
+      }
+      if (sb == 1) break;
+      /* G = Yt^H M^{-1} Yt is positive definite as long as the basis is well conditioned */
+      ierr = PetscMemcpy(tc,G,n*n*sizeof(PetscScalar));CHKERRQ(ierr);
+      ierr = KSPSStepCholesky(n,tc,n,&cond);CHKERRQ(ierr);
+      if (cond <= scg->condmax) break;
+      ierr = KSPSCGSwapState(scg,sb);CHKERRQ(ierr);
+      ierr = KSPSStepReduce(ksp,sb);CHKERRQ(ierr);
+    }
+
+    /* sb iterations of CG on the coordinates: p = Y pc, M p = Yt pc, r = Yt rc, z = Y rc, x - x_0 = Y xc */
+    for (i=0; i<n; i++) {xc[i] = 0.0; rc[i] = 0.0; pc[i] = 0.0;}
+    pc[0]    = 1.0;
+    rc[sb+1] = 1.0;
+    rho      = G[(sb+1)+(sb+1)*n];
+    reduce   = PETSC_FALSE;
+    for (j=0; j<sb; j++) {
+      KSPSCGApplyB(scg,sb,pc,bp);
+      pAp = KSPSCGQuad(n,G,bp,pc);                              /*   (A p)^H p   */
+      if (PetscRealPart(pAp) <= 0.0 || PetscIsInfOrNanScalar(pAp)) {
+        if (!j) {
+          ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+          ierr        = PetscInfo(ksp,"diverging due to indefinite or negative definite matrix\n");CHKERRQ(ierr);
+        } else reduce = PETSC_TRUE;
+        break;
+      }
+      a = rho/pAp;
+      for (i=0; i<n; i++) tc[i] = rc[i] - a*bp[i];
+      rhonew = KSPSCGQuad(n,G,tc,tc);
+      if (sb > 1 && PetscRealPart(rhonew) <= 0.0) {
+        /* the coordinates have lost their accuracy */
+        reduce = PETSC_TRUE;
+        break;
+      }
+      for (i=0; i<n; i++) {
+        xc[i] += a*pc[i];
+        rc[i]  = tc[i];
+      }
+      if (ksp->normtype == KSP_NORM_NATURAL) dp = PetscSqrtReal(PetscAbsScalar(rhonew));
+      else if (ksp->normtype == KSP_NORM_NONE) dp = 0.0;
+      else {
+        dot = KSPSCGQuad(n,Gn,rc,rc);
+        dp  = PetscSqrtReal(PetscAbsScalar(dot));
+      }
+      ierr = PetscLogFlops(6.0*n*n+8.0*n);CHKERRQ(ierr);
+      b = rhonew/rho;
+      if (scg->basis != KSP_SSTEP_BASIS_MONOMIAL && !scg->nshifts && scg->nlanczos < scg->s) {
+        scg->alpha[scg->nlanczos] = PetscRealPart(a);
+        scg->beta[scg->nlanczos]  = PetscRealPart(b);
+        scg->nlanczos++;
+      }
+      ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ksp->its++;
+      ksp->rnorm = dp;
+      ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ierr = KSPLogResidualHistory(ksp,dp);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,ksp->its,dp);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,ksp->its,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      rho = rhonew;
+      if (ksp->reason) break;
+      for (i=0; i<n; i++) pc[i] = rc[i] + b*pc[i];
+    }
+
+    /* recover the vectors from their coordinates */
+    ierr = VecMAXPY(X,n,xc,Y);CHKERRQ(ierr);
+    if (!ksp->reason) {
+      ierr = VecZeroEntries(VEC_P);CHKERRQ(ierr);
+      ierr = VecMAXPY(VEC_P,n,pc,Y);CHKERRQ(ierr);
+      ierr = VecZeroEntries(VEC_Z);CHKERRQ(ierr);
+      ierr = VecMAXPY(VEC_Z,n,rc,Y);CHKERRQ(ierr);
+      if (!scg->nopc) {
+        ierr = VecZeroEntries(VEC_PT);CHKERRQ(ierr);
+        ierr = VecMAXPY(VEC_PT,n,pc,Yt);CHKERRQ(ierr);
+        ierr = VecZeroEntries(VEC_R);CHKERRQ(ierr);
+        ierr = VecMAXPY(VEC_R,n,rc,Yt);CHKERRQ(ierr);
+      }
+    }
+    if (reduce) {ierr = KSPSStepReduce(ksp,sb);CHKERRQ(ierr);}
+
+    /* the Lanczos tridiagonal matrix of the first s iterations gives the Ritz values */
+    if (scg->basis != KSP_SSTEP_BASIS_MONOMIAL && !scg->nshifts && scg->nlanczos == scg->s) {
+      l    = scg->s;
+      ierr = PetscMemzero(tc,l*l*sizeof(PetscScalar));CHKERRQ(ierr);
+      for (i=0; i<l; i++) {
+        tc[i+i*l] = 1.0/scg->alpha[i] + (i ? scg->beta[i-1]/scg->alpha[i-1] : 0.0);
+        if (i < l-1) tc[i+1+i*l] = tc[i+(i+1)*l] = PetscSqrtReal(PetscAbsReal(scg->beta[i]))/scg->alpha[i];
+      }
+      ierr = KSPSStepSetShifts(ksp,l,tc,l);CHKERRQ(ierr);
+    }
+  }
+  if (!ksp->reason && ksp->its >= ksp->max_it) ksp->reason = KSP_DIVERGED_ITS;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_SCG"
+static PetscErrorCode KSPReset_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (scg->Y) {
+    if (!scg->nopc) {ierr = VecDestroyVecs(2*scg->s+3,&scg->Yt);CHKERRQ(ierr);}
+    ierr = VecDestroyVecs(2*scg->s+3,&scg->Y);CHKERRQ(ierr);
+    ierr = PetscFree7(scg->G,scg->Gn,scg->xc,scg->rc,scg->pc,scg->bp,scg->tc);CHKERRQ(ierr);
+    ierr = PetscFree2(scg->alpha,scg->beta);CHKERRQ(ierr);
+  }
+  scg->Yt = NULL;
+  ierr    = KSPReset_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_SCG"
+static PetscErrorCode KSPDestroy_SCG(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_SCG(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroy_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_SCG"
+static PetscErrorCode KSPView_SCG(KSP ksp,PetscViewer viewer)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPView_SStep(ksp,viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPSCG - Implements s-step conjugate gradients, which needs one global reduction per s iterations
+
+   Options Database Keys:
++   -ksp_sstep_s <4> - the number of iterations per outer step
+.   -ksp_sstep_basis <newton,monomial,chebyshev> - the polynomial basis, see KSPSStepSetBasis()
+.   -ksp_sstep_cond_max <cond> - reduce s when the basis is more ill conditioned
+-   -ksp_sstep_matrix_powers - generate the basis with two halo exchanges per outer step, see KSPSStepSetUseMatrixPowers()
+
+   Level: intermediate
+
+   Notes:
+   The matrix and the preconditioner must be symmetric positive definite. Each outer step builds s+1 vectors of a
+   polynomial basis from the search direction and s from the residual, both with and without the preconditioner
+   applied, computes their Gram matrix in a single MPI_Allreduce() and then performs s iterations of CG on the
+   coordinates in this basis. The preconditioned, unpreconditioned and natural norms are supported; the first two
+   need a second Gram matrix, computed in the same reduction.
+
+   The Newton and Chebyshev bases use the Ritz values from the first s iterations of each solve, which are done
+   one at a time. When the Gram matrix is not numerically positive definite, or is too ill conditioned, s is halved
+   for the rest of the solve.
+
+   Reference:
+   E. Carson, Communication-avoiding Krylov subspace methods in theory and practice, PhD thesis, UC Berkeley, 2015.
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPCG, KSPPIPECG, KSPSGMRES,
+           KSPSStepSetBasis(), KSPSStepSetUseMatrixPowers()
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_SCG"
+PETSC_EXTERN PetscErrorCode KSPCreate_SCG(KSP ksp)
+{
+  KSP_SCG        *scg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&scg);CHKERRQ(ierr);
+  ksp->data = (void*)scg;
+  ierr = KSPCreate_SStep(ksp);CHKERRQ(ierr);
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NATURAL,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_SCG;
+  ksp->ops->solve          = KSPSolve_SCG;
+  ksp->ops->reset          = KSPReset_SCG;
+  ksp->ops->destroy        = KSPDestroy_SCG;
+  ksp->ops->view           = KSPView_SCG;
+  ksp->ops->setfromoptions = KSPSetFromOptions_SStep;
+  ksp->ops->buildsolution  = KSPBuildSolutionDefault;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+  PetscFunctionReturn(0);
+}
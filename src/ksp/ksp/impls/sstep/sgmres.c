@@ -0,0 +1,502 @@
+
+/*
+    This file implements s-step GMRES: each outer step builds s vectors of a polynomial basis with s applications
+  of the operator and orthogonalizes them against the previous basis and among themselves with a single reduction,
+  block classical Gram-Schmidt followed by Cholesky QR.
+*/
+#include <../src/ksp/ksp/impls/sstep/sstepimpl.h>       /*I  "petscksp.h"  I*/
+
+#define SGMRES_DEFAULT_MAXK 30
+
+typedef struct {
+  KSPSSTEPHEADER
+  PetscInt    max_k;         /* restart */
+  PetscReal   haptol;        /* tolerance for the happy ending */
+  Vec         *vecs;         /* max_k+1 orthonormal basis vectors followed by two work vectors */
+  Vec         sol_temp;      /* used by KSPBuildSolution() */
+  PetscScalar *hh;           /* Hessenberg matrix multiplied by the plane rotations (upper triangular) */
+  PetscScalar *hes;          /* the unmodified Hessenberg matrix, needed to extend it by blocks */
+  PetscScalar *rs,*cc,*ss,*nrs;
+  PetscScalar *C;            /* projections of a block on the previous basis, (max_k+1) x s */
+  PetscScalar *G;            /* Gram matrix of a block, then its Cholesky factor, s x s */
+  PetscScalar *M;            /* new columns of the Hessenberg matrix before the triangular solve, (max_k+1) x s */
+  PetscInt    it;            /* last column of the Hessenberg matrix completed in this cycle, -1 if none */
+} KSP_SGMRES;
+
+#define VEC_VV(i)      sgmres->vecs[i]
+#define VEC_TEMP       sgmres->vecs[sgmres->max_k+1]
+#define VEC_TEMP_MATOP sgmres->vecs[sgmres->max_k+2]
+#define HH(a,b)        (sgmres->hh + (b)*(sgmres->max_k+1) + (a))
+#define HES(a,b)       (sgmres->hes + (b)*(sgmres->max_k+1) + (a))
+#define RS(a)          (sgmres->rs + (a))
+#define CC(a)          (sgmres->cc + (a))
+#define SS(a)          (sgmres->ss + (a))
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_SGMRES"
+static PetscErrorCode KSPSetUp_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       m = sgmres->max_k,s = sgmres->s;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!sgmres->vecs) {
+    ierr = KSPCreateVecs(ksp,m+3,&sgmres->vecs,0,NULL);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(ksp,m+3,sgmres->vecs);CHKERRQ(ierr);
+    ierr = PetscCalloc6((m+1)*m,&sgmres->hh,(m+1)*m,&sgmres->hes,m+1,&sgmres->rs,m,&sgmres->cc,m,&sgmres->ss,m+1,&sgmres->nrs);CHKERRQ(ierr);
+    ierr = PetscMalloc3((m+1)*s,&sgmres->C,s*s,&sgmres->G,(m+1)*s,&sgmres->M);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,(2*(m+1)*m+4*m+3+2*(m+1)*s+s*s)*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+  ierr = KSPSetUp_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSGMRESBlock"
+/*
+   KSPSGMRESBlock - Extends the orthonormal basis from k+1 to k+s+1 vectors and the Hessenberg matrix from k to k+s columns
+
+   The block W = [q_k, w_1, ..., w_s] satisfies Op W(:,0:s-1) = W B. Its new vectors are projected with
+   C = Q^H W and factored with W - Q C = Q_new R, all the inner products are computed in one reduction and the
+   Gram matrix of W - Q C is obtained as W^H W - C^H C. With W = [Q Q_new] Rt the new columns of the Hessenberg
+   matrix are the solution of H_new T_bot = Rt B - H_old T_top, with T_top and T_bot the rows of Rt(:,0:s-1)
+   before and after k.
+
+   If the block is too ill conditioned s is reduced and the block generated again; a single vector is instead
+   orthogonalized a second time.
+*/
+static PetscErrorCode KSPSGMRESBlock(KSP ksp,PetscInt k,PetscInt *sb)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s,i,j,l,ldc = sgmres->max_k+1,lds = sgmres->s;
+  PetscScalar    *C = sgmres->C,*G = sgmres->G,*M = sgmres->M,*coef = sgmres->nrs,t,tbot;
+  PetscReal      cond,nrm,gmax;
+  MPI_Comm       comm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)ksp,&comm);CHKERRQ(ierr);
+  for (;;) {
+    s    = *sb;
+    ierr = KSPSStepBuildBasis(ksp,s,&VEC_VV(k),NULL,VEC_TEMP_MATOP);CHKERRQ(ierr);
+    for (i=1; i<=s; i++) {
+      ierr = VecMDotBegin(VEC_VV(k+i),k+1,&VEC_VV(0),C+(i-1)*ldc);CHKERRQ(ierr);
+      ierr = VecMDotBegin(VEC_VV(k+i),i,&VEC_VV(k+1),G+(i-1)*lds);CHKERRQ(ierr);
+    }
+    ierr = PetscCommSplitReductionBegin(comm);CHKERRQ(ierr);
+    for (i=1; i<=s; i++) {
+      ierr = VecMDotEnd(VEC_VV(k+i),k+1,&VEC_VV(0),C+(i-1)*ldc);CHKERRQ(ierr);
+      ierr = VecMDotEnd(VEC_VV(k+i),i,&VEC_VV(k+1),G+(i-1)*lds);CHKERRQ(ierr);
+    }
+    /* Gram matrix of the projected block, G - C^H C, then its Cholesky factor */
+    gmax = 0.0;
+    for (j=0; j<s; j++) {
+      gmax = PetscMax(gmax,PetscRealPart(G[j+j*lds]));
+      for (i=0; i<=j; i++) {
+        t = G[i+j*lds];
+        for (l=0; l<=k; l++) t -= PetscConj(C[l+i*ldc])*C[l+j*ldc];
+        G[i+j*lds] = t;
+      }
+    }
+    ierr = PetscLogFlops(s*(s+1)*(k+1));CHKERRQ(ierr);
+    ierr = KSPSStepCholesky(s,G,lds,&cond);CHKERRQ(ierr);
+    /* the projection loses the accuracy of the Gram matrix when the block is close to the span of the basis */
+    if (cond < PETSC_MAX_REAL) {
+      for (j=0; j<s; j++) cond = PetscMax(cond,PetscSqrtReal(gmax)/PetscRealPart(G[j+j*lds]));
+    }
+    if (cond <= sgmres->condmax) break;
+    if (s > 1) {
+      ierr = KSPSStepReduce(ksp,s);CHKERRQ(ierr);
+      *sb  = sgmres->sact;
+      continue;
+    }
+    /* a single vector: classical Gram-Schmidt with one step of refinement */
+    for (l=0; l<=k; l++) coef[l] = -C[l];
+    ierr = VecMAXPY(VEC_VV(k+1),k+1,coef,&VEC_VV(0));CHKERRQ(ierr);
+    ierr = VecMDot(VEC_VV(k+1),k+1,&VEC_VV(0),coef);CHKERRQ(ierr);
+    for (l=0; l<=k; l++) {
+      C[l]   += coef[l];
+      coef[l] = -coef[l];
+    }
+    ierr = VecMAXPY(VEC_VV(k+1),k+1,coef,&VEC_VV(0));CHKERRQ(ierr);
+    ierr = VecNorm(VEC_VV(k+1),NORM_2,&nrm);CHKERRQ(ierr);
+    G[0] = nrm;
+    if (nrm > 0.0) {ierr = VecScale(VEC_VV(k+1),1.0/nrm);CHKERRQ(ierr);}
+    break;
+  }
+
+  if (cond <= sgmres->condmax) {
+    /* q_{k+i} = (w_i - Q C(:,i) - sum_{l<i} R(l,i) q_{k+l})/R(i,i) */
+    for (i=1; i<=s; i++) {
+      for (l=0; l<=k; l++) coef[l] = -C[l+(i-1)*ldc];
+      for (l=1; l<i; l++)  coef[k+l] = -G[(l-1)+(i-1)*lds];
+      ierr = VecMAXPY(VEC_VV(k+i),k+i,coef,&VEC_VV(0));CHKERRQ(ierr);
+      ierr = VecScale(VEC_VV(k+i),1.0/G[(i-1)+(i-1)*lds]);CHKERRQ(ierr);
+    }
+  }
+
+  /*
+     Rt(r,j) with W(:,j) = [Q Q_new] Rt(:,j): e_k for j = 0, [C(:,j); R(1:j,j)] otherwise
+  */
+#define RT(r,j) ((j) == 0 ? ((r) == k ? 1.0 : 0.0) : ((r) <= k ? C[(r)+((j)-1)*ldc] : ((r)-k <= (j) ? G[((r)-k-1)+((j)-1)*lds] : 0.0)))
+  for (j=0; j<s; j++) {
+    for (i=0; i<=k+s; i++) {
+      t = sgmres->theta[j]*RT(i,j) + sgmres->sigma[j]*RT(i,j+1);
+      if (j) t += sgmres->gamma[j]*RT(i,j-1);
+      /* subtract H_old T_top(:,j), only the rows up to k of H_old are nonzero */
+      if (j && i <= k) {
+        for (l=PetscMax(0,i-1); l<k; l++) t -= *HES(i,l)*C[l+(j-1)*ldc];
+      }
+      M[i+j*ldc] = t;
+    }
+  }
+  /* solve H_new T_bot = M column by column, T_bot is upper triangular with T_bot(r,j) = Rt(k+r,j) */
+  for (j=0; j<s; j++) {
+    tbot = RT(k+j,j);
+    for (i=0; i<=k+s; i++) {
+      t = M[i+j*ldc];
+      for (l=0; l<j; l++) t -= *HES(i,k+l)*RT(k+l,j);
+      *HES(i,k+j) = t/tbot;
+    }
+    for (i=k+j+2; i<=sgmres->max_k; i++) *HES(i,k+j) = 0.0;
+  }
+#undef RT
+  ierr = PetscLogFlops(2.0*s*(k+s+1)*(k+s));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSGMRESUpdateHessenberg"
+/*
+   KSPSGMRESUpdateHessenberg - Applies the plane rotations to column it of the Hessenberg matrix and computes the new one
+
+   Output Parameters:
++  hapend - the happy ending was detected
+-  res - the new residual norm
+*/
+static PetscErrorCode KSPSGMRESUpdateHessenberg(KSP ksp,PetscInt it,PetscBool *hapend,PetscReal *res)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscScalar    *hh,*cc,*ss,*rs,hhj;
+  PetscReal      hapbnd,delta;
+  PetscInt       j;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  hh = HH(0,it);
+  cc = CC(0);
+  ss = SS(0);
+  rs = RS(0);
+  for (j=0; j<=it+1; j++) hh[j] = *HES(j,it);
+
+  hapbnd = PetscMin(PetscAbsScalar(hh[it+1] / rs[it]),sgmres->haptol);
+  if (PetscAbsScalar(hh[it+1]) < hapbnd) {
+    ierr    = PetscInfo4(ksp,"Detected happy breakdown, current hapbnd = %14.12e H(%D,%D) = %14.12e\n",(double)hapbnd,it+1,it,(double)PetscAbsScalar(hh[it+1]));CHKERRQ(ierr);
+    *hapend = PETSC_TRUE;
+  }
+  for (j=0; j<it; j++) {
+    hhj     = hh[j];
+    hh[j]   = PetscConj(cc[j])*hhj + ss[j]*hh[j+1];
+    hh[j+1] =          -ss[j] *hhj + cc[j]*hh[j+1];
+  }
+  if (!*hapend) {
+    delta = PetscSqrtReal(PetscSqr(PetscAbsScalar(hh[it])) + PetscSqr(PetscAbsScalar(hh[it+1])));
+    if (delta == 0.0) {
+      ksp->reason = KSP_DIVERGED_NULL;
+      PetscFunctionReturn(0);
+    }
+    cc[it]   = hh[it] / delta;
+    ss[it]   = hh[it+1] / delta;
+    hh[it]   = PetscConj(cc[it])*hh[it] + ss[it]*hh[it+1];
+    rs[it+1] = -ss[it]*rs[it];
+    rs[it]   = PetscConj(cc[it])*rs[it];
+    *res     = PetscAbsScalar(rs[it+1]);
+  } else {
+    /* H(it+1,it) = 0, so the least squares problem is solved exactly */
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSGMRESBuildSoln"
+/*
+   KSPSGMRESBuildSoln - Adds the correction from the first it+1 basis vectors to vguess and puts it in vdest
+*/
+static PetscErrorCode KSPSGMRESBuildSoln(PetscScalar *nrs,Vec vguess,Vec vdest,KSP ksp,PetscInt it)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscScalar    tt;
+  PetscInt       k,j;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (it < 0) {
+    ierr = VecCopy(vguess,vdest);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (*HH(it,it) != 0.0) nrs[it] = *RS(it) / *HH(it,it);
+  else nrs[it] = 0.0;
+  for (k=it-1; k>=0; k--) {
+    tt = *RS(k);
+    for (j=k+1; j<=it; j++) tt -= *HH(k,j) * nrs[j];
+    nrs[k] = tt / *HH(k,k);
+  }
+  ierr = VecZeroEntries(VEC_TEMP);CHKERRQ(ierr);
+  ierr = VecMAXPY(VEC_TEMP,it+1,nrs,&VEC_VV(0));CHKERRQ(ierr);
+  ierr = KSPUnwindPreconditioner(ksp,VEC_TEMP,VEC_TEMP_MATOP);CHKERRQ(ierr);
+  if (vdest == vguess) {
+    ierr = VecAXPY(vdest,1.0,VEC_TEMP);CHKERRQ(ierr);
+  } else {
+    ierr = VecWAXPY(vdest,1.0,VEC_TEMP,vguess);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSGMRESCycle"
+/*
+   KSPSGMRESCycle - Runs one cycle of s-step GMRES, up to restart iterations, starting from the residual in VEC_VV(0)
+
+   Output Parameter:
+.  itcount - the number of iterations of the cycle
+*/
+static PetscErrorCode KSPSGMRESCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       k = 0,j,sb,m = sgmres->max_k;
+  PetscReal      res;
+  PetscBool      hapend = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *itcount   = 0;
+  sgmres->it = -1;
+  ierr = VecNormalize(VEC_VV(0),&res);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,res);
+  *RS(0) = res;
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  if (ksp->normtype != KSP_NORM_NONE) ksp->rnorm = res;
+  else ksp->rnorm = 0.0;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPLogResidualHistory(ksp,ksp->rnorm);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,ksp->rnorm);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    *itcount    = 0;
+    PetscFunctionReturn(0);
+  }
+  ierr = (*ksp->converged)(ksp,ksp->its,ksp->rnorm,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+  while (!ksp->reason && !hapend && k < m && ksp->its < ksp->max_it) {
+    /* the Ritz values of the first s columns of the Hessenberg matrix give the Newton and Chebyshev bases */
+    if (sgmres->basis != KSP_SSTEP_BASIS_MONOMIAL && !sgmres->nshifts && k >= sgmres->s) {
+      PetscScalar *H;
+
+      ierr = PetscMalloc1(sgmres->s*sgmres->s,&H);CHKERRQ(ierr);
+      for (j=0; j<sgmres->s*sgmres->s; j++) H[j] = *HES(j % sgmres->s,j / sgmres->s);
+      ierr = KSPSStepSetShifts(ksp,sgmres->s,H,sgmres->s);CHKERRQ(ierr);
+      ierr = PetscFree(H);CHKERRQ(ierr);
+    }
+    sb   = PetscMin(KSPSStepBlockSize((KSP_SStep*)sgmres),PetscMin(m-k,ksp->max_it-ksp->its));
+    ierr = KSPSGMRESBlock(ksp,k,&sb);CHKERRQ(ierr);
+    for (j=0; j<sb; j++) {
+      ierr = KSPSGMRESUpdateHessenberg(ksp,k+j,&hapend,&res);CHKERRQ(ierr);
+      if (ksp->reason) break;
+      sgmres->it = k+j;
+      ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ksp->its++;
+      if (ksp->normtype != KSP_NORM_NONE) ksp->rnorm = res;
+      else ksp->rnorm = 0.0;
+      ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ierr = KSPLogResidualHistory(ksp,ksp->rnorm);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,ksp->its,ksp->rnorm);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,ksp->its,ksp->rnorm,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (ksp->reason || hapend) break;
+    }
+    k += sb;
+  }
+  *itcount = sgmres->it+1;
+  ierr     = KSPSGMRESBuildSoln(sgmres->nrs,ksp->vec_sol,ksp->vec_sol,ksp,sgmres->it);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSolve_SGMRES"
+static PetscErrorCode KSPSolve_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       its = 0,itcount = 0;
+  PetscBool      guess_zero = ksp->guess_zero;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr         = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its     = 0;
+  ierr         = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  sgmres->sact = sgmres->s;
+  ksp->reason  = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    ierr     = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    ierr     = KSPSGMRESCycle(&its,ksp);CHKERRQ(ierr);
+    itcount += its;
+    if (itcount >= ksp->max_it) {
+      if (!ksp->reason) ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    ksp->guess_zero = PETSC_FALSE;
+  }
+  ksp->guess_zero = guess_zero;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBuildSolution_SGMRES"
+static PetscErrorCode KSPBuildSolution_SGMRES(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!sgmres->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&sgmres->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)sgmres->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = sgmres->sol_temp;
+  }
+  ierr = KSPSGMRESBuildSoln(sgmres->nrs,ksp->vec_sol,ptr,ksp,sgmres->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_SGMRES"
+static PetscErrorCode KSPReset_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (sgmres->vecs) {ierr = VecDestroyVecs(sgmres->max_k+3,&sgmres->vecs);CHKERRQ(ierr);}
+  ierr = VecDestroy(&sgmres->sol_temp);CHKERRQ(ierr);
+  ierr = PetscFree6(sgmres->hh,sgmres->hes,sgmres->rs,sgmres->cc,sgmres->ss,sgmres->nrs);CHKERRQ(ierr);
+  ierr = PetscFree3(sgmres->C,sgmres->G,sgmres->M);CHKERRQ(ierr);
+  ierr = KSPReset_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_SGMRES"
+static PetscErrorCode KSPDestroy_SGMRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_SGMRES(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroy_SStep(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetFromOptions_SGMRES"
+static PetscErrorCode KSPSetFromOptions_SGMRES(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       restart;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_SStep(PetscOptionsObject,ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP s-step GMRES Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_sgmres_restart","Number of Krylov search directions","None",sgmres->max_k,&restart,&flg);CHKERRQ(ierr);
+  if (flg) {
+    if (restart < 1) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Restart must be positive");
+    if (restart != sgmres->max_k && ksp->setupstage) {
+      ierr = KSPReset_SGMRES(ksp);CHKERRQ(ierr);
+      ksp->setupstage = KSP_SETUP_NEW;
+    }
+    sgmres->max_k = restart;
+  }
+  ierr = PetscOptionsReal("-ksp_sgmres_haptol","Tolerance for exact convergence (happy ending)","None",sgmres->haptol,&sgmres->haptol,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_SGMRES"
+static PetscErrorCode KSPView_SGMRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscBool      iascii;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {ierr = PetscViewerASCIIPrintf(viewer,"  SGMRES: restart=%D, block classical Gram-Schmidt with Cholesky QR\n",sgmres->max_k);CHKERRQ(ierr);}
+  ierr = KSPView_SStep(ksp,viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPSGMRES - Implements s-step GMRES, which needs one global reduction per s iterations
+
+   Options Database Keys:
++   -ksp_sstep_s <4> - the number of basis vectors built per outer step
+.   -ksp_sstep_basis <newton,monomial,chebyshev> - the polynomial basis, see KSPSStepSetBasis()
+.   -ksp_sstep_cond_max <cond> - reduce s when a block of the basis is more ill conditioned
+.   -ksp_sstep_matrix_powers - generate the s vectors with a single halo exchange, see KSPSStepSetUseMatrixPowers()
+.   -ksp_sgmres_restart <30> - the number of Krylov directions before a restart
+-   -ksp_sgmres_haptol <tol> - the tolerance for the happy ending
+
+   Level: intermediate
+
+   Notes:
+   Each outer step applies the operator s times to extend the basis by a polynomial, then orthogonalizes the s new
+   vectors against the previous basis and among themselves with block classical Gram-Schmidt followed by Cholesky QR,
+   all the inner products in a single MPI_Allreduce(). The Hessenberg matrix is recovered from the change of basis,
+   so the residual norm is still available after each iteration. Left and right preconditioning are supported.
+
+   The monomial basis quickly becomes ill conditioned; the Newton and Chebyshev bases use the Ritz values from the
+   first s iterations of each solve, which are done one at a time. When a block is too ill conditioned s is halved
+   for the rest of the solve; a single vector is orthogonalized with one step of refinement.
+
+   Reference:
+   M. Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, UC Berkeley, 2010.
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPPGMRES, KSPSCG,
+           KSPSStepSetBasis(), KSPSStepSetUseMatrixPowers()
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_SGMRES"
+PETSC_EXTERN PetscErrorCode KSPCreate_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&sgmres);CHKERRQ(ierr);
+  ksp->data = (void*)sgmres;
+  ierr = KSPCreate_SStep(ksp);CHKERRQ(ierr);
+  sgmres->max_k  = SGMRES_DEFAULT_MAXK;
+  sgmres->haptol = 1.0e-30;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_RIGHT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_SGMRES;
+  ksp->ops->solve          = KSPSolve_SGMRES;
+  ksp->ops->reset          = KSPReset_SGMRES;
+  ksp->ops->destroy        = KSPDestroy_SGMRES;
+  ksp->ops->view           = KSPView_SGMRES;
+  ksp->ops->setfromoptions = KSPSetFromOptions_SGMRES;
+  ksp->ops->buildsolution  = KSPBuildSolution_SGMRES;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,598 @@
+
+/*
+    Routines shared by the s-step Krylov methods: the polynomial basis, its generation with or
+  without the matrix powers kernel, and the Cholesky factorization used to orthogonalize blocks.
+*/
+#include <../src/ksp/ksp/impls/sstep/sstepimpl.h>       /*I  "petscksp.h"  I*/
+#include <petscblaslapack.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetCoefficients"
+/*
+   KSPSStepSetCoefficients - Computes the recurrence of the basis from its type and the Ritz values known
+*/
+static PetscErrorCode KSPSStepSetCoefficients(KSP ksp)
+{
+  KSP_SStep *ss = (KSP_SStep*)ksp->data;
+  PetscInt  j;
+  PetscReal rho = 0.0,a,b,c,d;
+
+  PetscFunctionBegin;
+  for (j=0; j<ss->nshifts; j++) rho = PetscMax(rho,PetscAbsReal(ss->shifts[j]));
+  if (rho == 0.0) rho = 1.0;
+  for (j=0; j<ss->s; j++) {
+    ss->theta[j] = 0.0;
+    ss->sigma[j] = 1.0;
+    ss->gamma[j] = 0.0;
+  }
+  if (!ss->nshifts) PetscFunctionReturn(0);
+  switch (ss->basis) {
+  case KSP_SSTEP_BASIS_MONOMIAL:
+    break;
+  case KSP_SSTEP_BASIS_NEWTON:
+    /* (Op - theta_j) y_j / rho, the shifts are used cyclically when there are fewer than s */
+    for (j=0; j<ss->s; j++) {
+      ss->theta[j] = ss->shifts[j % ss->nshifts];
+      ss->sigma[j] = rho;
+    }
+    break;
+  case KSP_SSTEP_BASIS_CHEBYSHEV:
+    /* Chebyshev polynomials of the first kind on the interval of the Ritz values, enlarged by 10 percent since they lie inside the spectrum */
+    a = b = ss->shifts[0];
+    for (j=1; j<ss->nshifts; j++) {
+      a = PetscMin(a,ss->shifts[j]);
+      b = PetscMax(b,ss->shifts[j]);
+    }
+    c = 0.5*(a + b);
+    d = 0.55*(b - a);
+    if (d < 1.e-2*rho) d = 1.e-2*rho;
+    for (j=0; j<ss->s; j++) {
+      ss->theta[j] = c;
+      ss->sigma[j] = j ? 0.5*d : d;
+      ss->gamma[j] = j ? 0.5*d : 0.0;
+    }
+    break;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetShifts"
+/*
+   KSPSStepSetShifts - Computes the Ritz values from a small Hessenberg or tridiagonal matrix and the basis from them
+
+   Input Parameters:
++  ksp - the Krylov space context
+.  n - the number of Ritz values wanted, at most s
+.  H - the matrix in column major order, it is overwritten
+-  ldh - its leading dimension
+
+   Notes:
+   Only the real parts of the Ritz values are used, so that the basis stays real for real operators. They are put
+   in Leja order, where each value is as far as possible from the ones before it, which keeps the Newton basis
+   well conditioned.
+*/
+PetscErrorCode KSPSStepSetShifts(KSP ksp,PetscInt n,PetscScalar *H,PetscInt ldh)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+#if defined(PETSC_MISSING_LAPACK_GEEV) || defined(PETSC_HAVE_ESSL)
+
+  PetscFunctionBegin;
+  ierr        = PetscInfo(ksp,"Ritz values need the LAPACK routine geev(), using the monomial basis\n");CHKERRQ(ierr);
+  ss->basis   = KSP_SSTEP_BASIS_MONOMIAL;
+  ss->nshifts = 0;
+#else
+  PetscInt       i,j,k,best;
+  PetscReal      *eig,dist,bestdist,tmp,lo,hi;
+  PetscScalar    *work,sdummy;
+  PetscBLASInt   bn,bld,lwork,idummy = 1,lierr;
+#if defined(PETSC_USE_COMPLEX)
+  PetscScalar    *eigs;
+  PetscReal      *rwork;
+#else
+  PetscReal      *imag;
+#endif
+
+  PetscFunctionBegin;
+  n    = PetscMin(n,ss->s);
+  if (n < 1) PetscFunctionReturn(0);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(ldh,&bld);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(5*n,&lwork);CHKERRQ(ierr);
+  ierr = PetscMalloc2(5*n,&work,2*n,&eig);CHKERRQ(ierr);
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+  ierr = PetscMalloc2(n,&eigs,2*n,&rwork);CHKERRQ(ierr);
+  PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","N",&bn,H,&bld,eigs,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,rwork,&lierr));
+  for (i=0; i<n; i++) eig[i] = PetscRealPart(eigs[i]);
+  ierr = PetscFree2(eigs,rwork);CHKERRQ(ierr);
+#else
+  imag = eig + n;
+  PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","N",&bn,H,&bld,eig,imag,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,&lierr));
+#endif
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (lierr) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)lierr);
+
+  /* Leja ordering: the largest in magnitude first, then each maximizes the product of the distances to the previous ones */
+  for (k=0; k<n; k++) {
+    best = k; bestdist = -1.0;
+    for (i=k; i<n; i++) {
+      if (!k) dist = PetscAbsReal(eig[i]);
+      else {
+        dist = 1.0;
+        for (j=0; j<k; j++) dist *= PetscAbsReal(eig[i] - eig[j]);
+      }
+      if (dist > bestdist) {best = i; bestdist = dist;}
+    }
+    tmp = eig[k]; eig[k] = eig[best]; eig[best] = tmp;
+  }
+  lo = hi = eig[0];
+  for (i=0; i<n; i++) {
+    ss->shifts[i] = eig[i];
+    lo = PetscMin(lo,eig[i]);
+    hi = PetscMax(hi,eig[i]);
+  }
+  ss->nshifts = n;
+  ierr = PetscFree2(work,eig);CHKERRQ(ierr);
+  ierr = PetscInfo3(ksp,"Using %D Ritz values in [%g, %g] for the basis\n",n,(double)lo,(double)hi);CHKERRQ(ierr);
+#endif
+  ierr = KSPSStepSetCoefficients(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepReduce"
+/*
+   KSPSStepReduce - Uses fewer basis vectors per outer step for the rest of the solve, after a block was too ill conditioned
+*/
+PetscErrorCode KSPSStepReduce(KSP ksp,PetscInt s)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  s    = PetscMax(1,s/2);
+  ierr = PetscInfo2(ksp,"Block of %D basis vectors is ill conditioned, using %D\n",ss->sact,s);CHKERRQ(ierr);
+  ss->sact = s;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepCholesky"
+/*
+   KSPSStepCholesky - Cholesky factorization A = R^H R of a small Hermitian positive definite matrix, in place
+
+   Input Parameters:
++  n - the size
+.  A - the matrix in column major order, only the upper triangle is used and it is overwritten with R
+-  lda - its leading dimension
+
+   Output Parameter:
+.  cond - the ratio of the largest to the smallest diagonal entry of R, PETSC_MAX_REAL if the matrix is not numerically positive definite
+*/
+PetscErrorCode KSPSStepCholesky(PetscInt n,PetscScalar *A,PetscInt lda,PetscReal *cond)
+{
+  PetscInt       i,j,p;
+  PetscScalar    t;
+  PetscReal      d,dmin = PETSC_MAX_REAL,dmax = 0.0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (j=0; j<n; j++) {
+    for (i=0; i<j; i++) {
+      t = A[i+j*lda];
+      for (p=0; p<i; p++) t -= PetscConj(A[p+i*lda])*A[p+j*lda];
+      A[i+j*lda] = t/A[i+i*lda];
+    }
+    d = PetscRealPart(A[j+j*lda]);
+    for (p=0; p<j; p++) d -= PetscRealPart(PetscConj(A[p+j*lda])*A[p+j*lda]);
+    if (!(d > 0.0) || PetscIsInfOrNanReal(d)) {
+      *cond = PETSC_MAX_REAL;
+      PetscFunctionReturn(0);
+    }
+    d          = PetscSqrtReal(d);
+    A[j+j*lda] = d;
+    dmin       = PetscMin(dmin,d);
+    dmax       = PetscMax(dmax,d);
+  }
+  *cond = n ? dmax/dmin : 1.0;
+  ierr  = PetscLogFlops(n*n*n/3.0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepBuildBasis"
+/*
+   KSPSStepBuildBasis - Generates n vectors of the polynomial basis after the first one
+
+   Input Parameters:
++  ksp - the Krylov space context
+.  n - the number of new vectors, at most s
+.  Y - n+1 vectors, the first holds the starting vector
+.  Yt - NULL to use the preconditioned operator of KSP_PCApplyBAorAB(); Y to use the operator alone;
+        otherwise n+1 vectors with M Y, the basis is then generated in both spaces with Yt_{j+1} from A Y_j and Y_{j+1} = M^{-1} Yt_{j+1}
+-  work - a work vector for KSP_PCApplyBAorAB()
+
+   Notes:
+   With the matrix powers kernel the operator is applied to the extended local region, after a single scatter of Y_0
+*/
+PetscErrorCode KSPSStepBuildBasis(KSP ksp,PetscInt n,Vec *Y,Vec *Yt,Vec work)
+{
+  KSP_SStep         *ss = (KSP_SStep*)ksp->data;
+  PetscInt          j,nlocal;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  Mat               Amat;
+  Vec               *V;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (ss->mpkactive && (!Yt || Yt == Y)) {
+    V    = ss->mpkx;
+    ierr = VecGetLocalSize(Y[0],&nlocal);CHKERRQ(ierr);
+    ierr = VecScatterBegin(ss->mpkscatter,Y[0],V[0],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(ss->mpkscatter,Y[0],V[0],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    for (j=0; j<n; j++) {
+      /* after j products the entries within distance s-j of the local rows are still exact */
+      ierr = MatMult(ss->mpkA,V[j],V[j+1]);CHKERRQ(ierr);
+      if (j) {ierr = VecAXPBYPCZ(V[j+1],-ss->theta[j]/ss->sigma[j],-ss->gamma[j]/ss->sigma[j],1.0/ss->sigma[j],V[j],V[j-1]);CHKERRQ(ierr);}
+      else   {ierr = VecAXPBY(V[j+1],-ss->theta[j]/ss->sigma[j],1.0/ss->sigma[j],V[j]);CHKERRQ(ierr);}
+      ierr = VecGetArrayRead(V[j+1],&x);CHKERRQ(ierr);
+      ierr = VecGetArray(Y[j+1],&y);CHKERRQ(ierr);
+      ierr = PetscMemcpy(y,x+ss->mpkoff,nlocal*sizeof(PetscScalar));CHKERRQ(ierr);
+      ierr = VecRestoreArray(Y[j+1],&y);CHKERRQ(ierr);
+      ierr = VecRestoreArrayRead(V[j+1],&x);CHKERRQ(ierr);
+    }
+    PetscFunctionReturn(0);
+  }
+
+  ierr = PCGetOperators(ksp->pc,&Amat,NULL);CHKERRQ(ierr);
+  V    = (Yt && Yt != Y) ? Yt : Y;
+  for (j=0; j<n; j++) {
+    if (!Yt) {
+      ierr = KSP_PCApplyBAorAB(ksp,Y[j],Y[j+1],work);CHKERRQ(ierr);
+    } else {
+      ierr = KSP_MatMult(ksp,Amat,Y[j],V[j+1]);CHKERRQ(ierr);
+    }
+    if (j) {ierr = VecAXPBYPCZ(V[j+1],-ss->theta[j]/ss->sigma[j],-ss->gamma[j]/ss->sigma[j],1.0/ss->sigma[j],V[j],V[j-1]);CHKERRQ(ierr);}
+    else   {ierr = VecAXPBY(V[j+1],-ss->theta[j]/ss->sigma[j],1.0/ss->sigma[j],V[j]);CHKERRQ(ierr);}
+    if (V != Y) {ierr = KSP_PCApply(ksp,V[j+1],Y[j+1]);CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetUpMatrixPowers"
+/*
+   KSPSStepSetUpMatrixPowers - Extracts the rows and columns of the operator within distance s of the local rows
+   and the scatter that fills them
+
+   The kernel is only used when the operator alone generates the basis: an MPIAIJ matrix without preconditioner,
+   null space or transposed solve.
+*/
+static PetscErrorCode KSPSStepSetUpMatrixPowers(KSP ksp)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  Mat            Amat,*sub;
+  MatNullSpace   nullsp;
+  IS             is;
+  Vec            x;
+  PetscInt       i,n,rstart,rend;
+  const PetscInt *idx;
+  PetscBool      ismpiaij,isnone,diagonalscale;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ss->mpkactive = PETSC_FALSE;
+  ierr = MatDestroy(&ss->mpkA);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&ss->mpkscatter);CHKERRQ(ierr);
+  if (ss->mpkx) {ierr = VecDestroyVecs(ss->s+1,&ss->mpkx);CHKERRQ(ierr);}
+  if (!ss->mpk) PetscFunctionReturn(0);
+
+  ierr = PCGetOperators(ksp->pc,&Amat,NULL);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)Amat,MATMPIAIJ,&ismpiaij);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)ksp->pc,PCNONE,&isnone);CHKERRQ(ierr);
+  ierr = MatGetNullSpace(Amat,&nullsp);CHKERRQ(ierr);
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (!ismpiaij || !isnone || nullsp || diagonalscale || ksp->transpose_solve) {
+    ierr = PetscInfo(ksp,"Matrix powers kernel needs an MPIAIJ matrix without preconditioner, null space or diagonal scaling; not used\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  ierr = MatGetOwnershipRange(Amat,&rstart,&rend);CHKERRQ(ierr);
+  ierr = ISCreateStride(PETSC_COMM_SELF,rend-rstart,rstart,1,&is);CHKERRQ(ierr);
+  ierr = MatIncreaseOverlap(Amat,1,&is,ss->s);CHKERRQ(ierr);
+  ierr = ISSort(is);CHKERRQ(ierr);
+  ierr = MatGetSubMatrices(Amat,1,&is,&is,MAT_INITIAL_MATRIX,&sub);CHKERRQ(ierr);
+  ss->mpkA = sub[0];
+  ierr = PetscFree(sub);CHKERRQ(ierr);
+
+  /* the local rows are contiguous in the sorted region */
+  ierr = ISGetLocalSize(is,&n);CHKERRQ(ierr);
+  ierr = ISGetIndices(is,&idx);CHKERRQ(ierr);
+  for (i=0; i<n && idx[i]<rstart; i++) ;
+  ss->mpkoff = i;
+  ierr = ISRestoreIndices(is,&idx);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(ss->mpkA,&x,NULL);CHKERRQ(ierr);
+  ierr = VecDuplicateVecs(x,ss->s+1,&ss->mpkx);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = MatCreateVecs(Amat,&x,NULL);CHKERRQ(ierr);
+  ierr = VecScatterCreate(x,is,ss->mpkx[0],NULL,&ss->mpkscatter);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = ISDestroy(&is);CHKERRQ(ierr);
+  ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)ss->mpkA);CHKERRQ(ierr);
+  ierr = PetscInfo2(ksp,"Matrix powers kernel with %D local rows extended to %D\n",rend-rstart,n);CHKERRQ(ierr);
+  ss->mpkactive = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_SStep"
+PetscErrorCode KSPSetUp_SStep(KSP ksp)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ss->shifts) {
+    ierr = PetscMalloc4(ss->s,&ss->shifts,ss->s,&ss->theta,ss->s,&ss->sigma,ss->s,&ss->gamma);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,4*ss->s*sizeof(PetscReal));CHKERRQ(ierr);
+  }
+  /* the operator may have changed, so the Ritz values are computed again */
+  ss->nshifts = 0;
+  ierr = KSPSStepSetCoefficients(ksp);CHKERRQ(ierr);
+  ierr = KSPSStepSetUpMatrixPowers(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_SStep"
+PetscErrorCode KSPReset_SStep(KSP ksp)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree4(ss->shifts,ss->theta,ss->sigma,ss->gamma);CHKERRQ(ierr);
+  ierr = MatDestroy(&ss->mpkA);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&ss->mpkscatter);CHKERRQ(ierr);
+  if (ss->mpkx) {ierr = VecDestroyVecs(ss->s+1,&ss->mpkx);CHKERRQ(ierr);}
+  ss->nshifts   = 0;
+  ss->mpkactive = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetFromOptions_SStep"
+PetscErrorCode KSPSetFromOptions_SStep(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SStep         *ss = (KSP_SStep*)ksp->data;
+  PetscInt          s = ss->s;
+  KSPSStepBasisType basis = ss->basis;
+  PetscBool         flg,flg2;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP s-step Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_sstep_s","Number of basis vectors per outer step","KSPSStepSetBasis",s,&s,&flg);CHKERRQ(ierr);
+  ierr = PetscOptionsEnum("-ksp_sstep_basis","Polynomial basis","KSPSStepSetBasis",KSPSStepBasisTypes,(PetscEnum)basis,(PetscEnum*)&basis,&flg2);CHKERRQ(ierr);
+  if (flg || flg2) {ierr = KSPSStepSetBasis(ksp,s,basis);CHKERRQ(ierr);}
+  ierr = PetscOptionsReal("-ksp_sstep_cond_max","Largest condition number of a block of basis vectors before s is reduced","None",ss->condmax,&ss->condmax,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-ksp_sstep_matrix_powers","Fetch a ghost region of depth s once per outer step","KSPSStepSetUseMatrixPowers",ss->mpk,&ss->mpk,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_SStep"
+PetscErrorCode KSPView_SStep(KSP ksp,PetscViewer viewer)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscBool      iascii;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  s-step: s=%D, %s basis\n",ss->s,KSPSStepBasisTypes[ss->basis]);CHKERRQ(ierr);
+    if (ss->sact != ss->s) {ierr = PetscViewerASCIIPrintf(viewer,"  s-step: reduced to s=%D in the last solve\n",ss->sact);CHKERRQ(ierr);}
+    if (ss->mpk) {ierr = PetscViewerASCIIPrintf(viewer,"  s-step: matrix powers kernel %s\n",ss->mpkactive ? "in use" : "requested, not applicable");CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetBasis_SStep"
+static PetscErrorCode KSPSStepSetBasis_SStep(KSP ksp,PetscInt s,KSPSStepBasisType basis)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (s == PETSC_DEFAULT) s = 4;
+  if (s < 1) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Number of basis vectors must be positive");
+  if (s != ss->s && ksp->setupstage) {
+    /* free the data structures, then create them again */
+    ierr = (*ksp->ops->reset)(ksp);CHKERRQ(ierr);
+    ksp->setupstage = KSP_SETUP_NEW;
+  }
+  ss->s     = s;
+  ss->sact  = s;
+  ss->basis = basis;
+  if (ss->shifts) {ierr = KSPSStepSetCoefficients(ksp);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepGetBasis_SStep"
+static PetscErrorCode KSPSStepGetBasis_SStep(KSP ksp,PetscInt *s,KSPSStepBasisType *basis)
+{
+  KSP_SStep *ss = (KSP_SStep*)ksp->data;
+
+  PetscFunctionBegin;
+  if (s)     *s     = ss->s;
+  if (basis) *basis = ss->basis;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetUseMatrixPowers_SStep"
+static PetscErrorCode KSPSStepSetUseMatrixPowers_SStep(KSP ksp,PetscBool flg)
+{
+  KSP_SStep *ss = (KSP_SStep*)ksp->data;
+
+  PetscFunctionBegin;
+  if (flg != ss->mpk && ksp->setupstage) ksp->setupstage = KSP_SETUP_NEW;
+  ss->mpk = flg;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_SStep"
+/*
+   KSPCreate_SStep - Sets the defaults of the data common to the s-step methods, ksp->data must already be allocated
+*/
+PetscErrorCode KSPCreate_SStep(KSP ksp)
+{
+  KSP_SStep      *ss = (KSP_SStep*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ss->s       = 4;
+  ss->sact    = 4;
+  ss->basis   = KSP_SSTEP_BASIS_NEWTON;
+  ss->condmax = PetscPowReal(PETSC_MACHINE_EPSILON,-0.25);
+  ss->mpk     = PETSC_FALSE;
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepSetBasis_C",KSPSStepSetBasis_SStep);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepGetBasis_C",KSPSStepGetBasis_SStep);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepSetUseMatrixPowers_C",KSPSStepSetUseMatrixPowers_SStep);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_SStep"
+PetscErrorCode KSPDestroy_SStep(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepSetBasis_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepGetBasis_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPSStepSetUseMatrixPowers_C",NULL);CHKERRQ(ierr);
+  ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetBasis"
+/*@
+   KSPSStepSetBasis - Sets the number of basis vectors built per outer step of the s-step methods and their polynomial basis
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+.  s - the number of basis vectors per outer step, or PETSC_DEFAULT for 4
+-  basis - the polynomial basis, KSP_SSTEP_BASIS_MONOMIAL, KSP_SSTEP_BASIS_NEWTON or KSP_SSTEP_BASIS_CHEBYSHEV
+
+   Options Database:
++  -ksp_sstep_s <s> - the number of basis vectors
+-  -ksp_sstep_basis <monomial,newton,chebyshev> - the basis
+
+   Notes:
+   The Newton and Chebyshev bases need estimates of the spectrum: the first s iterations of each solve take one
+   basis vector at a time and give the Ritz values, only their real parts are used. The Newton basis shifts by the
+   Ritz values in Leja order, the Chebyshev basis uses the interval containing them.
+
+   When the Cholesky factorization of a block fails, or the block is more ill conditioned than -ksp_sstep_cond_max,
+   s is halved for the rest of the solve.
+
+   Level: intermediate
+
+.keywords: KSP, s-step, basis
+
+.seealso: KSPSGMRES, KSPSCG, KSPSStepGetBasis(), KSPSStepSetUseMatrixPowers()
+@*/
+PetscErrorCode KSPSStepSetBasis(KSP ksp,PetscInt s,KSPSStepBasisType basis)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,s,2);
+  PetscValidLogicalCollectiveEnum(ksp,basis,3);
+  ierr = PetscTryMethod(ksp,"KSPSStepSetBasis_C",(KSP,PetscInt,KSPSStepBasisType),(ksp,s,basis));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepGetBasis"
+/*@
+   KSPSStepGetBasis - Gets the number of basis vectors built per outer step of the s-step methods and their polynomial basis
+
+   Not Collective
+
+   Input Parameter:
+.  ksp - the Krylov space context
+
+   Output Parameters:
++  s - the number of basis vectors per outer step
+-  basis - the polynomial basis
+
+   Level: intermediate
+
+.keywords: KSP, s-step, basis
+
+.seealso: KSPSGMRES, KSPSCG, KSPSStepSetBasis()
+@*/
+PetscErrorCode KSPSStepGetBasis(KSP ksp,PetscInt *s,KSPSStepBasisType *basis)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  ierr = PetscUseMethod(ksp,"KSPSStepGetBasis_C",(KSP,PetscInt*,KSPSStepBasisType*),(ksp,s,basis));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSStepSetUseMatrixPowers"
+/*@
+   KSPSStepSetUseMatrixPowers - Generates the s basis vectors of each outer step with a single halo exchange
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  flg - PETSC_TRUE to use the matrix powers kernel
+
+   Options Database:
+.  -ksp_sstep_matrix_powers - use the matrix powers kernel
+
+   Notes:
+   The rows and columns of the matrix within distance s of the local rows, found with MatIncreaseOverlap(), are
+   copied to each process at setup. Each outer step then scatters the depth s ghost region of the starting vector
+   once and computes the s products locally, at the cost of redundant work on the ghost rows.
+
+   Only MATMPIAIJ operators without preconditioner (PCNONE) are supported; otherwise the option is ignored.
+
+   Level: advanced
+
+.keywords: KSP, s-step, matrix powers
+
+.seealso: KSPSGMRES, KSPSCG, KSPSStepSetBasis()
+@*/
+PetscErrorCode KSPSStepSetUseMatrixPowers(KSP ksp,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveBool(ksp,flg,2);
+  ierr = PetscTryMethod(ksp,"KSPSStepSetUseMatrixPowers_C",(KSP,PetscBool),(ksp,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
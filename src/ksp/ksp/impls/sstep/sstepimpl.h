@@ -0,0 +1,54 @@
+/*
+   Private data structure shared by the s-step Krylov methods KSPSGMRES and KSPSCG. The data
+  structure of each method must begin with KSPSSTEPHEADER so that the routines in sstep.c can be
+  used for both.
+*/
+#if !defined(__SSTEPIMPL_H)
+#define __SSTEPIMPL_H
+
+#include <petsc/private/kspimpl.h>        /*I "petscksp.h" I*/
+
+#define KSPSSTEPHEADER                                                  \
+  PetscInt          s;          /* requested number of basis vectors per outer step */ \
+  PetscInt          sact;       /* number in use, reduced when a block of the basis is ill conditioned */ \
+  KSPSStepBasisType basis;                                              \
+  PetscReal         condmax;    /* largest condition number of a block of the basis that is accepted */ \
+  PetscInt          nshifts;    /* number of Ritz values known, 0 until they have been computed */ \
+  PetscReal         *shifts;    /* real parts of the Ritz values in Leja order */ \
+  /* the basis satisfies Op y_j = sigma_j y_{j+1} + theta_j y_j + gamma_j y_{j-1}, that is Op Y = Y B */ \
+  PetscReal         *theta,*sigma,*gamma;                               \
+  /* matrix powers kernel */                                            \
+  PetscBool         mpk;        /* requested with KSPSStepSetUseMatrixPowers() */ \
+  PetscBool         mpkactive;  /* possible for the current operator and preconditioner */ \
+  Mat               mpkA;       /* rows and columns of the operator within distance s of the local rows */ \
+  VecScatter        mpkscatter; /* from a global vector to the extended local region */ \
+  Vec               *mpkx;      /* s+1 vectors on the extended region */ \
+  PetscInt          mpkoff;     /* position of the local rows in the extended region */
+
+typedef struct {
+  KSPSSTEPHEADER
+} KSP_SStep;
+
+PETSC_INTERN PetscErrorCode KSPSetFromOptions_SStep(PetscOptionItems*,KSP);
+PETSC_INTERN PetscErrorCode KSPView_SStep(KSP,PetscViewer);
+PETSC_INTERN PetscErrorCode KSPSetUp_SStep(KSP);
+PETSC_INTERN PetscErrorCode KSPReset_SStep(KSP);
+PETSC_INTERN PetscErrorCode KSPCreate_SStep(KSP);
+PETSC_INTERN PetscErrorCode KSPDestroy_SStep(KSP);
+
+PETSC_INTERN PetscErrorCode KSPSStepSetShifts(KSP,PetscInt,PetscScalar*,PetscInt);
+PETSC_INTERN PetscErrorCode KSPSStepBuildBasis(KSP,PetscInt,Vec*,Vec*,Vec);
+PETSC_INTERN PetscErrorCode KSPSStepCholesky(PetscInt,PetscScalar*,PetscInt,PetscReal*);
+PETSC_INTERN PetscErrorCode KSPSStepReduce(KSP,PetscInt);
+
+/*
+   KSPSStepBlockSize - number of basis vectors of the next outer step; until the Ritz values needed by
+   the Newton and Chebyshev bases are known the methods take one vector at a time
+*/
+PETSC_STATIC_INLINE PetscInt KSPSStepBlockSize(KSP_SStep *ss)
+{
+  if (ss->basis != KSP_SSTEP_BASIS_MONOMIAL && !ss->nshifts) return 1;
+  return ss->sact;
+}
+
+#endif
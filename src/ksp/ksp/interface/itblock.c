@@ -0,0 +1,316 @@
+
+/*
+     Routines shared by the block Krylov methods that implement KSPMatSolve(). The blocks of vectors
+   are stored as dense matrices with the same row layout as the operator, one column per right hand
+   side, so that the operator is applied to a whole block with one sparse matrix - dense matrix product
+   and the inner products of a block are gathered in a single reduction.
+*/
+#include <petsc/private/kspimpl.h>   /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockCreateColumnVecs"
+/*
+   Vectors without storage with the row layout of the dense matrix M, used with VecPlaceArray() to pass
+   one of its columns to MatMult(), PCApply() or KSPSolve()
+*/
+static PetscErrorCode KSPBlockCreateColumnVecs(Mat M,Vec *x,Vec *y)
+{
+  PetscErrorCode ierr;
+  MPI_Comm       comm;
+  PetscMPIInt    size;
+  PetscInt       n,N;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)M,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(M,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(M,&N,NULL);CHKERRQ(ierr);
+  if (size == 1) {
+    ierr = VecCreateSeqWithArray(comm,1,n,NULL,x);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(comm,1,n,NULL,y);CHKERRQ(ierr);
+  } else {
+    ierr = VecCreateMPIWithArray(comm,1,n,N,NULL,x);CHKERRQ(ierr);
+    ierr = VecCreateMPIWithArray(comm,1,n,N,NULL,y);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatSolveColumns"
+/*
+   KSPMatSolveColumns - Solves for each column of B with KSPSolve(); used when the Krylov method has no block
+   variant or the solve needs features the block methods do not support. KSPGetIterationNumber() then returns
+   the total number of iterations and KSPGetConvergedReason() the first failure, if any.
+*/
+PetscErrorCode KSPMatSolveColumns(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode     ierr;
+  PetscScalar        *b,*x;
+  PetscInt           n,k,j,its = 0;
+  KSPConvergedReason reason = KSP_CONVERGED_ITS;
+  Vec                vb,vx;
+
+  PetscFunctionBegin;
+  ierr = MatGetLocalSize(B,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,NULL,&k);CHKERRQ(ierr);
+  ierr = KSPBlockCreateColumnVecs(B,&vb,&vx);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(B,&b);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+  for (j=0; j<k; j++) {
+    ierr = VecPlaceArray(vb,b+j*n);CHKERRQ(ierr);
+    ierr = VecPlaceArray(vx,x+j*n);CHKERRQ(ierr);
+    ierr = KSPSolve(ksp,vb,vx);CHKERRQ(ierr);
+    ierr = VecResetArray(vb);CHKERRQ(ierr);
+    ierr = VecResetArray(vx);CHKERRQ(ierr);
+    its += ksp->its;
+    if (!j || (reason > 0 && ksp->reason < 0)) reason = ksp->reason;
+  }
+  ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArray(B,&b);CHKERRQ(ierr);
+  /* do not leave the KSP holding vectors whose storage has been removed */
+  ierr = VecDestroy(&ksp->vec_rhs);CHKERRQ(ierr);
+  ierr = VecDestroy(&ksp->vec_sol);CHKERRQ(ierr);
+  ierr = VecDestroy(&vb);CHKERRQ(ierr);
+  ierr = VecDestroy(&vx);CHKERRQ(ierr);
+  ksp->its    = its;
+  ksp->reason = reason;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockMatMult"
+/*
+   KSPBlockMatMult - Computes Q = A P for the operator A of the KSP. For AIJ operators this is one
+   MatMatMult() so the matrix is read once for all the columns of P; other operators are applied column
+   by column. Q is created on the first call and must have been created by this routine on later calls.
+*/
+PetscErrorCode KSPBlockMatMult(KSP ksp,Mat P,Mat *Q)
+{
+  PetscErrorCode ierr;
+  Mat            A;
+  PetscBool      spmm;
+  PetscScalar    *p,*q;
+  PetscInt       n,k,j;
+  Vec            vp,vq;
+
+  PetscFunctionBegin;
+  ierr = PCGetOperators(ksp->pc,&A,NULL);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompareAny((PetscObject)A,&spmm,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+  if (spmm) {
+    ierr = MatMatMult(A,P,*Q ? MAT_REUSE_MATRIX : MAT_INITIAL_MATRIX,PETSC_DEFAULT,Q);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (!*Q) {ierr = MatDuplicate(P,MAT_DO_NOT_COPY_VALUES,Q);CHKERRQ(ierr);}
+  ierr = MatGetLocalSize(P,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(P,NULL,&k);CHKERRQ(ierr);
+  ierr = KSPBlockCreateColumnVecs(P,&vp,&vq);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(P,&p);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(*Q,&q);CHKERRQ(ierr);
+  for (j=0; j<k; j++) {
+    ierr = VecPlaceArray(vp,p+j*n);CHKERRQ(ierr);
+    ierr = VecPlaceArray(vq,q+j*n);CHKERRQ(ierr);
+    ierr = MatMult(A,vp,vq);CHKERRQ(ierr);
+    ierr = VecResetArray(vp);CHKERRQ(ierr);
+    ierr = VecResetArray(vq);CHKERRQ(ierr);
+  }
+  ierr = MatDenseRestoreArray(*Q,&q);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+  ierr = VecDestroy(&vp);CHKERRQ(ierr);
+  ierr = VecDestroy(&vq);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockPCApply"
+/*
+   KSPBlockPCApply - Applies the preconditioner to each column of R, Z = B R
+*/
+PetscErrorCode KSPBlockPCApply(KSP ksp,Mat R,Mat Z)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *r,*z;
+  PetscInt       n,k,j;
+  Vec            vr,vz;
+
+  PetscFunctionBegin;
+  ierr = MatGetLocalSize(R,&n,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(R,NULL,&k);CHKERRQ(ierr);
+  ierr = KSPBlockCreateColumnVecs(R,&vr,&vz);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(R,&r);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(Z,&z);CHKERRQ(ierr);
+  for (j=0; j<k; j++) {
+    ierr = VecPlaceArray(vr,r+j*n);CHKERRQ(ierr);
+    ierr = VecPlaceArray(vz,z+j*n);CHKERRQ(ierr);
+    ierr = KSP_PCApply(ksp,vr,vz);CHKERRQ(ierr);
+    ierr = VecResetArray(vr);CHKERRQ(ierr);
+    ierr = VecResetArray(vz);CHKERRQ(ierr);
+  }
+  ierr = MatDenseRestoreArray(Z,&z);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+  ierr = VecDestroy(&vr);CHKERRQ(ierr);
+  ierr = VecDestroy(&vz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockOrthogonalize"
+/*
+   KSPBlockOrthogonalize - Replaces the first k columns of W by an orthonormal basis of their span, dropping
+   the columns that are numerically linearly dependent on the others (deflation).
+
+   Input Parameters:
++  W     - dense matrix holding the block
+.  k     - number of columns of W used
+.  scale - optional weight of each column, used only to decide which columns are dependent; a column whose
+           right hand side has nearly converged can be given a small weight so that it is deflated first
+-  nrm   - if positive, columns are dropped relative to this norm rather than to the largest column
+
+   Output Parameters:
++  rank  - number of orthonormal columns, stored in the first rank columns of W; the others are zeroed
+-  R     - optional rank by k factor (leading dimension ldr >= k, rows rank to k-1 are zeroed) with W = Q R
+
+   Notes:
+   A Cholesky factorization with diagonal pivoting of the Gram matrix W^H W reveals the rank, and a second
+   Cholesky QR pass restores the orthogonality lost to the conditioning of the columns that are kept. Each
+   pass needs a single reduction.
+*/
+PetscErrorCode KSPBlockOrthogonalize(Mat W,PetscInt k,const PetscReal *scale,PetscReal nrm,PetscInt *rank,PetscScalar *R,PetscInt ldr)
+{
+  PetscErrorCode ierr;
+  MPI_Comm       comm;
+  PetscScalar    *w,*G,*Gl,*T,t,one = 1.0,zero = 0.0;
+  PetscReal      tol,thr,dmax = 0.0,d;
+  PetscInt       n,i,j,l,piv,r,*perm;
+  PetscBLASInt   bn,bk,br,bld,info;
+
+  PetscFunctionBegin;
+  *rank = 0;
+  if (!k) PetscFunctionReturn(0);
+  ierr = PetscObjectGetComm((PetscObject)W,&comm);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(W,&n,NULL);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(n,1),&bld);CHKERRQ(ierr);
+  ierr = PetscMalloc4(k*k,&G,k*k,&Gl,k*k,&T,k,&perm);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(W,&w);CHKERRQ(ierr);
+  if (scale) {
+    for (j=0; j<k; j++) {
+      for (i=0; i<n; i++) w[i+j*n] *= scale[j];
+    }
+  }
+  PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bk,&bk,&bn,&one,w,&bld,w,&bld,&zero,Gl,&bk));
+  ierr = MPIU_Allreduce(Gl,G,k*k,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*n*k*k);CHKERRQ(ierr);
+
+  /* Cholesky factorization of the Gram matrix with diagonal pivoting; stops at the first pivot below the threshold */
+  tol = PetscPowReal(PETSC_MACHINE_EPSILON,1.0/3.0);
+  for (j=0; j<k; j++) {
+    dmax    = PetscMax(dmax,PetscRealPart(G[j*(k+1)]));
+    perm[j] = j;
+  }
+  thr = tol*tol*(nrm > 0.0 ? nrm*nrm : dmax);
+  for (r=0; r<k; r++) {
+    piv = r;
+    d   = PetscRealPart(G[r*(k+1)]);
+    for (j=r+1; j<k; j++) {
+      if (PetscRealPart(G[j*(k+1)]) > d) {piv = j; d = PetscRealPart(G[j*(k+1)]);}
+    }
+    if (d <= thr) break;
+    if (piv != r) {
+      for (j=0; j<k; j++) {t = G[r+j*k]; G[r+j*k] = G[piv+j*k]; G[piv+j*k] = t;}
+      for (j=0; j<k; j++) {t = G[j+r*k]; G[j+r*k] = G[j+piv*k]; G[j+piv*k] = t;}
+      for (i=0; i<n; i++) {t = w[i+r*n]; w[i+r*n] = w[i+piv*n]; w[i+piv*n] = t;}
+      l = perm[r]; perm[r] = perm[piv]; perm[piv] = l;
+    }
+    d          = PetscSqrtReal(d);
+    G[r*(k+1)] = d;
+    for (j=r+1; j<k; j++) G[r+j*k] /= d;
+    for (l=r+1; l<k; l++) {
+      for (j=r+1; j<k; j++) G[j+l*k] -= PetscConj(G[r+j*k])*G[r+l*k];
+    }
+  }
+
+  if (r) {
+    PetscBLASInt ldt;
+
+    ierr = PetscBLASIntCast(r,&br);CHKERRQ(ierr);
+    ldt  = br;
+    for (j=0; j<r; j++) {
+      for (i=j+1; i<k; i++) G[i+j*k] = 0.0;
+    }
+    PetscStackCallBLAS("BLAStrsm",BLAStrsm_("R","U","N","N",&bn,&br,&one,G,&bk,w,&bld));
+    /* second pass: W = Q R2 */
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&br,&br,&bn,&one,w,&bld,w,&bld,&zero,Gl,&br));
+    ierr = MPIU_Allreduce(Gl,T,r*r,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+    PetscStackCallBLAS("LAPACKpotrf",LAPACKpotrf_("U",&br,T,&ldt,&info));
+    if (info) {
+      ierr = PetscInfo2(W,"Second Cholesky QR pass lost rank, %D columns kept of %D\n",(PetscInt)info-1,r);CHKERRQ(ierr);
+      r    = info-1;
+      br   = info-1;
+    }
+    if (r) {
+      PetscStackCallBLAS("BLAStrsm",BLAStrsm_("R","U","N","N",&bn,&br,&one,T,&ldt,w,&bld));
+      for (j=0; j<r; j++) {
+        for (i=j+1; i<r; i++) T[i+j*ldt] = 0.0;
+      }
+      /* R = R2 R1, in the pivoted column order */
+      PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&br,&bk,&br,&one,T,&ldt,G,&bk,&zero,Gl,&br));
+    }
+    ierr = PetscLogFlops(4.0*n*r*r+2.0*n*r*r);CHKERRQ(ierr);
+  }
+  ierr = PetscMemzero(w+r*n,(k-r)*n*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = MatDenseRestoreArray(W,&w);CHKERRQ(ierr);
+  if (R) {
+    for (j=0; j<k; j++) {
+      l = perm[j];
+      for (i=0; i<r; i++) R[i+l*ldr] = scale ? Gl[i+j*r]/scale[l] : Gl[i+j*r];
+      for (i=r; i<k; i++) R[i+l*ldr] = 0.0;
+    }
+  }
+  ierr  = PetscFree4(G,Gl,T,perm);CHKERRQ(ierr);
+  *rank = r;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBlockConverged"
+/*
+   KSPBlockConverged - Logs and monitors the residual norms of a block iteration and sets the converged
+   reason. The block has converged when every column satisfies the test of KSPConvergedDefault() relative
+   to the norm ref of its initial residual; the norm monitored is the largest over the columns. KSPMatSolve()
+   only calls the block methods when the KSP uses that test, other tests are applied by KSPSolve() per column.
+*/
+PetscErrorCode KSPBlockConverged(KSP ksp,PetscInt k,const PetscReal *nrm,const PetscReal *ref)
+{
+  PetscErrorCode ierr;
+  PetscReal      rnorm = 0.0;
+  PetscBool      conv = PETSC_TRUE,div = PETSC_FALSE,naninf = PETSC_FALSE;
+  PetscInt       j;
+
+  PetscFunctionBegin;
+  for (j=0; j<k; j++) {
+    if (PetscIsInfOrNanReal(nrm[j])) naninf = PETSC_TRUE;
+    rnorm = PetscMax(rnorm,nrm[j]);
+    if (nrm[j] > PetscMax(ksp->rtol*ref[j],ksp->abstol)) conv = PETSC_FALSE;
+    if (nrm[j] > ksp->divtol*ref[j]) div = PETSC_TRUE;
+  }
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = rnorm;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPLogResidualHistory(ksp,rnorm);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,rnorm);CHKERRQ(ierr);
+  if (naninf) {
+    if (ksp->errorifnotconverged) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"KSPMatSolve has not converged due to Nan or Inf norm");
+    ksp->reason = KSP_DIVERGED_NANORINF;
+  } else if (ksp->normtype == KSP_NORM_NONE) {
+    if (ksp->its >= ksp->max_it) ksp->reason = KSP_CONVERGED_ITS;
+  } else if (conv) {
+    ksp->reason = rnorm <= ksp->abstol ? KSP_CONVERGED_ATOL : KSP_CONVERGED_RTOL;
+  } else if (div) {
+    ksp->reason = KSP_DIVERGED_DTOL;
+  } else if (ksp->its >= ksp->max_it) {
+    ksp->reason = KSP_DIVERGED_ITS;
+  }
+  PetscFunctionReturn(0);
+}
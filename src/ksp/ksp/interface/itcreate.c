@@ -7,7 +7,7 @@
 /* Logging support */
 PetscClassId  KSP_CLASSID;
 PetscClassId  DMKSP_CLASSID;
-PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve;
+PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve, KSP_MatSolve;
 
 /*
    Contains the list of registered KSP routines
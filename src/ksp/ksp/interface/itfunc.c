@@ -4,6 +4,7 @@
 */
 
 #include <petsc/private/kspimpl.h>   /*I "petscksp.h" I*/
+#include <petsc/private/pcimpl.h>
 #include <petscdm.h>
 
 #undef __FUNCT__
@@ -910,6 +911,111 @@ PetscErrorCode  KSPSolveTranspose(KSP ksp,Vec b,Vec x)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatSolve"
+/*@
+   KSPMatSolve - Solves a linear system with several right hand sides that share the same operators
+
+   Collective on KSP
+
+   Input Parameters:
++  ksp - iterative context obtained from KSPCreate()
+-  B - dense matrix whose columns are the right hand sides
+
+   Output Parameter:
+.  X - dense matrix whose columns are the solutions; used as the initial guess with KSPSetInitialGuessNonzero()
+
+   Notes:
+   B and X must be MATSEQDENSE or MATMPIDENSE matrices whose rows are distributed like the rows of the operator,
+   with their local columns stored contiguously (the default when the dense matrix allocates its own storage).
+
+   KSPCG and KSPGMRES solve all the right hand sides together with a block Krylov method: each iteration applies the
+   operator to the whole block with one MatMatMult() when it is an AIJ matrix, so the matrix is read from memory once
+   per iteration rather than once per right hand side, and the inner products of the block share one reduction.
+   When the columns of the block become numerically linearly dependent, for example because some right hand sides
+   have converged or because they are multiples of each other, the dependent columns are removed from the block
+   (deflation). Each column is considered converged when its residual norm satisfies the tolerances set with
+   KSPSetTolerances() relative to the norm of its initial residual; the residual norm passed to the monitors is the
+   largest over the columns, and KSPGetIterationNumber() returns the number of block iterations.
+
+   Other Krylov methods, and solves that need diagonal scaling, a null space, an initial guess generator, or a
+   preconditioner with a presolve stage, solve the columns one after the other with KSPSolve(); the
+   iteration number is then the total over the columns. So do solves with a convergence test other than
+   KSPConvergedDefault(), for example one set with KSPSetConvergenceTest() or KSPConvergedSkip(), and solves
+   where KSPConvergedDefault() does not measure convergence relative to the initial residual, that is with a
+   nonzero initial guess unless KSPConvergedDefaultSetUIRNorm() is used, or with KSPSetCheckNormIteration().
+
+   Level: intermediate
+
+.keywords: KSP, solve, linear system, multiple right hand sides
+
+.seealso: KSPSolve(), MatMatSolve(), KSPCG, KSPGMRES
+@*/
+PetscErrorCode  KSPMatSolve(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode ierr;
+  Mat            mat,pmat;
+  MatNullSpace   nullsp = NULL,tnullsp = NULL;
+  PetscBool      flg,defaultconv = PETSC_FALSE;
+  PetscInt       m,n,M,N,K;
+  MPI_Comm       comm;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidHeaderSpecific(B,MAT_CLASSID,2);
+  PetscValidHeaderSpecific(X,MAT_CLASSID,3);
+  PetscCheckSameComm(ksp,1,B,2);
+  PetscCheckSameComm(ksp,1,X,3);
+  comm = PetscObjectComm((PetscObject)ksp);
+  if (B == X) SETERRQ(comm,PETSC_ERR_ARG_IDN,"B and X must be different matrices");
+  ierr = PetscObjectTypeCompareAny((PetscObject)B,&flg,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!flg) SETERRQ(comm,PETSC_ERR_SUP,"Right hand sides must be stored in a dense matrix");
+  ierr = PetscObjectTypeCompareAny((PetscObject)X,&flg,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!flg) SETERRQ(comm,PETSC_ERR_SUP,"Solutions must be stored in a dense matrix");
+  ierr = MatGetSize(B,&M,&K);CHKERRQ(ierr);
+  ierr = MatGetSize(X,&N,&n);CHKERRQ(ierr);
+  if (M != N || K != n) SETERRQ4(comm,PETSC_ERR_ARG_SIZ,"Solution matrix %D x %D does not match right hand side matrix %D x %D",N,n,M,K);
+
+  ksp->transpose_solve = PETSC_FALSE;
+  ierr = KSPSetUp(ksp);CHKERRQ(ierr);
+  ierr = KSPSetUpOnBlocks(ksp);CHKERRQ(ierr);
+  ierr = PCGetOperators(ksp->pc,&mat,&pmat);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(mat,&m,NULL);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(B,&n,NULL);CHKERRQ(ierr);
+  if (m != n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Local rows of the right hand sides %D do not match local rows of the operator %D",n,m);
+  ierr = MatGetLocalSize(X,&n,NULL);CHKERRQ(ierr);
+  if (m != n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Local rows of the solutions %D do not match local rows of the operator %D",n,m);
+
+  if (!K) {
+    ksp->its    = 0;
+    ksp->reason = KSP_CONVERGED_ITS;
+    PetscFunctionReturn(0);
+  }
+  ierr = MatGetNullSpace(mat,&nullsp);CHKERRQ(ierr);
+  ierr = MatGetTransposeNullSpace(pmat,&tnullsp);CHKERRQ(ierr);
+  /* the block methods test each column as KSPConvergedDefault() does relative to its initial residual */
+  if (ksp->converged == KSPConvergedDefault) {
+    KSPConvergedDefaultCtx *cctx = (KSPConvergedDefaultCtx*)ksp->cnvP;
+
+    defaultconv = (PetscBool)((ksp->guess_zero || (cctx && cctx->initialrtol)) && ksp->chknorm < 0);
+  }
+  if (!ksp->ops->matsolve || !defaultconv || ksp->dscale || nullsp || tnullsp || ksp->guess || ksp->guess_knoll || ksp->presolve || ksp->postsolve || ksp->pc->ops->presolve || ksp->pc->ops->postsolve) {
+    ierr = KSPMatSolveColumns(ksp,B,X);CHKERRQ(ierr);
+  } else {
+    ierr = PetscLogEventBegin(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+    if (ksp->res_hist_reset) ksp->res_hist_len = 0;
+    ksp->its    = 0;
+    ksp->reason = KSP_CONVERGED_ITERATING;
+    ierr = (*ksp->ops->matsolve)(ksp,B,X);CHKERRQ(ierr);
+    if (!ksp->reason) SETERRQ(comm,PETSC_ERR_PLIB,"Internal error, solver returned without setting converged reason");
+    ksp->totalits += ksp->its;
+    ierr = KSPReasonViewFromOptions(ksp);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+  }
+  if (ksp->errorifnotconverged && ksp->reason < 0) SETERRQ(comm,PETSC_ERR_NOT_CONVERGED,"KSPMatSolve has not converged");
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "KSPReset"
 /*@
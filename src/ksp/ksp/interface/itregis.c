@@ -39,10 +39,13 @@ PETSC_EXTERN PetscErrorCode KSPCreate_PIPEGCR(KSP);
 PETSC_EXTERN PetscErrorCode KSPCreate_PGMRES(KSP);
 #if !defined(PETSC_USE_COMPLEX)
 PETSC_EXTERN PetscErrorCode KSPCreate_DGMRES(KSP);
+PETSC_EXTERN PetscErrorCode KSPCreate_GCRODR(KSP);
 #endif
 PETSC_EXTERN PetscErrorCode KSPCreate_TSIRM(KSP);
 PETSC_EXTERN PetscErrorCode KSPCreate_CGLS(KSP);
 PETSC_EXTERN PetscErrorCode KSPCreate_FETIDP(KSP);
+PETSC_EXTERN PetscErrorCode KSPCreate_SGMRES(KSP);
+PETSC_EXTERN PetscErrorCode KSPCreate_SCG(KSP);
 
 /*
     This is used by KSPSetType() to make sure that at least one
@@ -110,10 +113,13 @@ PetscErrorCode  KSPRegisterAll(void)
   ierr = KSPRegister(KSPPGMRES,      KSPCreate_PGMRES);CHKERRQ(ierr);
 #if !defined(PETSC_USE_COMPLEX)
   ierr = KSPRegister(KSPDGMRES,      KSPCreate_DGMRES);CHKERRQ(ierr);
+  ierr = KSPRegister(KSPGCRODR,      KSPCreate_GCRODR);CHKERRQ(ierr);
 #endif
   ierr = KSPRegister(KSPTSIRM,       KSPCreate_TSIRM);CHKERRQ(ierr);
   ierr = KSPRegister(KSPCGLS,        KSPCreate_CGLS);CHKERRQ(ierr);
   ierr = KSPRegister(KSPFETIDP,      KSPCreate_FETIDP);CHKERRQ(ierr);
+  ierr = KSPRegister(KSPSGMRES,      KSPCreate_SGMRES);CHKERRQ(ierr);
+  ierr = KSPRegister(KSPSCG,         KSPCreate_SCG);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
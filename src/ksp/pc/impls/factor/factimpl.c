@@ -170,6 +170,17 @@ PetscErrorCode  PCFactorSetPivotInBlocks_Factor(PC pc,PetscBool pivot)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCFactorSetUseSinglePrecision_Factor"
+PetscErrorCode  PCFactorSetUseSinglePrecision_Factor(PC pc,PetscBool flg)
+{
+  PC_Factor *dir = (PC_Factor*)pc->data;
+
+  PetscFunctionBegin;
+  dir->usesingle = flg;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCFactorGetMatrix_Factor"
 PetscErrorCode  PCFactorGetMatrix_Factor(PC pc,Mat *mat)
@@ -260,6 +271,11 @@ PetscErrorCode  PCSetFromOptions_Factor(PetscOptionItems *PetscOptionsObject,PC
     ierr = PCFactorSetPivotInBlocks(pc,flg);CHKERRQ(ierr);
   }
 
+  ierr = PetscOptionsBool("-pc_factor_single_precision","Use single precision values of the factor in MatSolve()","PCFactorSetUseSinglePrecision",((PC_Factor*)factor)->usesingle,&flg,&set);CHKERRQ(ierr);
+  if (set) {
+    ierr = PCFactorSetUseSinglePrecision(pc,flg);CHKERRQ(ierr);
+  }
+
   ierr = PetscOptionsBool("-pc_factor_reuse_fill","Use fill from previous factorization","PCFactorSetReuseFill",PETSC_FALSE,&flg,&set);CHKERRQ(ierr);
   if (set) {
     ierr = PCFactorSetReuseFill(pc,flg);CHKERRQ(ierr);
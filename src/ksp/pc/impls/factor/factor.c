@@ -597,6 +597,48 @@ PetscErrorCode  PCFactorSetPivotInBlocks(PC pc,PetscBool pivot)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCFactorSetUseSinglePrecision"
+/*@
+   PCFactorSetUseSinglePrecision - Keeps a single precision copy of the values of the factor that is used
+   by MatSolve(), while the Krylov method and the vectors stay in double precision.
+
+   Logically Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  flg - PETSC_TRUE to use the single precision values, PETSC_FALSE to use the double precision values (default)
+
+   Options Database Key:
+.  -pc_factor_single_precision <true,false> - Activate/deactivate the single precision values
+
+   Notes:
+   Applying the factor is limited by the memory bandwidth; with single precision values the triangular solves
+   read 8 instead of 12 bytes per nonzero (with 32 bit indices). The factorization itself is done in double precision
+   and the solves accumulate in double precision, so the preconditioner only changes by the rounding of
+   the values, a relative error of about 1.e-7, which is below what an incomplete factorization neglects anyway.
+
+   Currently this is only supported for the LU and ILU factorizations of MATSOLVERPETSC with
+   MATSEQAIJ matrices, for example the subdomain solves of PCBJACOBI and PCASM with -sub_pc_factor_single_precision,
+   and requires PETSc configured with real double precision scalars; otherwise it is ignored.
+
+   Level: intermediate
+
+.keywords: PC, factorization, single precision, mixed precision
+
+.seealso: MatAIJSetSinglePrecision(), PCMGSetUseSinglePrecision()
+@*/
+PetscErrorCode  PCFactorSetUseSinglePrecision(PC pc,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveBool(pc,flg,2);
+  ierr = PetscTryMethod(pc,"PCFactorSetUseSinglePrecision_C",(PC,PetscBool),(pc,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCFactorSetReuseFill"
 /*@
@@ -12,6 +12,7 @@ typedef struct {
   MatOrderingType  ordering;          /* matrix reordering */
   MatSolverPackage solvertype;
   MatFactorType    factortype;
+  PetscBool        usesingle;         /* the factor keeps single precision values for MatSolve() */
 } PC_Factor;
 
 PETSC_INTERN PetscErrorCode PCFactorGetMatrix_Factor(PC,Mat*);
@@ -31,6 +32,7 @@ PETSC_INTERN PetscErrorCode PCFactorSetMatSolverPackage_Factor(PC,const MatSolve
 PETSC_INTERN PetscErrorCode PCFactorSetUpMatSolverPackage_Factor(PC);
 PETSC_INTERN PetscErrorCode PCFactorGetMatSolverPackage_Factor(PC,const MatSolverPackage*);
 PETSC_INTERN PetscErrorCode PCFactorSetColumnPivot_Factor(PC,PetscReal);
+PETSC_INTERN PetscErrorCode PCFactorSetUseSinglePrecision_Factor(PC,PetscBool);
 PETSC_INTERN PetscErrorCode PCSetFromOptions_Factor(PetscOptionItems *PetscOptionsObject,PC);
 PETSC_INTERN PetscErrorCode PCView_Factor(PC,PetscViewer);
 
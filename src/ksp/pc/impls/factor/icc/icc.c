@@ -173,7 +173,9 @@ PetscErrorCode  PCFactorGetUseInPlace_ICC(PC pc,PetscBool *flg)
 .  -pc_factor_in_place - only for ICC(0) with natural ordering, reuses the space of the matrix for
                       its factorization (overwrites original matrix)
 .  -pc_factor_fill <nfill> - expected amount of fill in factored matrix compared to original matrix, nfill > 1
--  -pc_factor_mat_ordering_type <natural,nd,1wd,rcm,qmd> - set the row/column ordering of the factored matrix
+.  -pc_factor_mat_ordering_type <natural,nd,1wd,rcm,qmd> - set the row/column ordering of the factored matrix
+-  -mat_solve_levels - for AIJ and SBAIJ matrices with block size one, apply the factor with OpenMP threads processing
+                       independent rows level by level (see -mat_solve_levels_threads)
 
    Level: beginner
 
@@ -163,6 +163,7 @@ static PetscErrorCode PCSetUp_LU(PC pc)
       PetscFunctionReturn(0);
     }
 
+    ierr = MatAIJSetSinglePrecision(((PC_Factor*)dir)->fact,((PC_Factor*)dir)->usesingle);CHKERRQ(ierr);
     ierr = MatLUFactorNumeric(((PC_Factor*)dir)->fact,pc->pmat,&((PC_Factor*)dir)->info);CHKERRQ(ierr);
     ierr = MatFactorGetError(((PC_Factor*)dir)->fact,&err);CHKERRQ(ierr);
     if (err) { /* FactorNumeric() fails */
@@ -364,6 +365,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_LU(PC pc)
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCFactorSetReuseFill_C",PCFactorSetReuseFill_LU);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCFactorSetColumnPivot_C",PCFactorSetColumnPivot_Factor);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCFactorSetPivotInBlocks_C",PCFactorSetPivotInBlocks_Factor);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCFactorSetUseSinglePrecision_C",PCFactorSetUseSinglePrecision_Factor);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCFactorReorderForNonzeroDiagonal_C",PCFactorReorderForNonzeroDiagonal_LU);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
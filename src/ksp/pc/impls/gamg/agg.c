@@ -1181,6 +1181,65 @@ static PetscErrorCode PCGAMGProlongator_AGG(PC pc,Mat Amat,Mat Gmat,PetscCoarsen
   PetscFunctionReturn(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*
+   PCGAMGSmoothEstimate_AGG - estimate of the largest eigenvalue of the Jacobi preconditioned operator, for the smoothing of P0
+
+  Input Parameter:
+   . pc - this
+   . Amat - matrix on this fine level
+ Output Parameter:
+   . a_emax - the estimate
+*/
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGSmoothEstimate_AGG"
+static PetscErrorCode PCGAMGSmoothEstimate_AGG(PC pc,Mat Amat,PetscReal *a_emax)
+{
+  PetscErrorCode ierr;
+  PC_MG          *mg          = (PC_MG*)pc->data;
+  PC_GAMG        *pc_gamg     = (PC_GAMG*)mg->innerctx;
+  MPI_Comm       comm;
+  KSP            eksp;
+  Vec            bb, xx;
+  PC             epc;
+  PetscReal      emin;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)Amat,&comm);CHKERRQ(ierr);
+  ierr = MatCreateVecs(Amat, &bb, 0);CHKERRQ(ierr);
+  ierr = MatCreateVecs(Amat, &xx, 0);CHKERRQ(ierr);
+  ierr = VecSetRandom(bb,pc_gamg->random);CHKERRQ(ierr);
+
+  ierr = KSPCreate(comm,&eksp);CHKERRQ(ierr);
+  ierr = KSPSetErrorIfNotConverged(eksp,pc->erroriffailure);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(eksp,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT,10);CHKERRQ(ierr);
+  ierr = KSPSetNormType(eksp, KSP_NORM_NONE);CHKERRQ(ierr);
+  ierr = KSPSetOptionsPrefix(eksp,((PetscObject)pc)->prefix);CHKERRQ(ierr);
+  ierr = KSPAppendOptionsPrefix(eksp, "gamg_est_");CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(eksp);CHKERRQ(ierr);
+
+  ierr = KSPSetInitialGuessNonzero(eksp, PETSC_FALSE);CHKERRQ(ierr);
+  ierr = KSPSetOperators(eksp, Amat, Amat);CHKERRQ(ierr);
+  ierr = KSPSetComputeSingularValues(eksp,PETSC_TRUE);CHKERRQ(ierr);
+
+  ierr = KSPGetPC(eksp, &epc);CHKERRQ(ierr);
+  ierr = PCSetType(epc, PCJACOBI);CHKERRQ(ierr);  /* smoother in smoothed agg. */
+
+  /* solve - keep stuff out of logging */
+  ierr = PetscLogEventDeactivate(KSP_Solve);CHKERRQ(ierr);
+  ierr = PetscLogEventDeactivate(PC_Apply);CHKERRQ(ierr);
+  ierr = KSPSolve(eksp, bb, xx);CHKERRQ(ierr);
+  ierr = PetscLogEventActivate(KSP_Solve);CHKERRQ(ierr);
+  ierr = PetscLogEventActivate(PC_Apply);CHKERRQ(ierr);
+
+  ierr = KSPComputeExtremeSingularValues(eksp, a_emax, &emin);CHKERRQ(ierr);
+  ierr = PetscInfo3(pc,"Smooth P0: max eigen=%e min=%e PC=%s\n",*a_emax,emin,PCJACOBI);CHKERRQ(ierr);
+  ierr = VecDestroy(&xx);CHKERRQ(ierr);
+  ierr = VecDestroy(&bb);CHKERRQ(ierr);
+  ierr = KSPDestroy(&eksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* -------------------------------------------------------------------------- */
 /*
    PCGAMGOptProlongator_AGG
@@ -1190,6 +1249,9 @@ static PetscErrorCode PCGAMGProlongator_AGG(PC pc,Mat Amat,Mat Gmat,PetscCoarsen
    . Amat - matrix on this fine level
  In/Output Parameter:
    . a_P - prolongation operator to the next level
+
+   With reuse_coarsening each smoothed prolongator keeps the one it was computed from, composed as "PCGAMGSmoothedFrom",
+   for PCGAMGOptProlongatorNumeric_AGG().
 */
 #undef __FUNCT__
 #define __FUNCT__ "PCGAMGOptProlongator_AGG"
@@ -1201,49 +1263,14 @@ static PetscErrorCode PCGAMGOptProlongator_AGG(PC pc,Mat Amat,Mat *a_P)
   PC_GAMG_AGG    *pc_gamg_agg = (PC_GAMG_AGG*)pc_gamg->subctx;
   PetscInt       jj;
   Mat            Prol  = *a_P;
-  MPI_Comm       comm;
-  KSP            eksp;
-  Vec            bb, xx;
-  PC             epc;
-  PetscReal      alpha, emax, emin;
+  PetscReal      alpha, emax;
 
   PetscFunctionBegin;
-  ierr = PetscObjectGetComm((PetscObject)Amat,&comm);CHKERRQ(ierr);
   ierr = PetscLogEventBegin(PC_GAMGOptProlongator_AGG,0,0,0,0);CHKERRQ(ierr);
 
   /* compute maximum value of operator to be used in smoother */
   if (0 < pc_gamg_agg->nsmooths) {
-    ierr = MatCreateVecs(Amat, &bb, 0);CHKERRQ(ierr);
-    ierr = MatCreateVecs(Amat, &xx, 0);CHKERRQ(ierr);
-    ierr = VecSetRandom(bb,pc_gamg->random);CHKERRQ(ierr);
-
-    ierr = KSPCreate(comm,&eksp);CHKERRQ(ierr);
-    ierr = KSPSetErrorIfNotConverged(eksp,pc->erroriffailure);CHKERRQ(ierr);
-    ierr = KSPSetTolerances(eksp,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT,10);CHKERRQ(ierr);
-    ierr = KSPSetNormType(eksp, KSP_NORM_NONE);CHKERRQ(ierr);
-    ierr = KSPSetOptionsPrefix(eksp,((PetscObject)pc)->prefix);CHKERRQ(ierr);
-    ierr = KSPAppendOptionsPrefix(eksp, "gamg_est_");CHKERRQ(ierr);
-    ierr = KSPSetFromOptions(eksp);CHKERRQ(ierr);
-
-    ierr = KSPSetInitialGuessNonzero(eksp, PETSC_FALSE);CHKERRQ(ierr);
-    ierr = KSPSetOperators(eksp, Amat, Amat);CHKERRQ(ierr);
-    ierr = KSPSetComputeSingularValues(eksp,PETSC_TRUE);CHKERRQ(ierr);
-
-    ierr = KSPGetPC(eksp, &epc);CHKERRQ(ierr);
-    ierr = PCSetType(epc, PCJACOBI);CHKERRQ(ierr);  /* smoother in smoothed agg. */
-
-    /* solve - keep stuff out of logging */
-    ierr = PetscLogEventDeactivate(KSP_Solve);CHKERRQ(ierr);
-    ierr = PetscLogEventDeactivate(PC_Apply);CHKERRQ(ierr);
-    ierr = KSPSolve(eksp, bb, xx);CHKERRQ(ierr);
-    ierr = PetscLogEventActivate(KSP_Solve);CHKERRQ(ierr);
-    ierr = PetscLogEventActivate(PC_Apply);CHKERRQ(ierr);
-
-    ierr = KSPComputeExtremeSingularValues(eksp, &emax, &emin);CHKERRQ(ierr);
-    ierr = PetscInfo3(pc,"Smooth P0: max eigen=%e min=%e PC=%s\n",emax,emin,PCJACOBI);CHKERRQ(ierr);
-    ierr = VecDestroy(&xx);CHKERRQ(ierr);
-    ierr = VecDestroy(&bb);CHKERRQ(ierr);
-    ierr = KSPDestroy(&eksp);CHKERRQ(ierr);
+    ierr = PCGAMGSmoothEstimate_AGG(pc,Amat,&emax);CHKERRQ(ierr);
   }
 
   /* smooth P0 */
@@ -1264,6 +1291,9 @@ static PetscErrorCode PCGAMGOptProlongator_AGG(PC pc,Mat Amat,Mat *a_P)
     ierr  = VecDestroy(&diag);CHKERRQ(ierr);
     alpha = -1.4/emax;
     ierr  = MatAYPX(tMat, alpha, Prol, SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+    if (pc_gamg->reuse_coarsening) {
+      ierr = PetscObjectCompose((PetscObject)tMat,"PCGAMGSmoothedFrom",(PetscObject)Prol);CHKERRQ(ierr);
+    }
     ierr  = MatDestroy(&Prol);CHKERRQ(ierr);
     Prol  = tMat;
 #if defined PETSC_GAMG_USE_LOG
@@ -1275,6 +1305,60 @@ static PetscErrorCode PCGAMGOptProlongator_AGG(PC pc,Mat Amat,Mat *a_P)
   PetscFunctionReturn(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*
+   PCGAMGOptProlongatorNumeric_AGG - recomputes, in place, the smoothing of a prolongator created by
+   PCGAMGOptProlongator_AGG() with reuse_coarsening, for new values of the matrix with the same nonzero pattern
+
+  Input Parameter:
+   . pc - this
+   . Amat - matrix on this fine level
+   . Prol - the smoothed prolongator
+*/
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGOptProlongatorNumeric_AGG"
+static PetscErrorCode PCGAMGOptProlongatorNumeric_AGG(PC pc,Mat Amat,Mat Prol)
+{
+  PetscErrorCode ierr;
+  Mat            *chain,P0;
+  PetscInt       jj,n = 0;
+  Vec            diag;
+  PetscReal      alpha, emax;
+
+  PetscFunctionBegin;
+  /* the prolongators from Prol back to the tentative one */
+  for (P0=Prol; P0; n++) {
+    ierr = PetscObjectQuery((PetscObject)P0,"PCGAMGSmoothedFrom",(PetscObject*)&P0);CHKERRQ(ierr);
+  }
+  if (n == 1) PetscFunctionReturn(0);
+  ierr = PetscMalloc1(n, &chain);CHKERRQ(ierr);
+  for (P0=Prol, jj=0; P0; jj++) {
+    chain[jj] = P0;
+    ierr = PetscObjectQuery((PetscObject)P0,"PCGAMGSmoothedFrom",(PetscObject*)&P0);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventBegin(PC_GAMGOptProlongator_AGG,0,0,0,0);CHKERRQ(ierr);
+  ierr = PCGAMGSmoothEstimate_AGG(pc,Amat,&emax);CHKERRQ(ierr);
+  ierr = MatCreateVecs(Amat, &diag, 0);CHKERRQ(ierr);
+  ierr = MatGetDiagonal(Amat, diag);CHKERRQ(ierr);
+  ierr = VecReciprocal(diag);CHKERRQ(ierr);
+  alpha = -1.4/emax;
+  for (jj = n-2; jj >= 0; jj--) {
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventBegin(petsc_gamg_setup_events[SET9],0,0,0,0);CHKERRQ(ierr);
+#endif
+    ierr = MatMatMult(Amat, chain[jj+1], MAT_REUSE_MATRIX, PETSC_DEFAULT, &chain[jj]);CHKERRQ(ierr);
+    ierr = MatDiagonalScale(chain[jj], diag, 0);CHKERRQ(ierr);
+    ierr = MatAYPX(chain[jj], alpha, chain[jj+1], SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventEnd(petsc_gamg_setup_events[SET9],0,0,0,0);CHKERRQ(ierr);
+#endif
+  }
+  ierr = VecDestroy(&diag);CHKERRQ(ierr);
+  ierr = PetscFree(chain);CHKERRQ(ierr);
+  ierr = PetscLogEventEnd(PC_GAMGOptProlongator_AGG,0,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* -------------------------------------------------------------------------- */
 /*
    PCCreateGAMG_AGG
@@ -1301,12 +1385,13 @@ PetscErrorCode  PCCreateGAMG_AGG(PC pc)
   /* reset does not do anything; setup not virtual */
 
   /* set internal function pointers */
-  pc_gamg->ops->graph             = PCGAMGGraph_AGG;
-  pc_gamg->ops->coarsen           = PCGAMGCoarsen_AGG;
-  pc_gamg->ops->prolongator       = PCGAMGProlongator_AGG;
-  pc_gamg->ops->optprolongator    = PCGAMGOptProlongator_AGG;
-  pc_gamg->ops->createdefaultdata = PCSetData_AGG;
-  pc_gamg->ops->view              = PCView_GAMG_AGG;
+  pc_gamg->ops->graph                 = PCGAMGGraph_AGG;
+  pc_gamg->ops->coarsen               = PCGAMGCoarsen_AGG;
+  pc_gamg->ops->prolongator           = PCGAMGProlongator_AGG;
+  pc_gamg->ops->optprolongator        = PCGAMGOptProlongator_AGG;
+  pc_gamg->ops->optprolongatornumeric = PCGAMGOptProlongatorNumeric_AGG;
+  pc_gamg->ops->createdefaultdata     = PCSetData_AGG;
+  pc_gamg->ops->view                  = PCView_GAMG_AGG;
 
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetNSmooths_C",PCGAMGSetNSmooths_AGG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetSymGraph_C",PCGAMGSetSymGraph_AGG);CHKERRQ(ierr);
@@ -19,7 +19,9 @@ PetscLogEvent PC_GAMGProlongator_GEO;
 PetscLogEvent PC_GAMGOptProlongator_AGG;
 #endif
 
-#define GAMG_MAXLEVELS 30
+#if defined PETSC_GAMG_USE_LOG
+static PetscLogEvent gamg_numeric_events[GAMG_MAXLEVELS]; /* rebuild of each level with PCGAMGSetReuseCoarsening() */
+#endif
 
 /* #define GAMG_STAGES */
 #if (defined PETSC_GAMG_USE_LOG && defined GAMG_STAGES)
@@ -30,6 +32,29 @@ static PetscFunctionList GAMGList = 0;
 static PetscBool PCGAMGPackageInitialized;
 
 /* ----------------------------------------------------------------------------- */
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGResetCoarsening_Private"
+/*
+   PCGAMGResetCoarsening_Private - drops the hierarchy kept for numeric rebuilds with PCGAMGSetReuseCoarsening()
+*/
+static PetscErrorCode PCGAMGResetCoarsening_Private(PC pc)
+{
+  PetscErrorCode ierr;
+  PC_MG          *mg      = (PC_MG*)pc->data;
+  PC_GAMG        *pc_gamg = (PC_GAMG*)mg->innerctx;
+  PetscInt       level;
+
+  PetscFunctionBegin;
+  for (level=0; level<GAMG_MAXLEVELS; level++) {
+    ierr = MatDestroy(&pc_gamg->cached_P[level]);CHKERRQ(ierr);
+    ierr = MatDestroy(&pc_gamg->cached_PtAP[level]);CHKERRQ(ierr);
+    ierr = ISDestroy(&pc_gamg->cached_perm[level]);CHKERRQ(ierr);
+  }
+  pc_gamg->cached_nlevels = 0;
+  pc_gamg->cached_pmat_id = 0;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCReset_GAMG"
 PetscErrorCode PCReset_GAMG(PC pc)
@@ -42,6 +67,7 @@ PetscErrorCode PCReset_GAMG(PC pc)
   if (pc_gamg->data) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_PLIB,"This should not happen, cleaned up in SetUp\n");
   pc_gamg->data_sz = 0;
   ierr = PetscFree(pc_gamg->orig_data);CHKERRQ(ierr);
+  ierr = PCGAMGResetCoarsening_Private(pc);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -102,6 +128,16 @@ static PetscErrorCode PCGAMGCreateLevel_GAMG(PC pc,Mat Amat_fine,PetscInt cr_bs,
 
   if (Pcolumnperm) *Pcolumnperm = NULL;
 
+  /* keep the product and the prolongator it was computed with for numeric rebuilds */
+  if (pc_gamg->reuse_coarsening) {
+    ierr = PetscObjectReference((PetscObject)Cmat);CHKERRQ(ierr);
+    ierr = MatDestroy(&pc_gamg->cached_PtAP[pc_gamg->current_level]);CHKERRQ(ierr);
+    pc_gamg->cached_PtAP[pc_gamg->current_level] = Cmat;
+    ierr = PetscObjectReference((PetscObject)Pold);CHKERRQ(ierr);
+    ierr = MatDestroy(&pc_gamg->cached_P[pc_gamg->current_level]);CHKERRQ(ierr);
+    pc_gamg->cached_P[pc_gamg->current_level] = Pold;
+  }
+
   if (!pc_gamg->repart && new_size==nactive) *a_Amat_crs = Cmat; /* output - no repartitioning or reduction - could bail here */
   else {
     PetscInt       *counts,*newproc_idx,ii,jj,kk,strideNew,*tidx,ncrs_new,ncrs_eq_new,nloc_old;
@@ -403,6 +439,57 @@ static PetscErrorCode PCGAMGCreateLevel_GAMG(PC pc,Mat Amat_fine,PetscInt cr_bs,
   PetscFunctionReturn(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*
+   PCGAMGSetUpNumeric_Private - rebuilds the hierarchy kept with PCGAMGSetReuseCoarsening() for new values of the
+   matrix: the aggregates, the patterns of the prolongators and the symbolic Galerkin products are kept, only
+   the smoothing of the prolongators and the Galerkin products are recomputed, and the coarse equations are
+   moved to the processes of the first setup.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGSetUpNumeric_Private"
+static PetscErrorCode PCGAMGSetUpNumeric_Private(PC pc)
+{
+  PetscErrorCode ierr;
+  PC_MG          *mg       = (PC_MG*)pc->data;
+  PC_GAMG        *pc_gamg  = (PC_GAMG*)mg->innerctx;
+  PC_MG_Levels   **mglevels = mg->levels;
+  Mat            A = pc->pmat,Acrs,P;
+  IS             findices;
+  PetscInt       level,lidx,Istart,Iend,f_bs;
+
+  PetscFunctionBegin;
+  for (level=0; level<pc_gamg->cached_nlevels-1; level++) {
+    lidx = pc_gamg->cached_nlevels-1-level; /* the PCMG index of this level */
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventBegin(gamg_numeric_events[level],0,0,0,0);CHKERRQ(ierr);
+#endif
+    pc_gamg->current_level = level;
+    if (pc_gamg->ops->optprolongatornumeric) {
+      ierr = (*pc_gamg->ops->optprolongatornumeric)(pc,A,pc_gamg->cached_P[level]);CHKERRQ(ierr);
+    }
+    ierr = MatPtAP(A,pc_gamg->cached_P[level],MAT_REUSE_MATRIX,2.0,&pc_gamg->cached_PtAP[level]);CHKERRQ(ierr);
+    if (pc_gamg->cached_perm[level]) {
+      ierr = KSPGetOperators(mglevels[lidx-1]->smoothd,NULL,&Acrs);CHKERRQ(ierr);
+      ierr = MatGetSubMatrix(pc_gamg->cached_PtAP[level],pc_gamg->cached_perm[level],pc_gamg->cached_perm[level],MAT_REUSE_MATRIX,&Acrs);CHKERRQ(ierr);
+      ierr = PCMGGetInterpolation(pc,lidx,&P);CHKERRQ(ierr);
+      ierr = MatGetOwnershipRange(pc_gamg->cached_P[level],&Istart,&Iend);CHKERRQ(ierr);
+      ierr = MatGetBlockSize(A,&f_bs);CHKERRQ(ierr);
+      ierr = ISCreateStride(PetscObjectComm((PetscObject)A),Iend-Istart,Istart,1,&findices);CHKERRQ(ierr);
+      ierr = ISSetBlockSize(findices,f_bs);CHKERRQ(ierr);
+      ierr = MatGetSubMatrix(pc_gamg->cached_P[level],findices,pc_gamg->cached_perm[level],MAT_REUSE_MATRIX,&P);CHKERRQ(ierr);
+      ierr = ISDestroy(&findices);CHKERRQ(ierr);
+    } else Acrs = pc_gamg->cached_PtAP[level];
+    /* (re)set to get dirty flag */
+    ierr = KSPSetOperators(mglevels[lidx-1]->smoothd,Acrs,Acrs);CHKERRQ(ierr);
+    A    = Acrs;
+#if defined PETSC_GAMG_USE_LOG
+    ierr = PetscLogEventEnd(gamg_numeric_events[level],0,0,0,0);CHKERRQ(ierr);
+#endif
+  }
+  PetscFunctionReturn(0);
+}
+
 /* -------------------------------------------------------------------------- */
 /*
    PCSetUp_GAMG - Prepares for the use of the GAMG preconditioner
@@ -434,8 +521,21 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
 
   if (pc_gamg->setup_count++ > 0) {
+    if (pc_gamg->cached_nlevels && !pc_gamg->reuse_prol) {
+      PetscObjectId id;
+
+      ierr = PetscObjectGetId((PetscObject)Pmat,&id);CHKERRQ(ierr);
+      if (pc->flag == SAME_NONZERO_PATTERN && id == pc_gamg->cached_pmat_id && (!pc_gamg->ops->optprolongator || pc_gamg->ops->optprolongatornumeric)) {
+        ierr = PetscInfo1(pc,"Numeric rebuild of the %D levels with the kept coarsening\n",pc_gamg->cached_nlevels);CHKERRQ(ierr);
+        ierr = PCGAMGSetUpNumeric_Private(pc);CHKERRQ(ierr);
+        ierr = PCSetUp_MG(pc);CHKERRQ(ierr);
+        PetscFunctionReturn(0);
+      }
+      ierr = PetscInfo(pc,"New matrix or nonzero pattern, or no numeric rebuild for this GAMG type; the coarsening is recomputed\n");CHKERRQ(ierr);
+    }
     if ((PetscBool)(!pc_gamg->reuse_prol)) {
       /* reset everything */
+      ierr = PCGAMGResetCoarsening_Private(pc);CHKERRQ(ierr);
       ierr = PCReset_MG(pc);CHKERRQ(ierr);
       pc->setupcalled = 0;
     } else {
@@ -561,7 +661,7 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
     ierr = PetscLogEventBegin(petsc_gamg_setup_events[SET2],0,0,0,0);CHKERRQ(ierr);
 #endif
 
-    ierr = pc_gamg->ops->createlevel(pc, Aarr[level], bs,&Parr[level1], &Aarr[level1], &nactivepe, NULL);CHKERRQ(ierr);
+    ierr = pc_gamg->ops->createlevel(pc, Aarr[level], bs,&Parr[level1], &Aarr[level1], &nactivepe, pc_gamg->reuse_coarsening ? &pc_gamg->cached_perm[level] : NULL);CHKERRQ(ierr);
 
 #if defined PETSC_GAMG_USE_LOG
     ierr = PetscLogEventEnd(petsc_gamg_setup_events[SET2],0,0,0,0);CHKERRQ(ierr);
@@ -585,6 +685,10 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
 
   ierr = PetscInfo2(pc,"%D levels, grid complexity = %g\n",level+1,nnztot/nnz0);CHKERRQ(ierr);
   pc_gamg->Nlevels = level + 1;
+  if (pc_gamg->reuse_coarsening) {
+    pc_gamg->cached_nlevels = pc_gamg->Nlevels;
+    ierr = PetscObjectGetId((PetscObject)Pmat,&pc_gamg->cached_pmat_id);CHKERRQ(ierr);
+  }
   fine_level       = level;
   ierr             = PCMGSetLevels(pc,pc_gamg->Nlevels,NULL);CHKERRQ(ierr);
 
@@ -883,6 +987,59 @@ static PetscErrorCode PCGAMGSetReuseInterpolation_GAMG(PC pc, PetscBool n)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGSetReuseCoarsening"
+/*@
+   PCGAMGSetReuseCoarsening - Keep the coarsening, the patterns of the prolongators and the symbolic Galerkin products
+   so that rebuilding the preconditioner for new values of the matrix, with the same nonzero pattern, is numeric only
+
+   Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  n - PETSC_TRUE or PETSC_FALSE
+
+   Options Database Key:
+.  -pc_gamg_reuse_coarsening <true,false>
+
+   Notes: A rebuild recomputes the smoothing of the prolongators and the Galerkin products in place, the graph, the aggregates
+   and the repartitioning of the coarse grids are those of the first setup. The coarsening is recomputed when the matrix passed
+   to the preconditioner is a different one or its nonzero pattern has changed. The cost of the rebuild of each level is logged
+   in the events "GAMG: numeric L<level>" of -log_view.
+
+   Unlike PCGAMGSetReuseInterpolation(), which keeps the prolongators, this updates the prolongators for the new values.
+   Only the types whose prolongator smoothing has a numeric rebuild, PCGAMGAGG and PCGAMGGEO, reuse the coarsening; with
+   PCGAMGCLASSICAL the hierarchy is rebuilt from scratch.
+
+   Level: intermediate
+
+   Concepts: Unstructured multigrid preconditioner
+
+.seealso: PCGAMGSetReuseInterpolation(), PCSetReusePreconditioner()
+@*/
+PetscErrorCode PCGAMGSetReuseCoarsening(PC pc, PetscBool n)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveBool(pc,n,2);
+  ierr = PetscTryMethod(pc,"PCGAMGSetReuseCoarsening_C",(PC,PetscBool),(pc,n));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PCGAMGSetReuseCoarsening_GAMG"
+static PetscErrorCode PCGAMGSetReuseCoarsening_GAMG(PC pc, PetscBool n)
+{
+  PC_MG   *mg      = (PC_MG*)pc->data;
+  PC_GAMG *pc_gamg = (PC_GAMG*)mg->innerctx;
+
+  PetscFunctionBegin;
+  pc_gamg->reuse_coarsening = n;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCGAMGSetUseASMAggs"
 /*@
@@ -1103,6 +1260,7 @@ static PetscErrorCode PCGAMGSetType_GAMG(PC pc, PCGAMGType type)
     pc_gamg->orig_data_cell_rows = 0;
     ierr = PetscFree(pc_gamg->data);CHKERRQ(ierr);
     pc_gamg->data_sz = 0;
+    ierr = PCGAMGResetCoarsening_Private(pc);CHKERRQ(ierr);
   }
   ierr = PetscFree(pc_gamg->gamg_type_name);CHKERRQ(ierr);
   ierr = PetscStrallocpy(type,&pc_gamg->gamg_type_name);CHKERRQ(ierr);
@@ -1121,6 +1279,9 @@ static PetscErrorCode PCView_GAMG(PC pc,PetscViewer viewer)
   PetscFunctionBegin;
   ierr = PetscViewerASCIIPrintf(viewer,"    GAMG specific options\n");CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"      Threshold for dropping small values from graph %g\n",(double)pc_gamg->threshold);CHKERRQ(ierr);
+  if (pc_gamg->reuse_coarsening) {
+    ierr = PetscViewerASCIIPrintf(viewer,"      Coarsening kept for numeric rebuilds\n");CHKERRQ(ierr);
+  }
   if (pc_gamg->ops->view) {
     ierr = (*pc_gamg->ops->view)(pc,viewer);CHKERRQ(ierr);
   }
@@ -1150,6 +1311,7 @@ PetscErrorCode PCSetFromOptions_GAMG(PetscOptionItems *PetscOptionsObject,PC pc)
     }
     ierr = PetscOptionsBool("-pc_gamg_repartition","Repartion coarse grids","PCGAMGRepartitioning",pc_gamg->repart,&pc_gamg->repart,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsBool("-pc_gamg_reuse_interpolation","Reuse prolongation operator","PCGAMGReuseInterpolation",pc_gamg->reuse_prol,&pc_gamg->reuse_prol,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsBool("-pc_gamg_reuse_coarsening","Keep the coarsening and symbolic products for numeric rebuilds","PCGAMGSetReuseCoarsening",pc_gamg->reuse_coarsening,&pc_gamg->reuse_coarsening,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsBool("-pc_gamg_use_agg_gasm","Use aggregation agragates for GASM smoother","PCGAMGUseASMAggs",pc_gamg->use_aggs_in_gasm,&pc_gamg->use_aggs_in_gasm,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsInt("-pc_gamg_process_eq_limit","Limit (goal) on number of equations per process on coarse grids","PCGAMGSetProcEqLim",pc_gamg->min_eq_proc,&pc_gamg->min_eq_proc,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsInt("-pc_gamg_coarse_eq_limit","Limit on number of equations for the coarse grid","PCGAMGSetCoarseEqLim",pc_gamg->coarse_eq_limit,&pc_gamg->coarse_eq_limit,NULL);CHKERRQ(ierr);
@@ -1189,7 +1351,7 @@ $       See the Users Manual Chapter 4 for more details
   Concepts: algebraic multigrid
 
 .seealso:  PCCreate(), PCSetType(), MatSetBlockSize(), PCMGType, PCSetCoordinates(), MatSetNearNullSpace(), PCGAMGSetType(), PCGAMGAGG, PCGAMGGEO, PCGAMGCLASSICAL, PCGAMGSetProcEqLim(),
-           PCGAMGSetCoarseEqLim(), PCGAMGSetRepartitioning(), PCGAMGRegister(), PCGAMGSetReuseInterpolation(), PCGAMGSetUseASMAggs(), PCGAMGSetNlevels(), PCGAMGSetThreshold(), PCGAMGGetType()
+           PCGAMGSetCoarseEqLim(), PCGAMGSetRepartitioning(), PCGAMGRegister(), PCGAMGSetReuseInterpolation(), PCGAMGSetReuseCoarsening(), PCGAMGSetUseASMAggs(), PCGAMGSetNlevels(), PCGAMGSetThreshold(), PCGAMGGetType()
 M*/
 
 #undef __FUNCT__
@@ -1232,6 +1394,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_GAMG(PC pc)
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetCoarseEqLim_C",PCGAMGSetCoarseEqLim_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetRepartitioning_C",PCGAMGSetRepartitioning_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetReuseInterpolation_C",PCGAMGSetReuseInterpolation_GAMG);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetReuseCoarsening_C",PCGAMGSetReuseCoarsening_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetUseASMAggs_C",PCGAMGSetUseASMAggs_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetThreshold_C",PCGAMGSetThreshold_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetType_C",PCGAMGSetType_GAMG);CHKERRQ(ierr);
@@ -1239,6 +1402,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_GAMG(PC pc)
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetNlevels_C",PCGAMGSetNlevels_GAMG);CHKERRQ(ierr);
   pc_gamg->repart           = PETSC_FALSE;
   pc_gamg->reuse_prol       = PETSC_FALSE;
+  pc_gamg->reuse_coarsening = PETSC_FALSE;
   pc_gamg->use_aggs_in_gasm = PETSC_FALSE;
   pc_gamg->min_eq_proc      = 50;
   pc_gamg->coarse_eq_limit  = 50;
@@ -1305,6 +1469,14 @@ PetscErrorCode PCGAMGInitializePackage(void)
   ierr = PetscLogEventRegister("  Invert-Sort", PC_CLASSID, &petsc_gamg_setup_events[SET13]);CHKERRQ(ierr);
   ierr = PetscLogEventRegister("  Move A", PC_CLASSID, &petsc_gamg_setup_events[SET14]);CHKERRQ(ierr);
   ierr = PetscLogEventRegister("  Move P", PC_CLASSID, &petsc_gamg_setup_events[SET15]);CHKERRQ(ierr);
+  {
+    char     str[32];
+    PetscInt lidx;
+    for (lidx=0; lidx<GAMG_MAXLEVELS; lidx++) {
+      ierr = PetscSNPrintf(str,sizeof(str),"GAMG: numeric L%D",lidx);CHKERRQ(ierr);
+      ierr = PetscLogEventRegister(str, PC_CLASSID, &gamg_numeric_events[lidx]);CHKERRQ(ierr);
+    }
+  }
 
   /* PetscLogEventRegister(" PL move data", PC_CLASSID, &petsc_gamg_setup_events[SET13]); */
   /* PetscLogEventRegister("GAMG: fix", PC_CLASSID, &petsc_gamg_setup_events[SET10]); */
@@ -389,6 +389,10 @@ PetscErrorCode PCSetFromOptions_MG(PetscOptionItems *PetscOptionsObject,PC pc)
   if (set) {
     ierr = PCMGSetGalerkin(pc,flg);CHKERRQ(ierr);
   }
+  ierr = PetscOptionsBool("-pc_mg_single_precision","Use single precision values in the operators of the coarser levels","PCMGSetUseSinglePrecision",mg->usesingle,&flg,&set);CHKERRQ(ierr);
+  if (set) {
+    ierr = PCMGSetUseSinglePrecision(pc,flg);CHKERRQ(ierr);
+  }
   ierr = PetscOptionsInt("-pc_mg_smoothup","Number of post-smoothing steps","PCMGSetNumberSmoothUp",mg->default_smoothu,&m,&flg);CHKERRQ(ierr);
   if (flg) {
     ierr = PCMGSetNumberSmoothUp(pc,m);CHKERRQ(ierr);
@@ -481,6 +485,9 @@ PetscErrorCode PCView_MG(PC pc,PetscViewer viewer)
     } else {
       ierr = PetscViewerASCIIPrintf(viewer,"    Not using Galerkin computed coarse grid matrices\n");CHKERRQ(ierr);
     }
+    if (mg->usesingle) {
+      ierr = PetscViewerASCIIPrintf(viewer,"    Using single precision values in the coarser grid matrices\n");CHKERRQ(ierr);
+    }
     if (mg->view){
       ierr = (*mg->view)(pc,viewer);CHKERRQ(ierr);
     }
@@ -772,6 +779,16 @@ PetscErrorCode PCSetUp_MG(PC pc)
     }
   }
 
+  if (mg->usesingle) {
+    /* not the finest level, its operator is also used by the outer Krylov method */
+    for (i=0; i<n-1; i++) {
+      Mat A,B;
+      ierr = KSPGetOperators(mglevels[i]->smoothd,&A,&B);CHKERRQ(ierr);
+      ierr = MatAIJSetSinglePrecision(A,PETSC_TRUE);CHKERRQ(ierr);
+      if (B != A) {ierr = MatAIJSetSinglePrecision(B,PETSC_TRUE);CHKERRQ(ierr);}
+    }
+  }
+
   for (i=1; i<n; i++) {
     if (mglevels[i]->smoothu == mglevels[i]->smoothd || mg->am == PC_MG_FULL || mg->am == PC_MG_KASKADE || mg->cyclesperpcapply > 1){
       /* if doing only down then initial guess is zero */
@@ -1094,6 +1111,45 @@ PetscErrorCode  PCMGGetGalerkin(PC pc,PetscBool  *galerkin)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCMGSetUseSinglePrecision"
+/*@
+   PCMGSetUseSinglePrecision - Keeps single precision copies of the values of the operators of all levels but
+   the finest, which are used by the smoothers and the residuals, while the vectors and the outer Krylov method
+   stay in double precision.
+
+   Logically Collective on PC
+
+   Input Parameters:
++  pc - the multigrid context
+-  flg - PETSC_TRUE to use the single precision values
+
+   Options Database Key:
+.  -pc_mg_single_precision <true,false>
+
+   Notes:
+   The smoothing and the residuals of the coarser levels are limited by the memory bandwidth, see MatAIJSetSinglePrecision(),
+   which only applies to MATSEQAIJ and MATMPIAIJ operators, for example those computed by PCGAMG and with -pc_mg_galerkin.
+   The coarse grid solver can use single precision values of its factor with -mg_coarse_pc_factor_single_precision, or
+   -mg_coarse_sub_pc_factor_single_precision for PCGAMG.
+
+   Level: intermediate
+
+.keywords: MG, set, single precision, mixed precision
+
+.seealso: MatAIJSetSinglePrecision(), PCFactorSetUseSinglePrecision()
+@*/
+PetscErrorCode PCMGSetUseSinglePrecision(PC pc,PetscBool flg)
+{
+  PC_MG *mg = (PC_MG*)pc->data;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveBool(pc,flg,2);
+  mg->usesingle = flg;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCMGSetNumberSmoothDown"
 /*@
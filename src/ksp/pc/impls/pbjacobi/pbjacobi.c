@@ -206,6 +206,32 @@ static PetscErrorCode PCApply_PBJacobi_7(PC pc,Vec x,Vec y)
   ierr = PetscLogFlops(80.0*m);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+#undef __FUNCT__
+#define __FUNCT__ "PCApply_PBJacobi_N"
+static PetscErrorCode PCApply_PBJacobi_N(PC pc,Vec x,Vec y)
+{
+  PC_PBJacobi       *jac = (PC_PBJacobi*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,j,k,m = jac->mbs,bs = jac->bs;
+  const MatScalar   *diag = jac->diag;
+  PetscScalar       *yy;
+  const PetscScalar *xx;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&yy);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    for (j=0; j<bs; j++) {
+      yy[bs*i+j] = 0.0;
+      for (k=0; k<bs; k++) yy[bs*i+j] += diag[j+bs*k]*xx[bs*i+k];
+    }
+    diag += bs*bs;
+  }
+  ierr = VecRestoreArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecRestoreArray(y,&yy);CHKERRQ(ierr);
+  ierr = PetscLogFlops((2.0*bs*bs-bs)*m);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
 /* -------------------------------------------------------------------------- */
 #undef __FUNCT__
 #define __FUNCT__ "PCSetUp_PBJacobi"
@@ -248,7 +274,8 @@ static PetscErrorCode PCSetUp_PBJacobi(PC pc)
     pc->ops->apply = PCApply_PBJacobi_7;
     break;
   default:
-    SETERRQ1(PetscObjectComm((PetscObject)pc),PETSC_ERR_SUP,"not supported for block size %D",jac->bs);
+    pc->ops->apply = PCApply_PBJacobi_N;
+    break;
   }
   PetscFunctionReturn(0);
 }
@@ -10,6 +10,7 @@ typedef struct {
   MatSORType sym;         /* forward, reverse, symmetric etc. */
   PetscReal  omega;
   PetscReal  fshift;
+  PetscBool  multicolor;  /* sweep the rows one color at a time with several threads */
 } PC_SOR;
 
 #undef __FUNCT__
@@ -33,6 +34,7 @@ static PetscErrorCode PCApply_SOR(PC pc,Vec x,Vec y)
   PetscReal      fshift;
 
   PetscFunctionBegin;
+  if (jac->multicolor) flag |= SOR_MULTICOLOR;
   fshift = (jac->fshift ? jac->fshift : pc->erroriffailure ? 0.0 : -1.0);
   ierr = MatSOR(pc->pmat,x,jac->omega,(MatSORType)flag,fshift,jac->its,jac->lits,y);CHKERRQ(ierr);
   ierr = MatFactorGetError(pc->pmat,(MatFactorError*)&pc->failedreason);CHKERRQ(ierr);
@@ -51,6 +53,7 @@ static PetscErrorCode PCApplyRichardson_SOR(PC pc,Vec b,Vec y,Vec w,PetscReal rt
   PetscFunctionBegin;
   ierr = PetscInfo1(pc,"Warning, convergence critera ignored, using %D iterations\n",its);CHKERRQ(ierr);
   if (guesszero) stype = (MatSORType) (stype | SOR_ZERO_INITIAL_GUESS);
+  if (jac->multicolor) stype = (MatSORType) (stype | SOR_MULTICOLOR);
   fshift = (jac->fshift ? jac->fshift : pc->erroriffailure ? 0.0 : -1.0);
   ierr = MatSOR(pc->pmat,b,jac->omega,stype,fshift,its*jac->its,jac->lits,y);CHKERRQ(ierr);
   ierr = MatFactorGetError(pc->pmat,(MatFactorError*)&pc->failedreason);CHKERRQ(ierr); 
@@ -85,6 +88,7 @@ PetscErrorCode PCSetFromOptions_SOR(PetscOptionItems *PetscOptionsObject,PC pc)
   if (flg) {ierr = PCSORSetSymmetric(pc,SOR_LOCAL_BACKWARD_SWEEP);CHKERRQ(ierr);}
   ierr = PetscOptionsBoolGroupEnd("-pc_sor_local_forward","use forward sweep locally","PCSORSetSymmetric",&flg);CHKERRQ(ierr);
   if (flg) {ierr = PCSORSetSymmetric(pc,SOR_LOCAL_FORWARD_SWEEP);CHKERRQ(ierr);}
+  ierr = PetscOptionsBool("-pc_sor_multicolor","sweep the rows one color at a time, with OpenMP threads","PCSORSetMulticolor",jac->multicolor,&jac->multicolor,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -114,6 +118,7 @@ PetscErrorCode PCView_SOR(PC pc,PetscViewer viewer)
     else if (sym & SOR_LOCAL_BACKWARD_SWEEP)                                 sortype = "local_backward";
     else                                                                     sortype = "unknown";
     ierr = PetscViewerASCIIPrintf(viewer,"  SOR: type = %s, iterations = %D, local iterations = %D, omega = %g\n",sortype,jac->its,jac->lits,(double)jac->omega);CHKERRQ(ierr);
+    if (jac->multicolor) {ierr = PetscViewerASCIIPrintf(viewer,"  SOR: multicolor sweeps\n");CHKERRQ(ierr);}
   }
   PetscFunctionReturn(0);
 }
@@ -155,6 +160,17 @@ static PetscErrorCode  PCSORSetIterations_SOR(PC pc,PetscInt its,PetscInt lits)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCSORSetMulticolor_SOR"
+static PetscErrorCode  PCSORSetMulticolor_SOR(PC pc,PetscBool flg)
+{
+  PC_SOR *jac = (PC_SOR*)pc->data;
+
+  PetscFunctionBegin;
+  jac->multicolor = flg;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PCSORGetSymmetric_SOR"
 static PetscErrorCode  PCSORGetSymmetric_SOR(PC pc,MatSORType *flag)
@@ -428,6 +444,49 @@ PetscErrorCode  PCSORSetIterations(PC pc,PetscInt its,PetscInt lits)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PCSORSetMulticolor"
+/*@
+   PCSORSetMulticolor - Sets the SOR preconditioner to relax the (local) rows one color
+   at a time, so that the rows of each color are relaxed in parallel by the OpenMP threads.
+
+   Logically Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  flg - PETSC_TRUE to use the multicolor sweeps
+
+   Options Database Key:
+.  -pc_sor_multicolor - Activates the multicolor sweeps
+
+   Level: intermediate
+
+   Notes:
+   A distance one coloring of the (block) rows is computed with MatColoringApply() the first time the
+   preconditioner is applied and recomputed only when the nonzero pattern of the matrix changes.
+   The forward sweep relaxes the colors in increasing and the backward sweep in decreasing order, so
+   the symmetric sweep is still symmetric; but the iteration is Gauss-Seidel for the matrix with its
+   rows ordered by color, which usually converges somewhat slower than the natural ordering.
+
+   Only the SeqAIJ and SeqBAIJ matrices, and the diagonal blocks of the MPIAIJ and MPIBAIJ matrices,
+   support the multicolor sweeps; it is ignored by the other matrix types and by Eisenstat.
+   The number of threads is the OpenMP default, see OMP_NUM_THREADS.
+
+.keywords: PC, SOR, Gauss-Seidel, multicolor, threads
+
+.seealso: PCSORSetSymmetric(), PCSORSetOmega(), MatSOR(), SOR_MULTICOLOR
+@*/
+PetscErrorCode  PCSORSetMulticolor(PC pc,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveBool(pc,flg,2);
+  ierr = PetscTryMethod(pc,"PCSORSetMulticolor_C",(PC,PetscBool),(pc,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*MC
      PCSOR - (S)SOR (successive over relaxation, Gauss-Seidel) preconditioning
 
@@ -441,7 +500,8 @@ PetscErrorCode  PCSORSetIterations(PC pc,PetscInt its,PetscInt lits)
 .  -pc_sor_omega <omega> - Sets omega
 .  -pc_sor_diagonal_shift <shift> - shift the diagonal entries; useful if the matrix has zeros on the diagonal
 .  -pc_sor_its <its> - Sets number of iterations   (default 1)
--  -pc_sor_lits <lits> - Sets number of local iterations  (default 1)
+.  -pc_sor_lits <lits> - Sets number of local iterations  (default 1)
+-  -pc_sor_multicolor - Relax the rows one color at a time with OpenMP threads, see PCSORSetMulticolor()
 
    Level: beginner
 
@@ -462,7 +522,7 @@ PetscErrorCode  PCSORSetIterations(PC pc,PetscInt its,PetscInt lits)
           the computation is stopped with an error
 
 .seealso:  PCCreate(), PCSetType(), PCType (for list of available types), PC,
-           PCSORSetIterations(), PCSORSetSymmetric(), PCSORSetOmega(), PCEISENSTAT
+           PCSORSetIterations(), PCSORSetSymmetric(), PCSORSetOmega(), PCSORSetMulticolor(), PCEISENSTAT
 M*/
 
 #undef __FUNCT__
@@ -487,10 +547,12 @@ PETSC_EXTERN PetscErrorCode PCCreate_SOR(PC pc)
   jac->fshift              = 0.0;
   jac->its                 = 1;
   jac->lits                = 1;
+  jac->multicolor          = PETSC_FALSE;
 
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORSetSymmetric_C",PCSORSetSymmetric_SOR);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORSetOmega_C",PCSORSetOmega_SOR);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORSetIterations_C",PCSORSetIterations_SOR);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORSetMulticolor_C",PCSORSetMulticolor_SOR);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORGetSymmetric_C",PCSORGetSymmetric_SOR);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORGetOmega_C",PCSORGetOmega_SOR);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSORGetIterations_C",PCSORGetIterations_SOR);CHKERRQ(ierr);
@@ -0,0 +1,213 @@
+/*
+   Include files needed for the variable size block PBJacobi preconditioner:
+     pcimpl.h - private include file intended for use by all preconditioners
+*/
+
+#include <petsc/private/pcimpl.h>   /*I "petscpc.h" I*/
+
+/*
+   Private context (data structure) for the VPBJacobi preconditioner.
+*/
+typedef struct {
+  PetscScalar *diag;          /* the inverses of the blocks in column major order, one after the other */
+  PetscInt    nblocks,*bsizes;
+  PetscInt    bsmin,bsmax;    /* the smallest and largest block size over all processes */
+} PC_VPBJacobi;
+
+#undef __FUNCT__
+#define __FUNCT__ "PCApply_VPBJacobi"
+static PetscErrorCode PCApply_VPBJacobi(PC pc,Vec x,Vec y)
+{
+  PC_VPBJacobi      *jac = (PC_VPBJacobi*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,j,k,bs,nflops = 0;
+  const PetscScalar *diag = jac->diag,*xx;
+  PetscScalar       *yy,s;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&yy);CHKERRQ(ierr);
+  for (i=0; i<jac->nblocks; i++) {
+    bs = jac->bsizes[i];
+    if (bs == 1) yy[0] = diag[0]*xx[0];
+    else {
+      for (j=0; j<bs; j++) {
+        s = 0.0;
+        for (k=0; k<bs; k++) s += diag[j+bs*k]*xx[k];
+        yy[j] = s;
+      }
+    }
+    nflops += bs*(2*bs-1);
+    xx     += bs;
+    yy     += bs;
+    diag   += bs*bs;
+  }
+  ierr = VecRestoreArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecRestoreArray(y,&yy);CHKERRQ(ierr);
+  ierr = PetscLogFlops((PetscLogDouble)nflops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PCApplyTranspose_VPBJacobi"
+static PetscErrorCode PCApplyTranspose_VPBJacobi(PC pc,Vec x,Vec y)
+{
+  PC_VPBJacobi      *jac = (PC_VPBJacobi*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,j,k,bs,nflops = 0;
+  const PetscScalar *diag = jac->diag,*xx;
+  PetscScalar       *yy,s;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&yy);CHKERRQ(ierr);
+  for (i=0; i<jac->nblocks; i++) {
+    bs = jac->bsizes[i];
+    for (j=0; j<bs; j++) {
+      s = 0.0;
+      for (k=0; k<bs; k++) s += diag[k+bs*j]*xx[k];
+      yy[j] = s;
+    }
+    nflops += bs*(2*bs-1);
+    xx     += bs;
+    yy     += bs;
+    diag   += bs*bs;
+  }
+  ierr = VecRestoreArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecRestoreArray(y,&yy);CHKERRQ(ierr);
+  ierr = PetscLogFlops((PetscLogDouble)nflops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+/* -------------------------------------------------------------------------- */
+#undef __FUNCT__
+#define __FUNCT__ "PCSetUp_VPBJacobi"
+static PetscErrorCode PCSetUp_VPBJacobi(PC pc)
+{
+  PC_VPBJacobi    *jac = (PC_VPBJacobi*)pc->data;
+  PetscErrorCode  ierr;
+  Mat             A = pc->pmat;
+  MatFactorError  err;
+  PetscInt        i,bs,nlocal,nblocks,nsize = 0,bsminmax[2];
+  const PetscInt  *bsizes;
+
+  PetscFunctionBegin;
+  ierr = MatGetVariableBlockSizes(A,&nblocks,&bsizes);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(A,&nlocal,NULL);CHKERRQ(ierr);
+  ierr = PetscFree(jac->bsizes);CHKERRQ(ierr);
+  ierr = PetscFree(jac->diag);CHKERRQ(ierr);
+  if (nblocks || !nlocal) {
+    ierr = PetscMalloc1(nblocks,&jac->bsizes);CHKERRQ(ierr);
+    ierr = PetscMemcpy(jac->bsizes,bsizes,nblocks*sizeof(PetscInt));CHKERRQ(ierr);
+  } else {
+    /* no variable block sizes were set, use the block size of the matrix */
+    ierr    = MatGetBlockSize(A,&bs);CHKERRQ(ierr);
+    nblocks = nlocal/bs;
+    ierr    = PetscMalloc1(nblocks,&jac->bsizes);CHKERRQ(ierr);
+    for (i=0; i<nblocks; i++) jac->bsizes[i] = bs;
+  }
+  jac->nblocks = nblocks;
+  bsminmax[0]  = PETSC_MAX_INT;
+  bsminmax[1]  = PETSC_MAX_INT;
+  for (i=0; i<nblocks; i++) {
+    nsize      += jac->bsizes[i]*jac->bsizes[i];
+    bsminmax[0] = PetscMin(bsminmax[0],jac->bsizes[i]);
+    bsminmax[1] = PetscMin(bsminmax[1],-jac->bsizes[i]);
+  }
+  ierr       = MPIU_Allreduce(MPI_IN_PLACE,bsminmax,2,MPIU_INT,MPI_MIN,PetscObjectComm((PetscObject)pc));CHKERRQ(ierr);
+  jac->bsmin = bsminmax[0];
+  jac->bsmax = -bsminmax[1];
+
+  ierr = PetscMalloc1(nsize,&jac->diag);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)pc,nsize*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = MatInvertVariableBlockDiagonal(A,jac->nblocks,jac->bsizes,jac->diag);CHKERRQ(ierr);
+  ierr = MatFactorGetError(A,&err);CHKERRQ(ierr);
+  if (err) pc->failedreason = (PCFailedReason)err;
+  PetscFunctionReturn(0);
+}
+/* -------------------------------------------------------------------------- */
+#undef __FUNCT__
+#define __FUNCT__ "PCReset_VPBJacobi"
+static PetscErrorCode PCReset_VPBJacobi(PC pc)
+{
+  PC_VPBJacobi   *jac = (PC_VPBJacobi*)pc->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(jac->diag);CHKERRQ(ierr);
+  ierr = PetscFree(jac->bsizes);CHKERRQ(ierr);
+  jac->nblocks = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PCDestroy_VPBJacobi"
+static PetscErrorCode PCDestroy_VPBJacobi(PC pc)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PCReset_VPBJacobi(pc);CHKERRQ(ierr);
+  ierr = PetscFree(pc->data);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PCView_VPBJacobi"
+static PetscErrorCode PCView_VPBJacobi(PC pc,PetscViewer viewer)
+{
+  PetscErrorCode ierr;
+  PC_VPBJacobi   *jac = (PC_VPBJacobi*)pc->data;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii && pc->setupcalled) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  variable size point-block Jacobi: block sizes %D to %D\n",jac->bsmin,jac->bsmax);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* -------------------------------------------------------------------------- */
+/*MC
+     PCVPBJACOBI - Variable size point block Jacobi preconditioner
+
+   Notes: The sizes of the diagonal blocks are given with MatSetVariableBlockSizes(), for example for meshes whose regions
+   have different numbers of fields; a block must not cross the boundary between two processes. If no sizes were set the
+   block size of the matrix is used, as in PCPBJACOBI.
+
+   This works for any matrix that supports MatGetValues() on the local rows. The blocks are inverted with
+   MatInvertVariableBlockDiagonal(), with dense LU factorization with partial pivoting; consecutive blocks of the same
+   size are inverted several at a time with vector instructions.
+
+   Level: beginner
+
+  Concepts: point block Jacobi
+
+.seealso:  PCCreate(), PCSetType(), PCType (for list of available types), PC, PCJACOBI, PCPBJACOBI, MatSetVariableBlockSizes(),
+           MatInvertVariableBlockDiagonal()
+
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "PCCreate_VPBJacobi"
+PETSC_EXTERN PetscErrorCode PCCreate_VPBJacobi(PC pc)
+{
+  PC_VPBJacobi   *jac;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr     = PetscNewLog(pc,&jac);CHKERRQ(ierr);
+  pc->data = (void*)jac;
+
+  pc->ops->apply               = PCApply_VPBJacobi;
+  pc->ops->applytranspose      = PCApplyTranspose_VPBJacobi;
+  pc->ops->setup               = PCSetUp_VPBJacobi;
+  pc->ops->reset               = PCReset_VPBJacobi;
+  pc->ops->destroy             = PCDestroy_VPBJacobi;
+  pc->ops->setfromoptions      = 0;
+  pc->ops->view                = PCView_VPBJacobi;
+  pc->ops->applyrichardson     = 0;
+  pc->ops->applysymmetricleft  = 0;
+  pc->ops->applysymmetricright = 0;
+  PetscFunctionReturn(0);
+}
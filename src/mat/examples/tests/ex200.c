@@ -0,0 +1,123 @@
+static char help[] = "Tests MatMult(), MatMultAdd() and MatMultTranspose() against products with the explicitly assembled transpose.\n\
+The matrix has very uneven row lengths. Set the type of the tested matrix with -mat_type.\n\
+Input parameters include\n\
+  -n <n> : number of rows (and columns)\n\
+  -convert_type <type> : convert the assembled matrix to this type before testing\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/* row i couples to i-1,i,i+1; every 10th row is long and couples to every 7th column; transpose assembles A^T */
+static PetscErrorCode FillMatrix(Mat A,PetscBool transpose)
+{
+  PetscInt       i,j,rstart,rend,N;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetSize(A,&N,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {
+    for (j=PetscMax(i-1,0); j<=PetscMin(i+1,N-1); j++) {
+      v = (i == j) ? 4.0 + i%3 : -1.0 - 0.01*i;
+      if (!transpose && i >= rstart && i < rend) {ierr = MatSetValues(A,1,&i,1,&j,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      if (transpose && j >= rstart && j < rend)  {ierr = MatSetValues(A,1,&j,1,&i,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    }
+    if (!(i%10)) {
+      for (j=i%7; j<N; j+=7) {
+        if (PetscAbsInt(i-j) <= 1) continue;
+        v = 0.5 + 0.001*j;
+        if (!transpose && i >= rstart && i < rend) {ierr = MatSetValues(A,1,&i,1,&j,&v,INSERT_VALUES);CHKERRQ(ierr);}
+        if (transpose && j >= rstart && j < rend)  {ierr = MatSetValues(A,1,&j,1,&i,&v,INSERT_VALUES);CHKERRQ(ierr);}
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,At,B;
+  Vec            x,y,z,w;
+  PetscInt       n = 200;
+  PetscReal      norm;
+  PetscRandom    rand;
+  char           type[256];
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetString(NULL,NULL,"-convert_type",type,sizeof(type),&flg);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSetUp(A);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = FillMatrix(A,PETSC_FALSE);CHKERRQ(ierr);
+  if (flg) {
+    ierr = MatConvert(A,type,MAT_INITIAL_MATRIX,&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+    A    = B;
+    ierr = MatViewFromOptions(A,NULL,"-convert_view");CHKERRQ(ierr);
+  }
+
+  /* the reference transpose is a plain AIJ matrix; the prefix keeps the options of A away from it */
+  ierr = MatCreate(PETSC_COMM_WORLD,&At);CHKERRQ(ierr);
+  ierr = MatSetOptionsPrefix(At,"t_");CHKERRQ(ierr);
+  ierr = MatSetSizes(At,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(At,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSetUp(At);CHKERRQ(ierr);
+  ierr = MatSetOption(At,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = FillMatrix(At,PETSC_TRUE);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&w);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(w,rand);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMultTranspose(At,x,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_2,&norm);CHKERRQ(ierr);
+  if (norm > 1.e-10) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMult(): norm of error %g\n",(double)norm);CHKERRQ(ierr);}
+
+  ierr = MatMultAdd(A,x,w,y);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(At,x,w,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_2,&norm);CHKERRQ(ierr);
+  if (norm > 1.e-10) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMultAdd(): norm of error %g\n",(double)norm);CHKERRQ(ierr);}
+
+  /* in-place y = y + A x */
+  ierr = VecCopy(w,y);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(At,x,w,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_2,&norm);CHKERRQ(ierr);
+  if (norm > 1.e-10) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMultAdd() in place: norm of error %g\n",(double)norm);CHKERRQ(ierr);}
+
+  ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(At,x,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_2,&norm);CHKERRQ(ierr);
+  if (norm > 1.e-10) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMultTranspose(): norm of error %g\n",(double)norm);CHKERRQ(ierr);}
+
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&At);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
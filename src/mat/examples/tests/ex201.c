@@ -0,0 +1,155 @@
+
+static char help[] = "Tests MatView()/MatLoad() and VecView()/VecLoad() in the memory-mapped binary format.\n\
+The objects are loaded with the distribution of the file, with another distribution and on each process alone.\n\
+Input parameters include\n\
+  -m <m>, -n <n> : size of the grid\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "Check"
+/*
+   Compares a loaded matrix and vector with the ones written, through their norms and the norm of their product
+*/
+static PetscErrorCode Check(const char *name,Mat A,Vec x,PetscReal nrm[4])
+{
+  PetscContainer container;
+  Vec            y;
+  PetscReal      lnrm[4];
+  PetscBool      ok;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,NULL,&y);CHKERRQ(ierr);
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatNorm(A,NORM_FROBENIUS,&lnrm[0]);CHKERRQ(ierr);
+  ierr = MatNorm(A,NORM_1,&lnrm[1]);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_2,&lnrm[2]);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_2,&lnrm[3]);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ok   = (PetscAbsReal(lnrm[0]-nrm[0]) < 1.e-10*nrm[0] && PetscAbsReal(lnrm[1]-nrm[1]) < 1.e-10*nrm[1] && PetscAbsReal(lnrm[2]-nrm[2]) < 1.e-10*nrm[2] && PetscAbsReal(lnrm[3]-nrm[3]) < 1.e-10*nrm[3]) ? PETSC_TRUE : PETSC_FALSE;
+  ierr = PetscObjectQuery((PetscObject)A,"MatLoad_AIJ_BinaryMmap",(PetscObject*)&container);CHKERRQ(ierr);
+  ierr = PetscPrintf(PetscObjectComm((PetscObject)A),"%s: in place %d, same norms %d\n",name,container ? 1 : 0,(int)ok);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Load"
+static PetscErrorCode Load(MPI_Comm comm,PetscInt m,Mat *A,Vec *x)
+{
+  PetscViewer    viewer;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscViewerBinaryOpen(comm,"ex201.dat",FILE_MODE_READ,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerBinarySetUseMmap(viewer,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  ierr = VecCreate(comm,x);CHKERRQ(ierr);
+  if (m >= 0) {
+    ierr = MatSetSizes(*A,m,m,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+    ierr = VecSetSizes(*x,m,PETSC_DETERMINE);CHKERRQ(ierr);
+  }
+  ierr = MatLoad(*A,viewer);CHKERRQ(ierr);
+  ierr = VecLoad(*x,viewer);CHKERRQ(ierr);
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  Vec            x,y;
+  PetscViewer    viewer;
+  PetscInt       i,j,Ii,J,Istart,Iend,m = 7,n = 6,mlocal;
+  PetscMPIInt    rank,size;
+  PetscInt       cols[2];
+  PetscScalar    v,vals[2];
+  PetscReal      nrm[4],anrm;
+  PetscBool      ok;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  /* a nonsymmetric matrix of the five point stencil, and a vector */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n,5,NULL,2,NULL,&A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    if (i>0)   {J = Ii - n; v = -1.0 - 0.01*Ii; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; v = -1.0 + 0.02*j;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -1.0 - 0.03*i;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; v = -1.0;           ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    v = 4.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(x,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    v    = 1.0/(1.0 + Ii);
+    ierr = VecSetValues(x,1,&Ii,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = VecAssemblyBegin(x);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(x);CHKERRQ(ierr);
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatNorm(A,NORM_FROBENIUS,&nrm[0]);CHKERRQ(ierr);
+  ierr = MatNorm(A,NORM_1,&nrm[1]);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_2,&nrm[2]);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_2,&nrm[3]);CHKERRQ(ierr);
+
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,"ex201.dat",FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerBinarySetUseMmap(viewer,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatView(A,viewer);CHKERRQ(ierr);
+  ierr = VecView(x,viewer);CHKERRQ(ierr);
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+
+  /* with the distribution of the file the matrix uses the file in place; changing it does not change the file */
+  ierr = Load(PETSC_COMM_WORLD,-1,&A,&x);CHKERRQ(ierr);
+  ierr = Check("Same distribution",A,x,nrm);CHKERRQ(ierr);
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = Load(PETSC_COMM_WORLD,-1,&B,&y);CHKERRQ(ierr);
+  ierr = Check("Loaded again",B,y,nrm);CHKERRQ(ierr);
+
+  /* new nonzeros in both blocks move the arrays of a matrix used in place to allocated memory */
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  cols[0] = (Istart + 2) % (m*n); cols[1] = (Istart + (m*n)/2) % (m*n);
+  vals[0] = vals[1] = 1.0;
+  ierr = MatSetValues(A,1,&Istart,2,cols,vals,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatGetValues(A,1,&Istart,2,cols,vals);CHKERRQ(ierr);
+  ierr = MatNorm(A,NORM_FROBENIUS,&anrm);CHKERRQ(ierr);
+  ok   = (PetscAbsReal(anrm*anrm - 4.0*nrm[0]*nrm[0] - 2.0*size) < 1.e-10*anrm*anrm && vals[0] == 1.0 && vals[1] == 1.0) ? PETSC_TRUE : PETSC_FALSE;
+  ierr = MPI_Allreduce(MPI_IN_PLACE,&ok,1,MPIU_BOOL,MPI_LAND,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"New nonzeros: inserted %d\n",(int)ok);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+
+  /* another distribution of the rows, taken from several parts of the file */
+  mlocal = (m*n)/size + (rank < (m*n)%size ? 1 : 0);
+  if (size > 1) mlocal += (rank == 0) ? 3 : ((rank == size-1) ? -3 : 0);
+  ierr = Load(PETSC_COMM_WORLD,mlocal,&A,&x);CHKERRQ(ierr);
+  ierr = Check("Other distribution",A,x,nrm);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+
+  /* each process alone */
+  ierr = Load(PETSC_COMM_SELF,-1,&A,&x);CHKERRQ(ierr);
+  if (!rank) {ierr = Check("One process",A,x,nrm);CHKERRQ(ierr);}
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
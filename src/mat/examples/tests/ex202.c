@@ -0,0 +1,154 @@
+
+static char help[] = "Tests the level-scheduled threaded MatSolve() (-mat_solve_levels) of LU, ILU, Cholesky and ICC factors.\n\
+Each factor is computed twice, with and without the level-scheduled solves, and the solutions are compared;\n\
+the matrix values are then changed and the factors recomputed with the same nonzero pattern.\n\
+Input parameters include\n\
+  -m <m>, -n <n> : size of the grid\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/* five point stencil on an m by n grid; with a nonzero beta it gets an upwind convection term and is nonsymmetric */
+static PetscErrorCode FillMatrix(Mat A,PetscInt m,PetscInt n,PetscReal beta,PetscReal shift)
+{
+  PetscInt       i,j,Ii,J;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  for (Ii=0; Ii<m*n; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    v = -1.0;
+    if (i>0)   {J = Ii - n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -1.0 - beta; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    v = 4.0 + beta + shift + 0.01*(Ii%5); ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Factor"
+static PetscErrorCode Factor(Mat A,MatFactorType ftype,MatOrderingType otype,PetscInt levels,Mat *F)
+{
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.levels = levels;
+  info.fill   = 2.0;
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  ierr = MatGetFactor(A,MATSOLVERPETSC,ftype,F);CHKERRQ(ierr);
+  switch (ftype) {
+  case MAT_FACTOR_LU:
+    ierr = MatLUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_ILU:
+    ierr = MatILUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_CHOLESKY:
+    ierr = MatCholeskyFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_ICC:
+    ierr = MatICCFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);
+    break;
+  default: SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Factor type not tested");
+  }
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FactorNumeric"
+static PetscErrorCode FactorNumeric(Mat A,MatFactorType ftype,Mat F)
+{
+  MatFactorInfo  info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  if (ftype == MAT_FACTOR_LU || ftype == MAT_FACTOR_ILU) {
+    ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);
+  } else {
+    ierr = MatCholeskyFactorNumeric(F,A,&info);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,F,Fl;
+  Vec            b,x,xl;
+  PetscInt       m = 15,n = 12,k,l,Ii;
+  PetscScalar    v;
+  PetscReal      norm;
+  PetscBool      symmetric;
+  const char     *mtype[] = {MATSEQAIJ,MATSEQAIJ,MATSEQAIJ,MATSEQAIJ,MATSEQAIJ,MATSEQSBAIJ};
+  MatFactorType  ftype[]  = {MAT_FACTOR_LU,MAT_FACTOR_ILU,MAT_FACTOR_ILU,MAT_FACTOR_CHOLESKY,MAT_FACTOR_ICC,MAT_FACTOR_ICC};
+  const char     *otype[] = {MATORDERINGND,MATORDERINGNATURAL,MATORDERINGRCM,MATORDERINGND,MATORDERINGNATURAL,MATORDERINGNATURAL};
+  PetscInt       levels[] = {0,0,2,0,1,0};
+  const char     *fname[] = {"LU","ILU(0)","ILU(2)","Cholesky","ICC(1)","ICC(0)"};
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = VecCreateSeq(PETSC_COMM_SELF,m*n,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&xl);CHKERRQ(ierr);
+  for (Ii=0; Ii<m*n; Ii++) {
+    v    = PetscSinReal(0.1*Ii) + 1.0;
+    ierr = VecSetValues(b,1,&Ii,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = VecAssemblyBegin(b);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(b);CHKERRQ(ierr);
+
+  for (k=0; k<6; k++) {
+    symmetric = (PetscBool)(ftype[k] == MAT_FACTOR_CHOLESKY || ftype[k] == MAT_FACTOR_ICC);
+    ierr = MatCreate(PETSC_COMM_SELF,&A);CHKERRQ(ierr);
+    ierr = MatSetSizes(A,m*n,m*n,m*n,m*n);CHKERRQ(ierr);
+    ierr = MatSetType(A,mtype[k]);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+    ierr = MatSeqSBAIJSetPreallocation(A,1,3,NULL);CHKERRQ(ierr);
+    if (k == 5) {ierr = MatSetOption(A,MAT_IGNORE_LOWER_TRIANGULAR,PETSC_TRUE);CHKERRQ(ierr);}
+    ierr = FillMatrix(A,m,n,symmetric ? 0.0 : 0.5,0.0);CHKERRQ(ierr);
+
+    /* the reference factor without and the tested factor with the level-scheduled solves; the option is
+       processed by the first numeric factorization */
+    ierr = Factor(A,ftype[k],otype[k],levels[k],&F);CHKERRQ(ierr);
+    ierr = Factor(A,ftype[k],otype[k],levels[k],&Fl);CHKERRQ(ierr);
+    for (l=0; l<2; l++) {
+      if (l) {ierr = FillMatrix(A,m,n,symmetric ? 0.0 : 0.3,1.0);CHKERRQ(ierr);}
+      ierr = PetscOptionsClearValue(NULL,"-mat_solve_levels");CHKERRQ(ierr);
+      ierr = FactorNumeric(A,ftype[k],F);CHKERRQ(ierr);
+      ierr = PetscOptionsSetValue(NULL,"-mat_solve_levels","1");CHKERRQ(ierr);
+      ierr = FactorNumeric(A,ftype[k],Fl);CHKERRQ(ierr);
+      ierr = MatSolve(F,b,x);CHKERRQ(ierr);
+      ierr = MatSolve(Fl,b,xl);CHKERRQ(ierr);
+      ierr = VecAXPY(xl,-1.0,x);CHKERRQ(ierr);
+      ierr = VecNorm(xl,NORM_INFINITY,&norm);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s %s %s: MatSolve() with levels %s\n",mtype[k],fname[k],l ? "refactored" : "factored",norm <= 100.0*PETSC_MACHINE_EPSILON ? "agrees" : "differs");CHKERRQ(ierr);
+    }
+    ierr = MatDestroy(&F);CHKERRQ(ierr);
+    ierr = MatDestroy(&Fl);CHKERRQ(ierr);
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+  }
+
+  ierr = PetscOptionsClearValue(NULL,"-mat_solve_levels");CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&xl);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
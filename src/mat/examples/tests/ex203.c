@@ -0,0 +1,146 @@
+
+static char help[] = "Tests the vector kernels (-mat_baij_simd) of MatMult(), MatMultAdd(), MatSolve() and MatLUFactorNumeric() for SeqBAIJ matrices.\n\
+The products are compared with those of the same matrix in AIJ format and the factors are checked with the residual;\n\
+the block sizes 2 to 8 are tested, for a matrix with all block rows and for one with compressed block rows.\n\
+Input parameters include\n\
+  -m <m>, -n <n> : size of the grid of blocks\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/*
+   five point stencil of blocks on an m by n grid, with nonsymmetric blocks and a dominant block diagonal; with sparse
+   only every fourth block row has the off-diagonal blocks and the other block rows are empty
+*/
+static PetscErrorCode FillMatrix(Mat A,PetscInt bs,PetscInt m,PetscInt n,PetscBool sparse)
+{
+  PetscInt       i,j,k,l,Ii,J[5],nc;
+  PetscScalar    *v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(5*bs*bs,&v);CHKERRQ(ierr);
+  for (Ii=0; Ii<m*n; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    if (sparse && Ii%4) continue;
+    nc = 0;
+    if (i>0)   J[nc++] = Ii - n;
+    if (j>0)   J[nc++] = Ii - 1;
+    J[nc++] = Ii;
+    if (j<n-1) J[nc++] = Ii + 1;
+    if (i<m-1) J[nc++] = Ii + n;
+    /* the values are stored block row by block row, with the rows of the blocks contiguous */
+    for (k=0; k<bs; k++) {
+      for (l=0; l<nc*bs; l++) {
+        if (J[l/bs] == Ii) v[k*nc*bs+l] = (k == l%bs) ? 4.0*bs + 0.1*k : 0.3/(1.0 + k + 2*(l%bs));
+        else v[k*nc*bs+l] = -1.0 + 0.01*((Ii + 3*k + 7*l)%11);
+      }
+    }
+    ierr = MatSetValuesBlocked(A,1,&Ii,nc,J,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(v);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,Aaij,F;
+  Vec            x,y,z,zaij,b;
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscInt       m = 6,n = 5,bs,s,N;
+  PetscReal      norm,nrm[4];
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+
+  for (bs=2; bs<=8; bs++) {
+    N = bs*m*n;
+    ierr = VecCreateSeq(PETSC_COMM_SELF,N,&x);CHKERRQ(ierr);
+    ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+    ierr = VecDuplicate(x,&z);CHKERRQ(ierr);
+    ierr = VecDuplicate(x,&zaij);CHKERRQ(ierr);
+    ierr = VecDuplicate(x,&b);CHKERRQ(ierr);
+    ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+    ierr = VecSetRandom(y,rand);CHKERRQ(ierr);
+
+    for (s=0; s<2; s++) {
+      ierr = MatCreateSeqBAIJ(PETSC_COMM_SELF,bs,N,N,5,NULL,&A);CHKERRQ(ierr);
+      ierr = FillMatrix(A,bs,m,n,(PetscBool)s);CHKERRQ(ierr);
+      ierr = MatConvert(A,MATSEQAIJ,MAT_INITIAL_MATRIX,&Aaij);CHKERRQ(ierr);
+
+      /* the products, compared with AIJ */
+      ierr = MatMult(A,x,z);CHKERRQ(ierr);
+      ierr = MatMult(Aaij,x,zaij);CHKERRQ(ierr);
+      ierr = VecAXPY(z,-1.0,zaij);CHKERRQ(ierr);
+      ierr = VecNorm(z,NORM_INFINITY,&nrm[0]);CHKERRQ(ierr);
+      ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+      ierr = MatMultAdd(Aaij,x,y,zaij);CHKERRQ(ierr);
+      ierr = VecAXPY(z,-1.0,zaij);CHKERRQ(ierr);
+      ierr = VecNorm(z,NORM_INFINITY,&nrm[1]);CHKERRQ(ierr);
+      ierr = VecCopy(y,z);CHKERRQ(ierr);
+      ierr = MatMultAdd(A,x,z,z);CHKERRQ(ierr);
+      ierr = VecAXPY(z,-1.0,zaij);CHKERRQ(ierr);
+      ierr = VecNorm(z,NORM_INFINITY,&norm);CHKERRQ(ierr);
+      nrm[1] = PetscMax(nrm[1],norm);
+
+      /* LU with nested dissection and ILU(0) in the natural ordering of the nonsingular matrix */
+      if (!s) {
+        ierr = MatMult(A,x,b);CHKERRQ(ierr);
+        ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+        info.fill = 2.0;
+        ierr = MatGetOrdering(A,MATORDERINGND,&row,&col);CHKERRQ(ierr);
+        ierr = MatGetFactor(A,MATSOLVERPETSC,MAT_FACTOR_LU,&F);CHKERRQ(ierr);
+        ierr = MatLUFactorSymbolic(F,A,row,col,&info);CHKERRQ(ierr);
+        ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);
+        ierr = MatSolve(F,b,z);CHKERRQ(ierr);
+        ierr = VecAXPY(z,-1.0,x);CHKERRQ(ierr);
+        ierr = VecNorm(z,NORM_INFINITY,&nrm[2]);CHKERRQ(ierr);
+        ierr = MatDestroy(&F);CHKERRQ(ierr);
+        ierr = ISDestroy(&row);CHKERRQ(ierr);
+        ierr = ISDestroy(&col);CHKERRQ(ierr);
+
+        /* one step of ILU(0) in BAIJ and AIJ format gives the same result, the blocks are dense */
+        ierr = MatGetOrdering(A,MATORDERINGNATURAL,&row,&col);CHKERRQ(ierr);
+        ierr = MatGetFactor(A,MATSOLVERPETSC,MAT_FACTOR_ILU,&F);CHKERRQ(ierr);
+        ierr = MatILUFactorSymbolic(F,A,row,col,&info);CHKERRQ(ierr);
+        ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);
+        ierr = MatSolve(F,b,z);CHKERRQ(ierr);
+        ierr = MatMult(A,z,zaij);CHKERRQ(ierr);
+        ierr = VecAXPY(zaij,-1.0,b);CHKERRQ(ierr);
+        ierr = VecNorm(zaij,NORM_2,&nrm[3]);CHKERRQ(ierr);
+        ierr = VecNorm(b,NORM_2,&norm);CHKERRQ(ierr);
+        nrm[3] /= norm;
+        ierr = MatDestroy(&F);CHKERRQ(ierr);
+        ierr = ISDestroy(&row);CHKERRQ(ierr);
+        ierr = ISDestroy(&col);CHKERRQ(ierr);
+        ierr = PetscPrintf(PETSC_COMM_SELF,"bs %D: MatMult() %s, MatMultAdd() %s, LU error %s, ILU(0) relative residual %s\n",bs,
+                           nrm[0] < 1.e-12 ? "agrees" : "differs",nrm[1] < 1.e-12 ? "agrees" : "differs",
+                           nrm[2] < 1.e-10 ? "below 1.e-10" : "too large",nrm[3] < 0.5 ? "below 0.5" : "too large");CHKERRQ(ierr);
+      } else {
+        ierr = PetscPrintf(PETSC_COMM_SELF,"bs %D with compressed block rows: MatMult() %s, MatMultAdd() %s\n",bs,
+                           nrm[0] < 1.e-12 ? "agrees" : "differs",nrm[1] < 1.e-12 ? "agrees" : "differs");CHKERRQ(ierr);
+      }
+      ierr = MatDestroy(&A);CHKERRQ(ierr);
+      ierr = MatDestroy(&Aaij);CHKERRQ(ierr);
+    }
+    ierr = VecDestroy(&x);CHKERRQ(ierr);
+    ierr = VecDestroy(&y);CHKERRQ(ierr);
+    ierr = VecDestroy(&z);CHKERRQ(ierr);
+    ierr = VecDestroy(&zaij);CHKERRQ(ierr);
+    ierr = VecDestroy(&b);CHKERRQ(ierr);
+  }
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
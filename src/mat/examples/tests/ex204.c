@@ -0,0 +1,70 @@
+static char help[] = "Tests the streaming stash (-matstash_stream) when a rank overflows the stream buffer with a long off-process\n\
+row while the other ranks set no values and are already in the assembly, or (-all) when every rank adds values\n\
+to the rows of the next rank one at a time, so that the values it receives meanwhile are added on arrival.\n\
+Input parameters include\n\
+  -n <n> : number of columns set in the off-process row\n\
+  -all   : every rank sets values\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,b;
+  PetscErrorCode ierr;
+  PetscMPIInt    size,rank;
+  PetscInt       i,k,n = 2000,N,row,*cols;
+  PetscScalar    *vals,one = 1.0;
+  PetscReal      norm;
+  PetscBool      all = PETSC_FALSE;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-all",&all,NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  if (size < 2) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_SUP,"This example needs at least two processes");
+  N    = n*size;
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,n,n,N,N);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSetUp(A);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecSet(x,one);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(n,&cols,n,&vals);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {cols[i] = i; vals[i] = 1.0;}
+  /* assemble twice, the second time the messages use the other tag */
+  for (k=0; k<2; k++) {
+    if (all) {
+      /* each value of the rows of the next rank, and one local value in between */
+      for (i=0; i<n; i++) {
+        row  = ((rank+1)%size)*n + i;
+        ierr = MatSetValues(A,1,&row,1,&cols[i],vals,ADD_VALUES);CHKERRQ(ierr);
+        row  = rank*n + i;
+        ierr = MatSetValues(A,1,&row,1,&cols[i],vals,ADD_VALUES);CHKERRQ(ierr);
+      }
+    } else if (!rank) {
+      /* a row of the last rank, followed by one more value in another of its rows */
+      row  = N-1;
+      ierr = MatSetValues(A,1,&row,n,cols,vals,ADD_VALUES);CHKERRQ(ierr);
+      row  = N-2;
+      ierr = MatSetValues(A,1,&row,1,cols,vals,ADD_VALUES);CHKERRQ(ierr);
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatMult(A,x,b);CHKERRQ(ierr);
+    ierr = VecNorm(b,NORM_1,&norm);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Assembly %D: norm of A*1 %g\n",k,(double)norm);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(cols,vals);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
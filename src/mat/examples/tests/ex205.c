@@ -0,0 +1,162 @@
+static char help[] = "Tests that the copies of the values of AIJ matrices, the single precision values (-single) and the\n\
+sliced ELLPACK values of MATSELL (-mat_type sell), follow the changes of the values that do not go through\n\
+MatSetValues(): MatDiagonalScale(), MatAXPY() with SAME_NONZERO_PATTERN, MatRetrieveValues() and the arrays of\n\
+MatSeqAIJGetArray(). Each product is compared with that of a MATAIJ matrix changed the same way.\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -single           : use the single precision values\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FillMatrix"
+/* five point Laplacian with a variable coefficient, so the values are not exact in single precision */
+static PetscErrorCode FillMatrix(Mat A,PetscInt m,PetscInt n)
+{
+  PetscInt       i,j,Ii,J,Istart,Iend;
+  PetscScalar    v,d;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,2,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    i = Ii/n; j = Ii - i*n;
+    d = 1.0/3.0;
+    if (i>0)   {J = Ii - n; v = -1.0/(1.0 + 0.05*(2*i-1)); d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; v = -1.0/(1.0 + 0.05*(2*i+1)); d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; v = -1.0/(1.0 + 0.1*i);        d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; v = -1.0/(1.0 + 0.1*i);        d -= v; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRQ(ierr);}
+    ierr = MatSetValues(A,1,&Ii,1,&Ii,&d,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CompareMult"
+static PetscErrorCode CompareMult(const char name[],Mat A,Mat B,Vec u,Vec x,Vec y,PetscReal tol)
+{
+  PetscReal      err,nrm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMult(A,u,x);CHKERRQ(ierr);
+  ierr = MatMult(B,u,y);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: relative difference %s\n",name,err <= tol*nrm ? "small" : "wrong");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "ScaleArrays"
+/* doubles the values through the arrays of the SeqAIJ blocks */
+static PetscErrorCode ScaleArrays(Mat A)
+{
+  Mat            Ad,Ao = NULL,blocks[2];
+  PetscScalar    *a;
+  PetscInt       b,i,nz;
+  PetscBool      mpi;
+  MatInfo        info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompareAny((PetscObject)A,&mpi,MATMPIAIJ,MATMPISELL,"");CHKERRQ(ierr);
+  if (mpi) {
+    ierr = MatMPIAIJGetSeqAIJ(A,&Ad,&Ao,NULL);CHKERRQ(ierr);
+  } else Ad = A;
+  blocks[0] = Ad; blocks[1] = Ao;
+  for (b=0; b<2; b++) {
+    if (!blocks[b]) continue;
+    ierr = MatGetInfo(blocks[b],MAT_LOCAL,&info);CHKERRQ(ierr);
+    nz   = (PetscInt)info.nz_used;
+    ierr = MatSeqAIJGetArray(blocks[b],&a);CHKERRQ(ierr);
+    for (i=0; i<nz; i++) a[i] *= 2.0;
+    ierr = MatSeqAIJRestoreArray(blocks[b],&a);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,B,X;
+  Vec            u,x,y,l,r;
+  PetscInt       m = 12,n = 10;
+  PetscReal      tol = 1.e-12;
+  PetscBool      single = PETSC_FALSE;
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-single",&single,NULL);CHKERRQ(ierr);
+
+  /* A is tested, B is the MATAIJ reference */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = FillMatrix(A,m,n);CHKERRQ(ierr);
+  ierr = MatCreate(PETSC_COMM_WORLD,&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATAIJ);CHKERRQ(ierr);
+  ierr = FillMatrix(B,m,n);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_COPY_VALUES,&X);CHKERRQ(ierr);
+  if (single) {
+    ierr = MatAIJSetSinglePrecision(A,PETSC_TRUE);CHKERRQ(ierr);
+    tol  = 1.e-6;
+  }
+
+  ierr = MatCreateVecs(A,&u,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&l);CHKERRQ(ierr);
+  ierr = VecDuplicate(u,&r);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(u,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(l,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(r,rand);CHKERRQ(ierr);
+  ierr = VecShift(l,1.0);CHKERRQ(ierr);
+  ierr = VecShift(r,1.0);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+
+  /* each product builds the copy of the values, which the next change must refresh */
+  ierr = CompareMult("Assembled",A,B,u,x,y,tol);CHKERRQ(ierr);
+  ierr = MatDiagonalScale(A,l,r);CHKERRQ(ierr);
+  ierr = MatDiagonalScale(B,l,r);CHKERRQ(ierr);
+  ierr = CompareMult("MatDiagonalScale()",A,B,u,x,y,tol);CHKERRQ(ierr);
+  ierr = MatAXPY(A,2.0,X,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatAXPY(B,2.0,X,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = CompareMult("MatAXPY()",A,B,u,x,y,tol);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_LOCATIONS,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatSetOption(B,MAT_NEW_NONZERO_LOCATIONS,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatStoreValues(A);CHKERRQ(ierr);
+  ierr = MatStoreValues(B);CHKERRQ(ierr);
+  ierr = MatScale(A,3.0);CHKERRQ(ierr);
+  ierr = MatScale(B,3.0);CHKERRQ(ierr);
+  ierr = CompareMult("MatScale()",A,B,u,x,y,tol);CHKERRQ(ierr);
+  ierr = MatRetrieveValues(A);CHKERRQ(ierr);
+  ierr = MatRetrieveValues(B);CHKERRQ(ierr);
+  ierr = CompareMult("MatRetrieveValues()",A,B,u,x,y,tol);CHKERRQ(ierr);
+  ierr = ScaleArrays(A);CHKERRQ(ierr);
+  ierr = ScaleArrays(B);CHKERRQ(ierr);
+  ierr = CompareMult("MatSeqAIJGetArray()",A,B,u,x,y,tol);CHKERRQ(ierr);
+
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&l);CHKERRQ(ierr);
+  ierr = VecDestroy(&r);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&X);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
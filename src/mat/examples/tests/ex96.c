@@ -218,6 +218,19 @@ int main(int argc,char **argv)
     ierr = MatDestroy(&C1);CHKERRQ(ierr);
     ierr = MatDestroy(&C2);CHKERRQ(ierr);
 
+    /* Compare the reused C with a new product of a copy of A, whose algorithm is set with -ref_matptap_via */
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&A_tmp);CHKERRQ(ierr);
+    ierr = MatSetOptionsPrefix(A_tmp,"ref_");CHKERRQ(ierr);
+    ierr = MatPtAP(A_tmp,P,MAT_INITIAL_MATRIX,fill,&C1);CHKERRQ(ierr);
+    ierr = MatNorm(C1,NORM_FROBENIUS,&norm_tmp1);CHKERRQ(ierr);
+    ierr = MatAXPY(C1,none,C,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatNorm(C1,NORM_FROBENIUS,&norm_tmp);CHKERRQ(ierr);
+    if (norm_tmp > tol*norm_tmp1) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"Error: MatPtAP(), |C - Cref|/|Cref|: %g\n",(double)(norm_tmp/norm_tmp1));CHKERRQ(ierr);
+    }
+    ierr = MatDestroy(&C1);CHKERRQ(ierr);
+    ierr = MatDestroy(&A_tmp);CHKERRQ(ierr);
+
     /* Create vector x that is compatible with P */
     ierr = VecCreate(PETSC_COMM_WORLD,&x);CHKERRQ(ierr);
     ierr = MatGetLocalSize(P,&m,&n);CHKERRQ(ierr);
@@ -0,0 +1,338 @@
+
+/*
+   Writes and loads MATSEQAIJ and MATMPIAIJ matrices in the memory-mapped binary format, see PetscViewerBinarySetUseMmap().
+
+   After the header of PetscViewerBinaryMmapBegin() (whose last words are M, N, the block size, the number of parts and
+   the length of the object) come, as PetscInt64,
+
+     rows[nparts+1], cols[nparts+1]     the rows and the columns owned by each process that wrote the file
+     nzd, nzo, di, dj, da, oi, oj, oa   for each part, the number of nonzeros of its two blocks and the locations of their arrays
+
+   and then the arrays of each part, as they are in MATMPIAIJ: the diagonal block (di, dj with local columns, da) and
+   the off-diagonal block (oi, oj with global columns, oa) in compressed row format. A MATSEQAIJ matrix is one part
+   with an empty off-diagonal block. All locations are relative to the start of the object.
+*/
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <petsc/private/viewerimpl.h>
+
+#define MATMMAP_INDEX(nparts) (2*((nparts)+1)+8*(nparts))
+
+typedef struct {
+  void   *p[6];
+  size_t len[6];
+} MatMmap_AIJ;
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMmapUnmap_AIJ"
+static PetscErrorCode MatMmapUnmap_AIJ(MatMmap_AIJ *mm)
+{
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (k=0; k<6; k++) {ierr = PetscBinaryUnmap(mm->p[k],mm->len[k]);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMmapDestroy_AIJ"
+static PetscErrorCode MatMmapDestroy_AIJ(void *ctx)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMmapUnmap_AIJ((MatMmap_AIJ*)ctx);CHKERRQ(ierr);
+  ierr = PetscFree(ctx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMmapMapRows_AIJ"
+/*
+   Maps rows [lo,hi) of a part: the row pointers of both blocks and, if values is set, their columns and values
+*/
+static PetscErrorCode MatMmapMapRows_AIJ(int fd,off_t start,const PetscInt64 part[],PetscInt lo,PetscInt hi,PetscBool values,MatMmap_AIJ *mm)
+{
+  PetscInt       *di,*oi;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMemzero(mm,sizeof(MatMmap_AIJ));CHKERRQ(ierr);
+  mm->len[0] = mm->len[3] = (hi-lo+1)*sizeof(PetscInt);
+  ierr = PetscBinaryMap(fd,start+part[2]+lo*sizeof(PetscInt),mm->len[0],&mm->p[0]);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start+part[5]+lo*sizeof(PetscInt),mm->len[3],&mm->p[3]);CHKERRQ(ierr);
+  if (!values) PetscFunctionReturn(0);
+  di         = (PetscInt*)mm->p[0];
+  oi         = (PetscInt*)mm->p[3];
+  mm->len[1] = (di[hi-lo]-di[0])*sizeof(PetscInt);
+  mm->len[2] = (di[hi-lo]-di[0])*sizeof(PetscScalar);
+  mm->len[4] = (oi[hi-lo]-oi[0])*sizeof(PetscInt);
+  mm->len[5] = (oi[hi-lo]-oi[0])*sizeof(PetscScalar);
+  ierr = PetscBinaryMap(fd,start+part[3]+di[0]*sizeof(PetscInt),mm->len[1],&mm->p[1]);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start+part[4]+di[0]*sizeof(PetscScalar),mm->len[2],&mm->p[2]);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start+part[6]+oi[0]*sizeof(PetscInt),mm->len[4],&mm->p[4]);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start+part[7]+oi[0]*sizeof(PetscScalar),mm->len[5],&mm->p[5]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatView_AIJ_BinaryMmap"
+/*
+   MatView_AIJ_BinaryMmap - Writes a MATSEQAIJ matrix, or a MATMPIAIJ matrix on more than one process, in the memory-mapped format
+*/
+PetscErrorCode MatView_AIJ_BinaryMmap(Mat mat,PetscViewer viewer)
+{
+  MPI_Comm       comm;
+  PetscMPIInt    rank,size,vsize,p;
+  Mat_SeqAIJ     *A,*B;
+  PetscInt       m = mat->rmap->n,k,*oi,*oj = NULL,*zeros = NULL;
+  PetscScalar    *oa;
+  PetscInt64     local[4],*sizes,*index,*part,header[16],off;
+  off_t          start;
+  int            fd;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)mat,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject)viewer),&vsize);CHKERRQ(ierr);
+  if (size != vsize) SETERRQ(comm,PETSC_ERR_SUP,"The memory-mapped format needs the matrix and the viewer on the same processes");
+
+  /* a MATMPIAIJ matrix on one process is written by its diagonal block */
+  if (size > 1) {
+    Mat_MPIAIJ *aij = (Mat_MPIAIJ*)mat->data;
+
+    A    = (Mat_SeqAIJ*)aij->A->data;
+    B    = (Mat_SeqAIJ*)aij->B->data;
+    oi   = B->i;
+    oa   = B->a;
+    ierr = PetscMalloc1(oi[m],&oj);CHKERRQ(ierr);
+    for (k=0; k<oi[m]; k++) oj[k] = aij->garray[B->j[k]];
+  } else {
+    A    = (Mat_SeqAIJ*)mat->data;
+    ierr = PetscCalloc1(m+1,&zeros);CHKERRQ(ierr);
+    oi   = zeros;
+    oa   = NULL;
+  }
+
+  local[0] = m;
+  local[1] = mat->cmap->n;
+  local[2] = A->i[m];
+  local[3] = oi[m];
+  ierr = PetscMalloc2(4*size,&sizes,MATMMAP_INDEX(size),&index);CHKERRQ(ierr);
+  ierr = MPI_Allgather(local,4,MPIU_INT64,sizes,4,MPIU_INT64,comm);CHKERRQ(ierr);
+
+  /* every process computes the locations of all the parts */
+  index[0] = index[size+1] = 0;
+  off      = sizeof(header) + PetscViewerBinaryMmapAlign(MATMMAP_INDEX(size)*sizeof(PetscInt64));
+  for (p=0; p<size; p++) {
+    index[p+1]      = index[p] + sizes[4*p];
+    index[size+2+p] = index[size+1+p] + sizes[4*p+1];
+    part            = index + 2*(size+1) + 8*p;
+    part[0]         = sizes[4*p+2];
+    part[1]         = sizes[4*p+3];
+    part[2]         = off; off = PetscViewerBinaryMmapAlign(off + (sizes[4*p]+1)*sizeof(PetscInt));
+    part[3]         = off; off = PetscViewerBinaryMmapAlign(off + part[0]*sizeof(PetscInt));
+    part[4]         = off; off = PetscViewerBinaryMmapAlign(off + part[0]*sizeof(PetscScalar));
+    part[5]         = off; off = PetscViewerBinaryMmapAlign(off + (sizes[4*p]+1)*sizeof(PetscInt));
+    part[6]         = off; off = PetscViewerBinaryMmapAlign(off + part[1]*sizeof(PetscInt));
+    part[7]         = off; off = PetscViewerBinaryMmapAlign(off + part[1]*sizeof(PetscScalar));
+  }
+
+  ierr = PetscViewerBinaryMmapBegin(viewer,&fd,&start);CHKERRQ(ierr);
+  if (!rank) {
+    ierr = PetscMemzero(header,sizeof(header));CHKERRQ(ierr);
+    header[0] = PETSC_VIEWER_BINARY_MMAP_MAGIC;
+    header[1] = PETSC_VIEWER_BINARY_MMAP_VERSION;
+    header[2] = MAT_FILE_CLASSID;
+    header[3] = sizeof(PetscInt);
+    header[4] = sizeof(PetscScalar);
+    header[5] = mat->rmap->N;
+    header[6] = mat->cmap->N;
+    header[7] = PetscAbs(mat->rmap->bs);
+    header[8] = size;
+    header[9] = off;
+    ierr = PetscBinaryWriteAt(fd,header,sizeof(header),start);CHKERRQ(ierr);
+    ierr = PetscBinaryWriteAt(fd,index,MATMMAP_INDEX(size)*sizeof(PetscInt64),start+sizeof(header));CHKERRQ(ierr);
+  }
+  part = index + 2*(size+1) + 8*rank;
+  ierr = PetscBinaryWriteAt(fd,A->i,(m+1)*sizeof(PetscInt),start+part[2]);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,A->j,part[0]*sizeof(PetscInt),start+part[3]);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,A->a,part[0]*sizeof(PetscScalar),start+part[4]);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,oi,(m+1)*sizeof(PetscInt),start+part[5]);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,oj,part[1]*sizeof(PetscInt),start+part[6]);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,oa,part[1]*sizeof(PetscScalar),start+part[7]);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryMmapEnd(viewer,start+off);CHKERRQ(ierr);
+
+  ierr = PetscFree2(sizes,index);CHKERRQ(ierr);
+  ierr = PetscFree(oj);CHKERRQ(ierr);
+  ierr = PetscFree(zeros);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLoad_AIJ_BinaryMmap"
+/*
+   MatLoad_AIJ_BinaryMmap - Loads a matrix written in the memory-mapped format into a MATSEQAIJ or MATMPIAIJ matrix
+
+   When the matrix is not preallocated and gets the same rows and columns as the part of the file written by its
+   process, that part is used in place: the arrays of the matrix are the pages of the file, which are only read when
+   they are used and only copied when they are changed. The file must then not be changed or truncated while the
+   matrix exists, the mapping would see the change or fault with SIGBUS. A new nonzero copies the arrays of the block
+   it goes in to allocated memory, as any AIJ matrix does when a row is full. Otherwise the rows are copied from the
+   parts that hold them.
+*/
+PetscErrorCode MatLoad_AIJ_BinaryMmap(Mat newMat,PetscViewer viewer)
+{
+  MPI_Comm       comm;
+  PetscMPIInt    rank,size,inplace,allinplace;
+  PetscBool      isseq,ismpi;
+  PetscInt       M,N,m,n,bs,nparts,p,i,k,lo,hi,rstart,rend,cstart,cend,*ii,*jj;
+  PetscInt64     header[16],*index,*rows,*cols;
+  PetscScalar    *aa;
+  MatMmap_AIJ    *mm;
+  void           *ptr;
+  off_t          start;
+  int            fd;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryMmapBegin(viewer,&fd,&start);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start,sizeof(header),&ptr);CHKERRQ(ierr);
+  ierr = PetscMemcpy(header,ptr,sizeof(header));CHKERRQ(ierr);
+  ierr = PetscBinaryUnmap(ptr,sizeof(header));CHKERRQ(ierr);
+  if (header[0] != PETSC_VIEWER_BINARY_MMAP_MAGIC) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Not an object in the memory-mapped format, or written with a different byte order");
+  if (header[1] != PETSC_VIEWER_BINARY_MMAP_VERSION) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Memory-mapped format version %D is not supported",(PetscInt)header[1]);
+  if (header[2] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Not a matrix object");
+  if (header[3] != sizeof(PetscInt) || header[4] != sizeof(PetscScalar)) SETERRQ4(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"File has %D byte integers and %D byte scalars, this build of PETSc has %D and %D",(PetscInt)header[3],(PetscInt)header[4],(PetscInt)sizeof(PetscInt),(PetscInt)sizeof(PetscScalar));
+  M      = (PetscInt)header[5];
+  N      = (PetscInt)header[6];
+  bs     = (PetscInt)header[7];
+  nparts = (PetscInt)header[8];
+  ierr   = PetscBinaryMap(fd,start+sizeof(header),MATMMAP_INDEX(nparts)*sizeof(PetscInt64),&ptr);CHKERRQ(ierr);
+  index  = (PetscInt64*)ptr;
+  rows   = index;
+  cols   = index + nparts + 1;
+
+  /* if global sizes are set, check if they are consistent with that given in the file */
+  if (newMat->rmap->N >= 0 && newMat->rmap->N != M) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Inconsistent # of rows:Matrix in file has (%D) and input matrix has (%D)",M,newMat->rmap->N);
+  if (newMat->cmap->N >= 0 && newMat->cmap->N != N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Inconsistent # of cols:Matrix in file has (%D) and input matrix has (%D)",N,newMat->cmap->N);
+  /* keep the distribution of the file when it was written by as many processes */
+  if (nparts == size && newMat->rmap->n < 0 && newMat->cmap->n < 0) {
+    m = (PetscInt)(rows[rank+1] - rows[rank]);
+    n = (PetscInt)(cols[rank+1] - cols[rank]);
+  } else {
+    m = newMat->rmap->n;
+    n = newMat->cmap->n;
+  }
+  ierr = MatSetSizes(newMat,m,n,M,N);CHKERRQ(ierr);
+  if (newMat->rmap->bs < 0 && bs > 1 && (m < 0 || m%bs == 0) && (n < 0 || n%bs == 0)) {
+    ierr = MatSetBlockSize(newMat,bs);CHKERRQ(ierr);
+  }
+  ierr   = PetscLayoutSetUp(newMat->rmap);CHKERRQ(ierr);
+  ierr   = PetscLayoutSetUp(newMat->cmap);CHKERRQ(ierr);
+  rstart = newMat->rmap->rstart;
+  rend   = newMat->rmap->rend;
+  cstart = newMat->cmap->rstart;
+  cend   = newMat->cmap->rend;
+  m      = newMat->rmap->n;
+  n      = newMat->cmap->n;
+  ierr   = PetscObjectTypeCompare((PetscObject)newMat,MATSEQAIJ,&isseq);CHKERRQ(ierr);
+  ierr   = PetscObjectTypeCompare((PetscObject)newMat,MATMPIAIJ,&ismpi);CHKERRQ(ierr);
+  inplace = (isseq || ismpi) && !newMat->preallocated && nparts == size && rows[rank] == rstart && rows[rank+1] == rend && cols[rank] == cstart && cols[rank+1] == cend;
+  ierr    = MPI_Allreduce(&inplace,&allinplace,1,MPI_INT,MPI_LAND,comm);CHKERRQ(ierr);
+
+  if (allinplace) {
+    PetscContainer container;
+
+    ierr = PetscNew(&mm);CHKERRQ(ierr);
+    ierr = MatMmapMapRows_AIJ(fd,start,index+2*(nparts+1)+8*rank,0,m,PETSC_TRUE,mm);CHKERRQ(ierr);
+    if (isseq) {
+      Mat_SeqAIJ *a;
+
+      /* as MatCreateSeqAIJWithArrays() */
+      ierr = MatSeqAIJSetPreallocation_SeqAIJ(newMat,MAT_SKIP_ALLOCATION,0);CHKERRQ(ierr);
+      a    = (Mat_SeqAIJ*)newMat->data;
+      ierr = PetscMalloc2(m,&a->imax,m,&a->ilen);CHKERRQ(ierr);
+      a->i            = (PetscInt*)mm->p[0];
+      a->j            = (PetscInt*)mm->p[1];
+      a->a            = (PetscScalar*)mm->p[2];
+      a->singlemalloc = PETSC_FALSE;
+      a->nonew        = 0;
+      a->free_a       = PETSC_FALSE;
+      a->free_ij      = PETSC_FALSE;
+      for (i=0; i<m; i++) a->ilen[i] = a->imax[i] = a->i[i+1] - a->i[i];
+    } else {
+      Mat_MPIAIJ *aij = (Mat_MPIAIJ*)newMat->data;
+
+      /* as MatCreateMPIAIJWithSplitArrays(), the columns of the off-diagonal block are made local in place */
+      newMat->preallocated = PETSC_TRUE;
+      ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,m,n,(PetscInt*)mm->p[0],(PetscInt*)mm->p[1],(PetscScalar*)mm->p[2],&aij->A);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)newMat,(PetscObject)aij->A);CHKERRQ(ierr);
+      ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,m,N,(PetscInt*)mm->p[3],(PetscInt*)mm->p[4],(PetscScalar*)mm->p[5],&aij->B);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)newMat,(PetscObject)aij->B);CHKERRQ(ierr);
+      /* unlike user arrays, the mapped pages may be left for allocated memory when a new nonzero needs room */
+      ((Mat_SeqAIJ*)aij->A->data)->nonew = 0;
+      ((Mat_SeqAIJ*)aij->B->data)->nonew = 0;
+      ierr = MatStashSetOwners_Private(&newMat->stash,newMat->rmap->range,MatStashInsert_MPIAIJ);CHKERRQ(ierr);
+    }
+    ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+    ierr = PetscContainerSetPointer(container,mm);CHKERRQ(ierr);
+    ierr = PetscContainerSetUserDestroy(container,MatMmapDestroy_AIJ);CHKERRQ(ierr);
+    ierr = PetscObjectCompose((PetscObject)newMat,"MatLoad_AIJ_BinaryMmap",(PetscObject)container);CHKERRQ(ierr);
+    ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+    ierr = MatAssemblyBegin(newMat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(newMat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  } else {
+    MatMmap_AIJ rmm;
+
+    /* count the nonzeros of each row, then merge the two blocks of the parts that hold the rows */
+    ierr = PetscMalloc1(m+1,&ii);CHKERRQ(ierr);
+    ii[0] = 0;
+    for (p=0; p<nparts; p++) {
+      lo = PetscMax(rstart,(PetscInt)rows[p]);
+      hi = PetscMin(rend,(PetscInt)rows[p+1]);
+      if (lo >= hi) continue;
+      ierr = MatMmapMapRows_AIJ(fd,start,index+2*(nparts+1)+8*p,lo-(PetscInt)rows[p],hi-(PetscInt)rows[p],PETSC_FALSE,&rmm);CHKERRQ(ierr);
+      for (i=lo; i<hi; i++) {
+        PetscInt *di = (PetscInt*)rmm.p[0],*oi = (PetscInt*)rmm.p[3];
+        ii[i-rstart+1] = di[i-lo+1] - di[i-lo] + oi[i-lo+1] - oi[i-lo];
+      }
+      ierr = MatMmapUnmap_AIJ(&rmm);CHKERRQ(ierr);
+    }
+    for (i=0; i<m; i++) ii[i+1] += ii[i];
+    ierr = PetscMalloc2(ii[m],&jj,ii[m],&aa);CHKERRQ(ierr);
+    for (p=0; p<nparts; p++) {
+      PetscInt    *di,*dj,*oi,*oj,c0 = (PetscInt)cols[p],d,o;
+      PetscScalar *da,*oa;
+
+      lo = PetscMax(rstart,(PetscInt)rows[p]);
+      hi = PetscMin(rend,(PetscInt)rows[p+1]);
+      if (lo >= hi) continue;
+      ierr = MatMmapMapRows_AIJ(fd,start,index+2*(nparts+1)+8*p,lo-(PetscInt)rows[p],hi-(PetscInt)rows[p],PETSC_TRUE,&rmm);CHKERRQ(ierr);
+      di = (PetscInt*)rmm.p[0]; dj = (PetscInt*)rmm.p[1]; da = (PetscScalar*)rmm.p[2];
+      oi = (PetscInt*)rmm.p[3]; oj = (PetscInt*)rmm.p[4]; oa = (PetscScalar*)rmm.p[5];
+      for (i=lo; i<hi; i++) {
+        k = ii[i-rstart];
+        d = di[i-lo] - di[0];
+        o = oi[i-lo] - oi[0];
+        /* the off-diagonal block has no columns in [cols[p],cols[p+1]) */
+        for (; o<oi[i-lo+1]-oi[0] && oj[o]<c0; o++,k++) {jj[k] = oj[o]; aa[k] = oa[o];}
+        for (; d<di[i-lo+1]-di[0]; d++,k++)             {jj[k] = dj[d] + c0; aa[k] = da[d];}
+        for (; o<oi[i-lo+1]-oi[0]; o++,k++)              {jj[k] = oj[o]; aa[k] = oa[o];}
+      }
+      ierr = MatMmapUnmap_AIJ(&rmm);CHKERRQ(ierr);
+    }
+    ierr = MatSeqAIJSetPreallocationCSR(newMat,ii,jj,aa);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocationCSR(newMat,ii,jj,aa);CHKERRQ(ierr);
+    ierr = PetscFree(ii);CHKERRQ(ierr);
+    ierr = PetscFree2(jj,aa);CHKERRQ(ierr);
+  }
+  ierr = PetscViewerBinaryMmapEnd(viewer,start+(off_t)header[9]);CHKERRQ(ierr);
+  ierr = PetscBinaryUnmap(index,MATMMAP_INDEX(nparts)*sizeof(PetscInt64));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -4,6 +4,7 @@
 */
 #include <../src/mat/impls/aij/mpi/mpiaij.h>
 #include <petsc/private/isimpl.h>    /* needed because accesses data structure of ISLocalToGlobalMapping directly */
+#include <../src/sys/utils/hash.h>
 
 #undef __FUNCT__
 #define __FUNCT__ "MatSetUpMultiply_MPIAIJ"
@@ -16,47 +17,36 @@ PetscErrorCode MatSetUpMultiply_MPIAIJ(Mat mat)
   IS             from,to;
   Vec            gvec;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable         gid1_lid1;
-  PetscTablePosition tpos;
-  PetscInt           gid,lid;
+  PetscHMapI     gid_lid;
+  PetscInt       lid;
+  PetscBool      missing = PETSC_FALSE;
 #else
   PetscInt N = mat->cmap->N,*indices;
 #endif
 
   PetscFunctionBegin;
 #if defined(PETSC_USE_CTABLE)
-  /* use a table */
-  ierr = PetscTableCreate(aij->B->rmap->n,mat->cmap->N+1,&gid1_lid1);CHKERRQ(ierr);
+  /* use a hash map */
+  ierr = PetscHMapICreate(&gid_lid);CHKERRQ(ierr);
+  ierr = PetscHMapIResize(gid_lid,aij->B->rmap->n);CHKERRQ(ierr);
   for (i=0; i<aij->B->rmap->n; i++) {
     for (j=0; j<B->ilen[i]; j++) {
-      PetscInt data,gid1 = aj[B->i[i] + j] + 1;
-      ierr = PetscTableFind(gid1_lid1,gid1,&data);CHKERRQ(ierr);
-      if (!data) {
-        /* one based table */
-        ierr = PetscTableAdd(gid1_lid1,gid1,++ec,INSERT_VALUES);CHKERRQ(ierr);
-      }
+      ierr = PetscHMapIQuerySet(gid_lid,aj[B->i[i] + j],ec,&missing);CHKERRQ(ierr);
+      if (missing) ec++;
     }
   }
   /* form array of columns we need */
   ierr = PetscMalloc1(ec+1,&garray);CHKERRQ(ierr);
-  ierr = PetscTableGetHeadPosition(gid1_lid1,&tpos);CHKERRQ(ierr);
-  while (tpos) {
-    ierr = PetscTableGetNext(gid1_lid1,&tpos,&gid,&lid);CHKERRQ(ierr);
-    gid--;
-    lid--;
-    garray[lid] = gid;
-  }
+  lid  = 0;
+  ierr = PetscHMapIGetPairs(gid_lid,&lid,garray,NULL);CHKERRQ(ierr);
   ierr = PetscSortInt(ec,garray);CHKERRQ(ierr); /* sort, and rebuild */
-  ierr = PetscTableRemoveAll(gid1_lid1);CHKERRQ(ierr);
   for (i=0; i<ec; i++) {
-    ierr = PetscTableAdd(gid1_lid1,garray[i]+1,i+1,INSERT_VALUES);CHKERRQ(ierr);
+    ierr = PetscHMapISet(gid_lid,garray[i],i);CHKERRQ(ierr);
   }
   /* compact out the extra columns in B */
   for (i=0; i<aij->B->rmap->n; i++) {
     for (j=0; j<B->ilen[i]; j++) {
-      PetscInt gid1 = aj[B->i[i] + j] + 1;
-      ierr = PetscTableFind(gid1_lid1,gid1,&lid);CHKERRQ(ierr);
-      lid--;
+      ierr = PetscHMapIGet(gid_lid,aj[B->i[i] + j],&lid);CHKERRQ(ierr);
       aj[B->i[i] + j] = lid;
     }
   }
@@ -64,7 +54,7 @@ PetscErrorCode MatSetUpMultiply_MPIAIJ(Mat mat)
   aij->B->cmap->bs = 1;
 
   ierr = PetscLayoutSetUp((aij->B->cmap));CHKERRQ(ierr);
-  ierr = PetscTableDestroy(&gid1_lid1);CHKERRQ(ierr);
+  ierr = PetscHMapIDestroy(&gid_lid);CHKERRQ(ierr);
 #else
   /* Make an array as long as the number of columns */
   /* mark those columns that are in aij->B */
@@ -7,6 +7,7 @@
 #include <../src/mat/impls/aij/mpi/mpiaij.h>
 #include <petscbt.h>
 #include <petscsf.h>
+#include <../src/sys/utils/hash.h>
 
 static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat,PetscInt,IS*);
 static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat,PetscInt,char**,PetscInt*,PetscInt**);
@@ -1210,7 +1211,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
   PetscInt       **rbuf3,*req_source,**sbuf_aj,**rbuf2,max1,max2;
   PetscInt       **lens,is_no,ncols,*cols,mat_i,*mat_j,tmp2,jmax;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable *cmap,cmap_i=NULL,*rmap,rmap_i;
+  PetscHMapI *cmap,cmap_i=NULL,*rmap,rmap_i;
 #else
   PetscInt **cmap,*cmap_i=NULL,**rmap,*rmap_i;
 #endif
@@ -1547,13 +1548,14 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
     ierr = PetscMalloc1(1+ismax,&cmap);CHKERRQ(ierr);
     for (i=0; i<ismax; i++) {
       if (!allcolumns[i]) {
-        ierr = PetscTableCreate(ncol[i]+1,C->cmap->N+1,&cmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapICreate(&cmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapIResize(cmap[i],ncol[i]);CHKERRQ(ierr);
 
         jmax   = ncol[i];
         icol_i = icol[i];
         cmap_i = cmap[i];
         for (j=0; j<jmax; j++) {
-          ierr = PetscTableAdd(cmap[i],icol_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = PetscHMapISet(cmap[i],icol_i[j],j);CHKERRQ(ierr);
         }
       } else {
         cmap[i] = NULL;
@@ -1603,7 +1605,8 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
         if (!allcolumns[i]) {
           for (k=0; k<ncols; k++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,cols[k]+1,&tcol);CHKERRQ(ierr);
+            ierr = PetscHMapIGet(cmap_i,cols[k],&tcol);CHKERRQ(ierr);
+            tcol++;
 #else
             tcol = cmap_i[cols[k]];
 #endif
@@ -1621,11 +1624,12 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
 #if defined(PETSC_USE_CTABLE)
   ierr = PetscMalloc1(1+ismax,&rmap);CHKERRQ(ierr);
   for (i=0; i<ismax; i++) {
-    ierr   = PetscTableCreate(nrow[i]+1,C->rmap->N+1,&rmap[i]);CHKERRQ(ierr);
+    ierr   = PetscHMapICreate(&rmap[i]);CHKERRQ(ierr);
+    ierr   = PetscHMapIResize(rmap[i],nrow[i]);CHKERRQ(ierr);
     irow_i = irow[i];
     jmax   = nrow[i];
     for (j=0; j<jmax; j++) {
-      ierr = PetscTableAdd(rmap[i],irow_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = PetscHMapISet(rmap[i],irow_i[j],j);CHKERRQ(ierr);
     }
   }
 #else
@@ -1666,8 +1670,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
         rmap_i = rmap[is_no];
         for (k=0; k<max1; k++,ct1++) {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableFind(rmap_i,sbuf1_i[ct1]+1,&row);CHKERRQ(ierr);
-          row--;
+          ierr = PetscHMapIGet(rmap_i,sbuf1_i[ct1],&row);CHKERRQ(ierr);
           if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
 #else
           row = rmap_i[sbuf1_i[ct1]]; /* the val in the new matrix to be */
@@ -1676,7 +1679,8 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
           for (l=0; l<max2; l++,ct2++) {
             if (!allcolumns[is_no]) {
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGet(cmap_i,rbuf3_i[ct2],&tcol);CHKERRQ(ierr);
+              tcol++;
 #else
               tcol = cmap_i[rbuf3_i[ct2]];
 #endif
@@ -1752,8 +1756,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
         if (proc == rank) {
           old_row = row;
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableFind(rmap_i,row+1,&row);CHKERRQ(ierr);
-          row--;
+          ierr = PetscHMapIGet(rmap_i,row,&row);CHKERRQ(ierr);
 #else
           row = rmap_i[row];
 #endif
@@ -1765,7 +1768,8 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
           if (!allcolumns[i]) {
             for (k=0; k<ncols; k++) {
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(cmap_i,cols[k]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGet(cmap_i,cols[k],&tcol);CHKERRQ(ierr);
+              tcol++;
 #else
               tcol = cmap_i[cols[k]];
 #endif
@@ -1819,8 +1823,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
         for (k=0; k<max1; k++,ct1++) {
           row = sbuf1_i[ct1];
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableFind(rmap_i,row+1,&row);CHKERRQ(ierr);
-          row--;
+          ierr = PetscHMapIGet(rmap_i,row,&row);CHKERRQ(ierr);
 #else
           row = rmap_i[row];
 #endif
@@ -1833,7 +1836,8 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
             for (l=0; l<max2; l++,ct2++) {
 
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGet(cmap_i,rbuf3_i[ct2],&tcol);CHKERRQ(ierr);
+              tcol++;
 #else
               tcol = cmap_i[rbuf3_i[ct2]];
 #endif
@@ -1920,7 +1924,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
   ierr = PetscFree(sbuf_aa);CHKERRQ(ierr);
 
 #if defined(PETSC_USE_CTABLE)
-  for (i=0; i<ismax; i++) {ierr = PetscTableDestroy((PetscTable*)&rmap[i]);CHKERRQ(ierr);}
+  for (i=0; i<ismax; i++) {ierr = PetscHMapIDestroy(&rmap[i]);CHKERRQ(ierr);}
 #else
   if (ismax) {ierr = PetscFree(rmap[0]);CHKERRQ(ierr);}
 #endif
@@ -1929,7 +1933,7 @@ PetscErrorCode MatGetSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS isro
   for (i=0; i<ismax; i++) {
     if (!allcolumns[i]) {
 #if defined(PETSC_USE_CTABLE)
-      ierr = PetscTableDestroy((PetscTable*)&cmap[i]);CHKERRQ(ierr);
+      ierr = PetscHMapIDestroy(&cmap[i]);CHKERRQ(ierr);
 #else
       ierr = PetscFree(cmap[i]);CHKERRQ(ierr);
 #endif
@@ -7,8 +7,10 @@
 #include <../src/mat/impls/aij/seq/aij.h>   /*I "petscmat.h" I*/
 #include <../src/mat/utils/freespace.h>
 #include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <petsc/private/vecimpl.h>
 #include <petscbt.h>
 #include <petsctime.h>
+#include <../src/sys/utils/hash.h>
 
 /* #define PTAP_PROFILE */
 
@@ -139,7 +141,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
   Mat_SeqAIJ          *p_loc,*p_oth,*ad=(Mat_SeqAIJ*)(a->A)->data,*ao=(Mat_SeqAIJ*)(a->B)->data,*c_loc,*c_oth;
   PetscScalar         *apv;
   PetscTable          ta;
-  const char          *algTypes[2] = {"scalable","nonscalable"};
+  const char          *algTypes[4] = {"scalable","nonscalable","allatonce","allatonce_merged"};
   PetscInt            alg=1; /* set default algorithm */
 #if defined(PETSC_USE_INFO)
   PetscReal           apfill; 
@@ -149,6 +151,14 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
 #endif
 
   PetscFunctionBegin;
+  ierr = PetscObjectOptionsBegin((PetscObject)A);CHKERRQ(ierr);
+  ierr = PetscOptionsEList("-matptap_via","Algorithmic approach","MatPtAP",algTypes,4,algTypes[1],&alg,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (alg > 1) { /* all-at-once algorithm, does not form A*P */
+    ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(A,P,fill,(PetscBool)(alg == 3),C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
   ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
@@ -450,10 +460,6 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
   ptap->duplicate = Cmpi->ops->duplicate;
   ptap->destroy   = Cmpi->ops->destroy;
 
-  ierr = PetscObjectOptionsBegin((PetscObject)A);CHKERRQ(ierr);
-  ierr = PetscOptionsEList("-matptap_via","Algorithmic approach","MatPtAP",algTypes,2,algTypes[1],&alg,NULL);CHKERRQ(ierr);
-  ierr = PetscOptionsEnd();CHKERRQ(ierr);
-
   if (alg == 1) {
     /* Do dense axpy in MatPtAPNumeric_MPIAIJ_MPIAIJ() */
     ierr = PetscCalloc1(pN,&ptap->apa);CHKERRQ(ierr);
@@ -1326,3 +1332,552 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_ptap(Mat A,Mat P,Mat C)
 #endif
   PetscFunctionReturn(0);
 }
+
+/* ------------------------------------------------------------------------------------------------------- */
+/*
+   The all-at-once algorithm, -matptap_via allatonce or allatonce_merged: row i of C = P^T*A*P gets the
+   contribution P(i,I)*AP(i,:) for each nonzero P(i,I) of the local row i of P. Each row of A*P is computed,
+   used and discarded, so A*P is never stored; the only large data kept between MatPtAPSymbolic() and
+   MatPtAPNumeric() are P_oth and the rows of C that this process contributes to: C_loc, the rows owned by this
+   process (the columns of the diagonal part of P), and C_oth, the rows owned by other processes (the columns of the
+   off-diagonal part of P), both with global column indices.
+*/
+extern PetscErrorCode MatGetRow_MPIAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
+extern PetscErrorCode MatRestoreRow_MPIAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPGetAPRow_Private"
+/*
+   Computes the row i of A*P, in the unsorted columns apj[] and values apv[] (if apv is not NULL), from the rows of P
+   owned by this process (diag, the diagonal part of A) and/or the rows of P_oth (offdiag, the off-diagonal part of A).
+   The hash map ht maps the column of each entry to its location in apj[]; apj[] must be large enough.
+*/
+static PetscErrorCode MatPtAPGetAPRow_Private(Mat A,Mat P,Mat P_oth,PetscInt i,PetscBool diag,PetscBool offdiag,PetscHMapI ht,PetscInt *nap,PetscInt *apj,PetscScalar *apv)
+{
+  PetscErrorCode ierr;
+  Mat_MPIAIJ     *a=(Mat_MPIAIJ*)A->data,*p=(Mat_MPIAIJ*)P->data;
+  Mat_SeqAIJ     *ad=(Mat_SeqAIJ*)(a->A)->data,*ao=(Mat_SeqAIJ*)(a->B)->data;
+  Mat_SeqAIJ     *pd=(Mat_SeqAIJ*)(p->A)->data,*po=(Mat_SeqAIJ*)(p->B)->data,*p_oth=(Mat_SeqAIJ*)P_oth->data;
+  PetscInt       k,l,r,col,loc,n=0,cstart=P->cmap->rstart;
+  PetscScalar    av=0.0;
+
+  PetscFunctionBegin;
+  ierr = PetscHMapIClear(ht);CHKERRQ(ierr);
+#define MatPtAPAddToAPRow_Private(c,v) do {                                                              \
+    ierr = PetscHMapIGet(ht,(c),&loc);CHKERRQ(ierr);                                                  \
+    if (loc >= 0) {                                                                                   \
+      if (apv) apv[loc] += (v);                                                                       \
+    } else {                                                                                          \
+      ierr = PetscHMapISet(ht,(c),n);CHKERRQ(ierr);                                                   \
+      apj[n] = (c);                                                                                   \
+      if (apv) apv[n] = (v);                                                                          \
+      n++;                                                                                            \
+    }                                                                                                 \
+  } while (0)
+  if (diag) {
+    for (k=ad->i[i]; k<ad->i[i+1]; k++) {
+      r = ad->j[k];
+      if (apv) av = ad->a[k];
+      for (l=pd->i[r]; l<pd->i[r+1]; l++) {
+        col = pd->j[l] + cstart;
+        MatPtAPAddToAPRow_Private(col,apv ? av*pd->a[l] : 0.0);
+      }
+      for (l=po->i[r]; l<po->i[r+1]; l++) {
+        col = p->garray[po->j[l]];
+        MatPtAPAddToAPRow_Private(col,apv ? av*po->a[l] : 0.0);
+      }
+    }
+  }
+  if (offdiag) {
+    for (k=ao->i[i]; k<ao->i[i+1]; k++) {
+      r = ao->j[k];
+      if (apv) av = ao->a[k];
+      for (l=p_oth->i[r]; l<p_oth->i[r+1]; l++) {
+        col = p_oth->j[l];
+        MatPtAPAddToAPRow_Private(col,apv ? av*p_oth->a[l] : 0.0);
+      }
+    }
+  }
+#undef MatPtAPAddToAPRow_Private
+  *nap = n;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce"
+PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,PetscReal fill,PetscBool merged,Mat *C)
+{
+  PetscErrorCode      ierr;
+  Mat_PtAPMPI         *ptap;
+  Mat_MPIAIJ          *a=(Mat_MPIAIJ*)A->data,*p=(Mat_MPIAIJ*)P->data,*c;
+  Mat_SeqAIJ          *ad=(Mat_SeqAIJ*)(a->A)->data,*ao=(Mat_SeqAIJ*)(a->B)->data;
+  Mat_SeqAIJ          *pd=(Mat_SeqAIJ*)(p->A)->data,*po=(Mat_SeqAIJ*)(p->B)->data,*p_oth,*cseq;
+  MPI_Comm            comm;
+  PetscMPIInt         size,rank,tagi,tagj,*len_si,*len_s,*len_ri,*len_r,*id_r,icompleted=0,nrecv;
+  Mat                 Cmpi;
+  PetscHMapI          ht;
+  PetscHSetI          *hc[2];
+  PetscInt            am=A->rmap->n,pn=P->cmap->n,pN=P->cmap->N,no=p->B->cmap->n,nc[2],*ci[2],*cj[2];
+  PetscInt            i,j,k,l,t,r,row,len,nap,apmax=0,bound,nzi,nsend,nrows,proc,Crmax;
+  PetscInt            *apj,*lnk,*rowj,*dnz,*onz,*owners,*prmap=p->garray,*coi,*coj,*owners_co;
+  PetscInt            **buf_rj,**buf_ri,**buf_ri_k,**nextrow,**nextci,*buf_s,*buf_si,*buf_si_i,*crlen;
+  PetscScalar         *ca;
+  MPI_Request         *swaits,*rwaits;
+  MPI_Status          *sstatus,rstatus;
+  PetscLayout         rowmap;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+
+  /* create struct Mat_PtAPMPI and attached it to C later */
+  ierr        = PetscNew(&ptap);CHKERRQ(ierr);
+  ptap->reuse = MAT_INITIAL_MATRIX;
+
+  /* get P_oth by taking rows of P (= non-zero cols of local A) from other processors */
+  ierr  = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_INITIAL_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+  p_oth = (Mat_SeqAIJ*)(ptap->P_oth)->data;
+
+  /* (1) the nonzero structure of the rows of C this process contributes to, accumulated in one hash set
+         per row: hc[0] for the rows of C_loc and hc[1] for the rows of C_oth */
+  nc[0] = pn; nc[1] = no;
+  ierr  = PetscCalloc1(pn,&hc[0]);CHKERRQ(ierr);
+  ierr  = PetscCalloc1(no,&hc[1]);CHKERRQ(ierr);
+  len   = 16;
+  ierr  = PetscMalloc1(len,&apj);CHKERRQ(ierr);
+  ierr  = PetscHMapICreate(&ht);CHKERRQ(ierr);
+  ierr  = PetscHMapIResize(ht,len);CHKERRQ(ierr);
+  for (i=0; i<am; i++) {
+    if (pd->i[i+1] == pd->i[i] && po->i[i+1] == po->i[i]) continue; /* row i of P is empty */
+    /* an upper bound for the number of nonzeros of row i of A*P */
+    bound = 0;
+    for (k=ad->i[i]; k<ad->i[i+1]; k++) {
+      r      = ad->j[k];
+      bound += pd->i[r+1] - pd->i[r] + po->i[r+1] - po->i[r];
+    }
+    for (k=ao->i[i]; k<ao->i[i+1]; k++) {
+      r      = ao->j[k];
+      bound += p_oth->i[r+1] - p_oth->i[r];
+    }
+    if (bound > len) {
+      len  = PetscMax(bound,2*len);
+      ierr = PetscFree(apj);CHKERRQ(ierr);
+      ierr = PetscMalloc1(len,&apj);CHKERRQ(ierr);
+    }
+    ierr  = MatPtAPGetAPRow_Private(A,P,ptap->P_oth,i,PETSC_TRUE,PETSC_TRUE,ht,&nap,apj,NULL);CHKERRQ(ierr);
+    apmax = PetscMax(apmax,nap);
+    if (!nap) continue;
+    for (t=0; t<2; t++) {
+      Mat_SeqAIJ *pp = t ? po : pd;
+      for (l=pp->i[i]; l<pp->i[i+1]; l++) {
+        row = pp->j[l];
+        if (!hc[t][row]) {
+          ierr = PetscHSetICreate(&hc[t][row]);CHKERRQ(ierr);
+          ierr = PetscHSetIResize(hc[t][row],nap);CHKERRQ(ierr);
+        }
+        for (k=0; k<nap; k++) {ierr = PetscHSetIAdd(hc[t][row],apj[k]);CHKERRQ(ierr);}
+      }
+    }
+  }
+  ierr = PetscHMapIDestroy(&ht);CHKERRQ(ierr);
+  ierr = PetscFree(apj);CHKERRQ(ierr);
+  ptap->apnzmax = apmax;
+
+  /* (2) C_loc and C_oth as SeqAIJ matrices with sorted global column indices */
+  for (t=0; t<2; t++) {
+    ierr     = PetscMalloc1(nc[t]+1,&ci[t]);CHKERRQ(ierr);
+    ci[t][0] = 0;
+    for (row=0; row<nc[t]; row++) {
+      nzi = 0;
+      if (hc[t][row]) {ierr = PetscHSetIGetSize(hc[t][row],&nzi);CHKERRQ(ierr);}
+      ci[t][row+1] = ci[t][row] + nzi;
+    }
+    ierr = PetscMalloc1(ci[t][nc[t]]+1,&cj[t]);CHKERRQ(ierr);
+    ierr = PetscCalloc1(ci[t][nc[t]]+1,&ca);CHKERRQ(ierr);
+    for (row=0; row<nc[t]; row++) {
+      if (!hc[t][row]) continue;
+      rowj = cj[t] + ci[t][row];
+      k    = 0;
+      ierr = PetscHSetIGetElems(hc[t][row],&k,rowj);CHKERRQ(ierr);
+      ierr = PetscSortInt(k,rowj);CHKERRQ(ierr);
+      ierr = PetscHSetIDestroy(&hc[t][row]);CHKERRQ(ierr);
+    }
+    ierr = PetscFree(hc[t]);CHKERRQ(ierr);
+    ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,nc[t],pN,ci[t],cj[t],ca,t ? &ptap->C_oth : &ptap->C_loc);CHKERRQ(ierr);
+    /* let C_loc and C_oth free their arrays */
+    cseq          = (Mat_SeqAIJ*)(t ? ptap->C_oth : ptap->C_loc)->data;
+    cseq->free_a  = PETSC_TRUE;
+    cseq->free_ij = PETSC_TRUE;
+    cseq->nonew   = 0;
+  }
+  ierr = PetscInfo4(A,"All-at-once PtAP: largest row of A*P has %D nonzeros, C_loc has %D and C_oth %D nonzeros%s\n",apmax,ci[0][pn],ci[1][no],merged ? ", overlapping the communication of P_oth" : "");CHKERRQ(ierr);
+
+  /* (3) send coj of C_oth to other processors  */
+  /* ------------------------------------------ */
+  /* determine row ownership */
+  ierr = PetscLayoutCreate(comm,&rowmap);CHKERRQ(ierr);
+  rowmap->n  = pn;
+  rowmap->bs = 1;
+  ierr   = PetscLayoutSetUp(rowmap);CHKERRQ(ierr);
+  owners = rowmap->range;
+
+  /* determine the number of messages to send, their lengths */
+  ierr = PetscMalloc4(size,&len_s,size,&len_si,size,&sstatus,size+2,&owners_co);CHKERRQ(ierr);
+  ierr = PetscMemzero(len_s,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = PetscMemzero(len_si,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
+
+  coi  = ci[1]; coj = cj[1];
+  proc = 0;
+  for (i=0; i<no; i++) {
+    while (prmap[i] >= owners[proc+1]) proc++;
+    len_si[proc]++;                   /* num of rows in C_oth to be sent to [proc] */
+    len_s[proc] += coi[i+1] - coi[i]; /* num of nonzeros in C_oth to be sent to [proc] */
+  }
+
+  len          = 0; /* max length of buf_si[], see (4) */
+  owners_co[0] = 0;
+  nsend        = 0;
+  for (proc=0; proc<size; proc++) {
+    owners_co[proc+1] = owners_co[proc] + len_si[proc];
+    if (len_s[proc]) {
+      nsend++;
+      len_si[proc] = 2*(len_si[proc] + 1); /* length of buf_si to be sent to [proc] */
+      len         += len_si[proc];
+    }
+  }
+
+  /* determine the number and length of messages to receive for coi and coj  */
+  ierr = PetscGatherNumberOfMessages(comm,NULL,len_s,&nrecv);CHKERRQ(ierr);
+  ierr = PetscGatherMessageLengths2(comm,nsend,nrecv,len_s,len_si,&id_r,&len_r,&len_ri);CHKERRQ(ierr);
+
+  /* post the Irecv and Isend of coj */
+  ierr = PetscCommGetNewTag(comm,&tagj);CHKERRQ(ierr);
+  ierr = PetscPostIrecvInt(comm,tagj,nrecv,id_r,len_r,&buf_rj,&rwaits);CHKERRQ(ierr);
+  ierr = PetscMalloc1(nsend+1,&swaits);CHKERRQ(ierr);
+  for (proc=0, k=0; proc<size; proc++) {
+    if (!len_s[proc]) continue;
+    i    = owners_co[proc];
+    ierr = MPI_Isend(coj+coi[i],len_s[proc],MPIU_INT,proc,tagj,comm,swaits+k);CHKERRQ(ierr);
+    k++;
+  }
+  for (i=0; i<nrecv; i++) {
+    ierr = MPI_Waitany(nrecv,rwaits,&icompleted,&rstatus);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(rwaits);CHKERRQ(ierr);
+  if (nsend) {ierr = MPI_Waitall(nsend,swaits,sstatus);CHKERRQ(ierr);}
+
+  /* (4) send and recv coi */
+  /*-----------------------*/
+  ierr   = PetscCommGetNewTag(comm,&tagi);CHKERRQ(ierr);
+  ierr   = PetscPostIrecvInt(comm,tagi,nrecv,id_r,len_ri,&buf_ri,&rwaits);CHKERRQ(ierr);
+  ierr   = PetscMalloc1(len+1,&buf_s);CHKERRQ(ierr);
+  buf_si = buf_s;  /* points to the beginning of k-th msg to be sent */
+  for (proc=0,k=0; proc<size; proc++) {
+    if (!len_s[proc]) continue;
+    /* form outgoing message for i-structure:
+         buf_si[0]:                 nrows to be sent
+               [1:nrows]:           row index (global)
+               [nrows+1:2*nrows+1]: i-structure index
+    */
+    /*-------------------------------------------*/
+    nrows       = len_si[proc]/2 - 1; /* num of rows in C_oth to be sent to [proc] */
+    buf_si_i    = buf_si + nrows+1;
+    buf_si[0]   = nrows;
+    buf_si_i[0] = 0;
+    nrows       = 0;
+    for (i=owners_co[proc]; i<owners_co[proc+1]; i++) {
+      nzi = coi[i+1] - coi[i];
+      buf_si_i[nrows+1] = buf_si_i[nrows] + nzi;  /* i-structure */
+      buf_si[nrows+1]   = prmap[i] -owners[proc]; /* local row index */
+      nrows++;
+    }
+    ierr = MPI_Isend(buf_si,len_si[proc],MPIU_INT,proc,tagi,comm,swaits+k);CHKERRQ(ierr);
+    k++;
+    buf_si += len_si[proc];
+  }
+  for (i=0; i<nrecv; i++) {
+    ierr = MPI_Waitany(nrecv,rwaits,&icompleted,&rstatus);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(rwaits);CHKERRQ(ierr);
+  if (nsend) {ierr = MPI_Waitall(nsend,swaits,sstatus);CHKERRQ(ierr);}
+
+  ierr = PetscFree4(len_s,len_si,sstatus,owners_co);CHKERRQ(ierr);
+  ierr = PetscFree(len_ri);CHKERRQ(ierr);
+  ierr = PetscFree(swaits);CHKERRQ(ierr);
+  ierr = PetscFree(buf_s);CHKERRQ(ierr);
+
+  /* (5) merge the rows of C_loc with the received rows of C_oth for the preallocation of C */
+  /* -------------------------------------------------------------------------------------- */
+  ierr = PetscMalloc3(nrecv,&buf_ri_k,nrecv,&nextrow,nrecv,&nextci);CHKERRQ(ierr);
+  ierr = PetscMalloc1(pn+1,&crlen);CHKERRQ(ierr);
+  for (i=0; i<pn; i++) crlen[i] = ci[0][i+1] - ci[0][i];
+  for (k=0; k<nrecv; k++) {
+    buf_ri_k[k] = buf_ri[k]; /* beginning of k-th recved i-structure */
+    nrows       = *buf_ri_k[k];
+    nextrow[k]  = buf_ri_k[k] + 1;  /* next row number of k-th recved i-structure */
+    nextci[k]   = buf_ri_k[k] + (nrows + 1); /* poins to the next i-structure of k-th recved i-structure  */
+    for (j=0; j<nrows; j++) crlen[nextrow[k][j]] += nextci[k][j+1] - nextci[k][j];
+  }
+  /* an upper bound for the number of nonzeros in a row of C */
+  Crmax = 0;
+  for (i=0; i<pn; i++) Crmax = PetscMax(Crmax,crlen[i]);
+  ierr = PetscFree(crlen);CHKERRQ(ierr);
+  ierr = PetscMalloc1(Crmax+1,&rowj);CHKERRQ(ierr);
+
+  ierr = MatPreallocateInitialize(comm,pn,pn,dnz,onz);CHKERRQ(ierr);
+  ierr = PetscLLCondensedCreate_Scalable(Crmax,&lnk);CHKERRQ(ierr);
+  for (i=0; i<pn; i++) {
+    /* add C_loc into Cmpi */
+    nzi  = ci[0][i+1] - ci[0][i];
+    ierr = PetscLLCondensedAddSorted_Scalable(nzi,cj[0]+ci[0][i],lnk);CHKERRQ(ierr);
+
+    /* add received col data into lnk */
+    for (k=0; k<nrecv; k++) { /* k-th received message */
+      if (i == *nextrow[k]) { /* i-th row */
+        nzi  = *(nextci[k]+1) - *nextci[k];
+        ierr = PetscLLCondensedAddSorted_Scalable(nzi,buf_rj[k] + *nextci[k],lnk);CHKERRQ(ierr);
+        nextrow[k]++; nextci[k]++;
+      }
+    }
+    nzi  = lnk[0];
+    ierr = PetscLLCondensedClean_Scalable(nzi,rowj,lnk);CHKERRQ(ierr);
+    ierr = MatPreallocateSet(i+owners[rank],nzi,rowj,dnz,onz);CHKERRQ(ierr);
+  }
+  ierr = PetscFree3(buf_ri_k,nextrow,nextci);CHKERRQ(ierr);
+  ierr = PetscLLCondensedDestroy_Scalable(lnk);CHKERRQ(ierr);
+  ierr = PetscFree(rowj);CHKERRQ(ierr);
+
+  /* (6) create symbolic parallel matrix Cmpi */
+  /*------------------------------------------*/
+  ierr = MatCreate(comm,&Cmpi);CHKERRQ(ierr);
+  ierr = MatSetSizes(Cmpi,pn,pn,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = MatSetBlockSizes(Cmpi,PetscAbs(P->cmap->bs),PetscAbs(P->cmap->bs));CHKERRQ(ierr);
+  ierr = MatSetType(Cmpi,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(Cmpi,0,dnz,0,onz);CHKERRQ(ierr);
+  ierr = MatPreallocateFinalize(dnz,onz);CHKERRQ(ierr);
+
+  ierr = PetscFree(id_r);CHKERRQ(ierr);
+  ierr = PetscFree(len_r);CHKERRQ(ierr);
+  ierr = PetscFree(buf_ri[0]);CHKERRQ(ierr);
+  ierr = PetscFree(buf_ri);CHKERRQ(ierr);
+  ierr = PetscFree(buf_rj[0]);CHKERRQ(ierr);
+  ierr = PetscFree(buf_rj);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&rowmap);CHKERRQ(ierr);
+
+  /* attach the supporting struct to Cmpi for reuse */
+  c = (Mat_MPIAIJ*)Cmpi->data;
+  c->ptap         = ptap;
+  ptap->duplicate = Cmpi->ops->duplicate;
+  ptap->destroy   = Cmpi->ops->destroy;
+
+  if (merged) Cmpi->ops->ptapnumeric = MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged;
+  else        Cmpi->ops->ptapnumeric = MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce;
+
+  /* Cmpi is not ready for use - assembly will be done by MatPtAPNumeric() */
+  Cmpi->assembled        = PETSC_FALSE;
+  Cmpi->ops->destroy     = MatDestroy_MPIAIJ_PtAP;
+  Cmpi->ops->duplicate   = MatDuplicate_MPIAIJ_MatPtAP;
+  *C                     = Cmpi;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPGetPothValuesBegin_Private"
+/*
+   Starts the communication of the values of P_oth, like MatGetBrowsOfAoCols_MPIAIJ() with MAT_REUSE_MATRIX
+   but without waiting for the messages to arrive, see MatPtAPGetPothValuesEnd_Private()
+*/
+static PetscErrorCode MatPtAPGetPothValuesBegin_Private(Mat A,Mat P,Mat_PtAPMPI *ptap,MPI_Request **rwaits,MPI_Request **swaits)
+{
+  PetscErrorCode         ierr;
+  Mat_MPIAIJ             *a=(Mat_MPIAIJ*)A->data;
+  Mat_SeqAIJ             *p_oth=(Mat_SeqAIJ*)(ptap->P_oth)->data;
+  VecScatter             ctx=a->Mvctx;
+  VecScatter_MPI_General *gen_to=(VecScatter_MPI_General*)ctx->todata,*gen_from=(VecScatter_MPI_General*)ctx->fromdata;
+  MPI_Comm               comm;
+  PetscMPIInt            tag=((PetscObject)ctx)->tag,rank;
+  PetscInt               i,j,k,l,ll,row,ncols,nrows,sbs=gen_to->bs;
+  PetscInt               *sstartsj=ptap->startsj_s,*rstartsj=ptap->startsj_r,*srow=gen_to->indices,*sstarts=gen_to->starts;
+  PetscScalar            *vals,*bufA;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = PetscMalloc2(gen_from->n,rwaits,gen_to->n,swaits);CHKERRQ(ierr);
+  for (i=0; i<gen_from->n; i++) {
+    ierr = MPI_Irecv(p_oth->a+rstartsj[i],rstartsj[i+1]-rstartsj[i],MPIU_SCALAR,gen_from->procs[i],tag,comm,*rwaits+i);CHKERRQ(ierr);
+  }
+  k = 0;
+  for (i=0; i<gen_to->n; i++) {
+    nrows = sstarts[i+1]-sstarts[i]; /* num of block rows */
+    bufA  = ptap->bufa+sstartsj[i];
+    for (j=0; j<nrows; j++) {
+      row = srow[k++] + P->rmap->range[rank];  /* global row idx */
+      for (ll=0; ll<sbs; ll++) {
+        ierr = MatGetRow_MPIAIJ(P,row+ll,&ncols,NULL,&vals);CHKERRQ(ierr);
+        for (l=0; l<ncols; l++) *bufA++ = vals[l];
+        ierr = MatRestoreRow_MPIAIJ(P,row+ll,&ncols,NULL,&vals);CHKERRQ(ierr);
+      }
+    }
+    ierr = MPI_Isend(ptap->bufa+sstartsj[i],sstartsj[i+1]-sstartsj[i],MPIU_SCALAR,gen_to->procs[i],tag,comm,*swaits+i);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPGetPothValuesEnd_Private"
+static PetscErrorCode MatPtAPGetPothValuesEnd_Private(Mat A,MPI_Request **rwaits,MPI_Request **swaits)
+{
+  PetscErrorCode         ierr;
+  Mat_MPIAIJ             *a=(Mat_MPIAIJ*)A->data;
+  VecScatter_MPI_General *gen_to=(VecScatter_MPI_General*)a->Mvctx->todata,*gen_from=(VecScatter_MPI_General*)a->Mvctx->fromdata;
+
+  PetscFunctionBegin;
+  if (gen_from->n) {ierr = MPI_Waitall(gen_from->n,*rwaits,MPI_STATUSES_IGNORE);CHKERRQ(ierr);}
+  if (gen_to->n) {ierr = MPI_Waitall(gen_to->n,*swaits,MPI_STATUSES_IGNORE);CHKERRQ(ierr);}
+  ierr = PetscFree2(*rwaits,*swaits);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPNumericRows_Private"
+/*
+   Adds P(i,:)^T*AP(i,:) to C_loc and C_oth for all local rows i, where AP(i,:) is computed from the diagonal
+   and/or the off-diagonal part of A
+*/
+static PetscErrorCode MatPtAPNumericRows_Private(Mat A,Mat P,Mat_PtAPMPI *ptap,PetscBool diag,PetscBool offdiag)
+{
+  PetscErrorCode ierr;
+  Mat_MPIAIJ     *p=(Mat_MPIAIJ*)P->data;
+  Mat_SeqAIJ     *pp[2],*cc[2];
+  PetscHMapI     ht;
+  PetscInt       am=A->rmap->n,i,k,l,t,row,nap,nzc,loc,*apj;
+  const PetscInt *rowj;
+  PetscScalar    *apv,*rowa,pv;
+  PetscLogDouble flops=0.0;
+
+  PetscFunctionBegin;
+  pp[0] = (Mat_SeqAIJ*)(p->A)->data;       pp[1] = (Mat_SeqAIJ*)(p->B)->data;
+  cc[0] = (Mat_SeqAIJ*)(ptap->C_loc)->data; cc[1] = (Mat_SeqAIJ*)(ptap->C_oth)->data;
+  ierr  = PetscMalloc2(ptap->apnzmax+1,&apj,ptap->apnzmax+1,&apv);CHKERRQ(ierr);
+  ierr  = PetscHMapICreate(&ht);CHKERRQ(ierr);
+  ierr  = PetscHMapIResize(ht,ptap->apnzmax+1);CHKERRQ(ierr);
+  for (i=0; i<am; i++) {
+    if (pp[0]->i[i+1] == pp[0]->i[i] && pp[1]->i[i+1] == pp[1]->i[i]) continue; /* row i of P is empty */
+    ierr = MatPtAPGetAPRow_Private(A,P,ptap->P_oth,i,diag,offdiag,ht,&nap,apj,apv);CHKERRQ(ierr);
+    if (!nap) continue;
+    for (t=0; t<2; t++) {
+      for (l=pp[t]->i[i]; l<pp[t]->i[i+1]; l++) {
+        row  = pp[t]->j[l];
+        pv   = pp[t]->a[l];
+        nzc  = cc[t]->i[row+1] - cc[t]->i[row];
+        rowj = cc[t]->j + cc[t]->i[row];
+        rowa = cc[t]->a + cc[t]->i[row];
+        for (k=0; k<nap; k++) {
+          ierr = PetscFindInt(apj[k],nzc,rowj,&loc);CHKERRQ(ierr);
+          if (loc < 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Column %D is not in the nonzero pattern of row %D of C, nonzero pattern of A or P changed",apj[k],row);
+          rowa[loc] += pv*apv[k];
+        }
+        flops += 2.0*nap;
+      }
+    }
+  }
+  ierr = PetscHMapIDestroy(&ht);CHKERRQ(ierr);
+  ierr = PetscFree2(apj,apv);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_Private"
+static PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_Private(Mat A,Mat P,Mat C,PetscBool merged)
+{
+  PetscErrorCode ierr;
+  Mat_MPIAIJ     *p=(Mat_MPIAIJ*)P->data,*c=(Mat_MPIAIJ*)C->data;
+  Mat_PtAPMPI    *ptap=c->ptap;
+  Mat_SeqAIJ     *c_seq;
+  MPI_Request    *rwaits,*swaits;
+  PetscInt       i,t,row,ncols,rstart;
+  const PetscInt *cols;
+  PetscScalar    *vals;
+
+  PetscFunctionBegin;
+  ierr = MatZeroEntries(C);CHKERRQ(ierr);
+  for (t=0; t<2; t++) {
+    c_seq = (Mat_SeqAIJ*)(t ? ptap->C_oth : ptap->C_loc)->data;
+    ierr  = PetscMemzero(c_seq->a,c_seq->i[(t ? ptap->C_oth : ptap->C_loc)->rmap->n]*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  /* P_oth got its values in MatPtAPSymbolic() when reuse == MAT_INITIAL_MATRIX */
+  if (!merged) {
+    if (ptap->reuse == MAT_REUSE_MATRIX) {
+      ierr = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_REUSE_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+    }
+    ierr = MatPtAPNumericRows_Private(A,P,ptap,PETSC_TRUE,PETSC_TRUE);CHKERRQ(ierr);
+  } else {
+    /* the diagonal part of A only needs the local rows of P: compute its contribution while P_oth is on its way */
+    if (ptap->reuse == MAT_REUSE_MATRIX) {
+      ierr = PetscLogEventBegin(MAT_GetBrowsOfAocols,A,P,0,0);CHKERRQ(ierr);
+      ierr = MatPtAPGetPothValuesBegin_Private(A,P,ptap,&rwaits,&swaits);CHKERRQ(ierr);
+      ierr = PetscLogEventEnd(MAT_GetBrowsOfAocols,A,P,0,0);CHKERRQ(ierr);
+    }
+    ierr = MatPtAPNumericRows_Private(A,P,ptap,PETSC_TRUE,PETSC_FALSE);CHKERRQ(ierr);
+    if (ptap->reuse == MAT_REUSE_MATRIX) {
+      ierr = PetscLogEventBegin(MAT_GetBrowsOfAocols,A,P,0,0);CHKERRQ(ierr);
+      ierr = MatPtAPGetPothValuesEnd_Private(A,&rwaits,&swaits);CHKERRQ(ierr);
+      ierr = PetscLogEventEnd(MAT_GetBrowsOfAocols,A,P,0,0);CHKERRQ(ierr);
+    }
+    ierr = MatPtAPNumericRows_Private(A,P,ptap,PETSC_FALSE,PETSC_TRUE);CHKERRQ(ierr);
+  }
+
+  /* C_loc -> C */
+  ierr  = MatGetOwnershipRange(C,&rstart,NULL);CHKERRQ(ierr);
+  c_seq = (Mat_SeqAIJ*)(ptap->C_loc)->data;
+  cols  = c_seq->j;
+  vals  = c_seq->a;
+  for (i=0; i<ptap->C_loc->rmap->n; i++) {
+    ncols = c_seq->i[i+1] - c_seq->i[i];
+    row   = rstart + i;
+    ierr  = MatSetValues(C,1,&row,ncols,cols,vals,ADD_VALUES);CHKERRQ(ierr);
+    cols += ncols; vals += ncols;
+  }
+
+  /* C_oth -> C, off-processor part */
+  c_seq = (Mat_SeqAIJ*)(ptap->C_oth)->data;
+  cols  = c_seq->j;
+  vals  = c_seq->a;
+  for (i=0; i<ptap->C_oth->rmap->n; i++) {
+    ncols = c_seq->i[i+1] - c_seq->i[i];
+    row   = p->garray[i];
+    if (ncols) {ierr = MatSetValues(C,1,&row,ncols,cols,vals,ADD_VALUES);CHKERRQ(ierr);}
+    cols += ncols; vals += ncols;
+  }
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ptap->reuse = MAT_REUSE_MATRIX;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce"
+PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_Private(A,P,C,PETSC_FALSE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged"
+PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,Mat C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce_Private(A,P,C,PETSC_TRUE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,283 @@
+
+/*
+  Defines the MATMPISELL matrix class: an MPIAIJ matrix whose diagonal and
+  off-diagonal blocks are MATSEQSELL matrices, so that the local parts of the
+  matrix-vector products use the sliced ELLPACK kernels.
+*/
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/sell/sell.h>
+
+typedef struct {
+  PetscInt C;     /* slice height passed to the blocks */
+  PetscInt sigma; /* sorting window passed to the blocks */
+} Mat_MPISELL;
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreateSELL"
+/*@C
+   MatCreateSELL - Creates a sparse parallel matrix whose local
+   portions are stored as SEQSELL matrices (a matrix class that inherits
+   from SEQAIJ but keeps a sliced ELLPACK copy used for the matrix-vector products).
+   The same guidelines that apply to MPIAIJ matrices for
+   preallocating the matrix storage apply here as well.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+           This value should be the same as the local size used in creating the
+           y vector for the matrix-vector product y = Ax.
+.  n - This value should be the same as the local size used in creating the
+       x vector for the matrix-vector product y = Ax. (or PETSC_DECIDE to have
+       calculated if N is given) For square matrices n is almost always m.
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz  - number of nonzeros per row in DIAGONAL portion of local submatrix
+           (same value is used for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the
+           DIAGONAL portion of the local submatrix (possibly different for each row)
+           or NULL, if d_nz is used to specify the nonzero structure.
+.  o_nz  - number of nonzeros per row in the OFF-DIAGONAL portion of local
+           submatrix (same value is used for all local rows).
+-  o_nnz - array containing the number of nonzeros in the various rows of the
+           OFF-DIAGONAL portion of the local submatrix (possibly different for
+           each row) or NULL, if o_nz is used to specify the nonzero
+           structure.
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
++  -mat_sell_slice_height <C> - number of rows in each slice (default 8, at most 64)
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length inside windows of sigma rows, 1 disables the sorting (default 64)
+
+   Notes:
+   If the *_nnz parameter is given then the *_nz parameter is ignored
+
+   When calling this routine with a single process communicator, a matrix of
+   type SEQSELL is returned.
+
+   Level: intermediate
+
+.keywords: matrix, sparse, parallel, sliced ellpack, vectorization
+
+.seealso: MatCreate(), MatCreateSeqSELL(), MatSetValues(), MATSELL
+@*/
+PetscErrorCode  MatCreateSELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (size > 1) {
+    ierr = MatSetType(*A,MATMPISELL);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATSEQSELL);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(*A,d_nz,d_nnz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMPISELLSetUpBlocks_Private"
+/*
+   The off-diagonal block is recreated by MatDisAssemble_MPIAIJ(), so the blocks are
+   converted (when needed) and given the parameters of the parallel matrix after every assembly
+*/
+static PetscErrorCode MatMPISELLSetUpBlocks_Private(Mat B)
+{
+  Mat_MPIAIJ     *b    = (Mat_MPIAIJ*)B->data;
+  Mat_MPISELL    *sell = (Mat_MPISELL*)B->spptr;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (b->A) {
+    ierr = PetscObjectTypeCompare((PetscObject)b->A,MATSEQSELL,&flg);CHKERRQ(ierr);
+    if (!flg) {ierr = MatConvert_SeqAIJ_SeqSELL(b->A,MATSEQSELL,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);}
+    ierr = MatSeqSELLSetParameters_Private(b->A,sell->C,sell->sigma);CHKERRQ(ierr);
+  }
+  if (b->B) {
+    ierr = PetscObjectTypeCompare((PetscObject)b->B,MATSEQSELL,&flg);CHKERRQ(ierr);
+    if (!flg) {ierr = MatConvert_SeqAIJ_SeqSELL(b->B,MATSEQSELL,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);}
+    ierr = MatSeqSELLSetParameters_Private(b->B,sell->C,sell->sigma);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMPIAIJSetPreallocation_MPISELL"
+PetscErrorCode  MatMPIAIJSetPreallocation_MPISELL(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatMPISELLSetUpBlocks_Private(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_MPISELL"
+PetscErrorCode MatAssemblyEnd_MPISELL(Mat B,MatAssemblyType mode)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatAssemblyEnd_MPIAIJ(B,mode);CHKERRQ(ierr);
+  ierr = MatMPISELLSetUpBlocks_Private(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDiagonalScale_MPISELL"
+PetscErrorCode MatDiagonalScale_MPISELL(Mat B,Vec ll,Vec rr)
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDiagonalScale_MPIAIJ(B,ll,rr);CHKERRQ(ierr);
+  /* the blocks are scaled through their function tables, which does not mark their sliced copies out of date */
+  ierr = PetscObjectStateIncrease((PetscObject)b->A);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)b->B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDuplicate_MPISELL"
+PetscErrorCode MatDuplicate_MPISELL(Mat B,MatDuplicateOption op,Mat *M)
+{
+  Mat_MPISELL    *sell = (Mat_MPISELL*)B->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDuplicate_MPIAIJ(B,op,M);CHKERRQ(ierr);
+  ierr = PetscMemcpy((*M)->spptr,sell,sizeof(Mat_MPISELL));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_MPISELL"
+PetscErrorCode MatDestroy_MPISELL(Mat B)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpisell_mpiaij_C",NULL);CHKERRQ(ierr);
+  ierr = MatDestroy_MPIAIJ(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_MPISELL_MPIAIJ"
+PETSC_INTERN PetscErrorCode MatConvert_MPISELL_MPIAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_MPIAIJ     *b;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+  b = (Mat_MPIAIJ*)B->data;
+  if (b->A) {ierr = MatConvert_SeqSELL_SeqAIJ(b->A,MATSEQAIJ,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);}
+  if (b->B) {ierr = MatConvert_SeqSELL_SeqAIJ(b->B,MATSEQAIJ,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);}
+
+  /* Reset the original function pointers. */
+  B->ops->assemblyend   = MatAssemblyEnd_MPIAIJ;
+  B->ops->diagonalscale = MatDiagonalScale_MPIAIJ;
+  B->ops->duplicate     = MatDuplicate_MPIAIJ;
+  B->ops->destroy       = MatDestroy_MPIAIJ;
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJ);CHKERRQ(ierr);
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpisell_mpiaij_C",NULL);CHKERRQ(ierr);
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJ);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_MPIAIJ_MPISELL"
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPISELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_MPISELL    *sell;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr        = PetscNewLog(B,&sell);CHKERRQ(ierr);
+  B->spptr    = (void*)sell;
+  sell->C     = 8;
+  sell->sigma = 64;
+  ierr = PetscObjectOptionsBegin((PetscObject)B);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_sell_slice_height","Number of rows in each slice","MatCreateSELL",sell->C,&sell->C,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_sell_sigma","Rows are sorted by length inside windows of this many rows","MatCreateSELL",sell->sigma,&sell->sigma,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+
+  B->ops->assemblyend   = MatAssemblyEnd_MPISELL;
+  B->ops->diagonalscale = MatDiagonalScale_MPISELL;
+  B->ops->duplicate     = MatDuplicate_MPISELL;
+  B->ops->destroy       = MatDestroy_MPISELL;
+
+  /* blocks that already exist are converted now, the others when they are preallocated */
+  ierr = MatMPISELLSetUpBlocks_Private(B);CHKERRQ(ierr);
+
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPISELL);CHKERRQ(ierr);
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpisell_mpiaij_C",MatConvert_MPISELL_MPIAIJ);CHKERRQ(ierr);
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATMPISELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_MPISELL"
+PETSC_EXTERN PetscErrorCode MatCreate_MPISELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPISELL(A,MATMPISELL,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSELL - MATSELL = "sell" - A matrix type to be used for sparse matrices whose
+   matrix-vector products should use the sliced ELLPACK format SELL-C-sigma.
+
+   The matrix is stored as AIJ (so every AIJ operation is available) plus a copy in which
+   the rows are sorted by length inside windows of sigma rows and grouped into slices of C rows that
+   are padded to the length of their longest row and stored column by column. MatMult(), MatMultAdd(),
+   MatMultTranspose() and MatMultTransposeAdd() use this copy with AVX-512 or AVX2 gathers when PETSc is
+   compiled with -mavx512f or -mavx2 (double precision real scalars and 32 bit indices), and plain loops otherwise.
+   The copy is rebuilt lazily after the matrix changes, so it is most effective for matrices that are
+   assembled once and multiplied many times.
+
+   This matrix type is identical to MATSEQSELL when constructed with a single process communicator,
+   and MATMPISELL otherwise.  As a result, for single process communicators,
+  MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity. MatConvert() converts between MATAIJ and MATSELL in both directions.
+
+   Options Database Keys:
++ -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
+. -mat_sell_slice_height <C> - number of rows in each slice (default 8, at most 64)
+- -mat_sell_sigma <sigma> - rows are sorted by decreasing length inside windows of sigma rows, 1 disables the sorting (default 64)
+
+  Level: beginner
+
+.seealso: MatCreateSELL(), MatCreateSeqSELL(), MATSEQSELL, MATMPISELL, MATAIJCRL, MATAIJPERM
+M*/
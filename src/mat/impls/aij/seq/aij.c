@@ -551,8 +551,14 @@ PetscErrorCode MatView_SeqAIJ_Binary(Mat A,PetscViewer viewer)
   PetscInt       i,*col_lens;
   int            fd;
   FILE           *file;
+  PetscBool      usemmap;
 
   PetscFunctionBegin;
+  ierr = PetscViewerBinaryGetUseMmap(viewer,&usemmap);CHKERRQ(ierr);
+  if (usemmap) {
+    ierr = MatView_AIJ_BinaryMmap(A,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
   ierr = PetscMalloc1(4+A->rmap->n,&col_lens);CHKERRQ(ierr);
 
@@ -966,6 +972,8 @@ PetscErrorCode MatView_SeqAIJ(Mat A,PetscViewer viewer)
     ierr = MatView_SeqAIJ_Draw(A,viewer);CHKERRQ(ierr);
   }
   ierr = MatView_SeqAIJ_Inode(A,viewer);CHKERRQ(ierr);
+  ierr = MatView_SeqAIJ_OpenMP(A,viewer);CHKERRQ(ierr);
+  ierr = MatView_SeqAIJ_Single(A,viewer);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1025,6 +1033,8 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
 
   ierr = MatCheckCompressedRow(A,a->nonzerorowcnt,&a->compressedrow,a->i,m,ratio);CHKERRQ(ierr);
   ierr = MatAssemblyEnd_SeqAIJ_Inode(A,mode);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd_SeqAIJ_OpenMP(A,mode);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd_SeqAIJ_Single(A,mode);CHKERRQ(ierr);
   ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -1091,6 +1101,8 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscFree2(a->imax,a->ilen);CHKERRQ(ierr);
   ierr = PetscFree3(a->idiag,a->mdiag,a->ssor_work);CHKERRQ(ierr);
   ierr = PetscFree(a->solve_work);CHKERRQ(ierr);
+  ierr = MatSolveLevelsReset(&a->levels);CHKERRQ(ierr);
+  ierr = MatSORColoringReset(&a->sorcoloring);CHKERRQ(ierr);
   ierr = ISDestroy(&a->icol);CHKERRQ(ierr);
   ierr = PetscFree(a->saved_values);CHKERRQ(ierr);
   ierr = ISColoringDestroy(&a->coloring);CHKERRQ(ierr);
@@ -1098,6 +1110,8 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscFree(a->matmult_abdense);CHKERRQ(ierr);
 
   ierr = MatDestroy_SeqAIJ_Inode(A);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ_OpenMP(A);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ_Single(A);CHKERRQ(ierr);
   ierr = PetscFree(A->data);CHKERRQ(ierr);
 
   ierr = PetscObjectChangeTypeName((PetscObject)A,0);CHKERRQ(ierr);
@@ -1107,6 +1121,7 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqsbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijperm_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqsell_C",NULL);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_elemental_C",NULL);CHKERRQ(ierr);
 #endif
@@ -1620,6 +1635,13 @@ PetscErrorCode MatSOR_SeqAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscR
   const PetscInt    *idx,*diag;
 
   PetscFunctionBegin;
+  if (flag & SOR_MULTICOLOR) {
+    if (!(flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER))) {
+      ierr = MatSOR_SeqAIJ_Multicolor(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+    flag = (MatSORType)(flag & ~SOR_MULTICOLOR);
+  }
   its = its*lits;
 
   if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
@@ -2947,8 +2969,8 @@ PetscErrorCode MatInvertBlockDiagonal_SeqAIJ(Mat A,const PetscScalar **values)
 {
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*) A->data;
   PetscErrorCode ierr;
-  PetscInt       i,bs = PetscAbs(A->rmap->bs),mbs = A->rmap->n/bs,ipvt[5],bs2 = bs*bs,*v_pivots,ij[7],*IJ,j;
-  MatScalar      *diag,work[25],*v_work;
+  PetscInt       i,bs = PetscAbs(A->rmap->bs),mbs = A->rmap->n/bs,bs2 = bs*bs,*IJ,j;
+  MatScalar      *diag;
   PetscReal      shift = 0.0;
   PetscBool      allowzeropivot,zeropivotdetected=PETSC_FALSE;
 
@@ -2979,79 +3001,19 @@ PetscErrorCode MatInvertBlockDiagonal_SeqAIJ(Mat A,const PetscScalar **values)
       diag[i] = (PetscScalar)1.0 / (diag[i] + shift);
     }
     break;
-  case 2:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 2*i; ij[1] = 2*i + 1;
-      ierr  = MatGetValues(A,2,ij,2,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_2(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_2(diag);CHKERRQ(ierr);
-      diag += 4;
-    }
-    break;
-  case 3:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 3*i; ij[1] = 3*i + 1; ij[2] = 3*i + 2;
-      ierr  = MatGetValues(A,3,ij,3,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_3(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_3(diag);CHKERRQ(ierr);
-      diag += 9;
-    }
-    break;
-  case 4:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 4*i; ij[1] = 4*i + 1; ij[2] = 4*i + 2; ij[3] = 4*i + 3;
-      ierr  = MatGetValues(A,4,ij,4,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_4(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_4(diag);CHKERRQ(ierr);
-      diag += 16;
-    }
-    break;
-  case 5:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 5*i; ij[1] = 5*i + 1; ij[2] = 5*i + 2; ij[3] = 5*i + 3; ij[4] = 5*i + 4;
-      ierr  = MatGetValues(A,5,ij,5,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_5(diag,ipvt,work,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_5(diag);CHKERRQ(ierr);
-      diag += 25;
-    }
-    break;
-  case 6:
-    for (i=0; i<mbs; i++) {
-      ij[0] = 6*i; ij[1] = 6*i + 1; ij[2] = 6*i + 2; ij[3] = 6*i + 3; ij[4] = 6*i + 4; ij[5] = 6*i + 5;
-      ierr  = MatGetValues(A,6,ij,6,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_6(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_6(diag);CHKERRQ(ierr);
-      diag += 36;
-    }
-    break;
-  case 7:
+  default:
+    ierr = PetscMalloc1(bs,&IJ);CHKERRQ(ierr);
     for (i=0; i<mbs; i++) {
-      ij[0] = 7*i; ij[1] = 7*i + 1; ij[2] = 7*i + 2; ij[3] = 7*i + 3; ij[4] = 7*i + 4; ij[5] = 7*i + 5; ij[5] = 7*i + 6;
-      ierr  = MatGetValues(A,7,ij,7,ij,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A_7(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_7(diag);CHKERRQ(ierr);
-      diag += 49;
+      for (j=0; j<bs; j++) IJ[j] = bs*i + j;
+      ierr = MatGetValues(A,bs,IJ,bs,IJ,diag+bs2*i);CHKERRQ(ierr);
     }
-    break;
-  default:
-    ierr = PetscMalloc3(bs,&v_work,bs,&v_pivots,bs,&IJ);CHKERRQ(ierr);
+    ierr = PetscFree(IJ);CHKERRQ(ierr);
+    /* the blocks are stored by rows, so the inverses are transposed; several blocks at a time with the vector kernels */
+    ierr = PetscKernel_A_gets_inverse_A_batch(bs,mbs,diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
     for (i=0; i<mbs; i++) {
-      for (j=0; j<bs; j++) {
-        IJ[j] = bs*i + j;
-      }
-      ierr  = MatGetValues(A,bs,IJ,bs,IJ,diag);CHKERRQ(ierr);
-      ierr  = PetscKernel_A_gets_inverse_A(bs,diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      ierr  = PetscKernel_A_gets_transpose_A_N(diag,bs);CHKERRQ(ierr);
-      diag += bs2;
+      ierr = PetscKernel_A_gets_transpose_A_N(diag+bs2*i,bs);CHKERRQ(ierr);
     }
-    ierr = PetscFree3(v_work,v_pivots,IJ);CHKERRQ(ierr);
   }
   a->ibdiagvalid = PETSC_TRUE;
   PetscFunctionReturn(0);
@@ -3428,6 +3390,7 @@ PetscErrorCode  MatRetrieveValues(Mat mat)
   if (!mat->assembled) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for unassembled matrix");
   if (mat->factortype) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for factored matrix");
   ierr = PetscUseMethod(mat,"MatRetrieveValues_C",(Mat),(mat));CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)mat);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -3479,7 +3442,9 @@ PetscErrorCode  MatRetrieveValues(Mat mat)
 
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
--  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_aij_omp - Use OpenMP threads in MatMult() and MatMultAdd(), with rows split by number of nonzeros
+-  -mat_aij_omp_threads <n> - Number of threads used with -mat_aij_omp
 
    Level: intermediate
 
@@ -3543,6 +3508,7 @@ PetscErrorCode  MatCreateSeqAIJ(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
 .  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_aij_omp - Use OpenMP threads in MatMult() and MatMultAdd(), with rows split by number of nonzeros
 -  -mat_aij_oneindex - Internally use indexing starting at 1
         rather than 0.  Note that when calling MatSetValues(),
         the user still MUST index entries starting at 0!
@@ -3858,6 +3824,7 @@ M*/
 M*/
 
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJCRL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat,MatType,MatReuse,Mat*);
 #if defined(PETSC_HAVE_ELEMENTAL)
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_Elemental(Mat,MatType,MatReuse,Mat*);
 #endif
@@ -3932,6 +3899,9 @@ PetscErrorCode  MatSeqAIJGetMaxRowNonzeros(Mat A,PetscInt *nz)
 .  mat - a MATSEQAIJ matrix
 .  array - pointer to the data
 
+   Notes:
+   The values may have been changed through the array, so the object state of the matrix is increased.
+
    Level: intermediate
 
 .seealso: MatSeqAIJGetArray(), MatSeqAIJRestoreArrayF90()
@@ -3942,6 +3912,7 @@ PetscErrorCode  MatSeqAIJRestoreArray(Mat A,PetscScalar **array)
 
   PetscFunctionBegin;
   ierr = PetscUseMethod(A,"MatSeqAIJRestoreArray_C",(Mat,PetscScalar**),(A,array));CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -3999,6 +3970,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqbaij_C",MatConvert_SeqAIJ_SeqBAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijperm_C",MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijcrl_C",MatConvert_SeqAIJ_SeqAIJCRL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqsell_C",MatConvert_SeqAIJ_SeqSELL);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_elemental_C",MatConvert_SeqAIJ_Elemental);CHKERRQ(ierr);
 #endif
@@ -4012,6 +3984,8 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultSymbolic_seqdense_seqaij_C",MatMatMultSymbolic_SeqDense_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultNumeric_seqdense_seqaij_C",MatMatMultNumeric_SeqDense_SeqAIJ);CHKERRQ(ierr);
   ierr = MatCreate_SeqAIJ_Inode(B);CHKERRQ(ierr);
+  ierr = MatCreate_SeqAIJ_OpenMP(B);CHKERRQ(ierr);
+  ierr = MatCreate_SeqAIJ_Single(B);CHKERRQ(ierr);
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -4106,6 +4080,8 @@ PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat C,Mat A,MatDuplicateOption cpvalu
   C->nonzerostate  = A->nonzerostate;
 
   ierr = MatDuplicate_SeqAIJ_Inode(A,cpvalues,&C);CHKERRQ(ierr);
+  ierr = MatDuplicate_SeqAIJ_OpenMP(A,cpvalues,&C);CHKERRQ(ierr);
+  ierr = MatDuplicate_SeqAIJ_Single(A,cpvalues,&C);CHKERRQ(ierr);
   ierr = PetscFunctionListDuplicate(((PetscObject)A)->qlist,&((PetscObject)C)->qlist);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -4138,6 +4114,7 @@ PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
   PetscMPIInt    size;
   MPI_Comm       comm;
   PetscInt       bs = newMat->rmap->bs;
+  PetscBool      usemmap;
 
   PetscFunctionBegin;
   /* force binary viewer to load .info file if it has not yet done so */
@@ -4145,6 +4122,11 @@ PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
   ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
   if (size > 1) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"view must have one processor");
+  ierr = PetscViewerBinaryGetUseMmap(viewer,&usemmap);CHKERRQ(ierr);
+  if (usemmap) {
+    ierr = MatLoad_AIJ_BinaryMmap(newMat,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
 
   ierr = PetscOptionsBegin(comm,NULL,"Options for loading SEQAIJ matrix","Mat");CHKERRQ(ierr);
   ierr = PetscOptionsInt("-matload_block_size","Set the blocksize used to store the matrix","MatLoad",bs,&bs,NULL);CHKERRQ(ierr);
@@ -94,6 +94,44 @@ typedef struct {
   PetscObjectState mat_nonzerostate;               /* non-zero state when inodes were checked for */
 } Mat_SeqAIJ_Inode;
 
+/* Info about the nonzero-balanced row partition used by the OpenMP MatMult() for SeqAIJ */
+typedef struct {
+  PetscBool        use;                            /* use the threaded MatMult() and MatMultAdd() */
+  PetscInt         nthreads;                       /* number of threads the rows are partitioned for */
+  PetscInt         *rstart;                        /* first row of each thread, length nthreads+1 */
+  PetscBool        compressed;                     /* rstart[] refers to the compressed rows */
+  PetscReal        imbalance;                      /* max/average nonzeros per thread of the partition */
+  PetscLogDouble   *ttime;                         /* time spent by each thread in the last product */
+  PetscObjectState mat_nonzerostate;               /* non-zero state when the partition was computed */
+} Mat_SeqAIJ_OpenMP;
+
+PETSC_INTERN PetscErrorCode MatCreate_SeqAIJ_OpenMP(Mat);
+PETSC_INTERN PetscErrorCode MatAssemblyEnd_SeqAIJ_OpenMP(Mat,MatAssemblyType);
+PETSC_INTERN PetscErrorCode MatDuplicate_SeqAIJ_OpenMP(Mat,MatDuplicateOption,Mat*);
+PETSC_INTERN PetscErrorCode MatDestroy_SeqAIJ_OpenMP(Mat);
+PETSC_INTERN PetscErrorCode MatView_SeqAIJ_OpenMP(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatSeqAIJFactorSetUpLevels(Mat);
+
+/* Info about the single precision copy of the values used by MatMult() and MatSolve() for SeqAIJ, see MatAIJSetSinglePrecision() */
+typedef struct {
+  PetscBool        use;                            /* use the single precision values */
+  float            *a;                             /* the values rounded to single precision */
+  PetscInt         n;                              /* length of a[] */
+  PetscObjectState state;                          /* object state of the matrix when a[] was computed */
+  PetscErrorCode   (*mult)(Mat,Vec,Vec);           /* the operations replaced by the single precision versions */
+  PetscErrorCode   (*multadd)(Mat,Vec,Vec,Vec);
+  PetscErrorCode   (*solve)(Mat,Vec,Vec);
+} Mat_SeqAIJ_Single;
+
+PETSC_INTERN PetscErrorCode MatCreate_SeqAIJ_Single(Mat);
+PETSC_INTERN PetscErrorCode MatAssemblyEnd_SeqAIJ_Single(Mat,MatAssemblyType);
+PETSC_INTERN PetscErrorCode MatDuplicate_SeqAIJ_Single(Mat,MatDuplicateOption,Mat*);
+PETSC_INTERN PetscErrorCode MatDestroy_SeqAIJ_Single(Mat);
+PETSC_INTERN PetscErrorCode MatView_SeqAIJ_Single(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatSeqAIJFactorSetUpSingle(Mat);
+PETSC_INTERN PetscErrorCode MatSOR_SeqAIJ_Multicolor(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+PETSC_INTERN PetscErrorCode MatInvertDiagonal_SeqAIJ(Mat,PetscScalar,PetscScalar);
+
 PETSC_INTERN PetscErrorCode MatView_SeqAIJ_Inode(Mat,PetscViewer);
 PETSC_INTERN PetscErrorCode MatAssemblyEnd_SeqAIJ_Inode(Mat,MatAssemblyType);
 PETSC_INTERN PetscErrorCode MatDestroy_SeqAIJ_Inode(Mat);
@@ -107,6 +145,10 @@ PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat,Mat,const MatFac
 typedef struct {
   SEQAIJHEADER(MatScalar);
   Mat_SeqAIJ_Inode inode;
+  Mat_SeqAIJ_OpenMP omp;
+  Mat_SeqAIJ_Single single;
+  Mat_SolveLevels  levels;                    /* level sets of the factors for the threaded MatSolve() */
+  Mat_SORColoring  sorcoloring;               /* coloring of the rows for the multicolor MatSOR() */
   MatScalar        *saved_values;             /* location for stashing nonzero values of matrix */
 
   PetscScalar *idiag,*mdiag,*ssor_work;       /* inverse of diagonal entries, diagonal values and workspace for Eisenstat trick */
@@ -240,6 +282,8 @@ PETSC_INTERN PetscErrorCode MatFDColoringSetUp_SeqXAIJ(Mat,ISColoring,MatFDColor
 PETSC_INTERN PetscErrorCode MatFDColoringSetUpBlocked_AIJ_Private(Mat,MatFDColoring,PetscInt);
 PETSC_INTERN PetscErrorCode MatFDColoringApply_AIJ(Mat,MatFDColoring,Vec,void*);
 PETSC_INTERN PetscErrorCode MatLoad_SeqAIJ(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatView_AIJ_BinaryMmap(Mat,PetscViewer);
+PETSC_INTERN PetscErrorCode MatLoad_AIJ_BinaryMmap(Mat,PetscViewer);
 PETSC_INTERN PetscErrorCode RegisterApplyPtAPRoutines_Private(Mat);
 
 PETSC_INTERN PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
@@ -610,6 +610,8 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *info)
   C->ops->matsolve          = MatMatSolve_SeqAIJ;
   C->assembled              = PETSC_TRUE;
   C->preallocated           = PETSC_TRUE;
+  ierr = MatSeqAIJFactorSetUpLevels(C);CHKERRQ(ierr);
+  ierr = MatSeqAIJFactorSetUpSingle(C);CHKERRQ(ierr);
 
   ierr = PetscLogFlops(C->cmap->n);CHKERRQ(ierr);
 
@@ -2221,6 +2223,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *
 
   C->assembled    = PETSC_TRUE;
   C->preallocated = PETSC_TRUE;
+  ierr = MatSeqSBAIJFactorSetUpLevels(C);CHKERRQ(ierr);
 
   ierr = PetscLogFlops(C->rmap->n);CHKERRQ(ierr);
 
@@ -0,0 +1,68 @@
+
+/*
+    Multicolor OpenMP threaded MatSOR() for SeqAIJ matrices, selected with the SOR_MULTICOLOR flag. The rows
+  are colored once, see MatSORColoringSetUp(), and each forward (backward) sweep relaxes the colors in
+  increasing (decreasing) order; within a color the rows are independent and are divided among the threads.
+  Each row is relaxed with its complete row, as in the backward sweep of MatSOR_SeqAIJ(), so the result does
+  not depend on the number of threads.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSOR_SeqAIJ_Multicolor"
+PetscErrorCode MatSOR_SeqAIJ_Multicolor(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  Mat_SORColoring   *sc = &a->sorcoloring;
+  PetscScalar       *x;
+  const PetscScalar *b,*idiag,*mdiag;
+  const MatScalar   *aa = a->a;
+  const PetscInt    *ai = a->i,*aj = a->j;
+  PetscInt          m = A->rmap->n,c,s;
+  PetscBool         forward,backward;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  its = its*lits;
+  if (its <= 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Relaxation requires global its %D and local its %D both positive",its,lits);
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+  if (!m) PetscFunctionReturn(0);
+
+  ierr     = MatSORColoringSetUp(A,sc,m,ai,aj);CHKERRQ(ierr);
+  idiag    = a->idiag;
+  mdiag    = a->mdiag;
+  forward  = (PetscBool)((flag & SOR_FORWARD_SWEEP) || (flag & SOR_LOCAL_FORWARD_SWEEP));
+  backward = (PetscBool)((flag & SOR_BACKWARD_SWEEP) || (flag & SOR_LOCAL_BACKWARD_SWEEP));
+
+  if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = VecSet(xx,0.0);CHKERRQ(ierr);}
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  while (its--) {
+    for (s=0; s<2; s++) {
+      if ((!s && !forward) || (s && !backward)) continue;
+      for (c=0; c<sc->ncolors; c++) {
+        const PetscInt  *rows = sc->rows,cc = s ? sc->ncolors-1-c : c;
+        const PetscInt  cs = sc->color[cc],ce = sc->color[cc+1];
+        PetscInt        k;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(sc->nthreads) schedule(static)
+#endif
+        for (k=cs; k<ce; k++) {
+          const PetscInt  i = rows[k],n = ai[i+1] - ai[i],*idx = aj + ai[i];
+          const MatScalar *v = aa + ai[i];
+          PetscScalar     sum = b[i];
+
+          PetscSparseDenseMinusDot(sum,x,v,idx,n);
+          x[i] = (1. - omega)*x[i] + (sum + mdiag[i]*x[i])*idiag[i];
+        }
+      }
+      ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
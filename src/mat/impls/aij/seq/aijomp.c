@@ -0,0 +1,311 @@
+
+/*
+    OpenMP threaded MatMult() and MatMultAdd() for the SeqAIJ format. The rows are split into
+  contiguous pieces, one per thread, that hold (nearly) the same number of nonzeros, so that
+  matrices with very uneven row lengths are still balanced. This is also used for the diagonal
+  and off-diagonal blocks of MATMPIAIJ since those are SeqAIJ matrices.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJOpenMPPartition_Private"
+/*
+   Computes rstart[] so that thread t handles rows rstart[t] <= i < rstart[t+1]; with compressed rows
+   these are indices into the compressed row arrays.
+*/
+static PetscErrorCode MatSeqAIJOpenMPPartition_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       nt = a->omp.nthreads,m,t,lo,hi,mid,target,nz,maxnz = 0;
+  const PetscInt *ii;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (a->compressedrow.use) {
+    m  = a->compressedrow.nrows;
+    ii = a->compressedrow.i;
+  } else {
+    m  = A->rmap->n;
+    ii = a->i;
+  }
+  if (!a->omp.rstart) {
+    ierr = PetscMalloc2(nt+1,&a->omp.rstart,nt,&a->omp.ttime);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(nt+1)*sizeof(PetscInt)+nt*sizeof(PetscLogDouble));CHKERRQ(ierr);
+  }
+  nz                = ii[m] - ii[0];
+  a->omp.rstart[0]  = 0;
+  a->omp.rstart[nt] = m;
+  for (t=1; t<nt; t++) {
+    /* first row at or after the previous split whose start reaches t/nt of the nonzeros */
+    target = ii[0] + (PetscInt)(((PetscInt64)nz*t)/nt);
+    lo     = a->omp.rstart[t-1];
+    hi     = m;
+    while (lo < hi) {
+      mid = lo + (hi - lo)/2;
+      if (ii[mid] < target) lo = mid + 1;
+      else hi = mid;
+    }
+    a->omp.rstart[t] = lo;
+  }
+  for (t=0; t<nt; t++) maxnz = PetscMax(maxnz,ii[a->omp.rstart[t+1]] - ii[a->omp.rstart[t]]);
+  a->omp.imbalance        = nz ? ((PetscReal)maxnz*nt)/nz : 1.0;
+  a->omp.compressed       = a->compressedrow.use;
+  a->omp.mat_nonzerostate = A->nonzerostate;
+  ierr = PetscInfo3(A,"Split %D rows among %D threads by nonzeros, imbalance (max/average nonzeros per thread) %g\n",m,nt,(double)a->omp.imbalance);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_OPENMP)
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJOpenMPLogImbalance_Private"
+/*
+   Logs the time the threads spent waiting for the slowest one in the last product as MatMultOMPImbal
+*/
+PETSC_STATIC_INLINE PetscErrorCode MatSeqAIJOpenMPLogImbalance_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscLogDouble tmax = 0.0,tsum = 0.0;
+  PetscInt       t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (t=0; t<a->omp.nthreads; t++) {
+    tmax  = PetscMax(tmax,a->omp.ttime[t]);
+    tsum += a->omp.ttime[t];
+  }
+  ierr = PetscLogEventAddTime(MAT_MultOMPImbalance,tmax - tsum/a->omp.nthreads);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_SeqAIJ_OpenMP"
+static PetscErrorCode MatMult_SeqAIJ_OpenMP(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const PetscInt    *ii,*ridx = NULL,*rstart;
+  PetscLogDouble    *ttime;
+  PetscInt          t,nt = a->omp.nthreads;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!a->omp.rstart || a->omp.mat_nonzerostate != A->nonzerostate || a->omp.compressed != usecprow) {
+    ierr = MatSeqAIJOpenMPPartition_Private(A);CHKERRQ(ierr);
+  }
+  rstart = a->omp.rstart;
+  ttime  = a->omp.ttime;
+  ierr   = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr   = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (usecprow) {
+    ierr = PetscMemzero(y,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else ii = a->i;
+#pragma omp parallel for schedule(static,1) num_threads(nt)
+  for (t=0; t<nt; t++) {
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscInt        i,n;
+    PetscScalar     sum;
+    double          t0 = omp_get_wtime();
+
+    for (i=rstart[t]; i<rstart[t+1]; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = a->a + ii[i];
+      sum = 0.0;
+      PetscSparseDensePlusDot(sum,x,aa,aj,n);
+      if (ridx) y[ridx[i]] = sum;
+      else y[i] = sum;
+    }
+    ttime[t] = omp_get_wtime() - t0;
+  }
+  ierr = MatSeqAIJOpenMPLogImbalance_Private(A);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqAIJ_OpenMP"
+static PetscErrorCode MatMultAdd_SeqAIJ_OpenMP(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y,*z;
+  const PetscScalar *x;
+  const PetscInt    *ii,*ridx = NULL,*rstart;
+  PetscLogDouble    *ttime;
+  PetscInt          t,nt = a->omp.nthreads;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!a->omp.rstart || a->omp.mat_nonzerostate != A->nonzerostate || a->omp.compressed != usecprow) {
+    ierr = MatSeqAIJOpenMPPartition_Private(A);CHKERRQ(ierr);
+  }
+  rstart = a->omp.rstart;
+  ttime  = a->omp.ttime;
+  ierr   = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr   = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  if (usecprow) {
+    if (zz != yy) {
+      ierr = PetscMemcpy(z,y,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else ii = a->i;
+#pragma omp parallel for schedule(static,1) num_threads(nt)
+  for (t=0; t<nt; t++) {
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscInt        i,n,r;
+    PetscScalar     sum;
+    double          t0 = omp_get_wtime();
+
+    for (i=rstart[t]; i<rstart[t+1]; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = a->a + ii[i];
+      r   = ridx ? ridx[i] : i;
+      sum = y[r];
+      PetscSparseDensePlusDot(sum,x,aa,aj,n);
+      z[r] = sum;
+    }
+    ttime[t] = omp_get_wtime() - t0;
+  }
+  ierr = MatSeqAIJOpenMPLogImbalance_Private(A);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJOpenMPSetOps_Private"
+static PetscErrorCode MatSeqAIJOpenMPSetOps_Private(Mat A)
+{
+#if defined(PETSC_HAVE_OPENMP)
+  Mat_SeqAIJ *a = (Mat_SeqAIJ*)A->data;
+
+  PetscFunctionBegin;
+  if (a->omp.use && !A->factortype) {
+    A->ops->mult    = MatMult_SeqAIJ_OpenMP;
+    A->ops->multadd = MatMultAdd_SeqAIJ_OpenMP;
+  }
+  PetscFunctionReturn(0);
+#else
+  PetscFunctionBegin;
+  PetscFunctionReturn(0);
+#endif
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_SeqAIJ_OpenMP"
+/*
+   Called at the end of MatAssemblyEnd_SeqAIJ(), after the Inode check, so the threaded product takes precedence
+*/
+PetscErrorCode MatAssemblyEnd_SeqAIJ_OpenMP(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->omp.use || A->factortype) PetscFunctionReturn(0);
+  ierr = MatSeqAIJOpenMPPartition_Private(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJOpenMPSetOps_Private(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDuplicate_SeqAIJ_OpenMP"
+PetscErrorCode MatDuplicate_SeqAIJ_OpenMP(Mat A,MatDuplicateOption cpvalues,Mat *C)
+{
+  Mat            B = *C;
+  Mat_SeqAIJ     *c = (Mat_SeqAIJ*)B->data,*a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  c->omp.use      = a->omp.use;
+  c->omp.nthreads = a->omp.nthreads;
+  c->omp.rstart   = NULL;
+  c->omp.ttime    = NULL;
+  /* the partition is recomputed on the first product */
+  ierr = MatSeqAIJOpenMPSetOps_Private(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_SeqAIJ_OpenMP"
+PetscErrorCode MatDestroy_SeqAIJ_OpenMP(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(a->omp.rstart,a->omp.ttime);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatView_SeqAIJ_OpenMP"
+PetscErrorCode MatView_SeqAIJ_OpenMP(Mat A,PetscViewer viewer)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+
+  PetscFunctionBegin;
+  if (!a->omp.use) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+      ierr = PetscViewerASCIIPrintf(viewer,"using OpenMP MatMult with %D threads, nonzero imbalance %g\n",a->omp.nthreads,(double)a->omp.imbalance);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_SeqAIJ_OpenMP"
+/*
+   Reads -mat_aij_omp and -mat_aij_omp_threads; like the Inode options these apply to every SeqAIJ matrix,
+   including the blocks of MATMPIAIJ matrices.
+*/
+PetscErrorCode MatCreate_SeqAIJ_OpenMP(Mat B)
+{
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  b->omp.use       = PETSC_FALSE;
+  b->omp.nthreads  = 1;
+  b->omp.rstart    = NULL;
+  b->omp.ttime     = NULL;
+  b->omp.imbalance = 1.0;
+#if defined(PETSC_HAVE_OPENMP)
+  b->omp.nthreads  = omp_get_max_threads();
+#endif
+
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Options for SEQAIJ matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_omp","Use OpenMP threads, balanced by nonzeros, in MatMult()",NULL,b->omp.use,&b->omp.use,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aij_omp_threads","Number of threads for the OpenMP MatMult()",NULL,b->omp.nthreads,&b->omp.nthreads,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+
+  if (b->omp.nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)B),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",b->omp.nthreads);
+#if !defined(PETSC_HAVE_OPENMP)
+  if (b->omp.use) {
+    ierr = PetscInfo(B,"PETSc was not configured with OpenMP, ignoring -mat_aij_omp\n");CHKERRQ(ierr);
+    b->omp.use = PETSC_FALSE;
+  }
+#endif
+  PetscFunctionReturn(0);
+}
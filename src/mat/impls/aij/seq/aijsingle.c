@@ -0,0 +1,400 @@
+
+/*
+    MatMult(), MatMultAdd() and MatSolve() for SeqAIJ matrices that use a single precision copy of the
+  values, see MatAIJSetSinglePrecision(). The products and the triangular solves read the float values and
+  convert them on the fly, the vectors and all the sums stay in double precision, so only the memory traffic
+  for the matrix values is halved. The copy is refreshed from the double precision values whenever the
+  object state of the matrix changed, that is after each assembly or numeric factorization, or any other
+  change of the values (the MPIAIJ operations that work on the blocks directly increase their state).
+  This is also used for the diagonal and off-diagonal blocks of MATMPIAIJ since those are SeqAIJ matrices.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+#define MAT_SEQAIJ_SINGLE 1
+#endif
+
+#if defined(MAT_SEQAIJ_SINGLE)
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJSingleUpdate_Private"
+/*
+   Rounds the values to single precision if they changed since the last call; the factors in the format
+   used by MatSolve_SeqAIJ() store the values of U after those of L, ending at adiag[0]
+*/
+static PetscErrorCode MatSeqAIJSingleUpdate_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       i,n = A->factortype ? a->diag[0]+1 : a->i[A->rmap->n];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (a->single.a && a->single.state == ((PetscObject)A)->state && a->single.n == n) PetscFunctionReturn(0);
+  if (a->single.n != n) {
+    ierr = PetscFree(a->single.a);CHKERRQ(ierr);
+    ierr = PetscMalloc1(n,&a->single.a);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(n-a->single.n)*sizeof(float));CHKERRQ(ierr);
+    a->single.n = n;
+  }
+  for (i=0; i<n; i++) a->single.a[i] = (float)a->a[i];
+  a->single.state = ((PetscObject)A)->state;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_SeqAIJ_Single"
+static PetscErrorCode MatMult_SeqAIJ_Single(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y,sum;
+  const PetscScalar *x;
+  const float       *aa;
+  const PetscInt    *aj,*ii,*ridx = NULL;
+  PetscInt          m = A->rmap->n,n,i;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingleUpdate_Private(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  ii   = a->i;
+  if (usecprow) {
+    ierr = PetscMemzero(y,m*sizeof(PetscScalar));CHKERRQ(ierr);
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    n   = ii[i+1] - ii[i];
+    aj  = a->j + ii[i];
+    aa  = a->single.a + ii[i];
+    sum = 0.0;
+    PetscSparseDensePlusDot(sum,x,aa,aj,n);
+    y[usecprow ? ridx[i] : i] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqAIJ_Single"
+static PetscErrorCode MatMultAdd_SeqAIJ_Single(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y,*z,sum;
+  const PetscScalar *x;
+  const float       *aa;
+  const PetscInt    *aj,*ii,*ridx = NULL;
+  PetscInt          m = A->rmap->n,n,i,r;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingleUpdate_Private(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  ii   = a->i;
+  if (usecprow) {
+    if (zz != yy) {
+      ierr = PetscMemcpy(z,y,m*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    r   = usecprow ? ridx[i] : i;
+    n   = ii[i+1] - ii[i];
+    aj  = a->j + ii[i];
+    aa  = a->single.a + ii[i];
+    sum = y[r];
+    PetscSparseDensePlusDot(sum,x,aa,aj,n);
+    z[r] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqAIJ_Single"
+/*
+   The same substitutions as MatSolve_SeqAIJ(), including the stored inverse of the diagonal of U
+*/
+static PetscErrorCode MatSolve_SeqAIJ_Single(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscInt          i,n = A->rmap->n,nz;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*vi,*r,*c;
+  PetscScalar       *x,*tmp = a->solve_work,sum;
+  const PetscScalar *b;
+  const float       *aa,*v;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = MatSeqAIJSingleUpdate_Private(A);CHKERRQ(ierr);
+  aa   = a->single.a;
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+
+  /* forward solve the lower triangular */
+  for (i=0; i<n; i++) {
+    nz  = ai[i+1] - ai[i];
+    v   = aa + ai[i];
+    vi  = aj + ai[i];
+    sum = b[r[i]];
+    PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+    tmp[i] = sum;
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v   = aa + adiag[i+1] + 1;
+    vi  = aj + adiag[i+1] + 1;
+    nz  = adiag[i] - adiag[i+1] - 1;
+    sum = tmp[i];
+    PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+    x[c[i]] = tmp[i] = sum*v[nz];
+  }
+
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJSingleSetOps_Private"
+/*
+   Switches the operations of an assembled matrix or of a factor to the single precision versions, remembering
+   the ones they replace, or puts the remembered ones back
+*/
+static PetscErrorCode MatSeqAIJSingleSetOps_Private(Mat A,PetscBool flg)
+{
+#if defined(MAT_SEQAIJ_SINGLE)
+  Mat_SeqAIJ *a = (Mat_SeqAIJ*)A->data;
+
+  PetscFunctionBegin;
+  if (A->factortype) {
+    if (flg && A->ops->solve != MatSolve_SeqAIJ_Single) {
+      a->single.solve = A->ops->solve;
+      A->ops->solve   = MatSolve_SeqAIJ_Single;
+    } else if (!flg && A->ops->solve == MatSolve_SeqAIJ_Single) {
+      A->ops->solve   = a->single.solve;
+    }
+  } else {
+    if (flg && A->ops->mult != MatMult_SeqAIJ_Single) {
+      a->single.mult    = A->ops->mult;
+      a->single.multadd = A->ops->multadd;
+      A->ops->mult      = MatMult_SeqAIJ_Single;
+      A->ops->multadd   = MatMultAdd_SeqAIJ_Single;
+    } else if (!flg && A->ops->mult == MatMult_SeqAIJ_Single) {
+      A->ops->mult      = a->single.mult;
+      A->ops->multadd   = a->single.multadd;
+    }
+  }
+  PetscFunctionReturn(0);
+#else
+  PetscFunctionBegin;
+  PetscFunctionReturn(0);
+#endif
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_SeqAIJ_Single"
+/*
+   Called at the end of MatAssemblyEnd_SeqAIJ(), after the Inode and OpenMP checks have set MatMult()
+*/
+PetscErrorCode MatAssemblyEnd_SeqAIJ_Single(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->single.use || A->factortype || mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+  ierr = MatSeqAIJSingleSetOps_Private(A,PETSC_TRUE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJFactorSetUpSingle"
+/*
+   MatSeqAIJFactorSetUpSingle - Called at the end of the numeric LU and ILU factorizations that produce the
+   factor in the (non-inplace) format used by MatSolve_SeqAIJ(), after MatSeqAIJFactorSetUpLevels()
+*/
+PetscErrorCode MatSeqAIJFactorSetUpSingle(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->single.use) PetscFunctionReturn(0);
+  ierr = MatSeqAIJSingleSetOps_Private(A,PETSC_TRUE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAIJSetSinglePrecision_SeqAIJ"
+static PetscErrorCode MatAIJSetSinglePrecision_SeqAIJ(Mat A,PetscBool flg)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if !defined(MAT_SEQAIJ_SINGLE)
+  if (flg) {
+    ierr = PetscInfo(A,"Single precision values are only supported with real double precision PetscScalar, ignoring\n");CHKERRQ(ierr);
+    flg  = PETSC_FALSE;
+  }
+#endif
+  a->single.use = flg;
+  if (!flg) {
+    ierr = PetscFree(a->single.a);CHKERRQ(ierr);
+    a->single.n = 0;
+  }
+  /* a factor gets the single precision MatSolve() with its next numeric factorization */
+  if (A->factortype) {
+    if (!flg) {ierr = MatSeqAIJSingleSetOps_Private(A,PETSC_FALSE);CHKERRQ(ierr);}
+  } else if (A->assembled) {
+    ierr = MatSeqAIJSingleSetOps_Private(A,flg);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAIJSetSinglePrecision"
+/*@
+   MatAIJSetSinglePrecision - Keeps a single precision copy of the values of an AIJ matrix, or of its LU or ILU
+   factor, that is used by MatMult() and MatMultAdd(), or by MatSolve() for the factor.
+
+   Logically Collective on Mat
+
+   Input Parameters:
++  A - the MATSEQAIJ or MATMPIAIJ matrix, or the factor obtained with MatGetFactor() for MATSOLVERPETSC
+-  flg - PETSC_TRUE to use the single precision values
+
+   Options Database Key:
+.  -mat_aij_single - use the single precision values in MatMult() and MatMultAdd()
+
+   Notes:
+   The values are rounded to single precision after each assembly or numeric factorization; the vectors, and all the
+   sums of the products and the triangular solves, stay in double precision. The memory traffic for the matrix values,
+   which dominates these operations, is therefore halved, at the price of a relative error of about 1.e-7 in the result.
+   This is meant for preconditioners inside a Krylov method that runs in double precision, see
+   PCFactorSetUseSinglePrecision() and PCMGSetUseSinglePrecision(). The double precision values are kept, all other
+   operations, for example MatSOR(), MatGetDiagonal() and MatSolveTranspose(), use them.
+
+   The single precision copy is stored in addition to the double precision values, so this saves no memory: it adds
+   4 bytes per nonzero, for instance 5.0 MB to the 19.0 MB of the five point Laplacian on a 500 by 500 grid.
+   The copy is refreshed whenever the object state of the matrix changed, which the operations that change the
+   values increase, including MatSeqAIJRestoreArray() and MatRetrieveValues().
+
+   It is only available when PETSc is configured with real double precision scalars, otherwise it is ignored. For
+   factors it applies to the LU and ILU factorizations of MATSOLVERPETSC, which must be called on the factor before
+   the numeric factorization. Other matrix types ignore it.
+
+   Level: advanced
+
+.keywords: matrix, aij, single precision, mixed precision
+
+.seealso: MatCreateAIJ(), PCFactorSetUseSinglePrecision(), PCMGSetUseSinglePrecision()
+@*/
+PetscErrorCode MatAIJSetSinglePrecision(Mat A,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidLogicalCollectiveBool(A,flg,2);
+  ierr = PetscTryMethod(A,"MatAIJSetSinglePrecision_C",(Mat,PetscBool),(A,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDuplicate_SeqAIJ_Single"
+PetscErrorCode MatDuplicate_SeqAIJ_Single(Mat A,MatDuplicateOption cpvalues,Mat *C)
+{
+  Mat            B = *C;
+  Mat_SeqAIJ     *c = (Mat_SeqAIJ*)B->data,*a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  c->single.use = a->single.use;
+  c->single.a   = NULL;
+  c->single.n   = 0;
+  /* the single precision values are computed with the first product */
+  if (c->single.use && !B->factortype) {ierr = MatSeqAIJSingleSetOps_Private(B,PETSC_TRUE);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_SeqAIJ_Single"
+PetscErrorCode MatDestroy_SeqAIJ_Single(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(a->single.a);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatAIJSetSinglePrecision_C",NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatView_SeqAIJ_Single"
+PetscErrorCode MatView_SeqAIJ_Single(Mat A,PetscViewer viewer)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+
+  PetscFunctionBegin;
+  if (!a->single.use) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+    if (format == PETSC_VIEWER_ASCII_INFO_DETAIL || format == PETSC_VIEWER_ASCII_INFO) {
+      ierr = PetscViewerASCIIPrintf(viewer,"using single precision values in %s\n",A->factortype ? "MatSolve()" : "MatMult()");CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_SeqAIJ_Single"
+/*
+   Reads -mat_aij_single; like the Inode and OpenMP options this applies to every SeqAIJ matrix, including the blocks
+   of MATMPIAIJ matrices
+*/
+PetscErrorCode MatCreate_SeqAIJ_Single(Mat B)
+{
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)B->data;
+  PetscBool      flg = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  b->single.use     = PETSC_FALSE;
+  b->single.a       = NULL;
+  b->single.n       = 0;
+  b->single.state   = 0;
+  b->single.mult    = NULL;
+  b->single.multadd = NULL;
+  b->single.solve   = NULL;
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatAIJSetSinglePrecision_C",MatAIJSetSinglePrecision_SeqAIJ);CHKERRQ(ierr);
+
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Options for SEQAIJ matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_single","Use single precision values in MatMult()","MatAIJSetSinglePrecision",flg,&flg,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (flg) {ierr = MatAIJSetSinglePrecision_SeqAIJ(B,flg);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,135 @@
+
+/*
+    Level-scheduled OpenMP threaded MatSolve() for the LU and ILU factors of SeqAIJ matrices. The level
+  sets of L and U are computed with the first numeric factorization after a symbolic factorization and
+  reused by later numeric factorizations, since those do not change the nonzero pattern of the factor.
+  Each row is computed exactly as in MatSolve_SeqAIJ(), so the result does not depend on the number of threads.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJFactorComputeLevels_Private"
+static PetscErrorCode MatSeqAIJFactorComputeLevels_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       n  = A->rmap->n,i,k,d,*depth;
+  const PetscInt *ai = a->i,*aj = a->j,*adiag = a->diag;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(n,&depth);CHKERRQ(ierr);
+  /* L: row i holds the columns ai[i] <= k < ai[i+1], all of them less than i */
+  for (i=0; i<n; i++) {
+    d = 0;
+    for (k=ai[i]; k<ai[i+1]; k++) d = PetscMax(d,depth[aj[k]]+1);
+    depth[i] = d;
+  }
+  ierr = MatSolveLevelsSetUp(A,&a->levels,0,n,depth);CHKERRQ(ierr);
+  /* U: row i holds the columns adiag[i+1] < k < adiag[i], all of them greater than i */
+  for (i=n-1; i>=0; i--) {
+    d = 0;
+    for (k=adiag[i+1]+1; k<adiag[i]; k++) d = PetscMax(d,depth[aj[k]]+1);
+    depth[i] = d;
+  }
+  ierr = MatSolveLevelsSetUp(A,&a->levels,1,n,depth);CHKERRQ(ierr);
+  ierr = PetscFree(depth);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,2*(n+a->levels.nlevels[0]+a->levels.nlevels[1]+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  a->levels.nonzerostate = A->nonzerostate;
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_OPENMP)
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqAIJ_Levels"
+static PetscErrorCode MatSolve_SeqAIJ_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  Mat_SolveLevels   *lv = &a->levels;
+  PetscInt          n = A->rmap->n,nt = lv->nthreads;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*r,*c;
+  const MatScalar   *aa = a->a;
+  PetscScalar       *x,*tmp = a->solve_work;
+  const PetscScalar *b;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (!lv->rows[0] || lv->nonzerostate != A->nonzerostate) {
+    ierr = MatSeqAIJFactorComputeLevels_Private(A);CHKERRQ(ierr);
+  }
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+
+#pragma omp parallel num_threads(nt)
+  {
+    const PetscInt  *vi;
+    const MatScalar *v;
+    PetscScalar     sum;
+    PetscInt        l,k,i,nz;
+
+    /* forward solve the lower triangular, one level at a time */
+    for (l=0; l<lv->nlevels[0]; l++) {
+#pragma omp for schedule(static)
+      for (k=lv->level[0][l]; k<lv->level[0][l+1]; k++) {
+        i   = lv->rows[0][k];
+        nz  = ai[i+1] - ai[i];
+        v   = aa + ai[i];
+        vi  = aj + ai[i];
+        sum = b[r[i]];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        tmp[i] = sum;
+      }
+    }
+
+    /* backward solve the upper triangular */
+    for (l=0; l<lv->nlevels[1]; l++) {
+#pragma omp for schedule(static)
+      for (k=lv->level[1][l]; k<lv->level[1][l+1]; k++) {
+        i   = lv->rows[1][k];
+        v   = aa + adiag[i+1] + 1;
+        vi  = aj + adiag[i+1] + 1;
+        nz  = adiag[i] - adiag[i+1] - 1;
+        sum = tmp[i];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        x[c[i]] = tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+      }
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJFactorSetUpLevels"
+/*
+   MatSeqAIJFactorSetUpLevels - Called at the end of the numeric LU and ILU factorizations that produce the
+   factor in the (non-inplace) format used by MatSolve_SeqAIJ(); with -mat_solve_levels it computes the level
+   sets, if the nonzero pattern of the factor changed, and switches MatSolve() to the threaded version.
+*/
+PetscErrorCode MatSeqAIJFactorSetUpLevels(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSolveLevelsSetFromOptions(A,&a->levels);CHKERRQ(ierr);
+  if (!a->levels.use) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_OPENMP)
+  if (!a->levels.rows[0] || a->levels.nonzerostate != A->nonzerostate) {
+    ierr = MatSeqAIJFactorComputeLevels_Private(A);CHKERRQ(ierr);
+  }
+  A->ops->solve = MatSolve_SeqAIJ_Levels;
+#endif
+  PetscFunctionReturn(0);
+}
@@ -82,6 +82,7 @@ PetscErrorCode MatAssemblyEnd_SeqAIJCRL(Mat A, MatAssemblyType mode)
 
   PetscFunctionBegin;
   a->inode.use = PETSC_FALSE;
+  a->omp.use   = PETSC_FALSE;
 
   ierr = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
   if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
@@ -265,6 +265,7 @@ PetscErrorCode MatAssemblyEnd_SeqAIJPERM(Mat A, MatAssemblyType mode)
    * are many zero rows.  If the SeqAIJ assembly end routine decides to use
    * this, this may break things.  (Don't know... haven't looked at it.) */
   a->inode.use = PETSC_FALSE;
+  a->omp.use   = PETSC_FALSE;
   ierr         = MatAssemblyEnd_SeqAIJ(A, mode);CHKERRQ(ierr);
 
   /* Now calculate the permutation and grouping information. */
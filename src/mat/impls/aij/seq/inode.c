@@ -1875,6 +1875,8 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat B,Mat A,const MatFactorInfo *
   C->ops->matsolve          = MatMatSolve_SeqAIJ;
   C->assembled              = PETSC_TRUE;
   C->preallocated           = PETSC_TRUE;
+  ierr = MatSeqAIJFactorSetUpLevels(C);CHKERRQ(ierr);
+  ierr = MatSeqAIJFactorSetUpSingle(C);CHKERRQ(ierr);
 
   ierr = PetscLogFlops(C->cmap->n);CHKERRQ(ierr);
 
@@ -2767,6 +2769,13 @@ PetscErrorCode MatSOR_SeqAIJ_Inode(Mat A,Vec bb,PetscReal omega,MatSORType flag,
   const PetscInt    *sizes = a->inode.size,*idx,*diag = a->diag,*ii = a->i;
 
   PetscFunctionBegin;
+  if (flag & SOR_MULTICOLOR) {
+    if (!(flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER))) {
+      ierr = MatSOR_SeqAIJ_Multicolor(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr); /* the rows are colored, not the inodes */
+      PetscFunctionReturn(0);
+    }
+    flag = (MatSORType)(flag & ~SOR_MULTICOLOR);
+  }
   allowzeropivot = PetscNot(A->erroriffailure);
   if (omega != 1.0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"No support for omega != 1.0; use -mat_no_inode");
   if (fshift == -1.0) fshift = 0.0; /* negative fshift indicates do not error on zero diagonal; this code never errors on zero diagonal */
@@ -14,7 +14,7 @@
 PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat A,Mat P,MatReuse scall,PetscReal fill,Mat *C)
 {
   PetscErrorCode ierr;
-  const char     *algTypes[2] = {"scalable","nonscalable"};
+  const char     *algTypes[4] = {"scalable","nonscalable","allatonce","allatonce_merged"};
   PetscInt       alg=0; /* set default algorithm */
 
   PetscFunctionBegin;
@@ -23,9 +23,10 @@ PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat A,Mat P,MatReuse scall,Pet
      Alg 'scalable' determines which implementations to be used:
        "nonscalable": do dense axpy in MatPtAPNumeric() - fastest, but requires storage of struct A*P;
        "scalable":    do two sparse axpy in MatPtAPNumeric() - might slow, does not store structure of A*P. 
+       "allatonce", "allatonce_merged": the parallel all-at-once algorithms, use "scalable" for sequential matrices
      */
     ierr = PetscObjectOptionsBegin((PetscObject)A);CHKERRQ(ierr);
-    ierr = PetscOptionsEList("-matptap_via","Algorithmic approach","MatPtAP",algTypes,2,algTypes[0],&alg,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsEList("-matptap_via","Algorithmic approach","MatPtAP",algTypes,4,algTypes[0],&alg,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsEnd();CHKERRQ(ierr);
     ierr = PetscLogEventBegin(MAT_PtAPSymbolic,A,P,0,0);CHKERRQ(ierr);
     switch (alg) {
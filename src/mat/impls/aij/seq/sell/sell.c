@@ -0,0 +1,559 @@
+
+/*
+  Defines the matrix-vector products for the MATSEQSELL matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage (aka Yale sparse matrix format) but augments
+  it with a sliced ELLPACK copy (SELL-C-sigma, Kreutzer et al. 2014) that
+  is used for MatMult(), MatMultAdd(), MatMultTranspose() and MatMultTransposeAdd().
+
+  The sliced copy is built lazily by the first product after the nonzero
+  structure or the object state of the matrix have changed, so every operation
+  inherited from AIJ that changes the matrix keeps working unmodified. The
+  changes of the values that bypass MatSetValues(), MatSeqAIJRestoreArray(),
+  MatRetrieveValues() and the MPIAIJ operations working on the blocks
+  directly, also increase the state.
+*/
+#include <../src/mat/impls/aij/seq/sell/sell.h>
+
+/*
+   The vector kernels need 8 byte real values and 4 byte column indices so that
+   one slice column can be gathered with a single instruction
+*/
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_REAL_MAT_SINGLE) && !defined(PETSC_USE_64BIT_INDICES)
+#if defined(__AVX512F__)
+#define MAT_SEQSELL_AVX512
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define MAT_SEQSELL_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqSELLUpdate_Private"
+/*
+   Builds the sliced copy of the matrix; the row permutation and the padded column
+   indices are only recomputed when the nonzero structure changed
+*/
+static PetscErrorCode MatSeqSELLUpdate_Private(Mat A)
+{
+  Mat_SeqAIJ      *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqSELL     *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt        m     = A->rmap->n,C = sell->C,*ai = a->i,*aj = a->j;
+  MatScalar       *aa   = a->a;
+  PetscInt        i,j,k,r,s,p,w,wn,len,row,width,nslices,pad,*rlen,*perm,*sliidx,*colidx;
+  const PetscInt  *pj;
+  const MatScalar *pa;
+  MatScalar       *val;
+  PetscBool       newstructure;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (sell->sliidx && sell->m == m && sell->nonzerostate == A->nonzerostate && sell->nz == a->nz && sell->state == ((PetscObject)A)->state) PetscFunctionReturn(0);
+  newstructure = (PetscBool)(!sell->sliidx || sell->m != m || sell->nonzerostate != A->nonzerostate || sell->nz != a->nz);
+  if (newstructure) {
+    ierr    = PetscFree2(sell->perm,sell->sliidx);CHKERRQ(ierr);
+    ierr    = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+    nslices = (m+C-1)/C;
+    ierr    = PetscMalloc2(m,&sell->perm,nslices+1,&sell->sliidx);CHKERRQ(ierr);
+    perm    = sell->perm;
+    sliidx  = sell->sliidx;
+    for (i=0; i<m; i++) perm[i] = i;
+    if (sell->sigma > 1) {
+      /* sort the rows by decreasing length inside each window, keeping the original order among rows of equal length */
+      ierr = PetscMalloc1(PetscMin(sell->sigma,m),&rlen);CHKERRQ(ierr);
+      for (w=0; w<m; w+=sell->sigma) {
+        wn = PetscMin(sell->sigma,m-w);
+        for (i=0; i<wn; i++) rlen[i] = -(ai[w+i+1]-ai[w+i]);
+        ierr = PetscSortIntWithArray(wn,rlen,perm+w);CHKERRQ(ierr);
+        for (i=0; i<wn; i=j) {
+          for (j=i+1; j<wn && rlen[j] == rlen[i]; j++) ;
+          ierr = PetscSortInt(j-i,perm+w+i);CHKERRQ(ierr);
+        }
+      }
+      ierr = PetscFree(rlen);CHKERRQ(ierr);
+    }
+    sliidx[0] = 0;
+    for (s=0; s<nslices; s++) {
+      width = 0;
+      for (p=s*C; p<PetscMin((s+1)*C,m); p++) width = PetscMax(width,ai[perm[p]+1]-ai[perm[p]]);
+      sliidx[s+1] = sliidx[s] + width*C;
+    }
+    ierr = PetscMalloc2(sliidx[nslices],&sell->colidx,sliidx[nslices],&sell->val);CHKERRQ(ierr);
+    sell->m            = m;
+    sell->nslices      = nslices;
+    sell->nz           = a->nz;
+    sell->nstored  = sliidx[nslices];
+    sell->nonzerostate = A->nonzerostate;
+    ierr = PetscInfo4(A,"SELL-%D-%D storage with %D slices; percentage of 0's introduced for vectorized multiply %g\n",C,sell->sigma,nslices,sell->nstored ? 1.0-((double)a->nz)/((double)sell->nstored) : 0.0);CHKERRQ(ierr);
+  }
+  perm   = sell->perm;
+  sliidx = sell->sliidx;
+  colidx = sell->colidx;
+  val    = sell->val;
+  for (s=0; s<sell->nslices; s++) {
+    /* empty rows are padded with a column of another row of the slice, never with a column that may not exist (n == 0) */
+    pad = 0;
+    if (newstructure) {
+      for (p=s*C; p<PetscMin((s+1)*C,m); p++) {
+        if (ai[perm[p]+1] > ai[perm[p]]) {pad = aj[ai[perm[p]]]; break;}
+      }
+    }
+    for (r=0; r<C; r++) {
+      p   = s*C+r;
+      len = 0;
+      pj  = NULL;
+      pa  = NULL;
+      if (p < m) {
+        row = perm[p];
+        len = ai[row+1]-ai[row];
+        pj  = aj + ai[row];
+        pa  = aa + ai[row];
+      }
+      for (k=sliidx[s]+r,j=0; k<sliidx[s+1]; k+=C,j++) {
+        if (j < len) {
+          val[k] = pa[j];
+          if (newstructure) colidx[k] = pj[j];
+        } else {
+          /* padding multiplies a zero with an entry of x that is already being loaded */
+          val[k] = 0.0;
+          if (newstructure) colidx[k] = len ? pj[len-1] : pad;
+        }
+      }
+    }
+  }
+  sell->state = ((PetscObject)A)->state;
+  PetscFunctionReturn(0);
+}
+
+/*
+   sum[r] = sum_k val[k,r] x[colidx[k,r]] for the C rows of slice s
+*/
+PETSC_STATIC_INLINE void MatSeqSELLSliceMult_Private(const Mat_SeqSELL *sell,PetscInt s,const PetscScalar *x,PetscScalar *sum)
+{
+  const PetscInt  C       = sell->C,start = sell->sliidx[s],end = sell->sliidx[s+1];
+  const PetscInt  *colidx = sell->colidx;
+  const MatScalar *val    = sell->val;
+  PetscInt        r,k;
+
+#if defined(MAT_SEQSELL_AVX512)
+  if (!(C%8)) {
+    for (r=0; r<C; r+=8) {
+      __m512d acc = _mm512_setzero_pd();
+      for (k=start+r; k<end; k+=C) {
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(colidx+k));
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(val+k),_mm512_i32gather_pd(idx,x,8),acc);
+      }
+      _mm512_storeu_pd(sum+r,acc);
+    }
+    return;
+  }
+#elif defined(MAT_SEQSELL_AVX2)
+  if (!(C%4)) {
+    for (r=0; r<C; r+=4) {
+      __m256d acc = _mm256_setzero_pd();
+      for (k=start+r; k<end; k+=C) {
+        __m128i idx = _mm_loadu_si128((const __m128i*)(colidx+k));
+#if defined(__FMA__)
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(val+k),_mm256_i32gather_pd(x,idx,8),acc);
+#else
+        acc = _mm256_add_pd(acc,_mm256_mul_pd(_mm256_loadu_pd(val+k),_mm256_i32gather_pd(x,idx,8)));
+#endif
+      }
+      _mm256_storeu_pd(sum+r,acc);
+    }
+    return;
+  }
+#endif
+  for (r=0; r<C; r++) sum[r] = 0.0;
+  for (k=start; k<end; k+=C) {
+    for (r=0; r<C; r++) sum[r] += val[k+r]*x[colidx[k+r]];
+  }
+}
+
+/*
+   y[colidx[k,r]] += val[k,r] xs[r] for the C rows of slice s; xs holds the entries of x of the rows of the slice
+*/
+PETSC_STATIC_INLINE void MatSeqSELLSliceMultTranspose_Private(const Mat_SeqSELL *sell,PetscInt s,const PetscScalar *xs,PetscScalar *y)
+{
+  const PetscInt  C       = sell->C,start = sell->sliidx[s],end = sell->sliidx[s+1];
+  const PetscInt  *colidx = sell->colidx;
+  const MatScalar *val    = sell->val;
+  PetscInt        r,k;
+#if defined(MAT_SEQSELL_AVX512) || defined(MAT_SEQSELL_AVX2)
+  PetscScalar     prod[8];
+  PetscInt        i;
+#endif
+
+#if defined(MAT_SEQSELL_AVX512)
+  if (!(C%8)) {
+    for (k=start; k<end; k+=C) {
+      for (r=0; r<C; r+=8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(colidx+k+r));
+        __m512d pv  = _mm512_mul_pd(_mm512_loadu_pd(val+k+r),_mm512_loadu_pd(xs+r));
+#if defined(__AVX512CD__)
+        /* the scatter is only safe when the eight rows update distinct entries of y */
+        __m512i conf = _mm512_conflict_epi64(_mm512_cvtepi32_epi64(idx));
+        if (!_mm512_test_epi64_mask(conf,conf)) {
+          _mm512_i32scatter_pd(y,idx,_mm512_add_pd(_mm512_i32gather_pd(idx,y,8),pv),8);
+          continue;
+        }
+#endif
+        _mm512_storeu_pd(prod,pv);
+        for (i=0; i<8; i++) y[colidx[k+r+i]] += prod[i];
+      }
+    }
+    return;
+  }
+#elif defined(MAT_SEQSELL_AVX2)
+  if (!(C%4)) {
+    for (k=start; k<end; k+=C) {
+      for (r=0; r<C; r+=4) {
+        _mm256_storeu_pd(prod,_mm256_mul_pd(_mm256_loadu_pd(val+k+r),_mm256_loadu_pd(xs+r)));
+        for (i=0; i<4; i++) y[colidx[k+r+i]] += prod[i];
+      }
+    }
+    return;
+  }
+#endif
+  for (k=start; k<end; k+=C) {
+    for (r=0; r<C; r++) y[colidx[k+r]] += val[k+r]*xs[r];
+  }
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_SeqSELL"
+PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt          m     = A->rmap->n,C = sell->C,s,r,nr;
+  const PetscInt    *perm;
+  PetscScalar       sum[MAT_SEQSELL_MAX_SLICE_HEIGHT],*y;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqSELLUpdate_Private(A);CHKERRQ(ierr);
+  perm = sell->perm;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    MatSeqSELLSliceMult_Private(sell,s,x,sum);
+    nr = PetscMin(C,m-s*C);
+    for (r=0; r<nr; r++) y[perm[s*C+r]] = sum[r];
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqSELL"
+PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec ww,Vec yy)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt          m     = A->rmap->n,C = sell->C,s,r,nr;
+  const PetscInt    *perm;
+  PetscScalar       sum[MAT_SEQSELL_MAX_SLICE_HEIGHT],*y,*w;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqSELLUpdate_Private(A);CHKERRQ(ierr);
+  perm = sell->perm;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(ww,yy,&w,&y);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    MatSeqSELLSliceMult_Private(sell,s,x,sum);
+    nr = PetscMin(C,m-s*C);
+    for (r=0; r<nr; r++) y[perm[s*C+r]] = w[perm[s*C+r]] + sum[r];
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(ww,yy,&w,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultTransposeAdd_SeqSELL"
+PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec ww,Vec yy)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt          m     = A->rmap->n,C = sell->C,s,r,nr;
+  const PetscInt    *perm;
+  PetscScalar       xs[MAT_SEQSELL_MAX_SLICE_HEIGHT],*y;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqSELLUpdate_Private(A);CHKERRQ(ierr);
+  perm = sell->perm;
+  if (ww != yy) {ierr = VecCopy(ww,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    nr = PetscMin(C,m-s*C);
+    for (r=0; r<nr; r++) xs[r] = x[perm[s*C+r]];
+    for (; r<C; r++) xs[r] = 0.0;
+    MatSeqSELLSliceMultTranspose_Private(sell,s,xs,y);
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultTranspose_SeqSELL"
+PetscErrorCode MatMultTranspose_SeqSELL(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqSELL(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatView_SeqSELL"
+PetscErrorCode MatView_SeqSELL(Mat A,PetscViewer viewer)
+{
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  PetscBool         iascii;
+  PetscViewerFormat format;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatView_SeqAIJ(A,viewer);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (!iascii) PetscFunctionReturn(0);
+  ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
+  if (format == PETSC_VIEWER_ASCII_INFO || format == PETSC_VIEWER_ASCII_INFO_DETAIL) {
+    ierr = MatSeqSELLUpdate_Private(A);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"using SELL-%D-%D storage for products, %D slices, %D stored entries for %D nonzeros\n",sell->C,sell->sigma,sell->nslices,sell->nstored,sell->nz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqSELLSetParameters_Private"
+/*
+   Sets the slice height and the sorting window; used by MATMPISELL to pass its options to the diagonal and off-diagonal blocks
+*/
+PetscErrorCode MatSeqSELLSetParameters_Private(Mat A,PetscInt C,PetscInt sigma)
+{
+  Mat_SeqSELL    *sell = (Mat_SeqSELL*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (C < 1 || C > MAT_SEQSELL_MAX_SLICE_HEIGHT) SETERRQ2(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Slice height %D must be between 1 and %D",C,(PetscInt)MAT_SEQSELL_MAX_SLICE_HEIGHT);
+  if (sigma < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Sorting window %D must be positive",sigma);
+  if (C != sell->C || sigma != sell->sigma) {
+    sell->C     = C;
+    sell->sigma = sigma;
+    /* forces a rebuild of the sliced copy */
+    ierr = PetscFree2(sell->perm,sell->sliidx);CHKERRQ(ierr);
+    ierr = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_SeqSELL"
+PetscErrorCode MatDestroy_SeqSELL(Mat A)
+{
+  PetscErrorCode ierr;
+  Mat_SeqSELL    *sell = (Mat_SeqSELL*) A->spptr;
+
+  PetscFunctionBegin;
+  if (sell) {
+    ierr = PetscFree2(sell->perm,sell->sliidx);CHKERRQ(ierr);
+    ierr = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqsell_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDuplicate_SeqSELL"
+PetscErrorCode MatDuplicate_SeqSELL(Mat A,MatDuplicateOption op,Mat *M)
+{
+  Mat_SeqSELL    *sell = (Mat_SeqSELL*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* the new matrix is created with type MATSEQSELL; its sliced copy is built by its first product */
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  ierr = MatSeqSELLSetParameters_Private(*M,sell->C,sell->sigma);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_SeqSELL"
+PetscErrorCode MatAssemblyEnd_SeqSELL(Mat A,MatAssemblyType mode)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+
+  PetscFunctionBegin;
+  /* the products are always done by the sliced copy */
+  a->inode.use = PETSC_FALSE;
+  a->omp.use   = PETSC_FALSE;
+
+  ierr = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_SeqSELL_SeqAIJ"
+PETSC_INTERN PetscErrorCode MatConvert_SeqSELL_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_SeqSELL    *sell;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+  sell = (Mat_SeqSELL*)B->spptr;
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJ;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy          = MatDestroy_SeqAIJ;
+  B->ops->view             = MatView_SeqAIJ;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+
+  ierr = PetscFree2(sell->perm,sell->sliidx);CHKERRQ(ierr);
+  ierr = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqsell_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_SeqAIJ_SeqSELL"
+/* MatConvert_SeqAIJ_SeqSELL converts a SeqAIJ matrix into a
+ * SeqSELL matrix.  This routine is called by the MatCreate_SeqSELL()
+ * routine, but can also be used to convert an assembled SeqAIJ matrix
+ * into a SeqSELL one. */
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_SeqSELL    *sell;
+  PetscInt       C = 8,sigma = 64;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr     = PetscNewLog(B,&sell);CHKERRQ(ierr);
+  B->spptr = (void*)sell;
+
+  ierr = PetscObjectOptionsBegin((PetscObject)B);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_sell_slice_height","Number of rows in each slice","MatCreateSeqSELL",C,&C,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_sell_sigma","Rows are sorted by length inside windows of this many rows","MatCreateSeqSELL",sigma,&sigma,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  ierr = MatSeqSELLSetParameters_Private(B,C,sigma);CHKERRQ(ierr);
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate        = MatDuplicate_SeqSELL;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqSELL;
+  B->ops->destroy          = MatDestroy_SeqSELL;
+  B->ops->view             = MatView_SeqSELL;
+  B->ops->mult             = MatMult_SeqSELL;
+  B->ops->multadd          = MatMultAdd_SeqSELL;
+  B->ops->multtranspose    = MatMultTranspose_SeqSELL;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqSELL;
+
+  /* the products are always done by the sliced copy, which is built when first needed */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+  ((Mat_SeqAIJ*)B->data)->omp.use   = PETSC_FALSE;
+
+  ierr    = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqsell_seqaij_C",MatConvert_SeqSELL_SeqAIJ);CHKERRQ(ierr);
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQSELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreateSeqSELL"
+/*@C
+   MatCreateSeqSELL - Creates a sparse matrix of type SEQSELL.
+   This type inherits from AIJ, but keeps a copy of the matrix in the
+   sliced ELLPACK format SELL-C-sigma that is used for the matrix-vector products.
+   The rows are sorted by length inside windows of sigma rows and grouped into
+   slices of C rows that are padded to the length of their longest row and stored
+   column by column, so that the products can use vector loads and gathers
+   (AVX2 or AVX-512 when PETSc is compiled for them). As with the AIJ type, it is
+   important to preallocate matrix storage in order to get good assembly performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
++  -mat_sell_slice_height <C> - number of rows in each slice (default 8, at most 64)
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length inside windows of sigma rows, 1 disables the sorting (default 64)
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   The sliced copy needs about as much additional storage as the AIJ matrix itself plus the padding;
+   the percentage of padding is reported by -info and -mat_view ::ascii_info.
+
+   Level: intermediate
+
+.keywords: matrix, sparse, sliced ellpack, vectorization
+
+.seealso: MatCreate(), MatCreateSELL(), MatSetValues(), MATSELL
+@*/
+PetscErrorCode  MatCreateSeqSELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQSELL);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_SeqSELL"
+PETSC_EXTERN PetscErrorCode MatCreate_SeqSELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqSELL(A,MATSEQSELL,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
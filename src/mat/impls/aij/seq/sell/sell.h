@@ -0,0 +1,35 @@
+
+#if !defined(__SELL_H)
+#define __SELL_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+/*
+   Sliced ELLPACK (SELL-C-sigma) storage kept alongside the CSR arrays of a SeqAIJ matrix.
+
+   The rows are sorted by decreasing length inside windows of sigma consecutive rows and then cut
+   into slices of C rows. Each slice is padded to the length of its longest row and stored column by
+   column, so the k-th entries of the C rows of a slice are contiguous and can be loaded as one vector.
+*/
+#define MAT_SEQSELL_MAX_SLICE_HEIGHT 64
+
+typedef struct {
+  PetscInt         C;            /* slice height, number of rows in each slice */
+  PetscInt         sigma;        /* rows are sorted by length inside windows of this many rows */
+  PetscInt         m;            /* number of rows */
+  PetscInt         nslices;
+  PetscInt         *perm;        /* perm[p] is the row of the matrix stored at position p */
+  PetscInt         *sliidx;      /* slice s occupies entries sliidx[s] to sliidx[s+1]-1 */
+  PetscInt         *colidx;      /* column index of each stored entry; padding repeats a valid column */
+  MatScalar        *val;         /* value of each stored entry; padding is zero */
+  PetscInt         nz;           /* number of true nonzeros */
+  PetscInt         nstored;      /* sliidx[nslices], the number of stored entries including padding */
+  PetscObjectState nonzerostate; /* nonzero state of the matrix the structure was built for */
+  PetscObjectState state;        /* object state of the matrix the values were copied from */
+} Mat_SeqSELL;
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqSELL_SeqAIJ(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatSeqSELLSetParameters_Private(Mat,PetscInt,PetscInt);
+
+#endif
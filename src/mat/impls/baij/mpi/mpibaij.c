@@ -902,6 +902,40 @@ PetscErrorCode MatAssemblyBegin_MPIBAIJ(Mat mat,MatAssemblyType mode)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatStashInsert_MPIBAIJ"
+/* adds a value received by the streaming stash, see MatStashSetOwners_Private() */
+static PetscErrorCode MatStashInsert_MPIBAIJ(Mat mat,PetscInt row,PetscInt col,const PetscScalar v[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetValues_MPIBAIJ(mat,1,&row,1,&col,v,ADD_VALUES);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashInsertBlocked_MPIBAIJ"
+/* adds a block received by the streaming block stash; as in MatAssemblyEnd_MPIBAIJ() its values are column oriented */
+static PetscErrorCode MatStashInsertBlocked_MPIBAIJ(Mat mat,PetscInt row,PetscInt col,const PetscScalar v[])
+{
+  Mat_MPIBAIJ    *baij = (Mat_MPIBAIJ*)mat->data;
+  Mat_SeqBAIJ    *a    = (Mat_SeqBAIJ*)baij->A->data,*b = (Mat_SeqBAIJ*)baij->B->data;
+  PetscBool      r1 = baij->roworiented,r2 = a->roworiented,r3 = b->roworiented;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  baij->roworiented = PETSC_FALSE;
+  a->roworiented    = PETSC_FALSE;
+  b->roworiented    = PETSC_FALSE;
+  ierr = MatSetValuesBlocked_MPIBAIJ(mat,1,&row,1,&col,v,ADD_VALUES);CHKERRQ(ierr);
+  /* the off-diagonal block may have been disassembled */
+  baij->roworiented = r1;
+  a->roworiented    = r2;
+  ((Mat_SeqBAIJ*)baij->B->data)->roworiented = r3;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatAssemblyEnd_MPIBAIJ"
 PetscErrorCode MatAssemblyEnd_MPIBAIJ(Mat mat,MatAssemblyType mode)
@@ -2505,7 +2539,7 @@ PetscErrorCode MatSOR_MPIBAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,P
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_SYMMETRIC_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,(MatSORType)(SOR_SYMMETRIC_SWEEP | (flag & SOR_MULTICOLOR)),fshift,lits,1,xx);CHKERRQ(ierr);
     }
   } else if (flag & SOR_LOCAL_FORWARD_SWEEP) {
     if (flag & SOR_ZERO_INITIAL_GUESS) {
@@ -2521,7 +2555,7 @@ PetscErrorCode MatSOR_MPIBAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,P
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_FORWARD_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,(MatSORType)(SOR_FORWARD_SWEEP | (flag & SOR_MULTICOLOR)),fshift,lits,1,xx);CHKERRQ(ierr);
     }
   } else if (flag & SOR_LOCAL_BACKWARD_SWEEP) {
     if (flag & SOR_ZERO_INITIAL_GUESS) {
@@ -2537,7 +2571,7 @@ PetscErrorCode MatSOR_MPIBAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,P
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_BACKWARD_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,(MatSORType)(SOR_BACKWARD_SWEEP | (flag & SOR_MULTICOLOR)),fshift,lits,1,xx);CHKERRQ(ierr);
     }
   } else SETERRQ(PetscObjectComm((PetscObject)matin),PETSC_ERR_SUP,"Parallel version of SOR requested not supported");
 
@@ -3001,6 +3035,8 @@ PetscErrorCode  MatMPIBAIJSetPreallocation_MPIBAIJ(Mat B,PetscInt bs,PetscInt d_
     ierr = PetscLogObjectParent((PetscObject)B,(PetscObject)b->B);CHKERRQ(ierr);
     ierr = MatStashCreate_Private(PetscObjectComm((PetscObject)B),bs,&B->bstash);CHKERRQ(ierr);
   }
+  ierr = MatStashSetOwners_Private(&B->stash,B->rmap->range,MatStashInsert_MPIBAIJ);CHKERRQ(ierr);
+  ierr = MatStashSetOwners_Private(&B->bstash,b->rangebs,MatStashInsertBlocked_MPIBAIJ);CHKERRQ(ierr);
 
   ierr = MatSeqBAIJSetPreallocation(b->A,bs,d_nz,d_nnz);CHKERRQ(ierr);
   ierr = MatSeqBAIJSetPreallocation(b->B,bs,o_nz,o_nnz);CHKERRQ(ierr);
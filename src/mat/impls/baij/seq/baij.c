@@ -14,8 +14,8 @@ PetscErrorCode MatInvertBlockDiagonal_SeqBAIJ(Mat A,const PetscScalar **values)
 {
   Mat_SeqBAIJ    *a = (Mat_SeqBAIJ*) A->data;
   PetscErrorCode ierr;
-  PetscInt       *diag_offset,i,bs = A->rmap->bs,mbs = a->mbs,ipvt[5],bs2 = bs*bs,*v_pivots;
-  MatScalar      *v    = a->a,*odiag,*diag,*mdiag,work[25],*v_work;
+  PetscInt       *diag_offset,i,bs = A->rmap->bs,mbs = a->mbs,bs2 = bs*bs;
+  MatScalar      *v    = a->a,*odiag,*diag,*mdiag;
   PetscReal      shift = 0.0;
   PetscBool      allowzeropivot,zeropivotdetected=PETSC_FALSE;
 
@@ -55,88 +55,15 @@ PetscErrorCode MatInvertBlockDiagonal_SeqBAIJ(Mat A,const PetscScalar **values)
       mdiag   += 1;
     }
     break;
-  case 2:
-    for (i=0; i<mbs; i++) {
-      odiag    = v + 4*diag_offset[i];
-      diag[0]  = odiag[0]; diag[1] = odiag[1]; diag[2] = odiag[2]; diag[3] = odiag[3];
-      mdiag[0] = odiag[0]; mdiag[1] = odiag[1]; mdiag[2] = odiag[2]; mdiag[3] = odiag[3];
-      ierr     = PetscKernel_A_gets_inverse_A_2(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag    += 4;
-      mdiag   += 4;
-    }
-    break;
-  case 3:
-    for (i=0; i<mbs; i++) {
-      odiag    = v + 9*diag_offset[i];
-      diag[0]  = odiag[0]; diag[1] = odiag[1]; diag[2] = odiag[2]; diag[3] = odiag[3];
-      diag[4]  = odiag[4]; diag[5] = odiag[5]; diag[6] = odiag[6]; diag[7] = odiag[7];
-      diag[8]  = odiag[8];
-      mdiag[0] = odiag[0]; mdiag[1] = odiag[1]; mdiag[2] = odiag[2]; mdiag[3] = odiag[3];
-      mdiag[4] = odiag[4]; mdiag[5] = odiag[5]; mdiag[6] = odiag[6]; mdiag[7] = odiag[7];
-      mdiag[8] = odiag[8];
-      ierr     = PetscKernel_A_gets_inverse_A_3(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag    += 9;
-      mdiag   += 9;
-    }
-    break;
-  case 4:
-    for (i=0; i<mbs; i++) {
-      odiag  = v + 16*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,16*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscMemcpy(mdiag,odiag,16*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A_4(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += 16;
-      mdiag += 16;
-    }
-    break;
-  case 5:
-    for (i=0; i<mbs; i++) {
-      odiag  = v + 25*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,25*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscMemcpy(mdiag,odiag,25*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A_5(diag,ipvt,work,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += 25;
-      mdiag += 25;
-    }
-    break;
-  case 6:
-    for (i=0; i<mbs; i++) {
-      odiag  = v + 36*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,36*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscMemcpy(mdiag,odiag,36*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A_6(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += 36;
-      mdiag += 36;
-    }
-    break;
-  case 7:
-    for (i=0; i<mbs; i++) {
-      odiag  = v + 49*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,49*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscMemcpy(mdiag,odiag,49*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A_7(diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += 49;
-      mdiag += 49;
-    }
-    break;
   default:
-    ierr = PetscMalloc2(bs,&v_work,bs,&v_pivots);CHKERRQ(ierr);
     for (i=0; i<mbs; i++) {
-      odiag  = v + bs2*diag_offset[i];
-      ierr   = PetscMemcpy(diag,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscMemcpy(mdiag,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
-      ierr   = PetscKernel_A_gets_inverse_A(bs,diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
-      if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
-      diag  += bs2;
-      mdiag += bs2;
+      odiag = v + bs2*diag_offset[i];
+      ierr  = PetscMemcpy(diag+bs2*i,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
+      ierr  = PetscMemcpy(mdiag+bs2*i,odiag,bs2*sizeof(PetscScalar));CHKERRQ(ierr);
     }
-    ierr = PetscFree2(v_work,v_pivots);CHKERRQ(ierr);
+    /* several blocks at a time with the vector kernels */
+    ierr = PetscKernel_A_gets_inverse_A_batch(bs,mbs,diag,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
   }
   a->idiagvalid = PETSC_TRUE;
   PetscFunctionReturn(0);
@@ -165,6 +92,10 @@ PetscErrorCode MatSOR_SeqBAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,Petsc
   if ((flag & SOR_APPLY_UPPER) || (flag & SOR_APPLY_LOWER)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for applying upper or lower triangular parts");
 
   if (!a->idiagvalid) {ierr = MatInvertBlockDiagonal(A,NULL);CHKERRQ(ierr);}
+  if (flag & SOR_MULTICOLOR) {
+    ierr = MatSOR_SeqBAIJ_Multicolor(A,bb,omega,flag,fshift,its,1,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
 
   if (!m) PetscFunctionReturn(0);
   diag  = a->diag;
@@ -1223,6 +1154,7 @@ PetscErrorCode MatDestroy_SeqBAIJ(Mat A)
   ierr = ISDestroy(&a->col);CHKERRQ(ierr);
   if (a->free_diag) {ierr = PetscFree(a->diag);CHKERRQ(ierr);}
   ierr = PetscFree(a->idiag);CHKERRQ(ierr);
+  ierr = MatSORColoringReset(&a->sorcoloring);CHKERRQ(ierr);
   if (a->free_imax_ilen) {ierr = PetscFree2(a->imax,a->ilen);CHKERRQ(ierr);}
   ierr = PetscFree(a->solve_work);CHKERRQ(ierr);
   ierr = PetscFree(a->mult_work);CHKERRQ(ierr);
@@ -2829,10 +2761,11 @@ PETSC_INTERN PetscErrorCode MatConvert_SeqBAIJ_SeqSBAIJ(Mat, MatType,MatReuse,Ma
 #define __FUNCT__ "MatSeqBAIJSetPreallocation_SeqBAIJ"
 static PetscErrorCode  MatSeqBAIJSetPreallocation_SeqBAIJ(Mat B,PetscInt bs,PetscInt nz,PetscInt *nnz)
 {
-  Mat_SeqBAIJ    *b;
-  PetscErrorCode ierr;
-  PetscInt       i,mbs,nbs,bs2;
-  PetscBool      flg = PETSC_FALSE,skipallocation = PETSC_FALSE,realalloc = PETSC_FALSE;
+  Mat_SeqBAIJ        *b;
+  PetscErrorCode     ierr;
+  PetscInt           i,mbs,nbs,bs2;
+  PetscBool          flg = PETSC_FALSE,skipallocation = PETSC_FALSE,realalloc = PETSC_FALSE;
+  MatSeqBAIJSIMDType simd;
 
   PetscFunctionBegin;
   if (nz >= 0 || nnz) realalloc = PETSC_TRUE;
@@ -2867,8 +2800,12 @@ static PetscErrorCode  MatSeqBAIJSetPreallocation_SeqBAIJ(Mat B,PetscInt bs,Pets
   ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),NULL,"Optimize options for SEQBAIJ matrix 2 ","Mat");CHKERRQ(ierr);
   ierr = PetscOptionsBool("-mat_no_unroll","Do not optimize for block size (slow)",NULL,flg,&flg,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  ierr = MatSeqBAIJGetSIMDType(bs,&simd);CHKERRQ(ierr);
 
-  if (!flg) {
+  if (!flg && simd != MAT_SEQBAIJ_SIMD_NONE) {
+    B->ops->mult    = MatMult_SeqBAIJ_SIMD;
+    B->ops->multadd = MatMultAdd_SeqBAIJ_SIMD;
+  } else if (!flg) {
     switch (bs) {
     case 1:
       B->ops->mult    = MatMult_SeqBAIJ_1;
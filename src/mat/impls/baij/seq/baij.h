@@ -28,6 +28,7 @@
 typedef struct {
   SEQAIJHEADER(MatScalar);
   SEQBAIJHEADER;
+  Mat_SORColoring sorcoloring;         /* coloring of the block rows for the multicolor MatSOR() */
 } Mat_SeqBAIJ;
 
 PETSC_INTERN PetscErrorCode MatGetColumnIJ_SeqBAIJ(Mat,PetscInt,PetscBool,PetscBool,PetscInt*,const PetscInt *[],const PetscInt *[],PetscBool*);
@@ -66,6 +67,7 @@ PETSC_INTERN PetscErrorCode MatGetInfo_SeqBAIJ(Mat,MatInfoType,MatInfo*);
 PETSC_INTERN PetscErrorCode MatZeroEntries_SeqBAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatDestroy_SeqBAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatAssemblyEnd_SeqBAIJ(Mat,MatAssemblyType);
+PETSC_INTERN PetscErrorCode MatSOR_SeqBAIJ_Multicolor(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
 
 PETSC_INTERN PetscErrorCode MatSeqBAIJ_UpdateFactorNumeric_NaturalOrdering(Mat);
 
@@ -198,6 +200,15 @@ PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqBAIJ_15_NaturalOrdering(Mat,Ma
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqBAIJ_N_inplace(Mat,Mat,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqBAIJ_N(Mat,Mat,const MatFactorInfo*);
 
+/* vector instruction sets of the kernels in baijsimd.c */
+typedef enum {MAT_SEQBAIJ_SIMD_NONE,MAT_SEQBAIJ_SIMD_AVX2,MAT_SEQBAIJ_SIMD_AVX512} MatSeqBAIJSIMDType;
+PETSC_INTERN const char *const MatSeqBAIJSIMDTypes[];
+PETSC_INTERN PetscErrorCode MatSeqBAIJGetSIMDType(PetscInt,MatSeqBAIJSIMDType*);
+PETSC_INTERN PetscErrorCode MatMult_SeqBAIJ_SIMD(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatMultAdd_SeqBAIJ_SIMD(Mat,Vec,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatSolve_SeqBAIJ_SIMD(Mat,Vec,Vec);
+PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqBAIJ_SIMD(Mat,Mat,const MatFactorInfo*);
+
 PETSC_INTERN PetscErrorCode MatMult_SeqBAIJ_1(Mat,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMult_SeqBAIJ_2(Mat,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMult_SeqBAIJ_3(Mat,Vec,Vec);
@@ -12,8 +12,14 @@
 */
 PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat fact,PetscBool natural)
 {
+  PetscErrorCode     ierr;
+  MatSeqBAIJSIMDType simd;
+
   PetscFunctionBegin;
-  if (natural) {
+  ierr = MatSeqBAIJGetSIMDType(fact->rmap->bs,&simd);CHKERRQ(ierr);
+  if (simd != MAT_SEQBAIJ_SIMD_NONE) {
+    fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_SIMD;
+  } else if (natural) {
     switch (fact->rmap->bs) {
     case 1:
       fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_1;
@@ -0,0 +1,81 @@
+
+/*
+    Multicolor OpenMP threaded point-block MatSOR() for SeqBAIJ matrices, selected with the SOR_MULTICOLOR flag.
+  The block rows are colored once, see MatSORColoringSetUp(), and each forward (backward) sweep relaxes the
+  colors in increasing (decreasing) order; within a color the block rows are independent and are divided among
+  the threads. Like MatSOR_SeqBAIJ() only omega = 1 and no diagonal shift are supported.
+*/
+#include <../src/mat/impls/baij/seq/baij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSOR_SeqBAIJ_Multicolor"
+/*
+   Called by MatSOR_SeqBAIJ() after it has checked the arguments and inverted the diagonal blocks
+*/
+PetscErrorCode MatSOR_SeqBAIJ_Multicolor(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  Mat_SORColoring   *sc = &a->sorcoloring;
+  PetscScalar       *x,*work;
+  const PetscScalar *b;
+  const MatScalar   *aa = a->a,*idiag = a->idiag;
+  const PetscInt    *ai = a->i,*aj = a->j;
+  PetscInt          m = a->mbs,bs = A->rmap->bs,bs2 = a->bs2,c,s;
+  PetscBool         forward,backward;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  its = its*lits;
+  if (!m) PetscFunctionReturn(0);
+  ierr     = MatSORColoringSetUp(A,sc,m,ai,aj);CHKERRQ(ierr);
+  forward  = (PetscBool)((flag & SOR_FORWARD_SWEEP) || (flag & SOR_LOCAL_FORWARD_SWEEP));
+  backward = (PetscBool)((flag & SOR_BACKWARD_SWEEP) || (flag & SOR_LOCAL_BACKWARD_SWEEP));
+  ierr     = PetscMalloc1(sc->nthreads*bs,&work);CHKERRQ(ierr);
+
+  if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = VecSet(xx,0.0);CHKERRQ(ierr);}
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  while (its--) {
+    for (s=0; s<2; s++) {
+      if ((!s && !forward) || (s && !backward)) continue;
+      for (c=0; c<sc->ncolors; c++) {
+        const PetscInt *rows = sc->rows,cc = s ? sc->ncolors-1-c : c;
+        const PetscInt cs = sc->color[cc],ce = sc->color[cc+1];
+        PetscInt       k;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(sc->nthreads) schedule(static)
+#endif
+        for (k=cs; k<ce; k++) {
+          const PetscInt  i = rows[k];
+          const MatScalar *v,*d = idiag + i*bs2;
+          PetscScalar     *w = work,*xi = x + i*bs,xc;
+          PetscInt        p,r,j;
+
+#if defined(PETSC_HAVE_OPENMP)
+          w = work + omp_get_thread_num()*bs;
+#endif
+          /* w = b_i - sum_j A_ij x_j over the whole block row, then x_i += D_i^{-1} w; the blocks are stored by columns */
+          for (r=0; r<bs; r++) w[r] = b[i*bs+r];
+          for (p=ai[i]; p<ai[i+1]; p++) {
+            v = aa + p*bs2;
+            for (j=0; j<bs; j++) {
+              xc = x[aj[p]*bs+j];
+              for (r=0; r<bs; r++) w[r] -= v[r+j*bs]*xc;
+            }
+          }
+          for (j=0; j<bs; j++) {
+            for (r=0; r<bs; r++) xi[r] += d[r+j*bs]*w[j];
+          }
+        }
+      }
+      ierr = PetscLogFlops(2.0*bs2*a->nz + 2.0*bs2*m);CHKERRQ(ierr);
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = PetscFree(work);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,752 @@
+
+/*
+    AVX2 and AVX-512 kernels for MatMult(), MatMultAdd(), MatSolve() and MatLUFactorNumeric() of SeqBAIJ matrices
+  with block sizes 2 to 8, and for the inversion of many blocks of the same size, as in MatInvertBlockDiagonal().
+
+    The blocks are stored by columns, so a block times a vector is a sum of the columns of the block, each of length
+  bs, scaled by the entries of the vector: one masked register of AVX-512 or two of AVX2 hold a column and the
+  sum. The kernels are compiled for their instruction set with the target attribute, independent of the compiler
+  flags of PETSc, and the instruction set is chosen when they are first used from what the processor supports, so
+  one build of PETSc uses the best kernels available on each machine it runs on.
+*/
+#include <../src/mat/impls/baij/seq/baij.h>
+#include <petsc/private/kernels/blockinvert.h>
+
+/* the kernels need 8 byte real values and a compiler that can compile a function for a given instruction set */
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_REAL_MAT_SINGLE)
+#if (defined(__x86_64__) || defined(__i386__)) && ((defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__))
+#define MAT_SEQBAIJ_SIMD
+#include <immintrin.h>
+#define MAT_SEQBAIJ_AVX2   __attribute__((target("avx2,fma")))
+#define MAT_SEQBAIJ_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+const char *const MatSeqBAIJSIMDTypes[] = {"none","avx2","avx512","MatSeqBAIJSIMDType","MAT_SEQBAIJ_SIMD_",0};
+
+static PetscBool          MatSeqBAIJSIMDSet = PETSC_FALSE;
+static MatSeqBAIJSIMDType MatSeqBAIJSIMD    = MAT_SEQBAIJ_SIMD_NONE;
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqBAIJSIMDFinalize_Private"
+static PetscErrorCode MatSeqBAIJSIMDFinalize_Private(void)
+{
+  PetscFunctionBegin;
+  MatSeqBAIJSIMDSet = PETSC_FALSE;
+  MatSeqBAIJSIMD    = MAT_SEQBAIJ_SIMD_NONE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqBAIJGetSIMDType"
+/*
+   MatSeqBAIJGetSIMDType - The vector instruction set used by the kernels of SeqBAIJ matrices with block size bs
+
+   Notes: The instruction set is determined once, the first time it is needed: the best one the processor supports,
+   or the one given with -mat_baij_simd <none,avx2,avx512> if the processor supports it. It is MAT_SEQBAIJ_SIMD_NONE
+   for block sizes without vector kernels.
+*/
+PetscErrorCode MatSeqBAIJGetSIMDType(PetscInt bs,MatSeqBAIJSIMDType *type)
+{
+  PetscErrorCode     ierr;
+  MatSeqBAIJSIMDType hw = MAT_SEQBAIJ_SIMD_NONE,simd;
+  PetscBool          flg;
+
+  PetscFunctionBegin;
+  if (!MatSeqBAIJSIMDSet) {
+#if defined(MAT_SEQBAIJ_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) hw = MAT_SEQBAIJ_SIMD_AVX512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) hw = MAT_SEQBAIJ_SIMD_AVX2;
+#endif
+    simd = hw;
+    ierr = PetscOptionsGetEnum(NULL,NULL,"-mat_baij_simd",MatSeqBAIJSIMDTypes,(PetscEnum*)&simd,&flg);CHKERRQ(ierr);
+    if (simd > hw) {
+      ierr = PetscInfo2(NULL,"Processor or compiler does not support %s, using %s\n",MatSeqBAIJSIMDTypes[simd],MatSeqBAIJSIMDTypes[hw]);CHKERRQ(ierr);
+      simd = hw;
+    }
+    ierr = PetscInfo1(NULL,"Using %s kernels for SeqBAIJ matrices with block sizes 2 to 8\n",MatSeqBAIJSIMDTypes[simd]);CHKERRQ(ierr);
+    ierr = PetscRegisterFinalize(MatSeqBAIJSIMDFinalize_Private);CHKERRQ(ierr);
+    MatSeqBAIJSIMD    = simd;
+    MatSeqBAIJSIMDSet = PETSC_TRUE;
+  }
+  *type = (bs >= 2 && bs <= 8) ? MatSeqBAIJSIMD : MAT_SEQBAIJ_SIMD_NONE;
+  PetscFunctionReturn(0);
+}
+
+#if defined(MAT_SEQBAIJ_SIMD)
+/* ----------------------------------------------------------------------------------------------------------- */
+/*
+   AVX2: a column of length bs <= 8 is held in s0 (rows 0 to 3) and s1 (rows 4 to 7); m0 and m1 mask the rows < bs
+*/
+MAT_SEQBAIJ_AVX2 PETSC_STATIC_INLINE __m256i MatSeqBAIJMask_AVX2(PetscInt n)
+{
+  return _mm256_cmpgt_epi64(_mm256_set1_epi64x((long long)n),_mm256_set_epi64x(3,2,1,0));
+}
+
+/* s = s + V*w for the block V */
+MAT_SEQBAIJ_AVX2 PETSC_STATIC_INLINE void MatSeqBAIJBlockMultAdd_AVX2(PetscInt bs,const MatScalar *v,const PetscScalar *w,__m256i m0,__m256i m1,__m256d *s0,__m256d *s1)
+{
+  PetscInt c;
+
+  if (bs > 4) {
+    for (c=0; c<bs; c++) {
+      const __m256d wc = _mm256_broadcast_sd(w+c);
+      *s0 = _mm256_fmadd_pd(_mm256_loadu_pd(v+bs*c),wc,*s0);
+      *s1 = _mm256_fmadd_pd(_mm256_maskload_pd(v+bs*c+4,m1),wc,*s1);
+    }
+  } else {
+    for (c=0; c<bs; c++) *s0 = _mm256_fmadd_pd(_mm256_maskload_pd(v+bs*c,m0),_mm256_broadcast_sd(w+c),*s0);
+  }
+}
+
+/* s = s - V*w for the block V */
+MAT_SEQBAIJ_AVX2 PETSC_STATIC_INLINE void MatSeqBAIJBlockMultSub_AVX2(PetscInt bs,const MatScalar *v,const PetscScalar *w,__m256i m0,__m256i m1,__m256d *s0,__m256d *s1)
+{
+  PetscInt c;
+
+  if (bs > 4) {
+    for (c=0; c<bs; c++) {
+      const __m256d wc = _mm256_broadcast_sd(w+c);
+      *s0 = _mm256_fnmadd_pd(_mm256_loadu_pd(v+bs*c),wc,*s0);
+      *s1 = _mm256_fnmadd_pd(_mm256_maskload_pd(v+bs*c+4,m1),wc,*s1);
+    }
+  } else {
+    for (c=0; c<bs; c++) *s0 = _mm256_fnmadd_pd(_mm256_maskload_pd(v+bs*c,m0),_mm256_broadcast_sd(w+c),*s0);
+  }
+}
+
+MAT_SEQBAIJ_AVX2 PETSC_STATIC_INLINE void MatSeqBAIJLoad_AVX2(PetscInt bs,const PetscScalar *p,__m256i m0,__m256i m1,__m256d *s0,__m256d *s1)
+{
+  *s0 = _mm256_maskload_pd(p,m0);
+  *s1 = bs > 4 ? _mm256_maskload_pd(p+4,m1) : _mm256_setzero_pd();
+}
+
+MAT_SEQBAIJ_AVX2 PETSC_STATIC_INLINE void MatSeqBAIJStore_AVX2(PetscInt bs,PetscScalar *p,__m256i m0,__m256i m1,__m256d s0,__m256d s1)
+{
+  _mm256_maskstore_pd(p,m0,s0);
+  if (bs > 4) _mm256_maskstore_pd(p+4,m1,s1);
+}
+
+/* z[row] = y[row] + sum_j A[row,j] x[j] for the m (compressed) block rows with the row indices ridx, y may be NULL */
+MAT_SEQBAIJ_AVX2 static void MatMultKernel_SeqBAIJ_AVX2(PetscInt bs,PetscInt m,const PetscInt *ii,const PetscInt *ridx,const PetscInt *aj,const MatScalar *aa,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  const __m256i m0 = MatSeqBAIJMask_AVX2(bs),m1 = MatSeqBAIJMask_AVX2(bs-4);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       i,j,row;
+  __m256d        s0,s1;
+
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    if (y) MatSeqBAIJLoad_AVX2(bs,y+bs*row,m0,m1,&s0,&s1);
+    else s0 = s1 = _mm256_setzero_pd();
+    for (j=ii[i]; j<ii[i+1]; j++) MatSeqBAIJBlockMultAdd_AVX2(bs,aa+bs2*j,x+bs*aj[j],m0,m1,&s0,&s1);
+    MatSeqBAIJStore_AVX2(bs,z+bs*row,m0,m1,s0,s1);
+  }
+}
+
+/* triangular solves with the factor, r and c are the row and column permutations, or NULL for the identity */
+MAT_SEQBAIJ_AVX2 static void MatSolveKernel_SeqBAIJ_AVX2(PetscInt bs,PetscInt n,const PetscInt *ai,const PetscInt *aj,const PetscInt *adiag,const MatScalar *aa,const PetscInt *r,const PetscInt *c,const PetscScalar *b,PetscScalar *t,PetscScalar *x)
+{
+  const __m256i m0 = MatSeqBAIJMask_AVX2(bs),m1 = MatSeqBAIJMask_AVX2(bs-4);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       i,j;
+  PetscScalar    w[8];
+  __m256d        s0,s1;
+
+  /* forward solve the lower triangular */
+  for (i=0; i<n; i++) {
+    MatSeqBAIJLoad_AVX2(bs,b+bs*(r ? r[i] : i),m0,m1,&s0,&s1);
+    for (j=ai[i]; j<ai[i+1]; j++) MatSeqBAIJBlockMultSub_AVX2(bs,aa+bs2*j,t+bs*aj[j],m0,m1,&s0,&s1);
+    MatSeqBAIJStore_AVX2(bs,t+bs*i,m0,m1,s0,s1);
+  }
+  /* backward solve the upper triangular, the diagonal blocks are inverted */
+  for (i=n-1; i>=0; i--) {
+    MatSeqBAIJLoad_AVX2(bs,t+bs*i,m0,m1,&s0,&s1);
+    for (j=adiag[i+1]+1; j<adiag[i]; j++) MatSeqBAIJBlockMultSub_AVX2(bs,aa+bs2*j,t+bs*aj[j],m0,m1,&s0,&s1);
+    MatSeqBAIJStore_AVX2(bs,w,m0,m1,s0,s1);
+    s0 = s1 = _mm256_setzero_pd();
+    MatSeqBAIJBlockMultAdd_AVX2(bs,aa+bs2*adiag[i],w,m0,m1,&s0,&s1);
+    MatSeqBAIJStore_AVX2(bs,t+bs*i,m0,m1,s0,s1);
+    MatSeqBAIJStore_AVX2(bs,x+bs*(c ? c[i] : i),m0,m1,s0,s1);
+  }
+}
+
+/* pc = pc*dv, then the block rtmp[pj[j]] = rtmp[pj[j]] - pc*pv[j] for j < nz; work holds bs*bs values */
+MAT_SEQBAIJ_AVX2 static void MatLUFactorKernel_SeqBAIJ_AVX2(PetscInt bs,MatScalar *pc,const MatScalar *dv,PetscInt nz,const PetscInt *pj,const MatScalar *pv,MatScalar *rtmp,MatScalar *work)
+{
+  const __m256i m0 = MatSeqBAIJMask_AVX2(bs),m1 = MatSeqBAIJMask_AVX2(bs-4);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       j,k;
+  MatScalar      *C;
+  __m256d        s0,s1;
+
+  for (k=0; k<bs; k++) {
+    s0 = s1 = _mm256_setzero_pd();
+    MatSeqBAIJBlockMultAdd_AVX2(bs,pc,dv+bs*k,m0,m1,&s0,&s1);
+    MatSeqBAIJStore_AVX2(bs,work+bs*k,m0,m1,s0,s1);
+  }
+  for (k=0; k<bs2; k++) pc[k] = work[k];
+  for (j=0; j<nz; j++) {
+    C = rtmp + bs2*pj[j];
+    for (k=0; k<bs; k++) {
+      MatSeqBAIJLoad_AVX2(bs,C+bs*k,m0,m1,&s0,&s1);
+      MatSeqBAIJBlockMultSub_AVX2(bs,pc,pv+bs2*j+bs*k,m0,m1,&s0,&s1);
+      MatSeqBAIJStore_AVX2(bs,C+bs*k,m0,m1,s0,s1);
+    }
+  }
+}
+
+/*
+   Gauss-Jordan inversion with partial pivoting of 4 blocks at a time, one in each lane: entry e of the block of lane l
+   is s[4*e+l]. Each lane chooses its own pivot rows and the interchanges are blends. Returns PETSC_FALSE, leaving s
+   modified, if a pivot of some lane is zero.
+*/
+MAT_SEQBAIJ_AVX2 static PetscBool PetscKernel_A_gets_inverse_A_batch_AVX2(PetscInt bs,MatScalar *s)
+{
+  const __m256d sgn = _mm256_set1_pd(-0.0),zero = _mm256_setzero_pd(),one = _mm256_set1_pd(1.0);
+  __m256d       piv[8],best,idx,v,m,x,y,f;
+  PetscInt      i,j,k,r;
+
+  for (k=0; k<bs; k++) {
+    /* the row of the largest entry of column k in each lane */
+    best = _mm256_andnot_pd(sgn,_mm256_loadu_pd(s+4*(bs*k+k)));
+    idx  = _mm256_set1_pd((double)k);
+    for (r=k+1; r<bs; r++) {
+      v    = _mm256_andnot_pd(sgn,_mm256_loadu_pd(s+4*(bs*r+k)));
+      m    = _mm256_cmp_pd(v,best,_CMP_GT_OQ);
+      best = _mm256_blendv_pd(best,v,m);
+      idx  = _mm256_blendv_pd(idx,_mm256_set1_pd((double)r),m);
+    }
+    if (_mm256_movemask_pd(_mm256_cmp_pd(best,zero,_CMP_EQ_OQ))) return PETSC_FALSE;
+    piv[k] = idx;
+    for (r=k+1; r<bs; r++) {
+      m = _mm256_cmp_pd(idx,_mm256_set1_pd((double)r),_CMP_EQ_OQ);
+      if (!_mm256_movemask_pd(m)) continue;
+      for (j=0; j<bs; j++) {
+        x = _mm256_loadu_pd(s+4*(bs*k+j));
+        y = _mm256_loadu_pd(s+4*(bs*r+j));
+        _mm256_storeu_pd(s+4*(bs*k+j),_mm256_blendv_pd(x,y,m));
+        _mm256_storeu_pd(s+4*(bs*r+j),_mm256_blendv_pd(y,x,m));
+      }
+    }
+    /* scale row k, then eliminate column k from the other rows; column k becomes the column of the inverse */
+    f = _mm256_div_pd(one,_mm256_loadu_pd(s+4*(bs*k+k)));
+    _mm256_storeu_pd(s+4*(bs*k+k),one);
+    for (j=0; j<bs; j++) _mm256_storeu_pd(s+4*(bs*k+j),_mm256_mul_pd(f,_mm256_loadu_pd(s+4*(bs*k+j))));
+    for (i=0; i<bs; i++) {
+      if (i == k) continue;
+      f = _mm256_loadu_pd(s+4*(bs*i+k));
+      _mm256_storeu_pd(s+4*(bs*i+k),zero);
+      for (j=0; j<bs; j++) _mm256_storeu_pd(s+4*(bs*i+j),_mm256_fnmadd_pd(f,_mm256_loadu_pd(s+4*(bs*k+j)),_mm256_loadu_pd(s+4*(bs*i+j))));
+    }
+  }
+  /* undo the row interchanges as column interchanges of the inverse, in reverse order */
+  for (k=bs-1; k>=0; k--) {
+    for (r=k+1; r<bs; r++) {
+      m = _mm256_cmp_pd(piv[k],_mm256_set1_pd((double)r),_CMP_EQ_OQ);
+      if (!_mm256_movemask_pd(m)) continue;
+      for (i=0; i<bs; i++) {
+        x = _mm256_loadu_pd(s+4*(bs*i+k));
+        y = _mm256_loadu_pd(s+4*(bs*i+r));
+        _mm256_storeu_pd(s+4*(bs*i+k),_mm256_blendv_pd(x,y,m));
+        _mm256_storeu_pd(s+4*(bs*i+r),_mm256_blendv_pd(y,x,m));
+      }
+    }
+  }
+  return PETSC_TRUE;
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+/*
+   AVX-512: a column of length bs <= 8 is held in one register, k masks the rows < bs
+*/
+MAT_SEQBAIJ_AVX512 PETSC_STATIC_INLINE void MatSeqBAIJBlockMultAdd_AVX512(PetscInt bs,const MatScalar *v,const PetscScalar *w,__mmask8 k,__m512d *s)
+{
+  PetscInt c;
+
+  for (c=0; c<bs; c++) *s = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(k,v+bs*c),_mm512_set1_pd(w[c]),*s);
+}
+
+MAT_SEQBAIJ_AVX512 PETSC_STATIC_INLINE void MatSeqBAIJBlockMultSub_AVX512(PetscInt bs,const MatScalar *v,const PetscScalar *w,__mmask8 k,__m512d *s)
+{
+  PetscInt c;
+
+  for (c=0; c<bs; c++) *s = _mm512_fnmadd_pd(_mm512_maskz_loadu_pd(k,v+bs*c),_mm512_set1_pd(w[c]),*s);
+}
+
+MAT_SEQBAIJ_AVX512 static void MatMultKernel_SeqBAIJ_AVX512(PetscInt bs,PetscInt m,const PetscInt *ii,const PetscInt *ridx,const PetscInt *aj,const MatScalar *aa,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  const __mmask8 k = (__mmask8)((1 << bs) - 1);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       i,j,row;
+  __m512d        s;
+
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    s   = y ? _mm512_maskz_loadu_pd(k,y+bs*row) : _mm512_setzero_pd();
+    for (j=ii[i]; j<ii[i+1]; j++) MatSeqBAIJBlockMultAdd_AVX512(bs,aa+bs2*j,x+bs*aj[j],k,&s);
+    _mm512_mask_storeu_pd(z+bs*row,k,s);
+  }
+}
+
+MAT_SEQBAIJ_AVX512 static void MatSolveKernel_SeqBAIJ_AVX512(PetscInt bs,PetscInt n,const PetscInt *ai,const PetscInt *aj,const PetscInt *adiag,const MatScalar *aa,const PetscInt *r,const PetscInt *c,const PetscScalar *b,PetscScalar *t,PetscScalar *x)
+{
+  const __mmask8 k = (__mmask8)((1 << bs) - 1);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       i,j;
+  PetscScalar    w[8];
+  __m512d        s;
+
+  for (i=0; i<n; i++) {
+    s = _mm512_maskz_loadu_pd(k,b+bs*(r ? r[i] : i));
+    for (j=ai[i]; j<ai[i+1]; j++) MatSeqBAIJBlockMultSub_AVX512(bs,aa+bs2*j,t+bs*aj[j],k,&s);
+    _mm512_mask_storeu_pd(t+bs*i,k,s);
+  }
+  for (i=n-1; i>=0; i--) {
+    s = _mm512_maskz_loadu_pd(k,t+bs*i);
+    for (j=adiag[i+1]+1; j<adiag[i]; j++) MatSeqBAIJBlockMultSub_AVX512(bs,aa+bs2*j,t+bs*aj[j],k,&s);
+    _mm512_mask_storeu_pd(w,k,s);
+    s = _mm512_setzero_pd();
+    MatSeqBAIJBlockMultAdd_AVX512(bs,aa+bs2*adiag[i],w,k,&s);
+    _mm512_mask_storeu_pd(t+bs*i,k,s);
+    _mm512_mask_storeu_pd(x+bs*(c ? c[i] : i),k,s);
+  }
+}
+
+MAT_SEQBAIJ_AVX512 static void MatLUFactorKernel_SeqBAIJ_AVX512(PetscInt bs,MatScalar *pc,const MatScalar *dv,PetscInt nz,const PetscInt *pj,const MatScalar *pv,MatScalar *rtmp,MatScalar *work)
+{
+  const __mmask8 m = (__mmask8)((1 << bs) - 1);
+  const PetscInt bs2 = bs*bs;
+  PetscInt       j,k;
+  MatScalar      *C;
+  __m512d        s;
+
+  for (k=0; k<bs; k++) {
+    s = _mm512_setzero_pd();
+    MatSeqBAIJBlockMultAdd_AVX512(bs,pc,dv+bs*k,m,&s);
+    _mm512_mask_storeu_pd(work+bs*k,m,s);
+  }
+  for (k=0; k<bs2; k++) pc[k] = work[k];
+  for (j=0; j<nz; j++) {
+    C = rtmp + bs2*pj[j];
+    for (k=0; k<bs; k++) {
+      s = _mm512_maskz_loadu_pd(m,C+bs*k);
+      MatSeqBAIJBlockMultSub_AVX512(bs,pc,pv+bs2*j+bs*k,m,&s);
+      _mm512_mask_storeu_pd(C+bs*k,m,s);
+    }
+  }
+}
+
+/* PetscKernel_A_gets_inverse_A_batch_AVX2() for 8 blocks at a time, entry e of the block of lane l is s[8*e+l] */
+MAT_SEQBAIJ_AVX512 static PetscBool PetscKernel_A_gets_inverse_A_batch_AVX512(PetscInt bs,MatScalar *s)
+{
+  const __m512d zero = _mm512_setzero_pd(),one = _mm512_set1_pd(1.0);
+  __m512d       piv[8],best,idx,v,x,y,f;
+  __mmask8      m;
+  PetscInt      i,j,k,r;
+
+  for (k=0; k<bs; k++) {
+    best = _mm512_abs_pd(_mm512_loadu_pd(s+8*(bs*k+k)));
+    idx  = _mm512_set1_pd((double)k);
+    for (r=k+1; r<bs; r++) {
+      v    = _mm512_abs_pd(_mm512_loadu_pd(s+8*(bs*r+k)));
+      m    = _mm512_cmp_pd_mask(v,best,_CMP_GT_OQ);
+      best = _mm512_mask_blend_pd(m,best,v);
+      idx  = _mm512_mask_blend_pd(m,idx,_mm512_set1_pd((double)r));
+    }
+    if (_mm512_cmp_pd_mask(best,zero,_CMP_EQ_OQ)) return PETSC_FALSE;
+    piv[k] = idx;
+    for (r=k+1; r<bs; r++) {
+      m = _mm512_cmp_pd_mask(idx,_mm512_set1_pd((double)r),_CMP_EQ_OQ);
+      if (!m) continue;
+      for (j=0; j<bs; j++) {
+        x = _mm512_loadu_pd(s+8*(bs*k+j));
+        y = _mm512_loadu_pd(s+8*(bs*r+j));
+        _mm512_storeu_pd(s+8*(bs*k+j),_mm512_mask_blend_pd(m,x,y));
+        _mm512_storeu_pd(s+8*(bs*r+j),_mm512_mask_blend_pd(m,y,x));
+      }
+    }
+    f = _mm512_div_pd(one,_mm512_loadu_pd(s+8*(bs*k+k)));
+    _mm512_storeu_pd(s+8*(bs*k+k),one);
+    for (j=0; j<bs; j++) _mm512_storeu_pd(s+8*(bs*k+j),_mm512_mul_pd(f,_mm512_loadu_pd(s+8*(bs*k+j))));
+    for (i=0; i<bs; i++) {
+      if (i == k) continue;
+      f = _mm512_loadu_pd(s+8*(bs*i+k));
+      _mm512_storeu_pd(s+8*(bs*i+k),zero);
+      for (j=0; j<bs; j++) _mm512_storeu_pd(s+8*(bs*i+j),_mm512_fnmadd_pd(f,_mm512_loadu_pd(s+8*(bs*k+j)),_mm512_loadu_pd(s+8*(bs*i+j))));
+    }
+  }
+  for (k=bs-1; k>=0; k--) {
+    for (r=k+1; r<bs; r++) {
+      m = _mm512_cmp_pd_mask(piv[k],_mm512_set1_pd((double)r),_CMP_EQ_OQ);
+      if (!m) continue;
+      for (i=0; i<bs; i++) {
+        x = _mm512_loadu_pd(s+8*(bs*i+k));
+        y = _mm512_loadu_pd(s+8*(bs*i+r));
+        _mm512_storeu_pd(s+8*(bs*i+k),_mm512_mask_blend_pd(m,x,y));
+        _mm512_storeu_pd(s+8*(bs*i+r),_mm512_mask_blend_pd(m,y,x));
+      }
+    }
+  }
+  return PETSC_TRUE;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------------------- */
+#undef __FUNCT__
+#define __FUNCT__ "MatMultKernel_SeqBAIJ_SIMD_Private"
+static PetscErrorCode MatMultKernel_SeqBAIJ_SIMD_Private(Mat A,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  Mat_SeqBAIJ        *a = (Mat_SeqBAIJ*)A->data;
+  PetscInt           bs = A->rmap->bs,m = a->mbs;
+  const PetscInt     *ii = a->i,*ridx = NULL;
+  MatSeqBAIJSIMDType simd;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqBAIJGetSIMDType(bs,&simd);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  switch (simd) {
+#if defined(MAT_SEQBAIJ_SIMD)
+  case MAT_SEQBAIJ_SIMD_AVX2:
+    MatMultKernel_SeqBAIJ_AVX2(bs,m,ii,ridx,a->j,a->a,x,y,z);
+    break;
+  case MAT_SEQBAIJ_SIMD_AVX512:
+    MatMultKernel_SeqBAIJ_AVX512(bs,m,ii,ridx,a->j,a->a,x,y,z);
+    break;
+#endif
+  default: SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SUP,"No vector kernels for block size %D",bs);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_SeqBAIJ_SIMD"
+PetscErrorCode MatMult_SeqBAIJ_SIMD(Mat A,Vec xx,Vec zz)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  if (a->compressedrow.use) {ierr = PetscMemzero(z,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);}
+  ierr = MatMultKernel_SeqBAIJ_SIMD_Private(A,x,NULL,z);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz*a->bs2 - A->rmap->bs*a->nonzerorowcnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqBAIJ_SIMD"
+PetscErrorCode MatMultAdd_SeqBAIJ_SIMD(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    /* only the nonzero rows are computed */
+    if (z != y) {ierr = PetscMemcpy(z,y,A->rmap->n*sizeof(PetscScalar));CHKERRQ(ierr);}
+    y = z;
+  }
+  ierr = MatMultKernel_SeqBAIJ_SIMD_Private(A,x,y,z);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz*a->bs2);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqBAIJ_SIMD"
+PetscErrorCode MatSolve_SeqBAIJ_SIMD(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqBAIJ        *a = (Mat_SeqBAIJ*)A->data;
+  PetscInt           bs = A->rmap->bs;
+  const PetscInt     *r,*c;
+  const PetscScalar  *b;
+  PetscScalar        *x;
+  MatSeqBAIJSIMDType simd;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqBAIJGetSIMDType(bs,&simd);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  switch (simd) {
+#if defined(MAT_SEQBAIJ_SIMD)
+  case MAT_SEQBAIJ_SIMD_AVX2:
+    MatSolveKernel_SeqBAIJ_AVX2(bs,a->mbs,a->i,a->j,a->diag,a->a,r,c,b,a->solve_work,x);
+    break;
+  case MAT_SEQBAIJ_SIMD_AVX512:
+    MatSolveKernel_SeqBAIJ_AVX512(bs,a->mbs,a->i,a->j,a->diag,a->a,r,c,b,a->solve_work,x);
+    break;
+#endif
+  default: SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SUP,"No vector kernels for block size %D",bs);
+  }
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*(a->bs2)*(a->nz) - A->rmap->bs*A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLUFactorNumeric_SeqBAIJ_SIMD"
+/*
+   MatLUFactorNumeric_SeqBAIJ_N() with the vector kernels for the block products; like the factorizations for the
+   block sizes 2 to 7 the diagonal blocks are shifted with MAT_SHIFT_INBLOCKS
+*/
+PetscErrorCode MatLUFactorNumeric_SeqBAIJ_SIMD(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat                C     = B;
+  Mat_SeqBAIJ        *a    = (Mat_SeqBAIJ*)A->data,*b = (Mat_SeqBAIJ*)C->data;
+  IS                 isrow = b->row,isicol = b->icol;
+  PetscErrorCode     ierr;
+  const PetscInt     *r,*ic;
+  PetscInt           i,j,k,n = a->mbs,*ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j;
+  PetscInt           *ajtmp,*bjtmp,nz,nzL,row,*bdiag = b->diag,*pj;
+  MatScalar          *rtmp,*pc,*mwork,*v,*pv,*aa = a->a;
+  PetscInt           bs = A->rmap->bs,bs2 = a->bs2,*v_pivots,flg;
+  MatScalar          *v_work;
+  PetscReal          shift = info->shifttype == (PetscReal)MAT_SHIFT_NONE ? 0.0 : info->shiftamount;
+  PetscBool          allowzeropivot,zeropivotdetected = PETSC_FALSE;
+  MatSeqBAIJSIMDType simd;
+
+  PetscFunctionBegin;
+  ierr = MatSeqBAIJGetSIMDType(bs,&simd);CHKERRQ(ierr);
+  if (simd == MAT_SEQBAIJ_SIMD_NONE) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SUP,"No vector kernels for block size %D",bs);
+  ierr = ISGetIndices(isrow,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(isicol,&ic);CHKERRQ(ierr);
+  allowzeropivot = PetscNot(A->erroriffailure);
+
+  ierr = PetscCalloc1(bs2*n,&rtmp);CHKERRQ(ierr);
+  ierr = PetscMalloc3(bs,&v_work,bs2,&mwork,bs,&v_pivots);CHKERRQ(ierr);
+
+  for (i=0; i<n; i++) {
+    /* zero rtmp */
+    /* L part */
+    nz    = bi[i+1] - bi[i];
+    bjtmp = bj + bi[i];
+    for  (j=0; j<nz; j++) {
+      ierr = PetscMemzero(rtmp+bs2*bjtmp[j],bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* U part */
+    nz    = bdiag[i] - bdiag[i+1];
+    bjtmp = bj + bdiag[i+1]+1;
+    for  (j=0; j<nz; j++) {
+      ierr = PetscMemzero(rtmp+bs2*bjtmp[j],bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* load in initial (unfactored row) */
+    nz    = ai[r[i]+1] - ai[r[i]];
+    ajtmp = aj + ai[r[i]];
+    v     = aa + bs2*ai[r[i]];
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(rtmp+bs2*ic[ajtmp[j]],v+bs2*j,bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* elimination */
+    bjtmp = bj + bi[i];
+    nzL   = bi[i+1] - bi[i];
+    for (k=0; k < nzL; k++) {
+      row = bjtmp[k];
+      pc  = rtmp + bs2*row;
+      for (flg=0,j=0; j<bs2; j++) {
+        if (pc[j] != 0.0) {
+          flg = 1;
+          break;
+        }
+      }
+      if (flg) {
+        pj = b->j + bdiag[row+1]+1;  /* begining of U(row,:) */
+        pv = b->a + bs2*(bdiag[row+1]+1);
+        nz = bdiag[row] - bdiag[row+1] - 1; /* num of entries inU(row,:), excluding diag */
+        switch (simd) {
+#if defined(MAT_SEQBAIJ_SIMD)
+        case MAT_SEQBAIJ_SIMD_AVX2:
+          MatLUFactorKernel_SeqBAIJ_AVX2(bs,pc,b->a+bs2*bdiag[row],nz,pj,pv,rtmp,mwork);
+          break;
+        case MAT_SEQBAIJ_SIMD_AVX512:
+          MatLUFactorKernel_SeqBAIJ_AVX512(bs,pc,b->a+bs2*bdiag[row],nz,pj,pv,rtmp,mwork);
+          break;
+#endif
+        default: break;
+        }
+        ierr = PetscLogFlops(2*bs2*bs*(nz+1)-bs2);CHKERRQ(ierr);
+      }
+    }
+
+    /* finished row so stick it into b->a */
+    /* L part */
+    pv = b->a + bs2*bi[i];
+    pj = b->j + bi[i];
+    nz = bi[i+1] - bi[i];
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(pv+bs2*j,rtmp+bs2*pj[j],bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* Mark diagonal and invert diagonal for simplier triangular solves */
+    pv   = b->a + bs2*bdiag[i];
+    pj   = b->j + bdiag[i];
+    ierr = PetscMemcpy(pv,rtmp+bs2*pj[0],bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    switch (bs) {
+    case 2:
+      ierr = PetscKernel_A_gets_inverse_A_2(pv,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    case 3:
+      ierr = PetscKernel_A_gets_inverse_A_3(pv,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    case 4:
+      ierr = PetscKernel_A_gets_inverse_A_4(pv,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    case 5:
+      ierr = PetscKernel_A_gets_inverse_A_5(pv,v_pivots,v_work,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    case 6:
+      ierr = PetscKernel_A_gets_inverse_A_6(pv,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    case 7:
+      ierr = PetscKernel_A_gets_inverse_A_7(pv,shift,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    default:
+      ierr = PetscKernel_A_gets_inverse_A(bs,pv,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+      break;
+    }
+    if (zeropivotdetected) B->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
+
+    /* U part */
+    pv = b->a + bs2*(bdiag[i+1]+1);
+    pj = b->j + bdiag[i+1]+1;
+    nz = bdiag[i] - bdiag[i+1] - 1;
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(pv+bs2*j,rtmp+bs2*pj[j],bs2*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+  }
+
+  ierr = PetscFree(rtmp);CHKERRQ(ierr);
+  ierr = PetscFree3(v_work,mwork,v_pivots);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(isicol,&ic);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(isrow,&r);CHKERRQ(ierr);
+
+  C->ops->solve          = MatSolve_SeqBAIJ_SIMD;
+  C->ops->solvetranspose = MatSolveTranspose_SeqBAIJ_N;
+  C->assembled           = PETSC_TRUE;
+
+  ierr = PetscLogFlops(1.333333333333*bs*bs2*b->mbs);CHKERRQ(ierr); /* from inverting diagonal blocks */
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscKernel_A_gets_inverse_A_batch_Private"
+/* inverts the n blocks one at a time with the unrolled kernels, which report or error on a zero pivot */
+static PetscErrorCode PetscKernel_A_gets_inverse_A_batch_Private(PetscInt bs,PetscInt n,MatScalar *a,PetscReal shift,PetscBool allowzeropivot,PetscBool *zeropivotdetected)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,bs2 = bs*bs,ipvt[5],*v_pivots = NULL;
+  MatScalar      work[25],*v_work = NULL;
+  PetscBool      zp = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  if (bs > 7) {ierr = PetscMalloc2(bs,&v_work,bs,&v_pivots);CHKERRQ(ierr);}
+  for (i=0; i<n; i++,a+=bs2) {
+    switch (bs) {
+    case 1:
+      if (PetscAbsScalar(a[0] + shift) < PETSC_MACHINE_EPSILON) {
+        if (allowzeropivot) {
+          zp   = PETSC_TRUE;
+          ierr = PetscInfo1(NULL,"Zero pivot, row %D\n",i);CHKERRQ(ierr);
+        } else SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MAT_LU_ZRPVT,"Zero pivot, row %D",i);
+      }
+      a[0] = (PetscScalar)1.0 / (a[0] + shift);
+      break;
+    case 2:
+      ierr = PetscKernel_A_gets_inverse_A_2(a,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    case 3:
+      ierr = PetscKernel_A_gets_inverse_A_3(a,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    case 4:
+      ierr = PetscKernel_A_gets_inverse_A_4(a,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    case 5:
+      ierr = PetscKernel_A_gets_inverse_A_5(a,ipvt,work,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    case 6:
+      ierr = PetscKernel_A_gets_inverse_A_6(a,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    case 7:
+      ierr = PetscKernel_A_gets_inverse_A_7(a,shift,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    default:
+      ierr = PetscKernel_A_gets_inverse_A(bs,a,v_pivots,v_work,allowzeropivot,&zp);CHKERRQ(ierr);
+      break;
+    }
+    if (zp && zeropivotdetected) *zeropivotdetected = PETSC_TRUE;
+  }
+  ierr = PetscFree2(v_work,v_pivots);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscKernel_A_gets_inverse_A_batch"
+/*
+   PetscKernel_A_gets_inverse_A_batch - Inverts in place the n blocks of size bs that are stored one after the other in a
+
+   Notes: With the vector kernels of MatSeqBAIJGetSIMDType() the blocks are interleaved and inverted 4 (AVX2) or 8
+   (AVX-512) at a time, one block in each lane. A group of blocks with a zero pivot, and the blocks left over, are
+   inverted one at a time with the unrolled kernels, which handle the zero pivot as they always do. The blocks may be
+   stored by rows or by columns, the inverse is stored the same way.
+*/
+PetscErrorCode PetscKernel_A_gets_inverse_A_batch(PetscInt bs,PetscInt n,MatScalar *a,PetscReal shift,PetscBool allowzeropivot,PetscBool *zeropivotdetected)
+{
+  PetscErrorCode     ierr;
+  PetscInt           i = 0;
+  MatSeqBAIJSIMDType simd;
+#if defined(MAT_SEQBAIJ_SIMD)
+  PetscInt           bs2 = bs*bs,l,e,w;
+  MatScalar          s[8*64];
+  PetscBool          ok;
+#endif
+
+  PetscFunctionBegin;
+  if (zeropivotdetected) *zeropivotdetected = PETSC_FALSE;
+  ierr = MatSeqBAIJGetSIMDType(bs,&simd);CHKERRQ(ierr);
+#if defined(MAT_SEQBAIJ_SIMD)
+  if (simd != MAT_SEQBAIJ_SIMD_NONE) {
+    w = simd == MAT_SEQBAIJ_SIMD_AVX512 ? 8 : 4;
+    for (; i+w<=n; i+=w) {
+      for (l=0; l<w; l++) {
+        for (e=0; e<bs2; e++) s[w*e+l] = a[bs2*(i+l)+e];
+      }
+      if (simd == MAT_SEQBAIJ_SIMD_AVX512) ok = PetscKernel_A_gets_inverse_A_batch_AVX512(bs,s);
+      else ok = PetscKernel_A_gets_inverse_A_batch_AVX2(bs,s);
+      if (ok) {
+        for (l=0; l<w; l++) {
+          for (e=0; e<bs2; e++) a[bs2*(i+l)+e] = s[w*e+l];
+        }
+      } else {
+        ierr = PetscKernel_A_gets_inverse_A_batch_Private(bs,w,a+bs2*i,shift,allowzeropivot,zeropivotdetected);CHKERRQ(ierr);
+      }
+    }
+  }
+#endif
+  ierr = PetscKernel_A_gets_inverse_A_batch_Private(bs,n-i,a+bs*bs*i,shift,allowzeropivot,zeropivotdetected);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
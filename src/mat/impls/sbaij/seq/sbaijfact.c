@@ -1449,6 +1449,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqSBAIJ_1_NaturalOrdering(Mat B,Mat A,c
 
   B->assembled    = PETSC_TRUE;
   B->preallocated = PETSC_TRUE;
+  ierr = MatSeqSBAIJFactorSetUpLevels(B);CHKERRQ(ierr);
 
   ierr = PetscLogFlops(B->rmap->n);CHKERRQ(ierr);
 
@@ -0,0 +1,155 @@
+
+/*
+    Level-scheduled OpenMP threaded MatSolve() for the block size one Cholesky and ICC factors stored in
+  the SeqSBAIJ format, including those of SeqAIJ matrices. The factor holds U by rows, so the forward
+  substitution with U^T is done from a column oriented copy of the structure of U that is built together
+  with the level sets and, like them, is kept until the nonzero pattern of the factor changes.
+  Each entry of the solution is computed exactly as in MatSolve_SeqSBAIJ_1().
+*/
+#include <../src/mat/impls/sbaij/seq/sbaij.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqSBAIJFactorComputeLevels_Private"
+static PetscErrorCode MatSeqSBAIJFactorComputeLevels_Private(Mat A)
+{
+  Mat_SeqSBAIJ    *a  = (Mat_SeqSBAIJ*)A->data;
+  Mat_SolveLevels *lv = &a->levels;
+  PetscInt        n   = a->mbs,i,k,p,d,*depth,*ti,*tj,*tk;
+  const PetscInt  *ai = a->i,*aj = a->j;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  /* column oriented structure of the strictly upper triangular part, rows in increasing order in each column */
+  ierr = PetscFree3(lv->ti,lv->tj,lv->tk);CHKERRQ(ierr);
+  ierr = PetscMalloc3(n+1,&lv->ti,ai[n]-n,&lv->tj,ai[n]-n,&lv->tk);CHKERRQ(ierr);
+  ti   = lv->ti; tj = lv->tj; tk = lv->tk;
+  ierr = PetscMemzero(ti,(n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (k=0; k<n; k++) {
+    for (p=ai[k]; p<ai[k+1]-1; p++) ti[aj[p]+1]++; /* the diagonal is the last entry of each row */
+  }
+  for (i=0; i<n; i++) ti[i+1] += ti[i];
+  for (k=0; k<n; k++) {
+    for (p=ai[k]; p<ai[k+1]-1; p++) {
+      tj[ti[aj[p]]]   = k;
+      tk[ti[aj[p]]++] = p;
+    }
+  }
+  for (i=n; i>0; i--) ti[i] = ti[i-1];
+  ti[0] = 0;
+
+  ierr = PetscMalloc1(n,&depth);CHKERRQ(ierr);
+  /* U^T: entry i depends on the rows k < i with U(k,i) nonzero */
+  for (i=0; i<n; i++) {
+    d = 0;
+    for (p=ti[i]; p<ti[i+1]; p++) d = PetscMax(d,depth[tj[p]]+1);
+    depth[i] = d;
+  }
+  ierr = MatSolveLevelsSetUp(A,lv,0,n,depth);CHKERRQ(ierr);
+  /* U: entry i depends on the columns j > i of row i */
+  for (i=n-1; i>=0; i--) {
+    d = 0;
+    for (p=ai[i]; p<ai[i+1]-1; p++) d = PetscMax(d,depth[aj[p]]+1);
+    depth[i] = d;
+  }
+  ierr = MatSolveLevelsSetUp(A,lv,1,n,depth);CHKERRQ(ierr);
+  ierr = PetscFree(depth);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(2*(ai[n]-n)+3*n+lv->nlevels[0]+lv->nlevels[1]+3)*sizeof(PetscInt));CHKERRQ(ierr);
+  lv->nonzerostate = A->nonzerostate;
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_OPENMP)
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqSBAIJ_1_Levels"
+static PetscErrorCode MatSolve_SeqSBAIJ_1_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqSBAIJ      *a  = (Mat_SeqSBAIJ*)A->data;
+  Mat_SolveLevels   *lv = &a->levels;
+  PetscInt          n   = a->mbs,nt = lv->nthreads;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*rp;
+  const MatScalar   *aa = a->a;
+  PetscScalar       *x,*t = a->solve_work;
+  const PetscScalar *b;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  if (!lv->rows[0] || lv->nonzerostate != A->nonzerostate) {
+    ierr = MatSeqSBAIJFactorComputeLevels_Private(A);CHKERRQ(ierr);
+  }
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&rp);CHKERRQ(ierr);
+
+#pragma omp parallel num_threads(nt)
+  {
+    const PetscInt  *vj;
+    const MatScalar *v;
+    PetscScalar     xi;
+    PetscInt        l,k,i,j,p,nz;
+
+    /* solve U^T*D*y = perm(b) by forward substitution, one level at a time; the scaling by D^{-1} comes
+       last since the entries are propagated unscaled */
+    for (l=0; l<lv->nlevels[0]; l++) {
+#pragma omp for schedule(static)
+      for (k=lv->level[0][l]; k<lv->level[0][l+1]; k++) {
+        i  = lv->rows[0][k];
+        xi = b[rp[i]];
+        for (p=lv->ti[i]; p<lv->ti[i+1]; p++) xi += aa[lv->tk[p]]*t[lv->tj[p]];
+        t[i] = xi;
+      }
+    }
+#pragma omp for schedule(static)
+    for (i=0; i<n; i++) t[i] *= aa[adiag[i]]; /* aa[adiag[i]] = 1/D(i) */
+
+    /* solve U*perm(x) = y by back substitution */
+    for (l=0; l<lv->nlevels[1]; l++) {
+#pragma omp for schedule(static)
+      for (k=lv->level[1][l]; k<lv->level[1][l+1]; k++) {
+        i  = lv->rows[1][k];
+        v  = aa + adiag[i] - 1;
+        vj = aj + adiag[i] - 1;
+        nz = ai[i+1] - ai[i] - 1;
+        xi = t[i];
+        for (j=0; j<nz; j++) xi += v[-j]*t[vj[-j]];
+        x[rp[i]] = t[i] = xi;
+      }
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&rp);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(4.0*a->nz - 3.0*n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqSBAIJFactorSetUpLevels"
+/*
+   MatSeqSBAIJFactorSetUpLevels - Called at the end of the numeric Cholesky and ICC factorizations that produce a
+   block size one factor in the (non-inplace) format used by MatSolve_SeqSBAIJ_1(); with -mat_solve_levels it
+   computes the level sets, if the nonzero pattern of the factor changed, and switches MatSolve() and
+   MatSolveTranspose() to the threaded version.
+*/
+PetscErrorCode MatSeqSBAIJFactorSetUpLevels(Mat A)
+{
+  Mat_SeqSBAIJ   *a = (Mat_SeqSBAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSolveLevelsSetFromOptions(A,&a->levels);CHKERRQ(ierr);
+  if (!a->levels.use) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_OPENMP)
+  if (!a->levels.rows[0] || a->levels.nonzerostate != A->nonzerostate) {
+    ierr = MatSeqSBAIJFactorComputeLevels_Private(A);CHKERRQ(ierr);
+  }
+  A->ops->solve          = MatSolve_SeqSBAIJ_1_Levels;
+  A->ops->solvetranspose = MatSolve_SeqSBAIJ_1_Levels;
+#endif
+  PetscFunctionReturn(0);
+}
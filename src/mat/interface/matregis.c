@@ -27,6 +27,9 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJPERM(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJCRL(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJCRL(Mat);
 
+PETSC_EXTERN PetscErrorCode MatCreate_SeqSELL(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_MPISELL(Mat);
+
 PETSC_EXTERN PetscErrorCode MatCreate_Scatter(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_BlockMat(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_Nest(Mat);
@@ -103,6 +106,10 @@ PetscErrorCode  MatRegisterAll(void)
   ierr = MatRegister(MATSEQAIJCRL,      MatCreate_SeqAIJCRL);CHKERRQ(ierr);
   ierr = MatRegister(MATMPIAIJCRL,      MatCreate_MPIAIJCRL);CHKERRQ(ierr);
 
+  ierr = MatRegisterBaseName(MATSELL,MATSEQSELL,MATMPISELL);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQSELL,        MatCreate_SeqSELL);CHKERRQ(ierr);
+  ierr = MatRegister(MATMPISELL,        MatCreate_MPISELL);CHKERRQ(ierr);
+
   ierr = MatRegisterBaseName(MATBAIJ,MATSEQBAIJ,MATMPIBAIJ);CHKERRQ(ierr);
   ierr = MatRegister(MATMPIBAIJ,        MatCreate_MPIBAIJ);CHKERRQ(ierr);
   ierr = MatRegister(MATSEQBAIJ,        MatCreate_SeqBAIJ);CHKERRQ(ierr);
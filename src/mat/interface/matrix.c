@@ -6,6 +6,8 @@
 #include <petsc/private/matimpl.h>        /*I "petscmat.h" I*/
 #include <petsc/private/isimpl.h>
 #include <petsc/private/vecimpl.h>
+#include <petsc/private/kernels/blockinvert.h>
+#include <petsc/private/kernels/blocktranspose.h>
 
 /* Logging support */
 PetscClassId MAT_CLASSID;
@@ -35,6 +37,7 @@ PetscLogEvent MAT_GetMultiProcBlock;
 PetscLogEvent MAT_CUSPCopyToGPU, MAT_CUSPARSECopyToGPU, MAT_SetValuesBatch, MAT_SetValuesBatchI, MAT_SetValuesBatchII, MAT_SetValuesBatchIII, MAT_SetValuesBatchIV;
 PetscLogEvent MAT_ViennaCLCopyToGPU;
 PetscLogEvent MAT_Merge,MAT_Residual,MAT_SetRandom;
+PetscLogEvent MAT_MultOMPImbalance;
 PetscLogEvent MATCOLORING_Apply,MATCOLORING_Comm,MATCOLORING_Local,MATCOLORING_ISCreate,MATCOLORING_SetUp,MATCOLORING_Weights;
 
 const char *const MatFactorTypes[] = {"NONE","LU","CHOLESKY","ILU","ICC","ILUDT","MatFactorType","MAT_FACTOR_",0};
@@ -1121,6 +1124,7 @@ PetscErrorCode MatDestroy(Mat *A)
   }
 
   ierr = PetscFree((*A)->solvertype);CHKERRQ(ierr);
+  ierr = PetscFree((*A)->bsizes);CHKERRQ(ierr);
   ierr = MatDestroy_Redundant(&(*A)->redundant);CHKERRQ(ierr);
   ierr = MatNullSpaceDestroy(&(*A)->nullsp);CHKERRQ(ierr);
   ierr = MatNullSpaceDestroy(&(*A)->transnullsp);CHKERRQ(ierr);
@@ -1219,6 +1223,7 @@ PetscErrorCode MatSetValues(Mat mat,PetscInt m,const PetscInt idxm[],PetscInt n,
   }
   ierr = PetscLogEventBegin(MAT_SetValues,mat,0,0,0);CHKERRQ(ierr);
   ierr = (*mat->ops->setvalues)(mat,m,idxm,n,idxn,v,addv);CHKERRQ(ierr);
+  if (mat->stash.streampoll || mat->bstash.streampoll) {ierr = MatStashStreamPoll_Private(mat);CHKERRQ(ierr);}
   ierr = PetscLogEventEnd(MAT_SetValues,mat,0,0,0);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_CUSP)
   if (mat->valid_GPU_matrix != PETSC_CUSP_UNALLOCATED) {
@@ -1754,6 +1759,7 @@ PetscErrorCode MatSetValuesBlocked(Mat mat,PetscInt m,const PetscInt idxm[],Pets
   ierr = PetscLogEventBegin(MAT_SetValues,mat,0,0,0);CHKERRQ(ierr);
   if (mat->ops->setvaluesblocked) {
     ierr = (*mat->ops->setvaluesblocked)(mat,m,idxm,n,idxn,v,addv);CHKERRQ(ierr);
+    if (mat->stash.streampoll || mat->bstash.streampoll) {ierr = MatStashStreamPoll_Private(mat);CHKERRQ(ierr);}
   } else {
     PetscInt buf[8192],*bufr=0,*bufc=0,*iidxm,*iidxn;
     PetscInt i,j,bs,cbs;
@@ -2990,6 +2996,7 @@ PetscErrorCode MatLUFactorSymbolic(Mat fact,Mat mat,IS row,IS col,const MatFacto
   ierr = (fact->ops->lufactorsymbolic)(fact,mat,row,col,info);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(MAT_LUFactorSymbolic,mat,row,col,0);CHKERRQ(ierr);
   ierr = PetscObjectStateIncrease((PetscObject)fact);CHKERRQ(ierr);
+  fact->nonzerostate++; /* the factor has a new nonzero pattern */
   PetscFunctionReturn(0);
 }
 
@@ -3160,6 +3167,7 @@ PetscErrorCode MatCholeskyFactorSymbolic(Mat fact,Mat mat,IS perm,const MatFacto
   ierr = (fact->ops->choleskyfactorsymbolic)(fact,mat,perm,info);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(MAT_CholeskyFactorSymbolic,mat,perm,0,0);CHKERRQ(ierr);
   ierr = PetscObjectStateIncrease((PetscObject)fact);CHKERRQ(ierr);
+  fact->nonzerostate++; /* the factor has a new nonzero pattern */
   PetscFunctionReturn(0);
 }
 
@@ -3751,12 +3759,20 @@ PetscErrorCode MatSolveTransposeAdd(Mat mat,Vec b,Vec y,Vec x)
          upper/lower triangular part of matrix to
          vector (with omega)
 .     SOR_ZERO_INITIAL_GUESS - zero initial guess
+.     SOR_MULTICOLOR - sweep the (local) rows one color at a time, see below
 
    Notes:
    SOR_LOCAL_FORWARD_SWEEP, SOR_LOCAL_BACKWARD_SWEEP, and
    SOR_LOCAL_SYMMETRIC_SWEEP perform separate independent smoothings
    on each processor.
 
+   With SOR_MULTICOLOR the SeqAIJ and SeqBAIJ matrices (and the diagonal blocks of the MPIAIJ and MPIBAIJ matrices)
+   compute a distance one coloring of the (block) rows, which is kept until the nonzero pattern changes, and sweep
+   the colors in order (forward) or in reverse order (backward); the rows of a color do not couple with each other so
+   they are updated in parallel by the OpenMP threads. This is a Gauss-Seidel method for the matrix with its rows
+   ordered by color, so it converges differently than the sweep in the natural ordering. Other matrix types, and
+   SOR_EISENSTAT, SOR_APPLY_UPPER and SOR_APPLY_LOWER, ignore the flag.
+
    Application programmers will not generally use MatSOR() directly,
    but instead will employ the KSP/PC interface.
 
@@ -5109,6 +5125,11 @@ static PetscInt MatAssemblyEnd_InUse = 0;
 +  mat - the matrix
 -  type - type of assembly, either MAT_FLUSH_ASSEMBLY or MAT_FINAL_ASSEMBLY
 
+   Options Database Keys:
++  -matstash_bts - sends the cached values with the two-sided communication of PetscCommBuildTwoSided()
+.  -matstash_stream - sends the cached values to their owners while MatSetValues() is still being called, instead of all in MatAssemblyBegin()
+-  -matstash_stream_size <n> - number of cached values after which they are sent, this bounds the memory of the cache while the other processes set values or assemble
+
    Notes:
    MatSetValues() generally caches the values.  The matrix is ready to
    use only after MatAssemblyBegin() and MatAssemblyEnd() have been called.
@@ -6625,6 +6646,7 @@ PetscErrorCode MatILUFactorSymbolic(Mat fact,Mat mat,IS row,IS col,const MatFact
   ierr = PetscLogEventBegin(MAT_ILUFactorSymbolic,mat,row,col,0);CHKERRQ(ierr);
   ierr = (fact->ops->ilufactorsymbolic)(fact,mat,row,col,info);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(MAT_ILUFactorSymbolic,mat,row,col,0);CHKERRQ(ierr);
+  fact->nonzerostate++; /* the factor has a new nonzero pattern */
   PetscFunctionReturn(0);
 }
 
@@ -6688,6 +6710,7 @@ PetscErrorCode MatICCFactorSymbolic(Mat fact,Mat mat,IS perm,const MatFactorInfo
   ierr = PetscLogEventBegin(MAT_ICCFactorSymbolic,mat,perm,0,0);CHKERRQ(ierr);
   ierr = (fact->ops->iccfactorsymbolic)(fact,mat,perm,info);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(MAT_ICCFactorSymbolic,mat,perm,0,0);CHKERRQ(ierr);
+  fact->nonzerostate++; /* the factor has a new nonzero pattern */
   PetscFunctionReturn(0);
 }
 
@@ -7189,6 +7212,79 @@ PetscErrorCode MatSetBlockSizes(Mat mat,PetscInt rbs,PetscInt cbs)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatSetVariableBlockSizes"
+/*@
+   MatSetVariableBlockSizes - Sets the sizes of the diagonal blocks of the local rows, for matrices whose point blocks
+   are not all the same size, for example meshes with regions with different numbers of fields
+
+   Logically Collective on Mat
+
+   Input Parameters:
++  mat - the matrix
+.  nblocks - the number of blocks on this process
+-  bsizes - the block sizes, they must add up to the number of local rows
+
+   Notes:
+    The sizes are copied. They are used by PCVPBJACOBI and MatInvertVariableBlockDiagonal(); the storage of the matrix
+    is not changed.
+
+   Level: intermediate
+
+   Concepts: matrices^block size
+
+.seealso: MatCreateSeqBAIJ(), MatCreateBAIJ(), MatGetBlockSize(), MatSetBlockSizes(), MatGetBlockSizes(), MatGetVariableBlockSizes(), PCVPBJACOBI
+@*/
+PetscErrorCode MatSetVariableBlockSizes(Mat mat,PetscInt nblocks,PetscInt *bsizes)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,ncnt = 0;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(mat,MAT_CLASSID,1);
+  if (nblocks < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of blocks %D cannot be negative",nblocks);
+  if (nblocks) PetscValidIntPointer(bsizes,3);
+  for (i=0; i<nblocks; i++) {
+    if (bsizes[i] < 1) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Size %D of block %D must be positive",bsizes[i],i);
+    ncnt += bsizes[i];
+  }
+  if (mat->rmap->n >= 0 && ncnt != mat->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Sum of the block sizes %D does not equal the number of local rows %D",ncnt,mat->rmap->n);
+  ierr = PetscFree(mat->bsizes);CHKERRQ(ierr);
+  mat->nblocks = nblocks;
+  ierr = PetscMalloc1(nblocks,&mat->bsizes);CHKERRQ(ierr);
+  ierr = PetscMemcpy(mat->bsizes,bsizes,nblocks*sizeof(PetscInt));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatGetVariableBlockSizes"
+/*@C
+   MatGetVariableBlockSizes - Gets the sizes of the diagonal blocks of the local rows set with MatSetVariableBlockSizes()
+
+   Not Collective
+
+   Input Parameter:
+.  mat - the matrix
+
+   Output Parameters:
++  nblocks - the number of blocks on this process, 0 if no sizes were set
+-  bsizes - the block sizes
+
+   Level: intermediate
+
+   Concepts: matrices^block size
+
+.seealso: MatSetVariableBlockSizes(), MatGetBlockSizes(), PCVPBJACOBI
+@*/
+PetscErrorCode MatGetVariableBlockSizes(Mat mat,PetscInt *nblocks,const PetscInt **bsizes)
+{
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(mat,MAT_CLASSID,1);
+  if (nblocks) *nblocks = mat->nblocks;
+  if (bsizes)  *bsizes  = mat->bsizes;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatSetBlockSizesFromMats"
 /*@
@@ -9101,6 +9197,11 @@ PetscErrorCode MatFactorInvertSchurComplement(Mat F)
    This routine is currently only implemented for pairs of AIJ matrices and classes
    which inherit from AIJ.
 
+   Options Database Keys:
+.  -matptap_via <scalable,nonscalable,allatonce,allatonce_merged> - algorithm for MPIAIJ matrices; allatonce computes
+          each row of A*P only when it is needed and never stores A*P, which reduces the memory used, and allatonce_merged
+          in addition overlaps the communication of the needed rows of P with the local part of the computation in MatPtAPNumeric()
+
    Level: intermediate
 
 .seealso: MatPtAPSymbolic(), MatPtAPNumeric(), MatMatMult(), MatRARt()
@@ -10308,6 +10409,70 @@ PetscErrorCode MatInvertBlockDiagonal(Mat mat,const PetscScalar **values)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatInvertVariableBlockDiagonal"
+/*@C
+  MatInvertVariableBlockDiagonal - Inverts the diagonal blocks of the local rows, of the sizes given
+
+  Not Collective
+
+  Input Parameters:
++ mat - the matrix
+. nblocks - the number of blocks on this process
+- bsizes - the block sizes, they must add up to the number of local rows
+
+  Output Parameters:
+. values - the block inverses in column major order (FORTRAN-like), one after the other; the caller provides the space,
+           the sum of the squares of the block sizes
+
+  Notes:
+  The blocks are obtained with MatGetValues(). Each run of consecutive blocks of the same size is inverted together,
+  several blocks at a time with the vector kernels that MatInvertBlockDiagonal() uses.
+
+  This routine is not available from Fortran.
+
+  Level: advanced
+
+.seealso: MatInvertBlockDiagonal(), MatSetVariableBlockSizes(), PCVPBJACOBI
+@*/
+PetscErrorCode MatInvertVariableBlockDiagonal(Mat mat,PetscInt nblocks,const PetscInt *bsizes,PetscScalar *values)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,bs,bsmax = 0,ncnt = 0,row,*idx;
+  PetscScalar    *v = values;
+  PetscBool      allowzeropivot,zeropivotdetected;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(mat,MAT_CLASSID,1);
+  if (!mat->assembled) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for unassembled matrix");
+  if (mat->factortype) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for factored matrix");
+  for (i=0; i<nblocks; i++) {
+    ncnt += bsizes[i];
+    bsmax = PetscMax(bsmax,bsizes[i]);
+  }
+  if (ncnt != mat->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Sum of the block sizes %D does not equal the number of local rows %D",ncnt,mat->rmap->n);
+  allowzeropivot = PetscNot(mat->erroriffailure);
+  ierr = PetscMalloc1(bsmax,&idx);CHKERRQ(ierr);
+  row  = mat->rmap->rstart;
+  for (i=0; i<nblocks; i=k) {
+    bs = bsizes[i];
+    for (k=i; k<nblocks && bsizes[k] == bs; k++) {
+      for (j=0; j<bs; j++) idx[j] = row + j;
+      ierr = MatGetValues(mat,bs,idx,bs,idx,v + bs*bs*(k-i));CHKERRQ(ierr);
+      row += bs;
+    }
+    /* the blocks are stored by rows, so the inverses are transposed */
+    ierr = PetscKernel_A_gets_inverse_A_batch(bs,k-i,v,0.0,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) mat->errortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
+    for (j=i; j<k; j++) {
+      ierr = PetscKernel_A_gets_transpose_A_N(v,bs);CHKERRQ(ierr);
+      v   += bs*bs;
+    }
+  }
+  ierr = PetscFree(idx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatTransposeColoringDestroy"
 /*@C
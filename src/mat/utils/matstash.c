@@ -2,6 +2,8 @@
 #include <petsc/private/matimpl.h>
 
 #define DEFAULT_STASH_SIZE   10000
+#define DEFAULT_STREAM_SIZE  1000000
+#define STREAM_RECV_INTERVAL 100
 
 static PetscErrorCode MatStashScatterBegin_Ref(Mat,MatStash*,PetscInt*);
 static PetscErrorCode MatStashScatterGetMesg_Ref(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
@@ -10,6 +12,12 @@ static PetscErrorCode MatStashScatterBegin_BTS(Mat,MatStash*,PetscInt*);
 static PetscErrorCode MatStashScatterGetMesg_BTS(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
 static PetscErrorCode MatStashScatterEnd_BTS(MatStash*);
 static PetscErrorCode MatStashScatterDestroy_BTS(MatStash*);
+static PetscErrorCode MatStashScatterBegin_Stream(Mat,MatStash*,PetscInt*);
+static PetscErrorCode MatStashScatterGetMesg_Stream(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
+static PetscErrorCode MatStashScatterEnd_Stream(MatStash*);
+static PetscErrorCode MatStashScatterDestroy_Stream(MatStash*);
+static PetscErrorCode MatStashStreamProgress_Private(MatStash*);
+static PetscErrorCode MatStashStreamReserve_Private(MatStash*,PetscInt);
 
 /*
   MatStashCreate_Private - Creates a stash,currently used for all the parallel
@@ -31,7 +39,7 @@ PetscErrorCode MatStashCreate_Private(MPI_Comm comm,PetscInt bs,MatStash *stash)
 {
   PetscErrorCode ierr;
   PetscInt       max,*opt,nopt,i;
-  PetscBool      flg;
+  PetscBool      flg,stream;
 
   PetscFunctionBegin;
   /* Require 2 tags,get the second using PetscCommGetNewTag() */
@@ -80,9 +88,38 @@ PetscErrorCode MatStashCreate_Private(MPI_Comm comm,PetscInt bs,MatStash *stash)
   stash->reproduce   = PETSC_FALSE;
   stash->blocktype   = MPI_DATATYPE_NULL;
 
+  stash->streamsize     = 0;
+  stash->owners         = NULL;
+  stash->streamcounts   = NULL;
+  stash->nstreamsends   = 0;
+  stash->maxstreamsends = 0;
+  stash->streamreqs     = NULL;
+  stash->streambufs     = NULL;
+  stash->streamlens     = NULL;
+  stash->streaminflight = 0;
+  stash->nstreamrecvs   = 0;
+  stash->streamcalls    = 0;
+  stash->streamtag      = stash->tag1;
+  stash->streaminsert   = NULL;
+  stash->streampoll     = PETSC_FALSE;
+  stash->nstreamframes  = 0;
+  stash->streamrecvbuf  = NULL;
+  stash->streamrecvmax  = 0;
+
   ierr = PetscOptionsGetBool(NULL,NULL,"-matstash_reproduce",&stash->reproduce,NULL);CHKERRQ(ierr);
-  ierr = PetscOptionsGetBool(NULL,NULL,"-matstash_bts",&flg,NULL);CHKERRQ(ierr);
-  if (flg) {
+  stream = PETSC_FALSE;
+  max    = DEFAULT_STREAM_SIZE;
+  ierr   = PetscOptionsGetBool(NULL,NULL,"-matstash_stream",&stream,NULL);CHKERRQ(ierr);
+  ierr   = PetscOptionsGetInt(NULL,NULL,"-matstash_stream_size",&max,NULL);CHKERRQ(ierr);
+  ierr   = PetscOptionsGetBool(NULL,NULL,"-matstash_bts",&flg,NULL);CHKERRQ(ierr);
+  if (stream) {
+    if (max <= 0) SETERRQ1(comm,PETSC_ERR_ARG_OUTOFRANGE,"-matstash_stream_size %D must be positive",max);
+    stash->streamsize     = max;
+    stash->ScatterBegin   = MatStashScatterBegin_Stream;
+    stash->ScatterGetMesg = MatStashScatterGetMesg_Stream;
+    stash->ScatterEnd     = MatStashScatterEnd_Stream;
+    stash->ScatterDestroy = MatStashScatterDestroy_Stream;
+  } else if (flg) {
     stash->ScatterBegin   = MatStashScatterBegin_BTS;
     stash->ScatterGetMesg = MatStashScatterGetMesg_BTS;
     stash->ScatterEnd     = MatStashScatterEnd_BTS;
@@ -220,6 +257,26 @@ PetscErrorCode MatStashSetInitialSize_Private(MatStash *stash,PetscInt max)
   PetscFunctionReturn(0);
 }
 
+/*
+   MatStashSetOwners_Private - Gives the ownership ranges of the rows to the stash, so that a streaming stash
+   can send its values before the assembly, and the routine that adds the values it receives to the matrix
+
+   Input Parameters:
+   stash  - the stash
+   owners - the ownership ranges, indexed by blocks for a blocked stash; the array is not copied
+   insert - adds one received block, a value or a column oriented bs x bs block, to a locally owned row with ADD_VALUES;
+            NULL keeps the received values until the assembly
+*/
+#undef __FUNCT__
+#define __FUNCT__ "MatStashSetOwners_Private"
+PetscErrorCode MatStashSetOwners_Private(MatStash *stash,const PetscInt owners[],PetscErrorCode (*insert)(Mat,PetscInt,PetscInt,const PetscScalar[]))
+{
+  PetscFunctionBegin;
+  stash->owners       = owners;
+  stash->streaminsert = insert;
+  PetscFunctionReturn(0);
+}
+
 /* MatStashExpand_Private - Expand the stash. This function is called
    when the space in the stash is not sufficient to add the new values
    being inserted into the stash.
@@ -280,6 +337,10 @@ PetscErrorCode MatStashValuesRow_Private(MatStash *stash,PetscInt row,PetscInt n
   PetscMatStashSpace space=stash->space;
 
   PetscFunctionBegin;
+  if (stash->streamsize) {
+    ierr  = MatStashStreamReserve_Private(stash,n);CHKERRQ(ierr);
+    space = stash->space;
+  }
   /* Check and see if we have sufficient memory */
   if (!space || space->local_remaining < n) {
     ierr = MatStashExpand_Private(stash,n);CHKERRQ(ierr);
@@ -297,6 +358,7 @@ PetscErrorCode MatStashValuesRow_Private(MatStash *stash,PetscInt row,PetscInt n
   stash->n               += cnt;
   space->local_used      += cnt;
   space->local_remaining -= cnt;
+  if (stash->streamsize) {ierr = MatStashStreamProgress_Private(stash);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
 
@@ -323,6 +385,10 @@ PetscErrorCode MatStashValuesCol_Private(MatStash *stash,PetscInt row,PetscInt n
   PetscMatStashSpace space=stash->space;
 
   PetscFunctionBegin;
+  if (stash->streamsize) {
+    ierr  = MatStashStreamReserve_Private(stash,n);CHKERRQ(ierr);
+    space = stash->space;
+  }
   /* Check and see if we have sufficient memory */
   if (!space || space->local_remaining < n) {
     ierr = MatStashExpand_Private(stash,n);CHKERRQ(ierr);
@@ -340,6 +406,7 @@ PetscErrorCode MatStashValuesCol_Private(MatStash *stash,PetscInt row,PetscInt n
   stash->n               += cnt;
   space->local_used      += cnt;
   space->local_remaining -= cnt;
+  if (stash->streamsize) {ierr = MatStashStreamProgress_Private(stash);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
 
@@ -372,6 +439,10 @@ PetscErrorCode MatStashValuesRowBlocked_Private(MatStash *stash,PetscInt row,Pet
   PetscMatStashSpace space=stash->space;
 
   PetscFunctionBegin;
+  if (stash->streamsize) {
+    ierr  = MatStashStreamReserve_Private(stash,n);CHKERRQ(ierr);
+    space = stash->space;
+  }
   if (!space || space->local_remaining < n) {
     ierr = MatStashExpand_Private(stash,n);CHKERRQ(ierr);
   }
@@ -396,6 +467,7 @@ PetscErrorCode MatStashValuesRowBlocked_Private(MatStash *stash,PetscInt row,Pet
   stash->n               += n;
   space->local_used      += n;
   space->local_remaining -= n;
+  if (stash->streamsize) {ierr = MatStashStreamProgress_Private(stash);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
 
@@ -428,6 +500,10 @@ PetscErrorCode MatStashValuesColBlocked_Private(MatStash *stash,PetscInt row,Pet
   PetscMatStashSpace space=stash->space;
 
   PetscFunctionBegin;
+  if (stash->streamsize) {
+    ierr  = MatStashStreamReserve_Private(stash,n);CHKERRQ(ierr);
+    space = stash->space;
+  }
   if (!space || space->local_remaining < n) {
     ierr = MatStashExpand_Private(stash,n);CHKERRQ(ierr);
   }
@@ -452,6 +528,7 @@ PetscErrorCode MatStashValuesColBlocked_Private(MatStash *stash,PetscInt row,Pet
   stash->n               += n;
   space->local_used      += n;
   space->local_remaining -= n;
+  if (stash->streamsize) {ierr = MatStashStreamProgress_Private(stash);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
 /*
@@ -1080,3 +1157,378 @@ static PetscErrorCode MatStashScatterDestroy_BTS(MatStash *stash)
   ierr = PetscFree2(stash->some_indices,stash->some_statuses);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+
+/*
+   The streaming stash sends the stashed values as soon as there are streamsize of them, with one message to each
+   owner of the stashed rows, instead of keeping them all until MatAssemblyBegin(). The messages that arrive are
+   received while values are being set. With ADD_VALUES they are added to the matrix right away, through one receive
+   buffer that only grows to the largest message, so that the memory of the receiver is bounded as well. This cannot
+   be done from inside the MatSetValues() of the matrix type, which keeps pointers into its arrays, so the stash only
+   flags that messages are to be received, and MatSetValues() and MatSetValuesBlocked() receive and add them after
+   the values of the call are set, see MatStashStreamPoll_Private(). With INSERT_VALUES the order of the values
+   matters, so the messages are kept until the assembly inserts them after the values set locally, as the other
+   stashes do.
+
+   Nothing waits on the sends while values are being set, since the destinations may be anywhere else in the code,
+   for instance in a collective. A flush is rather postponed while the sends in flight hold more than streamsize
+   values, and the values stay stashed until these are received. The memory is thus bounded by about twice
+   streamsize only when the other ranks keep setting values, or are in the assembly.
+
+   The values are sent as soon as the ownership ranges are known, see MatStashSetOwners_Private(), otherwise they are
+   all sent in MatStashScatterBegin_Stream(). There the number of messages to receive is unknown, so that the
+   messages are synchronous sends and the ranks use a nonblocking consensus (NBX, Hoefler, Siebert and Lumsdaine,
+   2010): each rank receives the messages that arrive until its own sends are received, then enters an
+   MPI_Ibarrier() and keeps receiving until the barrier completes. The tags of consecutive assemblies alternate, so
+   that the early messages of the next assembly are not taken for messages of this one.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamTest_Private"
+/* frees the buffers of the sends that are done */
+static PetscErrorCode MatStashStreamTest_Private(MatStash *stash)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j;
+  PetscMPIInt    done;
+
+  PetscFunctionBegin;
+  for (i=0,j=0; i<stash->nstreamsends; i++) {
+    ierr = MPI_Test(&stash->streamreqs[i],&done,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+    if (done) {
+      ierr = PetscFree(stash->streambufs[i]);CHKERRQ(ierr);
+      stash->streaminflight -= stash->streamlens[i];
+    } else {
+      stash->streamreqs[j] = stash->streamreqs[i];
+      stash->streambufs[j] = stash->streambufs[i];
+      stash->streamlens[j] = stash->streamlens[i];
+      j++;
+    }
+  }
+  stash->nstreamsends = j;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamRecv_Private"
+/* receives the messages that have arrived, or if nrecvs is not negative, waits until nrecvs messages are received;
+   they are added to mat with ADD_VALUES and otherwise kept for the assembly. Without mat nothing is received, the
+   messages are left to the next MatSetValues() */
+static PetscErrorCode MatStashStreamRecv_Private(Mat mat,MatStash *stash,PetscMPIInt nrecvs)
+{
+  PetscErrorCode ierr;
+  MPI_Status     status;
+  PetscMPIInt    flag,count,i;
+  MatStashFrame  *frame;
+  MatStashBlock  *block;
+  PetscBool      add;
+
+  PetscFunctionBegin;
+  stash->streamcalls = 0;
+  if (!mat && stash->streaminsert) {
+    stash->streampoll = PETSC_TRUE;
+    PetscFunctionReturn(0);
+  }
+  stash->streampoll = PETSC_FALSE;
+  add  = (PetscBool)(mat && stash->streaminsert && mat->insertmode == ADD_VALUES);
+  ierr = MatStashBlockTypeSetUp(stash);CHKERRQ(ierr);
+  while (1) {
+    if (nrecvs >= 0) {
+      if (stash->nstreamrecvs >= nrecvs) break;
+      ierr = MPI_Probe(MPI_ANY_SOURCE,stash->streamtag,stash->comm,&status);CHKERRQ(ierr);
+    } else {
+      ierr = MPI_Iprobe(MPI_ANY_SOURCE,stash->streamtag,stash->comm,&flag,&status);CHKERRQ(ierr);
+      if (!flag) break;
+    }
+    ierr = MPI_Get_count(&status,stash->blocktype,&count);CHKERRQ(ierr);
+    stash->nstreamrecvs++;
+    if (add) {
+      if (count > stash->streamrecvmax) {
+        ierr = PetscFree(stash->streamrecvbuf);CHKERRQ(ierr);
+        ierr = PetscMalloc(count*stash->blocktype_size,&stash->streamrecvbuf);CHKERRQ(ierr);
+        stash->streamrecvmax = count;
+      }
+      ierr = MPI_Recv(stash->streamrecvbuf,count,stash->blocktype,status.MPI_SOURCE,stash->streamtag,stash->comm,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+      for (i=0; i<count; i++) {
+        block = (MatStashBlock*)&stash->streamrecvbuf[i*stash->blocktype_size];
+        ierr  = (*stash->streaminsert)(mat,block->row,block->col,block->vals);CHKERRQ(ierr);
+      }
+    } else {
+      ierr = PetscSegBufferGet(stash->segrecvframe,1,&frame);CHKERRQ(ierr);
+      ierr = PetscSegBufferGet(stash->segrecvblocks,count,&frame->buffer);CHKERRQ(ierr);
+      ierr = MPI_Recv(frame->buffer,count,stash->blocktype,status.MPI_SOURCE,stash->streamtag,stash->comm,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+      frame->count   = count;
+      frame->pending = 0;
+      stash->nstreamframes++;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamPoll_Private"
+/*
+   MatStashStreamPoll_Private - Receives the streamed messages that the stashes of the matrix flagged while values were
+   being set, and adds them to the matrix with ADD_VALUES; called by MatSetValues() and MatSetValuesBlocked() once the
+   matrix type is done with the values of the call
+*/
+PetscErrorCode MatStashStreamPoll_Private(Mat mat)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (mat->stash.streampoll) {ierr = MatStashStreamRecv_Private(mat,&mat->stash,-1);CHKERRQ(ierr);}
+  if (mat->bstash.streampoll) {ierr = MatStashStreamRecv_Private(mat,&mat->bstash,-1);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamSend_Private"
+/* sends the stashed values, one message for each owner of their rows, and empties the stash; unless force is set,
+   nothing is sent while the sends in flight hold more than streamsize values */
+static PetscErrorCode MatStashStreamSend_Private(MatStash *stash,const PetscInt owners[],PetscBool force)
+{
+  PetscErrorCode     ierr;
+  PetscInt           bs2 = stash->bs*stash->bs,size = stash->size,i,j,k,l,nnew,*owner,*sizes;
+  char               **bufs;
+  MatStashBlock      *block;
+  PetscMatStashSpace space;
+
+  PetscFunctionBegin;
+  ierr = MatStashBlockTypeSetUp(stash);CHKERRQ(ierr);
+  if (!stash->streamcounts) {ierr = PetscCalloc1(size,&stash->streamcounts);CHKERRQ(ierr);}
+  ierr = MatStashStreamTest_Private(stash);CHKERRQ(ierr);
+  ierr = MatStashStreamRecv_Private(NULL,stash,-1);CHKERRQ(ierr);
+  if (!stash->n || (!force && stash->streaminflight*bs2 > stash->streamsize)) PetscFunctionReturn(0);
+
+  /* find the owner of each stashed block, the rows are often sorted so that the last owner is tried first */
+  ierr = PetscMalloc1(stash->n,&owner);CHKERRQ(ierr);
+  ierr = PetscCalloc2(size,&sizes,size,&bufs);CHKERRQ(ierr);
+  for (space=stash->space_head,j=0,k=0; space; space=space->next) {
+    for (l=0; l<space->local_used; l++) {
+      PetscInt row = space->idx[l];
+      if (row < owners[j] || row >= owners[j+1]) {
+        ierr = PetscFindInt(row,size+1,owners,&j);CHKERRQ(ierr);
+        if (j < 0) j = -(j+2);
+        while (row >= owners[j+1]) j++; /* skip the ranks that own no rows */
+      }
+      owner[k++] = j;
+      sizes[j]++;
+    }
+  }
+  for (i=0,nnew=0; i<size; i++) if (sizes[i]) nnew++;
+  if (stash->nstreamsends + nnew > stash->maxstreamsends) {
+    PetscInt    newmax = PetscMax(2*stash->maxstreamsends,stash->nstreamsends+nnew),*lens;
+    MPI_Request *reqs;
+    char        **sbufs;
+
+    ierr = PetscMalloc3(newmax,&reqs,newmax,&sbufs,newmax,&lens);CHKERRQ(ierr);
+    ierr = PetscMemcpy(reqs,stash->streamreqs,stash->nstreamsends*sizeof(MPI_Request));CHKERRQ(ierr);
+    ierr = PetscMemcpy(sbufs,stash->streambufs,stash->nstreamsends*sizeof(char*));CHKERRQ(ierr);
+    ierr = PetscMemcpy(lens,stash->streamlens,stash->nstreamsends*sizeof(PetscInt));CHKERRQ(ierr);
+    ierr = PetscFree3(stash->streamreqs,stash->streambufs,stash->streamlens);CHKERRQ(ierr);
+    stash->streamreqs     = reqs;
+    stash->streambufs     = sbufs;
+    stash->streamlens     = lens;
+    stash->maxstreamsends = newmax;
+  }
+
+  /* pack the blocks in the order they were stashed, so that the last value inserted at a location wins */
+  for (i=0; i<size; i++) {
+    if (sizes[i]) {ierr = PetscMalloc1(sizes[i]*stash->blocktype_size,&bufs[i]);CHKERRQ(ierr);}
+    sizes[i] = 0;
+  }
+  for (space=stash->space_head,k=0; space; space=space->next) {
+    for (l=0; l<space->local_used; l++,k++) {
+      j          = owner[k];
+      block      = (MatStashBlock*)&bufs[j][sizes[j]++*stash->blocktype_size];
+      block->row = space->idx[l];
+      block->col = space->idy[l];
+      ierr       = PetscMemcpy(block->vals,&space->val[l*bs2],bs2*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+  }
+  for (i=0; i<size; i++) {
+    if (!sizes[i]) continue;
+    k    = stash->nstreamsends++;
+#if defined(PETSC_HAVE_MPI_IBARRIER)
+    ierr = MPI_Issend(bufs[i],sizes[i],stash->blocktype,i,stash->streamtag,stash->comm,&stash->streamreqs[k]);CHKERRQ(ierr);
+#else
+    ierr = MPI_Isend(bufs[i],sizes[i],stash->blocktype,i,stash->streamtag,stash->comm,&stash->streamreqs[k]);CHKERRQ(ierr);
+#endif
+    stash->streambufs[k] = bufs[i];
+    stash->streamlens[k] = sizes[i];
+    stash->streamcounts[i]++;
+  }
+  stash->streaminflight += stash->n;
+  ierr = PetscFree(owner);CHKERRQ(ierr);
+  ierr = PetscFree2(sizes,bufs);CHKERRQ(ierr);
+
+  /* empty the stash, the next values are stashed in a new space of the same size */
+  ierr = PetscMatStashSpaceDestroy(&stash->space_head);CHKERRQ(ierr);
+  stash->space   = 0;
+  stash->oldnmax = PetscMax(stash->oldnmax,stash->nmax*bs2);
+  stash->nmax    = 0;
+  stash->n       = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamProgress_Private"
+/* called once n blocks were stashed */
+static PetscErrorCode MatStashStreamProgress_Private(MatStash *stash)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (stash->owners && stash->n*stash->bs*stash->bs >= stash->streamsize) {
+    ierr = MatStashStreamSend_Private(stash,stash->owners,PETSC_FALSE);CHKERRQ(ierr);
+  } else if (++stash->streamcalls >= STREAM_RECV_INTERVAL) {
+    ierr = MatStashStreamTest_Private(stash);CHKERRQ(ierr);
+    ierr = MatStashStreamRecv_Private(NULL,stash,-1);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashStreamReserve_Private"
+/* called before n blocks are stashed, so that the stash is sent before it exceeds streamsize values */
+static PetscErrorCode MatStashStreamReserve_Private(MatStash *stash,PetscInt n)
+{
+  PetscErrorCode ierr;
+  PetscInt       bs2 = stash->bs*stash->bs;
+
+  PetscFunctionBegin;
+  if (stash->owners && stash->n && (stash->n+n)*bs2 > stash->streamsize) {
+    ierr = MatStashStreamSend_Private(stash,stash->owners,PETSC_FALSE);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashScatterBegin_Stream"
+static PetscErrorCode MatStashScatterBegin_Stream(Mat mat,MatStash *stash,PetscInt owners[])
+{
+  PetscErrorCode ierr;
+#if !defined(PETSC_HAVE_MPI_IBARRIER)
+  PetscMPIInt    nrecvs;
+#endif
+
+  PetscFunctionBegin;
+  {                             /* make sure all processors are either in INSERTMODE or ADDMODE */
+    InsertMode addv;
+    ierr = MPIU_Allreduce((PetscEnum*)&mat->insertmode,(PetscEnum*)&addv,1,MPIU_ENUM,MPI_BOR,PetscObjectComm((PetscObject)mat));CHKERRQ(ierr);
+    if (addv == (ADD_VALUES|INSERT_VALUES)) SETERRQ(PetscObjectComm((PetscObject)mat),PETSC_ERR_ARG_WRONGSTATE,"Some processors inserted others added");
+    mat->insertmode = addv; /* in case this processor had no cache */
+  }
+
+  ierr = MatStashStreamSend_Private(stash,owners,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = PetscInfo2(NULL,"Stash has %D sends with %D blocks in flight\n",stash->nstreamsends,stash->streaminflight);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_IBARRIER)
+  {
+    MPI_Request barrier = MPI_REQUEST_NULL;
+    PetscMPIInt done    = 0;
+
+    while (!done) {
+      ierr = MatStashStreamRecv_Private(mat,stash,-1);CHKERRQ(ierr);
+      if (barrier == MPI_REQUEST_NULL) {
+        ierr = MatStashStreamTest_Private(stash);CHKERRQ(ierr);
+        /* the synchronous sends are all done, so that they were received */
+        if (!stash->nstreamsends) {ierr = MPI_Ibarrier(stash->comm,&barrier);CHKERRQ(ierr);}
+      } else {
+        ierr = MPI_Test(&barrier,&done,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+      }
+    }
+  }
+#else
+  /* counting the messages is a collective, which does not wait on the sends to complete */
+  ierr = PetscGatherNumberOfMessages(stash->comm,stash->streamcounts,NULL,&nrecvs);CHKERRQ(ierr);
+  ierr = MatStashStreamRecv_Private(mat,stash,nrecvs);CHKERRQ(ierr);
+#endif
+  ierr = PetscInfo2(NULL,"Stash received %d messages, %d kept for the assembly\n",stash->nstreamrecvs,stash->nstreamframes);CHKERRQ(ierr);
+
+  ierr = PetscSegBufferExtractInPlace(stash->segrecvframe,&stash->recvframes);CHKERRQ(ierr);
+  stash->recvframe_active = NULL;
+  stash->recvframe_i      = 0;
+  stash->recvcount        = 0;
+  stash->insertmode       = &mat->insertmode;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashScatterGetMesg_Stream"
+static PetscErrorCode MatStashScatterGetMesg_Stream(MatStash *stash,PetscMPIInt *n,PetscInt **row,PetscInt **col,PetscScalar **val,PetscInt *flg)
+{
+  MatStashBlock *block;
+
+  PetscFunctionBegin;
+  *flg = 0;
+  while (!stash->recvframe_active || stash->recvframe_i == stash->recvframe_count) {
+    if (stash->recvcount == stash->nstreamframes) PetscFunctionReturn(0); /* Done */
+    stash->recvframe_active = &stash->recvframes[stash->recvcount++];
+    stash->recvframe_count  = (PetscMPIInt)stash->recvframe_active->count;
+    stash->recvframe_i      = 0;
+  }
+  *n    = 1;
+  block = (MatStashBlock*)&((char*)stash->recvframe_active->buffer)[stash->recvframe_i*stash->blocktype_size];
+  *row  = &block->row;
+  *col  = &block->col;
+  *val  = block->vals;
+  stash->recvframe_i++;
+  *flg  = 1;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashScatterEnd_Stream"
+static PetscErrorCode MatStashScatterEnd_Stream(MatStash *stash)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatStashScatterDestroy_Stream(stash);CHKERRQ(ierr);
+  stash->streamtag = stash->streamtag == stash->tag1 ? stash->tag2 : stash->tag1;
+
+  if (stash->n) {
+    PetscInt bs2     = stash->bs*stash->bs;
+    PetscInt oldnmax = ((int)(stash->n * 1.1) + 5)*bs2;
+    if (oldnmax > stash->oldnmax) stash->oldnmax = oldnmax;
+  }
+
+  stash->nmax       = 0;
+  stash->n          = 0;
+  stash->reallocs   = -1;
+  stash->nprocessed = 0;
+
+  ierr = PetscMatStashSpaceDestroy(&stash->space_head);CHKERRQ(ierr);
+
+  stash->space = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashScatterDestroy_Stream"
+static PetscErrorCode MatStashScatterDestroy_Stream(MatStash *stash)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  if (stash->nstreamsends) {ierr = MPI_Waitall(stash->nstreamsends,stash->streamreqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);}
+  for (i=0; i<stash->nstreamsends; i++) {ierr = PetscFree(stash->streambufs[i]);CHKERRQ(ierr);}
+  ierr = PetscFree3(stash->streamreqs,stash->streambufs,stash->streamlens);CHKERRQ(ierr);
+  ierr = PetscFree(stash->streamcounts);CHKERRQ(ierr);
+  stash->nstreamsends   = 0;
+  stash->maxstreamsends = 0;
+  stash->streaminflight = 0;
+  stash->nstreamrecvs   = 0;
+  stash->nstreamframes  = 0;
+  stash->streampoll     = PETSC_FALSE;
+  ierr = PetscFree(stash->streamrecvbuf);CHKERRQ(ierr);
+  stash->streamrecvmax  = 0;
+  ierr = PetscSegBufferDestroy(&stash->segsendblocks);CHKERRQ(ierr);
+  ierr = PetscSegBufferDestroy(&stash->segrecvframe);CHKERRQ(ierr);
+  stash->recvframes = NULL;
+  ierr = PetscSegBufferDestroy(&stash->segrecvblocks);CHKERRQ(ierr);
+  if (stash->blocktype != MPI_DATATYPE_NULL) {
+    ierr = MPI_Type_free(&stash->blocktype);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
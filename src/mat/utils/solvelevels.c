@@ -0,0 +1,103 @@
+
+/*
+    Level sets of sparse triangular factors, shared by the level-scheduled threaded MatSolve() of the
+  SeqAIJ LU factors and the SeqSBAIJ (block size one) Cholesky factors. Row i of a triangular factor
+  can be computed as soon as the rows it depends on are; putting each row in level
+
+       depth(i) = 1 + max { depth(j) : row i depends on row j }     (0 if it depends on no row)
+
+  gives sets of rows that are independent of each other and can be processed by several threads,
+  with a barrier between consecutive levels.
+*/
+#include <petsc/private/matimpl.h>  /*I   "petscmat.h"  I*/
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsSetFromOptions"
+/*
+   MatSolveLevelsSetFromOptions - Reads -mat_solve_levels and -mat_solve_levels_threads for a factored matrix,
+   only the first time it is called for the matrix.
+*/
+PetscErrorCode MatSolveLevelsSetFromOptions(Mat A,Mat_SolveLevels *lv)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (lv->checked) PetscFunctionReturn(0);
+  lv->checked  = PETSC_TRUE;
+  lv->nthreads = 1;
+#if defined(PETSC_HAVE_OPENMP)
+  lv->nthreads = omp_get_max_threads();
+#endif
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)A),((PetscObject)A)->prefix,"Options for factored matrix","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_solve_levels","Use the level-scheduled OpenMP threaded triangular solves","None",lv->use,&lv->use,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_solve_levels_threads","Number of threads for the level-scheduled triangular solves","None",lv->nthreads,&lv->nthreads,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (lv->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",lv->nthreads);
+#if !defined(PETSC_HAVE_OPENMP)
+  if (lv->use) {
+    ierr = PetscInfo(A,"PETSc was not configured with OpenMP, ignoring -mat_solve_levels\n");CHKERRQ(ierr);
+    lv->use = PETSC_FALSE;
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsSetUp"
+/*
+   MatSolveLevelsSetUp - Sorts the rows of the forward (t = 0) or backward (t = 1) substitution by level
+
+   Input Parameters:
++  A     - the factored matrix
+.  lv    - the level information of A
+.  t     - 0 for the forward and 1 for the backward substitution
+.  n     - number of rows
+-  depth - level of each row
+
+   Notes: The rows of each level are kept in increasing order.
+*/
+PetscErrorCode MatSolveLevelsSetUp(Mat A,Mat_SolveLevels *lv,PetscInt t,PetscInt n,const PetscInt depth[])
+{
+  PetscErrorCode ierr;
+  PetscInt       i,l,nl = 0,*level,*rows;
+
+  PetscFunctionBegin;
+  for (i=0; i<n; i++) nl = PetscMax(nl,depth[i]+1);
+  ierr = PetscFree2(lv->level[t],lv->rows[t]);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nl+1,&lv->level[t],n,&lv->rows[t]);CHKERRQ(ierr);
+  level = lv->level[t];
+  rows  = lv->rows[t];
+  ierr  = PetscMemzero(level,(nl+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<n; i++) level[depth[i]+1]++;
+  for (l=0; l<nl; l++) level[l+1] += level[l];
+  for (i=0; i<n; i++) rows[level[depth[i]]++] = i;
+  /* the counting above shifted each level pointer to the start of the next level */
+  for (l=nl; l>0; l--) level[l] = level[l-1];
+  level[0]       = 0;
+  lv->nlevels[t] = nl;
+  ierr = PetscInfo4(A,"%s substitution of %D rows has %D levels, %g rows per level on average\n",t ? "Backward" : "Forward",n,nl,nl ? (double)n/nl : 0.0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsReset"
+/*
+   MatSolveLevelsReset - Frees the level sets, but keeps the options
+*/
+PetscErrorCode MatSolveLevelsReset(Mat_SolveLevels *lv)
+{
+  PetscErrorCode ierr;
+  PetscInt       t;
+
+  PetscFunctionBegin;
+  for (t=0; t<2; t++) {
+    ierr = PetscFree2(lv->level[t],lv->rows[t]);CHKERRQ(ierr);
+    lv->nlevels[t] = 0;
+  }
+  ierr = PetscFree3(lv->ti,lv->tj,lv->tk);CHKERRQ(ierr);
+  lv->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
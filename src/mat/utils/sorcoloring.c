@@ -0,0 +1,98 @@
+
+/*
+    Coloring of the (block) rows of a sequential matrix for the multicolor MatSOR() of the SeqAIJ and SeqBAIJ
+  matrices. Two rows of the same color of a distance one coloring of the graph of A + A^T do not couple,
+  so the rows of one color can be relaxed at the same time by several threads; sweeping the colors one
+  after the other is Gauss-Seidel for the matrix with its rows ordered by color.
+*/
+#include <petsc/private/matimpl.h>  /*I   "petscmat.h"  I*/
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSORColoringSetUp"
+/*
+   MatSORColoringSetUp - Colors the (block) rows of a sequential matrix, unless the coloring is current
+
+   Input Parameters:
++  A  - the matrix
+.  sc - the coloring information of A
+.  n  - number of (block) rows
+-  ai,aj - the (block) compressed row structure of A, with sorted column indices
+
+   Notes: The coloring is computed with MatColoringApply() of MATCOLORINGGREEDY and kept until the nonzero
+   state of A changes. The rows of each color are kept in increasing order.
+*/
+PetscErrorCode MatSORColoringSetUp(Mat A,Mat_SORColoring *sc,PetscInt n,const PetscInt ai[],const PetscInt aj[])
+{
+  PetscErrorCode ierr;
+  Mat            G,Gt;
+  MatColoring    mc;
+  ISColoring     iscoloring;
+  IS             *is;
+  PetscScalar    *va;
+  const PetscInt *idx;
+  PetscInt       nc,c,k,cnt,nrows;
+
+  PetscFunctionBegin;
+  if (sc->color && sc->nonzerostate == A->nonzerostate) PetscFunctionReturn(0);
+  ierr = MatSORColoringReset(sc);CHKERRQ(ierr);
+  sc->nthreads = 1;
+#if defined(PETSC_HAVE_OPENMP)
+  sc->nthreads = omp_get_max_threads();
+#endif
+
+  /* the graph of A + A^T; the coloring only uses the nonzero structure so the values are zero */
+  ierr = PetscCalloc1(ai[n],&va);CHKERRQ(ierr);
+  ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,n,n,(PetscInt*)ai,(PetscInt*)aj,va,&G);CHKERRQ(ierr);
+  ierr = MatTranspose(G,MAT_INITIAL_MATRIX,&Gt);CHKERRQ(ierr);
+  ierr = MatAXPY(Gt,1.0,G,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatDestroy(&G);CHKERRQ(ierr);
+  ierr = PetscFree(va);CHKERRQ(ierr);
+
+  ierr = MatColoringCreate(Gt,&mc);CHKERRQ(ierr);
+  ierr = MatColoringSetDistance(mc,1);CHKERRQ(ierr);
+  ierr = MatColoringSetType(mc,MATCOLORINGGREEDY);CHKERRQ(ierr);
+  ierr = MatColoringApply(mc,&iscoloring);CHKERRQ(ierr);
+  ierr = MatColoringDestroy(&mc);CHKERRQ(ierr);
+  ierr = MatDestroy(&Gt);CHKERRQ(ierr);
+
+  ierr = ISColoringGetIS(iscoloring,&nc,&is);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nc+1,&sc->color,n,&sc->rows);CHKERRQ(ierr);
+  sc->color[0] = 0;
+  for (c=0,cnt=0; c<nc; c++) {
+    ierr = ISGetLocalSize(is[c],&nrows);CHKERRQ(ierr);
+    if (!nrows) continue;
+    ierr = ISGetIndices(is[c],&idx);CHKERRQ(ierr);
+    for (k=0; k<nrows; k++) sc->rows[sc->color[cnt]+k] = idx[k];
+    ierr = ISRestoreIndices(is[c],&idx);CHKERRQ(ierr);
+    ierr = PetscSortInt(nrows,sc->rows+sc->color[cnt]);CHKERRQ(ierr);
+    sc->color[cnt+1] = sc->color[cnt] + nrows;
+    cnt++;
+  }
+  ierr = ISColoringRestoreIS(iscoloring,&is);CHKERRQ(ierr);
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+  if (sc->color[cnt] != n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Coloring has %D rows, expected %D",sc->color[cnt],n);
+  sc->ncolors      = cnt;
+  sc->nonzerostate = A->nonzerostate;
+  ierr = PetscLogObjectMemory((PetscObject)A,(n+nc+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscInfo3(A,"Multicolor SOR of %D rows uses %D colors, %g rows per color on average\n",n,sc->ncolors,sc->ncolors ? (double)n/sc->ncolors : 0.0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSORColoringReset"
+/*
+   MatSORColoringReset - Frees the coloring
+*/
+PetscErrorCode MatSORColoringReset(Mat_SORColoring *sc)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(sc->color,sc->rows);CHKERRQ(ierr);
+  sc->ncolors      = 0;
+  sc->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
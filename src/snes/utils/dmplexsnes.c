@@ -1506,6 +1506,7 @@ PetscErrorCode DMPlexComputeResidual_Internal(DM dm, PetscInt cStart, PetscInt c
   PetscFV           fvm        = NULL;
   PetscFECellGeom  *cgeomFEM   = NULL;
   PetscScalar      *cgeomScal;
+  DMPlex_AssemblyColoring *coloring = NULL;
   PetscFVCellGeom  *cgeomFVM   = NULL;
   PetscFVFaceGeom  *fgeomFVM   = NULL;
   Vec               locA, cellGeometryFEM = NULL, cellGeometryFVM = NULL, faceGeometryFVM = NULL, grad, locGrad = NULL;
@@ -1582,6 +1583,8 @@ PetscErrorCode DMPlexComputeResidual_Internal(DM dm, PetscInt cStart, PetscInt c
     /* Handle non-essential (e.g. outflow) boundary values */
     ierr = DMPlexInsertBoundaryValues(dm, PETSC_FALSE, locX, time, faceGeometryFVM, cellGeometryFVM, locGrad);CHKERRQ(ierr);
   }
+  /* Thread the cell loop, unless finite volume fields or ghost cells need the serial loop */
+  if (useFEM && !useFVM && !ghostLabel && mesh->printFEM <= 1) {ierr = DMPlexGetAssemblyColoring_Internal(dm, cStart, cEnd, &coloring);CHKERRQ(ierr);}
   /* Loop over chunks */
   ierr = DMPlexGetHeightStratum(dm, 1, &fStart, &fEnd);CHKERRQ(ierr);
   numChunks     = 1;
@@ -1639,8 +1642,12 @@ PetscErrorCode DMPlexComputeResidual_Internal(DM dm, PetscInt cStart, PetscInt c
         offset    = numCells - Nr;
         /* Integrate FE residual to get elemVec (need fields at quadrature points) */
         /*   For FV, I think we use a P0 basis and the cell coefficients (for subdivided cells, we can tweak the basis tabulation to be the indicator function) */
-        ierr = PetscFEIntegrateResidual(fe, prob, f, Ne, cgeomFEM, u, u_t, probAux, a, t, elemVec);CHKERRQ(ierr);
-        ierr = PetscFEIntegrateResidual(fe, prob, f, Nr, &cgeomFEM[offset], &u[offset*totDim], u_t ? &u_t[offset*totDim] : NULL, probAux, &a[offset*totDimAux], t, &elemVec[offset*totDim]);CHKERRQ(ierr);
+        if (coloring) {
+          ierr = DMPlexIntegrateResidualThreaded_Internal(coloring, fe, prob, f, numCells, cgeomFEM, u, u_t, probAux, a, t, elemVec);CHKERRQ(ierr);
+        } else {
+          ierr = PetscFEIntegrateResidual(fe, prob, f, Ne, cgeomFEM, u, u_t, probAux, a, t, elemVec);CHKERRQ(ierr);
+          ierr = PetscFEIntegrateResidual(fe, prob, f, Nr, &cgeomFEM[offset], &u[offset*totDim], u_t ? &u_t[offset*totDim] : NULL, probAux, &a[offset*totDimAux], t, &elemVec[offset*totDim]);CHKERRQ(ierr);
+        }
       } else if (id == PETSCFV_CLASSID) {
         PetscFV fv = (PetscFV) obj;
 
@@ -1658,7 +1665,9 @@ PetscErrorCode DMPlexComputeResidual_Internal(DM dm, PetscInt cStart, PetscInt c
     }
     if (cellGeometryFEM) {ierr = VecRestoreArray(cellGeometryFEM, &cgeomScal);CHKERRQ(ierr);}
     /* Loop over domain */
-    if (useFEM) {
+    if (useFEM && coloring) {
+      ierr = DMPlexVecSetClosureColored_Internal(coloring, locF, elemVec);CHKERRQ(ierr);
+    } else if (useFEM) {
       /* Add elemVec to locX */
       for (cell = cS; cell < cE; ++cell) {
         if (mesh->printFEM > 1) {ierr = DMPrintCellVector(cell, name, totDim, &elemVec[cell*totDim]);CHKERRQ(ierr);}
@@ -2011,6 +2020,216 @@ PetscErrorCode DMPlexSNESComputeBoundaryFEM(DM dm, Vec X, void *user)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexComputeJacobianDiagonal_Private"
+/* Adds the diagonal of the element Jacobians into the local vector D, integrating the diagonal blocks for a bounded number of cells at a time;
+   the blocks are full element matrices, also for PETSCFETENSOR, which has no sum-factorized diagonal */
+static PetscErrorCode DMPlexComputeJacobianDiagonal_Private(DM dm, PetscInt cStart, PetscInt cEnd, PetscReal t, PetscReal X_tShift, Vec X, Vec X_t, Vec D, void *user)
+{
+  DM                dmAux, plex;
+  Vec               A, cellgeom;
+  PetscDS           prob, probAux = NULL;
+  PetscSection      section, sectionAux;
+  PetscFECellGeom  *cgeom = NULL;
+  PetscScalar      *cgeomScal;
+  PetscScalar      *elemMat, *elemMatD, *u, *u_t, *a = NULL, *d;
+  PetscInt          Nf, fieldI, numCells, chunk, c0, c, e, i;
+  PetscInt          totDim, totDimAux = 0;
+  PetscBool         hasDyn;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = DMGetDefaultSection(dm, &section);CHKERRQ(ierr);
+  ierr = DMGetDS(dm, &prob);CHKERRQ(ierr);
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  ierr = PetscDSHasDynamicJacobian(prob, &hasDyn);CHKERRQ(ierr);
+  hasDyn = hasDyn && (X_tShift != 0.0) ? PETSC_TRUE : PETSC_FALSE;
+  ierr = PetscSectionGetNumFields(section, &Nf);CHKERRQ(ierr);
+  numCells = cEnd - cStart;
+  ierr = PetscObjectQuery((PetscObject) dm, "dmAux", (PetscObject *) &dmAux);CHKERRQ(ierr);
+  ierr = PetscObjectQuery((PetscObject) dm, "A", (PetscObject *) &A);CHKERRQ(ierr);
+  if (dmAux) {
+    ierr = DMConvert(dmAux, DMPLEX, &plex);CHKERRQ(ierr);
+    ierr = DMGetDefaultSection(plex, &sectionAux);CHKERRQ(ierr);
+    ierr = DMGetDS(dmAux, &probAux);CHKERRQ(ierr);
+    ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
+  }
+  /* Bound the element matrices to about 2^18 values */
+  chunk = PetscMax(1, PetscMin(numCells, 262144/(totDim*totDim)));
+  ierr = PetscMalloc6(chunk*totDim,&u,X_t ? chunk*totDim : 0,&u_t,chunk*totDim*totDim,&elemMat,hasDyn ? chunk*totDim*totDim : 0,&elemMatD,chunk*totDimAux,&a,totDim,&d);CHKERRQ(ierr);
+  ierr = DMPlexSNESGetGeometryFEM(dm, &cellgeom);CHKERRQ(ierr);
+  ierr = VecGetArray(cellgeom, &cgeomScal);CHKERRQ(ierr);
+  if (sizeof(PetscFECellGeom) % sizeof(PetscScalar)) {
+    DM dmCell;
+
+    ierr = VecGetDM(cellgeom,&dmCell);CHKERRQ(ierr);
+    ierr = PetscMalloc1(cEnd-cStart,&cgeom);CHKERRQ(ierr);
+    for (c = 0; c < cEnd - cStart; c++) {
+      PetscScalar *thisgeom;
+
+      ierr = DMPlexPointLocalRef(dmCell, c + cStart, cgeomScal, &thisgeom);CHKERRQ(ierr);
+      cgeom[c] = *((PetscFECellGeom *) thisgeom);
+    }
+  } else {
+    cgeom = (PetscFECellGeom *) cgeomScal;
+  }
+  for (c0 = cStart; c0 < cEnd; c0 += chunk) {
+    const PetscInt Ne = PetscMin(chunk, cEnd - c0);
+
+    for (c = c0; c < c0+Ne; ++c) {
+      PetscScalar *x = NULL,  *x_t = NULL;
+
+      ierr = DMPlexVecGetClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
+      for (i = 0; i < totDim; ++i) u[(c-c0)*totDim+i] = x[i];
+      ierr = DMPlexVecRestoreClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
+      if (X_t) {
+        ierr = DMPlexVecGetClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
+        for (i = 0; i < totDim; ++i) u_t[(c-c0)*totDim+i] = x_t[i];
+        ierr = DMPlexVecRestoreClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
+      }
+      if (dmAux) {
+        ierr = DMPlexVecGetClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
+        for (i = 0; i < totDimAux; ++i) a[(c-c0)*totDimAux+i] = x[i];
+        ierr = DMPlexVecRestoreClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscMemzero(elemMat, Ne*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);
+    if (hasDyn) {ierr = PetscMemzero(elemMatD, Ne*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);}
+    /* Only the blocks coupling a field to itself contribute to the diagonal */
+    for (fieldI = 0; fieldI < Nf; ++fieldI) {
+      PetscFE fe;
+
+      ierr = PetscDSGetDiscretization(prob, fieldI, (PetscObject *) &fe);CHKERRQ(ierr);
+      ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldI, Ne, &cgeom[c0-cStart], u, u_t, probAux, a, t, X_tShift, elemMat);CHKERRQ(ierr);
+      if (hasDyn) {ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, fieldI, Ne, &cgeom[c0-cStart], u, u_t, probAux, a, t, X_tShift, elemMatD);CHKERRQ(ierr);}
+    }
+    for (e = 0; e < Ne; ++e) {
+      for (i = 0; i < totDim; ++i) {
+        d[i] = elemMat[(e*totDim+i)*totDim+i];
+        if (hasDyn) d[i] += X_tShift*elemMatD[(e*totDim+i)*totDim+i];
+      }
+      ierr = DMPlexVecSetClosure(dm, section, D, c0+e, d, ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  if (sizeof(PetscFECellGeom) % sizeof(PetscScalar)) {ierr = PetscFree(cgeom);CHKERRQ(ierr);}
+  else                                               {cgeom = NULL;}
+  ierr = VecRestoreArray(cellgeom, &cgeomScal);CHKERRQ(ierr);
+  ierr = PetscFree6(u,u_t,elemMat,elemMatD,a,d);CHKERRQ(ierr);
+  if (dmAux) {ierr = DMDestroy(&plex);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_Plex_MFFE"
+static PetscErrorCode MatMult_Plex_MFFE(Mat J, Vec Y, Vec Z)
+{
+  DMPlex_MFFE   *mf;
+  DM             dm, plex;
+  Vec            locY, locZ;
+  PetscInt       cStart, cEnd, cEndInterior;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(J, &mf);CHKERRQ(ierr);
+  ierr = MatGetDM(J, &dm);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(dm, &locY);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(dm, &locZ);CHKERRQ(ierr);
+  /* The direction vanishes on the constrained unknowns */
+  ierr = VecZeroEntries(locY);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(dm, Y, INSERT_VALUES, locY);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(dm, Y, INSERT_VALUES, locY);CHKERRQ(ierr);
+  ierr = DMSNESConvertPlex(dm, &plex, PETSC_TRUE);CHKERRQ(ierr);
+  ierr = DMPlexGetHeightStratum(plex, 0, &cStart, &cEnd);CHKERRQ(ierr);
+  ierr = DMPlexGetHybridBounds(plex, &cEndInterior, NULL, NULL, NULL);CHKERRQ(ierr);
+  cEnd = cEndInterior < 0 ? cEnd : cEndInterior;
+  ierr = DMPlexComputeJacobianAction_Internal(plex, cStart, cEnd, mf->t, mf->shift, mf->X, mf->X_t, locY, locZ, mf->user);CHKERRQ(ierr);
+  ierr = DMDestroy(&plex);CHKERRQ(ierr);
+  ierr = VecZeroEntries(Z);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalBegin(dm, locZ, ADD_VALUES, Z);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalEnd(dm, locZ, ADD_VALUES, Z);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(dm, &locY);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(dm, &locZ);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatGetDiagonal_Plex_MFFE"
+static PetscErrorCode MatGetDiagonal_Plex_MFFE(Mat J, Vec D)
+{
+  DMPlex_MFFE   *mf;
+  DM             dm, plex;
+  Vec            locD;
+  PetscInt       cStart, cEnd, cEndInterior;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(J, &mf);CHKERRQ(ierr);
+  ierr = MatGetDM(J, &dm);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(dm, &locD);CHKERRQ(ierr);
+  ierr = VecZeroEntries(locD);CHKERRQ(ierr);
+  ierr = DMSNESConvertPlex(dm, &plex, PETSC_TRUE);CHKERRQ(ierr);
+  ierr = DMPlexGetHeightStratum(plex, 0, &cStart, &cEnd);CHKERRQ(ierr);
+  ierr = DMPlexGetHybridBounds(plex, &cEndInterior, NULL, NULL, NULL);CHKERRQ(ierr);
+  cEnd = cEndInterior < 0 ? cEnd : cEndInterior;
+  ierr = DMPlexComputeJacobianDiagonal_Private(plex, cStart, cEnd, mf->t, mf->shift, mf->X, mf->X_t, locD, mf->user);CHKERRQ(ierr);
+  ierr = DMDestroy(&plex);CHKERRQ(ierr);
+  ierr = VecZeroEntries(D);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalBegin(dm, locD, ADD_VALUES, D);CHKERRQ(ierr);
+  ierr = DMLocalToGlobalEnd(dm, locD, ADD_VALUES, D);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(dm, &locD);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexMFFESetState_Private"
+/* Records the state at which the MATMFFE matrix J applies the Jacobian */
+static PetscErrorCode DMPlexMFFESetState_Private(Mat J, DMPlex_MFFE *mf, PetscReal t, PetscReal X_tShift, Vec X, Vec X_t, void *user)
+{
+  DM             dm;
+  PetscDS        prob;
+  PetscInt       Nf, f, g;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* The action only integrates the cells, so refuse the terms it would silently drop */
+  ierr = MatGetDM(J, &dm);CHKERRQ(ierr);
+  ierr = DMGetDS(dm, &prob);CHKERRQ(ierr);
+  ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+  for (f = 0; f < Nf; ++f) {
+    PetscObject  obj;
+    PetscClassId id;
+
+    ierr = PetscDSGetDiscretization(prob, f, &obj);CHKERRQ(ierr);
+    ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+    if (id == PETSCFV_CLASSID) SETERRQ1(PetscObjectComm((PetscObject) J), PETSC_ERR_SUP, "MATMFFE does not support the finite volume field %D", f);
+    for (g = 0; g < Nf; ++g) {
+      void (*g0)(PetscInt, PetscInt, PetscInt, const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], PetscReal, PetscReal, const PetscReal[], const PetscReal[], PetscScalar[]);
+      void (*g1)(PetscInt, PetscInt, PetscInt, const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], PetscReal, PetscReal, const PetscReal[], const PetscReal[], PetscScalar[]);
+      void (*g2)(PetscInt, PetscInt, PetscInt, const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], PetscReal, PetscReal, const PetscReal[], const PetscReal[], PetscScalar[]);
+      void (*g3)(PetscInt, PetscInt, PetscInt, const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], const PetscInt[], const PetscInt[], const PetscScalar[], const PetscScalar[], const PetscScalar[], PetscReal, PetscReal, const PetscReal[], const PetscReal[], PetscScalar[]);
+
+      ierr = PetscDSGetBdJacobian(prob, f, g, &g0, &g1, &g2, &g3);CHKERRQ(ierr);
+      if (g0 || g1 || g2 || g3) SETERRQ2(PetscObjectComm((PetscObject) J), PETSC_ERR_SUP, "MATMFFE does not apply boundary Jacobians, but fields (%D, %D) have one", f, g);
+    }
+  }
+  if (!mf->X) {ierr = VecDuplicate(X, &mf->X);CHKERRQ(ierr);}
+  ierr = VecCopy(X, mf->X);CHKERRQ(ierr);
+  if (X_t) {
+    if (!mf->X_t) {ierr = VecDuplicate(X_t, &mf->X_t);CHKERRQ(ierr);}
+    ierr = VecCopy(X_t, mf->X_t);CHKERRQ(ierr);
+  } else {
+    ierr = VecDestroy(&mf->X_t);CHKERRQ(ierr);
+  }
+  mf->t     = t;
+  mf->shift = X_tShift;
+  mf->user  = user;
+  ierr = MatShellSetOperation(J, MATOP_MULT, (void (*)(void)) MatMult_Plex_MFFE);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(J, MATOP_GET_DIAGONAL, (void (*)(void)) MatGetDiagonal_Plex_MFFE);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(J, MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(J, MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexComputeJacobian_Internal"
 PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt cEnd, PetscReal t, PetscReal X_tShift, Vec X, Vec X_t, Mat Jac, Mat JacP,void *user)
@@ -2025,9 +2244,11 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
   PetscSection      section, globalSection, subSection, sectionAux;
   PetscFECellGeom  *cgeom = NULL;
   PetscScalar      *cgeomScal;
+  DMPlex_AssemblyColoring *coloring = NULL;
   PetscScalar      *elemMat, *elemMatP, *elemMatD, *u, *u_t, *a = NULL;
   PetscInt          dim, Nf, f, fieldI, fieldJ, numCells, c;
   PetscInt          totDim, totDimBd, totDimAux, numBd, bd;
+  DMPlex_MFFE      *mfJac, *mfJacP;
   PetscBool         isMatIS, isMatISP, isShell, hasJac, hasPrec, hasDyn, hasFV = PETSC_FALSE;
   PetscErrorCode    ierr;
 
@@ -2049,6 +2270,18 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
   hasDyn = hasDyn && (X_tShift != 0.0) ? PETSC_TRUE : PETSC_FALSE;
   ierr = PetscSectionGetNumFields(section, &Nf);CHKERRQ(ierr);
   numCells = cEnd - cStart;
+  /* Matrix-free operators only record the state at which they apply the Jacobian */
+  ierr = DMPlexGetMFFE_Internal(Jac, &mfJac);CHKERRQ(ierr);
+  ierr = DMPlexGetMFFE_Internal(JacP, &mfJacP);CHKERRQ(ierr);
+  if (mfJac) {ierr = DMPlexMFFESetState_Private(Jac, mfJac, t, X_tShift, X, X_t, user);CHKERRQ(ierr);}
+  if (mfJacP) {
+    if (!mfJac) SETERRQ(PetscObjectComm((PetscObject) dm), PETSC_ERR_SUP, "A matrix-free preconditioner requires a matrix-free operator");
+    if (JacP != Jac) {ierr = DMPlexMFFESetState_Private(JacP, mfJacP, t, X_tShift, X, X_t, user);CHKERRQ(ierr);}
+    ierr = PetscLogEventEnd(DMPLEX_JacobianFEM,dm,0,0,0);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  /* Only the preconditioner is assembled */
+  if (mfJac && hasPrec) hasJac = PETSC_FALSE;
   ierr = PetscObjectQuery((PetscObject) dm, "dmAux", (PetscObject *) &dmAux);CHKERRQ(ierr);
   ierr = PetscObjectQuery((PetscObject) dm, "A", (PetscObject *) &A);CHKERRQ(ierr);
   if (dmAux) {
@@ -2057,6 +2290,26 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
     ierr = DMGetDS(dmAux, &probAux);CHKERRQ(ierr);
     ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
   }
+  /* Thread the cell loop if the element matrices can be added directly into assembled MATSEQAIJ matrices */
+  if (!isMatISP && mesh->printFEM <= 1) {
+    PetscBool isSeqAIJ, assembled, isFE = PETSC_TRUE;
+
+    for (f = 0; f < Nf; ++f) {
+      PetscObject  obj;
+      PetscClassId id;
+
+      ierr = PetscDSGetDiscretization(prob, f, &obj);CHKERRQ(ierr);
+      ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+      if (id != PETSCFE_CLASSID) isFE = PETSC_FALSE;
+    }
+    ierr = PetscObjectTypeCompare((PetscObject) JacP, MATSEQAIJ, &isSeqAIJ);CHKERRQ(ierr);
+    ierr = MatAssembled(JacP, &assembled);CHKERRQ(ierr);
+    if (hasJac && hasPrec && isSeqAIJ && assembled) {
+      ierr = PetscObjectTypeCompare((PetscObject) Jac, MATSEQAIJ, &isSeqAIJ);CHKERRQ(ierr);
+      ierr = MatAssembled(Jac, &assembled);CHKERRQ(ierr);
+    }
+    if (isFE && isSeqAIJ && assembled) {ierr = DMPlexGetAssemblyColoring_Internal(dm, cStart, cEnd, &coloring);CHKERRQ(ierr);}
+  }
   ierr = MatZeroEntries(JacP);CHKERRQ(ierr);
   ierr = PetscMalloc5(numCells*totDim,&u,X_t ? numCells*totDim : 0,&u_t,hasJac ? numCells*totDim*totDim : 0,&elemMat,hasPrec ? numCells*totDim*totDim : 0, &elemMatP,hasDyn ? numCells*totDim*totDim : 0, &elemMatD);CHKERRQ(ierr);
   if (dmAux) {ierr = PetscMalloc1(numCells*totDimAux, &a);CHKERRQ(ierr);}
@@ -2121,6 +2374,12 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
     Nr        = numCells % (numBatches*batchSize);
     offset    = numCells - Nr;
     for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
+      if (coloring) {
+        if (hasJac)  {ierr = DMPlexIntegrateJacobianThreaded_Internal(coloring, fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, numCells, cgeom, u, u_t, probAux, a, t, X_tShift, elemMat);CHKERRQ(ierr);}
+        if (hasPrec) {ierr = DMPlexIntegrateJacobianThreaded_Internal(coloring, fe, prob, PETSCFE_JACOBIAN_PRE, fieldI, fieldJ, numCells, cgeom, u, u_t, probAux, a, t, X_tShift, elemMatP);CHKERRQ(ierr);}
+        if (hasDyn)  {ierr = DMPlexIntegrateJacobianThreaded_Internal(coloring, fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, fieldJ, numCells, cgeom, u, u_t, probAux, a, t, X_tShift, elemMatD);CHKERRQ(ierr);}
+        continue;
+      }
       if (hasJac) {
         ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, Ne, cgeom, u, u_t, probAux, a, t, X_tShift, elemMat);CHKERRQ(ierr);
         ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, Nr, &cgeom[offset], &u[offset*totDim], u_t ? &u_t[offset*totDim] : NULL, probAux, &a[offset*totDimAux], t, X_tShift, &elemMat[offset*totDim*totDim]);CHKERRQ(ierr);
@@ -2135,7 +2394,7 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
       }
     }
   }
-  if (hasDyn) {
+  if (hasDyn && hasJac) {
     for (c = 0; c < (cEnd - cStart)*totDim*totDim; ++c) elemMat[c] += X_tShift*elemMatD[c];
   }
   if (hasFV) {
@@ -2173,37 +2432,42 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
   if (isMatIS && !subSection) {
     ierr = DMPlexGetSubdomainSection(dm, &subSection);CHKERRQ(ierr);
   }
-  for (c = cStart; c < cEnd; ++c) {
-    if (hasPrec) {
-      if (hasJac) {
-        if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
-        if (!isMatIS) {
-          ierr = DMPlexMatSetClosure(dm, section, globalSection, Jac, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+  if (coloring) {
+    if (hasPrec && hasJac) {ierr = DMPlexMatSetClosureColored_Internal(dm, coloring, globalSection, Jac, elemMat);CHKERRQ(ierr);}
+    ierr = DMPlexMatSetClosureColored_Internal(dm, coloring, globalSection, JacP, hasPrec ? elemMatP : elemMat);CHKERRQ(ierr);
+  } else {
+    for (c = cStart; c < cEnd; ++c) {
+      if (hasPrec) {
+        if (hasJac) {
+          if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
+          if (!isMatIS) {
+            ierr = DMPlexMatSetClosure(dm, section, globalSection, Jac, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+          } else {
+            Mat lJ;
+
+            ierr = MatISGetLocalMat(Jac,&lJ);CHKERRQ(ierr);
+            ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+          }
+        }
+        if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMatP[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
+        if (!isMatISP) {
+          ierr = DMPlexMatSetClosure(dm, section, globalSection, JacP, c, &elemMatP[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
         } else {
           Mat lJ;
 
-          ierr = MatISGetLocalMat(Jac,&lJ);CHKERRQ(ierr);
-          ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+          ierr = MatISGetLocalMat(JacP,&lJ);CHKERRQ(ierr);
+          ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMatP[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
         }
-      }
-      if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMatP[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
-      if (!isMatISP) {
-        ierr = DMPlexMatSetClosure(dm, section, globalSection, JacP, c, &elemMatP[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
       } else {
-        Mat lJ;
-
-        ierr = MatISGetLocalMat(JacP,&lJ);CHKERRQ(ierr);
-        ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMatP[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
-      }
-    } else {
-      if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
-      if (!isMatISP) {
-        ierr = DMPlexMatSetClosure(dm, section, globalSection, JacP, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
-      } else {
-        Mat lJ;
+        if (mesh->printFEM > 1) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);}
+        if (!isMatISP) {
+          ierr = DMPlexMatSetClosure(dm, section, globalSection, JacP, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+        } else {
+          Mat lJ;
 
-        ierr = MatISGetLocalMat(JacP,&lJ);CHKERRQ(ierr);
-        ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+          ierr = MatISGetLocalMat(JacP,&lJ);CHKERRQ(ierr);
+          ierr = DMPlexMatSetClosure(dm, section, subSection, lJ, c, &elemMat[(c-cStart)*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+        }
       }
     }
   }
@@ -2331,7 +2595,7 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
   }
   ierr = PetscLogEventEnd(DMPLEX_JacobianFEM,dm,0,0,0);CHKERRQ(ierr);
   ierr = PetscObjectTypeCompare((PetscObject) Jac, MATSHELL, &isShell);CHKERRQ(ierr);
-  if (isShell) {
+  if (isShell && !mfJac) {
     JacActionCtx *jctx;
 
     ierr = MatShellGetContext(Jac, &jctx);CHKERRQ(ierr);
@@ -2343,6 +2607,8 @@ PetscErrorCode DMPlexComputeJacobian_Internal(DM dm, PetscInt cStart, PetscInt c
 
 #undef __FUNCT__
 #define __FUNCT__ "DMPlexComputeJacobianAction_Internal"
+/* Adds Z = J Y over the cells, with PetscFEIntegrateJacobianAction() when every field provides it and otherwise with the
+   element matrices of a bounded number of cells at a time */
 PetscErrorCode DMPlexComputeJacobianAction_Internal(DM dm, PetscInt cStart, PetscInt cEnd, PetscReal t, PetscReal X_tShift, Vec X, Vec X_t, Vec Y, Vec Z, void *user)
 {
   DM_Plex          *mesh  = (DM_Plex *) dm->data;
@@ -2350,14 +2616,13 @@ PetscErrorCode DMPlexComputeJacobianAction_Internal(DM dm, PetscInt cStart, Pets
   DM                dmAux, plex;
   Vec               A, cellgeom;
   PetscDS           prob, probAux = NULL;
-  PetscQuadrature   quad;
   PetscSection      section, globalSection, sectionAux;
   PetscFECellGeom  *cgeom = NULL;
   PetscScalar      *cgeomScal;
-  PetscScalar      *elemMat, *elemMatD, *u, *u_t, *a = NULL, *y, *z;
-  PetscInt          dim, Nf, fieldI, fieldJ, numCells, c;
+  PetscScalar      *elemMat = NULL, *elemMatD = NULL, *elemVec = NULL, *elemVecD = NULL, *u, *u_t, *a = NULL, *y, *z;
+  PetscInt          dim, Nf, fieldI, fieldJ, numCells, chunk, c0, c;
   PetscInt          totDim, totDimBd, totDimAux = 0;
-  PetscBool         hasDyn;
+  PetscBool         hasDyn, useAction = PETSC_TRUE;
   PetscErrorCode    ierr;
 
   PetscFunctionBegin;
@@ -2381,9 +2646,22 @@ PetscErrorCode DMPlexComputeJacobianAction_Internal(DM dm, PetscInt cStart, Pets
     ierr = DMGetDS(dmAux, &probAux);CHKERRQ(ierr);
     ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);
   }
+  /* If every discretization can apply its Jacobian pointwise, the element matrices are never formed */
+  for (fieldI = 0; fieldI < Nf; ++fieldI) {
+    PetscObject  obj;
+    PetscClassId id;
+
+    ierr = PetscDSGetDiscretization(prob, fieldI, &obj);CHKERRQ(ierr);
+    ierr = PetscObjectGetClassId(obj, &id);CHKERRQ(ierr);
+    if (id != PETSCFE_CLASSID || !((PetscFE) obj)->ops->integratejacobianaction) useAction = PETSC_FALSE;
+  }
+  /* The element matrices, when they must be formed, are bounded to about 2^18 values as for the diagonal */
+  chunk = useAction ? PetscMax(1, numCells) : PetscMax(1, PetscMin(numCells, 262144/(totDim*totDim)));
   ierr = VecSet(Z, 0.0);CHKERRQ(ierr);
-  ierr = PetscMalloc6(numCells*totDim,&u,X_t ? numCells*totDim : 0,&u_t,numCells*totDim*totDim,&elemMat,hasDyn ? numCells*totDim*totDim : 0, &elemMatD,numCells*totDim,&y,totDim,&z);CHKERRQ(ierr);
-  if (dmAux) {ierr = PetscMalloc1(numCells*totDimAux, &a);CHKERRQ(ierr);}
+  ierr = PetscMalloc4(chunk*totDim,&u,X_t ? chunk*totDim : 0,&u_t,chunk*totDim,&y,totDim,&z);CHKERRQ(ierr);
+  if (useAction) {ierr = PetscMalloc2(chunk*totDim,&elemVec,hasDyn ? chunk*totDim : 0,&elemVecD);CHKERRQ(ierr);}
+  else           {ierr = PetscMalloc2(chunk*totDim*totDim,&elemMat,hasDyn ? chunk*totDim*totDim : 0,&elemMatD);CHKERRQ(ierr);}
+  if (dmAux) {ierr = PetscMalloc1(chunk*totDimAux, &a);CHKERRQ(ierr);}
   ierr = DMPlexSNESGetGeometryFEM(dm, &cellgeom);CHKERRQ(ierr);
   ierr = VecGetArray(cellgeom, &cgeomScal);CHKERRQ(ierr);
   if (sizeof(PetscFECellGeom) % sizeof(PetscScalar)) {
@@ -2400,77 +2678,76 @@ PetscErrorCode DMPlexComputeJacobianAction_Internal(DM dm, PetscInt cStart, Pets
   } else {
     cgeom = (PetscFECellGeom *) cgeomScal;
   }
-  for (c = cStart; c < cEnd; ++c) {
-    PetscScalar *x = NULL,  *x_t = NULL;
-    PetscInt     i;
+  for (c0 = cStart; c0 < cEnd; c0 += chunk) {
+    const PetscInt Ne = PetscMin(chunk, cEnd - c0);
 
-    ierr = DMPlexVecGetClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
-    for (i = 0; i < totDim; ++i) u[(c-cStart)*totDim+i] = x[i];
-    ierr = DMPlexVecRestoreClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
-    if (X_t) {
-      ierr = DMPlexVecGetClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
-      for (i = 0; i < totDim; ++i) u_t[(c-cStart)*totDim+i] = x_t[i];
-      ierr = DMPlexVecRestoreClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
+    for (c = c0; c < c0+Ne; ++c) {
+      PetscScalar *x = NULL,  *x_t = NULL;
+      PetscInt     i;
+
+      ierr = DMPlexVecGetClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
+      for (i = 0; i < totDim; ++i) u[(c-c0)*totDim+i] = x[i];
+      ierr = DMPlexVecRestoreClosure(dm, section, X, c, NULL, &x);CHKERRQ(ierr);
+      if (X_t) {
+        ierr = DMPlexVecGetClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
+        for (i = 0; i < totDim; ++i) u_t[(c-c0)*totDim+i] = x_t[i];
+        ierr = DMPlexVecRestoreClosure(dm, section, X_t, c, NULL, &x_t);CHKERRQ(ierr);
+      }
+      if (dmAux) {
+        ierr = DMPlexVecGetClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
+        for (i = 0; i < totDimAux; ++i) a[(c-c0)*totDimAux+i] = x[i];
+        ierr = DMPlexVecRestoreClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
+      }
+      ierr = DMPlexVecGetClosure(dm, section, Y, c, NULL, &x);CHKERRQ(ierr);
+      for (i = 0; i < totDim; ++i) y[(c-c0)*totDim+i] = x[i];
+      ierr = DMPlexVecRestoreClosure(dm, section, Y, c, NULL, &x);CHKERRQ(ierr);
     }
-    if (dmAux) {
-      ierr = DMPlexVecGetClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
-      for (i = 0; i < totDimAux; ++i) a[(c-cStart)*totDimAux+i] = x[i];
-      ierr = DMPlexVecRestoreClosure(plex, sectionAux, A, c, NULL, &x);CHKERRQ(ierr);
+    if (useAction) {
+      ierr = PetscMemzero(elemVec, Ne*totDim * sizeof(PetscScalar));CHKERRQ(ierr);
+      if (hasDyn) {ierr = PetscMemzero(elemVecD, Ne*totDim * sizeof(PetscScalar));CHKERRQ(ierr);}
+    } else {
+      ierr = PetscMemzero(elemMat, Ne*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);
+      if (hasDyn) {ierr = PetscMemzero(elemMatD, Ne*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);}
     }
-    ierr = DMPlexVecGetClosure(dm, section, Y, c, NULL, &x);CHKERRQ(ierr);
-    for (i = 0; i < totDim; ++i) y[(c-cStart)*totDim+i] = x[i];
-    ierr = DMPlexVecRestoreClosure(dm, section, Y, c, NULL, &x);CHKERRQ(ierr);
-  }
-  ierr = PetscMemzero(elemMat, numCells*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);
-  if (hasDyn)  {ierr = PetscMemzero(elemMatD, numCells*totDim*totDim * sizeof(PetscScalar));CHKERRQ(ierr);}
-  for (fieldI = 0; fieldI < Nf; ++fieldI) {
-    PetscFE  fe;
-    PetscInt numQuadPoints, Nb;
-    /* Conforming batches */
-    PetscInt numChunks, numBatches, numBlocks, Ne, blockSize, batchSize;
-    /* Remainder */
-    PetscInt Nr, offset;
+    for (fieldI = 0; fieldI < Nf; ++fieldI) {
+      PetscFE fe;
 
-    ierr = PetscDSGetDiscretization(prob, fieldI, (PetscObject *) &fe);CHKERRQ(ierr);
-    ierr = PetscFEGetQuadrature(fe, &quad);CHKERRQ(ierr);
-    ierr = PetscFEGetDimension(fe, &Nb);CHKERRQ(ierr);
-    ierr = PetscFEGetTileSizes(fe, NULL, &numBlocks, NULL, &numBatches);CHKERRQ(ierr);
-    ierr = PetscQuadratureGetData(quad, NULL, &numQuadPoints, NULL, NULL);CHKERRQ(ierr);
-    blockSize = Nb*numQuadPoints;
-    batchSize = numBlocks * blockSize;
-    ierr = PetscFESetTileSizes(fe, blockSize, numBlocks, batchSize, numBatches);CHKERRQ(ierr);
-    numChunks = numCells / (numBatches*batchSize);
-    Ne        = numChunks*numBatches*batchSize;
-    Nr        = numCells % (numBatches*batchSize);
-    offset    = numCells - Nr;
-    for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
-      ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, Ne, cgeom, u, u_t, probAux, a, t, X_tShift, elemMat);CHKERRQ(ierr);
-      ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, Nr, &cgeom[offset], &u[offset*totDim], u_t ? &u_t[offset*totDim] : NULL, probAux, &a[offset*totDimAux], t, X_tShift, &elemMat[offset*totDim*totDim]);CHKERRQ(ierr);
-      if (hasDyn) {
-        ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, fieldJ, Ne, cgeom, u, u_t, probAux, a, t, X_tShift, elemMatD);CHKERRQ(ierr);
-        ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, fieldJ, Nr, &cgeom[offset], &u[offset*totDim], u_t ? &u_t[offset*totDim] : NULL, probAux, &a[offset*totDimAux], t, X_tShift, &elemMatD[offset*totDim*totDim]);CHKERRQ(ierr);
+      ierr = PetscDSGetDiscretization(prob, fieldI, (PetscObject *) &fe);CHKERRQ(ierr);
+      if (useAction) {
+        ierr = PetscFEIntegrateJacobianAction(fe, prob, PETSCFE_JACOBIAN, fieldI, Ne, &cgeom[c0-cStart], u, u_t, y, probAux, a, t, X_tShift, elemVec);CHKERRQ(ierr);
+        if (hasDyn) {ierr = PetscFEIntegrateJacobianAction(fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, Ne, &cgeom[c0-cStart], u, u_t, y, probAux, a, t, X_tShift, elemVecD);CHKERRQ(ierr);}
+        continue;
+      }
+      for (fieldJ = 0; fieldJ < Nf; ++fieldJ) {
+        ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN, fieldI, fieldJ, Ne, &cgeom[c0-cStart], u, u_t, probAux, a, t, X_tShift, elemMat);CHKERRQ(ierr);
+        if (hasDyn) {ierr = PetscFEIntegrateJacobian(fe, prob, PETSCFE_JACOBIAN_DYN, fieldI, fieldJ, Ne, &cgeom[c0-cStart], u, u_t, probAux, a, t, X_tShift, elemMatD);CHKERRQ(ierr);}
       }
     }
-  }
-  if (hasDyn) {
-    for (c = 0; c < (cEnd - cStart)*totDim*totDim; ++c) elemMat[c] += X_tShift*elemMatD[c];
-  }
-  for (c = cStart; c < cEnd; ++c) {
-    const PetscBLASInt M = totDim, one = 1;
-    const PetscScalar  a = 1.0, b = 0.0;
-
-    PetscStackCallBLAS("BLASgemv", BLASgemv_("N", &M, &M, &a, &elemMat[(c-cStart)*totDim*totDim], &M, &y[(c-cStart)*totDim], &one, &b, z, &one));
-    if (mesh->printFEM > 1) {
-      ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-cStart)*totDim*totDim]);CHKERRQ(ierr);
-      ierr = DMPrintCellVector(c, "Y",  totDim, &y[(c-cStart)*totDim]);CHKERRQ(ierr);
-      ierr = DMPrintCellVector(c, "Z",  totDim, z);CHKERRQ(ierr);
+    if (hasDyn && useAction) {
+      for (c = 0; c < Ne*totDim; ++c) elemVec[c] += X_tShift*elemVecD[c];
+    } else if (hasDyn) {
+      for (c = 0; c < Ne*totDim*totDim; ++c) elemMat[c] += X_tShift*elemMatD[c];
+    }
+    for (c = c0; c < c0+Ne; ++c) {
+      const PetscBLASInt M = totDim, one = 1;
+      const PetscScalar  a = 1.0, b = 0.0;
+
+      if (useAction) {ierr = PetscMemcpy(z, &elemVec[(c-c0)*totDim], totDim * sizeof(PetscScalar));CHKERRQ(ierr);}
+      else PetscStackCallBLAS("BLASgemv", BLASgemv_("T", &M, &M, &a, &elemMat[(c-c0)*totDim*totDim], &M, &y[(c-c0)*totDim], &one, &b, z, &one));
+      if (mesh->printFEM > 1) {
+        if (!useAction) {ierr = DMPrintCellMatrix(c, name, totDim, totDim, &elemMat[(c-c0)*totDim*totDim]);CHKERRQ(ierr);}
+        ierr = DMPrintCellVector(c, "Y",  totDim, &y[(c-c0)*totDim]);CHKERRQ(ierr);
+        ierr = DMPrintCellVector(c, "Z",  totDim, z);CHKERRQ(ierr);
+      }
+      ierr = DMPlexVecSetClosure(dm, section, Z, c, z, ADD_VALUES);CHKERRQ(ierr);
     }
-    ierr = DMPlexVecSetClosure(dm, section, Z, c, z, ADD_VALUES);CHKERRQ(ierr);
   }
   if (sizeof(PetscFECellGeom) % sizeof(PetscScalar)) {ierr = PetscFree(cgeom);CHKERRQ(ierr);}
   else                                               {cgeom = NULL;}
   ierr = VecRestoreArray(cellgeom, &cgeomScal);CHKERRQ(ierr);
-  ierr = PetscFree6(u,u_t,elemMat,elemMatD,y,z);CHKERRQ(ierr);
+  ierr = PetscFree4(u,u_t,y,z);CHKERRQ(ierr);
+  ierr = PetscFree2(elemMat,elemMatD);CHKERRQ(ierr);
+  ierr = PetscFree2(elemVec,elemVecD);CHKERRQ(ierr);
   if (dmAux) {
     ierr = PetscFree(a);CHKERRQ(ierr);
     ierr = DMDestroy(&plex);CHKERRQ(ierr);
@@ -0,0 +1,503 @@
+/*
+   Threaded assembly of the interior cells for DMPlexComputeResidual_Internal() and DMPlexComputeJacobian_Internal(),
+   selected with DMPlexSetAssemblyThreads(). The cells are colored once so that no two cells of one color share a
+   mesh point with unknowns. The element integrals of contiguous chunks of cells are computed by the threads at once,
+   each with its own copy of the PetscDS since its work arrays are used by the integration, and the element vectors
+   (matrices) of one color are added by all threads at once since they touch disjoint entries.
+*/
+#include <petsc/private/dmpleximpl.h>   /*I "petscdmplex.h" I*/
+#include <petsc/private/isimpl.h>
+#include <petsc/private/petscfeimpl.h>
+#include <petscds.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexAssemblyColoringDestroyDS_Private"
+static PetscErrorCode DMPlexAssemblyColoringDestroyDS_Private(DMPlex_AssemblyColoring *col)
+{
+  PetscInt       t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (t = 0; t < col->ndsthreads; ++t) {
+    if (col->ds)    {ierr = PetscDSDestroy(&col->ds[t]);CHKERRQ(ierr);}
+    if (col->dsAux) {ierr = PetscDSDestroy(&col->dsAux[t]);CHKERRQ(ierr);}
+  }
+  ierr = PetscFree(col->ds);CHKERRQ(ierr);
+  ierr = PetscFree(col->dsAux);CHKERRQ(ierr);
+  col->prob       = NULL;
+  col->probAux    = NULL;
+  col->ndsthreads = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexAssemblyColoringDestroy_Private"
+static PetscErrorCode DMPlexAssemblyColoringDestroy_Private(void *ctx)
+{
+  DMPlex_AssemblyColoring *col = (DMPlex_AssemblyColoring *) ctx;
+  PetscErrorCode           ierr;
+
+  PetscFunctionBegin;
+  ierr = DMPlexAssemblyColoringDestroyDS_Private(col);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&col->section);CHKERRQ(ierr);
+  ierr = PetscSectionDestroy(&col->globalSection);CHKERRQ(ierr);
+  ierr = PetscFree(col->lidx);CHKERRQ(ierr);
+  ierr = PetscFree(col->gidx);CHKERRQ(ierr);
+  ierr = PetscFree2(col->color, col->cells);CHKERRQ(ierr);
+  ierr = PetscFree(col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetClosureIndices_Private"
+/* The indices of the closure of cell into the offsets of section, or into the offsets of globalSection if given; the closure
+   has the points in the section chart, in the order of DMPlexVecGetClosure() and DMPlexMatSetClosure() */
+static PetscErrorCode DMPlexGetClosureIndices_Private(DM dm, PetscSection section, PetscSection globalSection, PetscInt cell, PetscInt *numIndices, PetscInt indices[])
+{
+  PetscInt      *points = NULL;
+  PetscInt       offsets[32];
+  PetscInt       Nf, numPoints, pStart, pEnd, Nind = 0, off = 0, p, f;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSectionGetNumFields(section, &Nf);CHKERRQ(ierr);
+  if (Nf > 31) SETERRQ1(PetscObjectComm((PetscObject) dm), PETSC_ERR_ARG_OUTOFRANGE, "Number of fields %D limited to 31", Nf);
+  ierr = PetscMemzero(offsets, 32 * sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscSectionGetChart(section, &pStart, &pEnd);CHKERRQ(ierr);
+  ierr = DMPlexGetTransitiveClosure(dm, cell, PETSC_TRUE, &numPoints, &points);CHKERRQ(ierr);
+  for (p = 0; p < numPoints*2; p += 2) {
+    PetscInt dof, fdof;
+
+    if ((points[p] < pStart) || (points[p] >= pEnd)) continue;
+    ierr = PetscSectionGetDof(section, points[p], &dof);CHKERRQ(ierr);
+    for (f = 0; f < Nf; ++f) {
+      ierr = PetscSectionGetFieldDof(section, points[p], f, &fdof);CHKERRQ(ierr);
+      offsets[f+1] += fdof;
+    }
+    Nind += dof;
+  }
+  for (f = 1; f < Nf; ++f) offsets[f+1] += offsets[f];
+  if (indices) {
+    for (p = 0; p < numPoints*2; p += 2) {
+      PetscInt pOff;
+
+      if ((points[p] < pStart) || (points[p] >= pEnd)) continue;
+      if (globalSection) {
+        ierr = PetscSectionGetOffset(globalSection, points[p], &pOff);CHKERRQ(ierr);
+        pOff = pOff < 0 ? -(pOff+1) : pOff;
+      } else {
+        ierr = PetscSectionGetOffset(section, points[p], &pOff);CHKERRQ(ierr);
+      }
+      /* the local indices include the constrained unknowns, as ADD_ALL_VALUES does */
+      if (Nf) {ierr = DMPlexGetIndicesPointFields_Internal(section, points[p], pOff, offsets, globalSection ? PETSC_FALSE : PETSC_TRUE, points[p+1], indices);CHKERRQ(ierr);}
+      else    {ierr = DMPlexGetIndicesPoint_Internal(section, points[p], pOff, &off, globalSection ? PETSC_FALSE : PETSC_TRUE, points[p+1], indices);CHKERRQ(ierr);}
+    }
+  }
+  ierr = DMPlexRestoreTransitiveClosure(dm, cell, PETSC_TRUE, &numPoints, &points);CHKERRQ(ierr);
+  *numIndices = Nind;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexAssemblyColoringSetUp_Private"
+/* Computes the local closure indices of the cells and colors the cells with MatColoringApply() of MATCOLORINGGREEDY on the
+   graph of cells sharing a mesh point with unknowns; totDim is set to -1 if the closures do not all have the same size */
+static PetscErrorCode DMPlexAssemblyColoringSetUp_Private(DM dm, PetscSection section, PetscInt cStart, PetscInt cEnd, DMPlex_AssemblyColoring *col)
+{
+  const PetscInt  numCells = cEnd - cStart;
+  Mat             C, G;
+  MatColoring     mc;
+  ISColoring      iscoloring;
+  IS             *is;
+  PetscScalar    *ones;
+  const PetscInt *idx;
+  PetscInt       *ci, *cj, *points = NULL;
+  PetscInt        pStart, pEnd, numPoints, nc, c, k, p, cnt, ncells, Nind;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectReference((PetscObject) section);CHKERRQ(ierr);
+  col->section = section;
+  col->cStart  = cStart;
+  col->cEnd    = cEnd;
+  col->totDim  = -1;
+  if (!numCells) PetscFunctionReturn(0);
+  ierr = DMPlexGetClosureIndices_Private(dm, section, NULL, cStart, &col->totDim, NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc1(numCells*col->totDim, &col->lidx);CHKERRQ(ierr);
+  for (c = cStart; c < cEnd; ++c) {
+    ierr = DMPlexGetClosureIndices_Private(dm, section, NULL, c, &Nind, NULL);CHKERRQ(ierr);
+    if (Nind != col->totDim) {
+      ierr = PetscInfo4(dm, "Cell %D has %D closure unknowns, cell %D has %D, the FEM assembly is not threaded\n", c, Nind, cStart, col->totDim);CHKERRQ(ierr);
+      ierr = PetscFree(col->lidx);CHKERRQ(ierr);
+      col->totDim = -1;
+      PetscFunctionReturn(0);
+    }
+    ierr = DMPlexGetClosureIndices_Private(dm, section, NULL, c, &Nind, &col->lidx[(c-cStart)*col->totDim]);CHKERRQ(ierr);
+  }
+
+  /* the incidence of cells and the points with unknowns in their closure, C C^T is the graph of conflicting cells */
+  ierr = PetscSectionGetChart(section, &pStart, &pEnd);CHKERRQ(ierr);
+  ierr = PetscMalloc1(numCells+1, &ci);CHKERRQ(ierr);
+  for (c = cStart, ci[0] = 0; c < cEnd; ++c) {
+    ierr = DMPlexGetTransitiveClosure(dm, c, PETSC_TRUE, &numPoints, &points);CHKERRQ(ierr);
+    for (p = 0, cnt = 0; p < numPoints*2; p += 2) {
+      PetscInt dof;
+
+      if ((points[p] < pStart) || (points[p] >= pEnd)) continue;
+      ierr = PetscSectionGetDof(section, points[p], &dof);CHKERRQ(ierr);
+      if (dof) ++cnt;
+    }
+    ci[c-cStart+1] = ci[c-cStart] + cnt;
+  }
+  ierr = PetscMalloc2(ci[numCells], &cj, ci[numCells], &ones);CHKERRQ(ierr);
+  for (c = cStart; c < cEnd; ++c) {
+    ierr = DMPlexGetTransitiveClosure(dm, c, PETSC_TRUE, &numPoints, &points);CHKERRQ(ierr);
+    for (p = 0, cnt = ci[c-cStart]; p < numPoints*2; p += 2) {
+      PetscInt dof;
+
+      if ((points[p] < pStart) || (points[p] >= pEnd)) continue;
+      ierr = PetscSectionGetDof(section, points[p], &dof);CHKERRQ(ierr);
+      if (dof) {cj[cnt] = points[p] - pStart; ones[cnt] = 1.0; ++cnt;}
+    }
+    ierr = PetscSortInt(cnt - ci[c-cStart], &cj[ci[c-cStart]]);CHKERRQ(ierr);
+  }
+  ierr = DMPlexRestoreTransitiveClosure(dm, cEnd-1, PETSC_TRUE, &numPoints, &points);CHKERRQ(ierr);
+  ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF, numCells, pEnd-pStart, ci, cj, ones, &C);CHKERRQ(ierr);
+  ierr = MatMatTransposeMult(C, C, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &G);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = PetscFree(ci);CHKERRQ(ierr);
+  ierr = PetscFree2(cj, ones);CHKERRQ(ierr);
+
+  ierr = MatColoringCreate(G, &mc);CHKERRQ(ierr);
+  ierr = MatColoringSetDistance(mc, 1);CHKERRQ(ierr);
+  ierr = MatColoringSetType(mc, MATCOLORINGGREEDY);CHKERRQ(ierr);
+  ierr = MatColoringApply(mc, &iscoloring);CHKERRQ(ierr);
+  ierr = MatColoringDestroy(&mc);CHKERRQ(ierr);
+  ierr = MatDestroy(&G);CHKERRQ(ierr);
+
+  ierr = ISColoringGetIS(iscoloring, &nc, &is);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nc+1, &col->color, numCells, &col->cells);CHKERRQ(ierr);
+  col->color[0] = 0;
+  for (k = 0, cnt = 0; k < nc; ++k) {
+    ierr = ISGetLocalSize(is[k], &ncells);CHKERRQ(ierr);
+    if (!ncells) continue;
+    ierr = ISGetIndices(is[k], &idx);CHKERRQ(ierr);
+    for (c = 0; c < ncells; ++c) col->cells[col->color[cnt]+c] = idx[c] + cStart;
+    ierr = ISRestoreIndices(is[k], &idx);CHKERRQ(ierr);
+    ierr = PetscSortInt(ncells, col->cells+col->color[cnt]);CHKERRQ(ierr);
+    col->color[cnt+1] = col->color[cnt] + ncells;
+    ++cnt;
+  }
+  ierr = ISColoringRestoreIS(iscoloring, &is);CHKERRQ(ierr);
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+  if (col->color[cnt] != numCells) SETERRQ2(PETSC_COMM_SELF, PETSC_ERR_PLIB, "Coloring has %D cells, expected %D", col->color[cnt], numCells);
+  col->ncolors = cnt;
+  ierr = PetscInfo3(dm, "Threaded FEM assembly of %D cells uses %D colors, %g cells per color on average\n", numCells, col->ncolors, col->ncolors ? (double) numCells/col->ncolors : 0.0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexGetAssemblyColoring_Internal"
+/*
+   DMPlexGetAssemblyColoring_Internal - Gets the coloring of the cells cStart to cEnd used by the threaded FEM assembly,
+   computing it unless it is current, or NULL if the assembly is not threaded
+
+   Notes: The coloring is kept on the DM until the default section or the range of cells changes. The assembly is not
+   threaded for hanging node constraints, closure permutations or closures of different sizes.
+*/
+PetscErrorCode DMPlexGetAssemblyColoring_Internal(DM dm, PetscInt cStart, PetscInt cEnd, DMPlex_AssemblyColoring **coloring)
+{
+  DM_Plex                 *mesh = (DM_Plex *) dm->data;
+  DMPlex_AssemblyColoring *col  = NULL;
+  PetscContainer           container;
+  PetscSection             section, anchorSection;
+  const PetscInt          *perm;
+  PetscInt                 nthreads = mesh->assemblyThreads;
+  PetscErrorCode           ierr;
+
+  PetscFunctionBegin;
+  *coloring = NULL;
+  if (!nthreads) PetscFunctionReturn(0);
+  if (nthreads == PETSC_DECIDE) {
+    nthreads = 1;
+#if defined(PETSC_HAVE_OPENMP)
+    nthreads = omp_get_max_threads();
+#endif
+  }
+  ierr = DMGetDefaultSection(dm, &section);CHKERRQ(ierr);
+  ierr = DMPlexGetAnchors(dm, &anchorSection, NULL);CHKERRQ(ierr);
+  if (anchorSection) PetscFunctionReturn(0);
+  ierr = PetscSectionGetClosureInversePermutation_Internal(section, (PetscObject) dm, NULL, &perm);CHKERRQ(ierr);
+  if (perm) PetscFunctionReturn(0);
+  ierr = PetscObjectQuery((PetscObject) dm, "DMPlexAssemblyColoring", (PetscObject *) &container);CHKERRQ(ierr);
+  if (container) {
+    ierr = PetscContainerGetPointer(container, (void **) &col);CHKERRQ(ierr);
+    if (col->section != section || col->cStart != cStart || col->cEnd != cEnd) col = NULL;
+  }
+  if (!col) {
+    ierr = PetscNew(&col);CHKERRQ(ierr);
+    ierr = DMPlexAssemblyColoringSetUp_Private(dm, section, cStart, cEnd, col);CHKERRQ(ierr);
+    ierr = PetscContainerCreate(PETSC_COMM_SELF, &container);CHKERRQ(ierr);
+    ierr = PetscContainerSetPointer(container, (void *) col);CHKERRQ(ierr);
+    ierr = PetscContainerSetUserDestroy(container, DMPlexAssemblyColoringDestroy_Private);CHKERRQ(ierr);
+    ierr = PetscObjectCompose((PetscObject) dm, "DMPlexAssemblyColoring", (PetscObject) container);CHKERRQ(ierr);
+    ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+  }
+  if (col->totDim < 0) PetscFunctionReturn(0);
+  col->nthreads = nthreads;
+  *coloring     = col;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexAssemblyColoringGetDS_Private"
+/* Copies prob and probAux for each thread; the discretizations are shared and the pointwise functions are copied again
+   for every integration since they may be changed between assemblies */
+static PetscErrorCode DMPlexAssemblyColoringGetDS_Private(DMPlex_AssemblyColoring *col, PetscDS prob, PetscDS probAux)
+{
+  PetscObject    disc;
+  PetscInt       Nf, f, t;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (col->prob != prob || col->probAux != probAux || col->ndsthreads != col->nthreads) {
+    ierr = DMPlexAssemblyColoringDestroyDS_Private(col);CHKERRQ(ierr);
+    ierr = PetscCalloc1(col->nthreads, &col->ds);CHKERRQ(ierr);
+    if (probAux) {ierr = PetscCalloc1(col->nthreads, &col->dsAux);CHKERRQ(ierr);}
+    col->ndsthreads = col->nthreads;
+    for (t = 0; t < col->nthreads; ++t) {
+      ierr = PetscDSCreate(PETSC_COMM_SELF, &col->ds[t]);CHKERRQ(ierr);
+      ierr = PetscDSGetNumFields(prob, &Nf);CHKERRQ(ierr);
+      for (f = 0; f < Nf; ++f) {
+        ierr = PetscDSGetDiscretization(prob, f, &disc);CHKERRQ(ierr);
+        ierr = PetscDSSetDiscretization(col->ds[t], f, disc);CHKERRQ(ierr);
+      }
+      if (probAux) {
+        ierr = PetscDSCreate(PETSC_COMM_SELF, &col->dsAux[t]);CHKERRQ(ierr);
+        ierr = PetscDSGetNumFields(probAux, &Nf);CHKERRQ(ierr);
+        for (f = 0; f < Nf; ++f) {
+          ierr = PetscDSGetDiscretization(probAux, f, &disc);CHKERRQ(ierr);
+          ierr = PetscDSSetDiscretization(col->dsAux[t], f, disc);CHKERRQ(ierr);
+        }
+        ierr = PetscDSSetUp(col->dsAux[t]);CHKERRQ(ierr);
+      }
+    }
+    col->prob    = prob;
+    col->probAux = probAux;
+  }
+  for (t = 0; t < col->nthreads; ++t) {
+    ierr = PetscDSCopyEquations(prob, col->ds[t]);CHKERRQ(ierr);
+    ierr = PetscDSSetUp(col->ds[t]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   The function stack of PetscFunctionBegin is not thread safe, so it is switched off while the threads call the
+   integration routines; an error in a thread is returned after the threads are joined. Neither is PetscMalloc(), so
+   everything the kernels would compute on first use is computed by PetscFESetUpIntegration_Internal() before the
+   threads start, and the kernels then only use the tabulations and work arrays of the PetscDS of their thread.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexIntegrateResidualThreaded_Internal"
+/*
+   DMPlexIntegrateResidualThreaded_Internal - PetscFEIntegrateResidual() for Ne cells, with the cells divided into one
+   contiguous chunk for each thread
+*/
+PetscErrorCode DMPlexIntegrateResidualThreaded_Internal(DMPlex_AssemblyColoring *col, PetscFE fe, PetscDS prob, PetscInt field, PetscInt Ne, PetscFECellGeom *geom,
+                                                        const PetscScalar coefficients[], const PetscScalar coefficients_t[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscScalar elemVec[])
+{
+  const PetscInt  nthreads = col->nthreads;
+  PetscInt        totDim, totDimAux = 0, tid;
+  PetscErrorCode *terr, ierr;
+  PetscStack     *stack;
+
+  PetscFunctionBegin;
+  ierr = DMPlexAssemblyColoringGetDS_Private(col, prob, probAux);CHKERRQ(ierr);
+  for (tid = 0; tid < nthreads; ++tid) {ierr = PetscFESetUpIntegration_Internal(fe, col->ds[tid], probAux ? col->dsAux[tid] : NULL);CHKERRQ(ierr);}
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  if (probAux) {ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);}
+  ierr = PetscCalloc1(nthreads, &terr);CHKERRQ(ierr);
+  stack      = petscstack;
+  petscstack = NULL;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+  for (tid = 0; tid < nthreads; ++tid) {
+    const PetscInt s = (Ne*tid)/nthreads, e = (Ne*(tid+1))/nthreads;
+
+    terr[tid] = PetscFEIntegrateResidual(fe, col->ds[tid], field, e-s, &geom[s], &coefficients[s*totDim], coefficients_t ? &coefficients_t[s*totDim] : NULL,
+                                         probAux ? col->dsAux[tid] : NULL, coefficientsAux ? &coefficientsAux[s*totDimAux] : NULL, t, &elemVec[s*totDim]);
+  }
+  petscstack = stack;
+  for (tid = 0; tid < nthreads; ++tid) {ierr = terr[tid];CHKERRQ(ierr);}
+  ierr = PetscFree(terr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexIntegrateJacobianThreaded_Internal"
+/*
+   DMPlexIntegrateJacobianThreaded_Internal - PetscFEIntegrateJacobian() for Ne cells, with the cells divided into one
+   contiguous chunk for each thread
+*/
+PetscErrorCode DMPlexIntegrateJacobianThreaded_Internal(DMPlex_AssemblyColoring *col, PetscFE fe, PetscDS prob, PetscFEJacobianType jtype, PetscInt fieldI, PetscInt fieldJ, PetscInt Ne, PetscFECellGeom *geom,
+                                                        const PetscScalar coefficients[], const PetscScalar coefficients_t[], PetscDS probAux, const PetscScalar coefficientsAux[], PetscReal t, PetscReal u_tshift, PetscScalar elemMat[])
+{
+  const PetscInt  nthreads = col->nthreads;
+  PetscInt        totDim, totDimAux = 0, tid;
+  PetscErrorCode *terr, ierr;
+  PetscStack     *stack;
+
+  PetscFunctionBegin;
+  ierr = DMPlexAssemblyColoringGetDS_Private(col, prob, probAux);CHKERRQ(ierr);
+  for (tid = 0; tid < nthreads; ++tid) {ierr = PetscFESetUpIntegration_Internal(fe, col->ds[tid], probAux ? col->dsAux[tid] : NULL);CHKERRQ(ierr);}
+  ierr = PetscDSGetTotalDimension(prob, &totDim);CHKERRQ(ierr);
+  if (probAux) {ierr = PetscDSGetTotalDimension(probAux, &totDimAux);CHKERRQ(ierr);}
+  ierr = PetscCalloc1(nthreads, &terr);CHKERRQ(ierr);
+  stack      = petscstack;
+  petscstack = NULL;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+  for (tid = 0; tid < nthreads; ++tid) {
+    const PetscInt s = (Ne*tid)/nthreads, e = (Ne*(tid+1))/nthreads;
+
+    terr[tid] = PetscFEIntegrateJacobian(fe, col->ds[tid], jtype, fieldI, fieldJ, e-s, &geom[s], &coefficients[s*totDim], coefficients_t ? &coefficients_t[s*totDim] : NULL,
+                                         probAux ? col->dsAux[tid] : NULL, coefficientsAux ? &coefficientsAux[s*totDimAux] : NULL, t, u_tshift, &elemMat[s*totDim*totDim]);
+  }
+  petscstack = stack;
+  for (tid = 0; tid < nthreads; ++tid) {ierr = terr[tid];CHKERRQ(ierr);}
+  ierr = PetscFree(terr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexVecSetClosureColored_Internal"
+/*
+   DMPlexVecSetClosureColored_Internal - Adds the element vectors of the cells of the coloring to the local vector locF, as
+   DMPlexVecSetClosure() with ADD_ALL_VALUES, with the cells of each color divided among the threads
+
+   Input Parameters:
++  col     - the coloring
+.  locF    - the local vector
+-  elemVec - the element vectors of the cells cStart to cEnd of the coloring
+*/
+PetscErrorCode DMPlexVecSetClosureColored_Internal(DMPlex_AssemblyColoring *col, Vec locF, const PetscScalar elemVec[])
+{
+  const PetscInt  totDim = col->totDim, *cells = col->cells, *lidx = col->lidx;
+  PetscScalar    *f;
+  PetscInt        k;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArray(locF, &f);CHKERRQ(ierr);
+  for (k = 0; k < col->ncolors; ++k) {
+    const PetscInt cs = col->color[k], ce = col->color[k+1];
+    PetscInt       j;
+
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(col->nthreads) schedule(static)
+#endif
+    for (j = cs; j < ce; ++j) {
+      const PetscInt     c   = cells[j] - col->cStart;
+      const PetscInt    *idx = lidx + c*totDim;
+      const PetscScalar *v   = elemVec + c*totDim;
+      PetscInt           i;
+
+      for (i = 0; i < totDim; ++i) f[idx[i]] += v[i];
+    }
+  }
+  ierr = VecRestoreArray(locF, &f);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DMPlexMatSetClosureColored_Internal"
+/*
+   DMPlexMatSetClosureColored_Internal - Adds the element matrices of the cells of the coloring to an assembled MATSEQAIJ
+   matrix, as DMPlexMatSetClosure() with ADD_VALUES, with the cells of each color divided among the threads
+
+   Input Parameters:
++  dm            - the DM
+.  col           - the coloring
+.  globalSection - the global section of A
+.  A             - the matrix
+-  elemMat       - the element matrices of the cells cStart to cEnd of the coloring
+
+   Notes: The cells of one color have disjoint rows, so the threads add directly into the values of the existing nonzeros
+   of their rows. A cell with an entry outside the nonzero structure of A is added afterwards with DMPlexMatSetClosure().
+*/
+PetscErrorCode DMPlexMatSetClosureColored_Internal(DM dm, DMPlex_AssemblyColoring *col, PetscSection globalSection, Mat A, const PetscScalar elemMat[])
+{
+  const PetscInt  numCells = col->cEnd - col->cStart, totDim = col->totDim, *cells = col->cells;
+  const PetscInt *ai, *aj;
+  PetscScalar    *aa;
+  PetscInt       *pos, *missed, *gidx, m, k, c;
+  PetscBool       done;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (col->globalSection != globalSection) {
+    ierr = PetscSectionDestroy(&col->globalSection);CHKERRQ(ierr);
+    if (!col->gidx) {ierr = PetscMalloc1(numCells*totDim, &col->gidx);CHKERRQ(ierr);}
+    for (c = col->cStart; c < col->cEnd; ++c) {
+      ierr = DMPlexGetClosureIndices_Private(dm, col->section, globalSection, c, &m, &col->gidx[(c-col->cStart)*totDim]);CHKERRQ(ierr);
+    }
+    ierr = PetscObjectReference((PetscObject) globalSection);CHKERRQ(ierr);
+    col->globalSection = globalSection;
+  }
+  gidx = col->gidx;
+  ierr = MatGetRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &m, &ai, &aj, &done);CHKERRQ(ierr);
+  if (!done) SETERRQ(PetscObjectComm((PetscObject) A), PETSC_ERR_SUP, "Cannot get the nonzero structure of the matrix");
+  ierr = MatSeqAIJGetArray(A, &aa);CHKERRQ(ierr);
+  ierr = PetscMalloc2(col->nthreads*totDim*totDim, &pos, numCells, &missed);CHKERRQ(ierr);
+  for (k = 0; k < col->ncolors; ++k) {
+    const PetscInt cs = col->color[k], ce = col->color[k+1];
+    PetscInt       j;
+
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads(col->nthreads) schedule(static)
+#endif
+    for (j = cs; j < ce; ++j) {
+      const PetscInt     c    = cells[j] - col->cStart, *idx = gidx + c*totDim;
+      const PetscScalar *v    = elemMat + c*totDim*totDim;
+#if defined(PETSC_HAVE_OPENMP)
+      PetscInt          *cpos = pos + omp_get_thread_num()*totDim*totDim;
+#else
+      PetscInt          *cpos = pos;
+#endif
+      PetscInt           r, s, lo, hi, mid;
+
+      /* find all the entries first, so that a cell outside the nonzero structure adds nothing here */
+      missed[c] = 0;
+      for (r = 0; r < totDim && !missed[c]; ++r) {
+        for (s = 0; s < totDim; ++s) {
+          cpos[r*totDim+s] = -1;
+          if (idx[r] < 0 || idx[s] < 0) continue;
+          lo = ai[idx[r]]; hi = ai[idx[r]+1];
+          while (hi - lo > 0) {
+            mid = lo + (hi - lo)/2;
+            if (aj[mid] < idx[s]) lo = mid + 1;
+            else hi = mid;
+          }
+          if (lo == ai[idx[r]+1] || aj[lo] != idx[s]) {missed[c] = 1; break;}
+          cpos[r*totDim+s] = lo;
+        }
+      }
+      if (missed[c]) continue;
+      for (r = 0; r < totDim*totDim; ++r) if (cpos[r] >= 0) aa[cpos[r]] += v[r];
+    }
+  }
+  ierr = MatSeqAIJRestoreArray(A, &aa);CHKERRQ(ierr);
+  ierr = MatRestoreRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &m, &ai, &aj, &done);CHKERRQ(ierr);
+  for (c = 0; c < numCells; ++c) {
+    if (!missed[c]) continue;
+    ierr = DMPlexMatSetClosure(dm, col->section, globalSection, A, c + col->cStart, &elemMat[c*totDim*totDim], ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(pos, missed);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
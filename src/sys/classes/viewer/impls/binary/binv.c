@@ -25,6 +25,8 @@ typedef struct  {
   PetscBool     skipheader;           /* don't write header, only raw data */
   PetscBool     matlabheaderwritten;  /* if format is PETSC_VIEWER_BINARY_MATLAB has the MATLAB .info header been written yet */
   PetscBool     setfromoptionscalled;
+  PetscBool     usemmap;              /* objects that support it are written in the memory-mapped format */
+  int           mmapfd;               /* file descriptor between PetscViewerBinaryMmapBegin() and PetscViewerBinaryMmapEnd() */
 } PetscViewer_Binary;
 
 #undef __FUNCT__
@@ -1119,6 +1121,203 @@ PetscErrorCode PetscViewerBinarySetUseMPIIO(PetscViewer viewer,PetscBool flg)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinarySetUseMmap_Binary"
+static PetscErrorCode PetscViewerBinarySetUseMmap_Binary(PetscViewer viewer,PetscBool flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  vbinary->usemmap = flg;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinaryGetUseMmap_Binary"
+static PetscErrorCode PetscViewerBinaryGetUseMmap_Binary(PetscViewer viewer,PetscBool *flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  *flg = vbinary->usemmap;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinarySetUseMmap"
+/*@
+    PetscViewerBinarySetUseMmap - Sets a binary viewer to write and read objects in the memory-mapped format
+
+    Logically Collective on PetscViewer
+
+    Input Parameters:
++   viewer - the PetscViewer; must be a binary
+-   flg - PETSC_TRUE means the memory-mapped format will be used
+
+    Options Database:
+    -viewer_binary_mmap : Flag for using the memory-mapped format
+
+    Level: advanced
+
+    Notes:
+    In this format the data of each process is stored in one piece, in the byte order and with the integer and scalar
+    sizes of the machine that wrote it, on boundaries of 64 bytes. Every process writes its own part of the file at once
+    and, when the file is loaded with the same number of processes, maps its part into memory and uses it without
+    copying or changing the byte order. Loading with a different number of processes is also possible, each process
+    then copies the rows it needs from the parts that hold them.
+
+    The file can only be read by a viewer that also uses this format, on a machine with the same byte order, PetscInt
+    and PetscScalar. Currently MATSEQAIJ, MATMPIAIJ and vectors support it, other objects are written in the usual
+    binary format. It cannot be used with MPI-IO.
+
+    An object loaded in place keeps the file mapped until it is destroyed; the file must not be changed, truncated or
+    rewritten in the meantime, which can make the process fail with SIGBUS. A new nonzero inserted in such a matrix
+    copies the arrays of its block to memory first.
+
+.seealso: PetscViewerBinaryGetUseMmap(), PetscViewerBinaryOpen(), PetscViewerBinarySetUseMPIIO(), PetscBinaryMap()
+@*/
+PetscErrorCode PetscViewerBinarySetUseMmap(PetscViewer viewer,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveBool(viewer,flg,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerBinarySetUseMmap_C",(PetscViewer,PetscBool),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinaryGetUseMmap"
+/*@
+    PetscViewerBinaryGetUseMmap - Returns PETSC_TRUE if the binary viewer uses the memory-mapped format
+
+    Not Collective
+
+    Input Parameter:
+.   viewer - PetscViewer context, obtained from PetscViewerBinaryOpen()
+
+    Output Parameter:
+.   flg - PETSC_TRUE if the memory-mapped format is used
+
+    Level: advanced
+
+.seealso: PetscViewerBinarySetUseMmap(), PetscViewerBinaryOpen()
+@*/
+PetscErrorCode PetscViewerBinaryGetUseMmap(PetscViewer viewer,PetscBool *flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidPointer(flg,2);
+  *flg = PETSC_FALSE;
+  ierr = PetscTryMethod(viewer,"PetscViewerBinaryGetUseMmap_C",(PetscViewer,PetscBool*),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinaryMmapBegin"
+/*@C
+    PetscViewerBinaryMmapBegin - Gives every process a file descriptor to write or map its part of the next object
+    in the memory-mapped format
+
+    Collective on PetscViewer
+
+    Input Parameter:
+.   viewer - the PetscViewer; must be a binary that uses the memory-mapped format
+
+    Output Parameters:
++   fd - the file descriptor, use it with PetscBinaryWriteAt() or PetscBinaryMap()
+-   start - the location in the file where the object starts, a multiple of 64 bytes
+
+    Level: developer
+
+    Notes:
+    The locations written or mapped by each process are computed from start, the object must end with
+    PetscViewerBinaryMmapEnd() which moves the viewer past it.
+
+.seealso: PetscViewerBinaryMmapEnd(), PetscViewerBinarySetUseMmap(), PetscBinaryWriteAt(), PetscBinaryMap()
+@*/
+PetscErrorCode PetscViewerBinaryMmapBegin(PetscViewer viewer,int *fd,off_t *start)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+  MPI_Comm           comm;
+  PetscMPIInt        rank;
+  PetscInt64         off = 0;
+  char               fname[PETSC_MAX_PATH_LEN];
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  if (!vbinary->usemmap) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_ARG_WRONGSTATE,"Viewer does not use the memory-mapped format, see PetscViewerBinarySetUseMmap()");
+  ierr = PetscViewerSetUp(viewer);CHKERRQ(ierr);
+  ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  if (!rank) {
+    off = (PetscInt64)lseek(vbinary->fdes,0,vbinary->btype == FILE_MODE_READ ? SEEK_CUR : SEEK_END);
+    if (off < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Error seeking in file");
+    off  = PetscViewerBinaryMmapAlign(off);
+    ierr = PetscStrncpy(fname,vbinary->filename,sizeof(fname));CHKERRQ(ierr);
+  }
+  /* rank 0 has created the file before this, and it may have removed .gz from the name */
+  ierr = MPI_Bcast(&off,1,MPIU_INT64,0,comm);CHKERRQ(ierr);
+  if (vbinary->btype != FILE_MODE_READ) {ierr = MPI_Bcast(fname,sizeof(fname),MPI_CHAR,0,comm);CHKERRQ(ierr);}
+  /* when reading every process has the file open already */
+  if (vbinary->btype == FILE_MODE_READ || !rank) vbinary->mmapfd = vbinary->fdes;
+  else if ((vbinary->mmapfd = open(fname,O_WRONLY,0)) == -1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s for writing",fname);
+  *fd    = vbinary->mmapfd;
+  *start = (off_t)off;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerBinaryMmapEnd"
+/*@C
+    PetscViewerBinaryMmapEnd - Ends an object written or read with PetscViewerBinaryMmapBegin()
+
+    Collective on PetscViewer
+
+    Input Parameters:
++   viewer - the PetscViewer
+-   end - the location in the file where the object ends, the same on all processes
+
+    Level: developer
+
+.seealso: PetscViewerBinaryMmapBegin()
+@*/
+PetscErrorCode PetscViewerBinaryMmapEnd(PetscViewer viewer,off_t end)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+  MPI_Comm           comm;
+  PetscMPIInt        rank;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  if (vbinary->mmapfd != vbinary->fdes) close(vbinary->mmapfd);
+  vbinary->mmapfd = -1;
+  if (vbinary->btype != FILE_MODE_READ) {
+    /* all the parts are in the file before anything is written after them; parts that end
+       with empty arrays leave the file shorter than the object, so it is padded with zeros */
+    ierr = MPI_Barrier(comm);CHKERRQ(ierr);
+    if (!rank) {
+      char  zeros[64];
+      off_t size;
+
+      ierr = PetscMemzero(zeros,sizeof(zeros));CHKERRQ(ierr);
+      if ((size = lseek(vbinary->fdes,0,SEEK_END)) < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Error seeking in file");
+      for (; size < end; size += sizeof(zeros)) {
+        ierr = PetscBinaryWriteAt(vbinary->fdes,zeros,PetscMin(sizeof(zeros),(size_t)(end-size)),size);CHKERRQ(ierr);
+      }
+    }
+  }
+  if (!rank && lseek(vbinary->fdes,end,SEEK_SET) < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Error seeking in file");
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscViewerFileSetMode"
 /*@C
@@ -1412,6 +1611,10 @@ static PetscErrorCode PetscViewerSetFromOptions_Binary(PetscOptionItems *PetscOp
   ierr = PetscOptionsBool("-viewer_binary_mpiio","Use MPI-IO functionality to write/read binary file","PetscViewerBinarySetUseMPIIO",PETSC_FALSE,&binary->usempiio,NULL);CHKERRQ(ierr);
 #elif defined(PETSC_HAVE_MPIUNI)
   ierr = PetscOptionsBool("-viewer_binary_mpiio","Use MPI-IO functionality to write/read binary file","PetscViewerBinarySetUseMPIIO",PETSC_FALSE,NULL,NULL);CHKERRQ(ierr);  
+#endif
+  ierr = PetscOptionsBool("-viewer_binary_mmap","Write/read objects in the memory-mapped format","PetscViewerBinarySetUseMmap",binary->usemmap,&binary->usemmap,NULL);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPIIO)
+  if (binary->usemmap && binary->usempiio) SETERRQ(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_INCOMP,"Cannot use both -viewer_binary_mmap and -viewer_binary_mpiio");
 #endif
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   binary->setfromoptionscalled = PETSC_TRUE;
@@ -1446,6 +1649,8 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
   vbinary->storecompressed = PETSC_FALSE;
   vbinary->filename        = 0;
   vbinary->flowcontrol     = 256; /* seems a good number for Cray XT-5 */
+  vbinary->usemmap         = PETSC_FALSE;
+  vbinary->mmapfd          = -1;
 
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetFlowControl_C",PetscViewerBinaryGetFlowControl_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetFlowControl_C",PetscViewerBinarySetFlowControl_Binary);CHKERRQ(ierr);
@@ -1460,6 +1665,8 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileSetMode_C",PetscViewerFileSetMode_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileGetMode_C",PetscViewerFileGetMode_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileGetName_C",PetscViewerFileGetName_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetUseMmap_C",PetscViewerBinarySetUseMmap_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetUseMmap_C",PetscViewerBinaryGetUseMmap_Binary);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPIIO)
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetUseMPIIO_C",PetscViewerBinaryGetUseMPIIO_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetUseMPIIO_C",PetscViewerBinarySetUseMPIIO_Binary);CHKERRQ(ierr);
@@ -0,0 +1,116 @@
+
+static char help[] = "Tests PetscMalloc(), PetscRealloc() and PetscFree() with random sizes, run with -malloc_pool.\n\
+Input parameters include\n\
+  -n <n> : number of allocations that are alive at a time\n\
+  -m <m> : number of times an allocation is replaced\n\
+  -threads : also replace allocations from several OpenMP threads at once, requires -malloc no\n\n";
+
+#include <petscsys.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+/* a simple linear congruential generator, so that every thread has its own sequence */
+PETSC_STATIC_INLINE PetscInt Random(unsigned long *seed,PetscInt max)
+{
+  *seed = *seed*1103515245 + 12345;
+  return (PetscInt)((*seed/65536) % (unsigned long)max);
+}
+
+/* sizes up to 256 bytes are the most common, a few are larger than the largest size class of the pool */
+PETSC_STATIC_INLINE PetscInt RandomSize(unsigned long *seed)
+{
+  PetscInt r = Random(seed,100);
+
+  if (r < 70) return 1 + Random(seed,256);
+  if (r < 98) return 1 + Random(seed,32768);
+  return 1 + Random(seed,100000);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Churn"
+/*
+   Replaces random entries of a set of n allocations m times, every replacement checks the contents of the old entry.
+
+   This is run by several threads at once, so it calls the routines behind PetscMalloc() directly and does not use
+   PetscFunctionBegin; these are only thread safe when the memory is not traced, that is with -malloc no.
+*/
+static PetscErrorCode Churn(PetscInt n,PetscInt m,unsigned long seed,PetscInt *nerr)
+{
+  char           **p;
+  PetscInt       *len,*key,i,j,k,newlen;
+  PetscErrorCode ierr;
+
+  ierr = (*PetscTrMalloc)(n*sizeof(char*),__LINE__,__FUNCT__,__FILE__,(void**)&p);if (ierr) return ierr;
+  ierr = (*PetscTrMalloc)(2*n*sizeof(PetscInt),__LINE__,__FUNCT__,__FILE__,(void**)&len);if (ierr) return ierr;
+  key  = len + n;
+  for (i=0; i<n; i++) {p[i] = NULL; len[i] = 0; key[i] = 0;}
+  for (k=0; k<m; k++) {
+    i = Random(&seed,n);
+    for (j=0; j<len[i]; j++) if (p[i][j] != (char)(key[i] + j)) {(*nerr)++; break;}
+    switch (Random(&seed,4)) {
+    case 0:
+      ierr   = (*PetscTrFree)(p[i],__LINE__,__FUNCT__,__FILE__);if (ierr) return ierr;
+      p[i]   = NULL;
+      len[i] = 0;
+      break;
+    case 1:
+      /* the contents kept by the reallocation are checked when the entry is replaced again */
+      if (!p[i]) break;
+      newlen = RandomSize(&seed);
+      ierr   = (*PetscTrRealloc)(newlen,__LINE__,__FUNCT__,__FILE__,(void**)&p[i]);if (ierr) return ierr;
+      for (j=len[i]; j<newlen; j++) p[i][j] = (char)(key[i] + j);
+      len[i] = newlen;
+      break;
+    default:
+      ierr   = (*PetscTrFree)(p[i],__LINE__,__FUNCT__,__FILE__);if (ierr) return ierr;
+      len[i] = RandomSize(&seed);
+      key[i] = k;
+      ierr   = (*PetscTrMalloc)(len[i],__LINE__,__FUNCT__,__FILE__,(void**)&p[i]);if (ierr) return ierr;
+      for (j=0; j<len[i]; j++) p[i][j] = (char)(key[i] + j);
+    }
+  }
+  for (i=0; i<n; i++) {
+    for (j=0; j<len[i]; j++) if (p[i][j] != (char)(key[i] + j)) {(*nerr)++; break;}
+    ierr = (*PetscTrFree)(p[i],__LINE__,__FUNCT__,__FILE__);if (ierr) return ierr;
+  }
+  ierr = (*PetscTrFree)(len,__LINE__,__FUNCT__,__FILE__);if (ierr) return ierr;
+  ierr = (*PetscTrFree)(p,__LINE__,__FUNCT__,__FILE__);if (ierr) return ierr;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscInt       n = 1000,m = 20000,nerr = 0;
+  PetscBool      threads = PETSC_FALSE;
+  PetscLogDouble space,held,maxheld;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-threads",&threads,NULL);CHKERRQ(ierr);
+
+  ierr = Churn(n,m,1,&nerr);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  if (threads) {
+    PetscInt terr = 0;
+#pragma omp parallel num_threads(4) reduction(+:terr)
+    {
+      PetscInt       myerr = 0;
+      PetscErrorCode lerr;
+      lerr  = Churn(n,m,2+omp_get_thread_num(),&myerr);
+      terr += myerr + (lerr ? 1 : 0);
+    }
+    nerr += terr;
+  }
+#endif
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Number of corrupted allocations %D\n",nerr);CHKERRQ(ierr);
+
+  ierr = PetscMallocPoolGetUsage(&space,&held,&maxheld);CHKERRQ(ierr);
+  if (space > held || held > maxheld) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Inconsistent pool usage %g %g %g\n",space,held,maxheld);CHKERRQ(ierr);}
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,85 @@
+
+static char help[] = "Tests PetscHSetI and PetscHMapI against a dense array, with random additions and deletions.\n\
+Input parameters include\n\
+  -n <n> : keys are taken from [0,n)\n\
+  -m <m> : number of changes\n\n";
+
+#include <petscsys.h>
+#include <../src/sys/utils/hash.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscHSetI     set;
+  PetscHMapI     map;
+  PetscHashIter  it;
+  PetscInt       n = 5000,m = 200000,i,k,key,val,size,nset = 0,nerr = 0,off,*dense,*keys,*vals;
+  PetscBool      has,missing = PETSC_FALSE;
+  unsigned long  seed = 1;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc3(n,&dense,n,&keys,n,&vals);CHKERRQ(ierr);
+  for (i=0; i<n; i++) dense[i] = -1;
+
+  ierr = PetscHSetICreate(&set);CHKERRQ(ierr);
+  ierr = PetscHMapICreate(&map);CHKERRQ(ierr);
+  for (k=0; k<m; k++) {
+    seed = seed*1103515245 + 12345;
+    /* the keys are multiples of 64 so that a poor hash function would collide */
+    i    = (PetscInt)((seed/65536)%(unsigned long)n);
+    key  = 64*i;
+    /* add more than delete at first, then delete more than add, so that the tables grow and fill with deleted buckets */
+    if ((seed/16)%8 < (k < m/2 ? 5 : 3)) {
+      ierr = PetscHSetIQueryAdd(set,key,&missing);CHKERRQ(ierr);
+      if (missing != (dense[i] < 0 ? PETSC_TRUE : PETSC_FALSE)) nerr++;
+      ierr = PetscHMapISet(map,key,k);CHKERRQ(ierr);
+      if (dense[i] < 0) nset++;
+      dense[i] = k;
+    } else {
+      ierr = PetscHSetIDel(set,key);CHKERRQ(ierr);
+      ierr = PetscHMapIDel(map,key);CHKERRQ(ierr);
+      if (dense[i] >= 0) nset--;
+      dense[i] = -1;
+    }
+  }
+  for (i=0; i<n; i++) {
+    ierr = PetscHSetIHas(set,64*i,&has);CHKERRQ(ierr);
+    ierr = PetscHMapIGet(map,64*i,&val);CHKERRQ(ierr);
+    if (has != (dense[i] >= 0 ? PETSC_TRUE : PETSC_FALSE) || val != dense[i]) nerr++;
+  }
+  ierr = PetscHSetIGetSize(set,&size);CHKERRQ(ierr);
+  if (size != nset) nerr++;
+  ierr = PetscHMapIGetSize(map,&size);CHKERRQ(ierr);
+  if (size != nset) nerr++;
+
+  /* every entry is visited once */
+  off  = 0;
+  ierr = PetscHMapIGetPairs(map,&off,keys,vals);CHKERRQ(ierr);
+  if (off != nset) nerr++;
+  for (i=0; i<off; i++) if (keys[i]%64 || dense[keys[i]/64] != vals[i]) nerr++;
+  off  = 0;
+  PetscHashIterBegin(set,it);
+  while (!PetscHashIterAtEnd(set,it)) {
+    PetscHashIterGetKey(set,it,key);
+    if (dense[key/64] < 0) nerr++;
+    off++;
+    PetscHashIterNext(set,it);
+  }
+  if (off != nset) nerr++;
+
+  ierr = PetscHMapIClear(map);CHKERRQ(ierr);
+  ierr = PetscHMapIGetSize(map,&size);CHKERRQ(ierr);
+  ierr = PetscHMapIGet(map,0,&val);CHKERRQ(ierr);
+  if (size || val != -1) nerr++;
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Number of keys %D, number of errors %D\n",nset,nerr);CHKERRQ(ierr);
+  ierr = PetscHSetIDestroy(&set);CHKERRQ(ierr);
+  ierr = PetscHMapIDestroy(&map);CHKERRQ(ierr);
+  ierr = PetscFree3(dense,keys,vals);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -12,6 +12,9 @@
 #if defined(PETSC_HAVE_IO_H)
 #include <io.h>
 #endif
+#if defined(PETSC_HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
 #include <petscbt.h>
 
 const char *const PetscFileModes[] = {"READ","WRITE","APPEND","UPDATE","APPEND_UPDATE","PetscFileMode","PETSC_FILE_",0};
@@ -570,6 +573,147 @@ PetscErrorCode  PetscBinarySeek(int fd,off_t off,PetscBinarySeekType whence,off_
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscBinaryWriteAt"
+/*@C
+   PetscBinaryWriteAt - Writes raw bytes at a given location of a file, without moving the file pointer
+   and without changing their byte order.
+
+   Not Collective
+
+   Input Parameters:
++  fd  - the file
+.  p   - the bytes
+.  len - the number of bytes
+-  off - the location in the file
+
+   Level: developer
+
+   Notes:
+   Several processes may write to disjoint parts of the same file this way, as
+   PetscViewerBinaryMmapBegin() arranges.
+
+.seealso: PetscBinaryMap(), PetscBinaryWrite(), PetscViewerBinarySetUseMmap()
+@*/
+PetscErrorCode PetscBinaryWriteAt(int fd,const void *p,size_t len,off_t off)
+{
+  const char *pp = (const char*)p;
+  ssize_t    wsize;
+
+  PetscFunctionBegin;
+#if !defined(PETSC_HAVE_PWRITE)
+  if (lseek(fd,off,SEEK_SET) < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"Error seeking in file");
+#endif
+  while (len) {
+#if defined(PETSC_HAVE_PWRITE)
+    wsize = pwrite(fd,pp,len,off);
+#else
+    wsize = write(fd,pp,len);
+#endif
+    if (wsize < 0 && errno == EINTR) continue;
+    if (wsize < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"Error writing to file errno %d",errno);
+    pp  += wsize;
+    off += wsize;
+    len -= (size_t)wsize;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscBinaryMap"
+/*@C
+   PetscBinaryMap - Maps a part of a file into memory, the bytes are used as they are, without changing their order.
+
+   Not Collective
+
+   Input Parameters:
++  fd  - the file, opened for reading
+.  off - the location in the file, it need not be a multiple of the page size
+-  len - the number of bytes
+
+   Output Parameter:
+.  p - the bytes, or NULL if len is zero
+
+   Level: developer
+
+   Notes:
+   The mapping is private: the bytes may be changed in memory, this only copies the pages that are changed and does not
+   change the file. Only the pages that are used are read from the file, so that a process can map the whole of a large
+   file and only pay for the part it uses. Free the mapping with PetscBinaryUnmap().
+
+   Pages that were not copied still come from the file, so it must not be changed or truncated while it is mapped:
+   the mapping would see the new bytes, and accessing a page beyond the end of a truncated file raises SIGBUS.
+
+   On systems without mmap() the bytes are read into memory.
+
+.seealso: PetscBinaryUnmap(), PetscBinaryWriteAt(), PetscViewerBinarySetUseMmap()
+@*/
+PetscErrorCode PetscBinaryMap(int fd,off_t off,size_t len,void **p)
+{
+#if defined(PETSC_HAVE_MMAP)
+  size_t         shift;
+  char           *base;
+#else
+  PetscErrorCode ierr;
+  char           *pp;
+  ssize_t        rsize;
+#endif
+
+  PetscFunctionBegin;
+  *p = NULL;
+  if (!len) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_MMAP)
+  /* the location of a mapping must be a multiple of the page size */
+  shift = (size_t)(off % (off_t)getpagesize());
+  base  = (char*)mmap(NULL,len+shift,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,off-(off_t)shift);
+  if (base == (char*)MAP_FAILED) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_READ,"Error mapping file errno %d",errno);
+  *p = base + shift;
+#else
+  ierr = PetscMalloc(len,p);CHKERRQ(ierr);
+  if (lseek(fd,off,SEEK_SET) < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_READ,"Error seeking in file");
+  for (pp=(char*)*p; len; pp+=rsize,len-=(size_t)rsize) {
+    rsize = read(fd,pp,len);
+    if (rsize < 0 && errno == EINTR) {rsize = 0; continue;}
+    if (rsize <= 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_READ,"Read past end of file");
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscBinaryUnmap"
+/*@C
+   PetscBinaryUnmap - Frees a mapping made with PetscBinaryMap()
+
+   Not Collective
+
+   Input Parameters:
++  p   - the bytes returned by PetscBinaryMap()
+-  len - the number of bytes given to PetscBinaryMap()
+
+   Level: developer
+
+.seealso: PetscBinaryMap()
+@*/
+PetscErrorCode PetscBinaryUnmap(void *p,size_t len)
+{
+#if defined(PETSC_HAVE_MMAP)
+  size_t         shift;
+#else
+  PetscErrorCode ierr;
+#endif
+
+  PetscFunctionBegin;
+  if (!p) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_MMAP)
+  shift = (size_t)((PETSC_UINTPTR_T)p % (PETSC_UINTPTR_T)getpagesize());
+  if (munmap((char*)p-shift,len+shift)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SYS,"Error unmapping file errno %d",errno);
+#else
+  ierr = PetscFree(p);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscBinarySynchronizedRead"
 /*@C
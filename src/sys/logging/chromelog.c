@@ -0,0 +1,347 @@
+
+/*
+     Event logging in the Chrome trace event format, which chrome://tracing and Perfetto (ui.perfetto.dev) display.
+
+   Every event begin and end writes one fixed-size record into a ring buffer owned by the calling thread, timestamped
+   with the processor time stamp counter where there is one. Nothing is looked up, formatted, locked or communicated
+   until PetscLogChromeDump(), so the log is cheap enough to leave on in production runs and events may be logged
+   from inside OpenMP parallel regions.
+*/
+#include <petsc/private/logimpl.h>  /*I "petscsys.h" I*/
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#if defined(PETSC_USE_LOG)
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER))
+#include <x86intrin.h>
+#define PetscChromeTick() ((PetscInt64)__rdtsc())
+#else
+#define PetscChromeTick() ((PetscInt64)(MPI_Wtime()*1.e9))
+#endif
+
+typedef struct {
+  PetscInt64    tick;
+  PetscLogEvent event;
+  int           end;      /* 0 for the begin of the event, 1 for its end */
+} PetscChromeRecord;
+
+typedef struct {
+  PetscChromeRecord *rec;
+  PetscInt64        count;    /* number of records written, the next goes to rec[count & chrome_mask] */
+  char              pad[64];  /* keeps the counts of different threads in different cache lines */
+} PetscChromeBuffer;
+
+static PetscChromeBuffer *chrome_buffers = NULL;
+static int               chrome_nthreads = 0;
+static PetscInt64        chrome_mask     = 0;
+static PetscInt64        chrome_tick0    = 0;
+static PetscLogDouble    chrome_time0    = 0.0;
+static PetscInt64        chrome_dropped  = 0;  /* records of threads that have no buffer */
+
+/*
+   The buffer of the calling thread. Threads of nested parallel regions would share the buffer of their thread number
+   with the outer threads, and threads past the number of buffers have none, so their records are dropped and counted.
+*/
+#if defined(PETSC_HAVE_OPENMP)
+PETSC_STATIC_INLINE PetscChromeBuffer *PetscChromeGetBuffer(void)
+{
+  int t = omp_get_thread_num();
+
+  if (t >= chrome_nthreads || omp_get_active_level() > 1) {
+#pragma omp atomic
+    chrome_dropped++;
+    return NULL;
+  }
+  return &chrome_buffers[t];
+}
+#else
+#define PetscChromeGetBuffer() (&chrome_buffers[0])
+#endif
+
+/* the handlers that were active when the Chrome log started, for example the one of -log_view; they are still called */
+static PetscErrorCode (*chrome_PLB)(PetscLogEvent,int,PetscObject,PetscObject,PetscObject,PetscObject) = NULL;
+static PetscErrorCode (*chrome_PLE)(PetscLogEvent,int,PetscObject,PetscObject,PetscObject,PetscObject) = NULL;
+
+/* These are called for every event, possibly by several threads at once, so they do not use PetscFunctionBegin */
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogEventBeginChrome"
+static PetscErrorCode PetscLogEventBeginChrome(PetscLogEvent event,int t,PetscObject o1,PetscObject o2,PetscObject o3,PetscObject o4)
+{
+  PetscChromeBuffer *buf = PetscChromeGetBuffer();
+  PetscChromeRecord *r;
+
+  if (buf) {
+    r        = &buf->rec[buf->count++ & chrome_mask];
+    r->tick  = PetscChromeTick();
+    r->event = event;
+    r->end   = 0;
+  }
+  if (chrome_PLB) return (*chrome_PLB)(event,t,o1,o2,o3,o4);
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogEventEndChrome"
+static PetscErrorCode PetscLogEventEndChrome(PetscLogEvent event,int t,PetscObject o1,PetscObject o2,PetscObject o3,PetscObject o4)
+{
+  PetscChromeBuffer *buf = PetscChromeGetBuffer();
+  PetscChromeRecord *r;
+
+  if (buf) {
+    r        = &buf->rec[buf->count++ & chrome_mask];
+    r->tick  = PetscChromeTick();
+    r->event = event;
+    r->end   = 1;
+  }
+  if (chrome_PLE) return (*chrome_PLE)(event,t,o1,o2,o3,o4);
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogChromeBegin"
+/*@C
+  PetscLogChromeBegin - Turns on logging of every event begin and end into per-thread buffers, to be written in the
+  Chrome trace event format by PetscLogChromeDump().
+
+  Logically Collective on PETSC_COMM_WORLD
+
+  Options Database Keys:
++ -log_chrome [filename] - Starts the log in PetscInitialize() and dumps it in PetscFinalize(), by default to petsc-trace.json
+- -log_chrome_buffer_size <n> - The number of records kept per thread, rounded up to a power of two (default 262144)
+
+  Notes:
+  Each thread keeps the most recent records only, two per event, so the beginning of a long run is lost when the
+  buffer wraps around. The event handlers that were in use, for example the one of -log_view, are called as well;
+  only the Chrome handlers themselves are safe to call from several threads. There is one buffer for each of the
+  omp_get_max_threads() threads at the time of this call; the events of threads past that number and of the threads
+  of nested OpenMP parallel regions are dropped, and -info reports how many.
+
+  The file can be loaded in chrome://tracing or https://ui.perfetto.dev; it has a process for each MPI rank and a
+  track for each thread.
+
+  Level: advanced
+
+.seealso: PetscLogChromeDump(), PetscLogDefaultBegin(), PetscLogTraceBegin(), PetscLogEventBegin()
+@*/
+PetscErrorCode PetscLogChromeBegin(void)
+{
+  PetscInt       n = 262144,size = 16;
+  int            i;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (chrome_buffers) PetscFunctionReturn(0);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-log_chrome_buffer_size",&n,NULL);CHKERRQ(ierr);
+  if (n < 1 || n > PETSC_MAX_INT/2) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Buffer size %D must be positive and less than 2^30",n);
+  while (size < n) size *= 2;
+#if defined(PETSC_HAVE_OPENMP)
+  chrome_nthreads = omp_get_max_threads();
+#else
+  chrome_nthreads = 1;
+#endif
+  chrome_mask    = size-1;
+  chrome_dropped = 0;
+  ierr = PetscCalloc1(chrome_nthreads,&chrome_buffers);CHKERRQ(ierr);
+  for (i=0; i<chrome_nthreads; i++) {
+    ierr = PetscMalloc1(size,&chrome_buffers[i].rec);CHKERRQ(ierr);
+  }
+  chrome_PLB = PetscLogPLB;
+  chrome_PLE = PetscLogPLE;
+  /* the clocks of the ranks start together */
+  ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscTime(&chrome_time0);CHKERRQ(ierr);
+  chrome_tick0 = PetscChromeTick();
+  ierr = PetscLogSet(PetscLogEventBeginChrome,PetscLogEventEndChrome);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogChromeEnd"
+/*
+   PetscLogChromeEnd - Frees the buffers of the Chrome log and goes back to the event handlers that were in use before
+*/
+PetscErrorCode PetscLogChromeEnd(void)
+{
+  int            i;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!chrome_buffers) PetscFunctionReturn(0);
+  ierr = PetscLogSet(chrome_PLB,chrome_PLE);CHKERRQ(ierr);
+  for (i=0; i<chrome_nthreads; i++) {
+    ierr = PetscFree(chrome_buffers[i].rec);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(chrome_buffers);CHKERRQ(ierr);
+  chrome_nthreads = 0;
+  chrome_PLB      = NULL;
+  chrome_PLE      = NULL;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscChromePrintf"
+/* appends formatted text to the segmented buffer */
+static PetscErrorCode PetscChromePrintf(PetscSegBuffer seg,const char format[],...)
+{
+  char           *text;
+  size_t         len,avail = 512;
+  va_list        Argp;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSegBufferGet(seg,avail,&text);CHKERRQ(ierr);
+  va_start(Argp,format);
+  ierr = PetscVSNPrintf(text,avail,format,&len,Argp);CHKERRQ(ierr);
+  va_end(Argp);
+  ierr = PetscSegBufferUnuse(seg,avail-PetscMin(len,avail-1));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscChromePrintEvent"
+static PetscErrorCode PetscChromePrintEvent(PetscSegBuffer seg,PetscEventRegLog eventRegLog,PetscClassRegLog classRegLog,PetscMPIInt rank,int thread,PetscChromeRecord *b,PetscInt64 endtick,double usPerTick)
+{
+  PetscEventRegInfo *info = &eventRegLog->eventInfo[b->event];
+  const char        *cat  = "PETSc";
+  int               c;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  for (c=0; c<classRegLog->numClasses; c++) {
+    if (classRegLog->classInfo[c].classid == info->classid) {cat = classRegLog->classInfo[c].name; break;}
+  }
+  ierr = PetscChromePrintf(seg,",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",info->name,cat,rank,thread,
+                           (double)(b->tick-chrome_tick0)*usPerTick,(double)(endtick-b->tick)*usPerTick);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogChromeDump"
+/*@C
+  PetscLogChromeDump - Writes the events logged since PetscLogChromeBegin() to a file in the Chrome trace event format
+
+  Collective on PETSC_COMM_WORLD
+
+  Input Parameter:
+. filename - the name of the file, or NULL for petsc-trace.json
+
+  Notes:
+  The begin and end records of each thread are matched into complete events. An end whose begin was overwritten in
+  the ring buffer is skipped and an event that has not ended yet is closed at the time of the dump. The first process
+  collects the events of the others and writes the file.
+
+  Level: advanced
+
+.seealso: PetscLogChromeBegin(), PetscLogDump(), PetscLogView()
+@*/
+PetscErrorCode PetscLogChromeDump(const char filename[])
+{
+  PetscStageLog     stageLog;
+  PetscEventRegLog  eventRegLog;
+  PetscClassRegLog  classRegLog;
+  PetscIntStack     stack;
+  PetscSegBuffer    seg;
+  PetscChromeRecord *r;
+  PetscInt64        tick1,first,last,i,lost = 0,glost,gdropped;
+  PetscLogDouble    time1;
+  double            usPerTick;
+  PetscMPIInt       rank,size,p,len,*lens = NULL,maxlen = 0,tag;
+  MPI_Comm          comm;
+  MPI_Status        status;
+  PetscBool         empty;
+  char              *text,*rtext;
+  size_t            n;
+  FILE              *fd;
+  int               t,top;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!chrome_buffers) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Must call PetscLogChromeBegin() or use -log_chrome before calling this routine");
+  tick1     = PetscChromeTick();
+  ierr      = PetscTime(&time1);CHKERRQ(ierr);
+  usPerTick = (tick1 > chrome_tick0) ? 1.e6*(time1-chrome_time0)/(double)(tick1-chrome_tick0) : 0.0;
+  ierr      = PetscCommDuplicate(PETSC_COMM_WORLD,&comm,&tag);CHKERRQ(ierr);
+  ierr      = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr      = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr      = PetscLogGetStageLog(&stageLog);CHKERRQ(ierr);
+  ierr      = PetscStageLogGetEventRegLog(stageLog,&eventRegLog);CHKERRQ(ierr);
+  ierr      = PetscStageLogGetClassRegLog(stageLog,&classRegLog);CHKERRQ(ierr);
+  ierr      = PetscIntStackCreate(&stack);CHKERRQ(ierr);
+  ierr      = PetscSegBufferCreate(1,1<<16,&seg);CHKERRQ(ierr);
+
+  ierr = PetscChromePrintf(seg,",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"rank %d\"}}",rank,rank);CHKERRQ(ierr);
+  ierr = PetscChromePrintf(seg,",\n{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}}",rank,rank);CHKERRQ(ierr);
+  for (t=0; t<chrome_nthreads; t++) {
+    PetscChromeBuffer *buf = &chrome_buffers[t];
+
+    if (!buf->count) continue;
+    ierr  = PetscChromePrintf(seg,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",rank,t,t);CHKERRQ(ierr);
+    first = PetscMax(buf->count-(chrome_mask+1),0);
+    lost += first;
+    for (i=first; i<buf->count; i++) {
+      r = &buf->rec[i & chrome_mask];
+      if (!r->end) {
+        ierr = PetscIntStackPush(stack,(int)(i & chrome_mask));CHKERRQ(ierr);
+        continue;
+      }
+      /* pop to the matching begin; an end without one had its begin overwritten */
+      ierr = PetscIntStackEmpty(stack,&empty);CHKERRQ(ierr);
+      while (!empty) {
+        ierr = PetscIntStackPop(stack,&top);CHKERRQ(ierr);
+        if (buf->rec[top].event == r->event) {
+          ierr = PetscChromePrintEvent(seg,eventRegLog,classRegLog,rank,t,&buf->rec[top],r->tick,usPerTick);CHKERRQ(ierr);
+          break;
+        }
+        ierr = PetscIntStackEmpty(stack,&empty);CHKERRQ(ierr);
+      }
+    }
+    /* events that have not ended yet */
+    last = buf->rec[(buf->count-1) & chrome_mask].tick;
+    ierr = PetscIntStackEmpty(stack,&empty);CHKERRQ(ierr);
+    while (!empty) {
+      ierr = PetscIntStackPop(stack,&top);CHKERRQ(ierr);
+      ierr = PetscChromePrintEvent(seg,eventRegLog,classRegLog,rank,t,&buf->rec[top],PetscMax(last,tick1),usPerTick);CHKERRQ(ierr);
+      ierr = PetscIntStackEmpty(stack,&empty);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscIntStackDestroy(stack);CHKERRQ(ierr);
+  ierr = PetscSegBufferGetSize(seg,&n);CHKERRQ(ierr);
+  if (n > PETSC_MPI_INT_MAX) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Trace of a process is larger than 2GB, use a smaller -log_chrome_buffer_size");
+  len  = (PetscMPIInt)n;
+  ierr = PetscSegBufferExtractAlloc(seg,&text);CHKERRQ(ierr);
+  ierr = PetscSegBufferDestroy(&seg);CHKERRQ(ierr);
+  ierr = MPIU_Allreduce(&lost,&glost,1,MPIU_INT64,MPI_SUM,comm);CHKERRQ(ierr);
+  if (glost) {ierr = PetscInfo1(0,"%lld records were overwritten in the Chrome log buffers, use a larger -log_chrome_buffer_size to keep them\n",(long long)glost);CHKERRQ(ierr);}
+  ierr = MPIU_Allreduce(&chrome_dropped,&gdropped,1,MPIU_INT64,MPI_SUM,comm);CHKERRQ(ierr);
+  if (gdropped) {ierr = PetscInfo1(0,"%lld records of threads of nested parallel regions or past the number of threads at PetscLogChromeBegin() were dropped\n",(long long)gdropped);CHKERRQ(ierr);}
+
+  if (!rank) {ierr = PetscMalloc1(size,&lens);CHKERRQ(ierr);}
+  ierr = MPI_Gather(&len,1,MPI_INT,lens,1,MPI_INT,0,comm);CHKERRQ(ierr);
+  if (!rank) {
+    if (!filename) filename = "petsc-trace.json";
+    fd = fopen(filename,"w");
+    if (!fd) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Unable to open file: %s",filename);
+    /* every element starts with a comma, except the first one */
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fd,"{\"traceEvents\":[");CHKERRQ(ierr);
+    if (len > 1 && fwrite(text+1,1,len-1,fd) != (size_t)(len-1)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"fwrite() failed on file");
+    for (p=1; p<size; p++) maxlen = PetscMax(maxlen,lens[p]);
+    ierr = PetscMalloc1(maxlen+1,&rtext);CHKERRQ(ierr);
+    for (p=1; p<size; p++) {
+      ierr = MPI_Recv(rtext,lens[p],MPI_CHAR,p,tag,comm,&status);CHKERRQ(ierr);
+      if (fwrite(rtext,1,lens[p],fd) != (size_t)lens[p]) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"fwrite() failed on file");
+    }
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fd,"\n],\n\"displayTimeUnit\":\"ns\"}\n");CHKERRQ(ierr);
+    if (fclose(fd)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SYS,"fclose() failed on file");
+    ierr = PetscFree(rtext);CHKERRQ(ierr);
+    ierr = PetscFree(lens);CHKERRQ(ierr);
+  } else {
+    ierr = MPI_Send(text,len,MPI_CHAR,0,tag,comm);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(text);CHKERRQ(ierr);
+  ierr = PetscCommDestroy(&comm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#endif
@@ -0,0 +1,90 @@
+
+static char help[] = "Records a timeline of events with PetscLogChromeBegin() and writes it in the Chrome trace format.\n\
+Input parameters include\n\
+  -n <n> : number of times the events are logged\n\
+  -view_overhead : print the time spent for each begin and end of an event\n\
+  -threads : also log the events from one more OpenMP thread than there are buffers for\n\n";
+
+/*T
+   Concepts: logging^timeline of events
+   Processors: n
+T*/
+
+#include <petscsys.h>
+#include <petsctime.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscClassId   classid;
+  PetscLogEvent  outer,inner;
+  PetscLogDouble t1,t2;
+  PetscInt       n = 1000,i,count = 0,total;
+  PetscMPIInt    rank,size;
+  PetscBool      overhead = PETSC_FALSE,threads = PETSC_FALSE;
+  char           line[1024];
+  FILE           *fd;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-view_overhead",&overhead,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-threads",&threads,NULL);CHKERRQ(ierr);
+  ierr = PetscClassIdRegister("Example",&classid);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("ExOuter",classid,&outer);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("ExInner",classid,&inner);CHKERRQ(ierr);
+
+  ierr = PetscLogChromeBegin();CHKERRQ(ierr);
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    ierr = PetscLogEventBegin(outer,0,0,0,0);CHKERRQ(ierr);
+    ierr = PetscLogEventBegin(inner,0,0,0,0);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(inner,0,0,0,0);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(outer,0,0,0,0);CHKERRQ(ierr);
+  }
+  ierr = PetscTime(&t2);CHKERRQ(ierr);
+  total = n;
+#if defined(PETSC_HAVE_OPENMP)
+  if (threads) {
+    int nbuf = omp_get_max_threads();
+
+    /* the events of the last thread have no buffer and are dropped */
+#pragma omp parallel num_threads(nbuf+1) reduction(+:total)
+    {
+      PetscInt j;
+
+      for (j=0; j<n; j++) {
+        PetscLogEventBegin(inner,0,0,0,0);
+        PetscLogEventEnd(inner,0,0,0,0);
+      }
+      if (omp_get_thread_num() < nbuf) total += n;
+    }
+  }
+#endif
+  if (overhead) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Time for each begin or end of an event %g ns\n",1.e9*(t2-t1)/(4*n));CHKERRQ(ierr);
+  }
+  ierr = PetscLogChromeDump("ex2-trace.json");CHKERRQ(ierr);
+
+  /* every event is written on a line of its own */
+  if (!rank) {
+    ierr = PetscFOpen(PETSC_COMM_SELF,"ex2-trace.json","r",&fd);CHKERRQ(ierr);
+    while (fgets(line,sizeof(line),fd)) {
+      if (strstr(line,"\"name\":\"ExInner\",\"cat\":\"Example\",\"ph\":\"X\"")) count++;
+    }
+    ierr = PetscFClose(PETSC_COMM_SELF,fd);CHKERRQ(ierr);
+  }
+  if (threads) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Found the inner events of the threads that have a buffer: %s\n",count == size*total ? "yes" : "no");CHKERRQ(ierr);
+  } else {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Found %D of %D inner events in the trace\n",count,size*total);CHKERRQ(ierr);
+  }
+  ierr  = PetscFinalize();
+  return ierr;
+}
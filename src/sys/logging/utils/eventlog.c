@@ -630,6 +630,47 @@ PetscErrorCode PetscLogEventZeroFlops(PetscLogEvent event)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogEventAddTime"
+/*@
+  PetscLogEventAddTime - Adds a separately measured time to an event, without a begin/end pair
+
+  Not Collective
+
+  Input Parameters:
++ event - The event number
+- time  - The time in seconds
+
+  Notes:
+  This is meant for quantities that cannot be bracketed by PetscLogEventBegin()/PetscLogEventEnd() on the
+  calling thread, for example the idle time of threads inside an OpenMP parallel region. The count of the
+  event is incremented by one. Nothing is recorded if logging is not on or the event is deactivated.
+
+  Level: developer
+
+.seealso: PetscLogEventBegin(), PetscLogEventGetFlops()
+@*/
+PetscErrorCode PetscLogEventAddTime(PetscLogEvent event, PetscLogDouble time)
+{
+  PetscStageLog     stageLog;
+  PetscEventPerfLog eventLog = NULL;
+  int               stage;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!PetscLogPLB) PetscFunctionReturn(0);
+  ierr = PetscLogGetStageLog(&stageLog);CHKERRQ(ierr);
+  ierr = PetscStageLogGetCurrent(stageLog, &stage);CHKERRQ(ierr);
+  if (!stageLog->stageInfo[stage].perfInfo.active) PetscFunctionReturn(0);
+  ierr = PetscStageLogGetEventPerfLog(stageLog, stage, &eventLog);CHKERRQ(ierr);
+  if (!eventLog->eventInfo[event].active) PetscFunctionReturn(0);
+
+  eventLog->eventInfo[event].count++;
+  eventLog->eventInfo[event].time  += time;
+  eventLog->eventInfo[event].time2 += time*time;
+  PetscFunctionReturn(0);
+}
+
 #if defined(PETSC_HAVE_PAPI)
 #include <papi.h>
 extern int PAPIEventSet;
@@ -0,0 +1,361 @@
+/*
+    A pooled allocator for PetscMalloc().
+
+    Requests of up to POOL_MAX_SMALL bytes are rounded up to one of POOL_NCLASS size classes and served from free
+  lists; each thread keeps its own lists, so allocating and freeing need no lock. A thread whose lists are empty takes a
+  batch of blocks from the shared lists or carves them from the current arena, a large piece of memory obtained from
+  the system; a thread that collects too many free blocks gives a batch back. Memory is never returned to the system,
+  so that the many small, short-lived allocations of the setup phases do not fragment the heap. Larger requests go to
+  the system directly.
+
+    Every block starts with a header of POOL_HEADER bytes that holds its size class and requested size.
+*/
+#include <petscsys.h>             /*I   "petscsys.h"   I*/
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+extern PetscErrorCode PetscMallocAlign(size_t,int,const char[],const char[],void**);
+extern PetscErrorCode PetscFreeAlign(void*,int,const char[],const char[]);
+extern PetscErrorCode PetscTrMallocDefault(size_t,int,const char[],const char[],void**);
+extern PetscErrorCode PetscSetTrMallocBase_Private(PetscErrorCode (*)(size_t,int,const char[],const char[],void**),PetscErrorCode (*)(void*,int,const char[],const char[]),PetscErrorCode (*)(size_t,int,const char[],const char[],void**));
+
+#define POOL_NCLASS     44                   /* 16 classes in steps of 16 bytes up to 256 bytes, then 4 per power of 2 */
+#define POOL_MAX_SMALL  32768
+#define POOL_ARENA_SIZE (4*1024*1024)
+#define POOL_BATCH_SIZE 16384                /* bytes moved between a thread and the shared lists at a time */
+#define POOL_HEADER     (PETSC_MEMALIGN > 16 ? PETSC_MEMALIGN : 16)
+#define POOL_LARGE      -1
+#define POOL_MAGIC      0x7a3c
+#define POOL_FREED      0x5e1f
+
+typedef struct _n_PoolBlock {
+  struct _n_PoolBlock *next;
+} PoolBlock;
+
+typedef struct {
+  int    magic;
+  int    cls;           /* the size class, or POOL_LARGE for a block obtained from the system */
+  size_t size;          /* the requested size */
+} PoolHeader;
+
+typedef struct _n_PoolCache *PoolCache;
+struct _n_PoolCache {
+  PoolBlock  *free[POOL_NCLASS];
+  int        nfree[POOL_NCLASS];
+  PetscInt64 requested;  /* bytes requested in the blocks allocated by this thread minus those freed by it */
+  PoolCache  next;       /* all caches, for the statistics */
+};
+
+static PoolBlock   *pool_free[POOL_NCLASS];  /* shared free lists */
+static char        *pool_cur = NULL,*pool_end = NULL;  /* the part of the current arena that is not carved yet */
+static void        *pool_arenas = NULL;      /* arenas are linked through their first word */
+static size_t      pool_held = 0,pool_maxheld = 0;
+static PetscInt64  pool_large = 0;           /* bytes requested in blocks obtained from the system */
+static PoolCache   pool_caches = NULL;
+static PoolCache   pool_cache  = NULL;       /* the cache of the calling thread */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp threadprivate(pool_cache)
+#endif
+
+/* the size class of a request of n > 0 bytes */
+PETSC_STATIC_INLINE int PoolClass(size_t n)
+{
+  int e = 8;
+
+  if (n <= 256) return (int)((n+15)/16) - 1;
+  while ((n-1) >> (e+1)) e++;
+  return 16 + 4*(e-8) + (int)((n-1) >> (e-2)) - 4;
+}
+
+/* the number of bytes in a block of size class c, including its header */
+PETSC_STATIC_INLINE size_t PoolClassSize(int c)
+{
+  if (c < 16) return POOL_HEADER + 16*(c+1);
+  return POOL_HEADER + ((size_t)((c-16)%4 + 5) << (8 + (c-16)/4 - 2));
+}
+
+PETSC_STATIC_INLINE int PoolBatch(int c)
+{
+  int n = (int)(POOL_BATCH_SIZE/PoolClassSize(c));
+  return n > 1 ? n : 1;
+}
+
+/* gets blocks from the shared lists or the current arena; called inside the critical section */
+static int PoolRefill(PoolCache cache,int c)
+{
+  size_t    bs = PoolClassSize(c);
+  int       n  = PoolBatch(c),i;
+  PoolBlock *b;
+  char      *arena;
+
+  for (i=0; i<n && pool_free[c]; i++) {
+    b            = pool_free[c];
+    pool_free[c] = b->next;
+    b->next      = cache->free[c];
+    cache->free[c] = b;
+  }
+  cache->nfree[c] += i;
+  if (i) return 0;
+  if ((size_t)(pool_end - pool_cur) < n*bs) {
+    /* the rest of the current arena is lost */
+    arena = (char*)malloc(POOL_ARENA_SIZE);
+    if (!arena) return 1;
+    *(void**)arena = pool_arenas;
+    pool_arenas    = arena;
+    pool_held     += POOL_ARENA_SIZE;
+    if (pool_held > pool_maxheld) pool_maxheld = pool_held;
+    pool_cur = arena + PETSC_MEMALIGN - ((PETSC_UINTPTR_T)arena)%PETSC_MEMALIGN;
+    if (pool_cur - arena < (PetscInt64)sizeof(void*)) pool_cur += PETSC_MEMALIGN;
+    pool_end = arena + POOL_ARENA_SIZE;
+  }
+  for (i=0; i<n; i++) {
+    b              = (PoolBlock*)pool_cur;
+    pool_cur      += bs;
+    b->next        = cache->free[c];
+    cache->free[c] = b;
+  }
+  cache->nfree[c] += n;
+  return 0;
+}
+
+static PoolCache PoolGetCache(void)
+{
+  PoolCache cache = pool_cache;
+
+  if (cache) return cache;
+  cache = (PoolCache)calloc(1,sizeof(struct _n_PoolCache));
+  if (!cache) return NULL;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+  {
+    cache->next = pool_caches;
+    pool_caches = cache;
+  }
+  pool_cache = cache;
+  return cache;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPool"
+/*
+   PetscMallocPool - Allocates from the pool, with the calling sequence of PetscMallocSet()
+
+   This is called for every PetscMalloc() so it does not use PetscFunctionBegin
+*/
+PetscErrorCode PetscMallocPool(size_t mem,int line,const char func[],const char file[],void **result)
+{
+  PoolCache      cache;
+  PoolHeader     *h;
+  PoolBlock      *b;
+  int            c,err = 0;
+  PetscErrorCode ierr;
+
+  if (!mem) {*result = NULL; return 0;}
+  if (mem > POOL_MAX_SMALL) {
+    ierr = PetscMallocAlign(POOL_HEADER+mem,line,func,file,(void**)&h);if (ierr) return ierr;
+    h->magic = POOL_MAGIC;
+    h->cls   = POOL_LARGE;
+    h->size  = mem;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+    {
+      pool_large += mem;
+      pool_held  += POOL_HEADER+mem;
+      if (pool_held > pool_maxheld) pool_maxheld = pool_held;
+    }
+    *result = (char*)h + POOL_HEADER;
+    return 0;
+  }
+  cache = PoolGetCache();
+  if (!cache) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEM,PETSC_ERROR_INITIAL,"Memory requested %.0f",(PetscLogDouble)sizeof(struct _n_PoolCache));
+  c = PoolClass((mem + PETSC_MEMALIGN-1) & ~(size_t)(PETSC_MEMALIGN-1));
+  if (!cache->free[c]) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+    err = PoolRefill(cache,c);
+    if (err) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEM,PETSC_ERROR_INITIAL,"Memory requested %.0f",(PetscLogDouble)POOL_ARENA_SIZE);
+  }
+  b              = cache->free[c];
+  cache->free[c] = b->next;
+  cache->nfree[c]--;
+  cache->requested += mem;
+  h        = (PoolHeader*)b;
+  h->magic = POOL_MAGIC;
+  h->cls   = c;
+  h->size  = mem;
+  *result  = (char*)h + POOL_HEADER;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFreePool"
+/*
+   PetscFreePool - Returns memory to the pool, with the calling sequence of PetscMallocSet()
+*/
+PetscErrorCode PetscFreePool(void *ptr,int line,const char func[],const char file[])
+{
+  PoolCache      cache;
+  PoolHeader     *h;
+  PoolBlock      *b;
+  size_t         mem;
+  int            c,n,i;
+  PetscErrorCode ierr;
+
+  if (!ptr) return 0;
+  h = (PoolHeader*)((char*)ptr - POOL_HEADER);
+  if (h->magic != POOL_MAGIC) {
+    if (h->magic == POOL_FREED) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_ARG_WRONG,PETSC_ERROR_INITIAL,"Memory already freed");
+    return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEMC,PETSC_ERROR_INITIAL,"Corrupted memory or memory not allocated with PetscMalloc()");
+  }
+  h->magic = POOL_FREED;
+  c        = h->cls;
+  mem      = h->size;
+  if (c == POOL_LARGE) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+    {
+      pool_large -= mem;
+      pool_held  -= POOL_HEADER+mem;
+    }
+    ierr = PetscFreeAlign(h,line,func,file);if (ierr) return ierr;
+    return 0;
+  }
+  cache = PoolGetCache();
+  if (!cache) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEM,PETSC_ERROR_INITIAL,"Memory requested %.0f",(PetscLogDouble)sizeof(struct _n_PoolCache));
+  b                 = (PoolBlock*)h;
+  b->next           = cache->free[c];
+  cache->free[c]    = b;
+  cache->requested -= mem;
+  if (++cache->nfree[c] > 2*(n = PoolBatch(c))) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+    for (i=0; i<n; i++) {
+      b              = cache->free[c];
+      cache->free[c] = b->next;
+      b->next        = pool_free[c];
+      pool_free[c]   = b;
+    }
+    cache->nfree[c] -= n;
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscReallocPool"
+/*
+   PetscReallocPool - Changes the size of memory from the pool, with the calling sequence of PetscReallocAlign()
+*/
+PetscErrorCode PetscReallocPool(size_t mem,int line,const char func[],const char file[],void **result)
+{
+  PoolHeader     *h;
+  void           *ptr;
+  PetscErrorCode ierr;
+
+  if (!*result) return PetscMallocPool(mem,line,func,file,result);
+  if (!mem) {
+    ierr    = PetscFreePool(*result,line,func,file);if (ierr) return ierr;
+    *result = NULL;
+    return 0;
+  }
+  h = (PoolHeader*)((char*)*result - POOL_HEADER);
+  if (h->magic != POOL_MAGIC) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEMC,PETSC_ERROR_INITIAL,"Corrupted memory or memory not allocated with PetscMalloc()");
+  /* a small block that has room for the new size is kept */
+  if (h->cls != POOL_LARGE && mem <= POOL_MAX_SMALL && PoolClass((mem + PETSC_MEMALIGN-1) & ~(size_t)(PETSC_MEMALIGN-1)) <= h->cls) {
+    PoolCache cache = PoolGetCache();
+    if (!cache) return PetscError(PETSC_COMM_SELF,line,func,file,PETSC_ERR_MEM,PETSC_ERROR_INITIAL,"Memory requested %.0f",(PetscLogDouble)sizeof(struct _n_PoolCache));
+    cache->requested += (PetscInt64)mem - (PetscInt64)h->size;
+    h->size           = mem;
+    return 0;
+  }
+  ierr = PetscMallocPool(mem,line,func,file,&ptr);if (ierr) return ierr;
+  ierr = PetscMemcpy(ptr,*result,PetscMin(mem,h->size));if (ierr) return ierr;
+  ierr = PetscFreePool(*result,line,func,file);if (ierr) return ierr;
+  *result = ptr;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocUsePool"
+/*@C
+   PetscMallocUsePool - Makes PetscMalloc() take memory from a pool instead of asking the system for every allocation
+
+   Not Collective
+
+   Options Database Key:
+.  -malloc_pool - calls PetscMallocUsePool() in PetscInitialize()
+
+   Notes:
+   Requests of up to 32 kilobytes are rounded up to one of a few sizes and carved from arenas of 4 megabytes; freed
+   memory is kept for later requests of the same size, in lists that belong to the thread that freed it, and is not
+   returned to the system. This avoids the fragmentation of the heap caused by the many small, short-lived allocations
+   of the setup phases (such as MatPtAP(), PCGAMG coarsening and DMPlex distribution) and allows threads to allocate
+   without locking. Larger requests are passed to the system.
+
+   The pool sits under the memory tracing of -malloc and -malloc_debug when these are used. Otherwise it replaces the
+   routines set with PetscMallocSet(), so it must be called before PetscInitialize() or not at all by programs that set
+   their own routines. Memory allocated before the pool is used must not be freed after.
+
+   PetscMemoryView() and -memory_view show how much memory the pool holds and how much of it is in use.
+
+   Level: advanced
+
+.seealso: PetscMallocSet(), PetscMallocPoolGetUsage(), PetscMemoryView()
+@*/
+PetscErrorCode PetscMallocUsePool(void)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (PetscTrMalloc == PetscMallocPool) PetscFunctionReturn(0);
+  if (PetscTrMalloc == PetscTrMallocDefault) {
+    ierr = PetscSetTrMallocBase_Private(PetscMallocPool,PetscFreePool,PetscReallocPool);CHKERRQ(ierr);
+  } else if (PetscTrMalloc == PetscMallocAlign) {
+    ierr           = PetscMallocSet(PetscMallocPool,PetscFreePool);CHKERRQ(ierr);
+    PetscTrRealloc = PetscReallocPool;
+  } else SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Cannot use the pool with routines set by PetscMallocSet()");
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPoolGetUsage"
+/*@C
+   PetscMallocPoolGetUsage - Gets the memory held by the PetscMalloc() pool and the part of it in use
+
+   Not Collective
+
+   Output Parameters:
++  space - the number of bytes requested with PetscMalloc() that are not freed yet
+.  held - the number of bytes the pool holds; held - space is lost to fragmentation, headers and free blocks
+-  maxheld - the largest number of bytes the pool has held
+
+   Notes:
+   All are zero when the pool is not used.
+
+   Level: advanced
+
+.seealso: PetscMallocUsePool(), PetscMemoryView(), PetscMallocGetCurrentUsage()
+@*/
+PetscErrorCode PetscMallocPoolGetUsage(PetscLogDouble *space,PetscLogDouble *held,PetscLogDouble *maxheld)
+{
+  PoolCache  cache;
+  PetscInt64 requested = 0;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp critical (PetscMallocPool)
+#endif
+  {
+    for (cache=pool_caches; cache; cache=cache->next) requested += cache->requested;
+    requested += pool_large;
+    if (space)   *space   = (PetscLogDouble)requested;
+    if (held)    *held    = (PetscLogDouble)pool_held;
+    if (maxheld) *maxheld = (PetscLogDouble)pool_maxheld;
+  }
+  PetscFunctionReturn(0);
+}
@@ -68,6 +68,13 @@ static size_t     PetscLogMallocThreshold = 0;
 static size_t     *PetscLogMallocLength;
 static const char **PetscLogMallocFile,**PetscLogMallocFunction;
 
+/*
+      The routines that provide the memory that is traced, PetscMallocUsePool() changes them
+*/
+static PetscErrorCode (*PetscTrMallocBase)(size_t,int,const char[],const char[],void**)  = PetscMallocAlign;
+static PetscErrorCode (*PetscTrFreeBase)(void*,int,const char[],const char[])            = PetscFreeAlign;
+static PetscErrorCode (*PetscTrReallocBase)(size_t,int,const char[],const char[],void**) = PetscReallocAlign;
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscSetUseTrMalloc_Private"
 PetscErrorCode PetscSetUseTrMalloc_Private(void)
@@ -86,6 +93,25 @@ PetscErrorCode PetscSetUseTrMalloc_Private(void)
   TRMaxMem          = 0;
   PetscLogMallocMax = 10000;
   PetscLogMalloc    = -1;
+
+  PetscTrMallocBase  = PetscMallocAlign;
+  PetscTrFreeBase    = PetscFreeAlign;
+  PetscTrReallocBase = PetscReallocAlign;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSetTrMallocBase_Private"
+/*
+   PetscSetTrMallocBase_Private - Sets the routines that provide the memory traced by PetscTrMallocDefault()
+*/
+PetscErrorCode PetscSetTrMallocBase_Private(PetscErrorCode (*imalloc)(size_t,int,const char[],const char[],void**),PetscErrorCode (*ifree)(void*,int,const char[],const char[]),PetscErrorCode (*irealloc)(size_t,int,const char[],const char[],void**))
+{
+  PetscFunctionBegin;
+  if (TRhead) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Cannot change the routines while traced memory is allocated");
+  PetscTrMallocBase  = imalloc;
+  PetscTrFreeBase    = ifree;
+  PetscTrReallocBase = irealloc;
   PetscFunctionReturn(0);
 }
 
@@ -188,7 +214,7 @@ PetscErrorCode  PetscTrMallocDefault(size_t a,int lineno,const char function[],c
   }
 
   nsize = (a + (PETSC_MEMALIGN-1)) & ~(PETSC_MEMALIGN-1);
-  ierr  = PetscMallocAlign(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,(void**)&inew);CHKERRQ(ierr);
+  ierr  = (*PetscTrMallocBase)(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,(void**)&inew);CHKERRQ(ierr);
 
   head  = (TRSPACE*)inew;
   inew += sizeof(TrSPACE);
@@ -317,7 +343,7 @@ PetscErrorCode  PetscTrFreeDefault(void *aa,int line,const char function[],const
   else TRhead = head->next;
 
   if (head->next) head->next->prev = head->prev;
-  ierr = PetscFreeAlign(a,line,function,file);CHKERRQ(ierr);
+  ierr = (*PetscTrFreeBase)(a,line,function,file);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -394,7 +420,7 @@ PetscErrorCode PetscTrReallocDefault(size_t len, int lineno, const char function
   if (head->next) head->next->prev = head->prev;
 
   nsize = (len + (PETSC_MEMALIGN-1)) & ~(PETSC_MEMALIGN-1);
-  ierr  = PetscReallocAlign(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,(void**)&inew);CHKERRQ(ierr);
+  ierr  = (*PetscTrReallocBase)(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,(void**)&inew);CHKERRQ(ierr);
 
   head  = (TRSPACE*)inew;
   inew += sizeof(TrSPACE);
@@ -463,18 +489,20 @@ PetscErrorCode PetscTrReallocDefault(size_t len, int lineno, const char function
 
     Options Database:
 +    -malloc - have PETSc track how much memory it has allocated
+.    -malloc_pool - also show how much memory the PetscMalloc() pool holds, see PetscMallocUsePool()
 -    -memory_view - during PetscFinalize() have this routine called
 
     Level: intermediate
 
     Concepts: memory usage
 
-.seealso: PetscMallocDump(), PetscMemoryGetCurrentUsage(), PetscMemorySetGetMaximumUsage()
+.seealso: PetscMallocDump(), PetscMemoryGetCurrentUsage(), PetscMemorySetGetMaximumUsage(), PetscMallocPoolGetUsage()
  @*/
 PetscErrorCode  PetscMemoryView(PetscViewer viewer,const char message[])
 {
   PetscLogDouble allocated,allocatedmax,resident,residentmax,gallocated,gallocatedmax,gresident,gresidentmax,maxgallocated,maxgallocatedmax,maxgresident,maxgresidentmax;
   PetscLogDouble mingallocated,mingallocatedmax,mingresident,mingresidentmax;
+  PetscLogDouble space,held,heldmax,gspace,gheld,gheldmax,maxgspace,maxgheld,maxgheldmax,mingspace,mingheld,mingheldmax;
   PetscErrorCode ierr;
   MPI_Comm       comm;
 
@@ -533,6 +561,22 @@ PetscErrorCode  PetscMemoryView(PetscViewer viewer,const char message[])
   } else {
     ierr = PetscViewerASCIIPrintf(viewer,"Run with -malloc to get statistics on PetscMalloc() calls\nOS cannot compute process memory\n");CHKERRQ(ierr);
   }
+  ierr = PetscMallocPoolGetUsage(&space,&held,&heldmax);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&heldmax,&maxgheldmax,1,MPIU_PETSCLOGDOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+  if (maxgheldmax > 0) {
+    ierr = MPI_Reduce(&heldmax,&gheldmax,1,MPIU_PETSCLOGDOUBLE,MPI_SUM,0,comm);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&heldmax,&mingheldmax,1,MPIU_PETSCLOGDOUBLE,MPI_MIN,0,comm);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Maximum (over computational time) memory held by pool:   total %5.4e max %5.4e min %5.4e\n",gheldmax,maxgheldmax,mingheldmax);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&held,&gheld,1,MPIU_PETSCLOGDOUBLE,MPI_SUM,0,comm);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&held,&maxgheld,1,MPIU_PETSCLOGDOUBLE,MPI_MAX,0,comm);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&held,&mingheld,1,MPIU_PETSCLOGDOUBLE,MPI_MIN,0,comm);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Current memory held by pool:                             total %5.4e max %5.4e min %5.4e\n",gheld,maxgheld,mingheld);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&space,&gspace,1,MPIU_PETSCLOGDOUBLE,MPI_SUM,0,comm);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&space,&maxgspace,1,MPIU_PETSCLOGDOUBLE,MPI_MAX,0,comm);CHKERRQ(ierr);
+    ierr = MPI_Reduce(&space,&mingspace,1,MPIU_PETSCLOGDOUBLE,MPI_MIN,0,comm);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Current space in use in pool:                            total %5.4e max %5.4e min %5.4e\n",gspace,maxgspace,mingspace);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Current fragmentation of pool (1 - space in use/held):   %g\n",gheld > 0 ? 1.0 - gspace/gheld : 0.0);CHKERRQ(ierr);
+  }
   ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -321,6 +321,9 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     ierr = PetscMallocDebug(PETSC_TRUE);CHKERRQ(ierr);
   }
 #endif
+  flg1 = PETSC_FALSE;
+  ierr = PetscOptionsGetBool(NULL,NULL,"-malloc_pool",&flg1,NULL);CHKERRQ(ierr);
+  if (flg1) {ierr = PetscMallocUsePool();CHKERRQ(ierr);}
 
   flg1 = PETSC_FALSE;
   ierr = PetscOptionsGetBool(NULL,NULL,"-malloc_info",&flg1,NULL);CHKERRQ(ierr);
@@ -530,6 +533,10 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
       ierr = PetscLogDefaultBegin();CHKERRQ(ierr);
     }
   }
+
+  /* last, so that it records on top of the handlers chosen above */
+  ierr = PetscOptionsHasName(NULL,NULL,"-log_chrome",&flg1);CHKERRQ(ierr);
+  if (flg1) {ierr = PetscLogChromeBegin();CHKERRQ(ierr);}
 #endif
 
   ierr = PetscOptionsGetBool(NULL,NULL,"-saws_options",&PetscOptionsPublish,NULL);CHKERRQ(ierr);
@@ -635,6 +642,7 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     ierr = (*PetscHelpPrintf)(comm," -malloc_info: prints total memory usage\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -malloc_log: keeps log of all memory allocations\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -malloc_debug: enables extended checking for memory corruption\n");CHKERRQ(ierr);
+    ierr = (*PetscHelpPrintf)(comm," -malloc_pool: take memory from a pool with free lists for each size\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_table: dump list of options inputted\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_left: dump list of unused options\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_left no: don't dump list of unused options\n");CHKERRQ(ierr);
@@ -646,6 +654,7 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     ierr = (*PetscHelpPrintf)(comm," -get_total_flops: total flops over all processors\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -log[_summary _summary_python]: logging objects and events\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -log_trace [filename]: prints trace of all PETSc calls\n");CHKERRQ(ierr);
+    ierr = (*PetscHelpPrintf)(comm," -log_chrome [filename]: writes a timeline of all events in the Chrome trace format\n");CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPE)
     ierr = (*PetscHelpPrintf)(comm," -log_mpe: Also create logfile viewable through Jumpshot\n");CHKERRQ(ierr);
 #endif
@@ -5,6 +5,7 @@
 #include <petsc/private/petscimpl.h>        /*I  "petscsys.h"   I*/
 #include <petscvalgrind.h>
 #include <petscviewer.h>
+#include <petsc/private/logimpl.h>
 
 #if defined(PETSC_USE_LOG)
 extern PetscErrorCode PetscLogInitialize(void);
@@ -667,6 +668,7 @@ PetscErrorCode  PetscInitializeSAWs(const char help[])
 .  -malloc_debug - check for memory corruption at EVERY malloc or free
 .  -malloc_dump - prints a list of all unfreed memory at the end of the run
 .  -malloc_test - like -malloc_dump -malloc_debug, but only active for debugging builds
+.  -malloc_pool - take memory from a pool with free lists for each size, see PetscMallocUsePool()
 .  -fp_trap - Stops on floating point exceptions (Note that on the
               IBM RS6000 this slows code by at least a factor of 10.)
 .  -no_signal_handler - Indicates not to trap error signals
@@ -684,6 +686,8 @@ PetscErrorCode  PetscInitializeSAWs(const char help[])
 .  -log_trace [filename] - Print traces of all PETSc calls to the screen (useful to determine where a program
         hangs without running in the debugger).  See PetscLogTraceBegin().
 .  -log_view [:filename:format] - Prints summary of flop and timing information to screen or file, see PetscLogView().
+.  -log_chrome [filename] - Writes a timeline of all events, for chrome://tracing or Perfetto, at PetscFinalize(); may be combined
+        with the other options.  See PetscLogChromeBegin().
 .  -log_summary [filename] - (Deprecated, use -log_view) Prints summary of flop and timing information to screen. If the filename is specified the
         summary is written to the file.  See PetscLogView().
 .  -log_exclude: <vec,mat,pc.ksp,snes> - excludes subset of object classes from logging
@@ -1139,6 +1143,14 @@ PetscErrorCode  PetscFinalize(void)
     if (mname[0]) PetscLogDump(mname);
     else          PetscLogDump(0);
   }
+  mname[0] = 0;
+
+  ierr = PetscOptionsGetString(NULL,NULL,"-log_chrome",mname,PETSC_MAX_PATH_LEN,&flg1);CHKERRQ(ierr);
+  if (flg1) {
+    if (mname[0]) {ierr = PetscLogChromeDump(mname);CHKERRQ(ierr);}
+    else          {ierr = PetscLogChromeDump(0);CHKERRQ(ierr);}
+  }
+  ierr = PetscLogChromeEnd();CHKERRQ(ierr);
 #endif
 
   /*
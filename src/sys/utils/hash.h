@@ -644,6 +644,481 @@ PETSC_STATIC_INLINE PetscErrorCode PetscHashIGetKeys(PetscHashI ht, PetscInt *n,
     }                                                                  \
 } while (0)
 
+/*
+  Grouped open addressing
+
+  The tables made by KHASH_GROUP_INIT() keep one control byte per bucket: the 7 low bits of the hash of the key in a
+  full bucket, or KG_EMPTY or KG_DELETED. The buckets are split in groups of KG_WIDTH, and a key is looked for in a
+  whole group at a time by comparing its control byte with all those of the group; with SSE2 this is a single
+  instruction, so that the keys themselves are only compared in the rare buckets whose control bytes match. The
+  groups are probed quadratically, and the probing stops at the first group that has an empty bucket. The number of
+  buckets is a power of 2 and the tables grow when 7/8 of the buckets are full or deleted.
+*/
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define KG_WIDTH 16
+#else
+#define KG_WIDTH 8
+#endif
+#define KG_EMPTY   ((unsigned char)0x80)
+#define KG_DELETED ((unsigned char)0xFE)
+
+/* bit b of a mask is set when bucket b of the group matches */
+typedef unsigned int kg_mask_t;
+
+PETSC_STATIC_INLINE kg_mask_t kg_match_byte(const unsigned char *g,unsigned char c)
+{
+#if defined(__SSE2__)
+  return (kg_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)g),_mm_set1_epi8((char)c)));
+#else
+  kg_mask_t m = 0;
+  int       b;
+  for (b=0; b<KG_WIDTH; b++) m |= (kg_mask_t)(g[b] == c) << b;
+  return m;
+#endif
+}
+
+/* the buckets that are empty or deleted, that is whose control byte has its high bit set */
+PETSC_STATIC_INLINE kg_mask_t kg_match_free(const unsigned char *g)
+{
+#if defined(__SSE2__)
+  return (kg_mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)g));
+#else
+  kg_mask_t m = 0;
+  int       b;
+  for (b=0; b<KG_WIDTH; b++) m |= (kg_mask_t)(g[b] >> 7) << b;
+  return m;
+#endif
+}
+
+PETSC_STATIC_INLINE int kg_first(kg_mask_t m)
+{
+#if defined(__GNUC__)
+  return __builtin_ctz(m);
+#else
+  int b = 0;
+  while (!(m & 1)) {m >>= 1; b++;}
+  return b;
+#endif
+}
+
+/* mixes the bits of the key so that keys with a common stride do not collide */
+PETSC_STATIC_INLINE khint32_t kg_int_hash_func(khint32_t key)
+{
+  key ^= key >> 16; key *= 0x85ebca6bU;
+  key ^= key >> 13; key *= 0xc2b2ae35U;
+  key ^= key >> 16;
+  return key;
+}
+
+PETSC_STATIC_INLINE khint32_t kg_int64_hash_func(khint64_t key)
+{
+  key ^= key >> 33; key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33; key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return (khint32_t)key;
+}
+
+#define KHASH_GROUP_INIT(name, khkey_t, khval_t, kh_is_map, __hash_func, __hash_equal)       \
+        typedef struct {khkey_t key; khval_t val;} kg_##name##_ent_t;                        \
+        typedef struct {                                                                     \
+                khint_t n_groups, size, growth_left;                                         \
+                unsigned char *ctrl;                                                         \
+                kg_##name##_ent_t *ents;                                                     \
+        } kg_##name##_t;                                                                     \
+        PETSC_STATIC_INLINE kg_##name##_t *kg_init_##name(void) {                            \
+                return (kg_##name##_t*)calloc(1, sizeof(kg_##name##_t));                     \
+        }                                                                                    \
+        PETSC_STATIC_INLINE void kg_destroy_##name(kg_##name##_t *h)                         \
+        {                                                                                    \
+                if (h) {free(h->ctrl); free(h->ents); free(h);}                              \
+        }                                                                                    \
+        PETSC_UNUSED PETSC_STATIC_INLINE void kg_clear_##name(kg_##name##_t *h)              \
+        {                                                                                    \
+                khint_t nb = h->n_groups*KG_WIDTH;                                           \
+                if (nb) memset(h->ctrl, KG_EMPTY, nb);                                       \
+                h->size = 0; h->growth_left = nb - nb/8;                                     \
+        }                                                                                    \
+        PETSC_UNUSED PETSC_STATIC_INLINE khint_t kg_get_##name(const kg_##name##_t *h, khkey_t key) \
+        {                                                                                    \
+                khint_t       k = __hash_func(key), gmask = h->n_groups - 1, g, step = 0;    \
+                unsigned char h2 = (unsigned char)(k & 0x7f);                                \
+                kg_mask_t     m;                                                             \
+                if (!h->n_groups) return 0;                                                  \
+                for (g = (k >> 7) & gmask; ; g = (g + ++step) & gmask) {                     \
+                        const unsigned char *c = h->ctrl + g*KG_WIDTH;                       \
+                        for (m = kg_match_byte(c, h2); m; m &= m - 1) {                      \
+                                khint_t i = g*KG_WIDTH + kg_first(m);                        \
+                                if (__hash_equal(h->ents[i].key, key)) return i;             \
+                        }                                                                    \
+                        if (kg_match_byte(c, KG_EMPTY) || step == gmask) return h->n_groups*KG_WIDTH; \
+                }                                                                            \
+        }                                                                                    \
+        /* the first free bucket in the sequence of probes of a key */                       \
+        PETSC_STATIC_INLINE khint_t kg_find_free_##name(const kg_##name##_t *h, khint_t k)   \
+        {                                                                                    \
+                khint_t   gmask = h->n_groups - 1, g, step = 0;                              \
+                kg_mask_t m;                                                                 \
+                for (g = (k >> 7) & gmask; ; g = (g + ++step) & gmask) {                     \
+                        m = kg_match_free(h->ctrl + g*KG_WIDTH);                             \
+                        if (m) return g*KG_WIDTH + kg_first(m);                              \
+                }                                                                            \
+        }                                                                                    \
+        /* makes room for at least n keys without growing, and removes the deleted buckets; returns -1 if out of memory */ \
+        PETSC_UNUSED PETSC_STATIC_INLINE int kg_resize_##name(kg_##name##_t *h, khint_t n)   \
+        {                                                                                    \
+                kg_##name##_t nh;                                                            \
+                khint_t       ng = 1, i, j, k;                                               \
+                if (n < h->size) n = h->size;                                                \
+                while ((ng*KG_WIDTH) - (ng*KG_WIDTH)/8 < n) ng <<= 1;                        \
+                nh.n_groups = ng; nh.size = h->size;                                         \
+                nh.growth_left = ng*KG_WIDTH - (ng*KG_WIDTH)/8 - h->size;                    \
+                nh.ctrl = (unsigned char*)malloc(ng*KG_WIDTH);                               \
+                nh.ents = (kg_##name##_ent_t*)malloc(ng*KG_WIDTH*sizeof(kg_##name##_ent_t)); \
+                if (!nh.ctrl || !nh.ents) {                                                  \
+                        free(nh.ctrl); free(nh.ents); return -1;                             \
+                }                                                                            \
+                memset(nh.ctrl, KG_EMPTY, ng*KG_WIDTH);                                      \
+                for (i = 0; i < h->n_groups*KG_WIDTH; i++) {                                 \
+                        if (h->ctrl[i] & 0x80) continue;                                     \
+                        k = __hash_func(h->ents[i].key);                                     \
+                        j = kg_find_free_##name(&nh, k);                                     \
+                        nh.ctrl[j] = (unsigned char)(k & 0x7f);                              \
+                        nh.ents[j] = h->ents[i];                                             \
+                }                                                                            \
+                free(h->ctrl); free(h->ents);                                                \
+                *h = nh;                                                                     \
+                return 0;                                                                    \
+        }                                                                                    \
+        /* *ret is 1 if the key is added, 0 if it is present and -1 if out of memory */      \
+        PETSC_UNUSED PETSC_STATIC_INLINE khint_t kg_put_##name(kg_##name##_t *h, khkey_t key, int *ret) \
+        {                                                                                    \
+                khint_t i = kg_get_##name(h, key), k;                                        \
+                if (i != h->n_groups*KG_WIDTH) {*ret = 0; return i;}                         \
+                if (!h->growth_left) {                                                       \
+                        /* grow, unless there are enough deleted buckets to make room */     \
+                        khint_t nb = h->n_groups*KG_WIDTH, n = h->size + 1;                  \
+                        if (n > (nb - nb/8)/2) n = nb ? 2*(nb - nb/8) : 1;                   \
+                        if (kg_resize_##name(h, n)) {*ret = -1; return 0;}                   \
+                }                                                                            \
+                k = __hash_func(key);                                                        \
+                i = kg_find_free_##name(h, k);                                               \
+                if (h->ctrl[i] == KG_EMPTY) h->growth_left--;                                \
+                h->ctrl[i] = (unsigned char)(k & 0x7f);                                      \
+                h->ents[i].key = key;                                                        \
+                h->size++;                                                                   \
+                *ret = 1;                                                                    \
+                return i;                                                                    \
+        }                                                                                    \
+        PETSC_UNUSED PETSC_STATIC_INLINE void kg_del_##name(kg_##name##_t *h, khint_t i)     \
+        {                                                                                    \
+                const unsigned char *c;                                                      \
+                if (i >= h->n_groups*KG_WIDTH || (h->ctrl[i] & 0x80)) return;                \
+                /* a probe passes a group without empty buckets, so the bucket must stay deleted there */ \
+                c = h->ctrl + (i/KG_WIDTH)*KG_WIDTH;                                         \
+                if (kg_match_byte(c, KG_EMPTY)) {h->ctrl[i] = KG_EMPTY; h->growth_left++;}   \
+                else h->ctrl[i] = KG_DELETED;                                                \
+                h->size--;                                                                   \
+        }
+
+#define kg_t(name)         kg_##name##_t
+#define kg_init(name)      kg_init_##name()
+#define kg_destroy(name,h) kg_destroy_##name(h)
+#define kg_clear(name,h)   kg_clear_##name(h)
+#define kg_resize(name,h,n) kg_resize_##name(h,n)
+#define kg_put(name,h,k,r) kg_put_##name(h,k,r)
+#define kg_get(name,h,k)   kg_get_##name(h,k)
+#define kg_del(name,h,x)   kg_del_##name(h,x)
+#define kg_exist(h,x)      (!((h)->ctrl[x] & 0x80))
+#define kg_key(h,x)        ((h)->ents[x].key)
+#define kg_val(h,x)        ((h)->ents[x].val)
+#define kg_begin(h)        (khint_t)(0)
+#define kg_end(h)          ((h)->n_groups*KG_WIDTH)
+#define kg_size(h)         ((h)->size)
+
+#if defined(PETSC_USE_64BIT_INDICES)
+#define kg_petscint_hash_func(key) kg_int64_hash_func((khint64_t)(key))
+#else
+#define kg_petscint_hash_func(key) kg_int_hash_func((khint32_t)(key))
+#endif
+#define kg_petscint_hash_equal(a,b) ((a) == (b))
+
+KHASH_GROUP_INIT(HSetI,PetscInt,char,0,kg_petscint_hash_func,kg_petscint_hash_equal)
+KHASH_GROUP_INIT(HMapI,PetscInt,PetscInt,1,kg_petscint_hash_func,kg_petscint_hash_equal)
+
+/*S
+   PetscHSetI - A hash set of PetscInt
+
+   Level: developer
+
+   Notes:
+   This is defined in src/sys/utils/hash.h, which is not a public include file.
+
+.seealso: PetscHSetICreate(), PetscHSetIAdd(), PetscHSetIHas(), PetscHMapI
+S*/
+typedef kg_t(HSetI) *PetscHSetI;
+
+/*S
+   PetscHMapI - A hash map from PetscInt to PetscInt
+
+   Level: developer
+
+   Notes:
+   This replaces PetscTable: the keys may be any PetscInt and need not be shifted by one, and the table grows as
+   needed.
+
+.seealso: PetscHMapICreate(), PetscHMapISet(), PetscHMapIGet(), PetscHSetI, PetscTable
+S*/
+typedef kg_t(HMapI) *PetscHMapI;
+
+/* a position in a PetscHSetI or PetscHMapI, for iterating over its entries */
+typedef khint_t PetscHashIter;
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetICreate"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetICreate(PetscHSetI *ht)
+{
+  PetscFunctionBegin;
+  *ht = kg_init(HSetI);
+  if (!*ht) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Memory requested %D",(PetscInt)sizeof(kg_t(HSetI)));
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIDestroy"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIDestroy(PetscHSetI *ht)
+{
+  PetscFunctionBegin;
+  kg_destroy(HSetI,*ht);
+  *ht = NULL;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIClear"
+/* removes all entries but keeps the memory */
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIClear(PetscHSetI ht)
+{
+  PetscFunctionBegin;
+  kg_clear(HSetI,ht);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIResize"
+/* makes room for n entries */
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIResize(PetscHSetI ht,PetscInt n)
+{
+  PetscFunctionBegin;
+  if (kg_resize(HSetI,ht,(khint_t)n)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot make room for %D entries",n);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIGetSize"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIGetSize(PetscHSetI ht,PetscInt *n)
+{
+  PetscFunctionBegin;
+  *n = (PetscInt)kg_size(ht);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIHas"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIHas(PetscHSetI ht,PetscInt key,PetscBool *has)
+{
+  PetscFunctionBegin;
+  *has = kg_get(HSetI,ht,key) != kg_end(ht) ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIQueryAdd"
+/* adds the key and tells whether it was missing */
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIQueryAdd(PetscHSetI ht,PetscInt key,PetscBool *missing)
+{
+  int ret;
+
+  PetscFunctionBegin;
+  kg_put(HSetI,ht,key,&ret);
+  if (ret < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot grow hash set");
+  *missing = ret ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIAdd"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIAdd(PetscHSetI ht,PetscInt key)
+{
+  int ret;
+
+  PetscFunctionBegin;
+  kg_put(HSetI,ht,key,&ret);
+  if (ret < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot grow hash set");
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIDel"
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIDel(PetscHSetI ht,PetscInt key)
+{
+  PetscFunctionBegin;
+  kg_del(HSetI,ht,kg_get(HSetI,ht,key));
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHSetIGetElems"
+/* puts the entries, in no particular order, in array starting at *off and advances *off past them */
+PETSC_STATIC_INLINE PetscErrorCode PetscHSetIGetElems(PetscHSetI ht,PetscInt *off,PetscInt array[])
+{
+  PetscHashIter i;
+  PetscInt      n = *off;
+
+  PetscFunctionBegin;
+  for (i=kg_begin(ht); i<kg_end(ht); i++) if (kg_exist(ht,i)) array[n++] = kg_key(ht,i);
+  *off = n;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapICreate"
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapICreate(PetscHMapI *ht)
+{
+  PetscFunctionBegin;
+  *ht = kg_init(HMapI);
+  if (!*ht) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Memory requested %D",(PetscInt)sizeof(kg_t(HMapI)));
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIDestroy"
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIDestroy(PetscHMapI *ht)
+{
+  PetscFunctionBegin;
+  kg_destroy(HMapI,*ht);
+  *ht = NULL;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIClear"
+/* removes all entries but keeps the memory */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIClear(PetscHMapI ht)
+{
+  PetscFunctionBegin;
+  kg_clear(HMapI,ht);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIResize"
+/* makes room for n entries */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIResize(PetscHMapI ht,PetscInt n)
+{
+  PetscFunctionBegin;
+  if (kg_resize(HMapI,ht,(khint_t)n)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot make room for %D entries",n);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIGetSize"
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIGetSize(PetscHMapI ht,PetscInt *n)
+{
+  PetscFunctionBegin;
+  *n = (PetscInt)kg_size(ht);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIHas"
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIHas(PetscHMapI ht,PetscInt key,PetscBool *has)
+{
+  PetscFunctionBegin;
+  *has = kg_get(HMapI,ht,key) != kg_end(ht) ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIGet"
+/* gets the value of the key, or -1 if the key is not present */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIGet(PetscHMapI ht,PetscInt key,PetscInt *val)
+{
+  PetscHashIter i;
+
+  PetscFunctionBegin;
+  i    = kg_get(HMapI,ht,key);
+  *val = i != kg_end(ht) ? kg_val(ht,i) : -1;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapISet"
+/* adds the key or replaces its value */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapISet(PetscHMapI ht,PetscInt key,PetscInt val)
+{
+  PetscHashIter i;
+  int           ret;
+
+  PetscFunctionBegin;
+  i = kg_put(HMapI,ht,key,&ret);
+  if (ret < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot grow hash map");
+  kg_val(ht,i) = val;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIQuerySet"
+/* sets the value of the key only if it is missing, and tells whether it was */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIQuerySet(PetscHMapI ht,PetscInt key,PetscInt val,PetscBool *missing)
+{
+  PetscHashIter i;
+  int           ret;
+
+  PetscFunctionBegin;
+  i = kg_put(HMapI,ht,key,&ret);
+  if (ret < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Cannot grow hash map");
+  if (ret) kg_val(ht,i) = val;
+  *missing = ret ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIDel"
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIDel(PetscHMapI ht,PetscInt key)
+{
+  PetscFunctionBegin;
+  kg_del(HMapI,ht,kg_get(HMapI,ht,key));
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscHMapIGetPairs"
+/* puts the entries, in no particular order, in keys and vals starting at *off and advances *off past them */
+PETSC_STATIC_INLINE PetscErrorCode PetscHMapIGetPairs(PetscHMapI ht,PetscInt *off,PetscInt keys[],PetscInt vals[])
+{
+  PetscHashIter i;
+  PetscInt      n = *off;
+
+  PetscFunctionBegin;
+  for (i=kg_begin(ht); i<kg_end(ht); i++) {
+    if (kg_exist(ht,i)) {
+      if (keys) keys[n] = kg_key(ht,i);
+      if (vals) vals[n] = kg_val(ht,i);
+      n++;
+    }
+  }
+  *off = n;
+  PetscFunctionReturn(0);
+}
+
+/* iterate over the entries of a PetscHSetI or PetscHMapI; the table must not be changed meanwhile */
+#define PetscHashIterNext(ht,i)     do {++(i);} while ((i) < kg_end((ht)) && !kg_exist((ht),(i)))
+#define PetscHashIterBegin(ht,i)    do {(i) = kg_begin((ht)); if ((i) < kg_end((ht)) && !kg_exist((ht),(i))) PetscHashIterNext((ht),(i));} while (0)
+#define PetscHashIterAtEnd(ht,i)    ((i) >= kg_end((ht)))
+#define PetscHashIterGetKey(ht,i,k) ((k) = kg_key((ht),(i)))
+#define PetscHashIterGetVal(ht,i,v) ((v) = kg_val((ht),(i)))
+
 /* HASHIJ */
 /* Linked list of values in a bucket. */
 struct _IJNode {
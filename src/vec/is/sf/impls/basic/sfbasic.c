@@ -1,5 +1,6 @@
 
 #include <petsc/private/sfimpl.h> /*I "petscsf.h" I*/
+#include <petsc/private/sfpackimpl.h>
 
 typedef struct _n_PetscSFBasicPack *PetscSFBasicPack;
 struct _n_PetscSFBasicPack {
@@ -34,6 +35,7 @@ struct _n_PetscSFBasicPack {
   MPI_Datatype     unit;
   size_t           unitbytes;   /* Number of bytes in a unit */
   PetscInt         bs;          /* Number of basic units in a unit */
+  PetscBool        isscalar;    /* The basic unit is PetscScalar, so the pack plans of the PetscSF can be used */
   const void       *key;        /* Array used as key for operation */
   char             *root;       /* Packed root data, contiguous by leaf rank */
   char             *leaf;       /* Packed leaf data, contiguous by root rank */
@@ -50,6 +52,10 @@ typedef struct {
   PetscInt         *irootloc;   /* Incoming roots referenced by ranks starting at ioffset[rank] */
   PetscSFBasicPack avail;       /* One or more entries per MPI Datatype, lazily constructed */
   PetscSFBasicPack inuse;       /* Buffers being used for transactions that have not yet completed */
+  PetscBool        usepackopt;  /* Build plans that pack runs of indices with memcpy() or strided loops */
+  PetscInt         packthreads; /* Number of threads the plans may use */
+  PetscSFPackOpt   rootpackopt; /* Plan for irootloc[], may be NULL */
+  PetscSFPackOpt   leafpackopt; /* Plan for rmine[], may be NULL */
 } PetscSF_Basic;
 
 #if !defined(PETSC_HAVE_MPI_TYPE_DUP) /* Danger: type is not reference counted; subject to ABA problem */
@@ -570,6 +576,10 @@ static PetscErrorCode PetscSFSetUp_Basic(PetscSF sf)
   ierr = MPI_Waitall(sf->nranks,leafreqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
   ierr = PetscFree(ilengths);CHKERRQ(ierr);
   ierr = PetscFree2(rootreqs,leafreqs);CHKERRQ(ierr);
+  if (bas->usepackopt) {
+    ierr = PetscSFPackOptCreate(bas->niranks,bas->ioffset,bas->irootloc,bas->packthreads,&bas->rootpackopt);CHKERRQ(ierr);
+    ierr = PetscSFPackOptCreate(sf->nranks,sf->roffset,sf->rmine,bas->packthreads,&bas->leafpackopt);CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -597,7 +607,12 @@ static PetscErrorCode PetscSFBasicPackTypeSetup(PetscSFBasicPack link,MPI_Dataty
 #endif
   ierr = MPIPetsc_Type_compare(unit,MPI_2INT,&is2Int);CHKERRQ(ierr);
   ierr = MPIPetsc_Type_compare(unit,MPIU_2INT,&is2PetscInt);CHKERRQ(ierr);
-  link->bs = 1;
+  link->bs       = 1;
+#if defined(PETSC_USE_COMPLEX)
+  link->isscalar = (PetscBool)(isPetscComplex || nPetscComplexContig);
+#else
+  link->isscalar = (PetscBool)(isPetscReal || nPetscRealContig);
+#endif
   if (isInt) {PackInit_int(link); PackInit_Logical_int(link); PackInit_Bitwise_int(link);}
   else if (isPetscInt) {PackInit_PetscInt(link); PackInit_Logical_PetscInt(link); PackInit_Bitwise_PetscInt(link);}
   else if (isPetscReal) {PackInit_PetscReal(link); PackInit_Logical_PetscReal(link);}
@@ -701,6 +716,23 @@ static PetscErrorCode PetscSFBasicPackGetFetchAndOp(PetscSF sf,PetscSFBasicPack
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFBasicPackGetInsertMode"
+/* Whether the unpacking with op can be done by a pack plan, and the corresponding InsertMode */
+static PetscErrorCode PetscSFBasicPackGetInsertMode(PetscSFBasicPack link,MPI_Op op,PetscBool *flg,InsertMode *addv)
+{
+  PetscFunctionBegin;
+  *flg  = link->isscalar;
+  *addv = NOT_SET_VALUES;
+  if (op == MPIU_REPLACE) *addv = INSERT_VALUES;
+  else if (op == MPI_SUM || op == MPIU_SUM) *addv = ADD_VALUES;
+#if !defined(PETSC_USE_COMPLEX)
+  else if (op == MPI_MAX || op == MPIU_MAX) *addv = MAX_VALUES;
+#endif
+  else *flg = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscSFBasicPackGetReqs"
 static PetscErrorCode PetscSFBasicPackGetReqs(PetscSF sf,PetscSFBasicPack link,MPI_Request **rootreqs,MPI_Request **leafreqs)
@@ -834,10 +866,13 @@ static PetscErrorCode PetscSFBasicReclaimPack(PetscSF sf,PetscSFBasicPack *link)
 #define __FUNCT__ "PetscSFSetFromOptions_Basic"
 static PetscErrorCode PetscSFSetFromOptions_Basic(PetscOptionItems *PetscOptionsObject,PetscSF sf)
 {
+  PetscSF_Basic  *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   ierr = PetscOptionsHead(PetscOptionsObject,"PetscSF Basic options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-sf_basic_packopt","Pack runs of indices with memcpy() or strided loops","PetscSFSetFromOptions",bas->usepackopt,&bas->usepackopt,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-sf_basic_pack_threads","Number of threads used to pack and unpack large messages","PetscSFSetFromOptions",bas->packthreads,&bas->packthreads,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -853,6 +888,8 @@ static PetscErrorCode PetscSFReset_Basic(PetscSF sf)
   PetscFunctionBegin;
   ierr = PetscFree(bas->iranks);CHKERRQ(ierr);
   ierr = PetscFree2(bas->ioffset,bas->irootloc);CHKERRQ(ierr);
+  ierr = PetscSFPackOptDestroy(&bas->rootpackopt);CHKERRQ(ierr);
+  ierr = PetscSFPackOptDestroy(&bas->leafpackopt);CHKERRQ(ierr);
   if (bas->inuse) SETERRQ(PetscObjectComm((PetscObject)sf),PETSC_ERR_ARG_WRONGSTATE,"Outstanding operation has not been completed");
   for (link=bas->avail; link; link=next) {
     next = link->next;
@@ -926,7 +963,8 @@ static PetscErrorCode PetscSFBcastBegin_Basic(PetscSF sf,MPI_Datatype unit,const
   for (i=0; i<nrootranks; i++) {
     PetscMPIInt n          = rootoffset[i+1] - rootoffset[i];
     void        *packstart = link->root+rootoffset[i]*unitbytes;
-    (*link->Pack)(n,link->bs,rootloc+rootoffset[i],rootdata,packstart);
+    if (link->isscalar && bas->rootpackopt) {ierr = PetscSFPackOptPack(bas->rootpackopt,i,i+1,link->bs,link->bs,(const PetscScalar*)rootdata,(PetscScalar*)packstart);CHKERRQ(ierr);}
+    else (*link->Pack)(n,link->bs,rootloc+rootoffset[i],rootdata,packstart);
     ierr = MPI_Isend(packstart,n,unit,rootranks[i],bas->tag,PetscObjectComm((PetscObject)sf),&rootreqs[i]);CHKERRQ(ierr);
   }
   PetscFunctionReturn(0);
@@ -936,6 +974,7 @@ static PetscErrorCode PetscSFBcastBegin_Basic(PetscSF sf,MPI_Datatype unit,const
 #define __FUNCT__ "PetscSFBcastEnd_Basic"
 PetscErrorCode PetscSFBcastEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *rootdata,void *leafdata)
 {
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   PetscErrorCode   ierr;
   PetscSFBasicPack link;
   PetscInt         i,nleafranks;
@@ -948,7 +987,8 @@ PetscErrorCode PetscSFBcastEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *ro
   for (i=0; i<nleafranks; i++) {
     PetscMPIInt n          = leafoffset[i+1] - leafoffset[i];
     const void  *packstart = link->leaf+leafoffset[i]*link->unitbytes;
-    (*link->UnpackInsert)(n,link->bs,leafloc+leafoffset[i],leafdata,packstart);
+    if (link->isscalar && bas->leafpackopt) {ierr = PetscSFPackOptUnpack(bas->leafpackopt,i,i+1,link->bs,link->bs,(const PetscScalar*)packstart,(PetscScalar*)leafdata,INSERT_VALUES);CHKERRQ(ierr);}
+    else (*link->UnpackInsert)(n,link->bs,leafloc+leafoffset[i],leafdata,packstart);
   }
   ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -985,7 +1025,8 @@ PetscErrorCode PetscSFReduceBegin_Basic(PetscSF sf,MPI_Datatype unit,const void
   for (i=0; i<nleafranks; i++) {
     PetscMPIInt n          = leafoffset[i+1] - leafoffset[i];
     void        *packstart = link->leaf+leafoffset[i]*unitbytes;
-    (*link->Pack)(n,link->bs,leafloc+leafoffset[i],leafdata,packstart);
+    if (link->isscalar && bas->leafpackopt) {ierr = PetscSFPackOptPack(bas->leafpackopt,i,i+1,link->bs,link->bs,(const PetscScalar*)leafdata,(PetscScalar*)packstart);CHKERRQ(ierr);}
+    else (*link->Pack)(n,link->bs,leafloc+leafoffset[i],leafdata,packstart);
     ierr = MPI_Isend(packstart,n,unit,leafranks[i],bas->tag,PetscObjectComm((PetscObject)sf),&leafreqs[i]);CHKERRQ(ierr);
   }
   PetscFunctionReturn(0);
@@ -995,10 +1036,13 @@ PetscErrorCode PetscSFReduceBegin_Basic(PetscSF sf,MPI_Datatype unit,const void
 #define __FUNCT__ "PetscSFReduceEnd_Basic"
 static PetscErrorCode PetscSFReduceEnd_Basic(PetscSF sf,MPI_Datatype unit,const void *leafdata,void *rootdata,MPI_Op op)
 {
+  PetscSF_Basic    *bas = (PetscSF_Basic*)sf->data;
   void             (*UnpackOp)(PetscInt,PetscInt,const PetscInt*,void*,const void*);
   PetscErrorCode   ierr;
   PetscSFBasicPack link;
   PetscInt         i,nrootranks;
+  PetscBool        useopt;
+  InsertMode       addv;
   PetscMPIInt      typesize = -1;
   const PetscInt   *rootoffset,*rootloc;
 
@@ -1008,6 +1052,8 @@ static PetscErrorCode PetscSFReduceEnd_Basic(PetscSF sf,MPI_Datatype unit,const
   ierr = PetscSFBasicPackWaitall(sf,link);CHKERRQ(ierr);
   ierr = PetscSFBasicGetRootInfo(sf,&nrootranks,NULL,&rootoffset,&rootloc);CHKERRQ(ierr);
   ierr = PetscSFBasicPackGetUnpackOp(sf,link,op,&UnpackOp);CHKERRQ(ierr);
+  ierr = PetscSFBasicPackGetInsertMode(link,op,&useopt,&addv);CHKERRQ(ierr);
+  useopt = (PetscBool)(useopt && bas->rootpackopt);
   if (UnpackOp) {
     typesize = link->unitbytes;
   }
@@ -1018,7 +1064,9 @@ static PetscErrorCode PetscSFReduceEnd_Basic(PetscSF sf,MPI_Datatype unit,const
     PetscMPIInt n   = rootoffset[i+1] - rootoffset[i];
     char *packstart = (char *) link->root+rootoffset[i]*typesize;
 
-    if (UnpackOp) {
+    if (useopt) {
+      ierr = PetscSFPackOptUnpack(bas->rootpackopt,i,i+1,link->bs,link->bs,(const PetscScalar*)packstart,(PetscScalar*)rootdata,addv);CHKERRQ(ierr);
+    } else if (UnpackOp) {
       (*UnpackOp)(n,link->bs,rootloc+rootoffset[i],rootdata,(const void *)packstart);
     }
 #if PETSC_HAVE_MPI_REDUCE_LOCAL
@@ -1090,7 +1138,8 @@ static PetscErrorCode PetscSFFetchAndOpEnd_Basic(PetscSF sf,MPI_Datatype unit,vo
   for (i=0; i<nleafranks; i++) {
     PetscMPIInt n          = leafoffset[i+1] - leafoffset[i];
     const void  *packstart = link->leaf+leafoffset[i]*unitbytes;
-    (*link->UnpackInsert)(n,link->bs,leafloc+leafoffset[i],leafupdate,packstart);
+    if (link->isscalar && bas->leafpackopt) {ierr = PetscSFPackOptUnpack(bas->leafpackopt,i,i+1,link->bs,link->bs,(const PetscScalar*)packstart,(PetscScalar*)leafupdate,INSERT_VALUES);CHKERRQ(ierr);}
+    else (*link->UnpackInsert)(n,link->bs,leafloc+leafoffset[i],leafupdate,packstart);
   }
   ierr = PetscSFBasicReclaimPack(sf,&link);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -1118,5 +1167,8 @@ PETSC_EXTERN PetscErrorCode PetscSFCreate_Basic(PetscSF sf)
 
   ierr     = PetscNewLog(sf,&bas);CHKERRQ(ierr);
   sf->data = (void*)bas;
+
+  bas->usepackopt  = PETSC_TRUE;
+  bas->packthreads = 1;
   PetscFunctionReturn(0);
 }
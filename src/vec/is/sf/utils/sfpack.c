@@ -0,0 +1,290 @@
+/*
+   Pack and unpack plans shared by the PetscSF basic implementation and VecScatter.
+
+   The index lists of halo exchanges usually consist of long runs of consecutive blocks (a face of a
+   structured grid, the ghost region of a block of rows) or of blocks a fixed distance apart (the other
+   faces). The plan finds these runs once when the communication is set up, so that packing and
+   unpacking become memcpy() or strided loops; what is left is done by indexing, with vector gathers
+   for single entries when the compiler targets AVX2 or AVX-512. Large packs may be split among threads.
+*/
+#include <petsc/private/sfpackimpl.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+/* the gathers need 8 byte scalars and 4 byte indices */
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+#if defined(__AVX512F__)
+#define PETSCSF_PACKOPT_AVX512
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define PETSCSF_PACKOPT_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#define PETSCSF_PACKOPT_MINRUN     4     /* shortest arithmetic progression stored as a regular segment */
+#define PETSCSF_PACKOPT_MAXSEG     2048  /* longest segment, so that threads get several segments each */
+#define PETSCSF_PACKOPT_THREAD_MIN 16384 /* fewest scalars moved before threads are used */
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFPackOptBuild_Private"
+/*
+   Cuts the index list into segments; with opt->offset NULL it only counts them
+*/
+static PetscErrorCode PetscSFPackOptBuild_Private(PetscInt nmsg,const PetscInt offset[],const PetscInt idx[],PetscSFPackOpt opt)
+{
+  PetscInt m,j,r,stride,irr,nseg = 0,nregular = 0;
+
+  PetscFunctionBegin;
+  for (m=0; m<nmsg; m++) {
+    if (opt->offset) opt->msgseg[m] = nseg;
+    irr = -1;
+    for (j=offset[m]; j<offset[m+1];) {
+      r      = 1;
+      stride = 0;
+      if (j+1 < offset[m+1]) {
+        stride = idx[j+1] - idx[j];
+        if (stride > 0) {
+          for (r=2; j+r<offset[m+1] && r<PETSCSF_PACKOPT_MAXSEG && idx[j+r]-idx[j+r-1] == stride; r++) ;
+        }
+      }
+      if (stride > 0 && r >= PETSCSF_PACKOPT_MINRUN) {
+        if (irr >= 0) {
+          if (opt->offset) {opt->offset[nseg] = irr; opt->start[nseg] = 0; opt->stride[nseg] = 0;}
+          nseg++;
+          irr = -1;
+        }
+        if (opt->offset) {opt->offset[nseg] = j; opt->start[nseg] = idx[j]; opt->stride[nseg] = stride;}
+        nseg++;
+        nregular += r;
+        j        += r;
+      } else {
+        if (irr >= 0 && j-irr == PETSCSF_PACKOPT_MAXSEG) {
+          if (opt->offset) {opt->offset[nseg] = irr; opt->start[nseg] = 0; opt->stride[nseg] = 0;}
+          nseg++;
+          irr = -1;
+        }
+        if (irr < 0) irr = j;
+        j++;
+      }
+    }
+    if (irr >= 0) {
+      if (opt->offset) {opt->offset[nseg] = irr; opt->start[nseg] = 0; opt->stride[nseg] = 0;}
+      nseg++;
+    }
+  }
+  if (opt->offset) {
+    opt->msgseg[nmsg] = nseg;
+    opt->offset[nseg] = offset[nmsg];
+  }
+  opt->nseg     = nseg;
+  opt->nregular = nregular;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFPackOptCreate"
+/*
+   PetscSFPackOptCreate - Creates the plan for packing the entries idx[offset[0]] ... idx[offset[nmsg]-1]
+   that are sent as nmsg messages, message m holding the entries offset[m] <= j < offset[m+1]
+
+   Input Parameters:
++  nmsg - number of messages
+.  offset - offsets of the messages in idx, offset[0] must be 0
+.  idx - the index list; it is referenced, not copied, by the plan
+-  nthreads - number of threads that may be used by the pack and unpack routines
+
+   Output Parameter:
+.  out - the plan, or NULL if too few entries are in runs for the plan to beat plain indexing
+          and no threads are to be used
+*/
+PetscErrorCode PetscSFPackOptCreate(PetscInt nmsg,const PetscInt offset[],const PetscInt idx[],PetscInt nthreads,PetscSFPackOpt *out)
+{
+  PetscSFPackOpt opt;
+  PetscInt       i,n = offset[nmsg],*sorted;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *out = NULL;
+  if (!n) PetscFunctionReturn(0);
+  ierr = PetscNew(&opt);CHKERRQ(ierr);
+  ierr = PetscSFPackOptBuild_Private(nmsg,offset,idx,opt);CHKERRQ(ierr);
+  if (2*opt->nregular < n && nthreads < 2) {
+    ierr = PetscFree(opt);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscMalloc4(nmsg+1,&opt->msgseg,opt->nseg+1,&opt->offset,opt->nseg,&opt->start,opt->nseg,&opt->stride);CHKERRQ(ierr);
+  ierr = PetscSFPackOptBuild_Private(nmsg,offset,idx,opt);CHKERRQ(ierr);
+  opt->nmsg     = nmsg;
+  opt->idx      = idx;
+  opt->n        = n;
+  opt->nthreads = PetscMax(nthreads,1);
+  ierr = PetscMalloc1(n,&sorted);CHKERRQ(ierr);
+  ierr = PetscMemcpy(sorted,idx,n*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscSortInt(n,sorted);CHKERRQ(ierr);
+  for (i=1; i<n; i++) if (sorted[i] == sorted[i-1]) break;
+  opt->unique = (PetscBool)(i >= n);
+  ierr = PetscFree(sorted);CHKERRQ(ierr);
+  ierr = PetscInfo3(NULL,"%D of %D entries are in runs, %D segments\n",opt->nregular,n,opt->nseg);CHKERRQ(ierr);
+  *out = opt;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFPackOptDestroy"
+PetscErrorCode PetscSFPackOptDestroy(PetscSFPackOpt *opt)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!*opt) PetscFunctionReturn(0);
+  ierr = PetscFree4((*opt)->msgseg,(*opt)->offset,(*opt)->start,(*opt)->stride);CHKERRQ(ierr);
+  ierr = PetscFree(*opt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFPackOptPack"
+/*
+   PetscSFPackOptPack - Packs messages m0 <= m < m1 into the buffer p, which starts with message m0
+
+   Each index addresses the bs scalars starting at u + scale*index; VecScatter stores offsets of
+   scalars (scale 1) while PetscSF stores offsets of units of bs scalars (scale bs).
+*/
+PetscErrorCode PetscSFPackOptPack(PetscSFPackOpt opt,PetscInt m0,PetscInt m1,PetscInt bs,PetscInt scale,const PetscScalar *u,PetscScalar *p)
+{
+  const PetscInt s0 = opt->msgseg[m0],s1 = opt->msgseg[m1],base = opt->offset[s0];
+  PetscInt       s;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(dynamic) num_threads(opt->nthreads) if (opt->nthreads > 1 && bs*(opt->offset[s1]-base) >= PETSCSF_PACKOPT_THREAD_MIN)
+#endif
+  for (s=s0; s<s1; s++) {
+    PetscInt    j,k,len = opt->offset[s+1] - opt->offset[s];
+    PetscScalar *q      = p + bs*(opt->offset[s]-base);
+
+    if (opt->stride[s]) {
+      const PetscScalar *v  = u + scale*opt->start[s];
+      const PetscInt    st  = scale*opt->stride[s];
+
+      if (st == bs) PetscMemcpy(q,v,bs*len*sizeof(PetscScalar));
+      else if (bs == 1) for (j=0; j<len; j++) q[j] = v[j*st];
+      else for (j=0; j<len; j++) for (k=0; k<bs; k++) q[j*bs+k] = v[j*st+k];
+    } else {
+      const PetscInt *ii = opt->idx + opt->offset[s];
+
+      if (bs == 1 && scale == 1) {
+        j = 0;
+#if defined(PETSCSF_PACKOPT_AVX512)
+        for (; j+8<=len; j+=8) _mm512_storeu_pd(q+j,_mm512_i32gather_pd(_mm256_loadu_si256((const __m256i*)(ii+j)),u,8));
+#elif defined(PETSCSF_PACKOPT_AVX2)
+        for (; j+4<=len; j+=4) _mm256_storeu_pd(q+j,_mm256_i32gather_pd(u,_mm_loadu_si128((const __m128i*)(ii+j)),8));
+#endif
+        for (; j<len; j++) q[j] = u[ii[j]];
+      } else {
+        for (j=0; j<len; j++) {
+          const PetscScalar *v = u + scale*ii[j];
+          for (k=0; k<bs; k++) q[j*bs+k] = v[k];
+        }
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Unpacks one segment with the operation OP(destination,source); the destination is the array
+   u and the source is the packed segment q
+*/
+#define PetscSFPackOptInsert(a,b) (a) = (b)
+#define PetscSFPackOptAdd(a,b)    (a) += (b)
+#define PetscSFPackOptMax(a,b)    (a) = PetscMax(a,b)
+#define PetscSFPackOptUnpackSegment(OP) do {                                                 \
+    if (opt->stride[s]) {                                                                   \
+      PetscScalar    *v = u + scale*opt->start[s];                                          \
+      const PetscInt st = scale*opt->stride[s];                                             \
+      if (bs == 1) for (j=0; j<len; j++) OP(v[j*st],q[j]);                                  \
+      else for (j=0; j<len; j++) for (k=0; k<bs; k++) OP(v[j*st+k],q[j*bs+k]);              \
+    } else {                                                                                \
+      const PetscInt *ii = opt->idx + opt->offset[s];                                       \
+      if (bs == 1) for (j=0; j<len; j++) OP(u[scale*ii[j]],q[j]);                           \
+      else for (j=0; j<len; j++) for (k=0; k<bs; k++) OP(u[scale*ii[j]+k],q[j*bs+k]);       \
+    }                                                                                       \
+  } while (0)
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscSFPackOptUnpack"
+/*
+   PetscSFPackOptUnpack - Combines messages m0 <= m < m1 of the buffer p, which starts with message m0,
+   into u with the operation given by addv; see PetscSFPackOptPack() for bs and scale.
+
+   MAX_VALUES does nothing for complex scalars, as in the VecScatter kernels.
+*/
+PetscErrorCode PetscSFPackOptUnpack(PetscSFPackOpt opt,PetscInt m0,PetscInt m1,PetscInt bs,PetscInt scale,const PetscScalar *p,PetscScalar *u,InsertMode addv)
+{
+  const PetscInt s0 = opt->msgseg[m0],s1 = opt->msgseg[m1],base = opt->offset[s0];
+  PetscInt       s,op;
+
+  PetscFunctionBegin;
+  switch (addv) {
+  case INSERT_VALUES:
+  case INSERT_ALL_VALUES:
+    op = 0; break;
+  case ADD_VALUES:
+  case ADD_ALL_VALUES:
+    op = 1; break;
+  case MAX_VALUES:
+#if defined(PETSC_USE_COMPLEX)
+  case NOT_SET_VALUES:
+    PetscFunctionReturn(0);
+#else
+    op = 2; break;
+  case NOT_SET_VALUES:
+    PetscFunctionReturn(0);
+#endif
+  default:
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Cannot handle insert mode %d",addv);
+  }
+  /* segments may only be unpacked concurrently if no two of them write the same location */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(dynamic) num_threads(opt->nthreads) if (opt->unique && opt->nthreads > 1 && bs*(opt->offset[s1]-base) >= PETSCSF_PACKOPT_THREAD_MIN)
+#endif
+  for (s=s0; s<s1; s++) {
+    PetscInt          j,k,len = opt->offset[s+1] - opt->offset[s];
+    const PetscScalar *q      = p + bs*(opt->offset[s]-base);
+
+    if (op == 0) {
+      if (opt->stride[s] && scale*opt->stride[s] == bs) PetscMemcpy(u+scale*opt->start[s],q,bs*len*sizeof(PetscScalar));
+#if defined(PETSCSF_PACKOPT_AVX512)
+      else if (!opt->stride[s] && bs == 1 && scale == 1) {
+        const PetscInt *ii = opt->idx + opt->offset[s];
+
+        /* lanes are written from lowest to highest so a repeated index keeps the last value, as in the loop */
+        for (j=0; j+8<=len; j+=8) _mm512_i32scatter_pd(u,_mm256_loadu_si256((const __m256i*)(ii+j)),_mm512_loadu_pd(q+j),8);
+        for (; j<len; j++) u[ii[j]] = q[j];
+      }
+#endif
+      else PetscSFPackOptUnpackSegment(PetscSFPackOptInsert);
+    } else if (op == 1) {
+#if defined(PETSCSF_PACKOPT_AVX512)
+      if (opt->unique && !opt->stride[s] && bs == 1 && scale == 1) {
+        const PetscInt *ii = opt->idx + opt->offset[s];
+        __m256i        vi;
+
+        for (j=0; j+8<=len; j+=8) {
+          vi = _mm256_loadu_si256((const __m256i*)(ii+j));
+          _mm512_i32scatter_pd(u,vi,_mm512_add_pd(_mm512_i32gather_pd(vi,u,8),_mm512_loadu_pd(q+j)),8);
+        }
+        for (; j<len; j++) u[ii[j]] += q[j];
+      } else
+#endif
+      PetscSFPackOptUnpackSegment(PetscSFPackOptAdd);
+    }
+#if !defined(PETSC_USE_COMPLEX)
+    else PetscSFPackOptUnpackSegment(PetscSFPackOptMax);
+#endif
+  }
+  PetscFunctionReturn(0);
+}
@@ -843,6 +843,8 @@ PetscErrorCode PetscSectionSetUp(PetscSection s)
   PetscFunctionBegin;
   if (s->setup) PetscFunctionReturn(0);
   s->setup = PETSC_TRUE;
+  /* Caches of offsets, like the closure dofs of DMPlex, are keyed on the state */
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   if (s->perm) {ierr = ISGetIndices(s->perm, &pind);CHKERRQ(ierr);}
   for (p = 0; p < s->pEnd - s->pStart; ++p) {
     const PetscInt q = pind ? pind[p] : p;
@@ -1250,9 +1252,12 @@ PetscErrorCode PetscSectionGetOffset(PetscSection s, PetscInt point, PetscInt *o
 @*/
 PetscErrorCode PetscSectionSetOffset(PetscSection s, PetscInt point, PetscInt offset)
 {
+  PetscErrorCode ierr;
+
   PetscFunctionBegin;
   if ((point < s->pStart) || (point >= s->pEnd)) SETERRQ3(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Section point %d should be in [%d, %d)", point, s->pStart, s->pEnd);
   s->atlasOff[point - s->pStart] = offset;
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1311,6 +1316,7 @@ PetscErrorCode PetscSectionSetFieldOffset(PetscSection s, PetscInt point, PetscI
   PetscFunctionBegin;
   if ((field < 0) || (field >= s->numFields)) SETERRQ3(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Section field %d should be in [%d, %d)", field, 0, s->numFields);
   ierr = PetscSectionSetOffset(s->field[field], point, offset);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1634,6 +1640,7 @@ PetscErrorCode PetscSectionReset(PetscSection s)
   s->setup     = PETSC_FALSE;
   s->numFields = 0;
   s->clObj     = NULL;
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1822,6 +1829,7 @@ PetscErrorCode PetscSectionSetConstraintIndices(PetscSection s, PetscInt point,
   if (s->bc) {
     ierr = VecIntSetValuesSection(s->bcIndices, s->bc, point, indices, INSERT_VALUES);CHKERRQ(ierr);
   }
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1846,6 +1854,7 @@ PetscErrorCode PetscSectionSetFieldConstraintIndices(PetscSection s, PetscInt po
   PetscFunctionBegin;
   if ((field < 0) || (field >= s->numFields)) SETERRQ3(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Section field %d should be in [%d, %d)", field, 0, s->numFields);
   ierr = PetscSectionSetConstraintIndices(s->field[field], point, indices);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject) s);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -2188,6 +2197,7 @@ PetscErrorCode PetscSectionSetClosurePermutation_Internal(PetscSection section,
     ierr = ISDestroy(&section->clPoints);CHKERRQ(ierr);
   }
   section->clObj  = obj;
+  ierr = PetscObjectStateIncrease((PetscObject) section);CHKERRQ(ierr);
   ierr = PetscFree(section->clPerm);CHKERRQ(ierr);
   ierr = PetscFree(section->clInvPerm);CHKERRQ(ierr);
   section->clSize = clSize;
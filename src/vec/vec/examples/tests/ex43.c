@@ -1,4 +1,4 @@
-static char help[] = "Tests VecMDot(),VecDot(),VecMTDot(), and VecTDot()\n";
+static char help[] = "Tests VecMDot(),VecDot(),VecMTDot(),VecTDot(), and VecMDotAndNorm()\n";
 #include <petscvec.h>
 
 #undef __FUNCT__
@@ -9,7 +9,8 @@ int main(int argc, char **argv)
   Vec            *V,t;
   PetscInt       i,j,reps,n=15,k=6;
   PetscRandom    rctx;
-  PetscScalar    *val_dot,*val_mdot,*tval_dot,*tval_mdot;
+  PetscScalar    *val_dot,*val_mdot,*tval_dot,*tval_mdot,*val_mdotnorm;
+  PetscReal      nrm,nrm_mdot;
 
   ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
   ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
@@ -27,11 +28,14 @@ int main(int argc, char **argv)
   ierr = PetscMalloc1(k,&val_mdot);CHKERRQ(ierr);
   ierr = PetscMalloc1(k,&tval_dot);CHKERRQ(ierr);
   ierr = PetscMalloc1(k,&tval_mdot);CHKERRQ(ierr);
+  ierr = PetscMalloc1(k,&val_mdotnorm);CHKERRQ(ierr);
   for (i=0; i<k; i++) { ierr = VecSetRandom(V[i],rctx);CHKERRQ(ierr); }
   for (reps=0; reps<20; reps++) {
     for (i=1; i<k; i++) {
       ierr = VecMDot(t,i,V,val_mdot);CHKERRQ(ierr);
       ierr = VecMTDot(t,i,V,tval_mdot);CHKERRQ(ierr);
+      ierr = VecNorm(t,NORM_2,&nrm);CHKERRQ(ierr);
+      ierr = VecMDotAndNorm(t,i,V,val_mdotnorm,&nrm_mdot);CHKERRQ(ierr);
       for (j=0;j<i;j++) {
         ierr = VecDot(t,V[j],&val_dot[j]);CHKERRQ(ierr);
         ierr = VecTDot(t,V[j],&tval_dot[j]);CHKERRQ(ierr);
@@ -46,6 +50,13 @@ int main(int argc, char **argv)
           ierr = PetscPrintf(PETSC_COMM_WORLD, "[TEST FAILED] i=%D, j=%D, tval_mdot[j]=%g, tval_dot[j]=%g\n", i, j, tval_mdot[j], tval_dot[j]);CHKERRQ(ierr);
           break;
         }
+        if (PetscAbsScalar(val_mdotnorm[j] - val_dot[j])/PetscAbsScalar(val_dot[j]) > 1e-5) {
+          ierr = PetscPrintf(PETSC_COMM_WORLD, "[TEST FAILED] i=%D, j=%D, val_mdotnorm[j]=%g, val_dot[j]=%g\n", i, j, (double)PetscRealPart(val_mdotnorm[j]), (double)PetscRealPart(val_dot[j]));CHKERRQ(ierr);
+          break;
+        }
+      }
+      if (PetscAbsReal(nrm_mdot - nrm)/nrm > 1e-5) {
+        ierr = PetscPrintf(PETSC_COMM_WORLD, "[TEST FAILED] i=%D, nrm_mdot=%g, nrm=%g\n", i, (double)nrm_mdot, (double)nrm);CHKERRQ(ierr);
       }
     }
   }
@@ -54,6 +65,7 @@ int main(int argc, char **argv)
   ierr = PetscFree(val_mdot);CHKERRQ(ierr);
   ierr = PetscFree(tval_dot);CHKERRQ(ierr);
   ierr = PetscFree(tval_mdot);CHKERRQ(ierr);
+  ierr = PetscFree(val_mdotnorm);CHKERRQ(ierr);
   ierr = VecDestroyVecs(k,&V);CHKERRQ(ierr);
   ierr = VecDestroy(&t);CHKERRQ(ierr);
   ierr = PetscRandomDestroy(&rctx);CHKERRQ(ierr);
@@ -0,0 +1,107 @@
+
+static char help[] = "Tests VecScatter with index lists made of contiguous runs, strided runs, irregular and repeated entries.\n\
+Each process gathers blocks owned by its neighbors, then adds and takes the maximum back.\n\
+Input parameters include\n\
+  -bs <bs> : block size\n\
+  -n <n> : number of blocks owned by each process\n\n";
+
+#include <petscvec.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "GetBlocks"
+/* the blocks gathered by process r; the list is the same on every process so each can compute the expected sums */
+static PetscErrorCode GetBlocks(PetscMPIInt r,PetscMPIInt size,PetscInt n,PetscInt *m,PetscInt **idx)
+{
+  PetscInt       i,cnt = 0,N = size*n,nrun = n/3,nstride = n/16,nirr = n/4,ndup = n/50;
+  PetscInt       next = ((r+1)%size)*n,prev = ((r+size-1)%size)*n;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *m   = nrun + nstride + nirr + ndup;
+  ierr = PetscMalloc1(*m,idx);CHKERRQ(ierr);
+  for (i=0; i<nrun; i++)    (*idx)[cnt++] = next + i;
+  for (i=0; i<nstride; i++) (*idx)[cnt++] = prev + 5*i;
+  for (i=0; i<nirr; i++)    (*idx)[cnt++] = (r*7919 + i*104729)%N;
+  for (i=0; i<ndup; i++)    (*idx)[cnt++] = next + 2*i;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  Vec               x,y;
+  IS                is;
+  VecScatter        ctx;
+  PetscMPIInt       rank,size,r;
+  PetscInt          bs = 3,n = 2000,m,mr,*idx,*idxr,*count,i,k,rstart,rend;
+  PetscScalar       *xv;
+  const PetscScalar *yv;
+  PetscReal         err = 0.0,gerr;
+  PetscErrorCode    ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-bs",&bs,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,n*bs,PETSC_DETERMINE,&x);CHKERRQ(ierr);
+  ierr = VecSetBlockSize(x,bs);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(x,&rstart,&rend);CHKERRQ(ierr);
+  ierr = GetBlocks(rank,size,n,&m,&idx);CHKERRQ(ierr);
+  ierr = ISCreateBlock(PETSC_COMM_SELF,bs,m,idx,PETSC_COPY_VALUES,&is);CHKERRQ(ierr);
+  ierr = VecCreateSeq(PETSC_COMM_SELF,m*bs,&y);CHKERRQ(ierr);
+  ierr = VecScatterCreate(x,is,y,NULL,&ctx);CHKERRQ(ierr);
+
+  /* number of times each of my blocks is gathered */
+  ierr = PetscCalloc1(n,&count);CHKERRQ(ierr);
+  for (r=0; r<size; r++) {
+    ierr = GetBlocks(r,size,n,&mr,&idxr);CHKERRQ(ierr);
+    for (i=0; i<mr; i++) if (idxr[i] >= rank*n && idxr[i] < (rank+1)*n) count[idxr[i]-rank*n]++;
+    ierr = PetscFree(idxr);CHKERRQ(ierr);
+  }
+
+  /* forward: y gets the global indices of the entries */
+  ierr = VecGetArray(x,&xv);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) xv[i-rstart] = i;
+  ierr = VecRestoreArray(x,&xv);CHKERRQ(ierr);
+  ierr = VecScatterBegin(ctx,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecScatterEnd(ctx,x,y,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(y,&yv);CHKERRQ(ierr);
+  for (i=0; i<m; i++) for (k=0; k<bs; k++) err = PetscMax(err,PetscAbsScalar(yv[i*bs+k] - (PetscScalar)(idx[i]*bs+k)));
+  ierr = VecRestoreArrayRead(y,&yv);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&err,&gerr,1,MPIU_REAL,MPIU_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (gerr > 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Forward INSERT_VALUES: error %g\n",(double)gerr);CHKERRQ(ierr);}
+
+  /* reverse: every block that is gathered c times becomes (c+1) times its value */
+  ierr = VecScatterBegin(ctx,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterEnd(ctx,y,x,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecGetArray(x,&xv);CHKERRQ(ierr);
+  for (i=0; i<n; i++) for (k=0; k<bs; k++) err = PetscMax(err,PetscAbsScalar(xv[i*bs+k] - (PetscScalar)((count[i]+1)*(rstart+i*bs+k))));
+  for (i=rstart; i<rend; i++) xv[i-rstart] = i;
+  ierr = VecRestoreArray(x,&xv);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&err,&gerr,1,MPIU_REAL,MPIU_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (gerr > 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Reverse ADD_VALUES: error %g\n",(double)gerr);CHKERRQ(ierr);}
+
+#if !defined(PETSC_USE_COMPLEX)
+  /* reverse: every block that is gathered at least once becomes twice its value */
+  ierr = VecScale(y,2.0);CHKERRQ(ierr);
+  ierr = VecScatterBegin(ctx,y,x,MAX_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterEnd(ctx,y,x,MAX_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecGetArray(x,&xv);CHKERRQ(ierr);
+  for (i=0; i<n; i++) for (k=0; k<bs; k++) err = PetscMax(err,PetscAbsScalar(xv[i*bs+k] - (PetscScalar)((count[i] ? 2 : 1)*(rstart+i*bs+k))));
+  ierr = VecRestoreArray(x,&xv);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&err,&gerr,1,MPIU_REAL,MPIU_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (gerr > 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Reverse MAX_VALUES: error %g\n",(double)gerr);CHKERRQ(ierr);}
+#endif
+
+  ierr = PetscFree(count);CHKERRQ(ierr);
+  ierr = PetscFree(idx);CHKERRQ(ierr);
+  ierr = ISDestroy(&is);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&ctx);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -16,6 +16,8 @@ typedef struct {
 } Vec_Seq;
 
 PETSC_INTERN PetscErrorCode VecMDot_Seq(Vec,PetscInt,const Vec[],PetscScalar*);
+PETSC_INTERN PetscErrorCode VecMDotAndNorm_Seq(Vec,PetscInt,const Vec[],PetscScalar*,PetscReal*);
+PETSC_INTERN PetscErrorCode VecMDotAndNormLocal_Seq(Vec,PetscInt,const Vec[],PetscScalar*,PetscReal*);
 PETSC_INTERN PetscErrorCode VecMTDot_Seq(Vec,PetscInt,const Vec[],PetscScalar*);
 PETSC_INTERN PetscErrorCode VecMin_Seq(Vec,PetscInt*,PetscReal*);
 PETSC_INTERN PetscErrorCode VecSet_Seq(Vec,PetscScalar);
@@ -280,6 +280,7 @@ PetscErrorCode VecCreate_MPICUDA_Private(Vec vv,PetscBool alloc,PetscInt nghost,
   vv->ops->duplicate              = VecDuplicate_MPICUDA;
   vv->ops->dot                    = VecDot_MPICUDA;
   vv->ops->mdot                   = VecMDot_MPICUDA;
+  vv->ops->mdotnorm               = 0;
   vv->ops->tdot                   = VecTDot_MPICUDA;
   vv->ops->norm                   = VecNorm_MPICUDA;
   vv->ops->scale                  = VecScale_SeqCUDA;
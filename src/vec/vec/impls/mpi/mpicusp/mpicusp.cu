@@ -194,6 +194,7 @@ PETSC_EXTERN PetscErrorCode VecCreate_MPICUSP(Vec vv)
   vv->ops->duplicate              = VecDuplicate_MPICUSP;
   vv->ops->dot                    = VecDot_MPICUSP;
   vv->ops->mdot                   = VecMDot_MPICUSP;
+  vv->ops->mdotnorm               = 0;
   vv->ops->tdot                   = VecTDot_MPICUSP;
   vv->ops->norm                   = VecNorm_MPICUSP;
   vv->ops->scale                  = VecScale_SeqCUSP;
@@ -191,6 +191,7 @@ PETSC_EXTERN PetscErrorCode VecCreate_MPIViennaCL(Vec vv)
   vv->ops->duplicate       = VecDuplicate_MPIViennaCL;
   vv->ops->dot             = VecDot_MPIViennaCL;
   vv->ops->mdot            = VecMDot_MPIViennaCL;
+  vv->ops->mdotnorm        = 0;
   vv->ops->tdot            = VecTDot_MPIViennaCL;
   vv->ops->norm            = VecNorm_MPIViennaCL;
   vv->ops->scale           = VecScale_SeqViennaCL;
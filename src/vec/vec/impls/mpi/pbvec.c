@@ -489,7 +489,12 @@ static struct _VecOps DvOps = { VecDuplicate_MPI, /* 1 */
                                 VecStrideSubSetGather_Default,
                                 VecStrideSubSetScatter_Default,
                                 0,
-                                0
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                VecMDotAndNorm_MPI
 };
 
 #undef __FUNCT__
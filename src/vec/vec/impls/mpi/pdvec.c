@@ -355,11 +355,16 @@ PetscErrorCode VecView_MPI_Binary(Vec xin,PetscViewer viewer)
 #if defined(PETSC_HAVE_MPIIO)
   PetscBool         isMPIIO;
 #endif
-  PetscBool         skipHeader;
+  PetscBool         skipHeader,usemmap;
   PetscInt          message_count,flowcontrolcount;
   PetscViewerFormat format;
 
   PetscFunctionBegin;
+  ierr = PetscViewerBinaryGetUseMmap(viewer,&usemmap);CHKERRQ(ierr);
+  if (usemmap) {
+    ierr = VecView_Binary_Mmap(xin,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = VecGetArrayRead(xin,&xarray);CHKERRQ(ierr);
   ierr = PetscViewerBinaryGetDescriptor(viewer,&fdes);CHKERRQ(ierr);
   ierr = PetscViewerBinaryGetSkipHeader(viewer,&skipHeader);CHKERRQ(ierr);
@@ -24,6 +24,30 @@ PetscErrorCode VecMDot_MPI(Vec xin,PetscInt nv,const Vec y[],PetscScalar *z)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotAndNorm_MPI"
+PetscErrorCode VecMDotAndNorm_MPI(Vec xin,PetscInt nv,const Vec y[],PetscScalar *z,PetscReal *nrm)
+{
+  PetscScalar    awork[128],asum[128],*work = awork,*sum = asum;
+  PetscReal      nrm2;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (nv > 127) {
+    ierr = PetscMalloc2(nv+1,&work,nv+1,&sum);CHKERRQ(ierr);
+  }
+  ierr     = VecMDotAndNormLocal_Seq(xin,nv,y,work,&nrm2);CHKERRQ(ierr);
+  work[nv] = nrm2;
+  /* the dot products and the squared norm share one reduction */
+  ierr = MPIU_Allreduce(work,sum,nv+1,MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)xin));CHKERRQ(ierr);
+  ierr = PetscMemcpy(z,sum,nv*sizeof(PetscScalar));CHKERRQ(ierr);
+  *nrm = PetscSqrtReal(PetscRealPart(sum[nv]));
+  if (nv > 127) {
+    ierr = PetscFree2(work,sum);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecMTDot_MPI"
 PetscErrorCode VecMTDot_MPI(Vec xin,PetscInt nv,const Vec y[],PetscScalar *z)
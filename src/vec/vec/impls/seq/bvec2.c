@@ -526,10 +526,15 @@ PetscErrorCode VecView_Seq_Binary(Vec xin,PetscViewer viewer)
 #if defined(PETSC_HAVE_MPIIO)
   PetscBool         isMPIIO;
 #endif
-  PetscBool         skipHeader;
+  PetscBool         skipHeader,usemmap;
   PetscViewerFormat format;
 
   PetscFunctionBegin;
+  ierr = PetscViewerBinaryGetUseMmap(viewer,&usemmap);CHKERRQ(ierr);
+  if (usemmap) {
+    ierr = VecView_Binary_Mmap(xin,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   /* Write vector header */
   ierr = PetscViewerBinaryGetSkipHeader(viewer,&skipHeader);CHKERRQ(ierr);
   if (!skipHeader) {
@@ -868,7 +873,12 @@ static struct _VecOps DvOps = {VecDuplicate_Seq, /* 1 */
                                VecStrideSubSetGather_Default,
                                VecStrideSubSetScatter_Default,
                                0,
-                               0
+                               0,
+                               0,
+                               0,
+                               0,
+                               0,
+                               VecMDotAndNorm_Seq
 };
 
 
@@ -294,6 +294,75 @@ PetscErrorCode VecMDot_Seq(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z)
 }
 #endif
 
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotAndNormLocal_Seq"
+/*
+   Local part of VecMDotAndNorm(): z[j] = y[j]^H x and *nrm2 = x^H x, computed four y vectors at a time.
+   The squared norm is accumulated during the sweep over the first group, so x is read nv/4 times
+   (rounded up) instead of nv/4 + 1 times as with VecMDot() followed by VecNorm().
+*/
+PetscErrorCode VecMDotAndNormLocal_Seq(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z,PetscReal *nrm2)
+{
+  PetscErrorCode    ierr;
+  PetscInt          n = xin->map->n,i,j,m;
+  PetscScalar       sum0,sum1,sum2,sum3,x0;
+  PetscReal         sumx = 0.0;
+  const PetscScalar *x,*yy0,*yy1,*yy2,*yy3;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xin,&x);CHKERRQ(ierr);
+  if (!nv) {
+    for (j=0; j<n; j++) sumx += PetscRealPart(x[j]*PetscConj(x[j]));
+  }
+  for (i=0; i<nv; i+=4) {
+    m    = PetscMin(nv-i,4);
+    /* unused slots of a short group point at x; their sums are discarded */
+    ierr = VecGetArrayRead(yin[i],&yy0);CHKERRQ(ierr);
+    yy1  = yy2 = yy3 = x;
+    if (m > 1) {ierr = VecGetArrayRead(yin[i+1],&yy1);CHKERRQ(ierr);}
+    if (m > 2) {ierr = VecGetArrayRead(yin[i+2],&yy2);CHKERRQ(ierr);}
+    if (m > 3) {ierr = VecGetArrayRead(yin[i+3],&yy3);CHKERRQ(ierr);}
+    sum0 = sum1 = sum2 = sum3 = 0.0;
+    if (!i) {
+      for (j=0; j<n; j++) {
+        x0    = x[j];
+        sumx += PetscRealPart(x0*PetscConj(x0));
+        sum0 += x0*PetscConj(yy0[j]); sum1 += x0*PetscConj(yy1[j]);
+        sum2 += x0*PetscConj(yy2[j]); sum3 += x0*PetscConj(yy3[j]);
+      }
+    } else {
+      for (j=0; j<n; j++) {
+        x0    = x[j];
+        sum0 += x0*PetscConj(yy0[j]); sum1 += x0*PetscConj(yy1[j]);
+        sum2 += x0*PetscConj(yy2[j]); sum3 += x0*PetscConj(yy3[j]);
+      }
+    }
+    z[i] = sum0;
+    ierr = VecRestoreArrayRead(yin[i],&yy0);CHKERRQ(ierr);
+    if (m > 1) {z[i+1] = sum1; ierr = VecRestoreArrayRead(yin[i+1],&yy1);CHKERRQ(ierr);}
+    if (m > 2) {z[i+2] = sum2; ierr = VecRestoreArrayRead(yin[i+2],&yy2);CHKERRQ(ierr);}
+    if (m > 3) {z[i+3] = sum3; ierr = VecRestoreArrayRead(yin[i+3],&yy3);CHKERRQ(ierr);}
+  }
+  ierr  = VecRestoreArrayRead(xin,&x);CHKERRQ(ierr);
+  *nrm2 = sumx;
+  ierr  = PetscLogFlops(PetscMax((nv+1)*(2.0*n-1),0.0));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotAndNorm_Seq"
+PetscErrorCode VecMDotAndNorm_Seq(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z,PetscReal *nrm)
+{
+  PetscErrorCode ierr;
+  PetscReal      nrm2;
+
+  PetscFunctionBegin;
+  ierr = VecMDotAndNormLocal_Seq(xin,nv,yin,z,&nrm2);CHKERRQ(ierr);
+  *nrm = PetscSqrtReal(nrm2);
+  PetscFunctionReturn(0);
+}
+
+
 /* ----------------------------------------------------------------------------*/
 #undef __FUNCT__
 #define __FUNCT__ "VecMTDot_Seq"
@@ -371,6 +371,7 @@ PetscErrorCode VecCreate_SeqCUDA_Private(Vec V,const PetscScalar *array)
   V->ops->mdot_local             = VecMDot_SeqCUDA;
   V->ops->maxpy                  = VecMAXPY_SeqCUDA;
   V->ops->mdot                   = VecMDot_SeqCUDA;
+  V->ops->mdotnorm               = 0;
   V->ops->aypx                   = VecAYPX_SeqCUDA;
   V->ops->waxpy                  = VecWAXPY_SeqCUDA;
   V->ops->dotnorm2               = VecDotNorm2_SeqCUDA;
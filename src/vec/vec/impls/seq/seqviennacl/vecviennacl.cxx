@@ -1150,6 +1150,7 @@ PETSC_EXTERN PetscErrorCode VecCreate_SeqViennaCL(Vec V)
   V->ops->mtdot_local     = VecMTDot_SeqViennaCL;
   V->ops->maxpy           = VecMAXPY_SeqViennaCL;
   V->ops->mdot            = VecMDot_SeqViennaCL;
+  V->ops->mdotnorm        = 0;
   V->ops->mtdot           = VecMTDot_SeqViennaCL;
   V->ops->aypx            = VecAYPX_SeqViennaCL;
   V->ops->waxpy           = VecWAXPY_SeqViennaCL;
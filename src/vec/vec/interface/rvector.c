@@ -1237,6 +1237,64 @@ PetscErrorCode  VecMDot(Vec x,PetscInt nv,const Vec y[],PetscScalar val[])
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotAndNorm"
+/*@
+   VecMDotAndNorm - Computes vector multiple dot products and the 2-norm of the vector in a single
+   pass over x and a single global reduction.
+
+   Collective on Vec
+
+   Input Parameters:
++  x - one vector
+.  nv - number of vectors
+-  y - array of vectors.
+
+   Output Parameters:
++  val - array of the dot products (does not allocate the array)
+-  norm - the 2-norm of x
+
+   Notes:
+   The dot products are computed as in VecMDot(). For vector types that do not provide a fused
+   kernel this is the same as calling VecMDot() followed by VecNorm().
+
+   Level: advanced
+
+   Concepts: inner product^multiple
+   Concepts: norm^with inner products
+
+.seealso: VecMDot(), VecNorm(), VecDotNorm2()
+@*/
+PetscErrorCode  VecMDotAndNorm(Vec x,PetscInt nv,const Vec y[],PetscScalar val[],PetscReal *norm)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(x,VEC_CLASSID,1);
+  PetscValidRealPointer(norm,5);
+  if (nv < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of vectors (given %D) cannot be negative",nv);
+  PetscValidType(x,1);
+  if (nv) {
+    PetscValidPointer(y,3);
+    PetscValidHeaderSpecific(*y,VEC_CLASSID,3);
+    PetscValidScalarPointer(val,4);
+    PetscValidType(*y,3);
+    PetscCheckSameTypeAndComm(x,1,*y,3);
+    PetscCheckSameSizeVec(x,*y);
+  }
+
+  if (x->ops->mdotnorm) {
+    ierr = PetscLogEventBegin(VEC_MDotNorm,x,0,0,0);CHKERRQ(ierr);
+    ierr = (*x->ops->mdotnorm)(x,nv,y,val,norm);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(VEC_MDotNorm,x,0,0,0);CHKERRQ(ierr);
+    ierr = PetscObjectComposedDataSetReal((PetscObject)x,NormIds[NORM_2],*norm);CHKERRQ(ierr);
+  } else {
+    ierr = VecMDot(x,nv,y,val);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_2,norm);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecMAXPY"
 /*@
@@ -8,6 +8,7 @@
 #include <petscsys.h>
 #include <petscvec.h>         /*I  "petscvec.h"  I*/
 #include <petsc/private/vecimpl.h>
+#include <petsc/private/viewerimpl.h>
 #include <petscviewerhdf5.h>
 
 #undef __FUNCT__
@@ -60,6 +61,112 @@ static PetscErrorCode VecLoad_Binary_MPIIO(Vec vec, PetscViewer viewer)
 }
 #endif
 
+/*
+   In the memory-mapped format (see PetscViewerBinarySetUseMmap()) a vector is the header of PetscViewerBinaryMmapBegin(),
+   whose last words are N, the block size, the number of parts and the length of the object, the PetscInt64 rows[nparts+1]
+   owned by each process that wrote it, and then all the values in order, so that any process reads its values in one piece.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "VecView_Binary_Mmap"
+PetscErrorCode VecView_Binary_Mmap(Vec vec,PetscViewer viewer)
+{
+  PetscErrorCode    ierr;
+  MPI_Comm          comm;
+  PetscMPIInt       rank,size,p;
+  PetscInt64        header[16],n = vec->map->n,*rows,values;
+  const PetscScalar *avec;
+  off_t             start;
+  int               fd;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = PetscMalloc1(size+1,&rows);CHKERRQ(ierr);
+  rows[0] = 0;
+  ierr    = MPI_Allgather(&n,1,MPIU_INT64,rows+1,1,MPIU_INT64,comm);CHKERRQ(ierr);
+  for (p=0; p<size; p++) rows[p+1] += rows[p];
+  if (rows[size] != vec->map->N) SETERRQ(comm,PETSC_ERR_SUP,"The memory-mapped format needs the vector and the viewer on the same processes");
+  values  = sizeof(header) + PetscViewerBinaryMmapAlign((size+1)*sizeof(PetscInt64));
+
+  ierr = PetscViewerBinaryMmapBegin(viewer,&fd,&start);CHKERRQ(ierr);
+  if (!rank) {
+    ierr = PetscMemzero(header,sizeof(header));CHKERRQ(ierr);
+    header[0] = PETSC_VIEWER_BINARY_MMAP_MAGIC;
+    header[1] = PETSC_VIEWER_BINARY_MMAP_VERSION;
+    header[2] = VEC_FILE_CLASSID;
+    header[3] = sizeof(PetscInt);
+    header[4] = sizeof(PetscScalar);
+    header[5] = vec->map->N;
+    header[6] = PetscAbs(vec->map->bs);
+    header[7] = size;
+    header[8] = values + vec->map->N*sizeof(PetscScalar);
+    ierr = PetscBinaryWriteAt(fd,header,sizeof(header),start);CHKERRQ(ierr);
+    ierr = PetscBinaryWriteAt(fd,rows,(size+1)*sizeof(PetscInt64),start+sizeof(header));CHKERRQ(ierr);
+  }
+  ierr = VecGetArrayRead(vec,&avec);CHKERRQ(ierr);
+  ierr = PetscBinaryWriteAt(fd,avec,n*sizeof(PetscScalar),start+values+rows[rank]*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(vec,&avec);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryMmapEnd(viewer,start+values+vec->map->N*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscFree(rows);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecLoad_Binary_Mmap"
+static PetscErrorCode VecLoad_Binary_Mmap(Vec vec,PetscViewer viewer)
+{
+  PetscErrorCode ierr;
+  MPI_Comm       comm;
+  PetscMPIInt    rank,size;
+  PetscInt64     header[16],*rows,values;
+  PetscInt       N,bs,nparts,n;
+  PetscScalar    *avec;
+  void           *ptr;
+  off_t          start;
+  int            fd;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryMmapBegin(viewer,&fd,&start);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start,sizeof(header),&ptr);CHKERRQ(ierr);
+  ierr = PetscMemcpy(header,ptr,sizeof(header));CHKERRQ(ierr);
+  ierr = PetscBinaryUnmap(ptr,sizeof(header));CHKERRQ(ierr);
+  if (header[0] != PETSC_VIEWER_BINARY_MMAP_MAGIC) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Not an object in the memory-mapped format, or written with a different byte order");
+  if (header[1] != PETSC_VIEWER_BINARY_MMAP_VERSION) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Memory-mapped format version %D is not supported",(PetscInt)header[1]);
+  if (header[2] != VEC_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Not a vector next in file");
+  if (header[3] != sizeof(PetscInt) || header[4] != sizeof(PetscScalar)) SETERRQ4(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"File has %D byte integers and %D byte scalars, this build of PETSc has %D and %D",(PetscInt)header[3],(PetscInt)header[4],(PetscInt)sizeof(PetscInt),(PetscInt)sizeof(PetscScalar));
+  N      = (PetscInt)header[5];
+  bs     = (PetscInt)header[6];
+  nparts = (PetscInt)header[7];
+  values = sizeof(header) + PetscViewerBinaryMmapAlign((nparts+1)*sizeof(PetscInt64));
+
+  /* keep the distribution of the file when it was written by as many processes */
+  if (vec->map->n < 0 && vec->map->N < 0) {
+    if (vec->map->bs < 0 && bs > 1) {ierr = VecSetBlockSize(vec,bs);CHKERRQ(ierr);}
+    if (nparts == size) {
+      ierr = PetscBinaryMap(fd,start+sizeof(header),(nparts+1)*sizeof(PetscInt64),&ptr);CHKERRQ(ierr);
+      rows = (PetscInt64*)ptr;
+      n    = (PetscInt)(rows[rank+1] - rows[rank]);
+      ierr = PetscBinaryUnmap(ptr,(nparts+1)*sizeof(PetscInt64));CHKERRQ(ierr);
+    } else n = PETSC_DECIDE;
+    ierr = VecSetSizes(vec,n,N);CHKERRQ(ierr);
+  }
+  if (vec->map->N != N) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED, "Vector in file different length (%D) then input vector (%D)",N,vec->map->N);
+
+  ierr = VecGetArray(vec,&avec);CHKERRQ(ierr);
+  ierr = PetscBinaryMap(fd,start+values+vec->map->rstart*sizeof(PetscScalar),vec->map->n*sizeof(PetscScalar),&ptr);CHKERRQ(ierr);
+  ierr = PetscMemcpy(avec,ptr,vec->map->n*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscBinaryUnmap(ptr,vec->map->n*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = VecRestoreArray(vec,&avec);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryMmapEnd(viewer,start+(off_t)header[8]);CHKERRQ(ierr);
+  ierr = VecAssemblyBegin(vec);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(vec);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecLoad_Binary"
 PetscErrorCode VecLoad_Binary(Vec vec, PetscViewer viewer)
@@ -68,7 +175,7 @@ PetscErrorCode VecLoad_Binary(Vec vec, PetscViewer viewer)
   int            fd;
   PetscInt       i,rows = 0,n,*range,N,bs;
   PetscErrorCode ierr;
-  PetscBool      flag,skipheader;
+  PetscBool      flag,skipheader,usemmap;
   PetscScalar    *avec,*avecwork;
   MPI_Comm       comm;
   MPI_Request    request;
@@ -80,6 +187,11 @@ PetscErrorCode VecLoad_Binary(Vec vec, PetscViewer viewer)
   PetscFunctionBegin;
   /* force binary viewer to load .info file if it has not yet done so */
   ierr = PetscViewerSetUp(viewer);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetUseMmap(viewer,&usemmap);CHKERRQ(ierr);
+  if (usemmap) {
+    ierr = VecLoad_Binary_Mmap(vec,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
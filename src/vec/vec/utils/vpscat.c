@@ -161,6 +161,9 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
     ierr = MPI_Waitall(to->n,to->rev_requests,to->rstatus);CHKERRQ(ierr);
   }
 
+  ierr = PetscSFPackOptDestroy(&to->packopt);CHKERRQ(ierr);
+  ierr = PetscSFPackOptDestroy(&from->packopt);CHKERRQ(ierr);
+
 #if defined(PETSC_HAVE_MPI_ALLTOALLW) && !defined(PETSC_USE_64BIT_INDICES)
   if (to->use_alltoallw) {
     for (i=0; i<to->n; i++) {
@@ -190,13 +193,26 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
     ierr = PetscFree2(from->counts,from->displs);CHKERRQ(ierr);
   }
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  if (to->use_neighbor) {
+#if defined(PETSC_HAVE_MPI_NEIGHBOR_ALLTOALLV_INIT)
+    ierr = MPI_Request_free(&to->nrequest);CHKERRQ(ierr);
+    ierr = MPI_Request_free(&from->nrequest);CHKERRQ(ierr);
+#endif
+    ierr = MPI_Comm_free(&to->neighborcomm);CHKERRQ(ierr);
+    ierr = MPI_Comm_free(&from->neighborcomm);CHKERRQ(ierr);
+    ierr = PetscFree2(to->ncounts,to->ndispls);CHKERRQ(ierr);
+    ierr = PetscFree2(from->ncounts,from->ndispls);CHKERRQ(ierr);
+  }
+#endif
+
   /* release MPI resources obtained with MPI_Send_init() and MPI_Recv_init() */
   /*
      IBM's PE version of MPI has a bug where freeing these guys will screw up later
      message passing.
   */
 #if !defined(PETSC_HAVE_BROKEN_REQUEST_FREE)
-  if (!to->use_alltoallv && !to->use_window) {   /* currently the to->requests etc are ALWAYS allocated even if not used */
+  if (!to->use_alltoallv && !to->use_window && !to->use_neighbor) {   /* currently the to->requests etc are ALWAYS allocated even if not used */
     if (to->requests) {
       for (i=0; i<to->n; i++) {
         ierr = MPI_Request_free(to->requests + i);CHKERRQ(ierr);
@@ -213,7 +229,7 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
     cannot free the requests. It may be fixed now, if not then put the following
     code inside a if (!to->use_readyreceiver) {
   */
-  if (!to->use_alltoallv && !to->use_window) {    /* currently the from->requests etc are ALWAYS allocated even if not used */
+  if (!to->use_alltoallv && !to->use_window && !to->use_neighbor) {    /* currently the from->requests etc are ALWAYS allocated even if not used */
     if (from->requests) {
       for (i=0; i<from->n; i++) {
         ierr = MPI_Request_free(from->requests + i);CHKERRQ(ierr);
@@ -284,6 +300,22 @@ PetscErrorCode VecScatterLocalOptimizeCopy_Private(VecScatter scatter,VecScatter
 
 /* --------------------------------------------------------------------------------------*/
 
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterPackOptCreate_Private"
+/*
+    Builds the plans used to pack the values sent by to and unpack the values received by from;
+    the messages are the segments of the index lists given by starts[]
+*/
+static PetscErrorCode VecScatterPackOptCreate_Private(VecScatter_MPI_General *to,VecScatter_MPI_General *from,PetscInt nthreads)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFPackOptCreate(to->n,to->starts,to->indices,nthreads,&to->packopt);CHKERRQ(ierr);
+  ierr = PetscSFPackOptCreate(from->n,from->starts,from->indices,nthreads,&from->packopt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecScatterCopy_PtoP_X"
 PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
@@ -411,6 +443,9 @@ PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
       ierr = MPI_Recv_init(Ssvalues+bs*sstarts[i],bs*sstarts[i+1]-bs*sstarts[i],MPIU_SCALAR,sprocs[i],tag,comm,rev_rwaits+i);CHKERRQ(ierr);
     }
   }
+  if (in_to->packopt || in_from->packopt) {
+    ierr = VecScatterPackOptCreate_Private(out_to,out_from,in_to->packopt ? in_to->packopt->nthreads : in_from->packopt->nthreads);CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -491,8 +526,125 @@ PetscErrorCode VecScatterCopy_PtoP_AllToAll(VecScatter in,VecScatter out)
   ierr = PetscMalloc2(size,&out_from->counts,size,&out_from->displs);CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->counts,in_from->counts,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->displs,in_from->displs,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  if (in_to->packopt || in_from->packopt) {
+    ierr = VecScatterPackOptCreate_Private(out_to,out_from,in_to->packopt ? in_to->packopt->nthreads : in_from->packopt->nthreads);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterSetUpNeighbor_Private"
+/*
+    Creates the two distributed graph communicators (one for each direction of the scatter) whose
+    neighbors are exactly the processes in the send and receive lists, and the message lengths for
+    MPI_Neighbor_alltoallv(). With MPI-3 persistent collectives the exchanges are initialized here once.
+*/
+static PetscErrorCode VecScatterSetUpNeighbor_Private(VecScatter ctx,VecScatter_MPI_General *to,VecScatter_MPI_General *from)
+{
+  MPI_Comm       comm;
+  PetscInt       i,bs = to->bs;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)ctx,&comm);CHKERRQ(ierr);
+  ierr = PetscMalloc2(to->n,&to->ncounts,to->n,&to->ndispls);CHKERRQ(ierr);
+  for (i=0; i<to->n; i++) {
+    ierr = PetscMPIIntCast(bs*(to->starts[i+1]-to->starts[i]),to->ncounts+i);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(bs*to->starts[i],to->ndispls+i);CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc2(from->n,&from->ncounts,from->n,&from->ndispls);CHKERRQ(ierr);
+  for (i=0; i<from->n; i++) {
+    ierr = PetscMPIIntCast(bs*(from->starts[i+1]-from->starts[i]),from->ncounts+i);CHKERRQ(ierr);
+    ierr = PetscMPIIntCast(bs*from->starts[i],from->ndispls+i);CHKERRQ(ierr);
+  }
+  /* the neighbors are listed in the order of procs so that counts and displacements line up; no reordering of ranks.
+     The message lengths are passed as edge weights; both ends of an edge give the same length */
+  ierr = MPI_Dist_graph_create_adjacent(comm,from->n,from->procs,from->ncounts,to->n,to->procs,to->ncounts,MPI_INFO_NULL,0,&to->neighborcomm);CHKERRQ(ierr);
+  ierr = MPI_Dist_graph_create_adjacent(comm,to->n,to->procs,to->ncounts,from->n,from->procs,from->ncounts,MPI_INFO_NULL,0,&from->neighborcomm);CHKERRQ(ierr);
+  to->nrequest   = MPI_REQUEST_NULL;
+  from->nrequest = MPI_REQUEST_NULL;
+#if defined(PETSC_HAVE_MPI_NEIGHBOR_ALLTOALLV_INIT)
+  ierr = MPI_Neighbor_alltoallv_init(to->values,to->ncounts,to->ndispls,MPIU_SCALAR,from->values,from->ncounts,from->ndispls,MPIU_SCALAR,to->neighborcomm,MPI_INFO_NULL,&to->nrequest);CHKERRQ(ierr);
+  ierr = MPI_Neighbor_alltoallv_init(from->values,from->ncounts,from->ndispls,MPIU_SCALAR,to->values,to->ncounts,to->ndispls,MPIU_SCALAR,from->neighborcomm,MPI_INFO_NULL,&from->nrequest);CHKERRQ(ierr);
+#endif
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterCopy_PtoP_Neighbor"
+PetscErrorCode VecScatterCopy_PtoP_Neighbor(VecScatter in,VecScatter out)
+{
+  VecScatter_MPI_General *in_to   = (VecScatter_MPI_General*)in->todata;
+  VecScatter_MPI_General *in_from = (VecScatter_MPI_General*)in->fromdata,*out_to,*out_from;
+  PetscErrorCode         ierr;
+  PetscInt               ny,bs = in_from->bs;
+
+  PetscFunctionBegin;
+  out->ops->begin     = in->ops->begin;
+  out->ops->end       = in->ops->end;
+  out->ops->copy      = in->ops->copy;
+  out->ops->destroy   = in->ops->destroy;
+  out->ops->view      = in->ops->view;
+
+  /* allocate entire send scatter context */
+  ierr = PetscNewLog(out,&out_to);CHKERRQ(ierr);
+  ierr = PetscNewLog(out,&out_from);CHKERRQ(ierr);
+
+  ny                = in_to->starts[in_to->n];
+  out_to->n         = in_to->n;
+  out_to->type      = in_to->type;
+  out_to->sendfirst = in_to->sendfirst;
+
+  ierr = PetscMalloc1(out_to->n,&out_to->requests);CHKERRQ(ierr);
+  ierr = PetscMalloc4(bs*ny,&out_to->values,ny,&out_to->indices,out_to->n+1,&out_to->starts,out_to->n,&out_to->procs);CHKERRQ(ierr);
+  ierr = PetscMalloc2(PetscMax(in_to->n,in_from->n),&out_to->sstatus,PetscMax(in_to->n,in_from->n),&out_to->rstatus);CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_to->indices,in_to->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_to->starts,in_to->starts,(out_to->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_to->procs,in_to->procs,(out_to->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+
+  out->todata                        = (void*)out_to;
+  out_to->local.n                    = in_to->local.n;
+  out_to->local.nonmatching_computed = PETSC_FALSE;
+  out_to->local.n_nonmatching        = 0;
+  out_to->local.slots_nonmatching    = 0;
+  if (in_to->local.n) {
+    ierr = PetscMalloc1(in_to->local.n,&out_to->local.vslots);CHKERRQ(ierr);
+    ierr = PetscMalloc1(in_from->local.n,&out_from->local.vslots);CHKERRQ(ierr);
+    ierr = PetscMemcpy(out_to->local.vslots,in_to->local.vslots,in_to->local.n*sizeof(PetscInt));CHKERRQ(ierr);
+    ierr = PetscMemcpy(out_from->local.vslots,in_from->local.vslots,in_from->local.n*sizeof(PetscInt));CHKERRQ(ierr);
+  } else {
+    out_to->local.vslots   = 0;
+    out_from->local.vslots = 0;
+  }
+
+  /* allocate entire receive context */
+  out_from->type      = in_from->type;
+  ny                  = in_from->starts[in_from->n];
+  out_from->n         = in_from->n;
+  out_from->sendfirst = in_from->sendfirst;
+
+  ierr = PetscMalloc1(out_from->n,&out_from->requests);CHKERRQ(ierr);
+  ierr = PetscMalloc4(ny*bs,&out_from->values,ny,&out_from->indices,out_from->n+1,&out_from->starts,out_from->n,&out_from->procs);CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_from->indices,in_from->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_from->starts,in_from->starts,(out_from->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(out_from->procs,in_from->procs,(out_from->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+
+  out->fromdata                        = (void*)out_from;
+  out_from->local.n                    = in_from->local.n;
+  out_from->local.nonmatching_computed = PETSC_FALSE;
+  out_from->local.n_nonmatching        = 0;
+  out_from->local.slots_nonmatching    = 0;
+
+  out_to->bs           = out_from->bs           = bs;
+  out_to->use_neighbor = out_from->use_neighbor = PETSC_TRUE;
+  ierr = VecScatterSetUpNeighbor_Private(out,out_to,out_from);CHKERRQ(ierr);
+  if (in_to->packopt || in_from->packopt) {
+    ierr = VecScatterPackOptCreate_Private(out_to,out_from,in_to->packopt ? in_to->packopt->nthreads : in_from->packopt->nthreads);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+#endif
 /* --------------------------------------------------------------------------------------------------
     Packs and unpacks the message data into send or from receive buffers.
 
@@ -2514,7 +2666,8 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
   PetscMPIInt    tag  = ((PetscObject)ctx)->tag, tagr;
   PetscInt       bs   = to->bs;
   PetscMPIInt    size;
-  PetscInt       i, n;
+  PetscInt       i, n, nthreads = 1;
+  PetscBool      packopt = PETSC_TRUE;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -2559,6 +2712,20 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
   from->use_window = to->use_window;
 #endif
 
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  to->use_neighbor = PETSC_FALSE;
+  if (!to->use_alltoallv && !to->use_window) {
+    ierr = PetscOptionsGetBool(NULL,NULL,"-vecscatter_neighbor",&to->use_neighbor,NULL);CHKERRQ(ierr);
+  }
+  from->use_neighbor = to->use_neighbor;
+  if (from->use_neighbor) PetscInfo(ctx,"Using MPI_Neighbor_alltoallv() on a distributed graph communicator for scatter\n");
+#endif
+
+  /* plans that turn runs of indices into memcpy() or strided loops when packing and unpacking */
+  ierr = PetscOptionsGetBool(NULL,NULL,"-vecscatter_packopt",&packopt,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-vecscatter_pack_threads",&nthreads,NULL);CHKERRQ(ierr);
+  if (packopt) {ierr = VecScatterPackOptCreate_Private(to,from,nthreads);CHKERRQ(ierr);}
+
   if (to->use_alltoallv) {
 
     ierr       = PetscMalloc2(size,&to->counts,size,&to->displs);CHKERRQ(ierr);
@@ -2650,6 +2817,11 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
     }
     ierr = MPI_Waitall(from->n,request,status);CHKERRQ(ierr);
     ierr = PetscFree2(request,status);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+  } else if (to->use_neighbor) {
+    ierr = VecScatterSetUpNeighbor_Private(ctx,to,from);CHKERRQ(ierr);
+    ctx->ops->copy = VecScatterCopy_PtoP_Neighbor;
 #endif
   } else {
     PetscBool   use_rsend = PETSC_FALSE, use_ssend = PETSC_FALSE;
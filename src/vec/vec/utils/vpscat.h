@@ -65,7 +65,7 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
   else yv = xv;
 
   if (!(mode & SCATTER_LOCAL)) {
-    if (!from->use_readyreceiver && !to->sendfirst && !to->use_alltoallv  & !to->use_window) {
+    if (!from->use_readyreceiver && !to->sendfirst && !to->use_alltoallv  & !to->use_window && !to->use_neighbor) {
       /* post receives since they were not previously posted    */
       if (nrecvs) {ierr = MPI_Startall_irecv(from->starts[nrecvs]*bs,nrecvs,rwaits);CHKERRQ(ierr);}
     }
@@ -75,11 +75,22 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
       ierr = MPI_Alltoallw(xv,to->wcounts,to->wdispls,to->types,yv,from->wcounts,from->wdispls,from->types,PetscObjectComm((PetscObject)ctx));CHKERRQ(ierr);
     } else
 #endif
-    if (ctx->packtogether || to->use_alltoallv || to->use_window) {
+    if (ctx->packtogether || to->use_alltoallv || to->use_window || to->use_neighbor) {
       /* this version packs all the messages together and sends, when -vecscatter_packtogether used */
-      PETSCMAP1(Pack)(sstarts[nsends],indices,xv,svalues,bs);
+      if (to->packopt) {ierr = PetscSFPackOptPack(to->packopt,0,nsends,bs,1,xv,svalues);CHKERRQ(ierr);}
+      else PETSCMAP1(Pack)(sstarts[nsends],indices,xv,svalues,bs);
       if (to->use_alltoallv) {
         ierr = MPI_Alltoallv(to->values,to->counts,to->displs,MPIU_SCALAR,from->values,from->counts,from->displs,MPIU_SCALAR,PetscObjectComm((PetscObject)ctx));CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES)
+      } else if (to->use_neighbor) {
+#if defined(PETSC_HAVE_MPI_NEIGHBOR_ALLTOALLV_INIT)
+        ierr = MPI_Start(&to->nrequest);CHKERRQ(ierr);
+#elif defined(PETSC_HAVE_MPI_INEIGHBOR_ALLTOALLV)
+        ierr = MPI_Ineighbor_alltoallv(to->values,to->ncounts,to->ndispls,MPIU_SCALAR,from->values,from->ncounts,from->ndispls,MPIU_SCALAR,to->neighborcomm,&to->nrequest);CHKERRQ(ierr);
+#else
+        ierr = MPI_Neighbor_alltoallv(to->values,to->ncounts,to->ndispls,MPIU_SCALAR,from->values,from->ncounts,from->ndispls,MPIU_SCALAR,to->neighborcomm);CHKERRQ(ierr);
+#endif
+#endif
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
       } else if (to->use_window) {
         PetscInt cnt;
@@ -96,12 +107,13 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
     } else {
       /* this version packs and sends one at a time */
       for (i=0; i<nsends; i++) {
-        PETSCMAP1(Pack)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
+        if (to->packopt) {ierr = PetscSFPackOptPack(to->packopt,i,i+1,bs,1,xv,svalues + bs*sstarts[i]);CHKERRQ(ierr);}
+        else PETSCMAP1(Pack)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
         ierr = MPI_Start_isend(sstarts[i+1]-sstarts[i],swaits+i);CHKERRQ(ierr);
       }
     }
 
-    if (!from->use_readyreceiver && to->sendfirst && !to->use_alltoallv && !to->use_window) {
+    if (!from->use_readyreceiver && to->sendfirst && !to->use_alltoallv && !to->use_window && !to->use_neighbor) {
       /* post receives since they were not previously posted   */
       if (nrecvs) {ierr = MPI_Startall_irecv(from->starts[nrecvs]*bs,nrecvs,rwaits);CHKERRQ(ierr);}
     }
@@ -164,13 +176,18 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
   indices = from->indices;
   rstarts = from->starts;
 
-  if (ctx->packtogether || (to->use_alltoallw && (addv != INSERT_VALUES)) || (to->use_alltoallv && !to->use_alltoallw) || to->use_window) {
+  if (ctx->packtogether || (to->use_alltoallw && (addv != INSERT_VALUES)) || (to->use_alltoallv && !to->use_alltoallw) || to->use_window || to->use_neighbor) {
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
     if (to->use_window) {ierr = MPI_Win_fence(0,from->window);CHKERRQ(ierr);}
     else
 #endif
-    if (nrecvs && !to->use_alltoallv) {ierr = MPI_Waitall(nrecvs,rwaits,rstatus);CHKERRQ(ierr);}
-    ierr = PETSCMAP1(UnPack)(from->starts[from->n],from->values,indices,yv,addv,bs);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_NEIGHBORHOOD_COLLECTIVES) && (defined(PETSC_HAVE_MPI_NEIGHBOR_ALLTOALLV_INIT) || defined(PETSC_HAVE_MPI_INEIGHBOR_ALLTOALLV))
+    if (to->use_neighbor) {ierr = MPI_Wait(&to->nrequest,&xrstatus);CHKERRQ(ierr);}
+    else
+#endif
+    if (nrecvs && !to->use_alltoallv && !to->use_neighbor) {ierr = MPI_Waitall(nrecvs,rwaits,rstatus);CHKERRQ(ierr);}
+    if (from->packopt) {ierr = PetscSFPackOptUnpack(from->packopt,0,nrecvs,bs,1,from->values,yv,addv);CHKERRQ(ierr);}
+    else {ierr = PETSCMAP1(UnPack)(from->starts[from->n],from->values,indices,yv,addv,bs);CHKERRQ(ierr);}
   } else if (!to->use_alltoallw) {
     /* unpack one at a time */
     count = nrecvs;
@@ -182,7 +199,8 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
         ierr = MPI_Waitany(nrecvs,rwaits,&imdex,&xrstatus);CHKERRQ(ierr);
       }
       /* unpack receives into our local space */
-      ierr = PETSCMAP1(UnPack)(rstarts[imdex+1] - rstarts[imdex],rvalues + bs*rstarts[imdex],indices + rstarts[imdex],yv,addv,bs);CHKERRQ(ierr);
+      if (from->packopt) {ierr = PetscSFPackOptUnpack(from->packopt,imdex,imdex+1,bs,1,rvalues + bs*rstarts[imdex],yv,addv);CHKERRQ(ierr);}
+      else {ierr = PETSCMAP1(UnPack)(rstarts[imdex+1] - rstarts[imdex],rvalues + bs*rstarts[imdex],indices + rstarts[imdex],yv,addv,bs);CHKERRQ(ierr);}
       count--;
     }
   }
@@ -192,7 +210,7 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
   }
 
   /* wait on sends */
-  if (nsends  && !to->use_alltoallv  && !to->use_window) {ierr = MPI_Waitall(nsends,swaits,sstatus);CHKERRQ(ierr);}
+  if (nsends  && !to->use_alltoallv  && !to->use_window && !to->use_neighbor) {ierr = MPI_Waitall(nsends,swaits,sstatus);CHKERRQ(ierr);}
   ierr = VecRestoreArray(yin,&yv);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
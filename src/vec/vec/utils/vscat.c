@@ -1958,8 +1958,9 @@ PetscErrorCode  VecScatterView(VecScatter ctx,PetscViewer viewer)
 PetscErrorCode  VecScatterRemap(VecScatter scat,PetscInt *rto,PetscInt *rfrom)
 {
   VecScatter_Seq_General *to,*from;
-  VecScatter_MPI_General *mto;
+  VecScatter_MPI_General *mto,*mfrom;
   PetscInt               i;
+  PetscErrorCode         ierr;
 
   PetscFunctionBegin;
   PetscValidHeaderSpecific(scat,VEC_SCATTER_CLASSID,1);
@@ -1979,6 +1980,17 @@ PetscErrorCode  VecScatterRemap(VecScatter scat,PetscInt *rto,PetscInt *rfrom)
       /* handle local part */
       to = &mto->local;
       for (i=0; i<to->n; i++) to->vslots[i] = rto[to->vslots[i]];
+
+      /* the pack plans hold runs of the old indices so they are rebuilt */
+      if (mto->packopt) {
+        PetscInt nthreads = mto->packopt->nthreads;
+
+        mfrom = (VecScatter_MPI_General*)scat->fromdata;
+        ierr  = PetscSFPackOptDestroy(&mto->packopt);CHKERRQ(ierr);
+        ierr  = PetscSFPackOptDestroy(&mfrom->packopt);CHKERRQ(ierr);
+        ierr  = PetscSFPackOptCreate(mto->n,mto->starts,mto->indices,nthreads,&mto->packopt);CHKERRQ(ierr);
+        ierr  = PetscSFPackOptCreate(mfrom->n,mfrom->starts,mfrom->indices,nthreads,&mfrom->packopt);CHKERRQ(ierr);
+      }
     } else if (from->type == VEC_SCATTER_SEQ_GENERAL) {
       for (i=0; i<from->n; i++) from->vslots[i] = rto[from->vslots[i]];
     } else if (from->type == VEC_SCATTER_SEQ_STRIDE) {